@@ -0,0 +1,324 @@
+#include "NTRIPCasterProtocol.h"
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#define NTRIP_CASTER_SERVER "NTRIP ESP32-Caster/1.0"
+
+/**
+ * @brief Compare the start of a line with a header name, ignoring case.
+ * @return Pointer to the first character after the name, or NULL if no match.
+ */
+static const char* matchHeader(const char* line, const char* end, const char* name) {
+    size_t len = strlen(name);
+    if ((size_t)(end - line) < len) {
+        return NULL;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (tolower((unsigned char)line[i]) != tolower((unsigned char)name[i])) {
+            return NULL;
+        }
+    }
+    return line + len;
+}
+
+/**
+ * @brief Skip spaces and tabs.
+ */
+static const char* skipSpaces(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        p++;
+    }
+    return p;
+}
+
+/**
+ * @brief Copy a field, trimming trailing whitespace.
+ * @return false if the field does not fit.
+ */
+static bool copyField(const char* start, const char* end, char* out, size_t size) {
+    while (end > start && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) {
+        end--;
+    }
+    size_t len = (size_t)(end - start);
+    if (len >= size) {
+        return false;
+    }
+    memcpy(out, start, len);
+    out[len] = '\0';
+    return true;
+}
+
+/**
+ * @brief Base64 encode (RFC 4648) into a terminated string.
+ * @return false if the output does not fit.
+ */
+static bool base64Encode(const uint8_t* data, size_t length, char* out, size_t size) {
+    static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t needed = ((length + 2) / 3) * 4 + 1;
+    if (needed > size) {
+        return false;
+    }
+    size_t o = 0;
+    for (size_t i = 0; i < length; i += 3) {
+        uint32_t v = (uint32_t)data[i] << 16;
+        if (i + 1 < length) v |= (uint32_t)data[i + 1] << 8;
+        if (i + 2 < length) v |= data[i + 2];
+        out[o++] = table[(v >> 18) & 0x3F];
+        out[o++] = table[(v >> 12) & 0x3F];
+        out[o++] = (i + 1 < length) ? table[(v >> 6) & 0x3F] : '=';
+        out[o++] = (i + 2 < length) ? table[v & 0x3F] : '=';
+    }
+    out[o] = '\0';
+    return true;
+}
+
+NtripRequestStatus parseNtripRequest(const char* buffer, size_t length, NtripRequest* request) {
+    if (buffer == NULL || request == NULL) {
+        return NTRIP_REQUEST_INVALID;
+    }
+
+    // Locate the blank line that terminates the header
+    const char* end = buffer + length;
+    const char* headerEnd = NULL;
+    for (const char* p = buffer; p < end; p++) {
+        if (*p != '\n') {
+            continue;
+        }
+        if (p + 1 < end && p[1] == '\n') {
+            headerEnd = p + 2;
+            break;
+        }
+        if (p + 2 < end && p[1] == '\r' && p[2] == '\n') {
+            headerEnd = p + 3;
+            break;
+        }
+    }
+    if (headerEnd == NULL) {
+        // Reject early if the request line is clearly not a GET
+        if (length >= 4 && strncmp(buffer, "GET ", 4) != 0) {
+            return NTRIP_REQUEST_INVALID;
+        }
+        return NTRIP_REQUEST_INCOMPLETE;
+    }
+
+    memset(request, 0, sizeof(*request));
+    request->version = 1;
+    request->headerLength = (size_t)(headerEnd - buffer);
+
+    // Request line: GET /<mountpoint> HTTP/1.x
+    const char* lineEnd = (const char*)memchr(buffer, '\n', (size_t)(headerEnd - buffer));
+    if (lineEnd == NULL || (size_t)(lineEnd - buffer) < 5 || strncmp(buffer, "GET ", 4) != 0) {
+        return NTRIP_REQUEST_INVALID;
+    }
+    const char* path = skipSpaces(buffer + 4, lineEnd);
+    if (path >= lineEnd || *path != '/') {
+        return NTRIP_REQUEST_INVALID;
+    }
+    path++;
+    const char* pathEnd = path;
+    while (pathEnd < lineEnd && *pathEnd != ' ' && *pathEnd != '\r' && *pathEnd != '?') {
+        pathEnd++;
+    }
+    if (!copyField(path, pathEnd, request->mountpoint, sizeof(request->mountpoint))) {
+        return NTRIP_REQUEST_INVALID;
+    }
+
+    // Header fields
+    const char* line = lineEnd + 1;
+    while (line < headerEnd) {
+        lineEnd = (const char*)memchr(line, '\n', (size_t)(headerEnd - line));
+        if (lineEnd == NULL) {
+            break;
+        }
+
+        const char* value = matchHeader(line, lineEnd, "Ntrip-Version:");
+        if (value != NULL) {
+            value = skipSpaces(value, lineEnd);
+            if (matchHeader(value, lineEnd, "Ntrip/2") != NULL) {
+                request->version = 2;
+            }
+        }
+
+        value = matchHeader(line, lineEnd, "Authorization:");
+        if (value != NULL) {
+            value = skipSpaces(value, lineEnd);
+            const char* token = matchHeader(value, lineEnd, "Basic ");
+            if (token != NULL) {
+                token = skipSpaces(token, lineEnd);
+                if (!copyField(token, lineEnd, request->authorization, sizeof(request->authorization))) {
+                    return NTRIP_REQUEST_INVALID;
+                }
+                request->hasAuthorization = true;
+            }
+        }
+
+        line = lineEnd + 1;
+    }
+
+    return NTRIP_REQUEST_OK;
+}
+
+bool ntripCheckAuthorization(const NtripRequest* request, const char* user, const char* password) {
+    if (user == NULL || user[0] == '\0') {
+        return true;
+    }
+    if (request == NULL || !request->hasAuthorization) {
+        return false;
+    }
+
+    char credentials[NTRIP_AUTH_MAX_LEN];
+    char expected[NTRIP_AUTH_MAX_LEN];
+    int len = snprintf(credentials, sizeof(credentials), "%s:%s", user, password ? password : "");
+    if (len < 0 || (size_t)len >= sizeof(credentials)) {
+        return false;
+    }
+    if (!base64Encode((const uint8_t*)credentials, (size_t)len, expected, sizeof(expected))) {
+        return false;
+    }
+    return strcmp(expected, request->authorization) == 0;
+}
+
+/**
+ * @brief Return the formatted length, or 0 if snprintf truncated.
+ */
+static size_t checkedLength(int len, size_t size) {
+    return (len < 0 || (size_t)len >= size) ? 0 : (size_t)len;
+}
+
+size_t ntripFormatResponse(NtripResponseType type, int version, const char* mountpoint,
+                           char* buffer, size_t size) {
+    int len = -1;
+    const char* realm = mountpoint ? mountpoint : "";
+
+    if (buffer == NULL || size == 0) {
+        return 0;
+    }
+
+    if (version >= 2) {
+        switch (type) {
+            case NTRIP_RESPONSE_STREAM:
+                len = snprintf(buffer, size,
+                               "HTTP/1.1 200 OK\r\n"
+                               "Ntrip-Version: Ntrip/2.0\r\n"
+                               "Server: " NTRIP_CASTER_SERVER "\r\n"
+                               "Content-Type: gnss/data\r\n"
+                               "Cache-Control: no-store, no-cache, max-age=0\r\n"
+                               "Connection: close\r\n"
+                               "Transfer-Encoding: chunked\r\n\r\n");
+                break;
+            case NTRIP_RESPONSE_UNAUTHORIZED:
+                len = snprintf(buffer, size,
+                               "HTTP/1.1 401 Unauthorized\r\n"
+                               "Ntrip-Version: Ntrip/2.0\r\n"
+                               "Server: " NTRIP_CASTER_SERVER "\r\n"
+                               "WWW-Authenticate: Basic realm=\"/%s\"\r\n"
+                               "Content-Length: 0\r\n"
+                               "Connection: close\r\n\r\n", realm);
+                break;
+            case NTRIP_RESPONSE_NOT_FOUND:
+                len = snprintf(buffer, size,
+                               "HTTP/1.1 404 Not Found\r\n"
+                               "Ntrip-Version: Ntrip/2.0\r\n"
+                               "Server: " NTRIP_CASTER_SERVER "\r\n"
+                               "Content-Length: 0\r\n"
+                               "Connection: close\r\n\r\n");
+                break;
+            case NTRIP_RESPONSE_UNAVAILABLE:
+                len = snprintf(buffer, size,
+                               "HTTP/1.1 503 Service Unavailable\r\n"
+                               "Ntrip-Version: Ntrip/2.0\r\n"
+                               "Server: " NTRIP_CASTER_SERVER "\r\n"
+                               "Content-Length: 0\r\n"
+                               "Connection: close\r\n\r\n");
+                break;
+            case NTRIP_RESPONSE_BAD_REQUEST:
+                len = snprintf(buffer, size,
+                               "HTTP/1.1 400 Bad Request\r\n"
+                               "Ntrip-Version: Ntrip/2.0\r\n"
+                               "Server: " NTRIP_CASTER_SERVER "\r\n"
+                               "Content-Length: 0\r\n"
+                               "Connection: close\r\n\r\n");
+                break;
+        }
+    } else {
+        switch (type) {
+            case NTRIP_RESPONSE_STREAM:
+                len = snprintf(buffer, size, "ICY 200 OK\r\n\r\n");
+                break;
+            case NTRIP_RESPONSE_UNAUTHORIZED:
+                len = snprintf(buffer, size,
+                               "HTTP/1.0 401 Unauthorized\r\n"
+                               "Server: " NTRIP_CASTER_SERVER "\r\n"
+                               "WWW-Authenticate: Basic realm=\"/%s\"\r\n\r\n", realm);
+                break;
+            case NTRIP_RESPONSE_NOT_FOUND:
+            case NTRIP_RESPONSE_BAD_REQUEST:
+                // NTRIP 1.0 clients get the sourcetable instead; this is a fallback only
+                len = snprintf(buffer, size,
+                               "HTTP/1.0 400 Bad Request\r\n"
+                               "Server: " NTRIP_CASTER_SERVER "\r\n\r\n");
+                break;
+            case NTRIP_RESPONSE_UNAVAILABLE:
+                len = snprintf(buffer, size,
+                               "HTTP/1.0 503 Service Unavailable\r\n"
+                               "Server: " NTRIP_CASTER_SERVER "\r\n\r\n");
+                break;
+        }
+    }
+
+    return checkedLength(len, size);
+}
+
+size_t ntripFormatSourcetable(int version, const char* mountpoint, bool authentication,
+                              double latitude, double longitude, char* buffer, size_t size) {
+    char table[256];
+    const char* mount = mountpoint ? mountpoint : "";
+
+    // STR;mountpoint;identifier;format;format-details;carrier;nav-system;network;country;
+    // latitude;longitude;nmea;solution;generator;compr-encryp;authentication;fee;bitrate;misc
+    int tableLen = snprintf(table, sizeof(table),
+                            "STR;%s;%s;RTCM 3;;2;GNSS;LOCAL;;%.2f;%.2f;0;0;ESP32;none;%c;N;0;\r\n"
+                            "ENDSOURCETABLE\r\n",
+                            mount, mount, latitude, longitude, authentication ? 'B' : 'N');
+    if (checkedLength(tableLen, sizeof(table)) == 0 || buffer == NULL) {
+        return 0;
+    }
+
+    int len;
+    if (version >= 2) {
+        len = snprintf(buffer, size,
+                       "HTTP/1.1 200 OK\r\n"
+                       "Ntrip-Version: Ntrip/2.0\r\n"
+                       "Server: " NTRIP_CASTER_SERVER "\r\n"
+                       "Content-Type: gnss/sourcetable\r\n"
+                       "Content-Length: %d\r\n"
+                       "Connection: close\r\n\r\n%s", tableLen, table);
+    } else {
+        len = snprintf(buffer, size,
+                       "SOURCETABLE 200 OK\r\n"
+                       "Server: " NTRIP_CASTER_SERVER "\r\n"
+                       "Content-Type: text/plain\r\n"
+                       "Content-Length: %d\r\n\r\n%s", tableLen, table);
+    }
+    return checkedLength(len, size);
+}
+
+size_t ntripFormatChunkHeader(size_t length, char* buffer) {
+    static const char hex[] = "0123456789ABCDEF";
+    char digits[8];
+    size_t count = 0;
+
+    do {
+        digits[count++] = hex[length & 0x0F];
+        length >>= 4;
+    } while (length > 0 && count < sizeof(digits));
+
+    size_t pos = 0;
+    while (count > 0) {
+        buffer[pos++] = digits[--count];
+    }
+    buffer[pos++] = '\r';
+    buffer[pos++] = '\n';
+    return pos;
+}
@@ -23,19 +23,30 @@
 #include "NTRIPClient.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_crt_bundle.h"
+#include "mbedtls/platform_util.h"
 #include <cstring>
 #include <cstdio>
 
 static const char* TAG = "NTRIPClient";
 
+#define NTRIP_TLS_TIMEOUT_MS    20000
+
 NTRIPClient::NTRIPClient() 
     : client(nullptr), buffer(nullptr), buffer_size(2048), 
-      buffer_pos(0), connected_flag(false) {
+      buffer_pos(0), connected_flag(false),
+      tls_enabled(false), tls_ca_pem(nullptr), tls(nullptr), tls_session(nullptr),
+      tls_session_port(0), tls_fingerprint_valid(false), buffer_len(0), chunked(false) {
     buffer = new char[buffer_size];
+    tls_session_host[0] = '\0';
+    memset(tls_fingerprint, 0, sizeof(tls_fingerprint));
+    memset(&tls_stats, 0, sizeof(tls_stats));
 }
 
 NTRIPClient::~NTRIPClient() {
     disconnect();
+    clearTlsSession();
     if (buffer) {
         delete[] buffer;
     }
@@ -45,6 +56,195 @@ bool NTRIPClient::init() {
     return true; // Configuration done per-request
 }
 
+void NTRIPClient::setTls(bool enabled, const char* caPem) {
+    if (enabled != tls_enabled) {
+        clearTlsSession();
+    }
+    tls_enabled = enabled;
+    tls_ca_pem = caPem;
+}
+
+void NTRIPClient::clearTlsSession() {
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+    if (tls_session) {
+        esp_tls_free_client_session(tls_session);
+        tls_session = nullptr;
+    }
+#endif
+    tls_session_host[0] = '\0';
+    tls_session_port = 0;
+    mbedtls_platform_zeroize(tls_fingerprint, sizeof(tls_fingerprint));
+    tls_fingerprint_valid = false;
+}
+
+bool NTRIPClient::tlsConnect(const char* host, int port) {
+    esp_tls_cfg_t cfg = {};
+    cfg.timeout_ms = NTRIP_TLS_TIMEOUT_MS;
+    if (tls_ca_pem != nullptr && tls_ca_pem[0] != '\0') {
+        cfg.cacert_buf = (const unsigned char*)tls_ca_pem;
+        cfg.cacert_bytes = strlen(tls_ca_pem) + 1;
+    } else {
+        cfg.crt_bundle_attach = esp_crt_bundle_attach;
+    }
+
+    // Offer the session of the previous connection to the same caster
+    bool offered = false;
+    if (strcmp(tls_session_host, host) != 0 || tls_session_port != port) {
+        clearTlsSession();
+    }
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+    if (tls_session) {
+        cfg.client_session = tls_session;
+        offered = true;
+    }
+#endif
+
+    tls = esp_tls_init();
+    if (!tls) {
+        ESP_LOGE(TAG, "Failed to allocate TLS connection");
+        return false;
+    }
+
+    int64_t start = esp_timer_get_time();
+    int ret = esp_tls_conn_new_sync(host, strlen(host), port, &cfg, tls);
+    uint32_t elapsed_ms = (uint32_t)((esp_timer_get_time() - start) / 1000);
+    if (ret != 1) {
+        ESP_LOGE(TAG, "TLS connection to %s:%d failed after %u ms", host, port, (unsigned)elapsed_ms);
+        esp_tls_conn_destroy(tls);
+        tls = nullptr;
+        tls_stats.failedHandshakes++;
+        // Do not offer a session the caster may have rejected
+        clearTlsSession();
+        return false;
+    }
+
+    // A resumed session keeps its master secret, a full handshake derives a new one
+    bool resumed = false;
+    uint8_t fingerprint[NTRIP_TLS_FINGERPRINT_SIZE];
+    if (ntripTlsSessionFingerprint(tls, fingerprint)) {
+        resumed = offered && tls_fingerprint_valid &&
+                  memcmp(fingerprint, tls_fingerprint, sizeof(tls_fingerprint)) == 0;
+        memcpy(tls_fingerprint, fingerprint, sizeof(tls_fingerprint));
+        tls_fingerprint_valid = true;
+    } else {
+        tls_fingerprint_valid = false;
+    }
+    mbedtls_platform_zeroize(fingerprint, sizeof(fingerprint));
+
+    if (resumed) {
+        tls_stats.resumedHandshakes++;
+        tls_stats.resumedTotalMs += elapsed_ms;
+    } else {
+        tls_stats.fullHandshakes++;
+        tls_stats.fullTotalMs += elapsed_ms;
+    }
+    tls_stats.lastHandshakeMs = elapsed_ms;
+    tls_stats.lastResumed = resumed;
+    ESP_LOGI(TAG, "TLS %s handshake with %s:%d in %u ms", resumed ? "resumed" : "full",
+             host, port, (unsigned)elapsed_ms);
+
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+    // Keep the (possibly renewed) session for the next reconnect
+    esp_tls_client_session_t* session = esp_tls_get_client_session(tls);
+    if (session) {
+        if (tls_session) {
+            esp_tls_free_client_session(tls_session);
+        }
+        tls_session = session;
+        strncpy(tls_session_host, host, sizeof(tls_session_host) - 1);
+        tls_session_host[sizeof(tls_session_host) - 1] = '\0';
+        tls_session_port = port;
+    }
+#endif
+    return true;
+}
+
+bool NTRIPClient::tlsWriteAll(const char* data, size_t length) {
+    size_t written = 0;
+    int64_t deadline = esp_timer_get_time() + (int64_t)NTRIP_TLS_TIMEOUT_MS * 1000;
+    while (written < length) {
+        if (esp_timer_get_time() > deadline) {
+            // The caster stopped reading; do not block the task on a dead connection
+            ESP_LOGE(TAG, "TLS write timed out after %u of %u bytes", (unsigned)written, (unsigned)length);
+            disconnect();
+            return false;
+        }
+        int ret = esp_tls_conn_write(tls, data + written, length - written);
+        if (ret == ESP_TLS_ERR_SSL_WANT_READ || ret == ESP_TLS_ERR_SSL_WANT_WRITE) {
+            continue;
+        }
+        if (ret < 0) {
+            ESP_LOGE(TAG, "TLS write failed: -0x%x", -ret);
+            return false;
+        }
+        written += ret;
+    }
+    return true;
+}
+
+bool NTRIPClient::reqRawTls(const char* host, int port, const char* mntpnt, const char* user, const char* psw) {
+    disconnect();
+
+    char auth_encoded[256] = "";
+    if (strlen(user) > 0) {
+        char auth_input[128];
+        snprintf(auth_input, sizeof(auth_input), "%s:%s", user, psw);
+        if (!base64Encode(auth_input, auth_encoded, sizeof(auth_encoded))) {
+            ESP_LOGE(TAG, "Failed to encode credentials");
+            return false;
+        }
+    }
+
+    if (!tlsConnect(host, port)) {
+        return false;
+    }
+
+    char request[512];
+    size_t request_len = ntripFormatRequest(host, mntpnt, auth_encoded, request, sizeof(request));
+    if (request_len == 0 || !tlsWriteAll(request, request_len)) {
+        disconnect();
+        return false;
+    }
+
+    // Read the response header; stream bytes received with it stay in the buffer
+    NtripResponseHeader header;
+    NtripHeaderStatus status = NTRIP_HEADER_INCOMPLETE;
+    int64_t deadline = esp_timer_get_time() + (int64_t)NTRIP_TLS_TIMEOUT_MS * 1000;
+    while (status == NTRIP_HEADER_INCOMPLETE) {
+        if (buffer_len >= buffer_size || esp_timer_get_time() > deadline) {
+            ESP_LOGE(TAG, "No complete response header from caster");
+            disconnect();
+            return false;
+        }
+        int ret = esp_tls_conn_read(tls, buffer + buffer_len, buffer_size - buffer_len);
+        if (ret == ESP_TLS_ERR_SSL_WANT_READ || ret == ESP_TLS_ERR_SSL_WANT_WRITE) {
+            continue;
+        }
+        if (ret <= 0) {
+            ESP_LOGE(TAG, "Connection closed while reading response header");
+            disconnect();
+            return false;
+        }
+        buffer_len += ret;
+        status = parseNtripResponseHeader(buffer, buffer_len, &header);
+    }
+
+    if (status != NTRIP_HEADER_OK || header.statusCode != 200 || header.sourcetable) {
+        ESP_LOGE(TAG, "Mountpoint %s refused (status %d%s)", mntpnt, header.statusCode,
+                 header.sourcetable ? ", sourcetable returned" : "");
+        disconnect();
+        return false;
+    }
+
+    chunked = header.chunked;
+    chunk_decoder.reset();
+    buffer_pos = header.headerLength;
+    connected_flag = true;
+    ESP_LOGI(TAG, "Successfully connected to NTRIP stream over TLS (%s)",
+             header.icy ? "NTRIP 1.0" : (chunked ? "NTRIP 2.0, chunked" : "NTRIP 2.0"));
+    return true;
+}
+
 bool NTRIPClient::base64Encode(const char* input, char* output, size_t output_size) {
     size_t olen = 0;
     int ret = mbedtls_base64_encode(
@@ -167,6 +367,10 @@ bool NTRIPClient::reqSrcTbl(const char* host, int &port, const char* user, const
 }
 
 bool NTRIPClient::reqRaw(const char* host, int &port, const char* mntpnt, const char* user, const char* psw) {
+    if (tls_enabled) {
+        return reqRawTls(host, port, mntpnt, user, psw);
+    }
+
     char url[256];
     snprintf(url, sizeof(url), "http://%s:%d/%s", host, port, mntpnt);
 
@@ -263,25 +467,36 @@ int NTRIPClient::readLine(char* _buffer, int size) {
     return len;
 }
 
-void NTRIPClient::sendGGA(const char* gga) {
-    if (!client || !connected_flag) {
+bool NTRIPClient::sendGGA(const char* gga) {
+    if (!isConnected()) {
         ESP_LOGW(TAG, "Not connected to NTRIP Caster");
-        return;
+        return false;
     }
 
     char ggaString[256];
     snprintf(ggaString, sizeof(ggaString), "%s\r\n", gga);
     
+    if (tls) {
+        if (!tlsWriteAll(ggaString, strlen(ggaString))) {
+            ESP_LOGE(TAG, "Failed to send GGA sentence");
+            connected_flag = false;
+            return false;
+        }
+        ESP_LOGD(TAG, "Sent GGA: %s", gga);
+        return true;
+    }
+
     int written = esp_http_client_write(client, ggaString, strlen(ggaString));
     if (written < 0) {
         ESP_LOGE(TAG, "Failed to send GGA sentence");
-    } else {
-        ESP_LOGD(TAG, "Sent GGA: %s", gga);
+        return false;
     }
+    ESP_LOGD(TAG, "Sent GGA: %s", gga);
+    return true;
 }
 
 bool NTRIPClient::isConnected() {
-    return connected_flag && client != nullptr;
+    return connected_flag && (client != nullptr || tls != nullptr);
 }
 
 void NTRIPClient::disconnect() {
@@ -290,10 +505,50 @@ void NTRIPClient::disconnect() {
         esp_http_client_cleanup(client);
         client = nullptr;
     }
+    if (tls) {
+        // The session is kept for resumption on the next connection
+        esp_tls_conn_destroy(tls);
+        tls = nullptr;
+    }
+    buffer_len = 0;
+    buffer_pos = 0;
     connected_flag = false;
 }
 
 int NTRIPClient::readData(uint8_t* data, size_t size) {
+    if (tls && connected_flag) {
+        size_t length;
+        if (buffer_pos < buffer_len) {
+            // Stream bytes that arrived together with the response header
+            length = buffer_len - buffer_pos;
+            if (length > size) {
+                length = size;
+            }
+            memcpy(data, buffer + buffer_pos, length);
+            buffer_pos += length;
+        } else {
+            int ret = esp_tls_conn_read(tls, data, size);
+            if (ret == ESP_TLS_ERR_SSL_WANT_READ || ret == ESP_TLS_ERR_SSL_WANT_WRITE) {
+                return 0;
+            }
+            if (ret <= 0) {
+                ESP_LOGE(TAG, "Error reading TLS data: %d", ret);
+                connected_flag = false;
+                return -1;
+            }
+            length = ret;
+        }
+
+        if (chunked) {
+            length = chunk_decoder.decode(data, length);
+            if (chunk_decoder.hasError() || chunk_decoder.isFinished()) {
+                ESP_LOGW(TAG, "NTRIP 2.0 stream %s", chunk_decoder.hasError() ? "framing error" : "ended by caster");
+                connected_flag = false;
+            }
+        }
+        return (int)length;
+    }
+
     if (!client || !connected_flag) {
         return 0;
     }
@@ -310,6 +565,10 @@ int NTRIPClient::readData(uint8_t* data, size_t size) {
 }
 
 int NTRIPClient::available() {
+    if (tls) {
+        // Reads block until data arrives or the socket timeout expires
+        return connected_flag ? 1 : 0;
+    }
     if (!client || !connected_flag) {
         return 0;
     }
@@ -24,11 +24,29 @@
 #define NTRIP_CLIENT
 
 #include "esp_http_client.h"
+#include "esp_tls.h"
 #include "esp_log.h"
 #include "mbedtls/base64.h"
+#include "NTRIPResponse.h"
+#include "NTRIPTlsSession.h"
 #include <cstring>
 #include <cstdio>
 
+/**
+ * @brief TLS handshake counters, split by full and resumed handshakes.
+ *
+ * Handshake times include the TCP connect, which costs the same for both.
+ */
+struct NTRIPTlsStats {
+    uint32_t fullHandshakes;        ///< Handshakes with certificate exchange
+    uint32_t resumedHandshakes;     ///< Handshakes that resumed the previous session
+    uint32_t failedHandshakes;      ///< Connections that failed during connect or handshake
+    uint64_t fullTotalMs;           ///< Sum of full handshake times
+    uint64_t resumedTotalMs;        ///< Sum of resumed handshake times
+    uint32_t lastHandshakeMs;       ///< Duration of the last successful handshake
+    bool lastResumed;               ///< Last handshake resumed a session
+};
+
 /**
  * @class NTRIPClient
  * @brief A client for NTRIP (Networked Transport of RTCM via Internet Protocol).
@@ -44,7 +62,24 @@ private:
     size_t buffer_pos;
     bool connected_flag;
 
+    // TLS transport (esp_tls directly, so the session outlives the connection)
+    bool tls_enabled;
+    const char* tls_ca_pem;
+    esp_tls_t* tls;
+    esp_tls_client_session_t* tls_session;
+    char tls_session_host[128];
+    int tls_session_port;
+    uint8_t tls_fingerprint[NTRIP_TLS_FINGERPRINT_SIZE];
+    bool tls_fingerprint_valid;
+    size_t buffer_len;
+    bool chunked;
+    NtripChunkDecoder chunk_decoder;
+    NTRIPTlsStats tls_stats;
+
     bool base64Encode(const char* input, char* output, size_t output_size);
+    bool reqRawTls(const char* host, int port, const char* mntpnt, const char* user, const char* psw);
+    bool tlsConnect(const char* host, int port);
+    bool tlsWriteAll(const char* data, size_t length);
 
 public:
     NTRIPClient();
@@ -55,6 +90,34 @@ public:
      * @return true if initialization was successful, false otherwise.
      */
     bool init();
+
+    /**
+     * @brief Select the transport for the following requests.
+     *
+     * With TLS enabled the caster certificate is verified against the ESP-IDF
+     * certificate bundle, or against caPem when given. The TLS session is kept
+     * after a disconnect and offered on the next connection to the same caster,
+     * so reconnects use an abbreviated handshake when the caster supports
+     * session IDs or session tickets.
+     *
+     * @param[in] enabled true for TLS, false for plain HTTP.
+     * @param[in] caPem PEM CA certificate, or NULL/empty for the certificate bundle.
+     *                  Must stay valid while the client is used.
+     */
+    void setTls(bool enabled, const char* caPem);
+
+    /**
+     * @brief Forget the cached TLS session, the next connection uses a full handshake.
+     *
+     * Call when the caster or its trust anchor changes.
+     */
+    void clearTlsSession();
+
+    /**
+     * @brief Get the TLS handshake counters.
+     * @return Counters since construction.
+     */
+    const NTRIPTlsStats& getTlsStats() const { return tls_stats; }
     /**
      * @brief Request the MountPoints List serviced by the NTRIP Caster without username and password.
      * 
@@ -110,8 +173,9 @@ public:
      * @brief Send a GGA sentence to the NTRIP Caster.
      * 
      * @param[in] gga The GGA sentence to send.
+     * @return true if the sentence was written to the connection.
      */
-    void sendGGA(const char* gga);
+    bool sendGGA(const char* gga);
 
     /**
      * @brief Check if connected to NTRIP Caster.
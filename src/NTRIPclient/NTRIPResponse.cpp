@@ -0,0 +1,281 @@
+#include "NTRIPResponse.h"
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#define NTRIP_CLIENT_AGENT "NTRIPClient ESP32 v1.0"
+
+/**
+ * @brief Compare the start of a line with a header name, ignoring case.
+ * @return Pointer to the first character after the name, or NULL if no match.
+ */
+static const char* matchHeader(const char* line, const char* end, const char* name) {
+    size_t len = strlen(name);
+    if ((size_t)(end - line) < len) {
+        return NULL;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (tolower((unsigned char)line[i]) != tolower((unsigned char)name[i])) {
+            return NULL;
+        }
+    }
+    return line + len;
+}
+
+/**
+ * @brief Check whether a header value contains a token, ignoring case.
+ */
+static bool valueContains(const char* value, const char* end, const char* token) {
+    size_t len = strlen(token);
+    for (const char* p = value; p + len <= end; p++) {
+        if (matchHeader(p, end, token) != NULL) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Find "\r\n" in a buffer.
+ * @return Offset of the '\r', or -1 if not found.
+ */
+static long findLineEnd(const char* buffer, size_t start, size_t length) {
+    for (size_t i = start; i + 1 < length; i++) {
+        if (buffer[i] == '\r' && buffer[i + 1] == '\n') {
+            return (long)i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Check whether the received bytes can still become the given prefix.
+ */
+static bool isPartialPrefix(const char* buffer, size_t length, const char* prefix) {
+    size_t len = strlen(prefix);
+    return length < len && memcmp(buffer, prefix, length) == 0;
+}
+
+NtripHeaderStatus parseNtripResponseHeader(const char* buffer, size_t length, NtripResponseHeader* header) {
+    if (buffer == NULL || header == NULL) {
+        return NTRIP_HEADER_INVALID;
+    }
+    memset(header, 0, sizeof(*header));
+
+    bool icy = length >= 4 && memcmp(buffer, "ICY ", 4) == 0;
+    bool sourcetable = length >= 12 && memcmp(buffer, "SOURCETABLE ", 12) == 0;
+    bool http = length >= 5 && memcmp(buffer, "HTTP/", 5) == 0;
+    if (!icy && !sourcetable && !http) {
+        if (isPartialPrefix(buffer, length, "ICY ") || isPartialPrefix(buffer, length, "HTTP/") ||
+            isPartialPrefix(buffer, length, "SOURCETABLE ")) {
+            return NTRIP_HEADER_INCOMPLETE;
+        }
+        return NTRIP_HEADER_INVALID;
+    }
+
+    long statusEnd = findLineEnd(buffer, 0, length);
+    if (statusEnd < 0) {
+        return NTRIP_HEADER_INCOMPLETE;
+    }
+
+    // Status code follows the first space
+    const char* space = (const char*)memchr(buffer, ' ', (size_t)statusEnd);
+    if (space == NULL || buffer + statusEnd - space < 4 ||
+        !isdigit((unsigned char)space[1]) || !isdigit((unsigned char)space[2]) || !isdigit((unsigned char)space[3])) {
+        return NTRIP_HEADER_INVALID;
+    }
+    header->statusCode = (space[1] - '0') * 100 + (space[2] - '0') * 10 + (space[3] - '0');
+    header->icy = icy;
+    header->sourcetable = sourcetable;
+
+    // NTRIP 1.0 stream: the status line alone, optionally followed by a blank line
+    if (icy) {
+        size_t end = (size_t)statusEnd + 2;
+        if (length == end + 1 && buffer[end] == '\r') {
+            return NTRIP_HEADER_INCOMPLETE;
+        }
+        if (length >= end + 2 && buffer[end] == '\r' && buffer[end + 1] == '\n') {
+            end += 2;
+        }
+        header->headerLength = end;
+        return NTRIP_HEADER_OK;
+    }
+
+    // HTTP and sourcetable responses: header lines up to the blank line
+    size_t lineStart = (size_t)statusEnd + 2;
+    while (1) {
+        long lineEnd = findLineEnd(buffer, lineStart, length);
+        if (lineEnd < 0) {
+            return NTRIP_HEADER_INCOMPLETE;
+        }
+        if ((size_t)lineEnd == lineStart) {
+            header->headerLength = lineStart + 2;
+            return NTRIP_HEADER_OK;
+        }
+
+        const char* line = buffer + lineStart;
+        const char* end = buffer + lineEnd;
+        const char* value;
+        if ((value = matchHeader(line, end, "Transfer-Encoding:")) != NULL) {
+            header->chunked = valueContains(value, end, "chunked");
+        } else if ((value = matchHeader(line, end, "Content-Type:")) != NULL) {
+            if (valueContains(value, end, "gnss/sourcetable")) {
+                header->sourcetable = true;
+            }
+        }
+        lineStart = (size_t)lineEnd + 2;
+    }
+}
+
+size_t ntripFormatRequest(const char* host, const char* mountpoint, const char* authorization,
+                          char* buffer, size_t size) {
+    if (host == NULL || buffer == NULL || size == 0) {
+        return 0;
+    }
+
+    char auth_line[200] = "";
+    if (authorization != NULL && authorization[0] != '\0') {
+        int n = snprintf(auth_line, sizeof(auth_line), "Authorization: Basic %s\r\n", authorization);
+        if (n < 0 || (size_t)n >= sizeof(auth_line)) {
+            return 0;
+        }
+    }
+
+    int len = snprintf(buffer, size,
+                       "GET /%s HTTP/1.1\r\n"
+                       "Host: %s\r\n"
+                       "Ntrip-Version: Ntrip/2.0\r\n"
+                       "User-Agent: " NTRIP_CLIENT_AGENT "\r\n"
+                       "Accept: */*\r\n"
+                       "%s"
+                       "Connection: close\r\n"
+                       "\r\n",
+                       mountpoint != NULL ? mountpoint : "", host, auth_line);
+    if (len < 0 || (size_t)len >= size) {
+        return 0;
+    }
+    return (size_t)len;
+}
+
+NtripChunkDecoder::NtripChunkDecoder() {
+    reset();
+}
+
+void NtripChunkDecoder::reset() {
+    state = STATE_SIZE;
+    remaining = 0;
+    sizeDigits = 0;
+    trailerLineEmpty = true;
+}
+
+size_t NtripChunkDecoder::decode(uint8_t* data, size_t length) {
+    if (data == NULL) {
+        return 0;
+    }
+
+    size_t out = 0;
+    size_t i = 0;
+    while (i < length) {
+        uint8_t c = data[i];
+        switch (state) {
+            case STATE_SIZE:
+                if (isxdigit(c)) {
+                    // More than 8 digits would overflow a 32-bit size
+                    if (sizeDigits >= 8) {
+                        state = STATE_ERROR;
+                        return out;
+                    }
+                    remaining = remaining * 16 + (isdigit(c) ? c - '0' : tolower(c) - 'a' + 10);
+                    sizeDigits++;
+                } else if (sizeDigits > 0 && (c == ';' || c == ' ' || c == '\t')) {
+                    state = STATE_EXTENSION;
+                } else if (sizeDigits > 0 && c == '\r') {
+                    state = STATE_SIZE_LF;
+                } else {
+                    state = STATE_ERROR;
+                    return out;
+                }
+                i++;
+                break;
+
+            case STATE_EXTENSION:
+                if (c == '\r') {
+                    state = STATE_SIZE_LF;
+                }
+                i++;
+                break;
+
+            case STATE_SIZE_LF:
+                if (c != '\n') {
+                    state = STATE_ERROR;
+                    return out;
+                }
+                state = (remaining == 0) ? STATE_TRAILER : STATE_DATA;
+                trailerLineEmpty = true;
+                i++;
+                break;
+
+            case STATE_DATA: {
+                size_t n = length - i;
+                if (n > remaining) {
+                    n = remaining;
+                }
+                memmove(data + out, data + i, n);
+                out += n;
+                i += n;
+                remaining -= n;
+                if (remaining == 0) {
+                    state = STATE_DATA_CR;
+                }
+                break;
+            }
+
+            case STATE_DATA_CR:
+                if (c != '\r') {
+                    state = STATE_ERROR;
+                    return out;
+                }
+                state = STATE_DATA_LF;
+                i++;
+                break;
+
+            case STATE_DATA_LF:
+                if (c != '\n') {
+                    state = STATE_ERROR;
+                    return out;
+                }
+                state = STATE_SIZE;
+                sizeDigits = 0;
+                i++;
+                break;
+
+            case STATE_TRAILER:
+                if (c == '\r') {
+                    state = STATE_TRAILER_LF;
+                } else {
+                    trailerLineEmpty = false;
+                }
+                i++;
+                break;
+
+            case STATE_TRAILER_LF:
+                if (c != '\n') {
+                    state = STATE_ERROR;
+                    return out;
+                }
+                if (trailerLineEmpty) {
+                    state = STATE_FINISHED;
+                } else {
+                    state = STATE_TRAILER;
+                    trailerLineEmpty = true;
+                }
+                i++;
+                break;
+
+            default:
+                // Finished or failed: anything after is ignored
+                return out;
+        }
+    }
+    return out;
+}
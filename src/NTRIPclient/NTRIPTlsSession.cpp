@@ -0,0 +1,22 @@
+// Only this file reads private mbedtls fields
+#define MBEDTLS_ALLOW_PRIVATE_ACCESS
+
+#include "NTRIPTlsSession.h"
+#include "mbedtls/ssl.h"
+#include "mbedtls/sha256.h"
+
+bool ntripTlsSessionFingerprint(esp_tls_t* tls, uint8_t* fingerprint) {
+#if defined(MBEDTLS_SSL_PROTO_TLS1_2) && MBEDTLS_VERSION_NUMBER >= 0x03000000 && MBEDTLS_VERSION_NUMBER < 0x04000000
+    mbedtls_ssl_context* ssl = (mbedtls_ssl_context*)esp_tls_get_ssl_context(tls);
+    if (ssl == nullptr || ssl->MBEDTLS_PRIVATE(session) == nullptr) {
+        return false;
+    }
+    const mbedtls_ssl_session* session = ssl->MBEDTLS_PRIVATE(session);
+    return mbedtls_sha256(session->MBEDTLS_PRIVATE(master), sizeof(session->MBEDTLS_PRIVATE(master)),
+                          fingerprint, 0) == 0;
+#else
+    (void)tls;
+    (void)fingerprint;
+    return false;
+#endif
+}
@@ -0,0 +1,27 @@
+#ifndef NTRIPTLSSESSION_H
+#define NTRIPTLSSESSION_H
+
+#include <stdint.h>
+#include "esp_tls.h"
+
+/** Bytes of a TLS session fingerprint (SHA-256) */
+#define NTRIP_TLS_FINGERPRINT_SIZE 32
+
+/**
+ * @brief Fingerprint the session of an established TLS 1.2 connection.
+ *
+ * The fingerprint is a SHA-256 digest of the session master secret: a resumed
+ * session keeps its master secret, a full handshake derives a new one, so equal
+ * fingerprints of two connections mean the second one resumed the session. The
+ * master secret itself is not copied.
+ *
+ * mbedtls has no public accessor for the master secret; this is the only place
+ * that reads private mbedtls fields, and only for the mbedtls 3.x layout.
+ *
+ * @param tls Connected esp_tls handle.
+ * @param fingerprint Receives NTRIP_TLS_FINGERPRINT_SIZE bytes.
+ * @return true on success, false when not available (TLS 1.3, other mbedtls version).
+ */
+bool ntripTlsSessionFingerprint(esp_tls_t* tls, uint8_t* fingerprint);
+
+#endif // NTRIPTLSSESSION_H
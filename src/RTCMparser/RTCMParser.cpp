@@ -0,0 +1,235 @@
+#include "RTCMParser.h"
+#include "../lib/CRC24Q.h"
+#include <string.h>
+
+#define RTCM_PREAMBLE   0xD3
+
+/**
+ * @brief Read up to 32 bits MSB first from a byte buffer.
+ * @param buffer Source buffer.
+ * @param pos Bit position of the first bit.
+ * @param len Number of bits (1..32).
+ * @return Extracted unsigned value.
+ */
+static uint32_t getBits(const uint8_t* buffer, size_t pos, size_t len) {
+    uint32_t value = 0;
+    for (size_t i = pos; i < pos + len; i++) {
+        value = (value << 1) | ((buffer[i / 8] >> (7 - i % 8)) & 0x01);
+    }
+    return value;
+}
+
+/**
+ * @brief Count set bits in a 64 bit mask.
+ */
+static uint8_t countBits(uint64_t mask) {
+    uint8_t count = 0;
+    while (mask) {
+        mask &= mask - 1;
+        count++;
+    }
+    return count;
+}
+
+RTCMParser::RTCMParser()
+    : frameCallback(NULL),
+      callbackContext(NULL),
+      frameCount(0),
+      crcErrorCount(0),
+      discardedBytes(0) {
+    reset();
+}
+
+void RTCMParser::setFrameCallback(FrameCallback callback, void* context) {
+    frameCallback = callback;
+    callbackContext = context;
+}
+
+void RTCMParser::reset() {
+    state = STATE_PREAMBLE;
+    crc = 0;
+    payloadLength = 0;
+    payloadPos = 0;
+    lengthHigh = 0;
+    crcPos = 0;
+    memset(crcBytes, 0, sizeof(crcBytes));
+    memset(header, 0, sizeof(header));
+    memset(epochActive, 0, sizeof(epochActive));
+    memset(epochTime, 0, sizeof(epochTime));
+    memset(epochSatMask, 0, sizeof(epochSatMask));
+    memset(epochSigMask, 0, sizeof(epochSigMask));
+}
+
+RTCMConstellation RTCMParser::classifyMessage(uint16_t messageType, uint8_t* msmType) {
+    RTCMConstellation constellation = RTCM_CONST_NONE;
+    uint16_t base = 0;
+
+    if (messageType >= 1071 && messageType <= 1077) {
+        constellation = RTCM_CONST_GPS;
+        base = 1070;
+    } else if (messageType >= 1081 && messageType <= 1087) {
+        constellation = RTCM_CONST_GLONASS;
+        base = 1080;
+    } else if (messageType >= 1091 && messageType <= 1097) {
+        constellation = RTCM_CONST_GALILEO;
+        base = 1090;
+    } else if (messageType >= 1121 && messageType <= 1127) {
+        constellation = RTCM_CONST_BEIDOU;
+        base = 1120;
+    }
+
+    if (constellation != RTCM_CONST_NONE && msmType != NULL) {
+        *msmType = (uint8_t)(messageType - base);
+    }
+    return constellation;
+}
+
+size_t RTCMParser::parse(const uint8_t* data, size_t length) {
+    size_t frames = 0;
+    size_t i = 0;
+
+    if (data == NULL) {
+        return 0;
+    }
+
+    while (i < length) {
+        switch (state) {
+            case STATE_PREAMBLE: {
+                // Skip to the next preamble candidate in one step
+                const uint8_t* found = (const uint8_t*)memchr(data + i, RTCM_PREAMBLE, length - i);
+                if (found == NULL) {
+                    discardedBytes += length - i;
+                    i = length;
+                    break;
+                }
+                discardedBytes += (uint32_t)(found - (data + i));
+                i = (size_t)(found - data);
+                crc = updateCRC24Q(0, data + i, 1);
+                i++;
+                state = STATE_LENGTH_HIGH;
+                break;
+            }
+
+            case STATE_LENGTH_HIGH:
+                if (data[i] & 0xFC) {
+                    // Reserved bits must be zero: false preamble, rescan this byte
+                    discardedBytes++;
+                    state = STATE_PREAMBLE;
+                    break;
+                }
+                lengthHigh = data[i];
+                crc = updateCRC24Q(crc, data + i, 1);
+                i++;
+                state = STATE_LENGTH_LOW;
+                break;
+
+            case STATE_LENGTH_LOW:
+                payloadLength = (uint16_t)(((lengthHigh & 0x03) << 8) | data[i]);
+                payloadPos = 0;
+                crcPos = 0;
+                crc = updateCRC24Q(crc, data + i, 1);
+                i++;
+                state = (payloadLength > 0) ? STATE_PAYLOAD : STATE_CRC;
+                break;
+
+            case STATE_PAYLOAD: {
+                // Consume as much of the payload as this chunk holds
+                size_t chunk = length - i;
+                size_t remaining = payloadLength - payloadPos;
+                if (chunk > remaining) {
+                    chunk = remaining;
+                }
+                if (payloadPos < RTCM_MSM_HEADER_BYTES) {
+                    size_t keep = RTCM_MSM_HEADER_BYTES - payloadPos;
+                    if (keep > chunk) {
+                        keep = chunk;
+                    }
+                    memcpy(header + payloadPos, data + i, keep);
+                }
+                crc = updateCRC24Q(crc, data + i, chunk);
+                payloadPos += (uint16_t)chunk;
+                i += chunk;
+                if (payloadPos >= payloadLength) {
+                    state = STATE_CRC;
+                }
+                break;
+            }
+
+            case STATE_CRC:
+                crcBytes[crcPos++] = data[i++];
+                if (crcPos == 3) {
+                    uint32_t received = ((uint32_t)crcBytes[0] << 16) |
+                                        ((uint32_t)crcBytes[1] << 8) |
+                                        crcBytes[2];
+                    if (received == crc) {
+                        frameCount++;
+                        frames++;
+                        completeFrame();
+                    } else {
+                        crcErrorCount++;
+                        discardedBytes += 3 + payloadLength + 3;
+                    }
+                    state = STATE_PREAMBLE;
+                }
+                break;
+        }
+    }
+
+    return frames;
+}
+
+void RTCMParser::completeFrame() {
+    RTCMFrameInfo info;
+    memset(&info, 0, sizeof(info));
+    info.length = payloadLength;
+    info.msm.constellation = RTCM_CONST_NONE;
+
+    if (payloadLength >= 2) {
+        info.messageType = (uint16_t)getBits(header, 0, 12);
+    }
+
+    uint8_t msmType = 0;
+    RTCMConstellation constellation = classifyMessage(info.messageType, &msmType);
+    if (constellation != RTCM_CONST_NONE && payloadLength >= RTCM_MSM_HEADER_BYTES) {
+        info.isMsm = decodeMsmHeader(info.msm, constellation, msmType);
+    }
+
+    if (frameCallback != NULL) {
+        frameCallback(info, callbackContext);
+    }
+}
+
+bool RTCMParser::decodeMsmHeader(RTCMMsmHeader& msm, RTCMConstellation constellation, uint8_t msmType) {
+    // MSM header layout (RTCM 10403.x, table 3.5-78):
+    // type(12) station(12) epoch(30) multiple(1) IODS(3) reserved(7)
+    // clock steering(2) ext clock(2) smoothing(1) smoothing interval(3)
+    // satellite mask(64) signal mask(32) cell mask(...)
+    msm.constellation = constellation;
+    msm.msmType = msmType;
+    msm.stationId = (uint16_t)getBits(header, 12, 12);
+    msm.epochTime = getBits(header, 24, 30);
+    msm.multipleMessage = getBits(header, 54, 1) != 0;
+    msm.satelliteMask = ((uint64_t)getBits(header, 73, 32) << 32) | getBits(header, 105, 32);
+    msm.signalMask = getBits(header, 137, 32);
+    msm.satellites = countBits(msm.satelliteMask);
+    msm.signals = countBits(msm.signalMask);
+
+    // Accumulate masks over all messages of the same epoch; a new epoch
+    // time starts a fresh union even if the previous one never completed.
+    if (!epochActive[constellation] || epochTime[constellation] != msm.epochTime) {
+        epochActive[constellation] = true;
+        epochTime[constellation] = msm.epochTime;
+        epochSatMask[constellation] = 0;
+        epochSigMask[constellation] = 0;
+    }
+    epochSatMask[constellation] |= msm.satelliteMask;
+    epochSigMask[constellation] |= msm.signalMask;
+
+    msm.epochSatellites = countBits(epochSatMask[constellation]);
+    msm.epochSignals = countBits(epochSigMask[constellation]);
+    msm.epochComplete = !msm.multipleMessage;
+    if (msm.epochComplete) {
+        epochActive[constellation] = false;
+    }
+    return true;
+}
@@ -0,0 +1,148 @@
+#ifndef RTCMPARSER_H
+#define RTCMPARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief GNSS constellations whose MSM messages are decoded.
+ *
+ * The order matches the per-constellation arrays in the statistics module.
+ */
+enum RTCMConstellation {
+    RTCM_CONST_GPS = 0,     /**< GPS MSM (1071-1077) */
+    RTCM_CONST_GLONASS,     /**< GLONASS MSM (1081-1087) */
+    RTCM_CONST_GALILEO,     /**< Galileo MSM (1091-1097) */
+    RTCM_CONST_BEIDOU,      /**< BeiDou MSM (1121-1127) */
+    RTCM_CONST_NONE         /**< Not an MSM message of a tracked constellation */
+};
+
+/**
+ * @brief Decoded MSM header (satellite and signal masks only, no observables).
+ */
+struct RTCMMsmHeader {
+    RTCMConstellation constellation; /**< Constellation of the message */
+    uint8_t msmType;                 /**< MSM type 1..7 (MSM4 = 4, MSM7 = 7) */
+    uint16_t stationId;              /**< Reference station ID */
+    uint32_t epochTime;              /**< GNSS epoch time (30 bits, constellation specific) */
+    bool multipleMessage;            /**< More MSM messages follow for this epoch */
+    uint64_t satelliteMask;          /**< 64 bit satellite mask (bit 63 = satellite 1) */
+    uint32_t signalMask;             /**< 32 bit signal mask (bit 31 = signal 1) */
+    uint8_t satellites;              /**< Satellites in this message */
+    uint8_t signals;                 /**< Signal types in this message */
+    bool epochComplete;              /**< Last message of the epoch for this constellation */
+    uint8_t epochSatellites;         /**< Satellites in the epoch so far (union of all messages) */
+    uint8_t epochSignals;            /**< Signal types in the epoch so far (union of all messages) */
+};
+
+/**
+ * @brief Information about one CRC-valid RTCM 3.x frame.
+ */
+struct RTCMFrameInfo {
+    uint16_t messageType;   /**< RTCM message number (0 for an empty frame) */
+    uint16_t length;        /**< Payload length in bytes (0..1023) */
+    bool isMsm;             /**< True if msm holds a decoded MSM header */
+    RTCMMsmHeader msm;      /**< MSM header, valid when isMsm is true */
+};
+
+/**
+ * @brief Streaming RTCM 3.x framer with MSM header decoding.
+ *
+ * Bytes are fed in arbitrary chunks as they arrive from the caster. The
+ * framer locates the 0xD3 preamble, tracks the 10 bit length and computes
+ * the CRC-24Q incrementally over the bytes as they pass. Only the first
+ * RTCM_MSM_HEADER_BYTES of each payload are retained for header decoding,
+ * so message payloads are never copied or buffered.
+ *
+ * A frame that fails the CRC check is counted and discarded; the framer
+ * then searches for the next preamble after the failed frame.
+ */
+class RTCMParser {
+public:
+    /**
+     * @brief Callback invoked for every CRC-valid frame.
+     * @param info Frame information (only valid during the call).
+     * @param context User context passed to setFrameCallback().
+     */
+    typedef void (*FrameCallback)(const RTCMFrameInfo& info, void* context);
+
+    /** Number of payload bytes needed to decode an MSM header (169 bits). */
+    static const size_t RTCM_MSM_HEADER_BYTES = 22;
+
+    RTCMParser();
+
+    /**
+     * @brief Register the frame callback.
+     * @param callback Function to call for each valid frame (may be NULL).
+     * @param context User context passed to the callback.
+     */
+    void setFrameCallback(FrameCallback callback, void* context);
+
+    /**
+     * @brief Reset framing and epoch state, e.g. after a reconnect.
+     *
+     * Counters are preserved.
+     */
+    void reset();
+
+    /**
+     * @brief Feed received bytes into the framer.
+     * @param data Received bytes.
+     * @param length Number of bytes.
+     * @return Number of CRC-valid frames completed within this call.
+     */
+    size_t parse(const uint8_t* data, size_t length);
+
+    /** @brief Total CRC-valid frames since construction. */
+    uint32_t getFrameCount() const { return frameCount; }
+
+    /** @brief Total frames rejected because of a CRC mismatch. */
+    uint32_t getCrcErrorCount() const { return crcErrorCount; }
+
+    /** @brief Total bytes skipped while searching for a preamble or in failed frames. */
+    uint32_t getDiscardedBytes() const { return discardedBytes; }
+
+    /**
+     * @brief Map an RTCM message number to its MSM constellation and type.
+     * @param messageType RTCM message number.
+     * @param msmType Receives the MSM type (1..7) when the message is MSM.
+     * @return Constellation, or RTCM_CONST_NONE if not a tracked MSM message.
+     */
+    static RTCMConstellation classifyMessage(uint16_t messageType, uint8_t* msmType);
+
+private:
+    enum State {
+        STATE_PREAMBLE,
+        STATE_LENGTH_HIGH,
+        STATE_LENGTH_LOW,
+        STATE_PAYLOAD,
+        STATE_CRC
+    };
+
+    State state;
+    uint32_t crc;
+    uint16_t payloadLength;
+    uint16_t payloadPos;
+    uint8_t lengthHigh;
+    uint8_t crcBytes[3];
+    uint8_t crcPos;
+    uint8_t header[RTCM_MSM_HEADER_BYTES];
+
+    // Per constellation epoch accumulation across multiple message bit
+    bool epochActive[RTCM_CONST_NONE];
+    uint32_t epochTime[RTCM_CONST_NONE];
+    uint64_t epochSatMask[RTCM_CONST_NONE];
+    uint32_t epochSigMask[RTCM_CONST_NONE];
+
+    FrameCallback frameCallback;
+    void* callbackContext;
+
+    uint32_t frameCount;
+    uint32_t crcErrorCount;
+    uint32_t discardedBytes;
+
+    void completeFrame();
+    bool decodeMsmHeader(RTCMMsmHeader& msm, RTCMConstellation constellation, uint8_t msmType);
+};
+
+#endif // RTCMPARSER_H
@@ -11,6 +11,9 @@ static const char* TAG = "ConfigManager";
 #define NVS_NAMESPACE_WIFI   "wifi"
 #define NVS_NAMESPACE_NTRIP  "ntrip"
 #define NVS_NAMESPACE_MQTT   "mqtt"
+#define NVS_NAMESPACE_CASTER "caster"
+#define NVS_NAMESPACE_NMEA_SERVER "nmea_server"
+#define NVS_NAMESPACE_DATA_OUTPUT "data_output"
 
 
 
@@ -41,7 +44,10 @@ static const app_config_t default_config = {
         .password = "password",
         .gga_interval_sec = 120,
         .reconnect_delay_sec = 5,
-        .enabled = false  // Disabled by default until configured
+        .enabled = false,  // Disabled by default until configured
+        .use_tls = false,
+        .gga_distance_m = 100,
+        .gga_min_interval_sec = 10
     },
     .mqtt = {
         .broker = "mqtt.example.com",
@@ -52,7 +58,51 @@ static const app_config_t default_config = {
         .gnss_interval_sec = 10,
         .status_interval_sec = 120,
         .stats_interval_sec = 60,
+        .enabled = false,  // Disabled by default until configured
+        .gnss_encoding = MQTT_ENCODING_JSON,
+        .status_encoding = MQTT_ENCODING_JSON,
+        .stats_encoding = MQTT_ENCODING_JSON,
+        .gnss_batch_size = 1,
+        .gnss_batch_ms = 1000,
+        .gnss_interval_ms = 0,
+        .gnss_every_n = 0,
+        .gnss_deadband_m = 0,
+        .gnss_heartbeat_sec = 300,
+        .gnss_simplify_cm = 0,
+        .outbox_enabled = false,
+        .outbox_rate = 5,
+        .gnss_qos = 0,
+        .status_qos = 0,
+        .stats_qos = 0,
+        .qos_window = 4,
+        .qos_queue_kb = 16
+    },
+    .caster = {
+        .port = 2101,
+        .mountpoint = "ESP32",
+        .user = "",
+        .password = "",
+        .max_clients = 8,
         .enabled = false  // Disabled by default until configured
+    },
+    .nmea_server = {
+        .tcp_port = 10110,
+        .max_clients = 4,
+        .tcp_enabled = false,
+        .udp_port = 10110,
+        .udp_enabled = false
+    },
+    .data_output = {
+        .format = DATA_OUTPUT_FORMAT_CSV,
+        .interval_ms = 0,
+        .baud_rate = 115200,
+        .predict = DATA_OUTPUT_PREDICT_OFF,
+        .uart_enabled = true,
+        .uart2_enabled = false,
+        .udp_enabled = false,
+        .udp_port = 10111,
+        .tcp_enabled = false,
+        .tcp_port = 10111
     }
 };
 
@@ -212,12 +262,19 @@ static esp_err_t nvs_load_ntrip(ntrip_config_t* config) {
 
     nvs_get_u16(handle, "gga_interval", &config->gga_interval_sec);
     nvs_get_u16(handle, "reconnect_delay", &config->reconnect_delay_sec);
+    nvs_get_u16(handle, "gga_distance", &config->gga_distance_m);
+    nvs_get_u16(handle, "gga_min_int", &config->gga_min_interval_sec);
 
     uint8_t enabled;
     if (nvs_get_u8(handle, "enabled", &enabled) == ESP_OK) {
         config->enabled = (enabled != 0);
     }
 
+    uint8_t use_tls;
+    if (nvs_get_u8(handle, "use_tls", &use_tls) == ESP_OK) {
+        config->use_tls = (use_tls != 0);
+    }
+
     nvs_close(handle);
     ESP_LOGI(TAG, "NTRIP config loaded from NVS");
     return ESP_OK;
@@ -243,7 +300,10 @@ static esp_err_t nvs_save_ntrip(const ntrip_config_t* config) {
     nvs_set_str(handle, "password", config->password);
     nvs_set_u16(handle, "gga_interval", config->gga_interval_sec);
     nvs_set_u16(handle, "reconnect_delay", config->reconnect_delay_sec);
+    nvs_set_u16(handle, "gga_distance", config->gga_distance_m);
+    nvs_set_u16(handle, "gga_min_int", config->gga_min_interval_sec);
     nvs_set_u8(handle, "enabled", config->enabled ? 1 : 0);
+    nvs_set_u8(handle, "use_tls", config->use_tls ? 1 : 0);
 
     err = nvs_commit(handle);
     if (err != ESP_OK) {
@@ -291,6 +351,28 @@ static esp_err_t nvs_load_mqtt(mqtt_config_t* config) {
         config->enabled = (enabled != 0);
     }
 
+    nvs_get_u8(handle, "gnss_enc", &config->gnss_encoding);
+    nvs_get_u8(handle, "status_enc", &config->status_encoding);
+    nvs_get_u8(handle, "stats_enc", &config->stats_encoding);
+    nvs_get_u8(handle, "gnss_batch", &config->gnss_batch_size);
+    nvs_get_u16(handle, "gnss_batch_ms", &config->gnss_batch_ms);
+    nvs_get_u16(handle, "gnss_int_ms", &config->gnss_interval_ms);
+    nvs_get_u8(handle, "gnss_every_n", &config->gnss_every_n);
+    nvs_get_u16(handle, "gnss_deadband", &config->gnss_deadband_m);
+    nvs_get_u16(handle, "gnss_heartbeat", &config->gnss_heartbeat_sec);
+    nvs_get_u16(handle, "gnss_simplify", &config->gnss_simplify_cm);
+
+    uint8_t outbox_enabled;
+    if (nvs_get_u8(handle, "outbox_en", &outbox_enabled) == ESP_OK) {
+        config->outbox_enabled = (outbox_enabled != 0);
+    }
+    nvs_get_u16(handle, "outbox_rate", &config->outbox_rate);
+    nvs_get_u8(handle, "gnss_qos", &config->gnss_qos);
+    nvs_get_u8(handle, "status_qos", &config->status_qos);
+    nvs_get_u8(handle, "stats_qos", &config->stats_qos);
+    nvs_get_u8(handle, "qos_window", &config->qos_window);
+    nvs_get_u8(handle, "qos_queue_kb", &config->qos_queue_kb);
+
     nvs_close(handle);
     ESP_LOGI(TAG, "MQTT config loaded from NVS");
     return ESP_OK;
@@ -318,6 +400,23 @@ static esp_err_t nvs_save_mqtt(const mqtt_config_t* config) {
     nvs_set_u16(handle, "status_interval", config->status_interval_sec);
     nvs_set_u16(handle, "stats_interval", config->stats_interval_sec);
     nvs_set_u8(handle, "enabled", config->enabled ? 1 : 0);
+    nvs_set_u8(handle, "gnss_enc", config->gnss_encoding);
+    nvs_set_u8(handle, "status_enc", config->status_encoding);
+    nvs_set_u8(handle, "stats_enc", config->stats_encoding);
+    nvs_set_u8(handle, "gnss_batch", config->gnss_batch_size);
+    nvs_set_u16(handle, "gnss_batch_ms", config->gnss_batch_ms);
+    nvs_set_u16(handle, "gnss_int_ms", config->gnss_interval_ms);
+    nvs_set_u8(handle, "gnss_every_n", config->gnss_every_n);
+    nvs_set_u16(handle, "gnss_deadband", config->gnss_deadband_m);
+    nvs_set_u16(handle, "gnss_heartbeat", config->gnss_heartbeat_sec);
+    nvs_set_u16(handle, "gnss_simplify", config->gnss_simplify_cm);
+    nvs_set_u8(handle, "outbox_en", config->outbox_enabled ? 1 : 0);
+    nvs_set_u16(handle, "outbox_rate", config->outbox_rate);
+    nvs_set_u8(handle, "gnss_qos", config->gnss_qos);
+    nvs_set_u8(handle, "status_qos", config->status_qos);
+    nvs_set_u8(handle, "stats_qos", config->stats_qos);
+    nvs_set_u8(handle, "qos_window", config->qos_window);
+    nvs_set_u8(handle, "qos_queue_kb", config->qos_queue_kb);
 
     err = nvs_commit(handle);
     if (err != ESP_OK) {
@@ -329,6 +428,226 @@ static esp_err_t nvs_save_mqtt(const mqtt_config_t* config) {
     return err;
 }
 
+/**
+ * @brief Load local caster configuration from NVS
+ */
+static esp_err_t nvs_load_caster(caster_config_t* config) {
+    nvs_handle_t handle;
+    esp_err_t err;
+
+    err = nvs_open(NVS_NAMESPACE_CASTER, NVS_READONLY, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Caster config not found in NVS, using defaults");
+        return err;
+    }
+
+    nvs_get_u16(handle, "port", &config->port);
+
+    size_t size = sizeof(config->mountpoint);
+    nvs_get_str(handle, "mountpoint", config->mountpoint, &size);
+
+    size = sizeof(config->user);
+    nvs_get_str(handle, "user", config->user, &size);
+
+    size = sizeof(config->password);
+    nvs_get_str(handle, "password", config->password, &size);
+
+    nvs_get_u8(handle, "max_clients", &config->max_clients);
+    if (config->max_clients == 0 || config->max_clients > CASTER_MAX_CLIENTS) {
+        config->max_clients = default_config.caster.max_clients;
+    }
+
+    uint8_t enabled;
+    if (nvs_get_u8(handle, "enabled", &enabled) == ESP_OK) {
+        config->enabled = (enabled != 0);
+    }
+
+    nvs_close(handle);
+    ESP_LOGI(TAG, "Caster config loaded from NVS");
+    return ESP_OK;
+}
+
+/**
+ * @brief Save local caster configuration to NVS
+ */
+static esp_err_t nvs_save_caster(const caster_config_t* config) {
+    nvs_handle_t handle;
+    esp_err_t err;
+
+    err = nvs_open(NVS_NAMESPACE_CASTER, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS for caster config: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    nvs_set_u16(handle, "port", config->port);
+    nvs_set_str(handle, "mountpoint", config->mountpoint);
+    nvs_set_str(handle, "user", config->user);
+    nvs_set_str(handle, "password", config->password);
+    nvs_set_u8(handle, "max_clients", config->max_clients);
+    nvs_set_u8(handle, "enabled", config->enabled ? 1 : 0);
+
+    err = nvs_commit(handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to commit caster config to NVS: %s", esp_err_to_name(err));
+    }
+
+    nvs_close(handle);
+    ESP_LOGI(TAG, "Caster config saved to NVS");
+    return err;
+}
+
+/**
+ * @brief Load NMEA server configuration from NVS
+ */
+static esp_err_t nvs_load_nmea_server(nmea_server_config_t* config) {
+    nvs_handle_t handle;
+    esp_err_t err;
+
+    err = nvs_open(NVS_NAMESPACE_NMEA_SERVER, NVS_READONLY, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "NMEA server config not found in NVS, using defaults");
+        return err;
+    }
+
+    nvs_get_u16(handle, "tcp_port", &config->tcp_port);
+    nvs_get_u16(handle, "udp_port", &config->udp_port);
+
+    nvs_get_u8(handle, "max_clients", &config->max_clients);
+    if (config->max_clients == 0 || config->max_clients > NMEA_SERVER_MAX_CLIENTS) {
+        config->max_clients = default_config.nmea_server.max_clients;
+    }
+
+    uint8_t enabled;
+    if (nvs_get_u8(handle, "tcp_enabled", &enabled) == ESP_OK) {
+        config->tcp_enabled = (enabled != 0);
+    }
+    if (nvs_get_u8(handle, "udp_enabled", &enabled) == ESP_OK) {
+        config->udp_enabled = (enabled != 0);
+    }
+
+    nvs_close(handle);
+    ESP_LOGI(TAG, "NMEA server config loaded from NVS");
+    return ESP_OK;
+}
+
+/**
+ * @brief Save NMEA server configuration to NVS
+ */
+static esp_err_t nvs_save_nmea_server(const nmea_server_config_t* config) {
+    nvs_handle_t handle;
+    esp_err_t err;
+
+    err = nvs_open(NVS_NAMESPACE_NMEA_SERVER, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS for NMEA server config: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    nvs_set_u16(handle, "tcp_port", config->tcp_port);
+    nvs_set_u16(handle, "udp_port", config->udp_port);
+    nvs_set_u8(handle, "max_clients", config->max_clients);
+    nvs_set_u8(handle, "tcp_enabled", config->tcp_enabled ? 1 : 0);
+    nvs_set_u8(handle, "udp_enabled", config->udp_enabled ? 1 : 0);
+
+    err = nvs_commit(handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to commit NMEA server config to NVS: %s", esp_err_to_name(err));
+    }
+
+    nvs_close(handle);
+    ESP_LOGI(TAG, "NMEA server config saved to NVS");
+    return err;
+}
+
+/**
+ * @brief Load telemetry data output configuration from NVS
+ */
+static esp_err_t nvs_load_data_output(telemetry_output_config_t* config) {
+    nvs_handle_t handle;
+    esp_err_t err;
+
+    err = nvs_open(NVS_NAMESPACE_DATA_OUTPUT, NVS_READONLY, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Data output config not found in NVS, using defaults");
+        return err;
+    }
+
+    nvs_get_u8(handle, "format", &config->format);
+    if (config->format > DATA_OUTPUT_FORMAT_BINARY) {
+        config->format = default_config.data_output.format;
+    }
+    nvs_get_u16(handle, "interval_ms", &config->interval_ms);
+    nvs_get_u32(handle, "baud", &config->baud_rate);
+    if (!config_data_output_baud_valid(config->baud_rate)) {
+        config->baud_rate = default_config.data_output.baud_rate;
+    }
+    nvs_get_u8(handle, "predict", &config->predict);
+    if (config->predict > DATA_OUTPUT_PREDICT_CTRV) {
+        config->predict = default_config.data_output.predict;
+    }
+
+    uint8_t enabled;
+    if (nvs_get_u8(handle, "uart_en", &enabled) == ESP_OK) {
+        config->uart_enabled = (enabled != 0);
+    }
+    if (nvs_get_u8(handle, "uart2_en", &enabled) == ESP_OK) {
+        config->uart2_enabled = (enabled != 0);
+    }
+    if (nvs_get_u8(handle, "udp_en", &enabled) == ESP_OK) {
+        config->udp_enabled = (enabled != 0);
+    }
+    if (nvs_get_u8(handle, "tcp_en", &enabled) == ESP_OK) {
+        config->tcp_enabled = (enabled != 0);
+    }
+    nvs_get_u16(handle, "udp_port", &config->udp_port);
+    if (config->udp_port == 0) {
+        config->udp_port = default_config.data_output.udp_port;
+    }
+    nvs_get_u16(handle, "tcp_port", &config->tcp_port);
+    if (config->tcp_port == 0) {
+        config->tcp_port = default_config.data_output.tcp_port;
+    }
+
+    nvs_close(handle);
+    ESP_LOGI(TAG, "Data output config loaded from NVS");
+    return ESP_OK;
+}
+
+/**
+ * @brief Save telemetry data output configuration to NVS
+ */
+static esp_err_t nvs_save_data_output(const telemetry_output_config_t* config) {
+    nvs_handle_t handle;
+    esp_err_t err;
+
+    err = nvs_open(NVS_NAMESPACE_DATA_OUTPUT, NVS_READWRITE, &handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS for data output config: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    nvs_set_u8(handle, "format", config->format);
+    nvs_set_u16(handle, "interval_ms", config->interval_ms);
+    nvs_set_u32(handle, "baud", config->baud_rate);
+    nvs_set_u8(handle, "predict", config->predict);
+    nvs_set_u8(handle, "uart_en", config->uart_enabled ? 1 : 0);
+    nvs_set_u8(handle, "uart2_en", config->uart2_enabled ? 1 : 0);
+    nvs_set_u8(handle, "udp_en", config->udp_enabled ? 1 : 0);
+    nvs_set_u16(handle, "udp_port", config->udp_port);
+    nvs_set_u8(handle, "tcp_en", config->tcp_enabled ? 1 : 0);
+    nvs_set_u16(handle, "tcp_port", config->tcp_port);
+
+    err = nvs_commit(handle);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to commit data output config to NVS: %s", esp_err_to_name(err));
+    }
+
+    nvs_close(handle);
+    ESP_LOGI(TAG, "Data output config saved to NVS");
+    return err;
+}
+
 void config_load_defaults(app_config_t* config) {
     memcpy(config, &default_config, sizeof(app_config_t));
     ESP_LOGI(TAG, "Loaded default configuration");
@@ -374,6 +693,9 @@ esp_err_t config_manager_init(void) {
     nvs_load_wifi(&app_config.wifi);
     nvs_load_ntrip(&app_config.ntrip);
     nvs_load_mqtt(&app_config.mqtt);
+    nvs_load_caster(&app_config.caster);
+    nvs_load_nmea_server(&app_config.nmea_server);
+    nvs_load_data_output(&app_config.data_output);
 
     ESP_LOGI(TAG, "Configuration Manager initialized");
     ESP_LOGI(TAG, "  WiFi SSID: %s", app_config.wifi.ssid);
@@ -381,6 +703,20 @@ esp_err_t config_manager_init(void) {
     ESP_LOGI(TAG, "  NTRIP Enabled: %s", app_config.ntrip.enabled ? "Yes" : "No");
     ESP_LOGI(TAG, "  MQTT Broker: %s:%d", app_config.mqtt.broker, app_config.mqtt.port);
     ESP_LOGI(TAG, "  MQTT Enabled: %s", app_config.mqtt.enabled ? "Yes" : "No");
+    ESP_LOGI(TAG, "  Caster Port: %d, Mountpoint: %s", app_config.caster.port, app_config.caster.mountpoint);
+    ESP_LOGI(TAG, "  Caster Enabled: %s", app_config.caster.enabled ? "Yes" : "No");
+    ESP_LOGI(TAG, "  NMEA TCP: %s (port %d), UDP: %s (port %d)",
+             app_config.nmea_server.tcp_enabled ? "Yes" : "No", app_config.nmea_server.tcp_port,
+             app_config.nmea_server.udp_enabled ? "Yes" : "No", app_config.nmea_server.udp_port);
+    ESP_LOGI(TAG, "  Data Output Format: %s, Interval: %u ms (0 = every epoch), Baud: %lu, Prediction: %s",
+             app_config.data_output.format == DATA_OUTPUT_FORMAT_BINARY ? "binary" : "CSV",
+             app_config.data_output.interval_ms, app_config.data_output.baud_rate,
+             config_data_output_predict_name(app_config.data_output.predict));
+    ESP_LOGI(TAG, "  Data Output UART: %s, UART2: %s, UDP: %s (port %d), TCP: %s (port %d)",
+             app_config.data_output.uart_enabled ? "Yes" : "No",
+             app_config.data_output.uart2_enabled ? "Yes" : "No",
+             app_config.data_output.udp_enabled ? "Yes" : "No", app_config.data_output.udp_port,
+             app_config.data_output.tcp_enabled ? "Yes" : "No", app_config.data_output.tcp_port);
 
     return ESP_OK;
 }
@@ -430,6 +766,51 @@ esp_err_t config_get_mqtt(mqtt_config_t* config) {
     return ESP_ERR_TIMEOUT;
 }
 
+esp_err_t config_get_caster(caster_config_t* config) {
+    if (config == NULL || config_mutex == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (xSemaphoreTake(config_mutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
+        memcpy(config, &app_config.caster, sizeof(caster_config_t));
+        xSemaphoreGive(config_mutex);
+        return ESP_OK;
+    }
+
+    ESP_LOGE(TAG, "Failed to acquire mutex for caster config read");
+    return ESP_ERR_TIMEOUT;
+}
+
+esp_err_t config_get_nmea_server(nmea_server_config_t* config) {
+    if (config == NULL || config_mutex == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (xSemaphoreTake(config_mutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
+        memcpy(config, &app_config.nmea_server, sizeof(nmea_server_config_t));
+        xSemaphoreGive(config_mutex);
+        return ESP_OK;
+    }
+
+    ESP_LOGE(TAG, "Failed to acquire mutex for NMEA server config read");
+    return ESP_ERR_TIMEOUT;
+}
+
+esp_err_t config_get_data_output(telemetry_output_config_t* config) {
+    if (config == NULL || config_mutex == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (xSemaphoreTake(config_mutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
+        memcpy(config, &app_config.data_output, sizeof(telemetry_output_config_t));
+        xSemaphoreGive(config_mutex);
+        return ESP_OK;
+    }
+
+    ESP_LOGE(TAG, "Failed to acquire mutex for data output config read");
+    return ESP_ERR_TIMEOUT;
+}
+
 esp_err_t config_get_all(app_config_t* config) {
     if (config == NULL || config_mutex == NULL) {
         return ESP_ERR_INVALID_ARG;
@@ -508,6 +889,82 @@ esp_err_t config_set_ntrip(const ntrip_config_t* config) {
     return ESP_ERR_TIMEOUT;
 }
 
+esp_err_t config_get_ntrip_ca(char* pem, size_t size) {
+    if ((pem != NULL && size == 0) || config_mutex == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (pem != NULL) {
+        pem[0] = '\0';
+    }
+
+    if (xSemaphoreTake(config_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        ESP_LOGE(TAG, "Failed to acquire mutex for NTRIP CA read");
+        return ESP_ERR_TIMEOUT;
+    }
+
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(NVS_NAMESPACE_NTRIP, NVS_READONLY, &handle);
+    if (err == ESP_OK) {
+        // With a NULL buffer nvs_get_str only reports the stored length
+        size_t length = size;
+        err = nvs_get_str(handle, "tls_ca", pem, &length);
+        if (err == ESP_OK && length <= 1) {
+            err = ESP_ERR_NOT_FOUND;
+        }
+        nvs_close(handle);
+    }
+    xSemaphoreGive(config_mutex);
+
+    if (err != ESP_OK) {
+        if (pem != NULL) {
+            pem[0] = '\0';
+        }
+        return ESP_ERR_NOT_FOUND;
+    }
+    return ESP_OK;
+}
+
+esp_err_t config_set_ntrip_ca(const char* pem) {
+    if (pem == NULL || strlen(pem) >= NTRIP_TLS_CA_MAX_LEN || config_mutex == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (xSemaphoreTake(config_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        ESP_LOGE(TAG, "Failed to acquire mutex for NTRIP CA write");
+        return ESP_ERR_TIMEOUT;
+    }
+
+    nvs_handle_t handle;
+    esp_err_t err = nvs_open(NVS_NAMESPACE_NTRIP, NVS_READWRITE, &handle);
+    if (err == ESP_OK) {
+        if (pem[0] == '\0') {
+            err = nvs_erase_key(handle, "tls_ca");
+            if (err == ESP_ERR_NVS_NOT_FOUND) {
+                err = ESP_OK;
+            }
+        } else {
+            err = nvs_set_str(handle, "tls_ca", pem);
+        }
+        if (err == ESP_OK) {
+            err = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+    xSemaphoreGive(config_mutex);
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to save NTRIP CA certificate: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    // Reconnect with the new trust anchor
+    if (config_event_group != NULL) {
+        xEventGroupSetBits(config_event_group, CONFIG_NTRIP_CHANGED_BIT);
+    }
+    ESP_LOGI(TAG, "NTRIP CA certificate %s", pem[0] == '\0' ? "removed, using certificate bundle" : "updated");
+    return ESP_OK;
+}
+
 esp_err_t config_set_ntrip_enabled_runtime(bool enabled) {
     if (config_mutex == NULL) {
         return ESP_ERR_INVALID_STATE;
@@ -582,6 +1039,132 @@ esp_err_t config_set_mqtt_enabled_runtime(bool enabled) {
     return ESP_ERR_TIMEOUT;
 }
 
+esp_err_t config_set_caster(const caster_config_t* config) {
+    if (config == NULL || config_mutex == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t err = ESP_OK;
+
+    if (xSemaphoreTake(config_mutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
+        // Update in-memory configuration
+        memcpy(&app_config.caster, config, sizeof(caster_config_t));
+        
+        // Save to NVS
+        err = nvs_save_caster(config);
+        
+        xSemaphoreGive(config_mutex);
+
+        // Notify tasks of configuration change
+        if (config_event_group != NULL) {
+            xEventGroupSetBits(config_event_group, CONFIG_CASTER_CHANGED_BIT);
+        }
+
+        if (err == ESP_OK) {
+            ESP_LOGI(TAG, "Caster configuration updated (enabled: %s)", 
+                     config->enabled ? "Yes" : "No");
+        }
+        return err;
+    }
+
+    ESP_LOGE(TAG, "Failed to acquire mutex for caster config write");
+    return ESP_ERR_TIMEOUT;
+}
+
+esp_err_t config_set_nmea_server(const nmea_server_config_t* config) {
+    if (config == NULL || config_mutex == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t err = ESP_OK;
+
+    if (xSemaphoreTake(config_mutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
+        // Update in-memory configuration
+        memcpy(&app_config.nmea_server, config, sizeof(nmea_server_config_t));
+        
+        // Save to NVS
+        err = nvs_save_nmea_server(config);
+        
+        xSemaphoreGive(config_mutex);
+
+        // Notify tasks of configuration change
+        if (config_event_group != NULL) {
+            xEventGroupSetBits(config_event_group, CONFIG_NMEA_SERVER_CHANGED_BIT);
+        }
+
+        if (err == ESP_OK) {
+            ESP_LOGI(TAG, "NMEA server configuration updated (TCP: %s, UDP: %s)", 
+                     config->tcp_enabled ? "Yes" : "No", config->udp_enabled ? "Yes" : "No");
+        }
+        return err;
+    }
+
+    ESP_LOGE(TAG, "Failed to acquire mutex for NMEA server config write");
+    return ESP_ERR_TIMEOUT;
+}
+
+esp_err_t config_set_data_output(const telemetry_output_config_t* config) {
+    if (config == NULL || config_mutex == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t err = ESP_OK;
+
+    if (xSemaphoreTake(config_mutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
+        // Update in-memory configuration
+        memcpy(&app_config.data_output, config, sizeof(telemetry_output_config_t));
+        
+        // Save to NVS
+        err = nvs_save_data_output(config);
+        
+        xSemaphoreGive(config_mutex);
+
+        // Notify tasks of configuration change
+        if (config_event_group != NULL) {
+            xEventGroupSetBits(config_event_group, CONFIG_DATA_OUTPUT_CHANGED_BIT);
+        }
+
+        if (err == ESP_OK) {
+            ESP_LOGI(TAG, "Data output configuration updated (format: %s, interval: %u ms, baud: %lu, prediction: %s)",
+                     config->format == DATA_OUTPUT_FORMAT_BINARY ? "binary" : "CSV",
+                     config->interval_ms, config->baud_rate, config_data_output_predict_name(config->predict));
+        }
+        return err;
+    }
+
+    ESP_LOGE(TAG, "Failed to acquire mutex for data output config write");
+    return ESP_ERR_TIMEOUT;
+}
+
+bool config_data_output_baud_valid(uint32_t baud_rate) {
+    static const uint32_t rates[] = {9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600};
+    for (size_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+        if (rates[i] == baud_rate) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static const char* const predict_names[] = {"off", "cv", "ctrv"};
+
+const char* config_data_output_predict_name(uint8_t predict) {
+    return (predict <= DATA_OUTPUT_PREDICT_CTRV) ? predict_names[predict] : predict_names[DATA_OUTPUT_PREDICT_OFF];
+}
+
+bool config_data_output_predict_parse(const char* name, uint8_t* predict) {
+    if (name == NULL || predict == NULL) {
+        return false;
+    }
+    for (uint8_t i = 0; i <= DATA_OUTPUT_PREDICT_CTRV; i++) {
+        if (strcmp(name, predict_names[i]) == 0) {
+            *predict = i;
+            return true;
+        }
+    }
+    return false;
+}
+
 esp_err_t config_set_all(const app_config_t* config) {
     if (config == NULL || config_mutex == NULL) {
         return ESP_ERR_INVALID_ARG;
@@ -598,12 +1181,18 @@ esp_err_t config_set_all(const app_config_t* config) {
         esp_err_t err_wifi = nvs_save_wifi(&config->wifi);
         esp_err_t err_ntrip = nvs_save_ntrip(&config->ntrip);
         esp_err_t err_mqtt = nvs_save_mqtt(&config->mqtt);
+        esp_err_t err_caster = nvs_save_caster(&config->caster);
+        esp_err_t err_nmea_server = nvs_save_nmea_server(&config->nmea_server);
+        esp_err_t err_data_output = nvs_save_data_output(&config->data_output);
         
         // Return first error encountered
         if (err_ui != ESP_OK) err = err_ui;
         else if (err_wifi != ESP_OK) err = err_wifi;
         else if (err_ntrip != ESP_OK) err = err_ntrip;
         else if (err_mqtt != ESP_OK) err = err_mqtt;
+        else if (err_caster != ESP_OK) err = err_caster;
+        else if (err_nmea_server != ESP_OK) err = err_nmea_server;
+        else if (err_data_output != ESP_OK) err = err_data_output;
         
         xSemaphoreGive(config_mutex);
 
@@ -655,6 +1244,27 @@ esp_err_t config_factory_reset(void) {
         nvs_close(handle);
     }
 
+    err = nvs_open(NVS_NAMESPACE_CASTER, NVS_READWRITE, &handle);
+    if (err == ESP_OK) {
+        nvs_erase_all(handle);
+        nvs_commit(handle);
+        nvs_close(handle);
+    }
+
+    err = nvs_open(NVS_NAMESPACE_NMEA_SERVER, NVS_READWRITE, &handle);
+    if (err == ESP_OK) {
+        nvs_erase_all(handle);
+        nvs_commit(handle);
+        nvs_close(handle);
+    }
+
+    err = nvs_open(NVS_NAMESPACE_DATA_OUTPUT, NVS_READWRITE, &handle);
+    if (err == ESP_OK) {
+        nvs_erase_all(handle);
+        nvs_commit(handle);
+        nvs_close(handle);
+    }
+
     // Load defaults into memory
     if (config_mutex != NULL && xSemaphoreTake(config_mutex, pdMS_TO_TICKS(1000)) == pdTRUE) {
         config_load_defaults(&app_config);
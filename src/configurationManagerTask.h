@@ -11,7 +11,12 @@
 #define CONFIG_WIFI_CHANGED_BIT     (1 << 0)
 #define CONFIG_NTRIP_CHANGED_BIT    (1 << 1)
 #define CONFIG_MQTT_CHANGED_BIT     (1 << 2)
-#define CONFIG_ALL_CHANGED_BIT      (CONFIG_WIFI_CHANGED_BIT | CONFIG_NTRIP_CHANGED_BIT | CONFIG_MQTT_CHANGED_BIT)
+#define CONFIG_CASTER_CHANGED_BIT   (1 << 3)
+#define CONFIG_NMEA_SERVER_CHANGED_BIT (1 << 4)
+#define CONFIG_DATA_OUTPUT_CHANGED_BIT (1 << 5)
+#define CONFIG_ALL_CHANGED_BIT      (CONFIG_WIFI_CHANGED_BIT | CONFIG_NTRIP_CHANGED_BIT | CONFIG_MQTT_CHANGED_BIT | \
+                                     CONFIG_CASTER_CHANGED_BIT | CONFIG_NMEA_SERVER_CHANGED_BIT | \
+                                     CONFIG_DATA_OUTPUT_CHANGED_BIT)
 
 
 // UI configuration structure
@@ -33,11 +38,40 @@ typedef struct {
     char mountpoint[64];
     char user[32];
     char password[64];
-    uint16_t gga_interval_sec;     // Default: 120
+    uint16_t gga_interval_sec;     // Default: 120 (maximum time between GGA uploads)
     uint16_t reconnect_delay_sec;  // Default: 5
     bool enabled;                  // Default: true
+    bool use_tls;                  // Default: false (TLS to the caster, usually port 443)
+    uint16_t gga_distance_m;       // Default: 100 (GGA upload after moving this far, 0 = off)
+    uint16_t gga_min_interval_sec; // Default: 10 (minimum time between GGA uploads)
 } ntrip_config_t;
 
+// Maximum size of a custom CA certificate for the NTRIP caster (PEM, including terminator)
+#define NTRIP_TLS_CA_MAX_LEN        4000
+
+// MQTT payload encodings (per topic)
+#define MQTT_ENCODING_JSON          0
+#define MQTT_ENCODING_CBOR          1
+
+// MQTT GNSS publishing limits
+#define MQTT_GNSS_INTERVAL_MIN_MS   100     // gnss_interval_ms, 0 = gnss_interval_sec
+#define MQTT_GNSS_INTERVAL_MAX_MS   60000
+#define MQTT_GNSS_BATCH_MAX_EPOCHS  32      // gnss_batch_size, 1 = no batching
+#define MQTT_GNSS_BATCH_MIN_MS      100     // gnss_batch_ms
+#define MQTT_GNSS_BATCH_MAX_MS      60000
+#define MQTT_GNSS_DEADBAND_MAX_M    10000   // gnss_deadband_m, 0 = off
+#define MQTT_GNSS_SIMPLIFY_MAX_CM   10000   // gnss_simplify_cm, 0 = off
+
+// MQTT outbox drain rate limits (outbox_rate, messages per second)
+#define MQTT_OUTBOX_RATE_MIN        1
+#define MQTT_OUTBOX_RATE_MAX        100
+
+// MQTT QoS 1 pipeline limits (qos_window, qos_queue_kb)
+#define MQTT_QOS_WINDOW_MIN         1
+#define MQTT_QOS_WINDOW_MAX         16
+#define MQTT_QOS_QUEUE_MIN_KB       2
+#define MQTT_QOS_QUEUE_MAX_KB       64
+
 // MQTT configuration structure
 typedef struct {
     char broker[128];
@@ -49,14 +83,89 @@ typedef struct {
     uint16_t status_interval_sec;  // Default: 120
     uint16_t stats_interval_sec;   // Default: 60
     bool enabled;                  // Default: true
+    uint8_t gnss_encoding;         // Default: MQTT_ENCODING_JSON
+    uint8_t status_encoding;       // Default: MQTT_ENCODING_JSON
+    uint8_t stats_encoding;        // Default: MQTT_ENCODING_JSON
+    uint8_t gnss_batch_size;       // Default: 1 (epochs per GNSS message, 1 = no batching, max 32)
+    uint16_t gnss_batch_ms;        // Default: 1000 (longest wait of a batched epoch, 100-60000)
+    uint16_t gnss_interval_ms;     // Default: 0 (sub-second GNSS interval, 100-60000; 0 = gnss_interval_sec)
+    uint8_t gnss_every_n;          // Default: 0 (publish every Nth GNSS epoch instead of an interval; 0 = off)
+    uint16_t gnss_deadband_m;      // Default: 0 (publish GNSS only after moving this far; 0 = off)
+    uint16_t gnss_heartbeat_sec;   // Default: 300 (publish a stationary position at least this often, 1-65535)
+    uint16_t gnss_simplify_cm;     // Default: 0 (batched track simplification tolerance; 0 = off)
+    bool outbox_enabled;           // Default: false (store GNSS messages in flash while disconnected)
+    uint16_t outbox_rate;          // Default: 5 (stored messages drained per second after reconnect, 1-100)
+    uint8_t gnss_qos;              // Default: 0 (MQTT QoS of GNSS messages, 0 or 1)
+    uint8_t status_qos;            // Default: 0 (MQTT QoS of status messages, 0 or 1)
+    uint8_t stats_qos;             // Default: 0 (MQTT QoS of stats messages, 0 or 1)
+    uint8_t qos_window;            // Default: 4 (QoS 1 messages waiting for PUBACK at most, 1-16)
+    uint8_t qos_queue_kb;          // Default: 16 (RAM queue for QoS 1 messages, oldest dropped when full, 2-64)
 } mqtt_config_t;
 
+// Upper limit for concurrent local caster clients (sizes the caster buffers)
+#define CASTER_MAX_CLIENTS          16
+
+// Local NTRIP caster configuration structure
+typedef struct {
+    uint16_t port;                 // Default: 2101
+    char mountpoint[64];           // Default: "ESP32"
+    char user[32];                 // Empty = no authentication
+    char password[64];
+    uint8_t max_clients;           // Default: 8 (upper limit CASTER_MAX_CLIENTS)
+    bool enabled;                  // Default: false
+} caster_config_t;
+
+// Upper limit for concurrent NMEA TCP clients (sizes the NMEA server buffers)
+#define NMEA_SERVER_MAX_CLIENTS     8
+
+// NMEA network server configuration structure
+typedef struct {
+    uint16_t tcp_port;             // Default: 10110
+    uint8_t max_clients;           // Default: 4 (upper limit NMEA_SERVER_MAX_CLIENTS)
+    bool tcp_enabled;              // Default: false
+    uint16_t udp_port;             // Default: 10110
+    bool udp_enabled;              // Default: false (broadcast on all interfaces)
+} nmea_server_config_t;
+
+// Telemetry UART payload formats
+#define DATA_OUTPUT_FORMAT_CSV      0   // ASCII CSV line
+#define DATA_OUTPUT_FORMAT_BINARY   1   // Fixed-layout binary record (lib/TelemetryRecord.h)
+
+// Telemetry output interval limits (0 = one frame per new GNSS epoch)
+#define DATA_OUTPUT_INTERVAL_MIN_MS 20
+#define DATA_OUTPUT_INTERVAL_MAX_MS 60000
+
+// Telemetry position prediction to the transmit time (lib/PositionPredictor.h)
+#define DATA_OUTPUT_PREDICT_OFF     0   // Position of the last epoch
+#define DATA_OUTPUT_PREDICT_CV      1   // Constant velocity
+#define DATA_OUTPUT_PREDICT_CTRV    2   // Constant turn rate and velocity
+
+// Upper limit for concurrent telemetry TCP clients (sizes the output router)
+#define DATA_OUTPUT_TCP_MAX_CLIENTS 4
+
+// Telemetry data output configuration structure (frames go to all enabled sinks)
+typedef struct {
+    uint8_t format;                // Default: DATA_OUTPUT_FORMAT_CSV
+    uint16_t interval_ms;          // Default: 0 (one frame per new GNSS epoch; else interval aligned to GNSS time, 20-60000)
+    uint32_t baud_rate;            // Default: 115200 (9600-921600, see config_data_output_baud_valid())
+    uint8_t predict;               // Default: DATA_OUTPUT_PREDICT_OFF
+    bool uart_enabled;             // Default: true (UART1)
+    bool uart2_enabled;            // Default: false (second UART, boards with TELEMETRY2_UART_NUM only)
+    bool udp_enabled;              // Default: false (broadcast on all interfaces)
+    uint16_t udp_port;             // Default: 10111
+    bool tcp_enabled;              // Default: false (up to DATA_OUTPUT_TCP_MAX_CLIENTS clients)
+    uint16_t tcp_port;             // Default: 10111
+} telemetry_output_config_t;
+
 // Application configuration structure (combined)
 typedef struct {
     ui_config_t ui;
     app_wifi_config_t wifi;
     ntrip_config_t ntrip;
     mqtt_config_t mqtt;
+    caster_config_t caster;
+    nmea_server_config_t nmea_server;
+    telemetry_output_config_t data_output;
 } app_config_t;
 
 /**
@@ -94,6 +203,30 @@ esp_err_t config_get_ntrip(ntrip_config_t* config);
  */
 esp_err_t config_get_mqtt(mqtt_config_t* config);
 
+/**
+ * @brief Get local NTRIP caster configuration (thread-safe)
+ * 
+ * @param config Pointer to caster_config_t structure to fill
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t config_get_caster(caster_config_t* config);
+
+/**
+ * @brief Get NMEA network server configuration (thread-safe)
+ * 
+ * @param config Pointer to nmea_server_config_t structure to fill
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t config_get_nmea_server(nmea_server_config_t* config);
+
+/**
+ * @brief Get telemetry data output configuration (thread-safe)
+ * 
+ * @param config Pointer to telemetry_output_config_t structure to fill
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t config_get_data_output(telemetry_output_config_t* config);
+
 /**
  * @brief Get MQTT configuration (thread-safe) - Compatibility wrapper
  * 
@@ -135,6 +268,29 @@ esp_err_t config_set_wifi(const app_wifi_config_t* config);
 esp_err_t config_set_ntrip(const ntrip_config_t* config);
 esp_err_t config_set_ntrip_enabled_runtime(bool enabled);
 
+/**
+ * @brief Get the custom CA certificate for NTRIP over TLS (thread-safe)
+ * 
+ * @param pem Buffer for the PEM certificate, at least NTRIP_TLS_CA_MAX_LEN bytes,
+ *            or NULL to only check whether a custom CA is stored
+ * @param size Size of the buffer
+ * @return ESP_OK if a custom CA is stored, ESP_ERR_NOT_FOUND if the certificate
+ *         bundle is used (pem is set to an empty string), error code otherwise
+ */
+esp_err_t config_get_ntrip_ca(char* pem, size_t size);
+
+/**
+ * @brief Set or clear the custom CA certificate for NTRIP over TLS (thread-safe)
+ * 
+ * Saves the certificate to NVS and sets CONFIG_NTRIP_CHANGED_BIT event.
+ * An empty string removes the certificate; the built-in certificate bundle
+ * is used again.
+ * 
+ * @param pem PEM certificate, shorter than NTRIP_TLS_CA_MAX_LEN
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t config_set_ntrip_ca(const char* pem);
+
 /**
  * @brief Set MQTT configuration (thread-safe)
  * 
@@ -146,6 +302,61 @@ esp_err_t config_set_ntrip_enabled_runtime(bool enabled);
 esp_err_t config_set_mqtt(const mqtt_config_t* config);
 esp_err_t config_set_mqtt_enabled_runtime(bool enabled);
 
+/**
+ * @brief Set local NTRIP caster configuration (thread-safe)
+ * 
+ * Saves configuration to NVS and sets CONFIG_CASTER_CHANGED_BIT event
+ * 
+ * @param config Pointer to caster_config_t structure with new values
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t config_set_caster(const caster_config_t* config);
+
+/**
+ * @brief Set NMEA network server configuration (thread-safe)
+ * 
+ * Saves configuration to NVS and sets CONFIG_NMEA_SERVER_CHANGED_BIT event
+ * 
+ * @param config Pointer to nmea_server_config_t structure with new values
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t config_set_nmea_server(const nmea_server_config_t* config);
+
+/**
+ * @brief Set telemetry data output configuration (thread-safe)
+ * 
+ * Saves configuration to NVS and sets CONFIG_DATA_OUTPUT_CHANGED_BIT event
+ * 
+ * @param config Pointer to telemetry_output_config_t structure with new values
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t config_set_data_output(const telemetry_output_config_t* config);
+
+/**
+ * @brief Check a telemetry output baud rate
+ *
+ * @param baud_rate Baud rate
+ * @return true for 9600, 19200, 38400, 57600, 115200, 230400, 460800 and 921600
+ */
+bool config_data_output_baud_valid(uint32_t baud_rate);
+
+/**
+ * @brief Name of a telemetry position prediction mode
+ *
+ * @param predict DATA_OUTPUT_PREDICT_*
+ * @return "off", "cv" or "ctrv"
+ */
+const char* config_data_output_predict_name(uint8_t predict);
+
+/**
+ * @brief Parse a telemetry position prediction mode
+ *
+ * @param name "off", "cv" or "ctrv"
+ * @param predict Set to the DATA_OUTPUT_PREDICT_* value
+ * @return true if the name is known
+ */
+bool config_data_output_predict_parse(const char* name, uint8_t* predict);
+
 /**
  * @brief Set complete application configuration (thread-safe)
  * 
@@ -8,21 +8,47 @@
  * Protocol Format:
  * [SOH] [Message Data (stuffed)] [CRC-16 High (stuffed)] [CRC-16 Low (stuffed)] [CAN]
  * 
- * Message Format: YYYY-MM-DD HH:mm:ss.sss,LAT,LON,ALT,HEADING,SPEED
- * Example: 2026-01-10 14:30:52.123,-34.123456,150.987654,123.45,270.15,45.67
+ * Message Format (CSV): YYYY-MM-DD HH:mm:ss.sss,LAT,LON,ALT,HEADING,SPEED,FIXQ
+ * Example: 2026-01-10 14:30:52.123,-34.123456,150.987654,123.45,270.15,45.67,4
+ *
+ * Message Format (binary): fixed 35 byte record, see lib/TelemetryRecord.h
+ *
+ * Scheduling: one frame per new GNSS epoch, or per interval aligned to GNSS
+ * time (lib/EpochScheduler). Without epochs frames are sent on a timer with
+ * the system time.
+ *
+ * Prediction (optional): the position is moved to the time the frame goes
+ * out on the wire (lib/PositionPredictor). With an interval, frames are then
+ * sent on the interval slots of GNSS time instead of on epochs, also faster
+ * than the GNSS rate.
+ *
+ * Sinks: a frame is built once and routed to UART1, the optional second
+ * UART, UDP broadcast and TCP clients (lib/OutputRouter). Every sink has its
+ * own queue and is written without blocking; a sink that falls behind drops
+ * its oldest frames and never delays the others.
  */
 
 #include "dataOutputTask.h"
 #include "gnssReceiverTask.h"
 #include "configurationManagerTask.h"
 #include "hardware_config.h"
-#include "lib/CRC16.h"
+#include "lib/EpochScheduler.h"
+#include "lib/FrameEncoder.h"
+#include "lib/OutputRouter.h"
+#include "lib/P2Quantile.h"
+#include "lib/PositionPredictor.h"
+#include "lib/TelemetryRecord.h"
+#include "statisticsTask.h"
+#include "traceRecorder.h"
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <freertos/event_groups.h>
 #include <driver/uart.h>
 #include <driver/gpio.h>
 #include <esp_log.h>
+#include <esp_timer.h>
+#include "lwip/sockets.h"
+#include <errno.h>
 #include <string.h>
 #include <stdio.h>
 #include <time.h>
@@ -37,38 +63,89 @@ static TaskHandle_t data_output_task_handle = NULL;
 #define OUTPUT_UART_NUM         TELEMETRY_UART_NUM
 #define OUTPUT_TX_PIN           TELEMETRY_TX_PIN
 #define OUTPUT_RX_PIN           TELEMETRY_RX_PIN
-#define OUTPUT_BAUD_RATE        115200
-#define OUTPUT_BUF_SIZE         1024
+#define OUTPUT_RX_BUF_SIZE      256
 
-/**
- * @brief Apply byte stuffing to data
- * 
- * If byte equals SOH, CAN, or DLE, prepend with DLE escape byte
- */
-static size_t stuff_byte(uint8_t byte, uint8_t* output, size_t out_pos) {
-    if (byte == FRAME_SOH || byte == FRAME_CAN || byte == FRAME_DLE) {
-        output[out_pos++] = FRAME_DLE;
-    }
-    output[out_pos++] = byte;
-    return out_pos;
-}
+// Largest payload: the CSV line (the binary record is smaller)
+#define PAYLOAD_MAX_SIZE        140
+#define FRAME_MAX_SIZE          FRAME_ENCODER_MAX_SIZE(PAYLOAD_MAX_SIZE)
+
+// TX ring buffer of the UART driver: one frame on the wire and the next one
+// queued behind it, so the task never waits for the UART
+#define OUTPUT_TX_BUF_SIZE      (2 * FRAME_MAX_SIZE)
+
+// Output router: every frame is copied once into a slot of a shared pool.
+// A UART queues one frame behind its driver ring, UDP two, a TCP client 8
+// (160 ms at 50 Hz, plus the socket send buffer). Stalled clients give up
+// their oldest frames when the pool runs out
+#define ROUTER_POOL_FRAMES      16
+#define ROUTER_MAX_SINKS        (3 + DATA_OUTPUT_TCP_MAX_CLIENTS)
+#define ROUTER_UART_DEPTH       1
+#define ROUTER_UDP_DEPTH        2
+#define ROUTER_TCP_DEPTH        8
+
+#define OUTPUT_DRAIN_MS         20      // Wake-up period while frames are queued
+#define OUTPUT_LISTEN_BACKLOG   2
+#define OUTPUT_RETRY_DELAY_MS   5000    // Retry delay when a socket cannot be opened
+
+static_assert(FRAME_SOH == FrameEncoder::SOH && FRAME_DLE == FrameEncoder::DLE && FRAME_CAN == FrameEncoder::CAN,
+              "Framing bytes of dataOutputTask.h and lib/FrameEncoder.h differ");
+static_assert(TELEMETRY_RECORD_SIZE <= PAYLOAD_MAX_SIZE, "Binary record larger than the payload buffer");
+
+// Output statistics, written by the task only
+static data_output_stats_t output_stats;
+
+// Selects the epochs that are sent and measures latency and jitter
+static EpochScheduler output_scheduler;
+
+// Latency percentiles since boot, without keeping samples
+static P2Quantile latency_p50(0.50f);
+static P2Quantile latency_p99(0.99f);
+
+// Moves positions to the transmit time
+static PositionPredictor output_predictor;
+
+// Sends every frame to the enabled sinks (owned by the task)
+static OutputRouter output_router;
+
+typedef struct {
+    int fd;
+    int sink;
+} output_client_t;
+
+static int uart_sink = -1;
+#ifdef TELEMETRY2_UART_NUM
+static int uart2_sink = -1;
+static bool uart2_installed = false;
+#endif
+static int udp_fd = -1;
+static int udp_sink = -1;
+static uint16_t udp_port = 0;
+static int listen_fd = -1;
+static uint16_t tcp_port = 0;
+static output_client_t tcp_clients[DATA_OUTPUT_TCP_MAX_CLIENTS];
+static data_output_sink_stats_t tcp_closed;     // Counters of closed TCP clients
+static int64_t sink_retry_us = 0;
+
+#define MS_PER_DAY 86400000UL
+
+// Why a frame is sent
+typedef enum {
+    FRAME_FOR_EPOCH,        // GNSS epoch selected by the scheduler
+    FRAME_FOR_SLOT,         // Interval slot of GNSS time, predicted position
+    FRAME_FREE_RUNNING      // Timer while no GNSS epochs arrive
+} frame_reason_t;
 
 /**
- * @brief Build framed telemetry message with CRC-16
- * 
+ * @brief Format the CSV payload
+ *
  * @param pos Position data
- * @param frame Output buffer for framed message
- * @param frame_size Maximum frame buffer size
- * @return Length of framed message, or 0 on error
+ * @param message Output buffer
+ * @param size Output buffer size
+ * @return Payload length, or 0 on error
  */
-static size_t build_telemetry_frame(const position_data_t* pos, uint8_t* frame, size_t frame_size) {
-    if (!pos || !frame || frame_size < 256) {
-        return 0;
-    }
-
+static size_t build_csv_payload(const position_data_t* pos, uint8_t* message, size_t size) {
     // Format message string: YYYY-MM-DD HH:mm:ss.sss,LAT,LON,ALT,HEADING,SPEED,FIXQ
-    char message[140];
-    int msg_len = snprintf(message, sizeof(message),
+    int msg_len = snprintf((char*)message, size,
                           "%04d-%02d-%02d %02d:%02d:%02d.%03d,%.6f,%.6f,%.2f,%.2f,%.2f,%u",
                           2000 + pos->year, pos->month, pos->day,
                           pos->hour, pos->minute, pos->second, pos->millisecond,
@@ -76,45 +153,67 @@ static size_t build_telemetry_frame(const position_data_t* pos, uint8_t* frame,
                           pos->altitude, pos->heading, pos->speed,
                           pos->fix_quality);
 
-    if (msg_len <= 0 || msg_len >= (int)sizeof(message)) {
+    if (msg_len <= 0 || msg_len >= (int)size) {
         ESP_LOGE(TAG, "Failed to format message");
         return 0;
     }
+    return (size_t)msg_len;
+}
 
-    // Calculate CRC-16 over message string
-    uint16_t crc = calculateCRC16((const uint8_t*)message, msg_len);
-    uint8_t crc_high = (crc >> 8) & 0xFF;
-    uint8_t crc_low = crc & 0xFF;
-
-    // Build framed message with byte stuffing
-    size_t pos_out = 0;
-
-    // Start of frame
-    frame[pos_out++] = FRAME_SOH;
+/**
+ * @brief Encode the binary payload (integer fields, no float formatting)
+ *
+ * @param pos Position data
+ * @param message Output buffer
+ * @param size Output buffer size
+ * @return Payload length, or 0 on error
+ */
+static size_t build_binary_payload(const position_data_t* pos, uint8_t* message, size_t size) {
+    uint32_t time_of_day_ms = ((pos->hour * 60u + pos->minute) * 60u + pos->second) * 1000u + pos->millisecond;
+    TelemetryRecord record = TelemetryBinary::quantize(
+        pos->epoch, pos->valid, pos->year, pos->month, pos->day, time_of_day_ms,
+        pos->latitude, pos->longitude, pos->altitude, pos->heading, pos->speed,
+        pos->fix_quality, pos->satellites, pos->hdop, pos->age);
+    return TelemetryBinary::encode(record, message, size);
+}
 
-    // Message data (with stuffing)
-    for (int i = 0; i < msg_len; i++) {
-        pos_out = stuff_byte((uint8_t)message[i], frame, pos_out);
+/**
+ * @brief Build framed telemetry message with CRC-16
+ * 
+ * @param pos Position data
+ * @param format Payload format (DATA_OUTPUT_FORMAT_CSV or DATA_OUTPUT_FORMAT_BINARY)
+ * @param frame Output buffer for framed message
+ * @param frame_size Frame buffer size (FRAME_MAX_SIZE always fits)
+ * @return Length of framed message, or 0 on error
+ */
+static size_t build_telemetry_frame(const position_data_t* pos, uint8_t format, uint8_t* frame, size_t frame_size) {
+    if (!pos || !frame) {
+        return 0;
     }
 
-    // CRC-16 high byte (with stuffing)
-    pos_out = stuff_byte(crc_high, frame, pos_out);
-
-    // CRC-16 low byte (with stuffing)
-    pos_out = stuff_byte(crc_low, frame, pos_out);
-
-    // End of frame
-    frame[pos_out++] = FRAME_CAN;
+    uint8_t message[PAYLOAD_MAX_SIZE];
+    size_t msg_len = (format == DATA_OUTPUT_FORMAT_BINARY)
+                     ? build_binary_payload(pos, message, sizeof(message))
+                     : build_csv_payload(pos, message, sizeof(message));
+    if (msg_len == 0) {
+        return 0;
+    }
 
-    return pos_out;
+    // Byte stuffing and CRC-16 in one pass over the message
+    return FrameEncoder::encode(message, msg_len, frame, frame_size);
 }
 
 /**
- * @brief Initialize UART1 for telemetry output
+ * @brief Initialize a UART for telemetry output
+ *
+ * @param uart_num UART port
+ * @param tx_pin TX GPIO
+ * @param rx_pin RX GPIO (unused, UART_PIN_NO_CHANGE if none)
+ * @param baud_rate Baud rate
  */
-static esp_err_t init_output_uart(void) {
+static esp_err_t init_output_uart(uart_port_t uart_num, int tx_pin, int rx_pin, uint32_t baud_rate) {
     uart_config_t uart_config = {
-        .baud_rate = OUTPUT_BAUD_RATE,
+        .baud_rate = (int)baud_rate,
         .data_bits = UART_DATA_8_BITS,
         .parity = UART_PARITY_DISABLE,
         .stop_bits = UART_STOP_BITS_1,
@@ -125,37 +224,575 @@ static esp_err_t init_output_uart(void) {
     };
 
     // Install UART driver
-    esp_err_t err = uart_driver_install(OUTPUT_UART_NUM, OUTPUT_BUF_SIZE, OUTPUT_BUF_SIZE, 0, NULL, 0);
+    esp_err_t err = uart_driver_install(uart_num, OUTPUT_RX_BUF_SIZE, OUTPUT_TX_BUF_SIZE, 0, NULL, 0);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to install UART driver: %s", esp_err_to_name(err));
         return err;
     }
 
     // Configure UART parameters
-    err = uart_param_config(OUTPUT_UART_NUM, &uart_config);
+    err = uart_param_config(uart_num, &uart_config);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to configure UART: %s", esp_err_to_name(err));
-        uart_driver_delete(OUTPUT_UART_NUM);
+        uart_driver_delete(uart_num);
         return err;
     }
 
     // Set UART pins
-    err = uart_set_pin(OUTPUT_UART_NUM, OUTPUT_TX_PIN, OUTPUT_RX_PIN, 
+    err = uart_set_pin(uart_num, tx_pin, rx_pin, 
                       UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Failed to set UART pins: %s", esp_err_to_name(err));
-        uart_driver_delete(OUTPUT_UART_NUM);
+        uart_driver_delete(uart_num);
         return err;
     }
 
-    ESP_LOGI(TAG, "UART1 initialized: %d baud, TX=GPIO%d, RX=GPIO%d",
-             OUTPUT_BAUD_RATE, OUTPUT_TX_PIN, OUTPUT_RX_PIN);
+    ESP_LOGI(TAG, "UART%d initialized: %lu baud, TX=GPIO%d, RX=GPIO%d",
+             (int)uart_num, baud_rate, tx_pin, rx_pin);
 
     return ESP_OK;
 }
 
+// UTC time of day of the GNSS epoch in milliseconds
+static uint32_t gnss_time_of_day_ms(const gnss_data_t* gnss_data) {
+    return ((gnss_data->hour * 60u + gnss_data->minute) * 60u + gnss_data->second) * 1000u
+           + gnss_data->millisecond;
+}
+
+// Read the output configuration, with the interval and baud rate limited
+static void load_output_config(telemetry_output_config_t* config) {
+    if (config_get_data_output(config) != ESP_OK) {
+        config->format = DATA_OUTPUT_FORMAT_CSV;
+        config->interval_ms = 0;
+        config->baud_rate = 115200;
+        config->predict = DATA_OUTPUT_PREDICT_OFF;
+    }
+    if (config->interval_ms > 0 && config->interval_ms < DATA_OUTPUT_INTERVAL_MIN_MS) {
+        config->interval_ms = DATA_OUTPUT_INTERVAL_MIN_MS;
+    } else if (config->interval_ms > DATA_OUTPUT_INTERVAL_MAX_MS) {
+        config->interval_ms = DATA_OUTPUT_INTERVAL_MAX_MS;
+    }
+    if (!config_data_output_baud_valid(config->baud_rate)) {
+        config->baud_rate = 115200;
+    }
+    if (config->predict > DATA_OUTPUT_PREDICT_CTRV) {
+        config->predict = DATA_OUTPUT_PREDICT_OFF;
+    }
+}
+
+// Every new epoch, or the first epoch of every interval slot of GNSS time
+static void configure_output_scheduler(const telemetry_output_config_t* config) {
+    if (config->interval_ms == 0) {
+        output_scheduler.configure(1, 1);
+    } else {
+        output_scheduler.configure(config->interval_ms, 0);
+    }
+    output_stats.interval_ms = config->interval_ms;
+}
+
+static void configure_output_predictor(const telemetry_output_config_t* config) {
+    output_predictor.configure(config->predict == DATA_OUTPUT_PREDICT_CV ? PREDICTOR_CV : PREDICTOR_CTRV,
+                               DATA_OUTPUT_PREDICT_HORIZON_MS, DATA_OUTPUT_RECEIVER_DELAY_MS);
+    output_predictor.reset();
+    output_stats.predict = config->predict;
+}
+
+// With prediction and an interval frames follow the slots of GNSS time, not the epochs
+static bool output_on_slots(const telemetry_output_config_t* config) {
+    return config->predict != DATA_OUTPUT_PREDICT_OFF && config->interval_ms > 0;
+}
+
+// First interval slot of GNSS time after a local time (restarting at midnight)
+static uint32_t next_slot_after(int64_t local_us, uint32_t interval_ms) {
+    uint32_t slot = (output_predictor.timeOfDayAt(local_us) / interval_ms + 1) * interval_ms;
+    return (slot >= MS_PER_DAY) ? 0 : slot;
+}
+
+// Fill the position from the GNSS data, or from the system time without a fix
+static void fill_position(const gnss_data_t* gnss_data, position_data_t* position) {
+    position->valid = gnss_data->valid;
+    position->latitude = gnss_data->latitude;
+    position->longitude = gnss_data->longitude;
+    position->altitude = gnss_data->altitude;
+    position->heading = gnss_data->heading;
+    position->speed = gnss_data->speed;
+    position->day = gnss_data->day;
+    position->month = gnss_data->month;
+    position->year = gnss_data->year;
+    position->hour = gnss_data->hour;
+    position->minute = gnss_data->minute;
+    position->second = gnss_data->second;
+    position->millisecond = gnss_data->millisecond;
+    position->fix_quality = gnss_data->fix_quality;
+    position->satellites = gnss_data->satellites;
+    position->hdop = gnss_data->hdop;
+    position->age = gnss_data->dgps_age;
+
+    // The epoch counter lets a receiver tell a repeated position from a new one
+    position->epoch = output_scheduler.getEpochs();
+
+    // If no valid data, use default values
+    if (!position->valid) {
+        // Get current system time as fallback
+        struct timeval tv;
+        struct tm timeinfo;
+        gettimeofday(&tv, NULL);
+        localtime_r(&tv.tv_sec, &timeinfo);
+
+        position->day = timeinfo.tm_mday;
+        position->month = timeinfo.tm_mon + 1;
+        position->year = timeinfo.tm_year % 100;
+        position->hour = timeinfo.tm_hour;
+        position->minute = timeinfo.tm_min;
+        position->second = timeinfo.tm_sec;
+        position->millisecond = tv.tv_usec / 1000;
+        position->latitude = 0.0;
+        position->longitude = 0.0;
+        position->altitude = 0.0f;
+        position->heading = 0.0f;
+        position->speed = 0.0f;
+        position->satellites = 0;
+        position->hdop = 0.0f;
+        position->age = 0.0f;
+    }
+}
+
+// Replace position and time by the prediction for the transmit time
+static void predict_position(position_data_t* position, int64_t tx_start_us) {
+    PredictedPosition predicted;
+    if (!output_predictor.predict(tx_start_us, &predicted)) {
+        return;
+    }
+    position->latitude = predicted.latitude;
+    position->longitude = predicted.longitude;
+    position->altitude = predicted.altitude;
+    position->heading = predicted.heading;
+    position->speed = predicted.speed;
+    position->hour = predicted.timeOfDayMs / 3600000;
+    position->minute = (predicted.timeOfDayMs / 60000) % 60;
+    position->second = (predicted.timeOfDayMs / 1000) % 60;
+    position->millisecond = predicted.timeOfDayMs % 1000;
+
+    if (predicted.extrapolated) {
+        output_stats.predicted_frames++;
+    }
+    output_stats.horizon_last_ms = predicted.horizonMs;
+    if (predicted.horizonMs > output_stats.horizon_max_ms) {
+        output_stats.horizon_max_ms = predicted.horizonMs;
+    }
+}
+
+// Counters of a router sink for the status
+static void read_sink_stats(int sink, data_output_sink_stats_t* out) {
+    OutputSinkStats stats;
+    memset(out, 0, sizeof(*out));
+    if (sink >= 0 && output_router.getSinkStats(sink, &stats)) {
+        out->active = true;
+        out->frames = stats.frames;
+        out->bytes = (uint32_t)stats.bytes;
+        out->dropped = stats.dropped;
+        out->pending = stats.pending;
+        out->max_pending = stats.maxPending;
+    }
+}
+
+// Refresh the per sink counters; the TCP clients are summed, closed ones included
+static void update_sink_stats(void) {
+    read_sink_stats(uart_sink, &output_stats.sinks[DATA_OUTPUT_SINK_UART]);
+#ifdef TELEMETRY2_UART_NUM
+    read_sink_stats(uart2_sink, &output_stats.sinks[DATA_OUTPUT_SINK_UART2]);
+#endif
+    read_sink_stats(udp_sink, &output_stats.sinks[DATA_OUTPUT_SINK_UDP]);
+    output_stats.tx_overruns = output_stats.sinks[DATA_OUTPUT_SINK_UART].dropped;
+
+    data_output_sink_stats_t tcp = tcp_closed;
+    tcp.active = (listen_fd >= 0);
+    tcp.pending = 0;
+    for (int i = 0; i < DATA_OUTPUT_TCP_MAX_CLIENTS; i++) {
+        if (tcp_clients[i].fd < 0) {
+            continue;
+        }
+        data_output_sink_stats_t client;
+        read_sink_stats(tcp_clients[i].sink, &client);
+        tcp.frames += client.frames;
+        tcp.bytes += client.bytes;
+        tcp.dropped += client.dropped;
+        tcp.pending += client.pending;
+        if (client.max_pending > tcp.max_pending) {
+            tcp.max_pending = client.max_pending;
+        }
+    }
+    output_stats.sinks[DATA_OUTPUT_SINK_TCP] = tcp;
+}
+
+/**
+ * @brief Copy whole frames into the TX ring of a UART while they fit
+ *
+ * The UART interrupt sends them, so the task never waits for the wire. A
+ * frame that does not fit stays queued in the router; the next frame
+ * replaces it (the newest position wins).
+ */
+static void drain_uart(uart_port_t uart_num, int sink) {
+    const uint8_t* data;
+    size_t length;
+    while (output_router.peek(sink, &data, &length)) {
+        size_t tx_free = 0;
+        uart_get_tx_buffer_free_size(uart_num, &tx_free);
+        if (tx_free < length) {
+            return;
+        }
+        if (uart_write_bytes(uart_num, data, length) < 0) {
+            ESP_LOGW(TAG, "Failed to write telemetry data to UART%d", (int)uart_num);
+            output_stats.errors++;
+        }
+        output_router.consume(sink, length);
+    }
+}
+
+// One frame per broadcast datagram; a full socket buffer keeps the frame for the next try
+static void drain_udp(void) {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_BROADCAST);
+    addr.sin_port = htons(udp_port);
+
+    const uint8_t* data;
+    size_t length;
+    while (output_router.peek(udp_sink, &data, &length)) {
+        int sent = sendto(udp_fd, data, length, MSG_DONTWAIT, (struct sockaddr*)&addr, sizeof(addr));
+        if (sent < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != ENOMEM) {
+                // No network: nobody receives these frames
+                output_router.clearSink(udp_sink);
+            }
+            return;
+        }
+        output_router.consume(udp_sink, length);
+    }
+}
+
+// Close a TCP client; its counters are kept in the totals
+static void close_client(output_client_t* client) {
+    data_output_sink_stats_t stats;
+    read_sink_stats(client->sink, &stats);
+    tcp_closed.frames += stats.frames;
+    tcp_closed.bytes += stats.bytes;
+    tcp_closed.dropped += stats.dropped;
+    if (stats.max_pending > tcp_closed.max_pending) {
+        tcp_closed.max_pending = stats.max_pending;
+    }
+    output_router.removeSink(client->sink);
+    shutdown(client->fd, SHUT_RDWR);
+    close(client->fd);
+    client->fd = -1;
+    client->sink = -1;
+    if (output_stats.tcp_clients > 0) {
+        output_stats.tcp_clients--;
+    }
+}
+
+// Accept all pending connections; a client gets frames from the next one on
+static void accept_clients(void) {
+    while (1) {
+        struct sockaddr_in peer;
+        socklen_t peer_len = sizeof(peer);
+        int fd = accept(listen_fd, (struct sockaddr*)&peer, &peer_len);
+        if (fd < 0) {
+            return;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        int nodelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+        output_client_t* slot = NULL;
+        for (int i = 0; i < DATA_OUTPUT_TCP_MAX_CLIENTS; i++) {
+            if (tcp_clients[i].fd < 0) {
+                slot = &tcp_clients[i];
+                break;
+            }
+        }
+        int sink = (slot != NULL) ? output_router.addSink(ROUTER_TCP_DEPTH) : -1;
+        if (sink < 0) {
+            close(fd);
+            output_stats.tcp_rejected++;
+            ESP_LOGW(TAG, "Telemetry client refused, all %d slots in use", DATA_OUTPUT_TCP_MAX_CLIENTS);
+            continue;
+        }
+
+        slot->fd = fd;
+        slot->sink = sink;
+        output_stats.tcp_clients++;
+        output_stats.tcp_connections++;
+        ESP_LOGI(TAG, "Telemetry client connected, %d connected", output_stats.tcp_clients);
+    }
+}
+
+/**
+ * @brief Send queued frames to a TCP client as far as its socket takes them
+ * @return false if the connection was closed or failed
+ */
+static bool drain_client(output_client_t* client) {
+    // Clients do not send anything meaningful; read to detect disconnects
+    char discard[32];
+    int received = recv(client->fd, discard, sizeof(discard), MSG_DONTWAIT);
+    if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+        return false;
+    }
+
+    const uint8_t* data;
+    size_t length;
+    while (output_router.peek(client->sink, &data, &length)) {
+        int sent = send(client->fd, data, length, MSG_DONTWAIT);
+        if (sent < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        output_router.consume(client->sink, sent);
+        if ((size_t)sent < length) {
+            return true;
+        }
+    }
+    return true;
+}
+
+// Send what every sink takes now, without waiting for any of them
+static void service_sinks(void) {
+    if (listen_fd >= 0) {
+        accept_clients();
+    }
+    if (uart_sink >= 0) {
+        drain_uart(OUTPUT_UART_NUM, uart_sink);
+    }
+#ifdef TELEMETRY2_UART_NUM
+    if (uart2_sink >= 0) {
+        drain_uart(TELEMETRY2_UART_NUM, uart2_sink);
+    }
+#endif
+    if (udp_sink >= 0) {
+        drain_udp();
+    }
+    for (int i = 0; i < DATA_OUTPUT_TCP_MAX_CLIENTS; i++) {
+        if (tcp_clients[i].fd >= 0 && !drain_client(&tcp_clients[i])) {
+            close_client(&tcp_clients[i]);
+            ESP_LOGI(TAG, "Telemetry client disconnected, %d connected", output_stats.tcp_clients);
+        }
+    }
+    update_sink_stats();
+}
+
+static bool open_udp(uint16_t port) {
+    udp_fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (udp_fd < 0) {
+        ESP_LOGE(TAG, "Failed to create UDP socket: errno %d", errno);
+        return false;
+    }
+    int broadcast = 1;
+    setsockopt(udp_fd, SOL_SOCKET, SO_BROADCAST, &broadcast, sizeof(broadcast));
+    fcntl(udp_fd, F_SETFL, fcntl(udp_fd, F_GETFL, 0) | O_NONBLOCK);
+
+    udp_sink = output_router.addSink(ROUTER_UDP_DEPTH);
+    if (udp_sink < 0) {
+        close(udp_fd);
+        udp_fd = -1;
+        return false;
+    }
+    udp_port = port;
+    ESP_LOGI(TAG, "Telemetry UDP broadcast on port %d", port);
+    return true;
+}
+
+static void close_udp(void) {
+    output_router.removeSink(udp_sink);
+    udp_sink = -1;
+    if (udp_fd >= 0) {
+        close(udp_fd);
+        udp_fd = -1;
+    }
+    ESP_LOGI(TAG, "Telemetry UDP broadcast stopped");
+}
+
+static bool open_listener(uint16_t port) {
+    listen_fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listen_fd < 0) {
+        ESP_LOGE(TAG, "Failed to create TCP socket: errno %d", errno);
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+
+    if (bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        listen(listen_fd, OUTPUT_LISTEN_BACKLOG) != 0) {
+        ESP_LOGE(TAG, "Failed to listen on port %d: errno %d", port, errno);
+        close(listen_fd);
+        listen_fd = -1;
+        return false;
+    }
+    fcntl(listen_fd, F_SETFL, fcntl(listen_fd, F_GETFL, 0) | O_NONBLOCK);
+    tcp_port = port;
+    ESP_LOGI(TAG, "Telemetry TCP server listening on port %d (max %d clients)", port, DATA_OUTPUT_TCP_MAX_CLIENTS);
+    return true;
+}
+
+static void close_tcp(void) {
+    for (int i = 0; i < DATA_OUTPUT_TCP_MAX_CLIENTS; i++) {
+        if (tcp_clients[i].fd >= 0) {
+            close_client(&tcp_clients[i]);
+        }
+    }
+    if (listen_fd >= 0) {
+        close(listen_fd);
+        listen_fd = -1;
+    }
+    ESP_LOGI(TAG, "Telemetry TCP server stopped");
+}
+
+// Open and close the sinks to match the configuration
+static void apply_sinks(const telemetry_output_config_t* config, int64_t now_us) {
+    if (config->uart_enabled && uart_sink < 0) {
+        uart_sink = output_router.addSink(ROUTER_UART_DEPTH);
+        ESP_LOGI(TAG, "Telemetry to UART%d enabled", (int)OUTPUT_UART_NUM);
+    } else if (!config->uart_enabled && uart_sink >= 0) {
+        output_router.removeSink(uart_sink);
+        uart_sink = -1;
+        ESP_LOGI(TAG, "Telemetry to UART%d disabled", (int)OUTPUT_UART_NUM);
+    }
+
+#ifdef TELEMETRY2_UART_NUM
+    if (config->uart2_enabled && uart2_sink < 0) {
+        if (!uart2_installed) {
+            uart2_installed = (init_output_uart(TELEMETRY2_UART_NUM, TELEMETRY2_TX_PIN, UART_PIN_NO_CHANGE,
+                                                config->baud_rate) == ESP_OK);
+        }
+        if (uart2_installed) {
+            uart2_sink = output_router.addSink(ROUTER_UART_DEPTH);
+            ESP_LOGI(TAG, "Telemetry to UART%d enabled", (int)TELEMETRY2_UART_NUM);
+        }
+    } else if (!config->uart2_enabled && uart2_sink >= 0) {
+        output_router.removeSink(uart2_sink);
+        uart2_sink = -1;
+        ESP_LOGI(TAG, "Telemetry to UART%d disabled", (int)TELEMETRY2_UART_NUM);
+    }
+#else
+    static bool uart2_warned = false;
+    if (config->uart2_enabled && !uart2_warned) {
+        ESP_LOGW(TAG, "Second telemetry UART enabled, but this board has none (TELEMETRY2_UART_NUM)");
+        uart2_warned = true;
+    }
+#endif
+
+    if (udp_fd >= 0 && (!config->udp_enabled || config->udp_port != udp_port)) {
+        close_udp();
+    }
+    if (listen_fd >= 0 && (!config->tcp_enabled || config->tcp_port != tcp_port)) {
+        close_tcp();
+    }
+    if (now_us < sink_retry_us) {
+        return;
+    }
+    if (config->udp_enabled && udp_fd < 0 && !open_udp(config->udp_port)) {
+        sink_retry_us = now_us + (int64_t)OUTPUT_RETRY_DELAY_MS * 1000;
+    }
+    if (config->tcp_enabled && listen_fd < 0 && !open_listener(config->tcp_port)) {
+        sink_retry_us = now_us + (int64_t)OUTPUT_RETRY_DELAY_MS * 1000;
+    }
+    update_sink_stats();
+}
+
+/**
+ * @brief Build and queue one frame
+ *
+ * The frame is copied once into the output router and sent to every sink as
+ * far as it takes it without blocking: into the TX ring buffer of the UART
+ * driver (sent by the UART interrupt), as a UDP datagram, into the TCP
+ * socket buffers. When the frames before it are still in the UART ring (the
+ * rate is too high for the baud rate) the UART gets this frame when there is
+ * room, unless a newer one replaced it by then; the other sinks are not
+ * affected.
+ *
+ * @param gnss_data Latest GNSS data
+ * @param config Output configuration
+ * @param reason Why the frame is sent (epoch and slot frames are measured for latency and jitter)
+ * @param time_ms GNSS time of day of the epoch or slot
+ * @return true if the frame was built (and routed to the sinks that are enabled)
+ */
+static bool send_frame(const gnss_data_t* gnss_data, const telemetry_output_config_t* config,
+                       frame_reason_t reason, uint32_t time_ms) {
+    static uint8_t frame_buffer[FRAME_MAX_SIZE];
+    TRACE_BEGIN(TRACE_FRAME_TX, 0);
+
+    // The frame starts on the wire after the bytes queued before it in the
+    // UART ring (10 bits per byte); network sinks send it right away
+    size_t queued_before = 0;
+    if (uart_sink >= 0) {
+        size_t tx_free = OUTPUT_TX_BUF_SIZE;
+        uart_get_tx_buffer_free_size(OUTPUT_UART_NUM, &tx_free);
+        queued_before = (tx_free < OUTPUT_TX_BUF_SIZE) ? OUTPUT_TX_BUF_SIZE - tx_free : 0;
+    }
+    int64_t tx_start_us = esp_timer_get_time() + (int64_t)queued_before * 10000000 / config->baud_rate;
+
+    position_data_t position;
+    fill_position(gnss_data, &position);
+    if (config->predict != DATA_OUTPUT_PREDICT_OFF && reason != FRAME_FREE_RUNNING && position.valid) {
+        predict_position(&position, tx_start_us);
+    }
+
+    size_t frame_len = build_telemetry_frame(&position, config->format, frame_buffer, sizeof(frame_buffer));
+    if (frame_len == 0) {
+        ESP_LOGW(TAG, "Failed to build telemetry frame");
+        output_stats.errors++;
+        TRACE_END(TRACE_FRAME_TX, 0);
+        return false;
+    }
+
+    size_t receivers = output_router.route(frame_buffer, frame_len);
+    service_sinks();
+    TRACE_END(TRACE_FRAME_TX, frame_len);
+    if (receivers == 0) {
+        // No sink enabled
+        return true;
+    }
+    ESP_LOGD(TAG, "Routed %u bytes to %u sinks (valid=%d)", (unsigned)frame_len, (unsigned)receivers, position.valid);
+    output_stats.frames++;
+    output_stats.bytes += frame_len;
+    output_stats.last_frame_bytes = frame_len;
+
+    if (reason != FRAME_FREE_RUNNING) {
+        output_scheduler.recordSampleAge((uint32_t)(tx_start_us - gnss_data->epoch_time_us));
+        output_scheduler.recordSendTime(time_ms, tx_start_us);
+        output_stats.latency_last_us = output_scheduler.getLastAgeUs();
+        output_stats.latency_avg_us = output_scheduler.getAverageAgeUs();
+        output_stats.latency_max_us = output_scheduler.getMaxAgeUs();
+        latency_p50.add((float)output_stats.latency_last_us);
+        latency_p99.add((float)output_stats.latency_last_us);
+        output_stats.latency_p50_us = (uint32_t)latency_p50.get();
+        output_stats.latency_p99_us = (uint32_t)latency_p99.get();
+        output_stats.jitter_last_us = output_scheduler.getLastJitterUs();
+        output_stats.jitter_avg_us = output_scheduler.getAverageJitterUs();
+        output_stats.jitter_max_us = output_scheduler.getMaxJitterUs();
+    } else {
+        output_stats.free_running_frames++;
+    }
+    return true;
+}
+
 /**
  * @brief Data Output Task main function
+ *
+ * Woken by GNSS_OUTPUT_EPOCH_BIT as soon as an epoch is parsed, so a frame is
+ * sent without waiting for a tick or polling interval. With prediction and an
+ * interval, epochs only update the predictor and frames are sent at the
+ * interval slots of GNSS time (within one tick after the slot; the frame
+ * carries the predicted position and time of its transmission). While no
+ * epoch frame (or valid epoch for the slots) arrived for longer than the
+ * interval plus DATA_OUTPUT_EPOCH_TIMEOUT_MS, frames are sent on a timer with
+ * absolute deadlines (no drift).
  */
 static void data_output_task(void* pvParameters) {
     data_output_config_t config = {
@@ -165,19 +802,46 @@ static void data_output_task(void* pvParameters) {
 
     ESP_LOGI(TAG, "Data Output Task started");
 
+    telemetry_output_config_t output_config;
+    load_output_config(&output_config);
+    output_stats.format = output_config.format;
+    output_stats.baud_rate = output_config.baud_rate;
+    configure_output_scheduler(&output_config);
+    configure_output_predictor(&output_config);
+
     // Initialize UART
-    if (init_output_uart() != ESP_OK) {
+    if (init_output_uart(OUTPUT_UART_NUM, OUTPUT_TX_PIN, OUTPUT_RX_PIN, output_config.baud_rate) != ESP_OK) {
         ESP_LOGE(TAG, "Failed to initialize UART, task exiting");
         vTaskDelete(NULL);
         return;
     }
 
-    uint8_t frame_buffer[256];
-    position_data_t position;
-    memset(&position, 0, sizeof(position_data_t));
-    TickType_t last_output_time = xTaskGetTickCount();
+    // One shared frame pool for all sinks
+    if (!output_router.init(ROUTER_POOL_FRAMES, FRAME_MAX_SIZE, ROUTER_MAX_SINKS, ROUTER_TCP_DEPTH)) {
+        ESP_LOGE(TAG, "Failed to allocate output router (%d bytes), task exiting",
+                 ROUTER_POOL_FRAMES * FRAME_MAX_SIZE);
+        uart_driver_delete(OUTPUT_UART_NUM);
+        vTaskDelete(NULL);
+        return;
+    }
+    for (int i = 0; i < DATA_OUTPUT_TCP_MAX_CLIENTS; i++) {
+        tcp_clients[i].fd = -1;
+        tcp_clients[i].sink = -1;
+    }
+    apply_sinks(&output_config, esp_timer_get_time());
+
+    EventGroupHandle_t config_events = config_get_event_group();
+    int64_t last_config_poll_us = esp_timer_get_time();
+    int64_t last_epoch_frame_us = esp_timer_get_time();
+    int64_t next_timer_frame_us = 0;
+    bool free_running = false;
+    bool slot_scheduled = false;
+    uint32_t next_slot_ms = 0;
 
-    ESP_LOGI(TAG, "Waiting for GNSS data updates...");
+    ESP_LOGI(TAG, "Waiting for GNSS epochs (interval %u ms, 0 = every epoch)", output_config.interval_ms);
+
+    // Loop time from waking up until the next wait
+    int64_t loop_start_us = esp_timer_get_time();
 
     while (1) {
         // Check if output is enabled (future: read from configuration)
@@ -186,77 +850,163 @@ static void data_output_task(void* pvParameters) {
             continue;
         }
 
-        // Wait for GNSS data update event or timeout at output interval
-        xEventGroupWaitBits(
-            gnss_event_group,
-            GNSS_DATA_UPDATED_BIT,
-            pdTRUE,  // Clear bit on exit
-            pdFALSE, // Don't wait for all bits
-            pdMS_TO_TICKS(config.interval_ms)
-        );
-
-        // Check if interval has elapsed (output at fixed rate)
-        TickType_t current_time = xTaskGetTickCount();
-        if ((current_time - last_output_time) < pdMS_TO_TICKS(config.interval_ms)) {
-            continue; // Not time yet
+        // Sleep until the next epoch, the next timer frame or the config poll
+        int64_t now_us = esp_timer_get_time();
+        int64_t timeout_us = (int64_t)(output_config.interval_ms + DATA_OUTPUT_EPOCH_TIMEOUT_MS) * 1000;
+        int64_t wake_us = last_config_poll_us + 1000000;
+        int64_t timer_us = free_running ? next_timer_frame_us : last_epoch_frame_us + timeout_us;
+        if (timer_us < wake_us) {
+            wake_us = timer_us;
+        }
+        if (!free_running && slot_scheduled && output_predictor.localTimeOf(next_slot_ms) < wake_us) {
+            wake_us = output_predictor.localTimeOf(next_slot_ms);
+        }
+        // Frames queued for a sink that was busy go out as soon as it has room
+        if (output_router.getFramesInUse() > 0 && now_us + OUTPUT_DRAIN_MS * 1000 < wake_us) {
+            wake_us = now_us + OUTPUT_DRAIN_MS * 1000;
+        }
+        // Rounded up to whole ticks, so the task never spins before a deadline
+        TickType_t wait = 0;
+        if (wake_us > now_us) {
+            wait = (TickType_t)(((wake_us - now_us) * configTICK_RATE_HZ + 999999) / 1000000);
+        }
+
+        statistics_loop_time(STATS_TASK_DATA_OUTPUT, (uint32_t)(esp_timer_get_time() - loop_start_us));
+        EventBits_t bits = 0;
+        if (gnss_event_group != NULL) {
+            bits = xEventGroupWaitBits(gnss_event_group, GNSS_OUTPUT_EPOCH_BIT, pdTRUE, pdFALSE, wait);
+        } else {
+            vTaskDelay(wait > 0 ? wait : 1);
+        }
+        now_us = esp_timer_get_time();
+        loop_start_us = now_us;
+
+        // Configuration: on change notification, and polled once per second
+        // because other tasks may clear CONFIG_ALL_CHANGED_BIT first
+        bool reload_config = false;
+        if (config_events != NULL && (xEventGroupGetBits(config_events) & CONFIG_DATA_OUTPUT_CHANGED_BIT)) {
+            xEventGroupClearBits(config_events, CONFIG_DATA_OUTPUT_CHANGED_BIT);
+            reload_config = true;
+        }
+        if ((now_us - last_config_poll_us) >= 1000000) {
+            last_config_poll_us = now_us;
+            reload_config = true;
         }
-        last_output_time = current_time;
-
-        // Get latest GNSS data (already parsed)
-        gnss_data_t gnss_data;
-        gnss_get_data(&gnss_data);
-
-        // Copy parsed data directly to position structure
-        position.valid = gnss_data.valid;
-        position.latitude = gnss_data.latitude;
-        position.longitude = gnss_data.longitude;
-        position.altitude = gnss_data.altitude;
-        position.heading = gnss_data.heading;
-        position.speed = gnss_data.speed;
-        position.day = gnss_data.day;
-        position.month = gnss_data.month;
-        position.year = gnss_data.year;
-        position.hour = gnss_data.hour;
-        position.minute = gnss_data.minute;
-        position.second = gnss_data.second;
-        position.millisecond = gnss_data.millisecond;
-        position.fix_quality = gnss_data.fix_quality;
-
-        // If no valid data, use default values
-        if (!position.valid) {
-            // Get current system time as fallback
-            struct timeval tv;
-            struct tm timeinfo;
-            gettimeofday(&tv, NULL);
-            localtime_r(&tv.tv_sec, &timeinfo);
-
-            position.day = timeinfo.tm_mday;
-            position.month = timeinfo.tm_mon + 1;
-            position.year = timeinfo.tm_year % 100;
-            position.hour = timeinfo.tm_hour;
-            position.minute = timeinfo.tm_min;
-            position.second = timeinfo.tm_sec;
-            position.millisecond = tv.tv_usec / 1000;
-            position.latitude = 0.0;
-            position.longitude = 0.0;
-            position.altitude = 0.0f;
-            position.heading = 0.0f;
-            position.speed = 0.0f;
+        if (reload_config) {
+            telemetry_output_config_t new_config;
+            load_output_config(&new_config);
+            if (new_config.format != output_config.format) {
+                output_stats.format = new_config.format;
+                ESP_LOGI(TAG, "Telemetry format changed to %s",
+                         new_config.format == DATA_OUTPUT_FORMAT_BINARY ? "binary" : "CSV");
+            }
+            if (new_config.interval_ms != output_config.interval_ms) {
+                ESP_LOGI(TAG, "Telemetry interval changed to %u ms (0 = every epoch)", new_config.interval_ms);
+                configure_output_scheduler(&new_config);
+                slot_scheduled = false;
+            }
+            if (new_config.predict != output_config.predict) {
+                ESP_LOGI(TAG, "Telemetry position prediction: %s", config_data_output_predict_name(new_config.predict));
+                configure_output_predictor(&new_config);
+                slot_scheduled = false;
+            }
+            if (new_config.baud_rate != output_config.baud_rate) {
+                // Let the queued frames go out at the old rate first
+                uart_wait_tx_done(OUTPUT_UART_NUM, pdMS_TO_TICKS(500));
+                if (uart_set_baudrate(OUTPUT_UART_NUM, new_config.baud_rate) == ESP_OK) {
+                    output_stats.baud_rate = new_config.baud_rate;
+                    ESP_LOGI(TAG, "Telemetry baud rate changed to %lu", new_config.baud_rate);
+                } else {
+                    ESP_LOGE(TAG, "Failed to set baud rate %lu", new_config.baud_rate);
+                    new_config.baud_rate = output_config.baud_rate;
+                }
+#ifdef TELEMETRY2_UART_NUM
+                if (uart2_installed) {
+                    uart_wait_tx_done(TELEMETRY2_UART_NUM, pdMS_TO_TICKS(500));
+                    uart_set_baudrate(TELEMETRY2_UART_NUM, new_config.baud_rate);
+                }
+#endif
+            }
+            apply_sinks(&new_config, now_us);
+            output_config = new_config;
         }
 
-        // Build framed telemetry message
-        size_t frame_len = build_telemetry_frame(&position, frame_buffer, sizeof(frame_buffer));
+        // Sinks that were busy, new and closed TCP clients
+        service_sinks();
+
+        if (bits & GNSS_OUTPUT_EPOCH_BIT) {
+            gnss_data_t gnss_data;
+            gnss_get_data(&gnss_data);
+            uint32_t epoch_ms = gnss_time_of_day_ms(&gnss_data);
+            bool send = output_scheduler.onEpoch(epoch_ms);
+            output_stats.epochs = output_scheduler.getEpochs();
+
+            if (output_config.predict != DATA_OUTPUT_PREDICT_OFF) {
+                if (gnss_data.valid) {
+                    // Without a VTG the predictor takes the speed from the positions
+                    output_predictor.addEpoch(epoch_ms, gnss_data.epoch_time_us, gnss_data.latitude,
+                                              gnss_data.longitude, gnss_data.altitude,
+                                              gnss_data.vtg[0] != '\0' ? gnss_data.speed : -1.0f,
+                                              gnss_data.heading);
+                } else {
+                    output_predictor.reset();
+                    slot_scheduled = false;
+                }
+            }
 
-        if (frame_len > 0) {
-            // Transmit frame via UART
-            int written = uart_write_bytes(OUTPUT_UART_NUM, frame_buffer, frame_len);
-            if (written < 0) {
-                ESP_LOGW(TAG, "Failed to write telemetry data to UART");
+            bool following;
+            if (output_on_slots(&output_config)) {
+                following = gnss_data.valid;
+                if (following && !slot_scheduled) {
+                    next_slot_ms = next_slot_after(now_us, output_config.interval_ms);
+                    slot_scheduled = true;
+                }
             } else {
-                ESP_LOGD(TAG, "Transmitted %d bytes (valid=%d)", written, position.valid);
+                following = send && send_frame(&gnss_data, &output_config, FRAME_FOR_EPOCH, epoch_ms);
+            }
+            if (following) {
+                if (free_running) {
+                    ESP_LOGI(TAG, "GNSS epochs received, frames follow the epochs");
+                    free_running = false;
+                }
+                last_epoch_frame_us = now_us;
+            }
+            continue;
+        }
+
+        if (!free_running && slot_scheduled && output_on_slots(&output_config) &&
+            now_us >= output_predictor.localTimeOf(next_slot_ms)) {
+            gnss_data_t gnss_data;
+            gnss_get_data(&gnss_data);
+            send_frame(&gnss_data, &output_config, FRAME_FOR_SLOT, next_slot_ms);
+
+            // After a stall the next frame is the next slot from now
+            next_slot_ms += output_config.interval_ms;
+            if (next_slot_ms >= MS_PER_DAY) {
+                next_slot_ms = 0;
+            }
+            if (output_predictor.localTimeOf(next_slot_ms) <= now_us) {
+                next_slot_ms = next_slot_after(now_us, output_config.interval_ms);
+            }
+        }
+
+        if (!free_running && now_us - last_epoch_frame_us >= timeout_us) {
+            ESP_LOGI(TAG, "No GNSS epochs, sending frames every %u ms",
+                     output_config.interval_ms > 0 ? output_config.interval_ms : DATA_OUTPUT_INTERVAL_MS);
+            free_running = true;
+            next_timer_frame_us = now_us;
+        }
+        if (free_running && now_us >= next_timer_frame_us) {
+            gnss_data_t gnss_data;
+            gnss_get_data(&gnss_data);
+            send_frame(&gnss_data, &output_config, FRAME_FREE_RUNNING, 0);
+
+            // Absolute deadlines; after a stall the next frame follows one period later
+            uint32_t period_ms = output_config.interval_ms > 0 ? output_config.interval_ms : DATA_OUTPUT_INTERVAL_MS;
+            next_timer_frame_us += (int64_t)period_ms * 1000;
+            if (next_timer_frame_us <= now_us) {
+                next_timer_frame_us = now_us + (int64_t)period_ms * 1000;
             }
-        } else {
-            ESP_LOGW(TAG, "Failed to build telemetry frame");
         }
     }
 }
@@ -285,6 +1035,13 @@ esp_err_t data_output_task_init(void) {
     return ESP_OK;
 }
 
+void data_output_get_stats(data_output_stats_t* stats) {
+    if (stats == NULL) {
+        return;
+    }
+    memcpy(stats, &output_stats, sizeof(data_output_stats_t));
+}
+
 esp_err_t data_output_task_stop(void) {
     ESP_LOGI(TAG, "Stopping Data Output Task");
 
@@ -293,8 +1050,25 @@ esp_err_t data_output_task_stop(void) {
         data_output_task_handle = NULL;
     }
 
+    // Close the network sinks and free the frame pool
+    if (udp_fd >= 0) {
+        close_udp();
+    }
+    if (listen_fd >= 0) {
+        close_tcp();
+    }
+    output_router.deinit();
+    uart_sink = -1;
+
     // Cleanup UART
     uart_driver_delete(OUTPUT_UART_NUM);
+#ifdef TELEMETRY2_UART_NUM
+    if (uart2_installed) {
+        uart_driver_delete(TELEMETRY2_UART_NUM);
+        uart2_installed = false;
+        uart2_sink = -1;
+    }
+#endif
 
     ESP_LOGI(TAG, "Data Output Task stopped");
     return ESP_OK;
@@ -1,9 +1,11 @@
 /**
  * @file dataOutputTask.h
- * @brief Data Output Task - Telemetry data transmission via UART1
+ * @brief Data Output Task - Telemetry data transmission via UART1 and the network
  * 
  * This task formats and transmits GPS position, time, and navigation data
  * to an external telemetry unit using a binary framing protocol with CRC-16.
+ * Each frame is built once and sent to all enabled sinks: UART1, an optional
+ * second UART, UDP broadcast and TCP clients (lib/OutputRouter).
  * 
  * @author ESP32-S3 NTRIP/GPS/MQTT System
  * @date 2026
@@ -23,9 +25,28 @@ extern "C" {
 
 /**
  * @def DATA_OUTPUT_INTERVAL_MS
- * @brief Default output interval in milliseconds (10 Hz).
+ * @brief Output interval in milliseconds (10 Hz) without GNSS epochs, when
+ * frames are sent once per epoch.
  */
 #define DATA_OUTPUT_INTERVAL_MS     100
+/**
+ * @def DATA_OUTPUT_EPOCH_TIMEOUT_MS
+ * @brief Time without an epoch frame (in addition to the interval) after
+ * which frames are sent on a timer with the system time.
+ */
+#define DATA_OUTPUT_EPOCH_TIMEOUT_MS 1000
+/**
+ * @def DATA_OUTPUT_PREDICT_HORIZON_MS
+ * @brief Longest time a position is predicted beyond its epoch.
+ */
+#define DATA_OUTPUT_PREDICT_HORIZON_MS 500
+/**
+ * @def DATA_OUTPUT_RECEIVER_DELAY_MS
+ * @brief Shortest time from a GNSS epoch until its GGA has been received:
+ * the receiver computing the fix and sending the sentences before it. Typical
+ * for a receiver at 10 Hz; predicted positions are late by the error in this.
+ */
+#define DATA_OUTPUT_RECEIVER_DELAY_MS 30
 /**
  * @def DATA_OUTPUT_TASK_STACK_SIZE
  * @brief Stack size for the data output task.
@@ -85,8 +106,67 @@ typedef struct {
     float speed;            /**< Ground speed in km/h */
     bool valid;             /**< Data validity flag */
     uint8_t fix_quality;    /**< GNSS fix quality (0=no fix, 1=GPS, 2=DGPS, 4=RTK fixed, 5=RTK float) */
+    uint8_t satellites;     /**< Number of satellites used */
+    float hdop;             /**< Horizontal dilution of precision */
+    float age;              /**< Age of differential data in seconds */
+    uint32_t epoch;         /**< GNSS epoch counter (binary format only) */
 } position_data_t;
 
+/**
+ * @brief Telemetry output sinks, index into data_output_stats_t.sinks.
+ */
+typedef enum {
+    DATA_OUTPUT_SINK_UART = 0,  /**< UART1 */
+    DATA_OUTPUT_SINK_UART2,     /**< Second UART (boards with TELEMETRY2_UART_NUM) */
+    DATA_OUTPUT_SINK_UDP,       /**< UDP broadcast */
+    DATA_OUTPUT_SINK_TCP,       /**< TCP clients, summed */
+    DATA_OUTPUT_SINK_COUNT
+} data_output_sink_t;
+
+/**
+ * @brief Counters of one telemetry sink, since it was opened.
+ */
+typedef struct {
+    bool active;            /**< Sink is open and receives frames */
+    uint32_t frames;        /**< Frames sent */
+    uint32_t bytes;         /**< Bytes sent */
+    uint32_t dropped;       /**< Frames dropped because the sink was behind */
+    uint16_t pending;       /**< Frames queued now */
+    uint16_t max_pending;   /**< Most frames queued at once */
+} data_output_sink_stats_t;
+
+/**
+ * @brief Telemetry output statistics, see data_output_get_stats().
+ */
+typedef struct {
+    uint8_t format;         /**< Payload format in use (DATA_OUTPUT_FORMAT_*) */
+    uint32_t frames;        /**< Frames built and routed to the sinks */
+    uint32_t bytes;         /**< Bytes of those frames including framing and stuffing (once, not per sink) */
+    uint32_t last_frame_bytes; /**< Size of the last frame */
+    uint32_t errors;        /**< Frames that could not be built or written */
+    uint32_t interval_ms;   /**< Output interval in use (0 = every GNSS epoch) */
+    uint32_t baud_rate;     /**< UART baud rate in use */
+    uint32_t epochs;        /**< New GNSS epochs seen */
+    uint32_t free_running_frames; /**< Frames sent on the timer because no epochs arrived */
+    uint32_t tx_overruns;   /**< Frames UART1 dropped because earlier frames were still being sent */
+    uint32_t latency_last_us; /**< Epoch reception to start of transmission, last frame */
+    uint32_t latency_avg_us;  /**< Epoch reception to start of transmission, average */
+    uint32_t latency_max_us;  /**< Epoch reception to start of transmission, maximum */
+    uint32_t latency_p50_us;  /**< Epoch reception to start of transmission, median (P² estimate) */
+    uint32_t latency_p99_us;  /**< Epoch reception to start of transmission, 99th percentile (P² estimate) */
+    uint32_t jitter_last_us;  /**< Transmit interval minus GNSS time interval, last frame */
+    uint32_t jitter_avg_us;   /**< Transmit interval minus GNSS time interval, average */
+    uint32_t jitter_max_us;   /**< Transmit interval minus GNSS time interval, maximum */
+    uint8_t predict;          /**< Position prediction in use (DATA_OUTPUT_PREDICT_*) */
+    uint32_t predicted_frames; /**< Frames with a position predicted beyond its epoch */
+    uint32_t horizon_last_ms; /**< Time the position was predicted ahead, last frame */
+    uint32_t horizon_max_ms;  /**< Time the position was predicted ahead, maximum */
+    data_output_sink_stats_t sinks[DATA_OUTPUT_SINK_COUNT]; /**< Per sink counters */
+    uint8_t tcp_clients;      /**< Connected TCP clients */
+    uint32_t tcp_connections; /**< TCP clients accepted since boot */
+    uint32_t tcp_rejected;    /**< TCP clients refused because all slots were in use */
+} data_output_stats_t;
+
 /**
  * @brief Initialize and start the Data Output Task
  * 
@@ -121,6 +201,13 @@ esp_err_t data_output_task_init(void);
  */
 esp_err_t data_output_task_stop(void);
 
+/**
+ * @brief Get telemetry output statistics.
+ *
+ * @param stats Pointer to structure to fill
+ */
+void data_output_get_stats(data_output_stats_t* stats);
+
 #ifdef __cplusplus
 }
 #endif
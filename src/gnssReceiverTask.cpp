@@ -1,8 +1,12 @@
 #include "gnssReceiverTask.h"
 #include "ntripClientTask.h"
+#include "nmeaServerTask.h"
 #include "configurationManagerTask.h"
 #include "hardware_config.h"
 #include "NMEAparser/NMEAParser.h"
+#include "lib/GGAScheduler.h"
+#include "statisticsTask.h"
+#include "traceRecorder.h"
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <freertos/semphr.h>
@@ -25,15 +29,18 @@ static const char *TAG = "GNSSTask";
 #define GNSS_TASK_PRIORITY     4
 #define GNSS_UART_TIMEOUT_MS   100
 
-// Default GGA interval (seconds)
-#define DEFAULT_GGA_INTERVAL_SEC  120
-
 // Global GNSS data, mutex, and event group
 static gnss_data_t gnss_data;
 static SemaphoreHandle_t gnss_data_mutex = NULL;
 static TaskHandle_t gnss_task_handle = NULL;
 EventGroupHandle_t gnss_event_group = NULL;
 
+// GGA upload policy (distance, fix change, min/max interval), used by this task only
+static GGAScheduler gga_scheduler;
+
+// Fix quality last reported to the statistics (0 until the first fix)
+static uint8_t reported_fix_quality = 0;
+
 // Calculate NMEA checksum
 static uint8_t calculate_nmea_checksum(const char *sentence) {
     uint8_t checksum = 0;
@@ -90,10 +97,11 @@ static bool is_sentence_type(const char *sentence, const char *type) {
 }
 
 // Update GNSS data with new sentence using centralized parsing
-static void update_gnss_data(const char *sentence) {
+// Returns false if the checksum is invalid
+static bool update_gnss_data(const char *sentence) {
     if (!validate_nmea_sentence(sentence)) {
         ESP_LOGD(TAG, "Invalid NMEA checksum");
-        return;
+        return false;
     }
     
     if (xSemaphoreTake(gnss_data_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
@@ -128,6 +136,7 @@ static void update_gnss_data(const char *sentence) {
             }
             
             gnss_data.timestamp = tv.tv_sec;
+            gnss_data.epoch_time_us = esp_timer_get_time();
             gnss_data.valid = (gga.fixType > 0);
             data_updated = true;
             gga_updated = true;
@@ -174,10 +183,12 @@ static void update_gnss_data(const char *sentence) {
                 xEventGroupSetBits(gnss_event_group, GNSS_DATA_UPDATED_BIT);
             }
             if (gga_updated) {
-                xEventGroupSetBits(gnss_event_group, GNSS_GGA_UPDATED_BIT);
+                xEventGroupSetBits(gnss_event_group, GNSS_GGA_UPDATED_BIT | GNSS_EPOCH_BIT | GNSS_OUTPUT_EPOCH_BIT);
             }
         }
     }
+    
+    return true;
 }
 
 // Initialize UART2 for GNSS communication
@@ -222,12 +233,77 @@ static esp_err_t init_gnss_uart(void) {
     return ESP_OK;
 }
 
+// Apply the GGA upload policy settings from the NTRIP configuration
+static void configure_gga_scheduler(const ntrip_config_t *ntrip_config) {
+    gga_scheduler.configure(ntrip_config->gga_distance_m,
+                            ntrip_config->gga_min_interval_sec * 1000UL,
+                            ntrip_config->gga_interval_sec * 1000UL);
+    ESP_LOGI(TAG, "GGA policy: distance %u m, interval %u-%u s",
+             ntrip_config->gga_distance_m, ntrip_config->gga_min_interval_sec, ntrip_config->gga_interval_sec);
+}
+
+// Run the GGA upload policy for the GGA sentence just parsed and queue it for the NTRIP Client
+static void schedule_gga(void) {
+    gga_data_t gga_data;
+    double latitude;
+    double longitude;
+    uint8_t fix_quality;
+    
+    if (xSemaphoreTake(gnss_data_mutex, pdMS_TO_TICKS(10)) != pdTRUE) {
+        return;
+    }
+    strncpy(gga_data.sentence, gnss_data.gga, sizeof(gga_data.sentence) - 1);
+    gga_data.sentence[sizeof(gga_data.sentence) - 1] = '\0';
+    latitude = gnss_data.latitude;
+    longitude = gnss_data.longitude;
+    fix_quality = gnss_data.valid ? gnss_data.fix_quality : 0;
+    xSemaphoreGive(gnss_data_mutex);
+    
+    // Counted per epoch, the Statistics Task only samples once per second
+    if (fix_quality != reported_fix_quality) {
+        statistics_fix_quality_changed(fix_quality);
+        reported_fix_quality = fix_quality;
+    }
+    
+    // The NTRIP Client sends its own line terminator
+    size_t length = strlen(gga_data.sentence);
+    if (length > 0 && gga_data.sentence[length - 1] == '\r') {
+        gga_data.sentence[--length] = '\0';
+    }
+    
+    // A new caster connection needs a position right away
+    if (xEventGroupClearBits(gnss_event_group, GNSS_GGA_REQUEST_BIT) & GNSS_GGA_REQUEST_BIT) {
+        gga_scheduler.reset();
+    }
+    
+    int64_t saved_before = gga_scheduler.getBytesSaved();
+    GgaSendReason reason = gga_scheduler.evaluate((uint32_t)(esp_timer_get_time() / 1000),
+                                                  latitude, longitude, fix_quality, length + 2);
+    int32_t saved_delta = (int32_t)(gga_scheduler.getBytesSaved() - saved_before);
+    if (reason != GGA_SEND_NONE || saved_delta != 0) {
+        statistics_gga_scheduled((uint8_t)reason, saved_delta);
+    }
+    if (reason == GGA_SEND_NONE) {
+        return;
+    }
+    
+    // Send to NTRIP Client (non-blocking); only the latest position matters
+    if (xQueueSend(gga_queue, &gga_data, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "GGA queue full, overwriting");
+        xQueueReset(gga_queue);
+        xQueueSend(gga_queue, &gga_data, 0);
+    }
+    ESP_LOGI(TAG, "Queued GGA for NTRIP (%s): %s",
+             reason == GGA_SEND_FIRST ? "first" :
+             reason == GGA_SEND_DISTANCE ? "moved" :
+             reason == GGA_SEND_FIX_CHANGE ? "fix change" : "interval",
+             gga_data.sentence);
+}
+
 // GNSS Receiver Task
 static void gnss_receiver_task(void *pvParameters) {
     char line_buffer[256];
     int line_pos = 0;
-    TickType_t last_gga_time = xTaskGetTickCount() - pdMS_TO_TICKS(DEFAULT_GGA_INTERVAL_SEC * 1000);  // Force immediate send on first valid GGA
-    uint16_t gga_interval_sec = DEFAULT_GGA_INTERVAL_SEC;
     
     ESP_LOGI(TAG, "GNSS Receiver Task started");
     
@@ -238,19 +314,23 @@ static void gnss_receiver_task(void *pvParameters) {
         return;
     }
     
-    // Load GGA interval configuration
+    // Load GGA upload policy
     ntrip_config_t ntrip_config;
     if (config_get_ntrip(&ntrip_config) == ESP_OK) {
-        gga_interval_sec = ntrip_config.gga_interval_sec;
-        ESP_LOGI(TAG, "GGA interval: %d seconds", gga_interval_sec);
+        configure_gga_scheduler(&ntrip_config);
     }
     
     while (1) {
+        // Loop time excludes the waits for UART data and the delay
+        int64_t loop_start_us = esp_timer_get_time();
+        
         // Check for RTCM data from NTRIP Client
         rtcm_data_t rtcm_data;
         if (xQueueReceive(rtcm_queue, &rtcm_data, 0) == pdTRUE) {
             // Forward RTCM data to GPS receiver
+            TRACE_BEGIN(TRACE_RTCM_FORWARD, rtcm_data.length);
             int written = uart_write_bytes(GNSS_UART_NUM, rtcm_data.data, rtcm_data.length);
+            TRACE_END(TRACE_RTCM_FORWARD, rtcm_data.length);
             if (written < 0) {
                 ESP_LOGW(TAG, "Failed to write RTCM data to GPS");
             } else {
@@ -260,9 +340,13 @@ static void gnss_receiver_task(void *pvParameters) {
         
         // Read NMEA data from GPS receiver
         uint8_t data[128];
+        int64_t busy_us = esp_timer_get_time() - loop_start_us;
         int len = uart_read_bytes(GNSS_UART_NUM, data, sizeof(data) - 1, pdMS_TO_TICKS(GNSS_UART_TIMEOUT_MS));
+        loop_start_us = esp_timer_get_time();
         
         if (len > 0) {
+            TRACE_INSTANT(TRACE_UART_RX, len);
+            
             // Process received data byte by byte
             for (int i = 0; i < len; i++) {
                 char c = data[i];
@@ -277,7 +361,24 @@ static void gnss_receiver_task(void *pvParameters) {
                     line_buffer[line_pos] = '\0';
                     
                     // Process complete sentence
-                    update_gnss_data(line_buffer);
+                    TRACE_BEGIN(TRACE_NMEA_SENTENCE, line_pos);
+                    bool valid = update_gnss_data(line_buffer);
+                    TRACE_END(TRACE_NMEA_SENTENCE, line_pos);
+                    if (valid) {
+                        if (is_sentence_type(line_buffer, "GGA")) {
+                            schedule_gga();
+                        }
+                        
+                        // Forward the validated sentence with a "\r\n" terminator
+                        if (line_buffer[line_pos - 1] == '\r') {
+                            line_pos--;
+                        }
+                        if (line_pos + 2 <= (int)sizeof(line_buffer)) {
+                            line_buffer[line_pos++] = '\r';
+                            line_buffer[line_pos++] = '\n';
+                            nmea_server_publish_line(line_buffer, line_pos);
+                        }
+                    }
                     
                     line_pos = 0;
                 }
@@ -293,44 +394,17 @@ static void gnss_receiver_task(void *pvParameters) {
             }
         }
         
-        // Send GGA to NTRIP Client at configured interval
-        TickType_t current_time = xTaskGetTickCount();
-        if ((current_time - last_gga_time) >= pdMS_TO_TICKS(gga_interval_sec * 1000)) {
-            if (xSemaphoreTake(gnss_data_mutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-                if (gnss_data.valid && strlen(gnss_data.gga) > 0) {
-                    gga_data_t gga_data;
-                    strncpy(gga_data.sentence, gnss_data.gga, sizeof(gga_data.sentence) - 1);
-                    gga_data.sentence[sizeof(gga_data.sentence) - 1] = '\0';
-                    
-                    // Send to NTRIP Client (non-blocking)
-                    if (xQueueSend(gga_queue, &gga_data, 0) == pdTRUE) {
-                        ESP_LOGI(TAG, "Sent GGA to NTRIP queue: %s", gga_data.sentence);
-                        last_gga_time = current_time;
-                    } else {
-                        ESP_LOGW(TAG, "GGA queue full, overwriting");
-                        // For GGA queue, we want the latest data, so overwrite
-                        xQueueReset(gga_queue);
-                        xQueueSend(gga_queue, &gga_data, 0);
-                        last_gga_time = current_time;
-                    }
-                } else {
-                    ESP_LOGD(TAG, "GGA send interval elapsed but no valid GNSS data (valid=%d, gga_len=%d)", 
-                             gnss_data.valid, strlen(gnss_data.gga));
-                }
-                xSemaphoreGive(gnss_data_mutex);
-            }
-        }
-        
         // Check for configuration changes
         EventBits_t bits = config_wait_for_event(CONFIG_NTRIP_CHANGED_BIT, 0);
         if (bits & CONFIG_NTRIP_CHANGED_BIT) {
-            // Reload GGA interval
+            // Reload GGA upload policy
             if (config_get_ntrip(&ntrip_config) == ESP_OK) {
-                gga_interval_sec = ntrip_config.gga_interval_sec;
-                ESP_LOGI(TAG, "GGA interval updated: %d seconds", gga_interval_sec);
+                configure_gga_scheduler(&ntrip_config);
             }
         }
         
+        statistics_loop_time(STATS_TASK_GNSS, (uint32_t)(busy_us + esp_timer_get_time() - loop_start_us));
+        
         // Small delay to prevent busy-waiting
         vTaskDelay(pdMS_TO_TICKS(10));
     }
@@ -411,6 +485,12 @@ bool gnss_has_valid_fix(void) {
     return valid;
 }
 
+void gnss_request_gga(void) {
+    if (gnss_event_group != NULL) {
+        xEventGroupSetBits(gnss_event_group, GNSS_GGA_REQUEST_BIT);
+    }
+}
+
 void gnss_receiver_task_stop(void) {
     if (gnss_task_handle != NULL) {
         vTaskDelete(gnss_task_handle);
@@ -17,6 +17,26 @@
  * @brief Event bit set when new GGA sentence is available.
  */
 #define GNSS_GGA_UPDATED_BIT    (1 << 1)
+/**
+ * @def GNSS_GGA_REQUEST_BIT
+ * @brief Event bit requesting that the next valid GGA is sent to the NTRIP Client.
+ */
+#define GNSS_GGA_REQUEST_BIT    (1 << 2)
+
+/**
+ * @def GNSS_EPOCH_BIT
+ * @brief Event bit set when a GGA sentence (one GNSS epoch) has been parsed.
+ *
+ * Reserved for the MQTT Client Task, which clears it while waiting; other
+ * tasks use GNSS_DATA_UPDATED_BIT or their own epoch bit.
+ */
+#define GNSS_EPOCH_BIT          (1 << 3)
+
+/**
+ * @def GNSS_OUTPUT_EPOCH_BIT
+ * @brief Event bit set with GNSS_EPOCH_BIT, reserved for the Data Output Task.
+ */
+#define GNSS_OUTPUT_EPOCH_BIT   (1 << 4)
 
 /**
  * @brief Global event group for GNSS data notifications.
@@ -56,6 +76,7 @@ typedef struct {
     
     // Status
     time_t timestamp;   /**< Last update time */
+    int64_t epoch_time_us; /**< esp_timer time at which the last GGA was received */
     bool valid;         /**< Data validity flag */
 
 } gnss_data_t;
@@ -84,6 +105,15 @@ void gnss_get_data(gnss_data_t *data);
  */
 bool gnss_has_valid_fix(void);
 
+/**
+ * @brief Send the next valid GGA to the NTRIP Client regardless of the upload policy.
+ *
+ * Called by the NTRIP Client Task after connecting to the caster. GGA uploads
+ * otherwise follow the GGA scheduler: after moving gga_distance_m, on a fix
+ * quality change, or after gga_interval_sec, at most every gga_min_interval_sec.
+ */
+void gnss_request_gga(void);
+
 /**
  * @brief Stop the GNSS Receiver Task.
  */
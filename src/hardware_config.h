@@ -33,6 +33,18 @@
 #define TELEMETRY_RX_PIN        GPIO_NUM_16  // Unused, but reserved
 #define TELEMETRY_BAUD_RATE     115200
 
+/**
+ * Second Telemetry UART (optional)
+ * Purpose: Same telemetry frames as UART1, for a second consumer
+ * Baud Rate: same as UART1 (configured at run time)
+ * Direction: TX-only
+ * Note: The Lolin S3 has no free UART (UART0 is the console), so this is not
+ *       defined here. Boards with the console on USB Serial/JTAG can define
+ *       TELEMETRY2_UART_NUM UART_NUM_0 and a TX pin, e.g. GPIO 13.
+ */
+// #define TELEMETRY2_UART_NUM     UART_NUM_0
+// #define TELEMETRY2_TX_PIN       GPIO_NUM_13
+
 /**
  * UART2 - GNSS Receiver Communication
  * Purpose: Bidirectional communication with GPS/GNSS module
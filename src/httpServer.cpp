@@ -2,6 +2,11 @@
 #include "configurationManagerTask.h"
 #include "ntripClientTask.h"
 #include "mqttClientTask.h"
+#include "ntripCasterTask.h"
+#include "nmeaServerTask.h"
+#include "dataOutputTask.h"
+#include "statisticsTask.h"
+#include "traceRecorder.h"
 #include "wifiManager.h"
 #include "esp_log.h"
 #include "esp_system.h"
@@ -182,6 +187,15 @@ static const char* html_page =
 "            <input type='number' id='ntrip_port' min='1' max='65535'>\n"
 "        </div>\n"
 "        <div class='form-group'>\n"
+"            <label><input type='checkbox' id='ntrip_use_tls'> Use TLS (caster port is usually 443)</label>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label>CA Certificate (PEM, optional):</label>\n"
+"            <textarea id='ntrip_ca' rows='4' style='width:100%; font-family:monospace;' placeholder='Leave empty to use the built-in certificate bundle'></textarea>\n"
+"            <span id='ntrip_ca_state' style='font-size:12px; color:#666;'></span>\n"
+"            <button onclick='uploadCa()'>Save CA Certificate</button>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
 "            <label>Mountpoint:</label>\n"
 "            <input type='text' id='ntrip_mountpoint' maxlength='63'>\n"
 "        </div>\n"
@@ -194,9 +208,17 @@ static const char* html_page =
 "            <input type='password' id='ntrip_password' maxlength='63' placeholder='Leave blank to keep current password'>\n"
 "        </div>\n"
 "        <div class='form-group'>\n"
-"            <label>GGA Interval (seconds):</label>\n"
+"            <label>Max GGA Interval (seconds):</label>\n"
 "            <input type='number' id='ntrip_gga_interval' min='10' max='600' value='120'>\n"
 "        </div>\n"
+"        <div class='form-group'>\n"
+"            <label>Min GGA Interval (seconds):</label>\n"
+"            <input type='number' id='ntrip_gga_min_interval' min='1' max='600' value='10'>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label>GGA Distance (meters, 0 = off):</label>\n"
+"            <input type='number' id='ntrip_gga_distance' min='0' max='50000' value='100'>\n"
+"        </div>\n"
 "        <h2 style='margin-bottom: 8px;'>MQTT Configuration</h2>\n"
 "        <div class='status-indicator-container' style='display: flex; align-items: center; margin-bottom: 15px;'>\n"
 "            <span style='font-weight:bold; color:#555; margin-right:10px;'>Enable:</span>\n"
@@ -239,6 +261,139 @@ static const char* html_page =
 "            <label>Stats Interval (sec, 0=disabled):</label>\n"
 "            <input type='number' id='mqtt_stats_interval' min='0' max='600' value='60'>\n"
 "        </div>\n"
+"        <div class='form-group'>\n"
+"            <label>Binary payload (CBOR instead of JSON):</label>\n"
+"            <label><input type='checkbox' id='mqtt_gnss_cbor'> GNSS</label>\n"
+"            <label><input type='checkbox' id='mqtt_status_cbor'> Status</label>\n"
+"            <label><input type='checkbox' id='mqtt_stats_cbor'> Stats</label>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label>GNSS Batch Size (epochs per message, 1=no batching):</label>\n"
+"            <input type='number' id='mqtt_gnss_batch_size' min='1' max='32' value='1'>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label>GNSS Batch Latency (ms):</label>\n"
+"            <input type='number' id='mqtt_gnss_batch_ms' min='100' max='60000' value='1000'>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label>GNSS Interval (ms, 0=use seconds):</label>\n"
+"            <input type='number' id='mqtt_gnss_interval_ms' min='0' max='60000' value='0'>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label>GNSS Every Nth Epoch (0=use interval):</label>\n"
+"            <input type='number' id='mqtt_gnss_every_n' min='0' max='255' value='0'>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label>GNSS Deadband (m, 0=publish every position):</label>\n"
+"            <input type='number' id='mqtt_gnss_deadband' min='0' max='10000' value='0'>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label>GNSS Heartbeat (sec, with deadband):</label>\n"
+"            <input type='number' id='mqtt_gnss_heartbeat' min='1' max='65535' value='300'>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label>Batch Track Simplification (cm, 0=off):</label>\n"
+"            <input type='number' id='mqtt_gnss_simplify' min='0' max='10000' value='0'>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label><input type='checkbox' id='mqtt_outbox_enabled'> Store GNSS messages in flash while the broker is unreachable</label>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label>Outbox Drain Rate (messages/sec):</label>\n"
+"            <input type='number' id='mqtt_outbox_rate' min='1' max='100' value='5'>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label>QoS 1 (delivery acknowledged by the broker):</label>\n"
+"            <label><input type='checkbox' id='mqtt_gnss_qos'> GNSS</label>\n"
+"            <label><input type='checkbox' id='mqtt_status_qos'> Status</label>\n"
+"            <label><input type='checkbox' id='mqtt_stats_qos'> Stats</label>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label>QoS 1 Window (messages awaiting PUBACK):</label>\n"
+"            <input type='number' id='mqtt_qos_window' min='1' max='16' value='4'>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label>QoS 1 Queue (KB, oldest dropped when full):</label>\n"
+"            <input type='number' id='mqtt_qos_queue_kb' min='2' max='64' value='16'>\n"
+"        </div>\n"
+"        <h2 style='margin-bottom: 8px;'>Local NTRIP Caster</h2>\n"
+"        <div class='form-group'>\n"
+"            <label><input type='checkbox' id='caster_enabled'> Serve corrections to LAN clients</label>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label>Port:</label>\n"
+"            <input type='number' id='caster_port' min='1' max='65535' value='2101'>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label>Mountpoint:</label>\n"
+"            <input type='text' id='caster_mountpoint' maxlength='63'>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label>Username (empty = no authentication):</label>\n"
+"            <input type='text' id='caster_user' maxlength='31'>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label>Password:</label>\n"
+"            <input type='password' id='caster_password' maxlength='63' placeholder='Leave blank to keep current password'>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label>Max Clients:</label>\n"
+"            <input type='number' id='caster_max_clients' min='1' max='16' value='8'>\n"
+"        </div>\n"
+"        <h2 style='margin-bottom: 8px;'>NMEA Network Output</h2>\n"
+"        <div class='form-group'>\n"
+"            <label><input type='checkbox' id='nmea_tcp_enabled'> Serve raw NMEA over TCP</label>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label>TCP Port:</label>\n"
+"            <input type='number' id='nmea_tcp_port' min='1' max='65535' value='10110'>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label>Max TCP Clients:</label>\n"
+"            <input type='number' id='nmea_max_clients' min='1' max='8' value='4'>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label><input type='checkbox' id='nmea_udp_enabled'> Broadcast raw NMEA over UDP</label>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label>UDP Port:</label>\n"
+"            <input type='number' id='nmea_udp_port' min='1' max='65535' value='10110'>\n"
+"        </div>\n"
+"        <h2 style='margin-bottom: 8px;'>Telemetry Output</h2>\n"
+"        <div class='form-group'>\n"
+"            <label><input type='checkbox' id='data_output_binary'> Send binary telemetry records (instead of CSV)</label>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label>Telemetry Interval (ms, 0=every GNSS epoch):</label>\n"
+"            <input type='number' id='data_output_interval_ms' min='0' max='60000' value='0'>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label>Telemetry Baud Rate (9600-921600):</label>\n"
+"            <input type='number' id='data_output_baud_rate' min='9600' max='921600' value='115200'>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label><input type='checkbox' id='data_output_predict'> Predict the position at the transmit time (allows intervals shorter than the GNSS epoch)</label>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label><input type='checkbox' id='data_output_uart_enabled'> Send telemetry on UART1</label>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label><input type='checkbox' id='data_output_uart2_enabled'> Send telemetry on the second UART (boards that have one)</label>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label><input type='checkbox' id='data_output_udp_enabled'> Broadcast telemetry frames over UDP</label>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label>Telemetry UDP Port:</label>\n"
+"            <input type='number' id='data_output_udp_port' min='1' max='65535' value='10111'>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label><input type='checkbox' id='data_output_tcp_enabled'> Serve telemetry frames over TCP (up to 4 clients)</label>\n"
+"        </div>\n"
+"        <div class='form-group'>\n"
+"            <label>Telemetry TCP Port:</label>\n"
+"            <input type='number' id='data_output_tcp_port' min='1' max='65535' value='10111'>\n"
+"        </div>\n"
 "        <div style='margin-top: 30px;'>\n"
 "            <button onclick='saveConfig()'>Save Configuration</button>\n"
 "            <button onclick='restartDevice()'>Restart Device</button>\n"
@@ -321,9 +476,13 @@ static const char* html_page =
 "                document.getElementById('ntrip_enabled').checked = data.ntrip.enabled;\n"
 "                document.getElementById('ntrip_host').value = data.ntrip.host;\n"
 "                document.getElementById('ntrip_port').value = data.ntrip.port;\n"
+"                document.getElementById('ntrip_use_tls').checked = data.ntrip.use_tls;\n"
+"                document.getElementById('ntrip_ca_state').textContent = data.ntrip.custom_ca ? 'Custom CA stored' : 'Using certificate bundle';\n"
 "                document.getElementById('ntrip_mountpoint').value = data.ntrip.mountpoint;\n"
 "                document.getElementById('ntrip_user').value = data.ntrip.user;\n"
 "                document.getElementById('ntrip_gga_interval').value = data.ntrip.gga_interval_sec;\n"
+"                document.getElementById('ntrip_gga_min_interval').value = data.ntrip.gga_min_interval_sec;\n"
+"                document.getElementById('ntrip_gga_distance').value = data.ntrip.gga_distance_m;\n"
 "                document.getElementById('mqtt_enabled').checked = data.mqtt.enabled;\n"
 "                document.getElementById('mqtt_broker').value = data.mqtt.broker;\n"
 "                document.getElementById('mqtt_port').value = data.mqtt.port;\n"
@@ -332,6 +491,44 @@ static const char* html_page =
 "                document.getElementById('mqtt_gnss_interval').value = data.mqtt.gnss_interval_sec;\n"
 "                document.getElementById('mqtt_status_interval').value = data.mqtt.status_interval_sec;\n"
 "                document.getElementById('mqtt_stats_interval').value = data.mqtt.stats_interval_sec;\n"
+"                document.getElementById('mqtt_gnss_cbor').checked = data.mqtt.gnss_encoding === 'cbor';\n"
+"                document.getElementById('mqtt_status_cbor').checked = data.mqtt.status_encoding === 'cbor';\n"
+"                document.getElementById('mqtt_stats_cbor').checked = data.mqtt.stats_encoding === 'cbor';\n"
+"                document.getElementById('mqtt_gnss_batch_size').value = data.mqtt.gnss_batch_size;\n"
+"                document.getElementById('mqtt_gnss_batch_ms').value = data.mqtt.gnss_batch_ms;\n"
+"                document.getElementById('mqtt_gnss_interval_ms').value = data.mqtt.gnss_interval_ms;\n"
+"                document.getElementById('mqtt_gnss_every_n').value = data.mqtt.gnss_every_n;\n"
+"                document.getElementById('mqtt_gnss_deadband').value = data.mqtt.gnss_deadband_m;\n"
+"                document.getElementById('mqtt_gnss_heartbeat').value = data.mqtt.gnss_heartbeat_sec;\n"
+"                document.getElementById('mqtt_gnss_simplify').value = data.mqtt.gnss_simplify_cm;\n"
+"                document.getElementById('mqtt_outbox_enabled').checked = data.mqtt.outbox_enabled;\n"
+"                document.getElementById('mqtt_outbox_rate').value = data.mqtt.outbox_rate;\n"
+"                document.getElementById('mqtt_gnss_qos').checked = data.mqtt.gnss_qos === 1;\n"
+"                document.getElementById('mqtt_status_qos').checked = data.mqtt.status_qos === 1;\n"
+"                document.getElementById('mqtt_stats_qos').checked = data.mqtt.stats_qos === 1;\n"
+"                document.getElementById('mqtt_qos_window').value = data.mqtt.qos_window;\n"
+"                document.getElementById('mqtt_qos_queue_kb').value = data.mqtt.qos_queue_kb;\n"
+"                document.getElementById('caster_enabled').checked = data.caster.enabled;\n"
+"                document.getElementById('caster_port').value = data.caster.port;\n"
+"                document.getElementById('caster_mountpoint').value = data.caster.mountpoint;\n"
+"                document.getElementById('caster_user').value = data.caster.user;\n"
+"                document.getElementById('caster_max_clients').value = data.caster.max_clients;\n"
+"                document.getElementById('nmea_tcp_enabled').checked = data.nmea_server.tcp_enabled;\n"
+"                document.getElementById('nmea_tcp_port').value = data.nmea_server.tcp_port;\n"
+"                document.getElementById('nmea_max_clients').value = data.nmea_server.max_clients;\n"
+"                document.getElementById('nmea_udp_enabled').checked = data.nmea_server.udp_enabled;\n"
+"                document.getElementById('nmea_udp_port').value = data.nmea_server.udp_port;\n"
+"                document.getElementById('data_output_binary').checked = data.data_output.format === 'binary';\n"
+"                document.getElementById('data_output_interval_ms').value = data.data_output.interval_ms;\n"
+"                document.getElementById('data_output_baud_rate').value = data.data_output.baud_rate;\n"
+"                document.getElementById('data_output_predict').checked = data.data_output.predict !== 'off';\n"
+"                document.getElementById('data_output_predict').dataset.mode = data.data_output.predict;\n"
+"                document.getElementById('data_output_uart_enabled').checked = data.data_output.uart_enabled;\n"
+"                document.getElementById('data_output_uart2_enabled').checked = data.data_output.uart2_enabled;\n"
+"                document.getElementById('data_output_udp_enabled').checked = data.data_output.udp_enabled;\n"
+"                document.getElementById('data_output_udp_port').value = data.data_output.udp_port;\n"
+"                document.getElementById('data_output_tcp_enabled').checked = data.data_output.tcp_enabled;\n"
+"                document.getElementById('data_output_tcp_port').value = data.data_output.tcp_port;\n"
 "            }).catch(e => showStatus('Failed to load configuration', 'error'));\n"
 "        }\n"
 "        function saveConfig() {\n"
@@ -344,21 +541,66 @@ static const char* html_page =
 "                ui: { password: document.getElementById('ui_password').value },\n"
 "                wifi: { ssid: document.getElementById('wifi_ssid').value, password: document.getElementById('wifi_password').value, ap_password: document.getElementById('ap_password').value },\n"
 "                ntrip: { enabled: document.getElementById('ntrip_enabled').checked, host: document.getElementById('ntrip_host').value,\n"
-"                         port: parseInt(document.getElementById('ntrip_port').value), mountpoint: document.getElementById('ntrip_mountpoint').value,\n"
+"                         port: parseInt(document.getElementById('ntrip_port').value), use_tls: document.getElementById('ntrip_use_tls').checked,\n"
+"                         mountpoint: document.getElementById('ntrip_mountpoint').value,\n"
 "                         user: document.getElementById('ntrip_user').value, password: document.getElementById('ntrip_password').value,\n"
-"                         gga_interval_sec: parseInt(document.getElementById('ntrip_gga_interval').value), reconnect_delay_sec: 5 },\n"
+"                         gga_interval_sec: parseInt(document.getElementById('ntrip_gga_interval').value),\n"
+"                         gga_min_interval_sec: parseInt(document.getElementById('ntrip_gga_min_interval').value),\n"
+"                         gga_distance_m: parseInt(document.getElementById('ntrip_gga_distance').value), reconnect_delay_sec: 5 },\n"
 "                mqtt: { enabled: document.getElementById('mqtt_enabled').checked, broker: document.getElementById('mqtt_broker').value,\n"
 "                        port: parseInt(document.getElementById('mqtt_port').value), topic: topic,\n"
 "                        user: document.getElementById('mqtt_user').value, password: document.getElementById('mqtt_password').value,\n"
 "                        gnss_interval_sec: parseInt(document.getElementById('mqtt_gnss_interval').value),\n"
 "                        status_interval_sec: parseInt(document.getElementById('mqtt_status_interval').value),\n"
-"                        stats_interval_sec: parseInt(document.getElementById('mqtt_stats_interval').value) }\n"
+"                        stats_interval_sec: parseInt(document.getElementById('mqtt_stats_interval').value),\n"
+"                        gnss_encoding: document.getElementById('mqtt_gnss_cbor').checked ? 'cbor' : 'json',\n"
+"                        status_encoding: document.getElementById('mqtt_status_cbor').checked ? 'cbor' : 'json',\n"
+"                        stats_encoding: document.getElementById('mqtt_stats_cbor').checked ? 'cbor' : 'json',\n"
+"                        gnss_batch_size: parseInt(document.getElementById('mqtt_gnss_batch_size').value),\n"
+"                        gnss_batch_ms: parseInt(document.getElementById('mqtt_gnss_batch_ms').value),\n"
+"                        gnss_interval_ms: parseInt(document.getElementById('mqtt_gnss_interval_ms').value),\n"
+"                        gnss_every_n: parseInt(document.getElementById('mqtt_gnss_every_n').value),\n"
+"                        gnss_deadband_m: parseInt(document.getElementById('mqtt_gnss_deadband').value),\n"
+"                        gnss_heartbeat_sec: parseInt(document.getElementById('mqtt_gnss_heartbeat').value),\n"
+"                        gnss_simplify_cm: parseInt(document.getElementById('mqtt_gnss_simplify').value),\n"
+"                        outbox_enabled: document.getElementById('mqtt_outbox_enabled').checked,\n"
+"                        outbox_rate: parseInt(document.getElementById('mqtt_outbox_rate').value),\n"
+"                        gnss_qos: document.getElementById('mqtt_gnss_qos').checked ? 1 : 0,\n"
+"                        status_qos: document.getElementById('mqtt_status_qos').checked ? 1 : 0,\n"
+"                        stats_qos: document.getElementById('mqtt_stats_qos').checked ? 1 : 0,\n"
+"                        qos_window: parseInt(document.getElementById('mqtt_qos_window').value),\n"
+"                        qos_queue_kb: parseInt(document.getElementById('mqtt_qos_queue_kb').value) },\n"
+"                caster: { enabled: document.getElementById('caster_enabled').checked, port: parseInt(document.getElementById('caster_port').value),\n"
+"                          mountpoint: document.getElementById('caster_mountpoint').value, user: document.getElementById('caster_user').value,\n"
+"                          password: document.getElementById('caster_password').value,\n"
+"                          max_clients: parseInt(document.getElementById('caster_max_clients').value) },\n"
+"                nmea_server: { tcp_enabled: document.getElementById('nmea_tcp_enabled').checked, tcp_port: parseInt(document.getElementById('nmea_tcp_port').value),\n"
+"                               max_clients: parseInt(document.getElementById('nmea_max_clients').value),\n"
+"                               udp_enabled: document.getElementById('nmea_udp_enabled').checked, udp_port: parseInt(document.getElementById('nmea_udp_port').value) },\n"
+"                data_output: { format: document.getElementById('data_output_binary').checked ? 'binary' : 'csv',\n"
+"                               interval_ms: parseInt(document.getElementById('data_output_interval_ms').value),\n"
+"                               baud_rate: parseInt(document.getElementById('data_output_baud_rate').value),\n"
+"                               predict: !document.getElementById('data_output_predict').checked ? 'off' :\n"
+"                                        (document.getElementById('data_output_predict').dataset.mode === 'cv' ? 'cv' : 'ctrv'),\n"
+"                               uart_enabled: document.getElementById('data_output_uart_enabled').checked,\n"
+"                               uart2_enabled: document.getElementById('data_output_uart2_enabled').checked,\n"
+"                               udp_enabled: document.getElementById('data_output_udp_enabled').checked,\n"
+"                               udp_port: parseInt(document.getElementById('data_output_udp_port').value),\n"
+"                               tcp_enabled: document.getElementById('data_output_tcp_enabled').checked,\n"
+"                               tcp_port: parseInt(document.getElementById('data_output_tcp_port').value) }\n"
 "            };\n"
 "            fetch('/api/config', { method: 'POST', headers: Object.assign({'Content-Type': 'application/json'}, getAuthHeaders()), body: JSON.stringify(config) })\n"
 "            .then(r => { if (r.status === 401) { logout(); return Promise.reject('Unauthorized'); } return r.json(); })\n"
 "            .then(data => showStatus(data.message, data.status === 'ok' ? 'success' : 'error'))\n"
 "            .catch(e => showStatus('Failed to save configuration', 'error'));\n"
 "        }\n"
+"        function uploadCa() {\n"
+"            const pem = document.getElementById('ntrip_ca').value.trim();\n"
+"            fetch('/api/ntrip/ca', { method: 'POST', headers: Object.assign({'Content-Type': 'application/x-pem-file'}, getAuthHeaders()), body: pem })\n"
+"            .then(r => { if (r.status === 401) { logout(); return Promise.reject('Unauthorized'); } return r.json(); })\n"
+"            .then(data => { showStatus(data.message, data.status === 'ok' ? 'success' : 'error'); if (data.status === 'ok') loadConfig(); })\n"
+"            .catch(e => showStatus('Failed to save CA certificate', 'error'));\n"
+"        }\n"
 "        function restartDevice() {\n"
 "            if(confirm('Restart device?')) {\n"
 "                fetch('/api/restart', {method: 'POST', headers: getAuthHeaders()}).then(r => { if (r.status === 401) { logout(); return Promise.reject('Unauthorized'); } return r.json(); }).then(() => showStatus('Device restarting...', 'success'));\n"
@@ -526,6 +768,30 @@ static bool check_auth(httpd_req_t *req) {
     return strcmp(token, SESSION_TOKEN) == 0;
 }
 
+// Name of an MQTT payload encoding in /api/config
+static const char *mqtt_encoding_name(uint8_t encoding) {
+    return encoding == MQTT_ENCODING_CBOR ? "cbor" : "json";
+}
+
+/**
+ * @brief Check an optional number of a POST /api/config section against its range
+ *
+ * Values are stored in narrow fields, so an out of range value would be
+ * truncated instead of refused.
+ *
+ * @return false if present and out of range; a 400 response with message has been sent
+ */
+static bool config_number_valid(httpd_req_t *req, const cJSON *item, int min, int max, const char *message) {
+    if (item == NULL || !cJSON_IsNumber(item) || (item->valueint >= min && item->valueint <= max)) {
+        return true;
+    }
+    char body[160];
+    snprintf(body, sizeof(body), "{\"status\":\"error\",\"message\":\"%s\"}", message);
+    httpd_resp_set_status(req, "400 Bad Request");
+    httpd_resp_sendstr(req, body);
+    return false;
+}
+
 /**
  * @brief Handler for GET /api/config
  */
@@ -564,10 +830,14 @@ static esp_err_t api_config_get_handler(httpd_req_t *req) {
     cJSON *ntrip = cJSON_CreateObject();
     cJSON_AddStringToObject(ntrip, "host", config.ntrip.host);
     cJSON_AddNumberToObject(ntrip, "port", config.ntrip.port);
+    cJSON_AddBoolToObject(ntrip, "use_tls", config.ntrip.use_tls);
+    cJSON_AddBoolToObject(ntrip, "custom_ca", config_get_ntrip_ca(NULL, 0) == ESP_OK);
     cJSON_AddStringToObject(ntrip, "mountpoint", config.ntrip.mountpoint);
     cJSON_AddStringToObject(ntrip, "user", config.ntrip.user);
     cJSON_AddStringToObject(ntrip, "password", "********");
     cJSON_AddNumberToObject(ntrip, "gga_interval_sec", config.ntrip.gga_interval_sec);
+    cJSON_AddNumberToObject(ntrip, "gga_min_interval_sec", config.ntrip.gga_min_interval_sec);
+    cJSON_AddNumberToObject(ntrip, "gga_distance_m", config.ntrip.gga_distance_m);
     cJSON_AddNumberToObject(ntrip, "reconnect_delay_sec", config.ntrip.reconnect_delay_sec);
     cJSON_AddBoolToObject(ntrip, "enabled", config.ntrip.enabled);
     cJSON_AddItemToObject(root, "ntrip", ntrip);
@@ -583,8 +853,56 @@ static esp_err_t api_config_get_handler(httpd_req_t *req) {
     cJSON_AddNumberToObject(mqtt, "status_interval_sec", config.mqtt.status_interval_sec);
     cJSON_AddNumberToObject(mqtt, "stats_interval_sec", config.mqtt.stats_interval_sec);
     cJSON_AddBoolToObject(mqtt, "enabled", config.mqtt.enabled);
+    cJSON_AddStringToObject(mqtt, "gnss_encoding", mqtt_encoding_name(config.mqtt.gnss_encoding));
+    cJSON_AddStringToObject(mqtt, "status_encoding", mqtt_encoding_name(config.mqtt.status_encoding));
+    cJSON_AddStringToObject(mqtt, "stats_encoding", mqtt_encoding_name(config.mqtt.stats_encoding));
+    cJSON_AddNumberToObject(mqtt, "gnss_batch_size", config.mqtt.gnss_batch_size);
+    cJSON_AddNumberToObject(mqtt, "gnss_batch_ms", config.mqtt.gnss_batch_ms);
+    cJSON_AddNumberToObject(mqtt, "gnss_interval_ms", config.mqtt.gnss_interval_ms);
+    cJSON_AddNumberToObject(mqtt, "gnss_every_n", config.mqtt.gnss_every_n);
+    cJSON_AddNumberToObject(mqtt, "gnss_deadband_m", config.mqtt.gnss_deadband_m);
+    cJSON_AddNumberToObject(mqtt, "gnss_heartbeat_sec", config.mqtt.gnss_heartbeat_sec);
+    cJSON_AddNumberToObject(mqtt, "gnss_simplify_cm", config.mqtt.gnss_simplify_cm);
+    cJSON_AddBoolToObject(mqtt, "outbox_enabled", config.mqtt.outbox_enabled);
+    cJSON_AddNumberToObject(mqtt, "outbox_rate", config.mqtt.outbox_rate);
+    cJSON_AddNumberToObject(mqtt, "gnss_qos", config.mqtt.gnss_qos);
+    cJSON_AddNumberToObject(mqtt, "status_qos", config.mqtt.status_qos);
+    cJSON_AddNumberToObject(mqtt, "stats_qos", config.mqtt.stats_qos);
+    cJSON_AddNumberToObject(mqtt, "qos_window", config.mqtt.qos_window);
+    cJSON_AddNumberToObject(mqtt, "qos_queue_kb", config.mqtt.qos_queue_kb);
     cJSON_AddItemToObject(root, "mqtt", mqtt);
     
+    cJSON *caster = cJSON_CreateObject();
+    cJSON_AddNumberToObject(caster, "port", config.caster.port);
+    cJSON_AddStringToObject(caster, "mountpoint", config.caster.mountpoint);
+    cJSON_AddStringToObject(caster, "user", config.caster.user);
+    cJSON_AddStringToObject(caster, "password", "********");
+    cJSON_AddNumberToObject(caster, "max_clients", config.caster.max_clients);
+    cJSON_AddBoolToObject(caster, "enabled", config.caster.enabled);
+    cJSON_AddItemToObject(root, "caster", caster);
+    
+    cJSON *nmea_server = cJSON_CreateObject();
+    cJSON_AddNumberToObject(nmea_server, "tcp_port", config.nmea_server.tcp_port);
+    cJSON_AddNumberToObject(nmea_server, "max_clients", config.nmea_server.max_clients);
+    cJSON_AddBoolToObject(nmea_server, "tcp_enabled", config.nmea_server.tcp_enabled);
+    cJSON_AddNumberToObject(nmea_server, "udp_port", config.nmea_server.udp_port);
+    cJSON_AddBoolToObject(nmea_server, "udp_enabled", config.nmea_server.udp_enabled);
+    cJSON_AddItemToObject(root, "nmea_server", nmea_server);
+
+    cJSON *data_output = cJSON_CreateObject();
+    cJSON_AddStringToObject(data_output, "format",
+                            config.data_output.format == DATA_OUTPUT_FORMAT_BINARY ? "binary" : "csv");
+    cJSON_AddNumberToObject(data_output, "interval_ms", config.data_output.interval_ms);
+    cJSON_AddNumberToObject(data_output, "baud_rate", config.data_output.baud_rate);
+    cJSON_AddStringToObject(data_output, "predict", config_data_output_predict_name(config.data_output.predict));
+    cJSON_AddBoolToObject(data_output, "uart_enabled", config.data_output.uart_enabled);
+    cJSON_AddBoolToObject(data_output, "uart2_enabled", config.data_output.uart2_enabled);
+    cJSON_AddBoolToObject(data_output, "udp_enabled", config.data_output.udp_enabled);
+    cJSON_AddNumberToObject(data_output, "udp_port", config.data_output.udp_port);
+    cJSON_AddBoolToObject(data_output, "tcp_enabled", config.data_output.tcp_enabled);
+    cJSON_AddNumberToObject(data_output, "tcp_port", config.data_output.tcp_port);
+    cJSON_AddItemToObject(root, "data_output", data_output);
+    
     char *json_string = cJSON_Print(root);
     httpd_resp_set_type(req, "application/json");
     httpd_resp_sendstr(req, json_string);
@@ -604,7 +922,7 @@ static esp_err_t api_config_post_handler(httpd_req_t *req) {
         httpd_resp_sendstr(req, "{\"status\":\"error\",\"message\":\"Unauthorized\"}");
         return ESP_FAIL;
     }
-    char content[2048];
+    char content[2560];
     int ret, remaining = req->content_len;
     
     if (remaining >= sizeof(content)) {
@@ -638,6 +956,9 @@ static esp_err_t api_config_post_handler(httpd_req_t *req) {
     bool wifi_changed = false;
     bool ntrip_changed = false;
     bool mqtt_changed = false;
+    bool caster_changed = false;
+    bool nmea_server_changed = false;
+    bool data_output_changed = false;
     
     // Parse UI config
     cJSON *ui = cJSON_GetObjectItem(root, "ui");
@@ -683,6 +1004,9 @@ static esp_err_t api_config_post_handler(httpd_req_t *req) {
         cJSON *user = cJSON_GetObjectItem(ntrip, "user");
         cJSON *password = cJSON_GetObjectItem(ntrip, "password");
         cJSON *gga_interval = cJSON_GetObjectItem(ntrip, "gga_interval_sec");
+        cJSON *use_tls = cJSON_GetObjectItem(ntrip, "use_tls");
+        cJSON *gga_min_interval = cJSON_GetObjectItem(ntrip, "gga_min_interval_sec");
+        cJSON *gga_distance = cJSON_GetObjectItem(ntrip, "gga_distance_m");
         
         if (enabled && cJSON_IsBool(enabled)) { config.ntrip.enabled = cJSON_IsTrue(enabled); ntrip_changed = true; }
         if (host && cJSON_IsString(host)) { strncpy(config.ntrip.host, host->valuestring, sizeof(config.ntrip.host) - 1); ntrip_changed = true; }
@@ -695,6 +1019,9 @@ static esp_err_t api_config_post_handler(httpd_req_t *req) {
             ntrip_changed = true;
         }
         if (gga_interval && cJSON_IsNumber(gga_interval)) { config.ntrip.gga_interval_sec = gga_interval->valueint; ntrip_changed = true; }
+        if (use_tls && cJSON_IsBool(use_tls)) { config.ntrip.use_tls = cJSON_IsTrue(use_tls); ntrip_changed = true; }
+        if (gga_min_interval && cJSON_IsNumber(gga_min_interval)) { config.ntrip.gga_min_interval_sec = gga_min_interval->valueint; ntrip_changed = true; }
+        if (gga_distance && cJSON_IsNumber(gga_distance)) { config.ntrip.gga_distance_m = gga_distance->valueint; ntrip_changed = true; }
     }
     
     // Parse MQTT config
@@ -709,6 +1036,33 @@ static esp_err_t api_config_post_handler(httpd_req_t *req) {
         cJSON *gnss_interval = cJSON_GetObjectItem(mqtt, "gnss_interval_sec");
         cJSON *status_interval = cJSON_GetObjectItem(mqtt, "status_interval_sec");
         cJSON *stats_interval = cJSON_GetObjectItem(mqtt, "stats_interval_sec");
+        cJSON *gnss_batch_size = cJSON_GetObjectItem(mqtt, "gnss_batch_size");
+        cJSON *gnss_batch_ms = cJSON_GetObjectItem(mqtt, "gnss_batch_ms");
+        cJSON *gnss_interval_ms = cJSON_GetObjectItem(mqtt, "gnss_interval_ms");
+        cJSON *gnss_every_n = cJSON_GetObjectItem(mqtt, "gnss_every_n");
+        cJSON *gnss_deadband = cJSON_GetObjectItem(mqtt, "gnss_deadband_m");
+        cJSON *gnss_heartbeat = cJSON_GetObjectItem(mqtt, "gnss_heartbeat_sec");
+        cJSON *gnss_simplify = cJSON_GetObjectItem(mqtt, "gnss_simplify_cm");
+        cJSON *outbox_enabled = cJSON_GetObjectItem(mqtt, "outbox_enabled");
+        cJSON *outbox_rate = cJSON_GetObjectItem(mqtt, "outbox_rate");
+        cJSON *qos_window = cJSON_GetObjectItem(mqtt, "qos_window");
+        cJSON *qos_queue_kb = cJSON_GetObjectItem(mqtt, "qos_queue_kb");
+        cJSON *qos_levels[3] = {
+            cJSON_GetObjectItem(mqtt, "gnss_qos"),
+            cJSON_GetObjectItem(mqtt, "status_qos"),
+            cJSON_GetObjectItem(mqtt, "stats_qos")
+        };
+        uint8_t *qos_fields[3] = {
+            &config.mqtt.gnss_qos, &config.mqtt.status_qos, &config.mqtt.stats_qos
+        };
+        cJSON *encodings[3] = {
+            cJSON_GetObjectItem(mqtt, "gnss_encoding"),
+            cJSON_GetObjectItem(mqtt, "status_encoding"),
+            cJSON_GetObjectItem(mqtt, "stats_encoding")
+        };
+        uint8_t *encoding_fields[3] = {
+            &config.mqtt.gnss_encoding, &config.mqtt.status_encoding, &config.mqtt.stats_encoding
+        };
         
         if (enabled && cJSON_IsBool(enabled)) { config.mqtt.enabled = cJSON_IsTrue(enabled); mqtt_changed = true; }
         if (broker && cJSON_IsString(broker)) { strncpy(config.mqtt.broker, broker->valuestring, sizeof(config.mqtt.broker) - 1); mqtt_changed = true; }
@@ -734,6 +1088,177 @@ static esp_err_t api_config_post_handler(httpd_req_t *req) {
         if (gnss_interval && cJSON_IsNumber(gnss_interval)) { config.mqtt.gnss_interval_sec = gnss_interval->valueint; mqtt_changed = true; }
         if (status_interval && cJSON_IsNumber(status_interval)) { config.mqtt.status_interval_sec = status_interval->valueint; mqtt_changed = true; }
         if (stats_interval && cJSON_IsNumber(stats_interval)) { config.mqtt.stats_interval_sec = stats_interval->valueint; mqtt_changed = true; }
+        if (!config_number_valid(req, gnss_batch_size, 1, MQTT_GNSS_BATCH_MAX_EPOCHS, "MQTT GNSS batch size must be 1 to 32 epochs.") ||
+            !config_number_valid(req, gnss_batch_ms, MQTT_GNSS_BATCH_MIN_MS, MQTT_GNSS_BATCH_MAX_MS, "MQTT GNSS batch time must be 100 to 60000 ms.") ||
+            (gnss_interval_ms && cJSON_IsNumber(gnss_interval_ms) && gnss_interval_ms->valueint != 0 &&
+             !config_number_valid(req, gnss_interval_ms, MQTT_GNSS_INTERVAL_MIN_MS, MQTT_GNSS_INTERVAL_MAX_MS, "MQTT GNSS interval must be 0 or 100 to 60000 ms.")) ||
+            !config_number_valid(req, gnss_every_n, 0, 255, "MQTT GNSS every N must be 0 to 255.") ||
+            !config_number_valid(req, gnss_deadband, 0, MQTT_GNSS_DEADBAND_MAX_M, "MQTT GNSS deadband must be 0 to 10000 m.") ||
+            !config_number_valid(req, gnss_heartbeat, 1, 65535, "MQTT GNSS heartbeat must be 1 to 65535 s.") ||
+            !config_number_valid(req, gnss_simplify, 0, MQTT_GNSS_SIMPLIFY_MAX_CM, "MQTT GNSS simplification must be 0 to 10000 cm.")) {
+            cJSON_Delete(root);
+            return ESP_FAIL;
+        }
+        if (gnss_batch_size && cJSON_IsNumber(gnss_batch_size)) { config.mqtt.gnss_batch_size = gnss_batch_size->valueint; mqtt_changed = true; }
+        if (gnss_batch_ms && cJSON_IsNumber(gnss_batch_ms)) { config.mqtt.gnss_batch_ms = gnss_batch_ms->valueint; mqtt_changed = true; }
+        if (gnss_interval_ms && cJSON_IsNumber(gnss_interval_ms)) { config.mqtt.gnss_interval_ms = gnss_interval_ms->valueint; mqtt_changed = true; }
+        if (gnss_every_n && cJSON_IsNumber(gnss_every_n)) { config.mqtt.gnss_every_n = gnss_every_n->valueint; mqtt_changed = true; }
+        if (gnss_deadband && cJSON_IsNumber(gnss_deadband)) { config.mqtt.gnss_deadband_m = gnss_deadband->valueint; mqtt_changed = true; }
+        if (gnss_heartbeat && cJSON_IsNumber(gnss_heartbeat)) { config.mqtt.gnss_heartbeat_sec = gnss_heartbeat->valueint; mqtt_changed = true; }
+        if (gnss_simplify && cJSON_IsNumber(gnss_simplify)) { config.mqtt.gnss_simplify_cm = gnss_simplify->valueint; mqtt_changed = true; }
+        if (outbox_enabled && cJSON_IsBool(outbox_enabled)) { config.mqtt.outbox_enabled = cJSON_IsTrue(outbox_enabled); mqtt_changed = true; }
+        if (!config_number_valid(req, outbox_rate, MQTT_OUTBOX_RATE_MIN, MQTT_OUTBOX_RATE_MAX, "MQTT outbox rate must be 1 to 100 messages per second.")) {
+            cJSON_Delete(root);
+            return ESP_FAIL;
+        }
+        if (outbox_rate && cJSON_IsNumber(outbox_rate)) { config.mqtt.outbox_rate = outbox_rate->valueint; mqtt_changed = true; }
+        if (!config_number_valid(req, qos_window, MQTT_QOS_WINDOW_MIN, MQTT_QOS_WINDOW_MAX, "MQTT QoS window must be 1 to 16.") ||
+            !config_number_valid(req, qos_queue_kb, MQTT_QOS_QUEUE_MIN_KB, MQTT_QOS_QUEUE_MAX_KB, "MQTT QoS queue must be 2 to 64 KB.")) {
+            cJSON_Delete(root);
+            return ESP_FAIL;
+        }
+        if (qos_window && cJSON_IsNumber(qos_window)) { config.mqtt.qos_window = qos_window->valueint; mqtt_changed = true; }
+        if (qos_queue_kb && cJSON_IsNumber(qos_queue_kb)) { config.mqtt.qos_queue_kb = qos_queue_kb->valueint; mqtt_changed = true; }
+        for (int i = 0; i < 3; i++) {
+            if (qos_levels[i] && cJSON_IsNumber(qos_levels[i])) {
+                if (qos_levels[i]->valueint != 0 && qos_levels[i]->valueint != 1) {
+                    httpd_resp_set_status(req, "400 Bad Request");
+                    httpd_resp_sendstr(req, "{\"status\":\"error\",\"message\":\"MQTT QoS must be 0 or 1.\"}");
+                    cJSON_Delete(root);
+                    return ESP_FAIL;
+                }
+                *qos_fields[i] = (uint8_t)qos_levels[i]->valueint;
+                mqtt_changed = true;
+            }
+        }
+        for (int i = 0; i < 3; i++) {
+            if (encodings[i] && cJSON_IsString(encodings[i])) {
+                if (strcmp(encodings[i]->valuestring, "json") == 0) {
+                    *encoding_fields[i] = MQTT_ENCODING_JSON;
+                } else if (strcmp(encodings[i]->valuestring, "cbor") == 0) {
+                    *encoding_fields[i] = MQTT_ENCODING_CBOR;
+                } else {
+                    httpd_resp_set_status(req, "400 Bad Request");
+                    httpd_resp_sendstr(req, "{\"status\":\"error\",\"message\":\"MQTT encoding must be json or cbor.\"}");
+                    cJSON_Delete(root);
+                    return ESP_FAIL;
+                }
+                mqtt_changed = true;
+            }
+        }
+    }
+    
+    // Parse local caster config
+    cJSON *caster = cJSON_GetObjectItem(root, "caster");
+    if (caster) {
+        cJSON *enabled = cJSON_GetObjectItem(caster, "enabled");
+        cJSON *port = cJSON_GetObjectItem(caster, "port");
+        cJSON *mountpoint = cJSON_GetObjectItem(caster, "mountpoint");
+        cJSON *user = cJSON_GetObjectItem(caster, "user");
+        cJSON *password = cJSON_GetObjectItem(caster, "password");
+        cJSON *max_clients = cJSON_GetObjectItem(caster, "max_clients");
+
+        if (enabled && cJSON_IsBool(enabled)) { config.caster.enabled = cJSON_IsTrue(enabled); caster_changed = true; }
+        if (port && cJSON_IsNumber(port) && port->valueint > 0 && port->valueint <= 65535) { config.caster.port = port->valueint; caster_changed = true; }
+        if (mountpoint && cJSON_IsString(mountpoint) && strlen(mountpoint->valuestring) > 0) {
+            // Mountpoint is matched without the leading slash
+            const char *m = mountpoint->valuestring;
+            if (m[0] == '/') m++;
+            memset(config.caster.mountpoint, 0, sizeof(config.caster.mountpoint));
+            strncpy(config.caster.mountpoint, m, sizeof(config.caster.mountpoint) - 1);
+            caster_changed = true;
+        }
+        if (user && cJSON_IsString(user)) {
+            memset(config.caster.user, 0, sizeof(config.caster.user));
+            strncpy(config.caster.user, user->valuestring, sizeof(config.caster.user) - 1);
+            caster_changed = true;
+        }
+        if (password && cJSON_IsString(password) && strlen(password->valuestring) > 0) {
+            memset(config.caster.password, 0, sizeof(config.caster.password));
+            strncpy(config.caster.password, password->valuestring, sizeof(config.caster.password) - 1);
+            caster_changed = true;
+        }
+        if (max_clients && cJSON_IsNumber(max_clients) && max_clients->valueint >= 1 && max_clients->valueint <= CASTER_MAX_CLIENTS) {
+            config.caster.max_clients = max_clients->valueint;
+            caster_changed = true;
+        }
+    }
+    
+    // Parse NMEA server config
+    cJSON *nmea_server = cJSON_GetObjectItem(root, "nmea_server");
+    if (nmea_server) {
+        cJSON *tcp_enabled = cJSON_GetObjectItem(nmea_server, "tcp_enabled");
+        cJSON *tcp_port = cJSON_GetObjectItem(nmea_server, "tcp_port");
+        cJSON *max_clients = cJSON_GetObjectItem(nmea_server, "max_clients");
+        cJSON *udp_enabled = cJSON_GetObjectItem(nmea_server, "udp_enabled");
+        cJSON *udp_port = cJSON_GetObjectItem(nmea_server, "udp_port");
+        
+        if (tcp_enabled && cJSON_IsBool(tcp_enabled)) { config.nmea_server.tcp_enabled = cJSON_IsTrue(tcp_enabled); nmea_server_changed = true; }
+        if (tcp_port && cJSON_IsNumber(tcp_port) && tcp_port->valueint > 0 && tcp_port->valueint <= 65535) { config.nmea_server.tcp_port = tcp_port->valueint; nmea_server_changed = true; }
+        if (max_clients && cJSON_IsNumber(max_clients) && max_clients->valueint >= 1 && max_clients->valueint <= NMEA_SERVER_MAX_CLIENTS) {
+            config.nmea_server.max_clients = max_clients->valueint;
+            nmea_server_changed = true;
+        }
+        if (udp_enabled && cJSON_IsBool(udp_enabled)) { config.nmea_server.udp_enabled = cJSON_IsTrue(udp_enabled); nmea_server_changed = true; }
+        if (udp_port && cJSON_IsNumber(udp_port) && udp_port->valueint > 0 && udp_port->valueint <= 65535) { config.nmea_server.udp_port = udp_port->valueint; nmea_server_changed = true; }
+    }
+
+    // Parse telemetry data output config
+    cJSON *data_output = cJSON_GetObjectItem(root, "data_output");
+    if (data_output) {
+        cJSON *format = cJSON_GetObjectItem(data_output, "format");
+        if (format && cJSON_IsString(format)) {
+            if (strcmp(format->valuestring, "csv") == 0) {
+                config.data_output.format = DATA_OUTPUT_FORMAT_CSV;
+            } else if (strcmp(format->valuestring, "binary") == 0) {
+                config.data_output.format = DATA_OUTPUT_FORMAT_BINARY;
+            } else {
+                httpd_resp_set_status(req, "400 Bad Request");
+                httpd_resp_sendstr(req, "{\"status\":\"error\",\"message\":\"Data output format must be csv or binary.\"}");
+                cJSON_Delete(root);
+                return ESP_FAIL;
+            }
+            data_output_changed = true;
+        }
+        cJSON *interval_ms = cJSON_GetObjectItem(data_output, "interval_ms");
+        if (interval_ms && cJSON_IsNumber(interval_ms) && interval_ms->valueint >= 0 && interval_ms->valueint <= DATA_OUTPUT_INTERVAL_MAX_MS) {
+            config.data_output.interval_ms = interval_ms->valueint;
+            data_output_changed = true;
+        }
+        cJSON *baud_rate = cJSON_GetObjectItem(data_output, "baud_rate");
+        if (baud_rate && cJSON_IsNumber(baud_rate)) {
+            if (!config_data_output_baud_valid((uint32_t)baud_rate->valuedouble)) {
+                httpd_resp_set_status(req, "400 Bad Request");
+                httpd_resp_sendstr(req, "{\"status\":\"error\",\"message\":\"Data output baud rate must be 9600, 19200, 38400, 57600, 115200, 230400, 460800 or 921600.\"}");
+                cJSON_Delete(root);
+                return ESP_FAIL;
+            }
+            config.data_output.baud_rate = (uint32_t)baud_rate->valuedouble;
+            data_output_changed = true;
+        }
+        cJSON *predict = cJSON_GetObjectItem(data_output, "predict");
+        if (predict && cJSON_IsString(predict)) {
+            if (!config_data_output_predict_parse(predict->valuestring, &config.data_output.predict)) {
+                httpd_resp_set_status(req, "400 Bad Request");
+                httpd_resp_sendstr(req, "{\"status\":\"error\",\"message\":\"Data output prediction must be off, cv or ctrv.\"}");
+                cJSON_Delete(root);
+                return ESP_FAIL;
+            }
+            data_output_changed = true;
+        }
+        cJSON *uart_enabled = cJSON_GetObjectItem(data_output, "uart_enabled");
+        cJSON *uart2_enabled = cJSON_GetObjectItem(data_output, "uart2_enabled");
+        cJSON *udp_enabled = cJSON_GetObjectItem(data_output, "udp_enabled");
+        cJSON *udp_port = cJSON_GetObjectItem(data_output, "udp_port");
+        cJSON *tcp_enabled = cJSON_GetObjectItem(data_output, "tcp_enabled");
+        cJSON *tcp_port = cJSON_GetObjectItem(data_output, "tcp_port");
+
+        if (uart_enabled && cJSON_IsBool(uart_enabled)) { config.data_output.uart_enabled = cJSON_IsTrue(uart_enabled); data_output_changed = true; }
+        if (uart2_enabled && cJSON_IsBool(uart2_enabled)) { config.data_output.uart2_enabled = cJSON_IsTrue(uart2_enabled); data_output_changed = true; }
+        if (udp_enabled && cJSON_IsBool(udp_enabled)) { config.data_output.udp_enabled = cJSON_IsTrue(udp_enabled); data_output_changed = true; }
+        if (udp_port && cJSON_IsNumber(udp_port) && udp_port->valueint > 0 && udp_port->valueint <= 65535) { config.data_output.udp_port = udp_port->valueint; data_output_changed = true; }
+        if (tcp_enabled && cJSON_IsBool(tcp_enabled)) { config.data_output.tcp_enabled = cJSON_IsTrue(tcp_enabled); data_output_changed = true; }
+        if (tcp_port && cJSON_IsNumber(tcp_port) && tcp_port->valueint > 0 && tcp_port->valueint <= 65535) { config.data_output.tcp_port = tcp_port->valueint; data_output_changed = true; }
     }
     
     cJSON_Delete(root);
@@ -764,6 +1289,30 @@ static esp_err_t api_config_post_handler(httpd_req_t *req) {
             return ESP_FAIL;
         }
     }
+    if (caster_changed) {
+        err = config_set_caster(&config.caster);
+        if (err != ESP_OK) {
+            httpd_resp_set_status(req, "500 Internal Server Error");
+            httpd_resp_sendstr(req, "{\"status\":\"error\",\"message\":\"Failed to save caster configuration\"}");
+            return ESP_FAIL;
+        }
+    }
+    if (nmea_server_changed) {
+        err = config_set_nmea_server(&config.nmea_server);
+        if (err != ESP_OK) {
+            httpd_resp_set_status(req, "500 Internal Server Error");
+            httpd_resp_sendstr(req, "{\"status\":\"error\",\"message\":\"Failed to save NMEA server configuration\"}");
+            return ESP_FAIL;
+        }
+    }
+    if (data_output_changed) {
+        err = config_set_data_output(&config.data_output);
+        if (err != ESP_OK) {
+            httpd_resp_set_status(req, "500 Internal Server Error");
+            httpd_resp_sendstr(req, "{\"status\":\"error\",\"message\":\"Failed to save data output configuration\"}");
+            return ESP_FAIL;
+        }
+    }
     
     // Apply WiFi changes ONLY if WiFi was actually changed
     if (wifi_changed && strlen(config.wifi.ssid) > 0) {
@@ -804,6 +1353,187 @@ static esp_err_t api_status_get_handler(httpd_req_t *req) {
     cJSON_AddBoolToObject(root, "ntrip_connected", ntrip_client_is_connected());
     cJSON_AddBoolToObject(root, "mqtt_connected", mqtt_is_connected());
 
+    // Batched GNSS publishing
+    mqtt_batch_stats_t batch_stats;
+    mqtt_get_batch_stats(&batch_stats);
+    cJSON *mqtt_batch = cJSON_CreateObject();
+    cJSON_AddNumberToObject(mqtt_batch, "batches", batch_stats.batches);
+    cJSON_AddNumberToObject(mqtt_batch, "epochs", batch_stats.epochs);
+    cJSON_AddNumberToObject(mqtt_batch, "messages_saved", batch_stats.messages_saved);
+    cJSON_AddNumberToObject(mqtt_batch, "bytes_saved", (double)batch_stats.bytes_saved);
+    cJSON_AddNumberToObject(mqtt_batch, "simplified_epochs", batch_stats.simplified_epochs);
+    cJSON_AddItemToObject(root, "mqtt_batch", mqtt_batch);
+
+    // Epoch driven GNSS publishing
+    mqtt_gnss_timing_t gnss_timing;
+    mqtt_get_gnss_timing(&gnss_timing);
+    cJSON *mqtt_gnss = cJSON_CreateObject();
+    cJSON_AddNumberToObject(mqtt_gnss, "epochs", gnss_timing.epochs);
+    cJSON_AddNumberToObject(mqtt_gnss, "published", gnss_timing.published);
+    cJSON_AddNumberToObject(mqtt_gnss, "sample_age_last_us", gnss_timing.sample_age_last_us);
+    cJSON_AddNumberToObject(mqtt_gnss, "sample_age_avg_us", gnss_timing.sample_age_avg_us);
+    cJSON_AddNumberToObject(mqtt_gnss, "sample_age_max_us", gnss_timing.sample_age_max_us);
+    cJSON_AddItemToObject(root, "mqtt_gnss", mqtt_gnss);
+
+    // GNSS deadband filter
+    mqtt_deadband_stats_t deadband_stats;
+    mqtt_get_deadband_stats(&deadband_stats);
+    cJSON *mqtt_deadband = cJSON_CreateObject();
+    cJSON_AddNumberToObject(mqtt_deadband, "evaluated", deadband_stats.evaluated);
+    cJSON_AddNumberToObject(mqtt_deadband, "suppressed", deadband_stats.suppressed);
+    cJSON_AddNumberToObject(mqtt_deadband, "suppressed_bytes", (double)deadband_stats.suppressed_bytes);
+    cJSON_AddNumberToObject(mqtt_deadband, "moved", deadband_stats.moved);
+    cJSON_AddNumberToObject(mqtt_deadband, "fix_changes", deadband_stats.fix_changes);
+    cJSON_AddNumberToObject(mqtt_deadband, "heartbeats", deadband_stats.heartbeats);
+    cJSON_AddItemToObject(root, "mqtt_deadband", mqtt_deadband);
+
+    // Store-and-forward outbox in flash
+    mqtt_outbox_stats_t outbox_stats;
+    mqtt_get_outbox_stats(&outbox_stats);
+    cJSON *mqtt_outbox = cJSON_CreateObject();
+    cJSON_AddBoolToObject(mqtt_outbox, "available", outbox_stats.available);
+    cJSON_AddNumberToObject(mqtt_outbox, "capacity_bytes", outbox_stats.capacity_bytes);
+    cJSON_AddNumberToObject(mqtt_outbox, "backlog", outbox_stats.backlog);
+    cJSON_AddNumberToObject(mqtt_outbox, "backlog_bytes", outbox_stats.backlog_bytes);
+    cJSON_AddNumberToObject(mqtt_outbox, "backlog_peak", outbox_stats.backlog_peak);
+    cJSON_AddNumberToObject(mqtt_outbox, "stored", outbox_stats.stored);
+    cJSON_AddNumberToObject(mqtt_outbox, "drained", outbox_stats.drained);
+    cJSON_AddNumberToObject(mqtt_outbox, "dropped", outbox_stats.dropped);
+    cJSON_AddNumberToObject(mqtt_outbox, "corrupt", outbox_stats.corrupt);
+    cJSON_AddNumberToObject(mqtt_outbox, "flash_errors", outbox_stats.flash_errors);
+    cJSON_AddNumberToObject(mqtt_outbox, "sector_erases", outbox_stats.sector_erases);
+    cJSON_AddNumberToObject(mqtt_outbox, "max_sector_erases", outbox_stats.max_sector_erases);
+    cJSON_AddNumberToObject(mqtt_outbox, "bytes_written", (double)outbox_stats.bytes_written);
+    cJSON_AddNumberToObject(mqtt_outbox, "last_drain_messages", outbox_stats.last_drain_messages);
+    cJSON_AddNumberToObject(mqtt_outbox, "last_drain_ms", outbox_stats.last_drain_ms);
+    cJSON_AddNumberToObject(mqtt_outbox, "last_drain_rate", outbox_stats.last_drain_rate);
+    cJSON_AddItemToObject(root, "mqtt_outbox", mqtt_outbox);
+    
+    // QoS 1 queue, in-flight window and PUBACK latency
+    mqtt_qos_stats_t qos_stats;
+    mqtt_get_qos_stats(&qos_stats);
+    cJSON *mqtt_qos = cJSON_CreateObject();
+    cJSON_AddBoolToObject(mqtt_qos, "enabled", qos_stats.enabled);
+    cJSON_AddNumberToObject(mqtt_qos, "gnss_qos", qos_stats.gnss_qos);
+    cJSON_AddNumberToObject(mqtt_qos, "status_qos", qos_stats.status_qos);
+    cJSON_AddNumberToObject(mqtt_qos, "stats_qos", qos_stats.stats_qos);
+    cJSON_AddNumberToObject(mqtt_qos, "window", qos_stats.window);
+    cJSON_AddNumberToObject(mqtt_qos, "in_flight", qos_stats.in_flight);
+    cJSON_AddNumberToObject(mqtt_qos, "in_flight_peak", qos_stats.in_flight_peak);
+    cJSON_AddNumberToObject(mqtt_qos, "queued", qos_stats.queued);
+    cJSON_AddNumberToObject(mqtt_qos, "queued_bytes", qos_stats.queued_bytes);
+    cJSON_AddNumberToObject(mqtt_qos, "queued_peak_bytes", qos_stats.queued_peak_bytes);
+    cJSON_AddNumberToObject(mqtt_qos, "queue_limit_bytes", qos_stats.queue_limit_bytes);
+    cJSON_AddNumberToObject(mqtt_qos, "client_outbox_bytes", qos_stats.client_outbox_bytes);
+    cJSON_AddNumberToObject(mqtt_qos, "sent", qos_stats.sent);
+    cJSON_AddNumberToObject(mqtt_qos, "acked", qos_stats.acked);
+    cJSON_AddNumberToObject(mqtt_qos, "dropped", qos_stats.dropped);
+    cJSON_AddNumberToObject(mqtt_qos, "rejected", qos_stats.rejected);
+    cJSON_AddNumberToObject(mqtt_qos, "lost", qos_stats.lost);
+    cJSON_AddNumberToObject(mqtt_qos, "puback_min_ms", qos_stats.latency_min_ms);
+    cJSON_AddNumberToObject(mqtt_qos, "puback_avg_ms", qos_stats.latency_avg_ms);
+    cJSON_AddNumberToObject(mqtt_qos, "puback_max_ms", qos_stats.latency_max_ms);
+    cJSON_AddNumberToObject(mqtt_qos, "puback_last_ms", qos_stats.latency_last_ms);
+    cJSON *puback_histogram = cJSON_CreateArray();
+    for (int i = 0; i < MQTT_PUBACK_LATENCY_BUCKETS; i++) {
+        cJSON *bucket = cJSON_CreateObject();
+        if (qos_stats.latency_bound_ms[i] > 0) {
+            cJSON_AddNumberToObject(bucket, "le_ms", qos_stats.latency_bound_ms[i]);
+        } else {
+            cJSON_AddStringToObject(bucket, "le_ms", "inf");
+        }
+        cJSON_AddNumberToObject(bucket, "count", qos_stats.latency_count[i]);
+        cJSON_AddItemToArray(puback_histogram, bucket);
+    }
+    cJSON_AddItemToObject(mqtt_qos, "puback_histogram", puback_histogram);
+    cJSON_AddItemToObject(root, "mqtt_qos", mqtt_qos);
+
+    // Local caster status
+    ntrip_caster_stats_t caster_stats;
+    ntrip_caster_get_stats(&caster_stats);
+    cJSON *caster = cJSON_CreateObject();
+    cJSON_AddBoolToObject(caster, "running", caster_stats.running);
+    cJSON_AddNumberToObject(caster, "clients", caster_stats.clients);
+    cJSON_AddNumberToObject(caster, "connections_total", caster_stats.connections_total);
+    cJSON_AddNumberToObject(caster, "rejected_total", caster_stats.rejected_total);
+    cJSON_AddNumberToObject(caster, "evicted_total", caster_stats.evicted_total);
+    cJSON_AddNumberToObject(caster, "bytes_out", (double)caster_stats.bytes_out);
+    cJSON_AddItemToObject(root, "caster", caster);
+
+    // NMEA server status
+    nmea_server_stats_t nmea_stats;
+    nmea_server_get_stats(&nmea_stats);
+    cJSON *nmea_server = cJSON_CreateObject();
+    cJSON_AddBoolToObject(nmea_server, "tcp_running", nmea_stats.tcp_running);
+    cJSON_AddBoolToObject(nmea_server, "udp_running", nmea_stats.udp_running);
+    cJSON_AddNumberToObject(nmea_server, "clients", nmea_stats.clients);
+    cJSON_AddNumberToObject(nmea_server, "connections_total", nmea_stats.connections_total);
+    cJSON_AddNumberToObject(nmea_server, "evicted_total", nmea_stats.evicted_total);
+    cJSON_AddNumberToObject(nmea_server, "lines_in", nmea_stats.lines_in);
+    cJSON_AddNumberToObject(nmea_server, "udp_datagrams", nmea_stats.udp_datagrams);
+    cJSON_AddNumberToObject(nmea_server, "bytes_out", (double)nmea_stats.bytes_out);
+    cJSON_AddItemToObject(root, "nmea_server", nmea_server);
+
+    // Telemetry UART output
+    data_output_stats_t output_stats;
+    data_output_get_stats(&output_stats);
+    cJSON *data_output = cJSON_CreateObject();
+    cJSON_AddStringToObject(data_output, "format",
+                            output_stats.format == DATA_OUTPUT_FORMAT_BINARY ? "binary" : "csv");
+    cJSON_AddNumberToObject(data_output, "frames", output_stats.frames);
+    cJSON_AddNumberToObject(data_output, "bytes", output_stats.bytes);
+    cJSON_AddNumberToObject(data_output, "last_frame_bytes", output_stats.last_frame_bytes);
+    cJSON_AddNumberToObject(data_output, "errors", output_stats.errors);
+    cJSON_AddNumberToObject(data_output, "interval_ms", output_stats.interval_ms);
+    cJSON_AddNumberToObject(data_output, "baud_rate", output_stats.baud_rate);
+    cJSON_AddNumberToObject(data_output, "epochs", output_stats.epochs);
+    cJSON_AddNumberToObject(data_output, "free_running_frames", output_stats.free_running_frames);
+    cJSON_AddNumberToObject(data_output, "tx_overruns", output_stats.tx_overruns);
+    cJSON_AddNumberToObject(data_output, "latency_last_us", output_stats.latency_last_us);
+    cJSON_AddNumberToObject(data_output, "latency_avg_us", output_stats.latency_avg_us);
+    cJSON_AddNumberToObject(data_output, "latency_max_us", output_stats.latency_max_us);
+    cJSON_AddNumberToObject(data_output, "latency_p50_us", output_stats.latency_p50_us);
+    cJSON_AddNumberToObject(data_output, "latency_p99_us", output_stats.latency_p99_us);
+    cJSON_AddNumberToObject(data_output, "jitter_last_us", output_stats.jitter_last_us);
+    cJSON_AddNumberToObject(data_output, "jitter_avg_us", output_stats.jitter_avg_us);
+    cJSON_AddNumberToObject(data_output, "jitter_max_us", output_stats.jitter_max_us);
+    cJSON_AddStringToObject(data_output, "predict", config_data_output_predict_name(output_stats.predict));
+    cJSON_AddNumberToObject(data_output, "predicted_frames", output_stats.predicted_frames);
+    cJSON_AddNumberToObject(data_output, "horizon_last_ms", output_stats.horizon_last_ms);
+    cJSON_AddNumberToObject(data_output, "horizon_max_ms", output_stats.horizon_max_ms);
+    static const char* sink_names[DATA_OUTPUT_SINK_COUNT] = {"uart", "uart2", "udp", "tcp"};
+    cJSON *sinks = cJSON_CreateObject();
+    for (int i = 0; i < DATA_OUTPUT_SINK_COUNT; i++) {
+        const data_output_sink_stats_t* sink_stats = &output_stats.sinks[i];
+        cJSON *sink = cJSON_CreateObject();
+        cJSON_AddBoolToObject(sink, "active", sink_stats->active);
+        cJSON_AddNumberToObject(sink, "frames", sink_stats->frames);
+        cJSON_AddNumberToObject(sink, "bytes", sink_stats->bytes);
+        cJSON_AddNumberToObject(sink, "dropped", sink_stats->dropped);
+        cJSON_AddNumberToObject(sink, "pending", sink_stats->pending);
+        cJSON_AddNumberToObject(sink, "max_pending", sink_stats->max_pending);
+        cJSON_AddItemToObject(sinks, sink_names[i], sink);
+    }
+    cJSON_AddItemToObject(data_output, "sinks", sinks);
+    cJSON_AddNumberToObject(data_output, "tcp_clients", output_stats.tcp_clients);
+    cJSON_AddNumberToObject(data_output, "tcp_connections", output_stats.tcp_connections);
+    cJSON_AddNumberToObject(data_output, "tcp_rejected", output_stats.tcp_rejected);
+    cJSON_AddItemToObject(root, "data_output", data_output);
+
+    // NTRIP TLS handshake statistics
+    ntrip_tls_stats_t tls_stats;
+    ntrip_client_get_tls_stats(&tls_stats);
+    cJSON *ntrip_tls = cJSON_CreateObject();
+    cJSON_AddBoolToObject(ntrip_tls, "enabled", tls_stats.enabled);
+    cJSON_AddNumberToObject(ntrip_tls, "full_handshakes", tls_stats.full_handshakes);
+    cJSON_AddNumberToObject(ntrip_tls, "resumed_handshakes", tls_stats.resumed_handshakes);
+    cJSON_AddNumberToObject(ntrip_tls, "failed_handshakes", tls_stats.failed_handshakes);
+    cJSON_AddNumberToObject(ntrip_tls, "full_avg_ms", tls_stats.full_avg_ms);
+    cJSON_AddNumberToObject(ntrip_tls, "resumed_avg_ms", tls_stats.resumed_avg_ms);
+    cJSON_AddNumberToObject(ntrip_tls, "last_ms", tls_stats.last_ms);
+    cJSON_AddBoolToObject(ntrip_tls, "last_resumed", tls_stats.last_resumed);
+    cJSON_AddItemToObject(root, "ntrip_tls", ntrip_tls);
+
     // System status
     cJSON *system = cJSON_CreateObject();
     cJSON_AddNumberToObject(system, "uptime_sec", esp_timer_get_time() / 1000000);
@@ -830,6 +1560,239 @@ static esp_err_t api_status_get_handler(httpd_req_t *req) {
     return ESP_OK;
 }
 
+/**
+ * @brief Handler for GET /api/tasks
+ * 
+ * CPU usage per task and per core and the loop durations of the
+ * instrumented tasks over the current statistics period.
+ */
+static esp_err_t api_tasks_get_handler(httpd_req_t *req) {
+    if (!check_auth(req)) {
+        httpd_resp_set_status(req, "401 Unauthorized");
+        httpd_resp_sendstr(req, "{\"status\":\"error\",\"message\":\"Unauthorized\"}");
+        return ESP_FAIL;
+    }
+    statistics_tasks_t* tasks = (statistics_tasks_t*)malloc(sizeof(statistics_tasks_t));
+    period_statistics_t* period = (period_statistics_t*)malloc(sizeof(period_statistics_t));
+    if (tasks == NULL || period == NULL || !statistics_get_tasks(tasks)) {
+        free(tasks);
+        free(period);
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_sendstr(req, "{\"status\":\"error\",\"message\":\"Statistics busy\"}");
+        return ESP_FAIL;
+    }
+    memset(period, 0, sizeof(period_statistics_t));
+    statistics_get_period(period);
+
+    cJSON *root = cJSON_CreateObject();
+    cJSON_AddBoolToObject(root, "available", tasks->available);
+    cJSON_AddNumberToObject(root, "elapsed_ms", tasks->elapsed_ms);
+
+    // Load per core
+    cJSON *cores = cJSON_CreateArray();
+    for (int i = 0; i < tasks->cores; i++) {
+        cJSON *core = cJSON_CreateObject();
+        cJSON_AddNumberToObject(core, "core", i);
+        cJSON_AddNumberToObject(core, "load_percent", tasks->core_load_percent[i]);
+        cJSON_AddItemToArray(cores, core);
+    }
+    cJSON_AddItemToObject(root, "cores", cores);
+
+    // All tasks
+    cJSON *list = cJSON_CreateArray();
+    for (int i = 0; i < tasks->task_count; i++) {
+        const statistics_task_info_t* info = &tasks->tasks[i];
+        cJSON *task = cJSON_CreateObject();
+        cJSON_AddStringToObject(task, "name", info->name);
+        cJSON_AddNumberToObject(task, "priority", info->priority);
+        cJSON_AddNumberToObject(task, "core", info->core);
+        cJSON_AddNumberToObject(task, "stack_hwm_bytes", info->stack_hwm_bytes);
+        cJSON_AddNumberToObject(task, "cpu_percent", info->cpu_percent);
+        cJSON_AddItemToArray(list, task);
+    }
+    cJSON_AddItemToObject(root, "tasks", list);
+
+    // Instrumented loops
+    cJSON *loops = cJSON_CreateObject();
+    for (int t = 0; t < STATS_TASK_COUNT; t++) {
+        const statistics_loop_t* loop_stats = &period->task_loops[t];
+        cJSON *loop = cJSON_CreateObject();
+        cJSON_AddNumberToObject(loop, "cpu_percent", period->cpu_usage_percent[t]);
+        cJSON_AddNumberToObject(loop, "loops", loop_stats->loops);
+        cJSON_AddNumberToObject(loop, "avg_us", loop_stats->avg_us);
+        cJSON_AddNumberToObject(loop, "p50_us", loop_stats->p50_us);
+        cJSON_AddNumberToObject(loop, "p99_us", loop_stats->p99_us);
+        cJSON_AddNumberToObject(loop, "max_us", loop_stats->max_us);
+        cJSON_AddItemToObject(loops, statistics_task_name((statistics_task_id_t)t), loop);
+    }
+    cJSON_AddItemToObject(root, "loops", loops);
+    free(tasks);
+    free(period);
+
+    char *json_string = cJSON_Print(root);
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, json_string);
+
+    free(json_string);
+    cJSON_Delete(root);
+
+    return ESP_OK;
+}
+
+// Send a part of the trace download as an HTTP chunk
+static bool trace_send_chunk(const uint8_t* data, size_t length, void* context) {
+    return httpd_resp_send_chunk((httpd_req_t*)context, (const char*)data, length) == ESP_OK;
+}
+
+/**
+ * @brief Handler for GET /api/trace
+ * 
+ * Downloads the task event trace in the binary lib/TraceDump format, sent
+ * in chunks while the rings are encoded. Convert it with the host tool in
+ * tests/TRACEring.
+ */
+static esp_err_t api_trace_get_handler(httpd_req_t *req) {
+    if (!check_auth(req)) {
+        httpd_resp_set_status(req, "401 Unauthorized");
+        httpd_resp_sendstr(req, "{\"status\":\"error\",\"message\":\"Unauthorized\"}");
+        return ESP_FAIL;
+    }
+    httpd_resp_set_type(req, "application/octet-stream");
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"trace.bin\"");
+    esp_err_t result = trace_recorder_write(trace_send_chunk, req);
+    if (result == ESP_ERR_NO_MEM || result == ESP_ERR_INVALID_STATE) {
+        // Nothing sent yet
+        httpd_resp_set_type(req, "application/json");
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_sendstr(req, "{\"status\":\"error\",\"message\":\"Trace not available\"}");
+        return ESP_FAIL;
+    }
+    if (result != ESP_OK) {
+        return ESP_FAIL;
+    }
+    // End of the chunked response
+    httpd_resp_send_chunk(req, NULL, 0);
+    return ESP_OK;
+}
+
+// Send a part of the OpenMetrics exposition or the metric history as an HTTP chunk
+static bool statistics_send_chunk(const char* data, size_t length, void* context) {
+    return httpd_resp_send_chunk((httpd_req_t*)context, data, length) == ESP_OK;
+}
+
+/**
+ * @brief Handler for GET /metrics
+ * 
+ * All statistics in the OpenMetrics text format for a Prometheus scrape,
+ * sent in chunks while they are generated. Prometheus authenticates with
+ * the session token (authorization credentials in the scrape config).
+ */
+static esp_err_t metrics_get_handler(httpd_req_t *req) {
+    if (!check_auth(req)) {
+        httpd_resp_set_status(req, "401 Unauthorized");
+        httpd_resp_sendstr(req, "Unauthorized\n");
+        return ESP_FAIL;
+    }
+    httpd_resp_set_type(req, "application/openmetrics-text; version=1.0.0; charset=utf-8");
+    int result = statistics_write_openmetrics(statistics_send_chunk, req);
+    if (result == -1) {
+        // Nothing sent yet
+        httpd_resp_set_type(req, "text/plain");
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_sendstr(req, "Statistics busy\n");
+        return ESP_FAIL;
+    }
+    if (result != 0) {
+        return ESP_FAIL;
+    }
+    // End of the chunked response
+    httpd_resp_send_chunk(req, NULL, 0);
+    return ESP_OK;
+}
+
+/**
+ * @brief Select the history metrics of a comma separated list of names
+ * 
+ * @param list Names, e.g. "fix_quality,wifi_rssi_dbm"
+ * @param metrics Receives the bit mask of the metrics
+ * @return false on an unknown name
+ */
+static bool parse_history_metrics(char* list, uint32_t* metrics) {
+    *metrics = 0;
+    char* save = NULL;
+    for (char* name = strtok_r(list, ",", &save); name != NULL; name = strtok_r(NULL, ",", &save)) {
+        int m = 0;
+        while (m < STATS_HISTORY_METRIC_COUNT &&
+               strcmp(name, statistics_history_metric_name((statistics_history_metric_t)m)) != 0) {
+            m++;
+        }
+        if (m == STATS_HISTORY_METRIC_COUNT) {
+            return false;
+        }
+        *metrics |= 1u << m;
+    }
+    return true;
+}
+
+/**
+ * @brief Handler for GET /api/history
+ * 
+ * Range query of the per-minute metric history. Query parameters, all
+ * optional: from and to (seconds since boot), or last (seconds before now);
+ * step (seconds between rows) and metrics (comma separated names). Without
+ * parameters the whole history is returned.
+ */
+static esp_err_t api_history_get_handler(httpd_req_t *req) {
+    if (!check_auth(req)) {
+        httpd_resp_set_status(req, "401 Unauthorized");
+        httpd_resp_sendstr(req, "{\"status\":\"error\",\"message\":\"Unauthorized\"}");
+        return ESP_FAIL;
+    }
+    statistics_history_query_t query = {0, UINT32_MAX, 0, 0, 0};
+    char params[512];
+    size_t params_length = httpd_req_get_url_query_len(req);
+    if (params_length >= sizeof(params)) {
+        httpd_resp_set_status(req, "400 Bad Request");
+        httpd_resp_sendstr(req, "{\"status\":\"error\",\"message\":\"Query too long\"}");
+        return ESP_FAIL;
+    }
+    if (params_length > 0 && httpd_req_get_url_query_str(req, params, sizeof(params)) == ESP_OK) {
+        char value[sizeof(params)];
+        if (httpd_query_key_value(params, "from", value, sizeof(value)) == ESP_OK) {
+            query.from_sec = strtoul(value, NULL, 10);
+        }
+        if (httpd_query_key_value(params, "to", value, sizeof(value)) == ESP_OK) {
+            query.to_sec = strtoul(value, NULL, 10);
+        }
+        if (httpd_query_key_value(params, "last", value, sizeof(value)) == ESP_OK) {
+            query.last_sec = strtoul(value, NULL, 10);
+        }
+        if (httpd_query_key_value(params, "step", value, sizeof(value)) == ESP_OK) {
+            query.step_sec = strtoul(value, NULL, 10);
+        }
+        if (httpd_query_key_value(params, "metrics", value, sizeof(value)) == ESP_OK &&
+            !parse_history_metrics(value, &query.metrics)) {
+            httpd_resp_set_status(req, "400 Bad Request");
+            httpd_resp_sendstr(req, "{\"status\":\"error\",\"message\":\"Unknown metric\"}");
+            return ESP_FAIL;
+        }
+    }
+    httpd_resp_set_type(req, "application/json");
+    int result = statistics_write_history(&query, statistics_send_chunk, req);
+    if (result == -1) {
+        // Nothing sent yet
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_sendstr(req, "{\"status\":\"error\",\"message\":\"History not available\"}");
+        return ESP_FAIL;
+    }
+    if (result != 0) {
+        return ESP_FAIL;
+    }
+    // End of the chunked response
+    httpd_resp_send_chunk(req, NULL, 0);
+    return ESP_OK;
+}
+
 /**
  * @brief Handler for POST /api/toggle
  */
@@ -899,6 +1862,66 @@ static esp_err_t api_toggle_post_handler(httpd_req_t *req) {
     return ESP_OK;
 }
 
+/**
+ * @brief Handler for POST /api/ntrip/ca
+ *
+ * Body is a PEM certificate for the caster connection; an empty body removes
+ * the stored certificate so the built-in certificate bundle is used again.
+ */
+static esp_err_t api_ntrip_ca_post_handler(httpd_req_t *req) {
+    if (!check_auth(req)) {
+        httpd_resp_set_status(req, "401 Unauthorized");
+        httpd_resp_sendstr(req, "{\"status\":\"error\",\"message\":\"Unauthorized\"}");
+        return ESP_FAIL;
+    }
+    if (req->content_len >= NTRIP_TLS_CA_MAX_LEN) {
+        httpd_resp_set_status(req, "400 Bad Request");
+        httpd_resp_sendstr(req, "{\"status\":\"error\",\"message\":\"Certificate too large\"}");
+        return ESP_FAIL;
+    }
+    
+    char *pem = (char *)malloc(NTRIP_TLS_CA_MAX_LEN);
+    if (pem == NULL) {
+        httpd_resp_set_status(req, "500 Internal Server Error");
+        httpd_resp_sendstr(req, "{\"status\":\"error\",\"message\":\"Out of memory\"}");
+        return ESP_FAIL;
+    }
+    
+    size_t received = 0;
+    while (received < req->content_len) {
+        int ret = httpd_req_recv(req, pem + received, req->content_len - received);
+        if (ret <= 0) {
+            free(pem);
+            httpd_resp_set_status(req, "400 Bad Request");
+            httpd_resp_sendstr(req, "{\"status\":\"error\",\"message\":\"No data received\"}");
+            return ESP_FAIL;
+        }
+        received += ret;
+    }
+    pem[received] = '\0';
+    
+    if (received > 0 && strstr(pem, "-----BEGIN CERTIFICATE-----") == NULL) {
+        free(pem);
+        httpd_resp_set_status(req, "400 Bad Request");
+        httpd_resp_sendstr(req, "{\"status\":\"error\",\"message\":\"Not a PEM certificate\"}");
+        return ESP_FAIL;
+    }
+    
+    esp_err_t err = config_set_ntrip_ca(pem);
+    free(pem);
+    if (err != ESP_OK) {
+        httpd_resp_set_status(req, "500 Internal Server Error");
+        httpd_resp_sendstr(req, "{\"status\":\"error\",\"message\":\"Failed to save CA certificate\"}");
+        return ESP_FAIL;
+    }
+    
+    ESP_LOGI(TAG, "NTRIP CA certificate %s via web interface", received > 0 ? "updated" : "removed");
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_sendstr(req, received > 0 ? "{\"status\":\"ok\",\"message\":\"CA certificate saved\"}"
+                                         : "{\"status\":\"ok\",\"message\":\"CA certificate removed, using certificate bundle\"}");
+    return ESP_OK;
+}
+
 /**
  * @brief Handler for POST /api/restart
  */
@@ -952,7 +1975,7 @@ esp_err_t http_server_start(void) {
     
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.server_port = 80;
-    config.max_uri_handlers = 10;
+    config.max_uri_handlers = 14;
     config.max_open_sockets = 7;
     config.stack_size = 8192;
     config.lru_purge_enable = true;
@@ -997,6 +2020,38 @@ esp_err_t http_server_start(void) {
     };
     httpd_register_uri_handler(server, &uri_api_status);
     
+    httpd_uri_t uri_api_tasks = {
+        .uri = "/api/tasks",
+        .method = HTTP_GET,
+        .handler = api_tasks_get_handler,
+        .user_ctx = NULL
+    };
+    httpd_register_uri_handler(server, &uri_api_tasks);
+    
+    httpd_uri_t uri_api_trace = {
+        .uri = "/api/trace",
+        .method = HTTP_GET,
+        .handler = api_trace_get_handler,
+        .user_ctx = NULL
+    };
+    httpd_register_uri_handler(server, &uri_api_trace);
+    
+    httpd_uri_t uri_metrics = {
+        .uri = "/metrics",
+        .method = HTTP_GET,
+        .handler = metrics_get_handler,
+        .user_ctx = NULL
+    };
+    httpd_register_uri_handler(server, &uri_metrics);
+    
+    httpd_uri_t uri_api_history = {
+        .uri = "/api/history",
+        .method = HTTP_GET,
+        .handler = api_history_get_handler,
+        .user_ctx = NULL
+    };
+    httpd_register_uri_handler(server, &uri_api_history);
+    
     httpd_uri_t uri_api_toggle = {
         .uri = "/api/toggle",
         .method = HTTP_POST,
@@ -1005,6 +2060,14 @@ esp_err_t http_server_start(void) {
     };
     httpd_register_uri_handler(server, &uri_api_toggle);
     
+    httpd_uri_t uri_api_ntrip_ca = {
+        .uri = "/api/ntrip/ca",
+        .method = HTTP_POST,
+        .handler = api_ntrip_ca_post_handler,
+        .user_ctx = NULL
+    };
+    httpd_register_uri_handler(server, &uri_api_ntrip_ca);
+    
     httpd_uri_t uri_api_restart = {
         .uri = "/api/restart",
         .method = HTTP_POST,
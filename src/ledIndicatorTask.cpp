@@ -11,11 +11,13 @@
 #include "ntripClientTask.h"
 #include "gnssReceiverTask.h"
 #include "mqttClientTask.h"
+#include "statisticsTask.h"
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <driver/gpio.h>
 #include <driver/rmt_tx.h>
 #include <esp_log.h>
+#include <esp_timer.h>
 #include <string.h>
 #include <sys/time.h>
 #include <freertos/queue.h>
@@ -300,6 +302,8 @@ static void led_indicator_task(void *pvParameters) {
     set_led_color(0, 0, 0);
     
     while (1) {
+        int64_t loop_start_us = esp_timer_get_time();
+        
         // Check for RGB LED command
         rgb_led_cmd_t cmd;
         if (rgb_led_cmd_queue && xQueueReceive(rgb_led_cmd_queue, &cmd, 0)) {
@@ -359,6 +363,8 @@ static void led_indicator_task(void *pvParameters) {
             // set_led_color or other logic can be placed here if needed
         }
         
+        statistics_loop_time(STATS_TASK_LED, (uint32_t)(esp_timer_get_time() - loop_start_us));
+        
         // Delay for update rate
         vTaskDelay(pdMS_TO_TICKS(LED_UPDATE_RATE_MS));
     }
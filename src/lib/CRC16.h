@@ -50,5 +50,34 @@
  */
 extern uint16_t calculateCRC16(const uint8_t* data, size_t length);
 
+/**
+ * \brief Initial value of the CRC-16, see updateCRC16().
+ */
+#define CRC16_INIT 0xFFFF
+
+/**
+ * \brief CRC-16 of every byte value, indexed by the top byte of the CRC XOR the data byte.
+ */
+extern const uint16_t crc16Table[256];
+
+/**
+ * \brief Add one byte to a CRC-16 using crc16Table.
+ * \param[in] crc CRC-16 so far (CRC16_INIT for the first byte).
+ * \param[in] byte Next data byte.
+ * \return Updated CRC-16 value.
+ */
+static inline uint16_t stepCRC16(uint16_t crc, uint8_t byte) {
+    return (uint16_t)((crc << 8) ^ crc16Table[(uint8_t)(crc >> 8) ^ byte]);
+}
+
+/**
+ * \brief Continue a CRC-16 over more data, so data in pieces gives the same CRC as in one buffer.
+ * \param[in] crc CRC-16 so far (CRC16_INIT for the first piece).
+ * \param[in] data Pointer to the data buffer.
+ * \param[in] length Length of the data buffer.
+ * \return Updated CRC-16 value.
+ */
+extern uint16_t updateCRC16(uint16_t crc, const uint8_t* data, size_t length);
+
 #endif // NTRIPCLIENTCRC16_H
 
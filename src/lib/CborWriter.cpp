@@ -0,0 +1,119 @@
+#include <cstdint>
+#include <stddef.h>
+#include <string.h>
+
+#include "CborWriter.h"
+
+// Major types (RFC 8949 section 3.1)
+#define CBOR_MAJOR_UNSIGNED     0
+#define CBOR_MAJOR_NEGATIVE     1
+#define CBOR_MAJOR_TEXT         3
+#define CBOR_MAJOR_ARRAY        4
+#define CBOR_MAJOR_MAP          5
+#define CBOR_MAJOR_SIMPLE       7
+
+// Additional information values of major type 7
+#define CBOR_FALSE              20
+#define CBOR_TRUE               21
+#define CBOR_FLOAT32            26
+#define CBOR_FLOAT64            27
+
+CborWriter::CborWriter(uint8_t* out, size_t size)
+    : buffer(out),
+      capacity(size),
+      written(0) {
+}
+
+void CborWriter::append(const uint8_t* data, size_t length) {
+    if (written < capacity) {
+        size_t room = capacity - written;
+        memcpy(buffer + written, data, length < room ? length : room);
+    }
+    written += length;
+}
+
+void CborWriter::writeHead(uint8_t majorType, uint64_t value) {
+    uint8_t head[9];
+    size_t length;
+    uint8_t major = (uint8_t)(majorType << 5);
+    if (value < 24) {
+        head[0] = (uint8_t)(major | value);
+        length = 1;
+    } else if (value <= 0xFF) {
+        head[0] = major | 24;
+        head[1] = (uint8_t)value;
+        length = 2;
+    } else if (value <= 0xFFFF) {
+        head[0] = major | 25;
+        head[1] = (uint8_t)(value >> 8);
+        head[2] = (uint8_t)value;
+        length = 3;
+    } else if (value <= 0xFFFFFFFFu) {
+        head[0] = major | 26;
+        for (int i = 0; i < 4; i++) {
+            head[1 + i] = (uint8_t)(value >> (24 - 8 * i));
+        }
+        length = 5;
+    } else {
+        head[0] = major | 27;
+        for (int i = 0; i < 8; i++) {
+            head[1 + i] = (uint8_t)(value >> (56 - 8 * i));
+        }
+        length = 9;
+    }
+    append(head, length);
+}
+
+void CborWriter::beginMap(size_t count) {
+    writeHead(CBOR_MAJOR_MAP, count);
+}
+
+void CborWriter::beginArray(size_t count) {
+    writeHead(CBOR_MAJOR_ARRAY, count);
+}
+
+void CborWriter::addUInt(uint64_t value) {
+    writeHead(CBOR_MAJOR_UNSIGNED, value);
+}
+
+void CborWriter::addInt(int64_t value) {
+    if (value < 0) {
+        // Negative integers are encoded as -1 - n
+        writeHead(CBOR_MAJOR_NEGATIVE, (uint64_t)(-1 - value));
+    } else {
+        writeHead(CBOR_MAJOR_UNSIGNED, (uint64_t)value);
+    }
+}
+
+void CborWriter::addFloat(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint8_t data[5];
+    data[0] = (CBOR_MAJOR_SIMPLE << 5) | CBOR_FLOAT32;
+    for (int i = 0; i < 4; i++) {
+        data[1 + i] = (uint8_t)(bits >> (24 - 8 * i));
+    }
+    append(data, sizeof(data));
+}
+
+void CborWriter::addDouble(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint8_t data[9];
+    data[0] = (CBOR_MAJOR_SIMPLE << 5) | CBOR_FLOAT64;
+    for (int i = 0; i < 8; i++) {
+        data[1 + i] = (uint8_t)(bits >> (56 - 8 * i));
+    }
+    append(data, sizeof(data));
+}
+
+void CborWriter::addBool(bool value) {
+    uint8_t data = (CBOR_MAJOR_SIMPLE << 5) | (value ? CBOR_TRUE : CBOR_FALSE);
+    append(&data, 1);
+}
+
+void CborWriter::addText(const char* text) {
+    size_t length = strlen(text);
+    writeHead(CBOR_MAJOR_TEXT, length);
+    append((const uint8_t*)text, length);
+}
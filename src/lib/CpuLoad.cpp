@@ -0,0 +1,84 @@
+#include <cstdint>
+#include <stddef.h>
+
+#include "CpuLoad.h"
+
+CpuLoad::CpuLoad() {
+    clear();
+}
+
+void CpuLoad::clear() {
+    taskCount = 0;
+    started = false;
+    lastTotalRunTime = 0;
+    elapsed = 0;
+}
+
+void CpuLoad::reset() {
+    for (size_t i = 0; i < taskCount; i++) {
+        tasks[i].runTime = 0;
+    }
+    elapsed = 0;
+}
+
+int CpuLoad::find(uint32_t taskNumber) const {
+    for (size_t i = 0; i < taskCount; i++) {
+        if (tasks[i].taskNumber == taskNumber) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+void CpuLoad::update(const CpuLoadSample* samples, size_t count, uint32_t totalRunTime) {
+    if (samples == NULL) {
+        count = 0;
+    }
+    // Unsigned differences stay right when a counter wraps
+    if (started) {
+        elapsed += (uint32_t)(totalRunTime - lastTotalRunTime);
+    }
+    started = true;
+    lastTotalRunTime = totalRunTime;
+
+    for (size_t i = 0; i < taskCount; i++) {
+        tasks[i].present = false;
+    }
+    for (size_t s = 0; s < count; s++) {
+        int index = find(samples[s].taskNumber);
+        if (index >= 0) {
+            Task& task = tasks[index];
+            task.runTime += (uint32_t)(samples[s].runTime - task.lastRunTime);
+            task.lastRunTime = samples[s].runTime;
+            task.present = true;
+        } else if (taskCount < CPU_LOAD_MAX_TASKS) {
+            // New task: its run time before this snapshot is not part of the period
+            Task& task = tasks[taskCount++];
+            task.taskNumber = samples[s].taskNumber;
+            task.lastRunTime = samples[s].runTime;
+            task.runTime = 0;
+            task.present = true;
+        }
+    }
+
+    // Drop deleted tasks
+    size_t kept = 0;
+    for (size_t i = 0; i < taskCount; i++) {
+        if (tasks[i].present) {
+            tasks[kept++] = tasks[i];
+        }
+    }
+    taskCount = kept;
+}
+
+uint64_t CpuLoad::getRunTime(uint32_t taskNumber) const {
+    int index = find(taskNumber);
+    return index >= 0 ? tasks[index].runTime : 0;
+}
+
+float CpuLoad::getPercent(uint32_t taskNumber) const {
+    if (elapsed == 0) {
+        return 0.0f;
+    }
+    return (float)((double)getRunTime(taskNumber) * 100.0 / (double)elapsed);
+}
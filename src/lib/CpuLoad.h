@@ -0,0 +1,88 @@
+/*!
+ * \file CpuLoad.h
+ * \brief CPU time per task from snapshots of the FreeRTOS run-time counters.
+ *
+ * With run-time statistics enabled, FreeRTOS counts the time every task has
+ * run since it was created, and uxTaskGetSystemState() returns the counters
+ * of all tasks with the total run time. On the ESP32 they count
+ * microseconds of esp_timer in 32 bits and wrap after 71 minutes. CpuLoad
+ * turns snapshots of the counters into the run time of every task since the
+ * start of the period: it keeps the last counter of each task and adds the
+ * unsigned, wrap-safe difference; the elapsed time follows from the total
+ * counter in the same way. Snapshots at least once per wrap keep the result
+ * exact; the Statistics Task takes one every second.
+ *
+ * Tasks are identified by their task number, which FreeRTOS never reuses. A
+ * task seen for the first time only sets its starting point; a task missing
+ * from a snapshot was deleted and is dropped.
+ *
+ * \section cpu_load_share Shares
+ * A task runs on one core at a time, so its share is a percentage of one
+ * core. The load of a core is 100% minus the share of its idle task.
+ */
+
+#ifndef CPU_LOAD_H
+#define CPU_LOAD_H
+
+#include <cstdint>
+#include <stddef.h>
+
+#define CPU_LOAD_MAX_TASKS 32
+
+/**
+ * \brief Run-time counter of one task in a snapshot.
+ */
+struct CpuLoadSample {
+    uint32_t taskNumber;    // Unique task number (TaskStatus_t::xTaskNumber)
+    uint32_t runTime;       // Run-time counter of the task
+};
+
+class CpuLoad {
+public:
+    /** \brief Create without tasks; the first snapshot sets the starting points. */
+    CpuLoad();
+
+    /** \brief Forget all tasks and the starting points. */
+    void clear();
+
+    /** \brief Start a new period: run times and elapsed time restart at 0, the starting points are kept. */
+    void reset();
+
+    /**
+     * \brief Add a snapshot of the run-time counters.
+     * \param[in] samples Counters of all tasks; tasks beyond CPU_LOAD_MAX_TASKS are ignored.
+     * \param[in] count Number of samples.
+     * \param[in] totalRunTime Total run-time counter of the snapshot.
+     */
+    void update(const CpuLoadSample* samples, size_t count, uint32_t totalRunTime);
+
+    /** \brief Time covered by the run times of this period, in run-time counter units. */
+    uint64_t getElapsed() const { return elapsed; }
+
+    /** \brief Run time of a task this period, 0 for an unknown task. */
+    uint64_t getRunTime(uint32_t taskNumber) const;
+
+    /** \brief Share of one core a task used this period in percent, 0 for an unknown task. */
+    float getPercent(uint32_t taskNumber) const;
+
+    /** \brief Number of tasks followed. */
+    size_t getTaskCount() const { return taskCount; }
+
+private:
+    struct Task {
+        uint32_t taskNumber;
+        uint32_t lastRunTime;   // Counter in the last snapshot
+        uint64_t runTime;       // Run time this period
+        bool present;           // Seen in the current snapshot
+    };
+
+    int find(uint32_t taskNumber) const;
+
+    Task tasks[CPU_LOAD_MAX_TASKS];
+    size_t taskCount;
+    bool started;
+    uint32_t lastTotalRunTime;
+    uint64_t elapsed;
+};
+
+#endif // CPU_LOAD_H
@@ -0,0 +1,94 @@
+#include <cstdint>
+#include <stddef.h>
+
+#include "EpochScheduler.h"
+
+#define MS_PER_DAY 86400000u
+
+EpochScheduler::EpochScheduler()
+    : intervalMs(1000),
+      everyNth(0),
+      haveLastEpoch(false),
+      lastTimeOfDayMs(0),
+      lastSlot(0),
+      epochsSincePublish(0),
+      epochs(0),
+      published(0),
+      lastAgeUs(0),
+      maxAgeUs(0),
+      ageSumUs(0),
+      haveLastSend(false),
+      lastSendTimeOfDayMs(0),
+      lastSentUs(0),
+      jitterSamples(0),
+      lastJitterUs(0),
+      maxJitterUs(0),
+      jitterSumUs(0) {
+}
+
+void EpochScheduler::configure(uint32_t interval, uint8_t nth) {
+    intervalMs = (interval < 1) ? 1 : interval;
+    everyNth = nth;
+    reset();
+}
+
+void EpochScheduler::reset() {
+    haveLastEpoch = false;
+    epochsSincePublish = 0;
+    haveLastSend = false;
+}
+
+bool EpochScheduler::onEpoch(uint32_t timeOfDayMs) {
+    timeOfDayMs %= MS_PER_DAY;
+    if (haveLastEpoch && timeOfDayMs == lastTimeOfDayMs) {
+        return false;
+    }
+    epochs++;
+
+    bool publish;
+    uint32_t slot = timeOfDayMs / intervalMs;
+    if (!haveLastEpoch) {
+        publish = true;
+    } else if (everyNth > 0) {
+        publish = (uint8_t)(epochsSincePublish + 1) >= everyNth;
+    } else {
+        // A new slot also starts after midnight, where the slot number drops
+        publish = (slot != lastSlot);
+    }
+
+    epochsSincePublish = publish ? 0 : (uint8_t)(epochsSincePublish + 1);
+    haveLastEpoch = true;
+    lastTimeOfDayMs = timeOfDayMs;
+    lastSlot = slot;
+    return publish;
+}
+
+void EpochScheduler::recordSampleAge(uint32_t ageUs) {
+    published++;
+    lastAgeUs = ageUs;
+    if (ageUs > maxAgeUs) {
+        maxAgeUs = ageUs;
+    }
+    ageSumUs += ageUs;
+}
+
+void EpochScheduler::recordSendTime(uint32_t timeOfDayMs, int64_t sentUs) {
+    timeOfDayMs %= MS_PER_DAY;
+    if (haveLastSend) {
+        // GNSS time between the epochs, also across midnight
+        int64_t gnssUs = (int64_t)((timeOfDayMs + MS_PER_DAY - lastSendTimeOfDayMs) % MS_PER_DAY) * 1000;
+        int64_t jitter = (sentUs - lastSentUs) - gnssUs;
+        if (jitter < 0) {
+            jitter = -jitter;
+        }
+        lastJitterUs = (jitter > 0xFFFFFFFFll) ? 0xFFFFFFFFu : (uint32_t)jitter;
+        if (lastJitterUs > maxJitterUs) {
+            maxJitterUs = lastJitterUs;
+        }
+        jitterSumUs += lastJitterUs;
+        jitterSamples++;
+    }
+    haveLastSend = true;
+    lastSendTimeOfDayMs = timeOfDayMs;
+    lastSentUs = sentUs;
+}
@@ -0,0 +1,178 @@
+/*!
+ * \file FanoutBuffer.h
+ * \brief Reference counted block buffer that fans one stream out to many readers.
+ *
+ * Data is copied once into a block from a shared pool when it is published.
+ * Every active subscriber gets a reference to that block in its own ring, and
+ * readers send straight from the block memory, so there is no copy per
+ * subscriber. A block returns to the pool when the last subscriber has
+ * consumed it.
+ *
+ * \section fanout_pinning Sending without the lock
+ * A reader that sends from block memory without holding the caller's mutex
+ * first pins its oldest block with pin(). The pin is an extra reference, so
+ * the block is neither recycled by publish() nor freed by an eviction until
+ * the reader calls consume(), which drops the pin. A reader has at most one
+ * block pinned at a time.
+ *
+ * \section fanout_backpressure Backpressure
+ * Publishing never blocks. A subscriber whose ring is full when a block is
+ * published is evicted: its references are released and isEvicted() reports
+ * true until the owner calls unsubscribe(). If the pool itself runs out of
+ * free blocks, the subscriber with the largest backlog is evicted until a
+ * block is free.
+ *
+ * \section fanout_threading Threading
+ * The class is not thread-safe. When publisher and readers run in different
+ * tasks the caller protects all calls with one mutex.
+ */
+
+#ifndef FANOUT_BUFFER_H
+#define FANOUT_BUFFER_H
+
+#include <cstdint>
+#include <stddef.h>
+
+class FanoutBuffer {
+public:
+    FanoutBuffer();
+    ~FanoutBuffer();
+
+    /**
+     * \brief Allocate the block pool and subscriber rings.
+     * \param[in] blockCount Number of blocks in the shared pool.
+     * \param[in] blockSize Payload capacity of one block in bytes.
+     * \param[in] maxSubscribers Maximum number of concurrent subscribers.
+     * \param[in] subscriberDepth Blocks a subscriber may have queued before it is evicted.
+     * \return true on success, false on invalid arguments or allocation failure.
+     */
+    bool init(size_t blockCount, size_t blockSize, size_t maxSubscribers, size_t subscriberDepth);
+
+    /**
+     * \brief Release all memory. All subscribers are dropped.
+     */
+    void deinit();
+
+    /**
+     * \brief Register a new subscriber. It receives data published from now on.
+     * \return Subscriber ID, or -1 if all subscriber slots are in use.
+     */
+    int subscribe();
+
+    /**
+     * \brief Remove a subscriber and release its queued blocks.
+     * \param[in] id Subscriber ID returned by subscribe().
+     */
+    void unsubscribe(int id);
+
+    /**
+     * \brief Publish data to all active subscribers.
+     *
+     * Data longer than the block size is split over several blocks.
+     * \param[in] data Data to publish.
+     * \param[in] length Length of the data.
+     * \return Number of subscribers the data was queued for.
+     */
+    size_t publish(const uint8_t* data, size_t length);
+
+    /**
+     * \brief Get the unsent part of the oldest queued block of a subscriber.
+     * \param[in] id Subscriber ID.
+     * \param[out] data Receives a pointer into the block (valid until consume()).
+     * \param[out] length Receives the number of unsent bytes in the block.
+     * \return true if data is pending, false otherwise.
+     */
+    bool peek(int id, const uint8_t** data, size_t* length) const;
+
+    /**
+     * \brief Like peek(), but keep the block alive until the next consume().
+     *
+     * The returned data stays valid without the caller's mutex, also when the
+     * subscriber is evicted in the meantime, so the reader can send from it
+     * after releasing the lock.
+     * \param[in] id Subscriber ID.
+     * \param[out] data Receives a pointer into the block (valid until consume()).
+     * \param[out] length Receives the number of unsent bytes in the block.
+     * \return true if data is pending and now pinned, false if there is no
+     *         data or the subscriber already has a block pinned.
+     */
+    bool pin(int id, const uint8_t** data, size_t* length);
+
+    /**
+     * \brief Mark bytes returned by peek() or pin() as sent and drop the pin.
+     *
+     * Call it after every successful pin(), with 0 bytes if nothing was sent.
+     * For an evicted subscriber only the pin is dropped.
+     * \param[in] id Subscriber ID.
+     * \param[in] bytes Number of bytes sent (at most the length from peek()).
+     */
+    void consume(int id, size_t bytes);
+
+    /**
+     * \brief Check whether a subscriber was evicted for falling behind.
+     * \param[in] id Subscriber ID.
+     * \return true if evicted; the owner should drop the reader and unsubscribe.
+     */
+    bool isEvicted(int id) const;
+
+    /**
+     * \brief Number of blocks queued for a subscriber.
+     * \param[in] id Subscriber ID.
+     */
+    size_t pendingBlocks(int id) const;
+
+    /** \brief Number of active (not evicted) subscribers. */
+    size_t getSubscriberCount() const;
+
+    /** \brief Number of pool blocks currently referenced. */
+    size_t getBlocksInUse() const;
+
+    /** \brief Total subscribers evicted since init(). */
+    uint32_t getEvictionCount() const { return evictionCount; }
+
+    /** \brief Total blocks published since init(). */
+    uint32_t getPublishedBlocks() const { return publishedBlocks; }
+
+    /** \brief Total bytes published since init() (counted once, not per subscriber). */
+    uint64_t getPublishedBytes() const { return publishedBytes; }
+
+private:
+    struct Block {
+        uint16_t length;
+        uint16_t refs;
+    };
+
+    struct Subscriber {
+        bool active;
+        bool evicted;
+        bool pinned;
+        uint16_t pinnedBlock;
+        uint16_t head;
+        uint16_t count;
+        uint16_t offset;
+        uint16_t* ring;
+    };
+
+    uint8_t* storage;
+    Block* blocks;
+    Subscriber* subscribers;
+    uint16_t* rings;
+    size_t blockCount;
+    size_t blockSize;
+    size_t maxSubscribers;
+    size_t subscriberDepth;
+    size_t nextFree;
+
+    uint32_t evictionCount;
+    uint32_t publishedBlocks;
+    uint64_t publishedBytes;
+
+    bool validId(int id) const;
+    int allocateBlock();
+    void release(uint16_t block);
+    void evict(Subscriber& subscriber);
+    void dropQueue(Subscriber& subscriber);
+    void unpin(Subscriber& subscriber);
+};
+
+#endif // FANOUT_BUFFER_H
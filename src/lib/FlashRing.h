@@ -0,0 +1,158 @@
+/*!
+ * \file FlashRing.h
+ * \brief Bounded FIFO of records in a raw flash partition.
+ *
+ * Used as the store-and-forward outbox of the MQTT Client Task: encoded
+ * messages are appended while the broker cannot be reached and read back in
+ * the same order after the connection is restored.
+ *
+ * \section ring_layout Layout
+ * The partition is a ring of erase sectors. Each sector in use starts with a
+ * sector header holding a sequence number and the number of times the sector
+ * was erased; records follow back to back, 4 byte aligned:
+ * - 8 byte record header: length, CRC-16 of the data, tag, state flags
+ * - the data
+ *
+ * Flash is only programmed from 1 to 0 bits, so the state of a record is kept
+ * in flag bits that are cleared in place: first "committed" after the data is
+ * written, then "sent" when it is drained. A sector is only erased when the
+ * ring wraps around to it, so every sector is erased equally often.
+ *
+ * \section ring_power Power loss
+ * begin() rebuilds the ring from flash: the sector with the highest sequence
+ * number is the newest, records that were never committed (power lost during
+ * append()) are skipped, and reading resumes at the oldest record not marked
+ * sent. A record whose data does not match its CRC is skipped when read.
+ *
+ * \section ring_full Full ring
+ * When the ring is full the oldest sector is erased for new records; its
+ * records that were not yet drained are counted as dropped.
+ *
+ * \section ring_io Flash access
+ * All flash access goes through the FlashRingIo callbacks, so the firmware
+ * maps them onto esp_partition and the host tests onto a simulated flash.
+ */
+
+#ifndef FLASH_RING_H
+#define FLASH_RING_H
+
+#include <cstdint>
+#include <stddef.h>
+
+/**
+ * \brief Flash access callbacks. Addresses are relative to the start of the ring.
+ */
+struct FlashRingIo {
+    bool (*read)(void* context, uint32_t address, void* data, size_t length);
+    bool (*write)(void* context, uint32_t address, const void* data, size_t length);
+    bool (*erase)(void* context, uint32_t address, size_t length);
+    void* context;
+};
+
+class FlashRing {
+public:
+    FlashRing();
+
+    /**
+     * \brief Attach to the flash and rebuild the ring from its contents.
+     * \param[in] io Flash access callbacks.
+     * \param[in] sectorSize Erase sector size in bytes (4096 on ESP32).
+     * \param[in] sectorCount Number of sectors in the ring (at least 2).
+     * \return false if the geometry is invalid.
+     */
+    bool begin(const FlashRingIo& io, uint32_t sectorSize, uint32_t sectorCount);
+
+    /**
+     * \brief Append one record.
+     * \param[in] tag Application defined record type.
+     * \param[in] data Record data.
+     * \param[in] length Data length, at most maxRecordLength().
+     * \return false if the record is too long or the flash could not be written.
+     */
+    bool append(uint8_t tag, const uint8_t* data, size_t length);
+
+    /**
+     * \brief Read the oldest record that was not drained yet.
+     * \param[out] tag Record tag.
+     * \param[out] data Buffer for the record data.
+     * \param[in] size Buffer size; longer records are skipped as corrupt.
+     * \param[out] length Data length.
+     * \return false if the ring holds no records.
+     */
+    bool peek(uint8_t* tag, uint8_t* data, size_t size, size_t* length);
+
+    /**
+     * \brief Mark the record returned by peek() as sent.
+     * \return false if the ring holds no records.
+     */
+    bool pop();
+
+    /** \brief Largest record data length. */
+    size_t maxRecordLength() const;
+
+    /** \brief Records waiting to be drained (backlog depth). */
+    uint32_t getRecords() const { return records; }
+
+    /** \brief Data bytes of the records waiting to be drained. */
+    uint32_t getBytes() const { return bytes; }
+
+    /** \brief Size of the ring in bytes. */
+    uint32_t getCapacity() const { return sectorSize * sectorCount; }
+
+    uint32_t getAppended() const { return appended; }
+    uint32_t getDrained() const { return drained; }
+
+    /** \brief Records lost because the ring was full. */
+    uint32_t getDropped() const { return dropped; }
+
+    /** \brief Records skipped because of a CRC error. */
+    uint32_t getCorrupt() const { return corrupt; }
+
+    /** \brief Failed flash writes and erases. */
+    uint32_t getFlashErrors() const { return flashErrors; }
+
+    /** \brief Sector erases since begin(). */
+    uint32_t getErases() const { return erases; }
+
+    /** \brief Highest erase count of any sector, kept in flash (flash wear). */
+    uint32_t getMaxSectorErases() const { return maxSectorErases; }
+
+    /** \brief Bytes programmed since begin(). */
+    uint64_t getBytesWritten() const { return bytesWritten; }
+
+private:
+    bool readSectorHeader(uint32_t sector, uint32_t* sequence, uint32_t* eraseCount);
+    bool isLive(uint32_t sector);
+    uint32_t findEnd(uint32_t sector);
+    bool openSector();
+    void countBacklog();
+    void seekTail(uint32_t sector, uint32_t offset);
+    void markSent(uint32_t length);
+
+    FlashRingIo io;
+    uint32_t sectorSize;
+    uint32_t sectorCount;
+    bool mounted;
+
+    bool headOpen;
+    uint32_t headSector;
+    uint32_t headOffset;
+    uint32_t headSequence;
+
+    uint32_t tailSector;
+    uint32_t tailOffset;
+
+    uint32_t records;
+    uint32_t bytes;
+
+    uint32_t appended;
+    uint32_t drained;
+    uint32_t dropped;
+    uint32_t corrupt;
+    uint32_t flashErrors;
+    uint32_t erases;
+    uint32_t maxSectorErases;
+    uint64_t bytesWritten;
+};
+
+#endif // FLASH_RING_H
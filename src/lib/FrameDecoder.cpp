@@ -0,0 +1,155 @@
+#include <cstdint>
+#include <stddef.h>
+#include <string.h>
+
+#include "FrameDecoder.h"
+#include "FrameEncoder.h"
+#include "CRC16.h"
+
+static inline bool isFramingByte(uint8_t byte) {
+    return byte == FrameEncoder::SOH || byte == FrameEncoder::DLE || byte == FrameEncoder::CAN;
+}
+
+FrameDecoder::FrameDecoder()
+    : frameCallback(NULL),
+      callbackContext(NULL) {
+    begin(NULL, 0);
+}
+
+void FrameDecoder::begin(uint8_t* memory, size_t size) {
+    buffer = memory;
+    capacity = (memory != NULL) ? size : 0;
+    reset();
+
+    frameCount = 0;
+    zeroCopyCount = 0;
+    crcErrorCount = 0;
+    escapeErrorCount = 0;
+    overrunCount = 0;
+    abortedCount = 0;
+    discardedBytes = 0;
+}
+
+void FrameDecoder::setFrameCallback(FrameCallback callback, void* context) {
+    frameCallback = callback;
+    callbackContext = context;
+}
+
+void FrameDecoder::reset() {
+    state = STATE_HUNT;
+    used = 0;
+    crc = CRC16_INIT;
+}
+
+void FrameDecoder::startFrame() {
+    state = STATE_DATA;
+    used = 0;
+    crc = CRC16_INIT;
+}
+
+// Append unstuffed bytes; a frame that does not fit is dropped
+bool FrameDecoder::store(const uint8_t* data, size_t length) {
+    if (length == 0) {
+        return true;
+    }
+    if (length > capacity - used) {
+        overrunCount++;
+        state = STATE_HUNT;
+        return false;
+    }
+    memcpy(buffer + used, data, length);
+    used += length;
+    return true;
+}
+
+// Check a complete frame (payload and CRC) and pass it on
+bool FrameDecoder::endFrame(const uint8_t* content, size_t length, bool zeroCopy) {
+    state = STATE_HUNT;
+    // The CRC over the payload followed by its big-endian CRC is zero
+    if (length < 2 || crc != 0) {
+        crcErrorCount++;
+        return false;
+    }
+    frameCount++;
+    if (zeroCopy) {
+        zeroCopyCount++;
+    }
+    if (frameCallback != NULL) {
+        frameCallback(content, length - 2, callbackContext);
+    }
+    return true;
+}
+
+size_t FrameDecoder::feed(const uint8_t* data, size_t length) {
+    size_t completed = 0;
+    size_t i = 0;
+
+    while (i < length) {
+        if (state == STATE_HUNT) {
+            const uint8_t* soh = (const uint8_t*)memchr(data + i, FrameEncoder::SOH, length - i);
+            if (soh == NULL) {
+                discardedBytes += (uint32_t)(length - i);
+                break;
+            }
+            discardedBytes += (uint32_t)(soh - (data + i));
+            i = (size_t)(soh - data) + 1;
+            startFrame();
+            continue;
+        }
+
+        if (state == STATE_ESCAPE) {
+            uint8_t byte = data[i++];
+            if (!isFramingByte(byte)) {
+                escapeErrorCount++;
+                state = STATE_HUNT;
+                continue;
+            }
+            crc = stepCRC16(crc, byte);
+            if (store(&byte, 1)) {
+                state = STATE_DATA;
+            }
+            continue;
+        }
+
+        // Run of bytes up to the next framing byte
+        size_t start = i;
+        uint16_t value = crc;
+        while (i < length && !isFramingByte(data[i])) {
+            value = stepCRC16(value, data[i]);
+            i++;
+        }
+        crc = value;
+        size_t run = i - start;
+
+        if (i == length) {
+            // The frame continues in the next chunk
+            store(data + start, run);
+            break;
+        }
+
+        uint8_t byte = data[i++];
+        if (byte == FrameEncoder::CAN) {
+            if (used == 0) {
+                // Whole frame in this chunk without escapes: no copy
+                if (run > capacity) {
+                    overrunCount++;
+                    state = STATE_HUNT;
+                } else if (endFrame(data + start, run, true)) {
+                    completed++;
+                }
+            } else if (store(data + start, run) && endFrame(buffer, used, false)) {
+                completed++;
+            }
+        } else if (byte == FrameEncoder::DLE) {
+            if (store(data + start, run)) {
+                state = STATE_ESCAPE;
+            }
+        } else {
+            // SOH before the CAN: start over with the new frame
+            abortedCount++;
+            startFrame();
+        }
+    }
+
+    return completed;
+}
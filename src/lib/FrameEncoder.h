@@ -0,0 +1,77 @@
+/*!
+ * \file FrameEncoder.h
+ * \brief SOH/DLE/CAN framing with CRC-16 in a single pass.
+ *
+ * Builds the frames of the telemetry UART protocol:
+ *
+ *     [SOH] [payload (stuffed)] [CRC-16 high (stuffed)] [CRC-16 low (stuffed)] [CAN]
+ *
+ * A payload byte equal to SOH, DLE or CAN is preceded by DLE. The CRC-16
+ * (lib/CRC16) is calculated over the unstuffed payload.
+ *
+ * \section encoder_pass Single pass
+ * Every payload byte is read once: the CRC is updated with the table of
+ * lib/CRC16 while the byte is copied. The payload is scanned four bytes at a
+ * time; a word without a framing byte, which is the common case, is copied as
+ * a whole. Only words with a framing byte are stuffed byte by byte.
+ *
+ * \section encoder_segments Segments
+ * A payload may be passed as several segments (scatter-gather), for example a
+ * header and a body in different buffers. The frame is the same as for the
+ * segments joined in one buffer.
+ *
+ * \section encoder_size Frame size
+ * FRAME_ENCODER_MAX_SIZE() is the worst case frame size for a payload length,
+ * for sizing buffers at compile time. A frame that does not fit the buffer is
+ * not written (encode() returns 0); a smaller buffer works as long as the
+ * actual frame fits.
+ */
+
+#ifndef FRAME_ENCODER_H
+#define FRAME_ENCODER_H
+
+#include <cstdint>
+#include <stddef.h>
+
+/**
+ * \brief Worst case frame size for a payload of n bytes: SOH, every payload
+ * and CRC byte stuffed, and CAN.
+ */
+#define FRAME_ENCODER_MAX_SIZE(n) (2 * ((n) + 2) + 2)
+
+/**
+ * \brief One piece of a payload.
+ */
+struct FrameSegment {
+    const uint8_t* data;    /**< Segment data (may be NULL if length is 0) */
+    size_t length;          /**< Segment length in bytes */
+};
+
+class FrameEncoder {
+public:
+    static const uint8_t SOH = 0x01;    /**< Start of frame */
+    static const uint8_t DLE = 0x10;    /**< Escape */
+    static const uint8_t CAN = 0x18;    /**< End of frame */
+
+    /**
+     * \brief Frame a payload.
+     * \param[in] payload Payload bytes.
+     * \param[in] length Payload length.
+     * \param[out] frame Output buffer.
+     * \param[in] size Output buffer size.
+     * \return Frame length, or 0 if the frame does not fit.
+     */
+    static size_t encode(const uint8_t* payload, size_t length, uint8_t* frame, size_t size);
+
+    /**
+     * \brief Frame a payload made of segments.
+     * \param[in] segments Payload segments in order.
+     * \param[in] count Number of segments.
+     * \param[out] frame Output buffer.
+     * \param[in] size Output buffer size.
+     * \return Frame length, or 0 if the frame does not fit.
+     */
+    static size_t encode(const FrameSegment* segments, size_t count, uint8_t* frame, size_t size);
+};
+
+#endif // FRAME_ENCODER_H
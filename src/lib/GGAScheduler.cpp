@@ -0,0 +1,100 @@
+#include <cstdint>
+#include <stddef.h>
+#include <math.h>
+#include <string.h>
+
+#include "GGAScheduler.h"
+
+// Meters per degree of latitude on a sphere with the mean earth radius (6371 km)
+#define METERS_PER_DEGREE 111194.93f
+#define DEG_TO_RAD 0.017453292519943295
+
+GGAScheduler::GGAScheduler()
+    : thresholdSquared(0.0f),
+      minIntervalMs(0),
+      maxIntervalMs(0),
+      referenceValid(false),
+      referenceLatitude(0.0),
+      referenceLongitude(0.0),
+      referenceCosLatitude(1.0f),
+      referenceFix(0),
+      lastSendMs(0),
+      baselineStarted(false),
+      lastBaselineMs(0),
+      bytesSent(0),
+      baselineBytes(0) {
+    memset(sendCount, 0, sizeof(sendCount));
+}
+
+void GGAScheduler::configure(uint32_t distanceM, uint32_t minInterval, uint32_t maxInterval) {
+    thresholdSquared = (float)distanceM * (float)distanceM;
+    minIntervalMs = minInterval;
+    maxIntervalMs = (maxInterval < minInterval) ? minInterval : maxInterval;
+}
+
+void GGAScheduler::reset() {
+    referenceValid = false;
+}
+
+float GGAScheduler::squaredDistanceFromReference(double latitude, double longitude) const {
+    // Shortest way around the antimeridian, wrapped before the float conversion
+    double lonDifference = longitude - referenceLongitude;
+    if (lonDifference > 180.0) {
+        lonDifference -= 360.0;
+    } else if (lonDifference < -180.0) {
+        lonDifference += 360.0;
+    }
+    float dLat = (float)(latitude - referenceLatitude);
+    float dLon = (float)lonDifference;
+    float north = dLat * METERS_PER_DEGREE;
+    float east = dLon * METERS_PER_DEGREE * referenceCosLatitude;
+    return north * north + east * east;
+}
+
+GgaSendReason GGAScheduler::evaluate(uint32_t nowMs, double latitude, double longitude,
+                                     uint8_t fixQuality, size_t sentenceLength) {
+    if (fixQuality == 0) {
+        return GGA_SEND_NONE;
+    }
+
+    // Reference schedule: the fixed upload every maximum interval this policy replaces
+    if (!baselineStarted || (uint32_t)(nowMs - lastBaselineMs) >= maxIntervalMs) {
+        baselineStarted = true;
+        lastBaselineMs = nowMs;
+        baselineBytes += sentenceLength;
+    }
+
+    GgaSendReason reason = GGA_SEND_NONE;
+    uint32_t elapsed = nowMs - lastSendMs;
+    if (!referenceValid) {
+        reason = GGA_SEND_FIRST;
+    } else if (elapsed >= maxIntervalMs) {
+        reason = GGA_SEND_MAX_INTERVAL;
+    } else if (elapsed >= minIntervalMs) {
+        if (fixQuality != referenceFix) {
+            reason = GGA_SEND_FIX_CHANGE;
+        } else if (thresholdSquared > 0.0f &&
+                   squaredDistanceFromReference(latitude, longitude) >= thresholdSquared) {
+            reason = GGA_SEND_DISTANCE;
+        }
+    }
+
+    if (reason != GGA_SEND_NONE) {
+        referenceValid = true;
+        referenceLatitude = latitude;
+        referenceLongitude = longitude;
+        referenceCosLatitude = (float)cos(latitude * DEG_TO_RAD);
+        referenceFix = fixQuality;
+        lastSendMs = nowMs;
+        sendCount[reason]++;
+        bytesSent += sentenceLength;
+    }
+    return reason;
+}
+
+uint32_t GGAScheduler::getSendCount(GgaSendReason reason) const {
+    if (reason <= GGA_SEND_NONE || reason >= GGA_SEND_REASON_COUNT) {
+        return 0;
+    }
+    return sendCount[reason];
+}
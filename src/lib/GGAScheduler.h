@@ -0,0 +1,110 @@
+/*!
+ * \file GGAScheduler.h
+ * \brief Decides when the rover position (GGA) is uploaded to the NTRIP caster.
+ *
+ * A GGA is sent when the rover has moved a set distance since the last upload
+ * (a VRS caster then regenerates the virtual base near the new position), when
+ * the fix state changes, or when the maximum interval has passed. A minimum
+ * interval limits the upload rate of a fast moving rover.
+ *
+ * \section gga_distance Distance
+ * The distance to the position of the last upload uses the equirectangular
+ * approximation with the cosine of the reference latitude cached at upload
+ * time. Only the coordinate differences are computed in double precision; the
+ * rest is single precision float, which the ESP32 FPU handles in hardware, and
+ * the comparison is done on the squared distance so no square root is needed.
+ * The error is well below 1% for the distances involved (up to tens of km).
+ *
+ * \section gga_savings Uplink savings
+ * Savings are counted against the fixed schedule this policy replaces: one
+ * upload per maximum interval regardless of motion. The saving is negative
+ * when distance and fix change uploads cost more uplink than that schedule.
+ */
+
+#ifndef GGA_SCHEDULER_H
+#define GGA_SCHEDULER_H
+
+#include <cstdint>
+#include <stddef.h>
+
+/**
+ * \brief Reason for a GGA upload.
+ */
+enum GgaSendReason {
+    GGA_SEND_NONE = 0,          /**< No upload for this epoch */
+    GGA_SEND_FIRST,             /**< First valid position after reset() */
+    GGA_SEND_DISTANCE,          /**< Moved more than the distance threshold (VRS regeneration) */
+    GGA_SEND_FIX_CHANGE,        /**< Fix quality changed since the last upload */
+    GGA_SEND_MAX_INTERVAL,      /**< Maximum interval passed */
+    GGA_SEND_REASON_COUNT
+};
+
+class GGAScheduler {
+public:
+    GGAScheduler();
+
+    /**
+     * \brief Set the upload policy.
+     * \param[in] distanceM Distance that triggers an upload in meters (0 disables the distance trigger).
+     * \param[in] minIntervalMs Minimum time between uploads in milliseconds.
+     * \param[in] maxIntervalMs Maximum time between uploads in milliseconds.
+     */
+    void configure(uint32_t distanceM, uint32_t minIntervalMs, uint32_t maxIntervalMs);
+
+    /**
+     * \brief Send the next valid position immediately, e.g. after a (re)connect.
+     *
+     * Counters are kept.
+     */
+    void reset();
+
+    /**
+     * \brief Evaluate one GGA epoch.
+     * \param[in] nowMs Monotonic time in milliseconds (may wrap).
+     * \param[in] latitude Latitude in decimal degrees.
+     * \param[in] longitude Longitude in decimal degrees.
+     * \param[in] fixQuality GGA fix quality; 0 (no fix) is never sent.
+     * \param[in] sentenceLength Length of the GGA sentence, for the uplink byte counters.
+     * \return Reason to send this GGA, or GGA_SEND_NONE.
+     */
+    GgaSendReason evaluate(uint32_t nowMs, double latitude, double longitude,
+                           uint8_t fixQuality, size_t sentenceLength);
+
+    /**
+     * \brief Squared distance in m^2 from the position of the last upload.
+     */
+    float squaredDistanceFromReference(double latitude, double longitude) const;
+
+    /** \brief Uploads since construction for one reason. */
+    uint32_t getSendCount(GgaSendReason reason) const;
+
+    /** \brief GGA bytes selected for upload. */
+    uint64_t getBytesSent() const { return bytesSent; }
+
+    /** \brief GGA bytes a fixed schedule at the maximum interval would have sent. */
+    uint64_t getBaselineBytes() const { return baselineBytes; }
+
+    /** \brief Baseline bytes minus sent bytes (negative if more was sent). */
+    int64_t getBytesSaved() const { return (int64_t)baselineBytes - (int64_t)bytesSent; }
+
+private:
+    float thresholdSquared;
+    uint32_t minIntervalMs;
+    uint32_t maxIntervalMs;
+
+    bool referenceValid;
+    double referenceLatitude;
+    double referenceLongitude;
+    float referenceCosLatitude;
+    uint8_t referenceFix;
+    uint32_t lastSendMs;
+
+    bool baselineStarted;
+    uint32_t lastBaselineMs;
+
+    uint32_t sendCount[GGA_SEND_REASON_COUNT];
+    uint64_t bytesSent;
+    uint64_t baselineBytes;
+};
+
+#endif // GGA_SCHEDULER_H
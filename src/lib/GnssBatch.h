@@ -0,0 +1,139 @@
+/*!
+ * \file GnssBatch.h
+ * \brief Collects GNSS epochs for one batched MQTT message.
+ *
+ * Instead of one MQTT message per position, epochs are collected until the
+ * batch holds a set number of epochs or the oldest epoch has waited the
+ * maximum latency. The batch is then published as one message with one array
+ * per field.
+ *
+ * \section batch_quantization Quantization
+ * Every epoch is stored as integers in the resolution of the single GNSS
+ * message: coordinates in 1e-7 degrees, altitude in mm, speed, HDOP and age
+ * in hundredths and heading in tenths. A batch therefore carries the same
+ * information as the single messages it replaces.
+ *
+ * \section batch_delta Delta coding
+ * Coordinates and altitude are published as the difference to the previous
+ * epoch (the first epoch against the batch base, so its delta is 0), and the
+ * time as the offset to the first epoch. At sub-second rates these are small
+ * numbers that take a few characters in JSON or one to three bytes in CBOR.
+ * Differences are 64-bit, so a longitude step across the antimeridian
+ * cannot overflow.
+ *
+ * \section batch_simplify Track simplification
+ * simplify() thins a batch with the Douglas-Peucker algorithm: epochs whose
+ * horizontal distance to the simplified track stays within a tolerance are
+ * removed, the first and last epoch are always kept. Each batch is simplified
+ * on its own just before it is published, so the track is simplified as it
+ * streams out, with a bounded cost of at most MAX_EPOCHS points. Distances
+ * use the same equirectangular approximation as GGAScheduler in single
+ * precision float; the remaining epochs keep their exact values and times.
+ *
+ * \section batch_savings Savings
+ * add() takes the size the epoch would have had as a single MQTT message, so
+ * the messages and bytes saved by batching can be reported.
+ */
+
+#ifndef GNSS_BATCH_H
+#define GNSS_BATCH_H
+
+#include <cstdint>
+#include <stddef.h>
+
+/**
+ * \brief One quantized GNSS epoch.
+ */
+struct GnssEpoch {
+    uint32_t timeOfDayMs;   /**< UTC time of day in milliseconds */
+    int32_t latE7;          /**< Latitude in 1e-7 degrees */
+    int32_t lonE7;          /**< Longitude in 1e-7 degrees */
+    int32_t altMm;          /**< Altitude in millimeters */
+    uint32_t speedX100;     /**< Speed in 0.01 km/h */
+    uint16_t dirX10;        /**< Heading in 0.1 degrees */
+    uint16_t hdopX100;      /**< HDOP in 0.01 */
+    uint16_t ageX100;       /**< Age of differential data in 0.01 seconds */
+    uint8_t fixType;        /**< GGA fix quality */
+    uint8_t sats;           /**< Satellites used */
+};
+
+class GnssBatch {
+public:
+    /** \brief Largest number of epochs in one batch. */
+    static const uint8_t MAX_EPOCHS = 32;
+
+    GnssBatch();
+
+    /**
+     * \brief Quantize a position to the resolution of the single GNSS message.
+     * Values out of range are clamped.
+     */
+    static GnssEpoch quantize(uint32_t timeOfDayMs, double latitude, double longitude, float altitude,
+                              float speed, float heading, float hdop, float age,
+                              uint8_t fixType, uint8_t sats);
+
+    /**
+     * \brief Set the batch limits.
+     * \param[in] maxEpochs Epochs per batch (1 to MAX_EPOCHS).
+     * \param[in] maxLatencyMs Longest time the first epoch of a batch waits.
+     */
+    void configure(uint8_t maxEpochs, uint32_t maxLatencyMs);
+
+    /**
+     * \brief Add an epoch.
+     * \param[in] epoch Quantized epoch.
+     * \param[in] nowMs Monotonic time in milliseconds (may wrap).
+     * \param[in] singleMessageBytes Size this epoch would have had as a single MQTT message.
+     * \return false if the epoch has the same time as the previous one or the batch is full.
+     */
+    bool add(const GnssEpoch& epoch, uint32_t nowMs, size_t singleMessageBytes);
+
+    /** \brief true if an epoch with this time was the last one added. */
+    bool isRepeat(uint32_t timeOfDayMs) const { return haveLastTime && timeOfDayMs == lastTimeOfDayMs; }
+
+    /** \brief true when the batch is full or its first epoch has waited the maximum latency. */
+    bool isDue(uint32_t nowMs) const;
+
+    /** \brief Remove all epochs; the time of the last epoch is kept to skip repeats. */
+    void clear();
+
+    /** \brief Forget the last epoch time as well, e.g. after a reconnect. */
+    void reset();
+
+    uint8_t count() const { return size; }
+    const GnssEpoch& epoch(uint8_t index) const { return epochs[index]; }
+
+    /** \brief Time of an epoch after the first one in ms (across midnight). */
+    uint32_t timeOffsetMs(uint8_t index) const;
+
+    /** \brief Latitude change to the previous epoch in 1e-7 degrees (0 for the first). */
+    int64_t latDelta(uint8_t index) const;
+
+    /** \brief Longitude change to the previous epoch in 1e-7 degrees (0 for the first). */
+    int64_t lonDelta(uint8_t index) const;
+
+    /** \brief Altitude change to the previous epoch in mm (0 for the first). */
+    int64_t altDelta(uint8_t index) const;
+
+    /**
+     * \brief Remove epochs within a tolerance of the simplified track.
+     * \param[in] toleranceMm Largest horizontal distance of a removed epoch in mm (0 keeps all).
+     * \return Number of epochs removed.
+     */
+    uint8_t simplify(uint32_t toleranceMm);
+
+    /** \brief Total size of the epochs as single MQTT messages (removed epochs included). */
+    size_t singleMessageBytes() const { return unbatchedBytes; }
+
+private:
+    GnssEpoch epochs[MAX_EPOCHS];
+    uint8_t size;
+    uint8_t maxEpochs;
+    uint32_t maxLatencyMs;
+    uint32_t firstAddedMs;
+    size_t unbatchedBytes;
+    bool haveLastTime;
+    uint32_t lastTimeOfDayMs;
+};
+
+#endif // GNSS_BATCH_H
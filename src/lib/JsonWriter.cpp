@@ -0,0 +1,284 @@
+#include <cstdint>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "JsonWriter.h"
+
+#define JSON_INDENT_WIDTH 3
+#define FIXED_MAX_DECIMALS 9
+
+// Largest scaled value that is still an exact integer in a double
+#define FIXED_MAX_SCALED 4503599627370496.0  // 2^52
+
+// Relative error of one double multiplication, with margin
+#define FIXED_TIE_TOLERANCE 4e-16
+
+static const double POW10[FIXED_MAX_DECIMALS + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9
+};
+
+static const uint32_t POW10_INT[FIXED_MAX_DECIMALS + 1] = {
+    1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u
+};
+
+// Member separator followed by the indentation of the deepest level
+static const char SEPARATOR[] = ",\n                        ";
+
+// Write the decimal digits of value so they end at out, return the first digit
+static char* digitsBefore(uint64_t value, char* out) {
+    // 64-bit division is a library call on the ESP32, use 32 bits when possible
+    while (value > 0xFFFFFFFFu) {
+        *--out = (char)('0' + (value % 10));
+        value /= 10;
+    }
+    uint32_t small = (uint32_t)value;
+    do {
+        *--out = (char)('0' + (small % 10));
+        small /= 10;
+    } while (small != 0);
+    return out;
+}
+
+static size_t copyTerminated(const char* text, size_t length, char* out, size_t size) {
+    if (size > 0) {
+        size_t n = length < size - 1 ? length : size - 1;
+        memcpy(out, text, n);
+        out[n] = '\0';
+    }
+    return length;
+}
+
+size_t formatFixed(double value, uint8_t decimals, char* out, size_t size) {
+    if (decimals > FIXED_MAX_DECIMALS) {
+        decimals = FIXED_MAX_DECIMALS;
+    }
+
+    bool negative = signbit(value);
+    double magnitude = fabs(value);
+    double scaled = magnitude * POW10[decimals];
+
+    // NaN, infinity, very large numbers and near-ties go through printf
+    bool exact = isfinite(scaled) && scaled < FIXED_MAX_SCALED;
+    double whole = 0.0;
+    if (exact) {
+        whole = floor(scaled);
+        double fraction = scaled - whole;
+        if (fabs(fraction - 0.5) <= scaled * FIXED_TIE_TOLERANCE) {
+            exact = false;
+        } else if (fraction > 0.5) {
+            whole += 1.0;
+        }
+    }
+    if (!exact) {
+        int n = snprintf(out, size, "%.*f", (int)decimals, value);
+        return n < 0 ? 0 : (size_t)n;
+    }
+
+    uint64_t rounded = (uint64_t)whole;
+    uint64_t integerPart;
+    uint32_t fractionPart;
+    if (rounded <= 0xFFFFFFFFu) {
+        integerPart = (uint32_t)rounded / POW10_INT[decimals];
+        fractionPart = (uint32_t)rounded % POW10_INT[decimals];
+    } else {
+        integerPart = rounded / POW10_INT[decimals];
+        fractionPart = (uint32_t)(rounded % POW10_INT[decimals]);
+    }
+
+    // Built from the end: fraction, decimal point, integer part, sign
+    char text[32];
+    char* end = text + sizeof(text);
+    char* start = end;
+    for (uint8_t i = 0; i < decimals; i++) {
+        *--start = (char)('0' + (fractionPart % 10));
+        fractionPart /= 10;
+    }
+    if (decimals > 0) {
+        *--start = '.';
+    }
+    start = digitsBefore(integerPart, start);
+    if (negative) {
+        *--start = '-';
+    }
+    return copyTerminated(start, (size_t)(end - start), out, size);
+}
+
+JsonWriter::JsonWriter(char* out, size_t size)
+    : buffer(out),
+      capacity(size),
+      written(0),
+      depth(0),
+      firstItem(true) {
+    if (capacity > 0) {
+        buffer[0] = '\0';
+    }
+}
+
+void JsonWriter::append(const char* text, size_t length) {
+    if (written + length < capacity) {
+        memcpy(buffer + written, text, length);
+        buffer[written + length] = '\0';
+    } else if (written + 1 < capacity) {
+        size_t room = capacity - 1 - written;
+        size_t n = length < room ? length : room;
+        memcpy(buffer + written, text, n);
+        buffer[written + n] = '\0';
+    }
+    written += length;
+}
+
+void JsonWriter::appendChar(char c) {
+    if (written + 1 < capacity) {
+        buffer[written] = c;
+        buffer[written + 1] = '\0';
+    }
+    written++;
+}
+
+void JsonWriter::appendUInt64(uint64_t value) {
+    char text[20];
+    char* end = text + sizeof(text);
+    char* start = digitsBefore(value, end);
+    append(start, (size_t)(end - start));
+}
+
+void JsonWriter::appendInt64(int64_t value) {
+    if (value < 0) {
+        appendChar('-');
+        appendUInt64(0 - (uint64_t)value);
+    } else {
+        appendUInt64((uint64_t)value);
+    }
+}
+
+void JsonWriter::key(const char* name) {
+    if (depth == 0) {
+        return;
+    }
+    uint8_t level = depth - 1;
+    if (inlineLevel[level]) {
+        append(firstMember[level] ? " " : ", ", firstMember[level] ? 1 : 2);
+    } else {
+        // ",\n" or "\n", then the indentation
+        size_t skip = firstMember[level] ? 1 : 0;
+        append(SEPARATOR + skip, 2 - skip + depth * JSON_INDENT_WIDTH);
+    }
+    firstMember[level] = false;
+    appendChar('"');
+    append(name, strlen(name));
+    append("\": ", 3);
+}
+
+void JsonWriter::beginObject() {
+    appendChar('{');
+    if (depth < MAX_DEPTH) {
+        firstMember[depth] = true;
+        inlineLevel[depth] = false;
+        depth++;
+    }
+}
+
+void JsonWriter::beginObject(const char* name, bool inlineObject) {
+    key(name);
+    appendChar('{');
+    if (depth < MAX_DEPTH) {
+        firstMember[depth] = true;
+        // Members of an inline object stay on one line
+        inlineLevel[depth] = inlineObject || (depth > 0 && inlineLevel[depth - 1]);
+        depth++;
+    }
+}
+
+void JsonWriter::endObject() {
+    if (depth == 0) {
+        return;
+    }
+    depth--;
+    if (inlineLevel[depth]) {
+        append(" }", 2);
+    } else {
+        append(SEPARATOR + 1, 1 + depth * JSON_INDENT_WIDTH);
+        appendChar('}');
+    }
+}
+
+void JsonWriter::addString(const char* name, const char* value) {
+    key(name);
+    appendChar('"');
+    const char* run = value;
+    for (const char* p = value; *p != '\0'; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c == '"' || c == '\\' || c < 0x20) {
+            append(run, (size_t)(p - run));
+            run = p + 1;
+            if (c < 0x20) {
+                char escape[7];
+                snprintf(escape, sizeof(escape), "\\u%04x", c);
+                append(escape, 6);
+            } else {
+                appendChar('\\');
+                appendChar((char)c);
+            }
+        }
+    }
+    append(run, strlen(run));
+    appendChar('"');
+}
+
+void JsonWriter::addBool(const char* name, bool value) {
+    key(name);
+    if (value) {
+        append("true", 4);
+    } else {
+        append("false", 5);
+    }
+}
+
+void JsonWriter::addUInt(const char* name, uint32_t value) {
+    key(name);
+    appendUInt64(value);
+}
+
+void JsonWriter::addInt(const char* name, int32_t value) {
+    addInt64(name, value);
+}
+
+void JsonWriter::addInt64(const char* name, int64_t value) {
+    key(name);
+    appendInt64(value);
+}
+
+void JsonWriter::addFixed(const char* name, double value, uint8_t decimals) {
+    key(name);
+    char text[40];
+    size_t length = formatFixed(value, decimals, text, sizeof(text));
+    if (length < sizeof(text)) {
+        append(text, length);
+    } else {
+        // Huge value: let printf write it in place
+        if (written < capacity) {
+            snprintf(buffer + written, capacity - written, "%.*f", (int)decimals, value);
+        }
+        written += length;
+    }
+}
+
+void JsonWriter::beginArray(const char* name) {
+    key(name);
+    appendChar('[');
+    firstItem = true;
+}
+
+void JsonWriter::addItem(int64_t value) {
+    if (!firstItem) {
+        appendChar(',');
+    }
+    firstItem = false;
+    appendInt64(value);
+}
+
+void JsonWriter::endArray() {
+    appendChar(']');
+}
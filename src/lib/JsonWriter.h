@@ -0,0 +1,105 @@
+/*!
+ * \file JsonWriter.h
+ * \brief Streaming JSON writer for the MQTT payloads.
+ *
+ * Members are written straight into a caller supplied buffer; nothing is
+ * allocated. The layout is the one the MQTT messages always had: one member
+ * per line with three spaces indentation per level, or an inline object
+ * (`{ "a": 1, "b": 2 }`) for short groups. Integer arrays are written on one
+ * line without spaces (`[1,-2,3]`), as used for the batched GNSS message.
+ *
+ * \section json_numbers Numbers
+ * Integers are converted with a digit loop. Fixed-precision numbers use
+ * formatFixed(), which gives the same digits as printf `%.Nf` without the
+ * printf floating point code: the value is scaled by a power of ten and
+ * rounded as a 64-bit integer. Only when the scaled value lies so close to
+ * a rounding tie that the double multiplication could decide it wrongly, or
+ * when it does not fit 53 bits, is snprintf used to keep the output exact.
+ *
+ * \section json_overflow Overflow
+ * Like snprintf, output that does not fit is truncated, the buffer is always
+ * terminated and length() returns the full length that was needed.
+ */
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <cstdint>
+#include <stddef.h>
+
+/**
+ * \brief Format a number with a fixed number of decimals, as printf `%.Nf`.
+ * \param[in] value Value to format.
+ * \param[in] decimals Number of decimals (0-9).
+ * \param[out] out Output buffer, always terminated if size > 0.
+ * \param[in] size Size of the output buffer.
+ * \return Length of the formatted number (may exceed size - 1).
+ */
+size_t formatFixed(double value, uint8_t decimals, char* out, size_t size);
+
+class JsonWriter {
+public:
+    /**
+     * \param[out] buffer Output buffer.
+     * \param[in] size Size of the output buffer including the terminator.
+     */
+    JsonWriter(char* buffer, size_t size);
+
+    /** \brief Open the top level object. */
+    void beginObject();
+
+    /**
+     * \brief Open a nested object.
+     * \param[in] key Member name.
+     * \param[in] inlineObject Write all members on one line.
+     */
+    void beginObject(const char* key, bool inlineObject = false);
+
+    /** \brief Close the innermost open object. */
+    void endObject();
+
+    void addString(const char* key, const char* value);
+    void addBool(const char* key, bool value);
+    void addUInt(const char* key, uint32_t value);
+    void addInt(const char* key, int32_t value);
+    void addInt64(const char* key, int64_t value);
+
+    /**
+     * \brief Add a number with a fixed number of decimals (printf `%.Nf`).
+     */
+    void addFixed(const char* key, double value, uint8_t decimals);
+
+    /** \brief Open an inline integer array; add items with addItem(). */
+    void beginArray(const char* key);
+
+    /** \brief Add an integer to the open array. */
+    void addItem(int64_t value);
+
+    /** \brief Close the open array. */
+    void endArray();
+
+    /** \brief Length of the complete output, also when it was truncated. */
+    size_t length() const { return written; }
+
+    /** \brief true if the output did not fit in the buffer. */
+    bool overflowed() const { return written >= capacity; }
+
+private:
+    static const uint8_t MAX_DEPTH = 8;
+
+    void append(const char* text, size_t length);
+    void appendChar(char c);
+    void appendUInt64(uint64_t value);
+    void appendInt64(int64_t value);
+    void key(const char* name);
+
+    char* buffer;
+    size_t capacity;
+    size_t written;
+    uint8_t depth;
+    bool firstMember[MAX_DEPTH];
+    bool inlineLevel[MAX_DEPTH];
+    bool firstItem;
+};
+
+#endif // JSON_WRITER_H
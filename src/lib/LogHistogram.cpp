@@ -0,0 +1,213 @@
+#include <cstdint>
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "LogHistogram.h"
+
+#define SUB_BUCKETS (1U << LOG_HISTOGRAM_SUB_BITS)
+
+LogHistogram::LogHistogram() {
+    reset();
+}
+
+void LogHistogram::reset() {
+    memset(buckets, 0, sizeof(buckets));
+    count = 0;
+    overflows = 0;
+    minimum = UINT32_MAX;
+    maximum = 0;
+    sum = 0;
+}
+
+size_t LogHistogram::bucketIndex(uint32_t value) {
+    if (value > LOG_HISTOGRAM_MAX_VALUE) {
+        value = LOG_HISTOGRAM_MAX_VALUE;
+    }
+    if (value < SUB_BUCKETS) {
+        return value;
+    }
+    // Power of two of the value selects the group, the next bits the sub-bucket
+    unsigned msb = 31 - __builtin_clz(value);
+    unsigned shift = msb - LOG_HISTOGRAM_SUB_BITS;
+    return ((size_t)(shift + 1) << LOG_HISTOGRAM_SUB_BITS) + ((value >> shift) - SUB_BUCKETS);
+}
+
+uint32_t LogHistogram::bucketLow(size_t index) {
+    if (index >= LOG_HISTOGRAM_BUCKETS) {
+        index = LOG_HISTOGRAM_BUCKETS - 1;
+    }
+    if (index < SUB_BUCKETS) {
+        return (uint32_t)index;
+    }
+    unsigned group = (unsigned)(index >> LOG_HISTOGRAM_SUB_BITS);
+    uint32_t sub = (uint32_t)(index & (SUB_BUCKETS - 1));
+    return (SUB_BUCKETS + sub) << (group - 1);
+}
+
+uint32_t LogHistogram::bucketHigh(size_t index) {
+    if (index >= LOG_HISTOGRAM_BUCKETS) {
+        index = LOG_HISTOGRAM_BUCKETS - 1;
+    }
+    if (index < SUB_BUCKETS) {
+        return (uint32_t)index;
+    }
+    unsigned group = (unsigned)(index >> LOG_HISTOGRAM_SUB_BITS);
+    return bucketLow(index) + (1U << (group - 1)) - 1;
+}
+
+void LogHistogram::record(uint32_t value) {
+    if (value > LOG_HISTOGRAM_MAX_VALUE) {
+        overflows++;
+    }
+    buckets[bucketIndex(value)]++;
+    count++;
+    sum += value;
+    if (value < minimum) {
+        minimum = value;
+    }
+    if (value > maximum) {
+        maximum = value;
+    }
+}
+
+void LogHistogram::record(uint32_t value, uint32_t samples) {
+    if (samples == 0) {
+        return;
+    }
+    if (value > LOG_HISTOGRAM_MAX_VALUE) {
+        overflows += samples;
+    }
+    buckets[bucketIndex(value)] += samples;
+    count += samples;
+    sum += (uint64_t)value * samples;
+    if (value < minimum) {
+        minimum = value;
+    }
+    if (value > maximum) {
+        maximum = value;
+    }
+}
+
+void LogHistogram::merge(const LogHistogram& other) {
+    if (other.count == 0) {
+        return;
+    }
+    for (size_t i = 0; i < LOG_HISTOGRAM_BUCKETS; i++) {
+        buckets[i] += other.buckets[i];
+    }
+    count += other.count;
+    overflows += other.overflows;
+    sum += other.sum;
+    if (other.minimum < minimum) {
+        minimum = other.minimum;
+    }
+    if (other.maximum > maximum) {
+        maximum = other.maximum;
+    }
+}
+
+uint32_t LogHistogram::quantile(float q) const {
+    if (count == 0) {
+        return 0;
+    }
+    if (q <= 0.0f) {
+        return minimum;
+    }
+    if (q >= 1.0f) {
+        return maximum;
+    }
+    // Rank of the sample, 1 for the smallest
+    uint32_t rank = (uint32_t)ceilf(q * count);
+    if (rank < 1) {
+        rank = 1;
+    }
+    uint32_t seen = 0;
+    for (size_t i = 0; i < LOG_HISTOGRAM_BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            uint32_t low = bucketLow(i);
+            uint32_t value = low + (bucketHigh(i) - low) / 2;
+            if (value < minimum) {
+                return minimum;
+            }
+            return value > maximum ? maximum : value;
+        }
+    }
+    return maximum;
+}
+
+size_t LogHistogram::exportSparse(uint8_t* gaps, uint32_t* counts, size_t maxBins, uint8_t* shift) const {
+    if (gaps == NULL || counts == NULL || maxBins == 0 || shift == NULL) {
+        return 0;
+    }
+    // Smallest shift at which the non-empty bins fit
+    uint8_t s = 0;
+    while (((LOG_HISTOGRAM_BUCKETS - 1) >> s) > 0) {
+        size_t bins = 0;
+        size_t last = SIZE_MAX;
+        for (size_t i = 0; i < LOG_HISTOGRAM_BUCKETS; i++) {
+            if (buckets[i] != 0 && (i >> s) != last) {
+                last = i >> s;
+                bins++;
+            }
+        }
+        if (bins <= maxBins) {
+            break;
+        }
+        s++;
+    }
+    *shift = s;
+
+    size_t written = 0;
+    size_t previous = 0;
+    for (size_t i = 0; i < LOG_HISTOGRAM_BUCKETS; i++) {
+        if (buckets[i] == 0) {
+            continue;
+        }
+        size_t bin = i >> s;
+        if (written > 0 && bin == previous) {
+            counts[written - 1] += buckets[i];
+            continue;
+        }
+        gaps[written] = (uint8_t)(bin - (written > 0 ? previous : 0));
+        counts[written] = buckets[i];
+        previous = bin;
+        written++;
+    }
+    return written;
+}
+
+bool LogHistogram::importSparse(const uint8_t* gaps, const uint32_t* counts, size_t bins, uint8_t shift) {
+    reset();
+    if (bins > 0 && (gaps == NULL || counts == NULL)) {
+        return false;
+    }
+    size_t bin = 0;
+    for (size_t i = 0; i < bins; i++) {
+        bin += gaps[i];
+        if (shift >= 16 || (bin << shift) >= LOG_HISTOGRAM_BUCKETS) {
+            reset();
+            return false;
+        }
+        size_t first = bin << shift;
+        size_t last = ((bin + 1) << shift) - 1;
+        if (last >= LOG_HISTOGRAM_BUCKETS) {
+            last = LOG_HISTOGRAM_BUCKETS - 1;
+        }
+        uint32_t low = bucketLow(first);
+        uint32_t high = bucketHigh(last);
+        buckets[first] += counts[i];
+        count += counts[i];
+        sum += (uint64_t)counts[i] * (low + (high - low) / 2);
+        if (counts[i] > 0) {
+            if (low < minimum) {
+                minimum = low;
+            }
+            if (high > maximum) {
+                maximum = high;
+            }
+        }
+    }
+    return true;
+}
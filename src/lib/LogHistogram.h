@@ -0,0 +1,133 @@
+/*!
+ * \file LogHistogram.h
+ * \brief Fixed-memory log-linear histogram for streaming statistics.
+ *
+ * Counts unsigned integer samples in buckets that are one wide up to 8 and
+ * then split every power of two into 8 equal sub-buckets, like an HDR
+ * histogram. A quantile read from the buckets is within 1/16 (6.25%) of the
+ * exact sample value at any scale, from a correction age of a few tenths of
+ * a second to a latency of a second in microseconds. Metrics with decimals
+ * are recorded scaled, e.g. HDOP times 100.
+ *
+ * Recording is an index calculation and an increment; the memory is fixed
+ * (LOG_HISTOGRAM_BUCKETS counters) whatever the number of samples. Count,
+ * sum, minimum and maximum are kept exactly.
+ *
+ * \section histogram_merge Scopes
+ * Histograms with the same layout add up bucket by bucket, so a period
+ * histogram is merged into a runtime histogram at the end of every period
+ * and both give quantiles of their own scope.
+ *
+ * \section histogram_sparse Sparse export
+ * exportSparse() writes the non-empty buckets as (index gap, count) pairs.
+ * When there are more non-empty buckets than pairs, neighbouring buckets are
+ * combined 2, 4, 8... at a time (the shift) until they fit; a bin then covers
+ * buckets index << shift up to ((index + 1) << shift) - 1. importSparse()
+ * reads this back.
+ */
+
+#ifndef LOG_HISTOGRAM_H
+#define LOG_HISTOGRAM_H
+
+#include <cstdint>
+#include <stddef.h>
+
+#define LOG_HISTOGRAM_SUB_BITS 3        // 8 sub-buckets per power of two
+#define LOG_HISTOGRAM_VALUE_BITS 21     // Largest value without overflow is 2^21 - 1
+#define LOG_HISTOGRAM_BUCKETS ((LOG_HISTOGRAM_VALUE_BITS - LOG_HISTOGRAM_SUB_BITS + 1) << LOG_HISTOGRAM_SUB_BITS)
+#define LOG_HISTOGRAM_MAX_VALUE ((1UL << LOG_HISTOGRAM_VALUE_BITS) - 1)
+
+class LogHistogram {
+public:
+    /** \brief Create an empty histogram. */
+    LogHistogram();
+
+    /** \brief Remove all samples. */
+    void reset();
+
+    /**
+     * \brief Count a sample.
+     * \param[in] value Sample; values above LOG_HISTOGRAM_MAX_VALUE are counted in the top bucket.
+     */
+    void record(uint32_t value);
+
+    /**
+     * \brief Count a sample a number of times.
+     * \param[in] value Sample; values above LOG_HISTOGRAM_MAX_VALUE are counted in the top bucket.
+     * \param[in] samples Number of times the sample occurred.
+     */
+    void record(uint32_t value, uint32_t samples);
+
+    /**
+     * \brief Add the samples of another histogram.
+     * \param[in] other Histogram to add; it is not changed.
+     */
+    void merge(const LogHistogram& other);
+
+    /**
+     * \brief Sample at a quantile.
+     * \param[in] q Quantile from 0.0 to 1.0, e.g. 0.99 for the 99th percentile.
+     * \return Middle of the bucket holding the sample, limited to the minimum and maximum; 0 without samples.
+     */
+    uint32_t quantile(float q) const;
+
+    /** \brief Number of samples. */
+    uint32_t getCount() const { return count; }
+
+    /** \brief Samples above LOG_HISTOGRAM_MAX_VALUE. */
+    uint32_t getOverflows() const { return overflows; }
+
+    /** \brief Smallest sample, 0 without samples. */
+    uint32_t getMin() const { return count > 0 ? minimum : 0; }
+
+    /** \brief Largest sample, 0 without samples. */
+    uint32_t getMax() const { return maximum; }
+
+    /** \brief Average of the samples, 0 without samples. */
+    float getMean() const { return count > 0 ? (float)((double)sum / count) : 0.0f; }
+
+    /** \brief Samples in a bucket, 0 for an unknown bucket. */
+    uint32_t getBucketCount(size_t index) const { return index < LOG_HISTOGRAM_BUCKETS ? buckets[index] : 0; }
+
+    /**
+     * \brief Export the non-empty buckets as (index gap, count) pairs.
+     * \param[out] gaps Bin index minus the previous bin index; the first is the bin index itself.
+     * \param[out] counts Samples per bin.
+     * \param[in] maxBins Size of gaps and counts.
+     * \param[out] shift Number of times neighbouring buckets were combined to fit maxBins.
+     * \return Number of pairs written.
+     */
+    size_t exportSparse(uint8_t* gaps, uint32_t* counts, size_t maxBins, uint8_t* shift) const;
+
+    /**
+     * \brief Replace the samples by an exported histogram.
+     * \param[in] gaps Index gaps from exportSparse().
+     * \param[in] counts Samples per bin.
+     * \param[in] bins Number of pairs.
+     * \param[in] shift Shift from exportSparse().
+     * \return false when a bin is outside the histogram; the histogram is then empty.
+     *
+     * The samples of a bin go into its lowest bucket; minimum and maximum are
+     * the bounds of the first and last bin, the sum uses the bucket middles.
+     */
+    bool importSparse(const uint8_t* gaps, const uint32_t* counts, size_t bins, uint8_t shift);
+
+    /** \brief Bucket of a value. */
+    static size_t bucketIndex(uint32_t value);
+
+    /** \brief Smallest value in a bucket. */
+    static uint32_t bucketLow(size_t index);
+
+    /** \brief Largest value in a bucket. */
+    static uint32_t bucketHigh(size_t index);
+
+private:
+    uint32_t buckets[LOG_HISTOGRAM_BUCKETS];
+    uint32_t count;
+    uint32_t overflows;
+    uint32_t minimum;
+    uint32_t maximum;
+    uint64_t sum;
+};
+
+#endif // LOG_HISTOGRAM_H
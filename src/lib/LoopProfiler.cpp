@@ -0,0 +1,49 @@
+#include <atomic>
+#include <cstdint>
+#include <stddef.h>
+
+#include "LoopProfiler.h"
+
+LoopProfiler::LoopProfiler() {
+    for (size_t i = 0; i < LOG_HISTOGRAM_BUCKETS; i++) {
+        buckets[i].store(0, std::memory_order_relaxed);
+    }
+    count.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    maximum.store(0, std::memory_order_relaxed);
+}
+
+void LoopProfiler::record(uint32_t durationUs) {
+    buckets[LogHistogram::bucketIndex(durationUs)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(durationUs, std::memory_order_relaxed);
+    // The reader may reset the maximum in between, so compare and swap
+    uint32_t longest = maximum.load(std::memory_order_relaxed);
+    while (durationUs > longest &&
+           !maximum.compare_exchange_weak(longest, durationUs, std::memory_order_relaxed)) {
+    }
+}
+
+uint32_t LoopProfiler::collect(LogHistogram* histogram, uint64_t* sumUs, uint32_t* maxUs) {
+    uint32_t samples = count.exchange(0, std::memory_order_relaxed);
+    uint32_t total = sum.exchange(0, std::memory_order_relaxed);
+    uint32_t longest = maximum.exchange(0, std::memory_order_relaxed);
+    for (size_t i = 0; i < LOG_HISTOGRAM_BUCKETS; i++) {
+        // Most buckets of a loop stay empty, only those in use are exchanged
+        if (buckets[i].load(std::memory_order_relaxed) == 0) {
+            continue;
+        }
+        uint32_t n = buckets[i].exchange(0, std::memory_order_relaxed);
+        if (histogram != NULL) {
+            uint32_t low = LogHistogram::bucketLow(i);
+            histogram->record(low + (LogHistogram::bucketHigh(i) - low) / 2, n);
+        }
+    }
+    if (sumUs != NULL) {
+        *sumUs = total;
+    }
+    if (maxUs != NULL) {
+        *maxUs = longest;
+    }
+    return samples;
+}
@@ -0,0 +1,62 @@
+/*!
+ * \file LoopProfiler.h
+ * \brief Lock-free loop duration histogram written by one task.
+ *
+ * Used by the Statistics Task for the loop durations of the GNSS, NTRIP,
+ * Data Output, MQTT and LED tasks. Every loop iteration records its
+ * duration in microseconds into counters with the bucket layout of
+ * LogHistogram; the Statistics Task collects them once per second into a
+ * LogHistogram of its own for the quantiles of the period.
+ *
+ * \section profiler_atomics Writer and reader
+ * The task that owns the profiler is its only writer. A record is a bucket
+ * index calculation and a few atomic additions, so it never waits for the
+ * reader. The loops run at most a few hundred times per second, so an
+ * atomic read-modify-write per record costs nothing measurable. The reader
+ * takes the counters with an atomic exchange to zero: a sample is moved
+ * exactly once, whenever it is recorded.
+ *
+ * \section profiler_consistency Consistency
+ * The counters are taken one by one. A sample recorded during a collect
+ * can be in the count but not yet in its bucket; the next collect moves
+ * the rest. The samples of a bucket go into the histogram at the middle of
+ * the bucket, so its quantiles are within 1/16; count, sum and maximum are
+ * returned exactly.
+ */
+
+#ifndef LOOP_PROFILER_H
+#define LOOP_PROFILER_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "LogHistogram.h"
+
+class LoopProfiler {
+public:
+    /** \brief Create a profiler without samples. */
+    LoopProfiler();
+
+    /**
+     * \brief Count the duration of one loop iteration. Only the owning task may call this.
+     * \param[in] durationUs Duration in microseconds.
+     */
+    void record(uint32_t durationUs);
+
+    /**
+     * \brief Move the samples recorded since the last collect into a histogram.
+     * \param[out] histogram Receives the samples at their bucket middles; NULL drops them.
+     * \param[out] sumUs Sum of the moved durations in microseconds (optional).
+     * \param[out] maxUs Longest moved duration in microseconds, 0 without samples (optional).
+     * \return Number of samples moved.
+     */
+    uint32_t collect(LogHistogram* histogram, uint64_t* sumUs, uint32_t* maxUs);
+
+private:
+    std::atomic<uint32_t> buckets[LOG_HISTOGRAM_BUCKETS];
+    std::atomic<uint32_t> count;
+    std::atomic<uint32_t> sum;         // Microseconds; the reader empties it long before it wraps
+    std::atomic<uint32_t> maximum;
+};
+
+#endif // LOOP_PROFILER_H
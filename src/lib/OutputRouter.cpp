@@ -0,0 +1,320 @@
+#include <cstdint>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "OutputRouter.h"
+
+OutputRouter::OutputRouter()
+    : storage(NULL),
+      slots(NULL),
+      sinks(NULL),
+      rings(NULL),
+      slotCount(0),
+      slotSize(0),
+      maxSinks(0),
+      maxDepth(0),
+      nextFree(0),
+      routedFrames(0),
+      routedBytes(0) {
+}
+
+OutputRouter::~OutputRouter() {
+    deinit();
+}
+
+bool OutputRouter::init(size_t frameCount, size_t frameSize, size_t sinkSlots, size_t depth) {
+    deinit();
+
+    // Slot indices, lengths and depths are stored as 16 bit values
+    if (frameCount == 0 || frameCount > 0xFFFF || frameSize == 0 || frameSize > 0xFFFF ||
+        sinkSlots == 0 || depth == 0 || depth > 0xFFFF) {
+        return false;
+    }
+
+    storage = (uint8_t*)malloc(frameCount * frameSize);
+    slots = (Slot*)calloc(frameCount, sizeof(Slot));
+    sinks = (Sink*)calloc(sinkSlots, sizeof(Sink));
+    rings = (uint16_t*)calloc(sinkSlots * depth, sizeof(uint16_t));
+    if (storage == NULL || slots == NULL || sinks == NULL || rings == NULL) {
+        deinit();
+        return false;
+    }
+
+    slotCount = frameCount;
+    slotSize = frameSize;
+    maxSinks = sinkSlots;
+    maxDepth = depth;
+    for (size_t i = 0; i < maxSinks; i++) {
+        sinks[i].ring = rings + i * maxDepth;
+    }
+    return true;
+}
+
+void OutputRouter::deinit() {
+    free(storage);
+    free(slots);
+    free(sinks);
+    free(rings);
+    storage = NULL;
+    slots = NULL;
+    sinks = NULL;
+    rings = NULL;
+    slotCount = 0;
+    slotSize = 0;
+    maxSinks = 0;
+    maxDepth = 0;
+    nextFree = 0;
+    routedFrames = 0;
+    routedBytes = 0;
+}
+
+// Ring position of the entry at an offset from the head (offset below the depth)
+static inline uint16_t ringIndex(uint16_t head, uint16_t offset, uint16_t depth) {
+    uint16_t index = (uint16_t)(head + offset);
+    return (index >= depth) ? (uint16_t)(index - depth) : index;
+}
+
+bool OutputRouter::validId(int id) const {
+    return id >= 0 && (size_t)id < maxSinks && sinks[id].active;
+}
+
+int OutputRouter::addSink(size_t depth) {
+    if (depth == 0 || depth > maxDepth) {
+        return -1;
+    }
+    for (size_t i = 0; i < maxSinks; i++) {
+        Sink& sink = sinks[i];
+        if (!sink.active) {
+            sink.active = true;
+            sink.depth = (uint16_t)depth;
+            sink.head = 0;
+            sink.count = 0;
+            sink.offset = 0;
+            memset(&sink.stats, 0, sizeof(sink.stats));
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+void OutputRouter::removeSink(int id) {
+    if (!validId(id)) {
+        return;
+    }
+    dropQueue(sinks[id]);
+    sinks[id].active = false;
+}
+
+void OutputRouter::clearSink(int id) {
+    if (!validId(id)) {
+        return;
+    }
+    dropQueue(sinks[id]);
+}
+
+void OutputRouter::release(uint16_t slot) {
+    if (slots[slot].refs > 0) {
+        slots[slot].refs--;
+    }
+}
+
+void OutputRouter::dropQueue(Sink& sink) {
+    while (sink.count > 0) {
+        release(sink.ring[sink.head]);
+        sink.head = ringIndex(sink.head, 1, sink.depth);
+        sink.count--;
+    }
+    sink.head = 0;
+    sink.offset = 0;
+    sink.stats.pending = 0;
+}
+
+bool OutputRouter::dropOldestUnsent(Sink& sink) {
+    // A partly sent frame at the head stays, the stream must not be torn
+    uint16_t position = (sink.offset > 0) ? 1 : 0;
+    if (sink.count <= position) {
+        return false;
+    }
+
+    release(sink.ring[ringIndex(sink.head, position, sink.depth)]);
+    if (position == 0) {
+        sink.head = ringIndex(sink.head, 1, sink.depth);
+    } else {
+        // Close the gap behind the head
+        for (uint16_t p = position; p + 1 < sink.count; p++) {
+            sink.ring[ringIndex(sink.head, p, sink.depth)] = sink.ring[ringIndex(sink.head, p + 1, sink.depth)];
+        }
+    }
+    sink.count--;
+    sink.stats.pending = sink.count;
+    sink.stats.dropped++;
+    return true;
+}
+
+int OutputRouter::allocateSlot() {
+    // Round robin search keeps recently released slots cold a little longer
+    size_t index = nextFree;
+    for (size_t n = 0; n < slotCount; n++) {
+        if (slots[index].refs == 0) {
+            nextFree = (index + 1 < slotCount) ? index + 1 : 0;
+            return (int)index;
+        }
+        index = (index + 1 < slotCount) ? index + 1 : 0;
+    }
+    return -1;
+}
+
+size_t OutputRouter::route(const uint8_t* frame, size_t length) {
+    if (storage == NULL || frame == NULL || length == 0 || length > slotSize) {
+        return 0;
+    }
+
+    // Full queues make room by dropping their oldest unsent frame
+    size_t receivers = 0;
+    for (size_t i = 0; i < maxSinks; i++) {
+        Sink& sink = sinks[i];
+        if (!sink.active) {
+            continue;
+        }
+        if (sink.count >= sink.depth) {
+            dropOldestUnsent(sink);
+        }
+        if (sink.count < sink.depth) {
+            receivers++;
+        } else {
+            // Only a partly sent frame in a queue of one: this frame is dropped
+            sink.stats.dropped++;
+        }
+    }
+    if (receivers == 0) {
+        return 0;
+    }
+
+    int slot = allocateSlot();
+    while (slot < 0) {
+        // Pool exhausted: the sink with the largest backlog drops its oldest unsent frame
+        Sink* largest = NULL;
+        for (size_t i = 0; i < maxSinks; i++) {
+            Sink& sink = sinks[i];
+            if (sink.active && sink.count > ((sink.offset > 0) ? 1 : 0) &&
+                (largest == NULL || sink.count > largest->count)) {
+                largest = &sink;
+            }
+        }
+        if (largest == NULL) {
+            for (size_t i = 0; i < maxSinks; i++) {
+                if (sinks[i].active && sinks[i].count < sinks[i].depth) {
+                    sinks[i].stats.dropped++;
+                }
+            }
+            return 0;
+        }
+        dropOldestUnsent(*largest);
+        slot = allocateSlot();
+    }
+
+    memcpy(storage + (size_t)slot * slotSize, frame, length);
+    slots[slot].length = (uint16_t)length;
+    slots[slot].refs = 0;
+
+    for (size_t i = 0; i < maxSinks; i++) {
+        Sink& sink = sinks[i];
+        if (!sink.active || sink.count >= sink.depth) {
+            continue;
+        }
+        sink.ring[ringIndex(sink.head, sink.count, sink.depth)] = (uint16_t)slot;
+        sink.count++;
+        slots[slot].refs++;
+        sink.stats.pending = sink.count;
+        if (sink.count > sink.stats.maxPending) {
+            sink.stats.maxPending = sink.count;
+        }
+    }
+
+    routedFrames++;
+    routedBytes += length;
+    return receivers;
+}
+
+bool OutputRouter::peek(int id, const uint8_t** data, size_t* length) const {
+    if (!validId(id) || data == NULL || length == NULL) {
+        return false;
+    }
+    const Sink& sink = sinks[id];
+    if (sink.count == 0) {
+        return false;
+    }
+    uint16_t slot = sink.ring[sink.head];
+    *data = storage + (size_t)slot * slotSize + sink.offset;
+    *length = slots[slot].length - sink.offset;
+    return true;
+}
+
+void OutputRouter::consume(int id, size_t bytes) {
+    if (!validId(id)) {
+        return;
+    }
+    Sink& sink = sinks[id];
+    while (bytes > 0 && sink.count > 0) {
+        uint16_t slot = sink.ring[sink.head];
+        size_t remaining = slots[slot].length - sink.offset;
+        if (bytes < remaining) {
+            sink.offset = (uint16_t)(sink.offset + bytes);
+            sink.stats.bytes += bytes;
+            return;
+        }
+        bytes -= remaining;
+        sink.stats.bytes += remaining;
+        sink.stats.frames++;
+        release(slot);
+        sink.head = ringIndex(sink.head, 1, sink.depth);
+        sink.count--;
+        sink.offset = 0;
+        sink.stats.pending = sink.count;
+    }
+}
+
+size_t OutputRouter::pendingFrames(int id) const {
+    return validId(id) ? sinks[id].count : 0;
+}
+
+size_t OutputRouter::pendingBytes(int id) const {
+    if (!validId(id)) {
+        return 0;
+    }
+    const Sink& sink = sinks[id];
+    size_t bytes = 0;
+    for (uint16_t p = 0; p < sink.count; p++) {
+        bytes += slots[sink.ring[ringIndex(sink.head, p, sink.depth)]].length;
+    }
+    return bytes - sink.offset;
+}
+
+bool OutputRouter::getSinkStats(int id, OutputSinkStats* stats) const {
+    if (!validId(id) || stats == NULL) {
+        return false;
+    }
+    *stats = sinks[id].stats;
+    return true;
+}
+
+size_t OutputRouter::getSinkCount() const {
+    size_t count = 0;
+    for (size_t i = 0; i < maxSinks; i++) {
+        if (sinks[i].active) {
+            count++;
+        }
+    }
+    return count;
+}
+
+size_t OutputRouter::getFramesInUse() const {
+    size_t count = 0;
+    for (size_t i = 0; i < slotCount; i++) {
+        if (slots[i].refs > 0) {
+            count++;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,59 @@
+/*!
+ * \file P2Quantile.h
+ * \brief Streaming estimate of one quantile with the P² algorithm.
+ *
+ * The P² algorithm (Jain and Chlamtac, 1985) follows a single quantile of a
+ * stream with five markers: the minimum, the quantile, the maximum and two
+ * points halfway. Every sample moves the marker positions; a marker that is
+ * off its desired position by one or more is adjusted with a parabolic (or
+ * linear) fit through its neighbours. Memory and time per sample are
+ * constant, without buckets or a range to choose.
+ *
+ * Use it where a single percentile of an unbounded metric is needed, e.g. the
+ * p99 latency of the Data Output Task. The estimate cannot be merged with
+ * another one; use LogHistogram for statistics that are combined over scopes.
+ * The first five samples are kept exactly.
+ */
+
+#ifndef P2_QUANTILE_H
+#define P2_QUANTILE_H
+
+#include <cstdint>
+
+#define P2_QUANTILE_MARKERS 5
+
+class P2Quantile {
+public:
+    /**
+     * \brief Create an estimator.
+     * \param[in] quantile Quantile to follow, between 0.0 and 1.0 (limited to that range).
+     */
+    explicit P2Quantile(float quantile);
+
+    /** \brief Remove all samples. */
+    void reset();
+
+    /** \brief Add a sample. */
+    void add(float value);
+
+    /** \brief Estimated quantile; with five samples or fewer the exact one, 0 without samples. */
+    float get() const;
+
+    /** \brief Number of samples. */
+    uint32_t getCount() const { return count; }
+
+    /** \brief Quantile followed. */
+    float getQuantile() const { return p; }
+
+private:
+    float parabolic(int i, int d) const;
+    float linear(int i, int d) const;
+
+    float p;
+    uint32_t count;
+    float heights[P2_QUANTILE_MARKERS];     // Marker values
+    int32_t positions[P2_QUANTILE_MARKERS]; // Actual marker positions (1 based)
+    float increments[P2_QUANTILE_MARKERS];  // Desired position per sample, relative to the count
+};
+
+#endif // P2_QUANTILE_H
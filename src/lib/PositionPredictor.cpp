@@ -0,0 +1,237 @@
+#include <cstdint>
+#include <stddef.h>
+#include <math.h>
+
+#include "PositionPredictor.h"
+
+// Meters per degree of latitude on a sphere with the mean earth radius (6371 km)
+#define METERS_PER_DEGREE 111194.93f
+#define DEG_TO_RAD 0.017453292519943295
+#define MS_PER_DAY 86400000UL
+#define US_PER_DAY 86400000000LL
+
+// Heading difference a - b in -180..180 degrees
+static float headingDifference(float a, float b) {
+    float difference = fmodf(a - b, 360.0f);
+    if (difference > 180.0f) {
+        difference -= 360.0f;
+    } else if (difference < -180.0f) {
+        difference += 360.0f;
+    }
+    return difference;
+}
+
+static float normalizeHeading(float heading) {
+    heading = fmodf(heading, 360.0f);
+    return (heading < 0.0f) ? heading + 360.0f : heading;
+}
+
+// Milliseconds from b to a, across midnight
+static uint32_t timeDifference(uint32_t a, uint32_t b) {
+    return (a + MS_PER_DAY - b) % MS_PER_DAY;
+}
+
+PositionPredictor::PositionPredictor()
+    : model(PREDICTOR_CTRV),
+      maxHorizonMs(500),
+      receiverDelayMs(0) {
+    reset();
+}
+
+void PositionPredictor::configure(PredictorModel predictorModel, uint32_t maxHorizon, uint32_t receiverDelay) {
+    model = predictorModel;
+    maxHorizonMs = maxHorizon;
+    receiverDelayMs = receiverDelay;
+}
+
+void PositionPredictor::reset() {
+    head = 0;
+    count = 0;
+    offsetHead = 0;
+    offsetCount = 0;
+    clockOffsetUs = 0;
+    turnRate = 0.0f;
+}
+
+const PositionPredictor::Epoch& PositionPredictor::epochAt(uint8_t age) const {
+    return epochs[(head + PREDICTOR_TURN_EPOCHS - 1 - age) % PREDICTOR_TURN_EPOCHS];
+}
+
+void PositionPredictor::addEpoch(uint32_t timeOfDayMs, int64_t receivedUs, double latitude,
+                                 double longitude, float altitude, float speedKmh, float headingDeg) {
+    timeOfDayMs %= MS_PER_DAY;
+
+    if (count > 0) {
+        uint32_t lastTime = epochAt(0).timeOfDayMs;
+        if (timeOfDayMs == lastTime) {
+            return;
+        }
+        if (timeOfDayMs < lastTime) {
+            if (lastTime - timeOfDayMs > MS_PER_DAY / 2) {
+                // Midnight: keep the clock offsets on the new day
+                for (uint8_t i = 0; i < PREDICTOR_CLOCK_EPOCHS; i++) {
+                    offsets[i] += US_PER_DAY;
+                }
+                clockOffsetUs += US_PER_DAY;
+            } else {
+                reset();
+            }
+        }
+    }
+
+    Epoch& epoch = epochs[head];
+    epoch.timeOfDayMs = timeOfDayMs;
+    epoch.latitude = latitude;
+    epoch.longitude = longitude;
+    epoch.altitude = altitude;
+    epoch.speed = speedKmh / 3.6f;
+    epoch.heading = normalizeHeading(headingDeg);
+
+    if (speedKmh < 0.0f) {
+        // No VTG: speed and heading from the displacement since the last epoch
+        epoch.speed = 0.0f;
+        epoch.heading = 0.0f;
+        if (count > 0) {
+            const Epoch& previous = epochAt(0);
+            uint32_t gap = timeDifference(timeOfDayMs, previous.timeOfDayMs);
+            if (gap <= PREDICTOR_MAX_GAP_MS) {
+                double lonDifference = longitude - previous.longitude;
+                if (lonDifference > 180.0) {
+                    lonDifference -= 360.0;
+                } else if (lonDifference < -180.0) {
+                    lonDifference += 360.0;
+                }
+                float north = (float)(latitude - previous.latitude) * METERS_PER_DEGREE;
+                float east = (float)lonDifference * METERS_PER_DEGREE * (float)cos(latitude * DEG_TO_RAD);
+                epoch.speed = sqrtf(north * north + east * east) * 1000.0f / (float)gap;
+                epoch.heading = normalizeHeading(atan2f(east, north) / (float)DEG_TO_RAD);
+            }
+        }
+    }
+
+    head = (head + 1) % PREDICTOR_TURN_EPOCHS;
+    if (count < PREDICTOR_TURN_EPOCHS) {
+        count++;
+    }
+
+    // The epoch that arrived with the least delay
+    offsets[offsetHead] = receivedUs - (int64_t)timeOfDayMs * 1000;
+    int64_t fastest = offsets[offsetHead];
+    offsetHead = (offsetHead + 1) % PREDICTOR_CLOCK_EPOCHS;
+    if (offsetCount < PREDICTOR_CLOCK_EPOCHS) {
+        offsetCount++;
+    }
+    for (uint8_t i = 0; i < offsetCount; i++) {
+        if (offsets[i] < fastest) {
+            fastest = offsets[i];
+        }
+    }
+    clockOffsetUs = fastest - (int64_t)receiverDelayMs * 1000;
+
+    // Turn rate over the last epochs, all moving and without gaps
+    turnRate = 0.0f;
+    if (count < 2) {
+        return;
+    }
+    const float minSpeed = PREDICTOR_MIN_SPEED_KMH / 3.6f;
+    float turned = 0.0f;
+    for (uint8_t age = 0; age + 1 < count; age++) {
+        const Epoch& newer = epochAt(age);
+        const Epoch& older = epochAt(age + 1);
+        if (newer.speed < minSpeed || older.speed < minSpeed ||
+            timeDifference(newer.timeOfDayMs, older.timeOfDayMs) > PREDICTOR_MAX_GAP_MS) {
+            return;
+        }
+        turned += headingDifference(newer.heading, older.heading);
+    }
+    uint32_t elapsed = timeDifference(epochAt(0).timeOfDayMs, epochAt(count - 1).timeOfDayMs);
+    turnRate = turned * 1000.0f / (float)elapsed;
+    if (turnRate > PREDICTOR_MAX_TURN_RATE) {
+        turnRate = PREDICTOR_MAX_TURN_RATE;
+    } else if (turnRate < -PREDICTOR_MAX_TURN_RATE) {
+        turnRate = -PREDICTOR_MAX_TURN_RATE;
+    }
+}
+
+uint32_t PositionPredictor::timeOfDayAt(int64_t localUs) const {
+    int64_t ms = localUs - clockOffsetUs;
+    ms = (ms >= 0) ? ms / 1000 : -((-ms + 999) / 1000);
+    ms %= (int64_t)MS_PER_DAY;
+    return (uint32_t)((ms < 0) ? ms + (int64_t)MS_PER_DAY : ms);
+}
+
+int64_t PositionPredictor::localTimeOf(uint32_t timeOfDayMs) const {
+    int64_t localUs = clockOffsetUs + (int64_t)(timeOfDayMs % MS_PER_DAY) * 1000;
+    if (count == 0) {
+        return localUs;
+    }
+    uint32_t lastTime = epochAt(0).timeOfDayMs;
+    if (timeOfDayMs + MS_PER_DAY / 2 < lastTime) {
+        localUs += US_PER_DAY;
+    } else if (timeOfDayMs > lastTime + MS_PER_DAY / 2) {
+        localUs -= US_PER_DAY;
+    }
+    return localUs;
+}
+
+bool PositionPredictor::predict(int64_t localUs, PredictedPosition* position) const {
+    if (count == 0 || position == NULL) {
+        return false;
+    }
+    const Epoch& epoch = epochAt(0);
+
+    // Horizon: from the epoch to the requested time, within the limits
+    int64_t horizonUs = localUs - (clockOffsetUs + (int64_t)epoch.timeOfDayMs * 1000);
+    if (horizonUs < 0) {
+        horizonUs = 0;
+    }
+    if (horizonUs > (int64_t)maxHorizonMs * 1000) {
+        horizonUs = (int64_t)maxHorizonMs * 1000;
+    }
+    if (epoch.timeOfDayMs + (uint32_t)(horizonUs / 1000) >= MS_PER_DAY) {
+        horizonUs = (int64_t)(MS_PER_DAY - 1 - epoch.timeOfDayMs) * 1000;
+    }
+
+    position->latitude = epoch.latitude;
+    position->longitude = epoch.longitude;
+    position->altitude = epoch.altitude;
+    position->heading = epoch.heading;
+    position->speed = epoch.speed * 3.6f;
+    position->horizonMs = (uint32_t)(horizonUs / 1000);
+    position->timeOfDayMs = epoch.timeOfDayMs + position->horizonMs;
+    position->extrapolated = false;
+
+    if (horizonUs == 0 || epoch.speed < PREDICTOR_MIN_SPEED_KMH / 3.6f) {
+        return true;
+    }
+
+    float t = (float)horizonUs * 1e-6f;
+    float heading = (float)(epoch.heading * DEG_TO_RAD);
+    float omega = (model == PREDICTOR_CTRV) ? (float)(turnRate * DEG_TO_RAD) : 0.0f;
+    float north;
+    float east;
+    if (fabsf(omega) < 1e-3f) {
+        north = epoch.speed * t * cosf(heading);
+        east = epoch.speed * t * sinf(heading);
+    } else {
+        // Arc with radius speed / omega
+        float radius = epoch.speed / omega;
+        north = radius * (sinf(heading + omega * t) - sinf(heading));
+        east = radius * (cosf(heading) - cosf(heading + omega * t));
+        position->heading = normalizeHeading(epoch.heading + turnRate * t);
+    }
+
+    position->latitude = epoch.latitude + (double)(north / METERS_PER_DEGREE);
+    float cosLatitude = (float)cos(epoch.latitude * DEG_TO_RAD);
+    if (cosLatitude > 1e-6f) {
+        double longitude = epoch.longitude + (double)(east / (METERS_PER_DEGREE * cosLatitude));
+        if (longitude > 180.0) {
+            longitude -= 360.0;
+        } else if (longitude < -180.0) {
+            longitude += 360.0;
+        }
+        position->longitude = longitude;
+    }
+    position->extrapolated = true;
+    return true;
+}
@@ -0,0 +1,155 @@
+/*!
+ * \file PositionPredictor.h
+ * \brief Extrapolates the last GNSS position to the time a telemetry frame is sent.
+ *
+ * Used by the Data Output Task. A position is valid at the GNSS time of its
+ * epoch but reaches the UART 50-150 ms later; at 100 km/h that is 1.4 to 4 m.
+ * The predictor moves the position forward to the send time with the speed
+ * and heading of the VTG and the turn rate of the recent epochs:
+ * - constant velocity (CV): straight line along the heading;
+ * - constant turn rate and velocity (CTRV): circular arc with the turn rate
+ *   from the heading change over the last epochs.
+ *
+ * Positions can be predicted for any time, so frames can also be sent at a
+ * higher rate than the GNSS rate (50 Hz from a 10 Hz receiver).
+ *
+ * \section predictor_clock GNSS time
+ * Every epoch gives a pair of GNSS time of day and local receive time. The
+ * smallest difference over the last PREDICTOR_CLOCK_EPOCHS epochs maps local time
+ * to GNSS time: the epoch that arrived with the least delay. Delays on top of
+ * that (more sentences before the GGA, a busy UART) are then compensated as
+ * well. The receive times cannot show the delay every epoch has (the receiver
+ * computing the fix, sending the GGA); it is given to configure().
+ *
+ * \section predictor_limits Limits
+ * - Below PREDICTOR_MIN_SPEED_KMH the heading is noise; the position is not moved.
+ * - The prediction stops at the maximum horizon, so a receiver that stops
+ *   sending does not make the position run away.
+ * - A prediction does not cross midnight (UTC), so the date of the epoch stays valid.
+ * - The altitude is not extrapolated.
+ *
+ * Offsets are computed in float meters around the epoch position
+ * (equirectangular, like lib/GGAScheduler); only the final latitude and
+ * longitude are double.
+ */
+
+#ifndef POSITION_PREDICTOR_H
+#define POSITION_PREDICTOR_H
+
+#include <cstdint>
+#include <stddef.h>
+
+#define PREDICTOR_CLOCK_EPOCHS 32       // Receive times for the GNSS time (3.2 s at 10 Hz)
+#define PREDICTOR_TURN_EPOCHS 3         // Heading change over the last 3 epochs (2 intervals)
+#define PREDICTOR_MIN_SPEED_KMH 1.0f
+#define PREDICTOR_MAX_TURN_RATE 60.0f   // Degrees per second
+#define PREDICTOR_MAX_GAP_MS 2000       // Epochs further apart are not used for speed or turn rate
+
+/**
+ * \brief Motion model.
+ */
+enum PredictorModel {
+    PREDICTOR_CV = 0,       /**< Constant velocity */
+    PREDICTOR_CTRV = 1      /**< Constant turn rate and velocity */
+};
+
+/**
+ * \brief A predicted position.
+ */
+struct PredictedPosition {
+    double latitude;        /**< Degrees */
+    double longitude;       /**< Degrees */
+    float altitude;         /**< Meters (of the epoch) */
+    float heading;          /**< Degrees (0-359.99) */
+    float speed;            /**< km/h */
+    uint32_t timeOfDayMs;   /**< UTC time of day of the position */
+    uint32_t horizonMs;     /**< Time since the epoch the position was predicted from */
+    bool extrapolated;      /**< false if the position of the epoch was kept (stationary) */
+};
+
+class PositionPredictor {
+public:
+    PositionPredictor();
+
+    /**
+     * \brief Set the model, the longest prediction and the receiver delay.
+     * \param[in] model Motion model.
+     * \param[in] maxHorizonMs Predictions stop this long after the epoch.
+     * \param[in] receiverDelayMs Shortest delay from the epoch to the GGA being received.
+     */
+    void configure(PredictorModel model, uint32_t maxHorizonMs, uint32_t receiverDelayMs);
+
+    /** \brief Forget all epochs, e.g. after the fix was lost. */
+    void reset();
+
+    /**
+     * \brief Add a GNSS epoch with a valid position.
+     * \param[in] timeOfDayMs UTC time of day of the epoch in milliseconds.
+     * \param[in] receivedUs Local time the epoch was received in microseconds.
+     * \param[in] latitude Degrees.
+     * \param[in] longitude Degrees.
+     * \param[in] altitude Meters.
+     * \param[in] speedKmh Ground speed in km/h (VTG); negative without a VTG:
+     *            speed and heading are then taken from the last two positions.
+     * \param[in] headingDeg Course over ground in degrees (VTG).
+     *
+     * An epoch with the same time as the previous one is ignored; an epoch
+     * earlier than the previous one (other than across midnight) starts over.
+     */
+    void addEpoch(uint32_t timeOfDayMs, int64_t receivedUs, double latitude, double longitude,
+                  float altitude, float speedKmh, float headingDeg);
+
+    /** \brief An epoch was added since the last reset(). */
+    bool hasEpoch() const { return count > 0; }
+
+    /** \brief UTC time of day in milliseconds at a local time. */
+    uint32_t timeOfDayAt(int64_t localUs) const;
+
+    /**
+     * \brief Local time of a UTC time of day, the one nearest to the last epoch.
+     * \param[in] timeOfDayMs UTC time of day in milliseconds.
+     * \return Local time in microseconds.
+     */
+    int64_t localTimeOf(uint32_t timeOfDayMs) const;
+
+    /**
+     * \brief Predict the position at a local time.
+     * \param[in] localUs Local time in microseconds (e.g. the send time of a frame).
+     * \param[out] position Predicted position.
+     * \return false without an epoch.
+     */
+    bool predict(int64_t localUs, PredictedPosition* position) const;
+
+    /** \brief Turn rate in degrees per second of the last epochs (clockwise positive). */
+    float getTurnRate() const { return turnRate; }
+
+    /** \brief Local minus GNSS time in microseconds (fastest recent epoch, less the receiver delay). */
+    int64_t getClockOffsetUs() const { return clockOffsetUs; }
+
+private:
+    struct Epoch {
+        uint32_t timeOfDayMs;
+        double latitude;
+        double longitude;
+        float altitude;
+        float speed;        // m/s
+        float heading;      // degrees
+    };
+
+    const Epoch& epochAt(uint8_t age) const;
+
+    PredictorModel model;
+    uint32_t maxHorizonMs;
+    uint32_t receiverDelayMs;
+
+    Epoch epochs[PREDICTOR_TURN_EPOCHS];
+    uint8_t head;
+    uint8_t count;
+    int64_t offsets[PREDICTOR_CLOCK_EPOCHS];
+    uint8_t offsetHead;
+    uint8_t offsetCount;
+    int64_t clockOffsetUs;
+    float turnRate;
+};
+
+#endif // POSITION_PREDICTOR_H
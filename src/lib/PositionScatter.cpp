@@ -0,0 +1,144 @@
+#include <cstdint>
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "PositionScatter.h"
+
+// Meters per degree of latitude on a sphere with the mean earth radius (6371 km)
+#define METERS_PER_DEGREE 111194.93
+#define DEG_TO_RAD 0.017453292519943295
+
+PositionScatter::PositionScatter() {
+    clear();
+}
+
+void PositionScatter::reset() {
+    count = 0;
+    memset(mean, 0, sizeof(mean));
+    memset(m2, 0, sizeof(m2));
+    radial.reset();
+}
+
+void PositionScatter::clear() {
+    referenceValid = false;
+    referenceLatitude = 0.0;
+    referenceLongitude = 0.0;
+    referenceAltitude = 0.0f;
+    referenceCosLatitude = 1.0f;
+    reset();
+}
+
+void PositionScatter::toLocal(double latitude, double longitude, float altitude, double* offsets) const {
+    // Shortest way around the antimeridian
+    double lonDifference = longitude - referenceLongitude;
+    if (lonDifference > 180.0) {
+        lonDifference -= 360.0;
+    } else if (lonDifference < -180.0) {
+        lonDifference += 360.0;
+    }
+    offsets[SCATTER_EAST] = lonDifference * METERS_PER_DEGREE * referenceCosLatitude;
+    offsets[SCATTER_NORTH] = (latitude - referenceLatitude) * METERS_PER_DEGREE;
+    offsets[SCATTER_UP] = (double)altitude - referenceAltitude;
+}
+
+void PositionScatter::add(double latitude, double longitude, float altitude) {
+    if (!referenceValid) {
+        referenceValid = true;
+        referenceLatitude = latitude;
+        referenceLongitude = longitude;
+        referenceAltitude = altitude;
+        referenceCosLatitude = (float)cos(latitude * DEG_TO_RAD);
+    }
+    double offsets[SCATTER_AXIS_COUNT];
+    toLocal(latitude, longitude, altitude, offsets);
+
+    // Horizontal distance to the mean of the earlier samples, scaled to the
+    // spread of the distance to the true mean
+    if (count > 0) {
+        double east = offsets[SCATTER_EAST] - mean[SCATTER_EAST];
+        double north = offsets[SCATTER_NORTH] - mean[SCATTER_NORTH];
+        double distance = sqrt((east * east + north * north) * count / (count + 1));
+        double units = distance * POSITION_SCATTER_UNITS_PER_METER + 0.5;
+        radial.record(units < (double)UINT32_MAX ? (uint32_t)units : UINT32_MAX);
+    }
+
+    // Welford update of the means and squared differences
+    count++;
+    for (int i = 0; i < SCATTER_AXIS_COUNT; i++) {
+        double delta = offsets[i] - mean[i];
+        mean[i] += delta / count;
+        m2[i] += delta * (offsets[i] - mean[i]);
+    }
+}
+
+bool PositionScatter::getMeanPosition(double* latitude, double* longitude, float* altitude) const {
+    double lat = referenceLatitude;
+    double lon = referenceLongitude;
+    float alt = referenceAltitude;
+    if (count > 0) {
+        lat += mean[SCATTER_NORTH] / METERS_PER_DEGREE;
+        if (referenceCosLatitude > 1e-6f) {
+            lon += mean[SCATTER_EAST] / (METERS_PER_DEGREE * referenceCosLatitude);
+        }
+        if (lon > 180.0) {
+            lon -= 360.0;
+        } else if (lon < -180.0) {
+            lon += 360.0;
+        }
+        alt += (float)mean[SCATTER_UP];
+    }
+    if (latitude != NULL) {
+        *latitude = lat;
+    }
+    if (longitude != NULL) {
+        *longitude = lon;
+    }
+    if (altitude != NULL) {
+        *altitude = alt;
+    }
+    return count > 0;
+}
+
+void PositionScatter::recenter() {
+    if (count == 0) {
+        return;
+    }
+    double latitude;
+    double longitude;
+    float altitude;
+    getMeanPosition(&latitude, &longitude, &altitude);
+    referenceLatitude = latitude;
+    referenceLongitude = longitude;
+    referenceAltitude = altitude;
+    referenceCosLatitude = (float)cos(latitude * DEG_TO_RAD);
+    reset();
+}
+
+float PositionScatter::getMeanOffset(ScatterAxis axis) const {
+    if (axis < 0 || axis >= SCATTER_AXIS_COUNT || count == 0) {
+        return 0.0f;
+    }
+    return (float)mean[axis];
+}
+
+float PositionScatter::getStdDev(ScatterAxis axis) const {
+    if (axis < 0 || axis >= SCATTER_AXIS_COUNT || count < 2) {
+        return 0.0f;
+    }
+    return (float)sqrt(m2[axis] / count);
+}
+
+float PositionScatter::getDrms2() const {
+    if (count < 2) {
+        return 0.0f;
+    }
+    return (float)(2.0 * sqrt((m2[SCATTER_EAST] + m2[SCATTER_NORTH]) / count));
+}
+
+float PositionScatter::getCep(float probability) const {
+    if (count < 2) {
+        return 0.0f;
+    }
+    return (float)radial.quantile(probability) / POSITION_SCATTER_UNITS_PER_METER;
+}
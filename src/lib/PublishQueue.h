@@ -0,0 +1,180 @@
+/*!
+ * \file PublishQueue.h
+ * \brief QoS 1 publish pipeline: bounded in-flight window over a RAM queue.
+ *
+ * Used by the MQTT Client Task for topics published with QoS 1. The MQTT
+ * client keeps every QoS 1 message in its own outbox until the broker sends
+ * the PUBACK; handing it all messages would let that outbox grow without
+ * bound while the broker is slow. Messages are therefore queued here and
+ * handed to the client only while fewer than the window size are waiting
+ * for their PUBACK.
+ *
+ * \section queue_memory Memory ceiling
+ * The queue is a ring of records in a buffer supplied by the caller; its size
+ * is the memory ceiling. A record is the topic (NUL terminated) and the
+ * payload, 4 byte aligned. A message that does not fit pushes out the oldest
+ * queued messages (drop-oldest), so the newest data is always kept.
+ *
+ * \section queue_latency PUBACK latency
+ * The time from handing a message to the client to its PUBACK is kept in a
+ * histogram with fixed bucket bounds (5 ms to 5 s and an overflow bucket).
+ * Messages that never get a PUBACK are released by the client (deleted from
+ * its outbox) or expire after a timeout, so they cannot block the window.
+ *
+ * The queue is not thread safe: the MQTT event handler passes PUBACKs to the
+ * MQTT task, which owns the queue.
+ */
+
+#ifndef PUBLISH_QUEUE_H
+#define PUBLISH_QUEUE_H
+
+#include <cstdint>
+#include <stddef.h>
+
+#define PUBLISH_WINDOW_MAX 16
+#define PUBLISH_LATENCY_BUCKETS 11
+
+class PublishQueue {
+public:
+    PublishQueue();
+
+    /**
+     * \brief Use a buffer for the queue and drop all queued and in-flight messages.
+     * \param[in] buffer Queue memory (NULL disables the queue).
+     * \param[in] size Buffer size in bytes: the memory ceiling.
+     * \param[in] window Messages waiting for their PUBACK at most (1 to PUBLISH_WINDOW_MAX).
+     */
+    void begin(uint8_t* buffer, size_t size, uint8_t window);
+
+    /** \brief Change the window; messages already in flight stay in flight. */
+    void setWindow(uint8_t window);
+
+    /**
+     * \brief Queue a message, dropping the oldest queued messages if needed.
+     * \param[in] topic NUL terminated topic.
+     * \param[in] data Payload.
+     * \param[in] length Payload length.
+     * \return false if the message is larger than the whole queue.
+     */
+    bool push(const char* topic, const uint8_t* data, size_t length);
+
+    /**
+     * \brief Whether push() would keep every queued message.
+     * \param[in] topicLength Topic length without the NUL.
+     * \param[in] length Payload length.
+     */
+    bool fits(size_t topicLength, size_t length) const;
+
+    /** \brief A message is queued and the window has room for it. */
+    bool canSend() const { return queued > 0 && inFlight < window; }
+
+    /**
+     * \brief The oldest queued message; valid until the next push() or sent().
+     * \return false if the queue is empty.
+     */
+    bool front(const char** topic, const uint8_t** data, size_t* length) const;
+
+    /**
+     * \brief Move the front message into the window after the client accepted it.
+     * \param[in] msgId Message id returned by the client.
+     * \param[in] nowUs Time of the publish call in microseconds.
+     */
+    void sent(int msgId, int64_t nowUs);
+
+    /**
+     * \brief Handle a PUBACK.
+     * \param[in] msgId Acknowledged message id.
+     * \param[in] nowUs Time the PUBACK was received in microseconds.
+     * \return false if the message was not in flight.
+     */
+    bool acked(int msgId, int64_t nowUs);
+
+    /**
+     * \brief Free the window slot of a message the client deleted without PUBACK.
+     * \return false if the message was not in flight.
+     */
+    bool released(int msgId);
+
+    /**
+     * \brief Free the window slots of messages without PUBACK for longer than timeoutUs.
+     * \return Number of messages expired.
+     */
+    uint32_t expire(int64_t nowUs, int64_t timeoutUs);
+
+    /**
+     * \brief Free the whole window after the client was destroyed; queued messages stay.
+     * \return Number of messages released.
+     */
+    uint32_t releaseAll();
+
+    uint32_t getQueued() const { return queued; }
+
+    /** \brief Queue memory in use (records including topic and alignment). */
+    uint32_t getQueuedBytes() const { return used; }
+    uint32_t getQueuedPeakBytes() const { return usedPeak; }
+    uint32_t getCapacity() const { return capacity; }
+
+    uint8_t getWindow() const { return window; }
+    uint8_t getInFlight() const { return inFlight; }
+    uint8_t getInFlightPeak() const { return inFlightPeak; }
+
+    uint32_t getSent() const { return sentCount; }
+    uint32_t getAcked() const { return ackedCount; }
+
+    /** \brief Queued messages pushed out by newer ones. */
+    uint32_t getDropped() const { return dropped; }
+
+    /** \brief Messages larger than the whole queue. */
+    uint32_t getRejected() const { return rejected; }
+
+    /** \brief In-flight messages released by the client or expired. */
+    uint32_t getLost() const { return lost; }
+
+    /** \brief Upper bound of a latency bucket in ms; 0 for the overflow bucket. */
+    static uint32_t latencyBound(uint8_t bucket);
+    uint32_t getLatencyCount(uint8_t bucket) const;
+
+    uint32_t getLatencyMinMs() const { return ackedCount ? (latencyMinUs + 500) / 1000 : 0; }
+    uint32_t getLatencyMaxMs() const { return (latencyMaxUs + 500) / 1000; }
+    uint32_t getLatencyAvgMs() const;
+    uint32_t getLatencyLastMs() const { return (latencyLastUs + 500) / 1000; }
+
+private:
+    struct InFlightMessage {
+        int msgId;
+        int64_t sentUs;
+    };
+
+    int32_t reserve(uint32_t size) const;
+    void popFront();
+    void removeInFlight(uint8_t index);
+
+    uint8_t* buffer;
+    uint32_t capacity;
+    uint32_t head;
+    uint32_t tail;
+    uint32_t end;
+    bool wrapped;
+    uint32_t queued;
+    uint32_t used;
+    uint32_t usedPeak;
+
+    uint8_t window;
+    uint8_t inFlight;
+    uint8_t inFlightPeak;
+    InFlightMessage inFlightMessages[PUBLISH_WINDOW_MAX];
+
+    uint32_t sentCount;
+    uint32_t ackedCount;
+    uint32_t dropped;
+    uint32_t rejected;
+    uint32_t lost;
+
+    uint32_t latencyCounts[PUBLISH_LATENCY_BUCKETS];
+    uint32_t latencyMinUs;
+    uint32_t latencyMaxUs;
+    uint32_t latencyLastUs;
+    uint64_t latencySumUs;
+};
+
+#endif // PUBLISH_QUEUE_H
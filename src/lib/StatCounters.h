@@ -0,0 +1,118 @@
+/*!
+ * \file StatCounters.h
+ * \brief Lock-free statistics counters with one shard per producer task.
+ *
+ * Used by the Statistics Task for the counters that the NTRIP and GNSS tasks
+ * update on every read or epoch. Every producer owns a shard of 64 bit
+ * counters and is its only writer, so an update is a few plain stores and
+ * never waits for another task. Readers sum the shards.
+ *
+ * \section counters_shards Why per producer, not per core
+ * FreeRTOS tasks move between the cores of the ESP32 and can be preempted
+ * halfway through an update by another task on the same core. A shard per
+ * core would then have two writers. A shard per producer task keeps one
+ * writer per shard wherever the task runs. Two tasks must never use the same
+ * producer ID.
+ *
+ * \section counters_snapshot Consistent snapshots
+ * Each shard has a sequence number that is odd while an update is in
+ * progress (a sequence lock). Counters changed between beginUpdate() and
+ * endUpdate() are seen by a reader all together or not at all, e.g. bytes
+ * and messages of one read, and a 64 bit counter is never seen half updated
+ * on the 32 bit ESP32. A reader that meets an update retries; it gives up
+ * after a given number of attempts, because a writer preempted by the reader
+ * on the same core cannot finish until the reader yields. Different shards
+ * are read one after the other; they count independent events.
+ */
+
+#ifndef STAT_COUNTERS_H
+#define STAT_COUNTERS_H
+
+#include <atomic>
+#include <cstdint>
+#include <stddef.h>
+
+#define STAT_COUNTERS_MAX_PRODUCERS 4
+#define STAT_COUNTERS_MAX_COUNTERS 32
+#define STAT_COUNTERS_ALIGN 64          // Shards on separate cache lines (host CPUs)
+
+class StatCounters {
+public:
+    /**
+     * \brief Create zeroed counters.
+     * \param[in] producers Number of producer shards (1 to STAT_COUNTERS_MAX_PRODUCERS).
+     * \param[in] counters Counters per shard (1 to STAT_COUNTERS_MAX_COUNTERS).
+     *
+     * Invalid sizes give an object without shards; all calls are then ignored.
+     */
+    StatCounters(size_t producers, size_t counters);
+
+    /**
+     * \brief Start an update of a producer's shard. Only the producer's own task may call this.
+     * \param[in] producer Producer ID.
+     */
+    void beginUpdate(int producer);
+
+    /**
+     * \brief Add to a counter; between beginUpdate() and endUpdate().
+     * \param[in] producer Producer ID.
+     * \param[in] counter Counter index.
+     * \param[in] delta Value to add (a negative delta wraps, read it back as int64_t).
+     */
+    void add(int producer, size_t counter, uint64_t delta);
+
+    /**
+     * \brief Overwrite a counter, e.g. with a timestamp; between beginUpdate() and endUpdate().
+     * \param[in] producer Producer ID.
+     * \param[in] counter Counter index.
+     * \param[in] value New value.
+     */
+    void set(int producer, size_t counter, uint64_t value);
+
+    /**
+     * \brief Publish the update started with beginUpdate().
+     * \param[in] producer Producer ID.
+     */
+    void endUpdate(int producer);
+
+    /**
+     * \brief Read all counters of one shard consistently.
+     * \param[in] producer Producer ID.
+     * \param[out] values Receives getCounterCount() values.
+     * \param[in] attempts Reads to try while the shard is being updated.
+     * \return false for an unknown producer or when every attempt met an update.
+     */
+    bool read(int producer, uint64_t* values, unsigned attempts) const;
+
+    /**
+     * \brief Sum every counter over all shards.
+     * \param[out] values Receives getCounterCount() sums.
+     * \param[in] attempts Reads to try per shard while it is being updated.
+     * \return false when a shard could not be read; values is then incomplete.
+     */
+    bool sum(uint64_t* values, unsigned attempts) const;
+
+    /** \brief Number of producer shards. */
+    size_t getProducerCount() const { return producerCount; }
+
+    /** \brief Number of counters per shard. */
+    size_t getCounterCount() const { return counterCount; }
+
+private:
+    // A 64 bit counter as two 32 bit words, atomic on every target
+    struct Counter {
+        std::atomic<uint32_t> low;
+        std::atomic<uint32_t> high;
+    };
+
+    struct alignas(STAT_COUNTERS_ALIGN) Shard {
+        std::atomic<uint32_t> sequence;
+        Counter counters[STAT_COUNTERS_MAX_COUNTERS];
+    };
+
+    Shard shards[STAT_COUNTERS_MAX_PRODUCERS];
+    size_t producerCount;
+    size_t counterCount;
+};
+
+#endif // STAT_COUNTERS_H
@@ -0,0 +1,112 @@
+/*!
+ * \file TelemetryRecord.h
+ * \brief Binary payload of the telemetry UART frames.
+ *
+ * The Data Output Task sends one position per frame to the telemetry unit.
+ * The original payload is an ASCII CSV line of 60 to 80 characters formatted
+ * with snprintf(). This payload carries the same position and more (HDOP,
+ * satellites, age of corrections and an epoch counter) in a fixed layout of
+ * TELEMETRY_RECORD_SIZE bytes with integers instead of decimal text. Both
+ * payloads use the same SOH/DLE/CAN framing and CRC-16.
+ *
+ * \section record_layout Layout (version 1)
+ * All multi-byte fields are big-endian, like the CRC-16 of the frame.
+ *
+ * | Offset | Size | Field                                          |
+ * |--------|------|------------------------------------------------|
+ * | 0      | 1    | Version (TELEMETRY_RECORD_VERSION)             |
+ * | 1      | 1    | Flags, bit 0: position valid                   |
+ * | 2      | 4    | Epoch counter (unsigned)                       |
+ * | 6      | 1    | Year (00-99, 2000+)                            |
+ * | 7      | 1    | Month (1-12)                                   |
+ * | 8      | 1    | Day (1-31)                                     |
+ * | 9      | 4    | UTC time of day in ms (unsigned)               |
+ * | 13     | 4    | Latitude in 1e-7 degrees (signed)              |
+ * | 17     | 4    | Longitude in 1e-7 degrees (signed)             |
+ * | 21     | 4    | Altitude in mm (signed)                        |
+ * | 25     | 2    | Heading in 0.01 degrees (unsigned)             |
+ * | 27     | 2    | Speed in 0.01 km/h (unsigned)                  |
+ * | 29     | 1    | Fix quality (GGA)                              |
+ * | 30     | 1    | Satellites used                                |
+ * | 31     | 2    | HDOP in 0.01 (unsigned)                        |
+ * | 33     | 2    | Age of differential data in 0.01 s (unsigned)  |
+ *
+ * \section record_version Versioning
+ * The version byte is always below 0x20, so a receiver tells a binary payload
+ * from a CSV line (which starts with a digit) by its first byte. Fields may
+ * be added at the end without a new version; decoders ignore bytes beyond the
+ * fields they know. A changed meaning or position of a field gets a new
+ * version.
+ */
+
+#ifndef TELEMETRY_RECORD_H
+#define TELEMETRY_RECORD_H
+
+#include <cstdint>
+#include <stddef.h>
+
+#define TELEMETRY_RECORD_VERSION 1
+#define TELEMETRY_RECORD_SIZE 35
+
+/** \brief Flag: the position is a valid GNSS fix. */
+#define TELEMETRY_FLAG_VALID 0x01
+
+/**
+ * \brief One telemetry position in the integer resolution of the binary payload.
+ */
+struct TelemetryRecord {
+    uint8_t version;        /**< Payload version */
+    uint8_t flags;          /**< TELEMETRY_FLAG_* */
+    uint32_t epoch;         /**< Epoch counter; repeats while no new GNSS epoch arrived */
+    uint8_t year;           /**< Year (00-99, 2000+) */
+    uint8_t month;          /**< Month (1-12) */
+    uint8_t day;            /**< Day (1-31) */
+    uint32_t timeOfDayMs;   /**< UTC time of day in milliseconds */
+    int32_t latE7;          /**< Latitude in 1e-7 degrees */
+    int32_t lonE7;          /**< Longitude in 1e-7 degrees */
+    int32_t altMm;          /**< Altitude in millimeters */
+    uint16_t headingX100;   /**< Heading in 0.01 degrees */
+    uint16_t speedX100;     /**< Speed in 0.01 km/h */
+    uint8_t fixQuality;     /**< GGA fix quality */
+    uint8_t sats;           /**< Satellites used */
+    uint16_t hdopX100;      /**< HDOP in 0.01 */
+    uint16_t ageX100;       /**< Age of differential data in 0.01 seconds */
+};
+
+class TelemetryBinary {
+public:
+    /**
+     * \brief Quantize a position to the resolution of the binary payload.
+     * Values out of range are clamped; the time of day is taken modulo one day.
+     */
+    static TelemetryRecord quantize(uint32_t epoch, bool valid,
+                                    uint8_t year, uint8_t month, uint8_t day, uint32_t timeOfDayMs,
+                                    double latitude, double longitude, float altitude,
+                                    float heading, float speed, uint8_t fixQuality,
+                                    uint8_t sats, float hdop, float age);
+
+    /**
+     * \brief Write the binary payload of a record.
+     * \param[in] record Record to encode; its version field is ignored.
+     * \param[out] buffer Output buffer.
+     * \param[in] size Output buffer size.
+     * \return TELEMETRY_RECORD_SIZE, or 0 if the buffer is too small.
+     */
+    static size_t encode(const TelemetryRecord& record, uint8_t* buffer, size_t size);
+
+    /**
+     * \brief Read a binary payload (the unstuffed frame contents without CRC).
+     * \param[in] payload Payload bytes.
+     * \param[in] length Payload length.
+     * \param[out] record Decoded record.
+     * \return false for another version or a payload shorter than version 1.
+     */
+    static bool decode(const uint8_t* payload, size_t length, TelemetryRecord* record);
+
+    /** \brief Whether a payload is binary rather than a CSV line. */
+    static bool isBinary(const uint8_t* payload, size_t length) {
+        return length > 0 && payload[0] < 0x20;
+    }
+};
+
+#endif // TELEMETRY_RECORD_H
@@ -0,0 +1,262 @@
+#include <cstdint>
+#include <stddef.h>
+#include <string.h>
+
+#include "TimeSeriesStore.h"
+
+#define MASK_BYTES(metrics) (((size_t)(metrics) + 7) / 8)
+
+static uint32_t readU32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t readU16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static void writeU32(uint8_t* p, uint32_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+static void writeU16(uint8_t* p, uint16_t value) {
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+// Zigzag: 0, -1, 1, -2, ... become 0, 1, 2, 3, ...
+static uint32_t zigzag(uint32_t difference) {
+    return (difference << 1) ^ (0u - (difference >> 31));
+}
+
+static uint32_t unzigzag(uint32_t value) {
+    return (value >> 1) ^ (0u - (value & 1));
+}
+
+static size_t writeVarint(uint8_t* p, uint32_t value) {
+    size_t length = 0;
+    while (value >= 0x80) {
+        p[length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    p[length++] = (uint8_t)value;
+    return length;
+}
+
+// Read a varint of at most 5 bytes before end; false when it runs past end
+static bool readVarint(const uint8_t** p, const uint8_t* end, uint32_t* value) {
+    uint32_t result = 0;
+    for (int shift = 0; shift < 35 && *p < end; shift += 7) {
+        uint8_t byte = *(*p)++;
+        result |= (uint32_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+TimeSeriesStore::TimeSeriesStore()
+    : memory(NULL), blockSize(0), blockCount(0), metrics(0), interval(0),
+      firstBlock(0), endBlock(0), rows(0), newestTime(0) {
+    memset(previous, 0, sizeof(previous));
+}
+
+bool TimeSeriesStore::init(uint8_t* area, size_t size, size_t block, uint8_t metricCount, uint32_t rowInterval) {
+    memory = NULL;
+    blockCount = 0;
+    if (area == NULL || metricCount == 0 || metricCount > TIMESERIES_MAX_METRICS || rowInterval == 0 ||
+        block < TIMESERIES_BLOCK_HEADER + maxBlockRow(metricCount) || block > 0xFFFF || size / block < 2) {
+        return false;
+    }
+    memory = area;
+    blockSize = block;
+    blockCount = (uint32_t)(size / block);
+    metrics = metricCount;
+    interval = rowInterval;
+    firstBlock = 0;
+    endBlock = 0;
+    clear();
+    return true;
+}
+
+void TimeSeriesStore::clear() {
+    firstBlock = endBlock;
+    rows = 0;
+    newestTime = 0;
+    memset(previous, 0, sizeof(previous));
+}
+
+uint8_t* TimeSeriesStore::blockAt(uint32_t block) const {
+    return memory + (size_t)(block % blockCount) * blockSize;
+}
+
+void TimeSeriesStore::startBlock(uint32_t time) {
+    if (endBlock - firstBlock == blockCount) {
+        rows -= readU16(blockAt(firstBlock) + 4);
+        firstBlock++;
+    }
+    uint8_t* header = blockAt(endBlock);
+    writeU32(header, time);
+    writeU16(header + 4, 0);
+    writeU16(header + 6, 0);
+    endBlock++;
+}
+
+bool TimeSeriesStore::append(uint32_t time, const int32_t* values) {
+    if (memory == NULL || values == NULL || (rows > 0 && time <= newestTime)) {
+        return false;
+    }
+    uint8_t encoded[MASK_BYTES(TIMESERIES_MAX_METRICS) + TIMESERIES_MAX_METRICS * 5];
+    size_t length = 0;
+    bool follows = rows > 0 && time - newestTime == interval;
+    if (follows) {
+        // Mask of the changed metrics, then their differences
+        size_t maskBytes = MASK_BYTES(metrics);
+        memset(encoded, 0, maskBytes);
+        length = maskBytes;
+        for (uint8_t m = 0; m < metrics; m++) {
+            uint32_t difference = (uint32_t)values[m] - (uint32_t)previous[m];
+            if (difference != 0) {
+                encoded[m / 8] |= (uint8_t)(1u << (m % 8));
+                length += writeVarint(encoded + length, zigzag(difference));
+            }
+        }
+        uint8_t* header = blockAt(endBlock - 1);
+        uint16_t used = readU16(header + 6);
+        if (TIMESERIES_BLOCK_HEADER + used + length > blockSize) {
+            follows = false;
+        }
+    }
+    if (!follows) {
+        // A new block starts with all values
+        startBlock(time);
+        length = 0;
+        for (uint8_t m = 0; m < metrics; m++) {
+            length += writeVarint(encoded + length, zigzag((uint32_t)values[m]));
+        }
+    }
+    uint8_t* header = blockAt(endBlock - 1);
+    uint16_t used = readU16(header + 6);
+    memcpy(header + TIMESERIES_BLOCK_HEADER + used, encoded, length);
+    writeU16(header + 4, (uint16_t)(readU16(header + 4) + 1));
+    writeU16(header + 6, (uint16_t)(used + length));
+    memcpy(previous, values, (size_t)metrics * sizeof(int32_t));
+    newestTime = time;
+    rows++;
+    return true;
+}
+
+size_t TimeSeriesStore::decodeBlock(const uint8_t* block, size_t blockSize, uint8_t metrics, uint32_t interval,
+                                    uint32_t from, uint32_t to, TimeSeriesVisitor visitor, void* context,
+                                    bool* stopped) {
+    if (stopped != NULL) {
+        *stopped = false;
+    }
+    uint32_t start = readU32(block);
+    uint16_t blockRows = readU16(block + 4);
+    uint16_t used = readU16(block + 6);
+    if (blockRows == 0 || metrics == 0 || metrics > TIMESERIES_MAX_METRICS ||
+        TIMESERIES_BLOCK_HEADER + (size_t)used > blockSize) {
+        return 0;
+    }
+    // Skip blocks outside the range without decoding them
+    uint64_t last = (uint64_t)start + (uint64_t)(blockRows - 1) * interval;
+    if (start > to || last < from) {
+        return 0;
+    }
+    const uint8_t* p = block + TIMESERIES_BLOCK_HEADER;
+    const uint8_t* end = p + used;
+    size_t maskBytes = MASK_BYTES(metrics);
+    int32_t values[TIMESERIES_MAX_METRICS];
+    size_t visited = 0;
+    for (uint16_t row = 0; row < blockRows; row++) {
+        uint64_t time = (uint64_t)start + (uint64_t)row * interval;
+        if (time > to) {
+            break;
+        }
+        if (row == 0) {
+            for (uint8_t m = 0; m < metrics; m++) {
+                uint32_t value;
+                if (!readVarint(&p, end, &value)) {
+                    return visited;
+                }
+                values[m] = (int32_t)unzigzag(value);
+            }
+        } else {
+            if ((size_t)(end - p) < maskBytes) {
+                return visited;
+            }
+            const uint8_t* mask = p;
+            p += maskBytes;
+            for (uint8_t m = 0; m < metrics; m++) {
+                if (mask[m / 8] & (1u << (m % 8))) {
+                    uint32_t difference;
+                    if (!readVarint(&p, end, &difference)) {
+                        return visited;
+                    }
+                    values[m] = (int32_t)((uint32_t)values[m] + unzigzag(difference));
+                }
+            }
+        }
+        if (time >= from) {
+            visited++;
+            if (!visitor((uint32_t)time, values, context)) {
+                if (stopped != NULL) {
+                    *stopped = true;
+                }
+                break;
+            }
+        }
+    }
+    return visited;
+}
+
+size_t TimeSeriesStore::query(uint32_t from, uint32_t to, TimeSeriesVisitor visitor, void* context) const {
+    if (memory == NULL || visitor == NULL || from > to) {
+        return 0;
+    }
+    size_t visited = 0;
+    for (uint32_t block = firstBlock; block != endBlock; block++) {
+        const uint8_t* data = blockAt(block);
+        if (readU32(data) > to) {
+            break;
+        }
+        bool stopped = false;
+        visited += decodeBlock(data, blockSize, metrics, interval, from, to, visitor, context, &stopped);
+        if (stopped) {
+            break;
+        }
+    }
+    return visited;
+}
+
+bool TimeSeriesStore::copyBlock(uint32_t block, uint8_t* out) const {
+    // Wrap-safe: the blocks held are the ones less than endBlock - firstBlock after firstBlock
+    if (memory == NULL || out == NULL || block - firstBlock >= endBlock - firstBlock) {
+        return false;
+    }
+    const uint8_t* data = blockAt(block);
+    // Only the used part is meaningful
+    size_t length = TIMESERIES_BLOCK_HEADER + readU16(data + 6);
+    memcpy(out, data, length);
+    return true;
+}
+
+uint32_t TimeSeriesStore::getOldestTime() const {
+    return rows > 0 ? readU32(blockAt(firstBlock)) : 0;
+}
+
+size_t TimeSeriesStore::getUsedBytes() const {
+    if (memory == NULL) {
+        return 0;
+    }
+    size_t used = 0;
+    for (uint32_t block = firstBlock; block != endBlock; block++) {
+        used += TIMESERIES_BLOCK_HEADER + readU16(blockAt(block) + 6);
+    }
+    return used;
+}
@@ -0,0 +1,171 @@
+#include <cstdint>
+#include <stddef.h>
+#include <string.h>
+
+#include "TraceDump.h"
+
+static const uint8_t TRACE_DUMP_MAGIC[4] = {'N', 'T', 'R', 'T'};
+
+static uint8_t* put16(uint8_t* out, uint16_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    return out + 2;
+}
+
+static uint8_t* put32(uint8_t* out, uint32_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    out[2] = (uint8_t)(value >> 16);
+    out[3] = (uint8_t)(value >> 24);
+    return out + 4;
+}
+
+static uint8_t* putName(uint8_t* out, const char* name) {
+    memset(out, 0, TRACE_DUMP_NAME_SIZE);
+    if (name != NULL) {
+        size_t length = strlen(name);
+        memcpy(out, name, length < TRACE_DUMP_NAME_SIZE - 1 ? length : TRACE_DUMP_NAME_SIZE - 1);
+    }
+    return out + TRACE_DUMP_NAME_SIZE;
+}
+
+static uint16_t get16(const uint8_t* in) {
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+static uint32_t get32(const uint8_t* in) {
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+static void getName(const uint8_t* in, char* name) {
+    memcpy(name, in, TRACE_DUMP_NAME_SIZE - 1);
+    name[TRACE_DUMP_NAME_SIZE - 1] = '\0';
+}
+
+size_t TraceDump::encodeHeader(uint8_t* out, uint64_t nowUs, uint16_t events, uint16_t tasks,
+                               uint32_t records, uint32_t skipped) {
+    memcpy(out, TRACE_DUMP_MAGIC, 4);
+    uint8_t* p = put16(out + 4, TRACE_DUMP_VERSION);
+    p = put16(p, TRACE_DUMP_RECORD_SIZE);
+    p = put32(p, (uint32_t)nowUs);
+    p = put32(p, (uint32_t)(nowUs >> 32));
+    p = put16(p, events);
+    p = put16(p, tasks);
+    p = put32(p, records);
+    p = put32(p, skipped);
+    put32(p, 0);
+    return TRACE_DUMP_HEADER_SIZE;
+}
+
+size_t TraceDump::encodeEvent(uint8_t* out, const char* name, const char* argName) {
+    putName(putName(out, name), argName);
+    return TRACE_DUMP_EVENT_SIZE;
+}
+
+size_t TraceDump::encodeTask(uint8_t* out, uint32_t taskNumber, const char* name) {
+    putName(put32(out, taskNumber), name);
+    return TRACE_DUMP_TASK_SIZE;
+}
+
+size_t TraceDump::encodeRecord(uint8_t* out, const TraceRecord& record, uint8_t core) {
+    uint8_t* p = put32(out, record.timeUs);
+    p = put32(p, record.arg);
+    p = put16(p, record.task);
+    p[0] = record.event;
+    p[1] = record.phase;
+    p[2] = core;
+    p[3] = 0;
+    p[4] = 0;
+    p[5] = 0;
+    return TRACE_DUMP_RECORD_SIZE;
+}
+
+TraceDump::TraceDump()
+    : events(NULL),
+      tasks(NULL),
+      records(NULL),
+      nowUs(0),
+      skipped(0),
+      eventCount(0),
+      taskCount(0),
+      recordCount(0) {
+}
+
+bool TraceDump::parse(const uint8_t* data, size_t size) {
+    eventCount = 0;
+    taskCount = 0;
+    recordCount = 0;
+    if (data == NULL || size < TRACE_DUMP_HEADER_SIZE || memcmp(data, TRACE_DUMP_MAGIC, 4) != 0 ||
+        get16(data + 4) != TRACE_DUMP_VERSION || get16(data + 6) != TRACE_DUMP_RECORD_SIZE) {
+        return false;
+    }
+    size_t events = get16(data + 16);
+    size_t tasks = get16(data + 18);
+    size_t records = get32(data + 20);
+    // Counts are checked one section at a time, so a large record count cannot overflow
+    size_t remaining = size - TRACE_DUMP_HEADER_SIZE;
+    if (remaining < events * TRACE_DUMP_EVENT_SIZE) {
+        return false;
+    }
+    remaining -= events * TRACE_DUMP_EVENT_SIZE;
+    if (remaining < tasks * TRACE_DUMP_TASK_SIZE) {
+        return false;
+    }
+    remaining -= tasks * TRACE_DUMP_TASK_SIZE;
+    if (remaining / TRACE_DUMP_RECORD_SIZE < records) {
+        return false;
+    }
+
+    nowUs = get32(data + 8) | ((uint64_t)get32(data + 12) << 32);
+    skipped = get32(data + 24);
+    this->events = data + TRACE_DUMP_HEADER_SIZE;
+    this->tasks = this->events + events * TRACE_DUMP_EVENT_SIZE;
+    this->records = this->tasks + tasks * TRACE_DUMP_TASK_SIZE;
+    eventCount = events;
+    taskCount = tasks;
+    recordCount = records;
+    return true;
+}
+
+void TraceDump::getEvent(size_t index, char* name, char* argName) const {
+    if (index >= eventCount) {
+        name[0] = '\0';
+        if (argName != NULL) {
+            argName[0] = '\0';
+        }
+        return;
+    }
+    const uint8_t* entry = events + index * TRACE_DUMP_EVENT_SIZE;
+    getName(entry, name);
+    if (argName != NULL) {
+        getName(entry + TRACE_DUMP_NAME_SIZE, argName);
+    }
+}
+
+uint32_t TraceDump::getTask(size_t index, char* name) const {
+    if (index >= taskCount) {
+        name[0] = '\0';
+        return 0;
+    }
+    const uint8_t* entry = tasks + index * TRACE_DUMP_TASK_SIZE;
+    getName(entry + 4, name);
+    return get32(entry);
+}
+
+uint64_t TraceDump::getRecord(size_t index, TraceRecord* record, uint8_t* core) const {
+    if (index >= recordCount) {
+        return 0;
+    }
+    const uint8_t* entry = records + index * TRACE_DUMP_RECORD_SIZE;
+    record->timeUs = get32(entry);
+    record->arg = get32(entry + 4);
+    record->task = get16(entry + 8);
+    record->event = entry[10];
+    record->phase = entry[11];
+    if (core != NULL) {
+        *core = entry[12];
+    }
+    // The record is at most 71 minutes older than the dump
+    uint32_t age = (uint32_t)nowUs - record->timeUs;
+    return (nowUs >= age) ? nowUs - age : 0;
+}
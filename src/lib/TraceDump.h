@@ -0,0 +1,126 @@
+/*!
+ * \file TraceDump.h
+ * \brief Binary download format of the trace recorder.
+ *
+ * The firmware writes the dump (GET /api/trace) and host tools read it. It
+ * describes itself: the event and task names are part of it, so a reader
+ * needs no copy of the firmware tables. All numbers are little endian.
+ *
+ *     header  32 bytes  "NTRT", version, record size, time of the dump (us, 64 bit),
+ *                       event count, task count, record count, records skipped
+ *     events  32 bytes  name (16 bytes, NUL padded), argument name (16 bytes)
+ *     tasks   20 bytes  task number (32 bit), name (16 bytes, NUL padded)
+ *     records 16 bytes  time (us, 32 bit), argument, task number (16 bit),
+ *                       event, phase, core, 3 reserved bytes
+ *
+ * Record times are the low 32 bits of the microsecond clock. A reader
+ * extends them to 64 bits with the time of the dump, which is later than
+ * every record and less than 71 minutes after the oldest one.
+ *
+ * No ESP-IDF dependencies; the encoder and the parser are plain C++11.
+ */
+
+#ifndef TRACE_DUMP_H
+#define TRACE_DUMP_H
+
+#include <cstdint>
+#include <stddef.h>
+
+#include "TraceRing.h"
+
+#define TRACE_DUMP_VERSION      1
+#define TRACE_DUMP_HEADER_SIZE  32
+#define TRACE_DUMP_EVENT_SIZE   32
+#define TRACE_DUMP_TASK_SIZE    20
+#define TRACE_DUMP_RECORD_SIZE  16
+#define TRACE_DUMP_NAME_SIZE    16      // Including the terminating NUL
+
+class TraceDump {
+public:
+    /**
+     * \brief Encode the header.
+     * \param[out] out TRACE_DUMP_HEADER_SIZE bytes.
+     * \param[in] nowUs Time of the dump in microseconds.
+     * \param[in] events Number of event entries that follow.
+     * \param[in] tasks Number of task entries that follow.
+     * \param[in] records Number of records that follow.
+     * \param[in] skipped Records in the rings left out because they were written during the snapshot.
+     * \return TRACE_DUMP_HEADER_SIZE.
+     */
+    static size_t encodeHeader(uint8_t* out, uint64_t nowUs, uint16_t events, uint16_t tasks,
+                               uint32_t records, uint32_t skipped);
+
+    /**
+     * \brief Encode an event entry; names are cut to 15 characters.
+     * \param[out] out TRACE_DUMP_EVENT_SIZE bytes.
+     * \param[in] name Event name.
+     * \param[in] argName Name of the argument, NULL or "" without one.
+     * \return TRACE_DUMP_EVENT_SIZE.
+     */
+    static size_t encodeEvent(uint8_t* out, const char* name, const char* argName);
+
+    /**
+     * \brief Encode a task entry; the name is cut to 15 characters.
+     * \param[out] out TRACE_DUMP_TASK_SIZE bytes.
+     * \return TRACE_DUMP_TASK_SIZE.
+     */
+    static size_t encodeTask(uint8_t* out, uint32_t taskNumber, const char* name);
+
+    /**
+     * \brief Encode a record.
+     * \param[out] out TRACE_DUMP_RECORD_SIZE bytes.
+     * \param[in] record Record from the ring.
+     * \param[in] core Core of the ring.
+     * \return TRACE_DUMP_RECORD_SIZE.
+     */
+    static size_t encodeRecord(uint8_t* out, const TraceRecord& record, uint8_t core);
+
+    TraceDump();
+
+    /**
+     * \brief Check a dump and index its sections. The data must stay valid while the parser is used.
+     * \return true if the magic, version, sizes and counts fit the data.
+     */
+    bool parse(const uint8_t* data, size_t size);
+
+    uint64_t getNowUs() const { return nowUs; }
+    uint32_t getSkipped() const { return skipped; }
+    size_t getEventCount() const { return eventCount; }
+    size_t getTaskCount() const { return taskCount; }
+    size_t getRecordCount() const { return recordCount; }
+
+    /**
+     * \brief Names of an event, "" when out of range.
+     * \param[in] index Event ID.
+     * \param[out] name Receives the name (TRACE_DUMP_NAME_SIZE bytes).
+     * \param[out] argName Receives the argument name (TRACE_DUMP_NAME_SIZE bytes, optional).
+     */
+    void getEvent(size_t index, char* name, char* argName) const;
+
+    /**
+     * \brief Task entry by index.
+     * \param[out] name Receives the name (TRACE_DUMP_NAME_SIZE bytes).
+     * \return The task number, 0 when out of range.
+     */
+    uint32_t getTask(size_t index, char* name) const;
+
+    /**
+     * \brief Record by index.
+     * \param[out] record Receives the record.
+     * \param[out] core Receives the core (optional).
+     * \return The time of the record extended to 64 bits, 0 when out of range.
+     */
+    uint64_t getRecord(size_t index, TraceRecord* record, uint8_t* core) const;
+
+private:
+    const uint8_t* events;
+    const uint8_t* tasks;
+    const uint8_t* records;
+    uint64_t nowUs;
+    uint32_t skipped;
+    size_t eventCount;
+    size_t taskCount;
+    size_t recordCount;
+};
+
+#endif // TRACE_DUMP_H
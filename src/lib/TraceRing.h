@@ -0,0 +1,105 @@
+/*!
+ * \file TraceRing.h
+ * \brief Lock-free ring of fixed-size binary trace records.
+ *
+ * Used by the trace recorder (traceRecorder.h) to keep the last events of
+ * the tasks: UART reads, parsed sentences, RTCM reads and forwards,
+ * telemetry frames and MQTT publishes. A record is 16 bytes: a sequence
+ * number, a 32 bit microsecond timestamp, an argument and the event, phase
+ * and task. The ring keeps the newest records and overwrites the oldest.
+ *
+ * \section trace_ring_writers Writers
+ * Any number of tasks may record into one ring. A writer reserves a slot
+ * with one atomic increment of the head, writes the record and then
+ * publishes it by storing its sequence number (index + 1) last. A writer
+ * never waits for another writer or for the reader. The firmware keeps one
+ * ring per core, so writers on different cores do not share the head.
+ *
+ * \section trace_ring_reader Reader
+ * snapshot() copies the records without stopping the writers. A slot is
+ * taken only when its sequence number is that of the expected index before
+ * and after the copy (a sequence lock per slot), so records that are being
+ * written, or overwritten during the copy, are skipped instead of torn. A
+ * writer preempted for a whole lap of the ring can still mix its fields
+ * into the newer record of its slot. The record with index 2^32 - 1 gets
+ * sequence number 0 and is never read.
+ */
+
+#ifndef TRACE_RING_H
+#define TRACE_RING_H
+
+#include <atomic>
+#include <cstdint>
+#include <stddef.h>
+
+// Record phases, as in the Chrome trace event format
+#define TRACE_PHASE_INSTANT 0   // A point in time
+#define TRACE_PHASE_BEGIN   1   // Start of a duration
+#define TRACE_PHASE_END     2   // End of a duration
+
+/**
+ * \brief One trace record as copied out of the ring.
+ */
+struct TraceRecord {
+    uint32_t timeUs;        // Microsecond timestamp, wraps after 71 minutes
+    uint32_t arg;           // Event argument (bytes, length)
+    uint16_t task;          // Task number of the writer, 0 if unknown
+    uint8_t event;          // Event ID of the recorder
+    uint8_t phase;          // TRACE_PHASE_*
+};
+
+class TraceRing {
+public:
+    TraceRing();
+    ~TraceRing();
+
+    /**
+     * \brief Allocate the ring.
+     * \param[in] capacity Number of records, a power of two.
+     * \return true on success, false on an invalid capacity or allocation failure.
+     */
+    bool init(size_t capacity);
+
+    /**
+     * \brief Release the ring. No writer may use it any more.
+     */
+    void deinit();
+
+    /**
+     * \brief Add a record, overwriting the oldest one when full. Does nothing before init().
+     * \param[in] timeUs Microsecond timestamp.
+     * \param[in] event Event ID.
+     * \param[in] phase TRACE_PHASE_*.
+     * \param[in] task Task number of the writer.
+     * \param[in] arg Event argument.
+     */
+    void record(uint32_t timeUs, uint8_t event, uint8_t phase, uint16_t task, uint32_t arg);
+
+    /**
+     * \brief Copy the complete records in the ring, oldest first.
+     * \param[out] records Receives the records.
+     * \param[in] maxRecords Size of records; the newest records are copied when it is smaller than the ring.
+     * \return Number of records copied.
+     */
+    size_t snapshot(TraceRecord* records, size_t maxRecords) const;
+
+    /** \brief Records written since init(), modulo 2^32. */
+    uint32_t getWritten() const { return head.load(std::memory_order_relaxed); }
+
+    /** \brief Number of records the ring holds, 0 before init(). */
+    size_t getCapacity() const { return capacity; }
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> sequence;    // Index + 1 when complete, 0 while written
+        std::atomic<uint32_t> timeUs;
+        std::atomic<uint32_t> arg;
+        std::atomic<uint32_t> info;        // Task << 16 | event << 8 | phase
+    };
+
+    Slot* slots;
+    size_t capacity;
+    std::atomic<uint32_t> head;
+};
+
+#endif // TRACE_RING_H
@@ -10,7 +10,10 @@
 #include "gnssReceiverTask.h"
 #include "dataOutputTask.h"
 #include "statisticsTask.h"
+#include "traceRecorder.h"
 #include "mqttClientTask.h"
+#include "ntripCasterTask.h"
+#include "nmeaServerTask.h"
 
 #include "ledIndicatorTask.h"
 #include "buttonBootTask.h"
@@ -37,6 +40,14 @@ extern "C" void app_main(void) {
     ESP_ERROR_CHECK(ret);
     ESP_LOGI(TAG, "✓ NVS Flash initialized");
     
+    // Trace rings, before the tasks that record into them (not fatal)
+    ret = trace_recorder_init();
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Trace recorder not available: %s", esp_err_to_name(ret));
+    } else {
+        ESP_LOGI(TAG, "✓ Trace recorder initialized");
+    }
+    
     // ========================================
     // Step 2: Initialize Configuration Manager
     // ========================================
@@ -116,7 +127,27 @@ extern "C" void app_main(void) {
     }
     
     // ========================================
-    // Step 11: Initialize Button Boot Task
+    // Step 11: Initialize local NTRIP Caster Task
+    // ========================================
+    ret = ntrip_caster_task_init();
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "NTRIP Caster Task initialization failed: %s", esp_err_to_name(ret));
+    } else {
+        ESP_LOGI(TAG, "\u2713 NTRIP Caster Task initialized");
+    }
+    
+    // ========================================
+    // Step 12: Initialize NMEA Server Task
+    // ========================================
+    ret = nmea_server_task_init();
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "NMEA Server Task initialization failed: %s", esp_err_to_name(ret));
+    } else {
+        ESP_LOGI(TAG, "\u2713 NMEA Server Task initialized");
+    }
+    
+    // ========================================
+    // Step 13: Initialize Button Boot Task
     // ========================================
     ret = button_boot_task_init();
     if (ret != ESP_OK) {
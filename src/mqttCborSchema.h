@@ -0,0 +1,150 @@
+/**
+ * @file mqttCborSchema.h
+ * @brief Map keys of the MQTT messages in CBOR encoding
+ *
+ * Plain C header without ESP-IDF dependencies, shared by the MQTT Client Task
+ * and the host side decoder in tests/MQTTcbor.
+ */
+
+#ifndef MQTT_CBOR_SCHEMA_H
+#define MQTT_CBOR_SCHEMA_H
+
+/*
+ * CBOR schema of the MQTT messages (topic encoding set to CBOR)
+ *
+ * Each message is one CBOR map with the unsigned integer keys below. Key 0
+ * holds MQTT_CBOR_SCHEMA_VERSION. Floats are single precision, lat/lon
+ * double precision, integers use the shortest CBOR encoding, and the
+ * per-constellation and fix duration fields are arrays. New fields are only
+ * appended with new keys; a decoder ignores keys it does not know.
+ */
+#define MQTT_CBOR_SCHEMA_VERSION 1
+
+// <topic>/GNSS, fields of mqtt_gnss_message_t
+enum {
+    MQTT_CBOR_GNSS_VERSION = 0,
+    MQTT_CBOR_GNSS_NUM,
+    MQTT_CBOR_GNSS_DAYTIME,
+    MQTT_CBOR_GNSS_LAT,
+    MQTT_CBOR_GNSS_LON,
+    MQTT_CBOR_GNSS_ALT,
+    MQTT_CBOR_GNSS_FIX_TYPE,
+    MQTT_CBOR_GNSS_SPEED,
+    MQTT_CBOR_GNSS_DIR,
+    MQTT_CBOR_GNSS_SATS,
+    MQTT_CBOR_GNSS_HDOP,
+    MQTT_CBOR_GNSS_AGE,
+    MQTT_CBOR_GNSS_KEY_COUNT
+};
+
+// <topic>/status, fields of mqtt_status_message_t
+enum {
+    MQTT_CBOR_STATUS_VERSION = 0,
+    MQTT_CBOR_STATUS_TIMESTAMP,
+    MQTT_CBOR_STATUS_UPTIME_SEC,
+    MQTT_CBOR_STATUS_HEAP_FREE,
+    MQTT_CBOR_STATUS_HEAP_MIN,
+    MQTT_CBOR_STATUS_WIFI_CONNECTED,
+    MQTT_CBOR_STATUS_WIFI_RSSI,
+    MQTT_CBOR_STATUS_NTRIP_CONNECTED,
+    MQTT_CBOR_STATUS_NTRIP_UPTIME_SEC,
+    MQTT_CBOR_STATUS_NTRIP_RECONNECTS,
+    MQTT_CBOR_STATUS_RTCM_PACKETS_TOTAL,
+    MQTT_CBOR_STATUS_MQTT_CONNECTED,
+    MQTT_CBOR_STATUS_MQTT_UPTIME_SEC,
+    MQTT_CBOR_STATUS_MQTT_PUBLISHED,
+    MQTT_CBOR_STATUS_WIFI_RECONNECTS,
+    MQTT_CBOR_STATUS_CURRENT_FIX,
+    MQTT_CBOR_STATUS_GNSS_BATCHES,
+    MQTT_CBOR_STATUS_BATCHED_EPOCHS,
+    MQTT_CBOR_STATUS_MESSAGES_SAVED,
+    MQTT_CBOR_STATUS_BYTES_SAVED,
+    MQTT_CBOR_STATUS_GNSS_EPOCHS,
+    MQTT_CBOR_STATUS_GNSS_AGE_AVG_US,
+    MQTT_CBOR_STATUS_GNSS_AGE_MAX_US,
+    MQTT_CBOR_STATUS_GNSS_SUPPRESSED,
+    MQTT_CBOR_STATUS_GNSS_SUPPRESSED_BYTES,
+    MQTT_CBOR_STATUS_SIMPLIFIED_EPOCHS,
+    MQTT_CBOR_STATUS_OUTBOX_BACKLOG,
+    MQTT_CBOR_STATUS_OUTBOX_STORED,
+    MQTT_CBOR_STATUS_OUTBOX_DRAINED,
+    MQTT_CBOR_STATUS_OUTBOX_DROPPED,
+    MQTT_CBOR_STATUS_QOS_ACKED,
+    MQTT_CBOR_STATUS_QOS_DROPPED,
+    MQTT_CBOR_STATUS_PUBACK_AVG_MS,
+    MQTT_CBOR_STATUS_KEY_COUNT
+};
+
+// <topic>/stats, fields of mqtt_stats_message_t
+enum {
+    MQTT_CBOR_STATS_VERSION = 0,
+    MQTT_CBOR_STATS_TIMESTAMP,
+    MQTT_CBOR_STATS_PERIOD_DURATION,
+    MQTT_CBOR_STATS_RTCM_BYTES_RECEIVED,
+    MQTT_CBOR_STATS_RTCM_MESSAGE_RATE,
+    MQTT_CBOR_STATS_RTCM_DATA_GAPS,
+    MQTT_CBOR_STATS_RTCM_AVG_LATENCY_MS,
+    MQTT_CBOR_STATS_RTCM_CORRUPTED,
+    MQTT_CBOR_STATS_MSM_SATELLITES,         // array [GPS, GLO, GAL, BDS]
+    MQTT_CBOR_STATS_MSM_SIGNALS,            // array [GPS, GLO, GAL, BDS]
+    MQTT_CBOR_STATS_MSM_MESSAGE_RATE,       // array [GPS, GLO, GAL, BDS]
+    MQTT_CBOR_STATS_FIX_QUALITY_DURATION,   // array indexed by fix quality 0-8
+    MQTT_CBOR_STATS_RTK_FIXED_PERCENT,
+    MQTT_CBOR_STATS_TIME_TO_RTK_FIXED_SEC,
+    MQTT_CBOR_STATS_FIX_DOWNGRADES,
+    MQTT_CBOR_STATS_FIX_UPGRADES,
+    MQTT_CBOR_STATS_HDOP_AVG,
+    MQTT_CBOR_STATS_HDOP_MIN,
+    MQTT_CBOR_STATS_HDOP_MAX,
+    MQTT_CBOR_STATS_SATS_AVG,
+    MQTT_CBOR_STATS_BASELINE_DISTANCE_KM,
+    MQTT_CBOR_STATS_GGA_SENT_COUNT,
+    MQTT_CBOR_STATS_GGA_FAILURES,
+    MQTT_CBOR_STATS_GGA_OVERFLOWS,
+    MQTT_CBOR_STATS_GGA_VRS_REGENERATIONS,
+    MQTT_CBOR_STATS_GGA_BYTES_SAVED,
+    MQTT_CBOR_STATS_WIFI_RSSI_AVG,
+    MQTT_CBOR_STATS_WIFI_RSSI_MIN,
+    MQTT_CBOR_STATS_WIFI_RSSI_MAX,
+    MQTT_CBOR_STATS_WIFI_UPTIME_PERCENT,
+    MQTT_CBOR_STATS_GNSS_UPDATE_RATE_HZ,
+    MQTT_CBOR_STATS_NMEA_ERRORS,
+    MQTT_CBOR_STATS_UART_ERRORS,
+    MQTT_CBOR_STATS_RTCM_QUEUE_OVERFLOWS,
+    MQTT_CBOR_STATS_NTRIP_TIMEOUTS,
+    MQTT_CBOR_STATS_QUANTILES,              // array per metric [HDOP, sats, RSSI, age] of [p10, p50, p90, p99]
+    MQTT_CBOR_STATS_HISTOGRAMS,             // array per metric of [count, shift, gap, count, gap, count, ...]
+    MQTT_CBOR_STATS_POSITION,               // [samples, mean lat, mean lon, mean alt, std E, std N, std U, CEP50, CEP95, 2DRMS]
+    MQTT_CBOR_STATS_KEY_COUNT
+};
+
+/*
+ * <topic>/GNSS/batch, several GNSS epochs (see GnssBatch)
+ *
+ * NUM, DAYTIME (of the first epoch), COUNT and the base position LAT/LON
+ * (1e-7 degrees) and ALT (mm) are integers or text; every other key holds
+ * an array of COUNT integers. T_MS is the offset of each epoch to the first
+ * one, DLAT/DLON/DALT the change to the previous epoch (0 for the first).
+ */
+enum {
+    MQTT_CBOR_BATCH_VERSION = 0,
+    MQTT_CBOR_BATCH_NUM,
+    MQTT_CBOR_BATCH_DAYTIME,
+    MQTT_CBOR_BATCH_COUNT,
+    MQTT_CBOR_BATCH_LAT_E7,
+    MQTT_CBOR_BATCH_LON_E7,
+    MQTT_CBOR_BATCH_ALT_MM,
+    MQTT_CBOR_BATCH_T_MS,
+    MQTT_CBOR_BATCH_DLAT_E7,
+    MQTT_CBOR_BATCH_DLON_E7,
+    MQTT_CBOR_BATCH_DALT_MM,
+    MQTT_CBOR_BATCH_FIX_TYPE,
+    MQTT_CBOR_BATCH_SATS,
+    MQTT_CBOR_BATCH_SPEED_X100,
+    MQTT_CBOR_BATCH_DIR_X10,
+    MQTT_CBOR_BATCH_HDOP_X100,
+    MQTT_CBOR_BATCH_AGE_X100,
+    MQTT_CBOR_BATCH_KEY_COUNT
+};
+
+#endif // MQTT_CBOR_SCHEMA_H
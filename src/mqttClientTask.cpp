@@ -2,18 +2,29 @@
 #include "configurationManagerTask.h"
 #include "gnssReceiverTask.h"
 #include "statisticsTask.h"
+#include "traceRecorder.h"
 #include "wifiManager.h"
 #include "ntripClientTask.h"
 
 #include "ledIndicatorTask.h"
+#include "lib/JsonWriter.h"
+#include "lib/CborWriter.h"
+#include "lib/GnssBatch.h"
+#include "lib/EpochScheduler.h"
+#include "lib/GGAScheduler.h"
+#include "lib/FlashRing.h"
+#include "lib/PublishQueue.h"
 
+#include <stdlib.h>
 #include <string.h>
 #include <sys/time.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "esp_wifi.h"
+#include "esp_partition.h"
 #include "mqtt_client.h"
 
 static const char *TAG = "MQTT_CLIENT";
@@ -32,12 +43,98 @@ static time_t mqtt_connection_start = 0;
 static uint32_t mqtt_uptime_accumulated = 0;
 static time_t last_activity_time = 0;
 
+// Publish buffer shared by all messages (only used by the MQTT task)
+#define MQTT_PUBLISH_BUFFER_SIZE 3072
+static char publish_buffer[MQTT_PUBLISH_BUFFER_SIZE];
+
+// Longest wait for a GNSS epoch; status and stats intervals are counted in whole seconds
+#define MQTT_TICK_MS 100
+
+// Epoch driven GNSS publishing (only used by the MQTT task, counters read by the HTTP server)
+static EpochScheduler gnss_scheduler;
+
+// GNSS deadband filter: the GGA upload policy (distance, fix change, maximum
+// interval) without a minimum interval
+static GGAScheduler gnss_deadband;
+static mqtt_deadband_stats_t deadband_stats;
+
+// Batched GNSS publishing (only used by the MQTT task, counters read by the HTTP server)
+static_assert(MQTT_GNSS_BATCH_MAX_EPOCHS <= GnssBatch::MAX_EPOCHS, "MQTT_GNSS_BATCH_MAX_EPOCHS exceeds GnssBatch");
+static GnssBatch gnss_batch;
+static char batch_daytime[32];
+static mqtt_batch_stats_t batch_stats;
+
+// Store-and-forward outbox: GNSS messages are kept in the "outbox" flash
+// partition while disconnected and drained at outbox_rate after reconnecting
+#define OUTBOX_PARTITION_LABEL "outbox"
+#define OUTBOX_SECTOR_SIZE 4096
+#define OUTBOX_TAG_GNSS 0
+#define OUTBOX_TAG_GNSS_BATCH 1
+static FlashRing outbox;
+static bool outbox_ready = false;
+static uint32_t outbox_capacity = 0;
+static uint32_t outbox_backlog_peak = 0;
+static float outbox_tokens = 0.0f;
+static int64_t outbox_last_refill_us = 0;
+static int64_t outbox_drain_start_us = 0;
+static uint32_t outbox_drain_messages = 0;
+static uint32_t outbox_last_drain_messages = 0;
+static uint32_t outbox_last_drain_ms = 0;
+
+// QoS 1 publishing: messages wait in a RAM queue of qos_queue_kb (oldest
+// dropped when full) and at most qos_window of them wait for their PUBACK in
+// the MQTT client outbox. The event handler passes PUBACKs (and messages the
+// client deleted) to the MQTT task through puback_queue.
+#define QOS_ACK_TIMEOUT_US 60000000LL
+#define PUBACK_QUEUE_LENGTH (2 * PUBLISH_WINDOW_MAX)
+// Backstop for the client outbox; the window keeps it far below this
+#define MQTT_CLIENT_OUTBOX_LIMIT (PUBLISH_WINDOW_MAX * (MQTT_PUBLISH_BUFFER_SIZE + 256))
+#if MQTT_PUBACK_LATENCY_BUCKETS != PUBLISH_LATENCY_BUCKETS
+#error "MQTT_PUBACK_LATENCY_BUCKETS does not match PublishQueue"
+#endif
+#if MQTT_QOS_WINDOW_MAX > PUBLISH_WINDOW_MAX
+#error "MQTT_QOS_WINDOW_MAX exceeds the PublishQueue window"
+#endif
+
+typedef struct {
+    int msg_id;
+    int64_t time_us;
+    bool deleted;                // Deleted from the client outbox without PUBACK
+} puback_event_t;
+
+static PublishQueue qos_queue;
+static uint8_t *qos_buffer = NULL;
+static uint32_t qos_buffer_size = 0;
+static QueueHandle_t puback_queue = NULL;
+static uint8_t qos_levels[3] = { 0, 0, 0 };     // GNSS, status, stats (for the status page)
+
 // Forward declarations
 static void mqtt_task(void *pvParameters);
 static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data);
-static void format_gnss_json(const mqtt_gnss_message_t *msg, char *buffer, size_t size);
-static void format_status_json(const mqtt_status_message_t *msg, char *buffer, size_t size);
-static void format_stats_json(const mqtt_stats_message_t *msg, char *buffer, size_t size);
+static size_t format_gnss_json(const mqtt_gnss_message_t *msg, char *buffer, size_t size);
+static size_t format_status_json(const mqtt_status_message_t *msg, char *buffer, size_t size);
+static size_t format_stats_json(const mqtt_stats_message_t *msg, char *buffer, size_t size);
+static size_t encode_gnss_cbor(const mqtt_gnss_message_t *msg, uint8_t *buffer, size_t size);
+static size_t encode_status_cbor(const mqtt_status_message_t *msg, uint8_t *buffer, size_t size);
+static size_t encode_stats_cbor(const mqtt_stats_message_t *msg, uint8_t *buffer, size_t size);
+static size_t format_gnss_batch_json(const GnssBatch *batch, uint32_t num, const char *daytime, char *buffer, size_t size);
+static size_t encode_gnss_batch_cbor(const GnssBatch *batch, uint32_t num, const char *daytime, uint8_t *buffer, size_t size);
+static void fill_gnss_message(const gnss_data_t *gnss_data, mqtt_gnss_message_t *msg);
+static uint32_t gnss_time_of_day_ms(const gnss_data_t *gnss_data);
+static void configure_gnss_publish(const mqtt_config_t *config);
+static void publish_gnss_epoch(const mqtt_config_t *config);
+static void configure_gnss_deadband(const mqtt_config_t *config);
+static bool gnss_deadband_pass(const mqtt_config_t *config, const gnss_data_t *gnss_data, size_t packet_size);
+static size_t mqtt_publish_packet_size(size_t topic_length, size_t payload_length);
+static void configure_gnss_batch(const mqtt_config_t *config);
+static void sample_gnss_batch(const mqtt_config_t *config);
+static void publish_gnss_batch(const mqtt_config_t *config);
+static void outbox_init(void);
+static bool outbox_store(uint8_t tag, size_t length);
+static void outbox_drain(const mqtt_config_t *config);
+static void configure_qos(const mqtt_config_t *config);
+static bool mqtt_publish_message(const char *topic, size_t length, uint8_t qos);
+static void qos_service(void);
 static void collect_system_status(mqtt_status_message_t *msg);
 static void collect_period_statistics(mqtt_stats_message_t *msg);
 
@@ -49,7 +146,7 @@ esp_err_t mqtt_client_task_init(void) {
     BaseType_t result = xTaskCreate(
         mqtt_task,
         "mqtt_client",
-        5120,  // Stack size (increased for JSON buffers)
+        4608,  // Stack size (JSON is written into the static publish buffer)
         NULL,
         2,     // Priority (lower than critical tasks)
         &mqtt_task_handle
@@ -70,6 +167,7 @@ void mqtt_client_task_stop(void) {
         esp_mqtt_client_stop(mqtt_client);
         esp_mqtt_client_destroy(mqtt_client);
         mqtt_client = NULL;
+        qos_queue.releaseAll();
     }
     
     if (mqtt_task_handle) {
@@ -104,6 +202,95 @@ uint32_t mqtt_get_uptime_sec(void) {
     return uptime;
 }
 
+// Get batched GNSS publishing counters
+void mqtt_get_batch_stats(mqtt_batch_stats_t *stats) {
+    if (stats == NULL) {
+        return;
+    }
+    memcpy(stats, &batch_stats, sizeof(mqtt_batch_stats_t));
+}
+
+// Get GNSS epoch and sample age counters
+void mqtt_get_gnss_timing(mqtt_gnss_timing_t *timing) {
+    if (timing == NULL) {
+        return;
+    }
+    timing->epochs = gnss_scheduler.getEpochs();
+    timing->published = gnss_scheduler.getPublished();
+    timing->sample_age_last_us = gnss_scheduler.getLastAgeUs();
+    timing->sample_age_avg_us = gnss_scheduler.getAverageAgeUs();
+    timing->sample_age_max_us = gnss_scheduler.getMaxAgeUs();
+}
+
+// Get store-and-forward outbox counters
+void mqtt_get_outbox_stats(mqtt_outbox_stats_t *stats) {
+    if (stats == NULL) {
+        return;
+    }
+    memset(stats, 0, sizeof(mqtt_outbox_stats_t));
+    stats->available = outbox_ready;
+    stats->capacity_bytes = outbox_capacity;
+    stats->backlog = outbox.getRecords();
+    stats->backlog_bytes = outbox.getBytes();
+    stats->backlog_peak = outbox_backlog_peak;
+    stats->stored = outbox.getAppended();
+    stats->drained = outbox.getDrained();
+    stats->dropped = outbox.getDropped();
+    stats->corrupt = outbox.getCorrupt();
+    stats->flash_errors = outbox.getFlashErrors();
+    stats->sector_erases = outbox.getErases();
+    stats->max_sector_erases = outbox.getMaxSectorErases();
+    stats->bytes_written = outbox.getBytesWritten();
+    stats->last_drain_messages = outbox_last_drain_messages;
+    stats->last_drain_ms = outbox_last_drain_ms;
+    stats->last_drain_rate = (outbox_last_drain_ms > 0)
+        ? outbox_last_drain_messages * 1000.0f / outbox_last_drain_ms : 0.0f;
+}
+
+// Get QoS 1 queue, window and PUBACK latency counters
+void mqtt_get_qos_stats(mqtt_qos_stats_t *stats) {
+    if (stats == NULL) {
+        return;
+    }
+    memset(stats, 0, sizeof(mqtt_qos_stats_t));
+    stats->enabled = qos_buffer != NULL;
+    stats->gnss_qos = qos_levels[0];
+    stats->status_qos = qos_levels[1];
+    stats->stats_qos = qos_levels[2];
+    stats->window = qos_queue.getWindow();
+    stats->in_flight = qos_queue.getInFlight();
+    stats->in_flight_peak = qos_queue.getInFlightPeak();
+    stats->queued = qos_queue.getQueued();
+    stats->queued_bytes = qos_queue.getQueuedBytes();
+    stats->queued_peak_bytes = qos_queue.getQueuedPeakBytes();
+    stats->queue_limit_bytes = qos_queue.getCapacity();
+    if (mqtt_client != NULL) {
+        int outbox_size = esp_mqtt_client_get_outbox_size(mqtt_client);
+        stats->client_outbox_bytes = (outbox_size > 0) ? (uint32_t)outbox_size : 0;
+    }
+    stats->sent = qos_queue.getSent();
+    stats->acked = qos_queue.getAcked();
+    stats->dropped = qos_queue.getDropped();
+    stats->rejected = qos_queue.getRejected();
+    stats->lost = qos_queue.getLost();
+    stats->latency_min_ms = qos_queue.getLatencyMinMs();
+    stats->latency_avg_ms = qos_queue.getLatencyAvgMs();
+    stats->latency_max_ms = qos_queue.getLatencyMaxMs();
+    stats->latency_last_ms = qos_queue.getLatencyLastMs();
+    for (uint8_t i = 0; i < MQTT_PUBACK_LATENCY_BUCKETS; i++) {
+        stats->latency_bound_ms[i] = PublishQueue::latencyBound(i);
+        stats->latency_count[i] = qos_queue.getLatencyCount(i);
+    }
+}
+
+// Get GNSS deadband filter counters
+void mqtt_get_deadband_stats(mqtt_deadband_stats_t *stats) {
+    if (stats == NULL) {
+        return;
+    }
+    memcpy(stats, &deadband_stats, sizeof(mqtt_deadband_stats_t));
+}
+
 // Set last activity time
 void mqtt_set_last_activity_time(time_t timestamp) {
     last_activity_time = timestamp;
@@ -147,11 +334,25 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
         case MQTT_EVENT_PUBLISHED:
             ESP_LOGD(TAG, "MQTT message published, msg_id=%d", event->msg_id);
             
+            // PUBACK of a QoS 1 message, timed here for the latency histogram
+            if (puback_queue != NULL) {
+                puback_event_t puback = { event->msg_id, esp_timer_get_time(), false };
+                xQueueSend(puback_queue, &puback, 0);
+            }
+            
             // Update activity time for LED indicator
             gettimeofday(&tv, NULL);
             mqtt_set_last_activity_time(tv.tv_sec);
             break;
             
+        case MQTT_EVENT_DELETED:
+            ESP_LOGW(TAG, "MQTT message deleted without PUBACK, msg_id=%d", event->msg_id);
+            if (puback_queue != NULL) {
+                puback_event_t deleted = { event->msg_id, esp_timer_get_time(), true };
+                xQueueSend(puback_queue, &deleted, 0);
+            }
+            break;
+            
         case MQTT_EVENT_ERROR:
             ESP_LOGE(TAG, "MQTT error: type=%d", event->error_handle->error_type);
             break;
@@ -164,7 +365,6 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
 // Main MQTT task
 static void mqtt_task(void *pvParameters) {
     mqtt_config_t config;
-    uint32_t gnss_counter = 0;
     uint32_t status_counter = 0;
     uint32_t stats_counter = 0;
     
@@ -189,6 +389,13 @@ static void mqtt_task(void *pvParameters) {
     }
 
     int64_t last_config_poll = 0;
+    int64_t last_second = 0;
+    configure_gnss_publish(&config);
+    configure_gnss_deadband(&config);
+    configure_gnss_batch(&config);
+    outbox_init();
+    puback_queue = xQueueCreate(PUBACK_QUEUE_LENGTH, sizeof(puback_event_t));
+    configure_qos(&config);
 
     // If enabled at boot, start client
     if (config.enabled) {
@@ -198,12 +405,19 @@ static void mqtt_task(void *pvParameters) {
         ESP_LOGI(TAG, "Base topic: %s", config.topic);
         ESP_LOGI(TAG, "Intervals - GNSS: %u sec, Status: %u sec, Stats: %u sec",
                  config.gnss_interval_sec, config.status_interval_sec, config.stats_interval_sec);
+        if (config.gnss_every_n > 0 || config.gnss_interval_ms > 0) {
+            ESP_LOGI(TAG, "GNSS publishing: every %u epochs, %u ms", config.gnss_every_n, config.gnss_interval_ms);
+        }
+        if (config.gnss_batch_size > 1) {
+            ESP_LOGI(TAG, "GNSS batching: %u epochs or %u ms", config.gnss_batch_size, config.gnss_batch_ms);
+        }
         esp_mqtt_client_config_t mqtt_cfg = {};
         mqtt_cfg.broker.address.uri = broker_uri;
         mqtt_cfg.credentials.username = config.user;
         mqtt_cfg.credentials.authentication.password = config.password;
         mqtt_cfg.session.keepalive = 60;
         mqtt_cfg.session.disable_clean_session = false;
+        mqtt_cfg.outbox.limit = MQTT_CLIENT_OUTBOX_LIMIT;
         mqtt_client = esp_mqtt_client_init(&mqtt_cfg);
         if (mqtt_client != NULL) {
             esp_mqtt_client_register_event(mqtt_client, (esp_mqtt_event_id_t)ESP_EVENT_ANY_ID, mqtt_event_handler, NULL);
@@ -212,6 +426,9 @@ static void mqtt_task(void *pvParameters) {
         }
     }
     
+    // Loop time from waking up until the next wait
+    int64_t loop_start_us = esp_timer_get_time();
+    
     // Main loop
     while (1) {
         // Check for configuration changes (non-blocking)
@@ -244,6 +461,7 @@ static void mqtt_task(void *pvParameters) {
                         mqtt_cfg.credentials.authentication.password = new_config.password;
                         mqtt_cfg.session.keepalive = 60;
                         mqtt_cfg.session.disable_clean_session = false;
+                        mqtt_cfg.outbox.limit = MQTT_CLIENT_OUTBOX_LIMIT;
                         
                         mqtt_client = esp_mqtt_client_init(&mqtt_cfg);
                         if (mqtt_client != NULL) {
@@ -258,10 +476,10 @@ static void mqtt_task(void *pvParameters) {
                         esp_mqtt_client_destroy(mqtt_client);
                         mqtt_client = NULL;
                         mqtt_connected = false;
+                        qos_queue.releaseAll();
                         ESP_LOGI(TAG, "MQTT client disabled");
                         
                         // Reset counters
-                        gnss_counter = 0;
                         status_counter = 0;
                         stats_counter = 0;
                     }
@@ -269,17 +487,46 @@ static void mqtt_task(void *pvParameters) {
                 
                 // Check if intervals changed
                 if (new_config.gnss_interval_sec != config.gnss_interval_sec ||
+                    new_config.gnss_interval_ms != config.gnss_interval_ms ||
+                    new_config.gnss_every_n != config.gnss_every_n ||
                     new_config.status_interval_sec != config.status_interval_sec ||
                     new_config.stats_interval_sec != config.stats_interval_sec) {
                     
-                    ESP_LOGI(TAG, "MQTT intervals updated - GNSS: %u sec, Status: %u sec, Stats: %u sec",
-                             new_config.gnss_interval_sec, new_config.status_interval_sec, 
-                             new_config.stats_interval_sec);
+                    ESP_LOGI(TAG, "MQTT intervals updated - GNSS: %u sec (%u ms, every %u epochs), Status: %u sec, Stats: %u sec",
+                             new_config.gnss_interval_sec, new_config.gnss_interval_ms, new_config.gnss_every_n,
+                             new_config.status_interval_sec, new_config.stats_interval_sec);
                     
                     // Reset counters when intervals change
-                    gnss_counter = 0;
                     status_counter = 0;
                     stats_counter = 0;
+                    configure_gnss_publish(&new_config);
+                }
+                
+                if (new_config.gnss_deadband_m != config.gnss_deadband_m ||
+                    new_config.gnss_heartbeat_sec != config.gnss_heartbeat_sec) {
+                    ESP_LOGI(TAG, "MQTT GNSS deadband updated - %u m, heartbeat %u sec",
+                             new_config.gnss_deadband_m, new_config.gnss_heartbeat_sec);
+                    configure_gnss_deadband(&new_config);
+                }
+                
+                // Epochs collected under the old limits are dropped
+                if (new_config.gnss_batch_size != config.gnss_batch_size ||
+                    new_config.gnss_batch_ms != config.gnss_batch_ms ||
+                    new_config.gnss_encoding != config.gnss_encoding) {
+                    ESP_LOGI(TAG, "MQTT GNSS batching updated - %u epochs, %u ms",
+                             new_config.gnss_batch_size, new_config.gnss_batch_ms);
+                    configure_gnss_batch(&new_config);
+                }
+                
+                if (new_config.gnss_qos != config.gnss_qos ||
+                    new_config.status_qos != config.status_qos ||
+                    new_config.stats_qos != config.stats_qos ||
+                    new_config.qos_window != config.qos_window ||
+                    new_config.qos_queue_kb != config.qos_queue_kb) {
+                    ESP_LOGI(TAG, "MQTT QoS updated - GNSS %u, status %u, stats %u, window %u, queue %u KB",
+                             new_config.gnss_qos, new_config.status_qos, new_config.stats_qos,
+                             new_config.qos_window, new_config.qos_queue_kb);
+                    configure_qos(&new_config);
                 }
                 
                 // Update config (note: broker/topic changes require restart for simplicity)
@@ -288,11 +535,20 @@ static void mqtt_task(void *pvParameters) {
         }
         
 
-        // 1 second tick for interval management
-        vTaskDelay(pdMS_TO_TICKS(1000));
+        // Wake on the next GNSS epoch, or after one tick without epochs
+        statistics_loop_time(STATS_TASK_MQTT, (uint32_t)(esp_timer_get_time() - loop_start_us));
+        EventBits_t gnss_bits = 0;
+        if (gnss_event_group != NULL) {
+            gnss_bits = xEventGroupWaitBits(gnss_event_group, GNSS_EPOCH_BIT,
+                                            pdTRUE, pdFALSE, pdMS_TO_TICKS(MQTT_TICK_MS));
+        } else {
+            vTaskDelay(pdMS_TO_TICKS(MQTT_TICK_MS));
+        }
+        bool new_epoch = (gnss_bits & GNSS_EPOCH_BIT) != 0;
 
         // Periodic config poll to catch missed event bits (runtime toggle)
         int64_t now_us = esp_timer_get_time();
+        loop_start_us = now_us;
         if ((now_us - last_config_poll) >= 1000000) {
             last_config_poll = now_us;
             mqtt_config_t polled_config;
@@ -308,7 +564,7 @@ static void mqtt_task(void *pvParameters) {
                         esp_mqtt_client_destroy(mqtt_client);
                         mqtt_client = NULL;
                         mqtt_connected = false;
-                        gnss_counter = 0;
+                        qos_queue.releaseAll();
                         status_counter = 0;
                         stats_counter = 0;
                     } else if (config.enabled && mqtt_client == NULL) {
@@ -321,6 +577,7 @@ static void mqtt_task(void *pvParameters) {
                         mqtt_cfg.credentials.authentication.password = config.password;
                         mqtt_cfg.session.keepalive = 60;
                         mqtt_cfg.session.disable_clean_session = false;
+                        mqtt_cfg.outbox.limit = MQTT_CLIENT_OUTBOX_LIMIT;
                         mqtt_client = esp_mqtt_client_init(&mqtt_cfg);
                         if (mqtt_client != NULL) {
                             esp_mqtt_client_register_event(mqtt_client, (esp_mqtt_event_id_t)ESP_EVENT_ANY_ID, mqtt_event_handler, NULL);
@@ -329,77 +586,88 @@ static void mqtt_task(void *pvParameters) {
                         }
                     }
                 } else {
+                    if (polled_config.gnss_interval_sec != config.gnss_interval_sec ||
+                        polled_config.gnss_interval_ms != config.gnss_interval_ms ||
+                        polled_config.gnss_every_n != config.gnss_every_n) {
+                        configure_gnss_publish(&polled_config);
+                    }
+                    if (polled_config.gnss_deadband_m != config.gnss_deadband_m ||
+                        polled_config.gnss_heartbeat_sec != config.gnss_heartbeat_sec) {
+                        configure_gnss_deadband(&polled_config);
+                    }
+                    if (polled_config.gnss_batch_size != config.gnss_batch_size ||
+                        polled_config.gnss_batch_ms != config.gnss_batch_ms ||
+                        polled_config.gnss_encoding != config.gnss_encoding) {
+                        configure_gnss_batch(&polled_config);
+                    }
+                    if (polled_config.gnss_qos != config.gnss_qos ||
+                        polled_config.status_qos != config.status_qos ||
+                        polled_config.stats_qos != config.stats_qos ||
+                        polled_config.qos_window != config.qos_window ||
+                        polled_config.qos_queue_kb != config.qos_queue_kb) {
+                        configure_qos(&polled_config);
+                    }
                     config = polled_config;
                 }
             }
         }
 
-        // Skip if not connected
+        // Skip if not connected; GNSS messages go on into the outbox if it is enabled
+        bool storing = config.enabled && config.outbox_enabled && outbox_ready;
         if (!mqtt_connected) {
             // Reset counters when disconnected to sync on reconnect
-            gnss_counter = 0;
             status_counter = 0;
             stats_counter = 0;
+            last_second = now_us;
+            // A drain starts again from one message after the reconnect, not from saved up tokens
+            outbox_drain_start_us = 0;
+            if (!storing) {
+                gnss_scheduler.reset();
+                gnss_deadband.reset();
+                if (gnss_batch.count() > 0) {
+                    gnss_batch.reset();
+                }
+                continue;
+            }
+        }
+        
+        // GNSS messages follow the receiver epochs (gnss_interval_sec 0 disables them);
+        // batched publishing replaces the single GNSS message
+        bool gnss_batching = config.gnss_interval_sec > 0 && config.gnss_batch_size > 1;
+        if (gnss_batching) {
+            if (new_epoch) {
+                sample_gnss_batch(&config);
+            }
+            if (gnss_batch.isDue((uint32_t)(esp_timer_get_time() / 1000))) {
+                publish_gnss_batch(&config);
+            }
+        } else if (config.gnss_interval_sec > 0 && new_epoch) {
+            publish_gnss_epoch(&config);
+        }
+        
+        if (!mqtt_connected) {
+            continue;
+        }
+        qos_service();
+        if (config.outbox_enabled) {
+            outbox_drain(&config);
+        }
+        
+        // The status and stats intervals below are counted once per second
+        now_us = esp_timer_get_time();
+        if ((now_us - last_second) < 1000000) {
             continue;
         }
+        last_second = ((now_us - last_second) < 2000000) ? last_second + 1000000 : now_us;
         
         // Increment counters only if their intervals are enabled (> 0)
-        if (config.gnss_interval_sec > 0) gnss_counter++;
         if (config.status_interval_sec > 0) status_counter++;
         if (config.stats_interval_sec > 0) stats_counter++;
         
-        ESP_LOGD(TAG, "Counters - GNSS:%lu/%u, Status:%lu/%u, Stats:%lu/%u", 
-                 gnss_counter, config.gnss_interval_sec,
+        ESP_LOGD(TAG, "Counters - Status:%lu/%u, Stats:%lu/%u", 
                  status_counter, config.status_interval_sec,
                  stats_counter, config.stats_interval_sec);
         
-        // Publish GNSS position data (only if interval > 0)
-        if (config.gnss_interval_sec > 0 && gnss_counter >= config.gnss_interval_sec) {
-            gnss_counter = 0;
-            
-            gnss_data_t gnss_data;
-            gnss_get_data(&gnss_data);
-            if (gnss_data.valid) {
-                mqtt_gnss_message_t gnss_msg = {};
-                
-                // Map pre-parsed data to MQTT message structure
-                gnss_msg.lat = gnss_data.latitude;
-                gnss_msg.lon = gnss_data.longitude;
-                gnss_msg.alt = gnss_data.altitude;
-                gnss_msg.fix_type = gnss_data.fix_quality;
-                gnss_msg.speed = gnss_data.speed;
-                gnss_msg.dir = gnss_data.heading;
-                gnss_msg.sats = gnss_data.satellites;
-                gnss_msg.hdop = gnss_data.hdop;
-                gnss_msg.age = gnss_data.dgps_age;  // Age of differential data from GGA field 13
-                
-                // Format timestamp as ISO 8601
-                snprintf(gnss_msg.daytime, sizeof(gnss_msg.daytime),
-                         "%04d-%02d-%02d %02d:%02d:%02d.%03d",
-                         2000 + gnss_data.year, gnss_data.month, gnss_data.day,
-                         gnss_data.hour, gnss_data.minute, gnss_data.second, gnss_data.millisecond);
-                gnss_msg.num = ++message_counter;
-                
-                // Format and publish
-                char json_buffer[512];
-                format_gnss_json(&gnss_msg, json_buffer, sizeof(json_buffer));
-                
-                char topic[128];
-                snprintf(topic, sizeof(topic), "%s/GNSS", config.topic);
-                
-                int msg_id = esp_mqtt_client_publish(mqtt_client, topic, json_buffer, 0, 0, 0);
-                if (msg_id >= 0) {
-                    total_published++;
-                    led_update_mqtt_activity();  // Blink LED on publish
-                    ESP_LOGI(TAG, "Published GNSS #%lu to %s", message_counter, topic);
-                } else {
-                    ESP_LOGE(TAG, "Failed to publish GNSS message");
-                }
-            } else {
-                ESP_LOGW(TAG, "No valid GNSS data, skipping GNSS publish");
-            }
-        }
-        
         // Publish system status (cumulative runtime data, only if interval > 0)
         if (config.status_interval_sec > 0 && status_counter >= config.status_interval_sec) {
             status_counter = 0;
@@ -407,14 +675,14 @@ static void mqtt_task(void *pvParameters) {
             mqtt_status_message_t status_msg = {};
             collect_system_status(&status_msg);
             
-            char json_buffer[1024];
-            format_status_json(&status_msg, json_buffer, sizeof(json_buffer));
+            size_t length = (config.status_encoding == MQTT_ENCODING_CBOR)
+                ? encode_status_cbor(&status_msg, (uint8_t *)publish_buffer, sizeof(publish_buffer))
+                : format_status_json(&status_msg, publish_buffer, sizeof(publish_buffer));
             
             char topic[128];
             snprintf(topic, sizeof(topic), "%s/status", config.topic);
             
-            int msg_id = esp_mqtt_client_publish(mqtt_client, topic, json_buffer, 0, 0, 0);
-            if (msg_id >= 0) {
+            if (mqtt_publish_message(topic, length, config.status_qos)) {
                 total_published++;
                 led_update_mqtt_activity();  // Blink LED on publish
                 ESP_LOGI(TAG, "Published system status to %s", topic);
@@ -427,17 +695,19 @@ static void mqtt_task(void *pvParameters) {
         if (config.stats_interval_sec > 0 && stats_counter >= config.stats_interval_sec) {
             stats_counter = 0;
             
-            mqtt_stats_message_t stats_msg = {};
+            // Static: the histograms make the message too large for the task stack
+            static mqtt_stats_message_t stats_msg;
+            memset(&stats_msg, 0, sizeof(stats_msg));
             collect_period_statistics(&stats_msg);
             
-            char json_buffer[1024];
-            format_stats_json(&stats_msg, json_buffer, sizeof(json_buffer));
+            size_t length = (config.stats_encoding == MQTT_ENCODING_CBOR)
+                ? encode_stats_cbor(&stats_msg, (uint8_t *)publish_buffer, sizeof(publish_buffer))
+                : format_stats_json(&stats_msg, publish_buffer, sizeof(publish_buffer));
             
             char topic[128];
             snprintf(topic, sizeof(topic), "%s/stats", config.topic);
             
-            int msg_id = esp_mqtt_client_publish(mqtt_client, topic, json_buffer, 0, 0, 0);
-            if (msg_id >= 0) {
+            if (mqtt_publish_message(topic, length, config.stats_qos)) {
                 total_published++;
                 led_update_mqtt_activity();  // Blink LED on publish
                 ESP_LOGI(TAG, "Published statistics to %s", topic);
@@ -491,6 +761,23 @@ static void collect_system_status(mqtt_status_message_t *msg) {
     msg->mqtt_connected = mqtt_connected;
     msg->mqtt_uptime_sec = mqtt_get_uptime_sec();
     msg->mqtt_published = total_published;
+    msg->gnss_batches = batch_stats.batches;
+    msg->batched_epochs = batch_stats.epochs;
+    msg->messages_saved = batch_stats.messages_saved;
+    msg->bytes_saved = batch_stats.bytes_saved;
+    msg->gnss_epochs = gnss_scheduler.getEpochs();
+    msg->gnss_age_avg_us = gnss_scheduler.getAverageAgeUs();
+    msg->gnss_age_max_us = gnss_scheduler.getMaxAgeUs();
+    msg->gnss_suppressed = deadband_stats.suppressed;
+    msg->gnss_suppressed_bytes = deadband_stats.suppressed_bytes;
+    msg->simplified_epochs = batch_stats.simplified_epochs;
+    msg->outbox_backlog = outbox.getRecords();
+    msg->outbox_stored = outbox.getAppended();
+    msg->outbox_drained = outbox.getDrained();
+    msg->outbox_dropped = outbox.getDropped();
+    msg->qos_acked = qos_queue.getAcked();
+    msg->qos_dropped = qos_queue.getDropped() + qos_queue.getRejected() + qos_queue.getLost();
+    msg->puback_avg_ms = qos_queue.getLatencyAvgMs();
     
     // WiFi reconnects
     msg->wifi_reconnects = runtime_stats.wifi_reconnect_count_total;
@@ -534,6 +821,9 @@ static void collect_period_statistics(mqtt_stats_message_t *msg) {
     msg->rtcm_data_gaps = period_stats.rtcm_data_gaps;
     msg->rtcm_avg_latency_ms = period_stats.rtcm_avg_latency_ms;
     msg->rtcm_corrupted = period_stats.rtcm_corrupted_count;
+    memcpy(msg->msm_satellites, period_stats.rtcm_msm_satellites, sizeof(msg->msm_satellites));
+    memcpy(msg->msm_signals, period_stats.rtcm_msm_signals, sizeof(msg->msm_signals));
+    memcpy(msg->msm_message_rate, period_stats.rtcm_msm_rate, sizeof(msg->msm_message_rate));
     
     // GNSS metrics
     memcpy(msg->fix_quality_duration, period_stats.fix_quality_duration, sizeof(msg->fix_quality_duration));
@@ -546,11 +836,14 @@ static void collect_period_statistics(mqtt_stats_message_t *msg) {
     msg->hdop_max = period_stats.hdop_max;
     msg->sats_avg = period_stats.satellites_avg;
     msg->baseline_distance_km = period_stats.baseline_distance_km;
+    msg->position = period_stats.position;
     
     // GGA transmission
     msg->gga_sent_count = period_stats.gga_sent_count;
     msg->gga_failures = period_stats.gga_send_failures;
     msg->gga_overflows = period_stats.gga_queue_overflows;
+    msg->gga_vrs_regenerations = period_stats.gga_vrs_regenerations;
+    msg->gga_bytes_saved = period_stats.gga_bytes_saved;
     
     // WiFi metrics
     msg->wifi_rssi_avg = period_stats.wifi_rssi_avg;
@@ -566,162 +859,843 @@ static void collect_period_statistics(mqtt_stats_message_t *msg) {
     msg->uart_errors = period_stats.uart_errors;
     msg->rtcm_queue_overflows = period_stats.rtcm_queue_overflows;
     msg->ntrip_timeouts = period_stats.ntrip_timeouts;
+    
+    // Distributions
+    memcpy(msg->quantiles, period_stats.quantiles, sizeof(msg->quantiles));
+    for (int m = 0; m < STATS_METRIC_COUNT; m++) {
+        if (!statistics_get_histogram((statistics_metric_t)m, false, &msg->histograms[m])) {
+            memset(&msg->histograms[m], 0, sizeof(msg->histograms[m]));
+        }
+    }
+}
+
+// Length of the formatted message in the buffer (truncated if it did not fit)
+static size_t json_length(const JsonWriter& json, size_t size) {
+    if (json.overflowed()) {
+        ESP_LOGW(TAG, "JSON message truncated (%u of %u bytes)", (unsigned)(size - 1), (unsigned)json.length());
+        return size - 1;
+    }
+    return json.length();
 }
 
 // Format GNSS JSON message
-static void format_gnss_json(const mqtt_gnss_message_t *msg, char *buffer, size_t size) {
-    snprintf(buffer, size,
-        "{\n"
-        "   \"num\": %lu,\n"
-        "   \"daytime\": \"%s\",\n"
-        "   \"lat\": %.7f,\n"
-        "   \"lon\": %.7f,\n"
-        "   \"alt\": %.3f,\n"
-        "   \"fix_type\": %u,\n"
-        "   \"speed\": %.2f,\n"
-        "   \"dir\": %.1f,\n"
-        "   \"sats\": %u,\n"
-        "   \"hdop\": %.2f,\n"
-        "   \"age\": %.2f\n"
-        "}",
-        msg->num,
-        msg->daytime,
-        msg->lat,
-        msg->lon,
-        msg->alt,
-        msg->fix_type,
-        msg->speed,
-        msg->dir,
-        msg->sats,
-        msg->hdop,
-        (double)msg->age  // Explicit cast to double for snprintf
-    );
+static size_t format_gnss_json(const mqtt_gnss_message_t *msg, char *buffer, size_t size) {
+    JsonWriter json(buffer, size);
+    json.beginObject();
+    json.addUInt("num", msg->num);
+    json.addString("daytime", msg->daytime);
+    json.addFixed("lat", msg->lat, 7);
+    json.addFixed("lon", msg->lon, 7);
+    json.addFixed("alt", msg->alt, 3);
+    json.addUInt("fix_type", msg->fix_type);
+    json.addFixed("speed", msg->speed, 2);
+    json.addFixed("dir", msg->dir, 1);
+    json.addUInt("sats", msg->sats);
+    json.addFixed("hdop", msg->hdop, 2);
+    json.addFixed("age", msg->age, 2);
+    json.endObject();
+    return json_length(json, size);
 }
 
 // Format system status JSON message
-static void format_status_json(const mqtt_status_message_t *msg, char *buffer, size_t size) {
-    snprintf(buffer, size,
-        "{\n"
-        "   \"timestamp\": \"%s\",\n"
-        "   \"uptime_sec\": %lu,\n"
-        "   \"heap_free\": %lu,\n"
-        "   \"heap_min\": %lu,\n"
-        "   \"wifi\": {\n"
-        "      \"rssi_dbm\": %d,\n"
-        "      \"reconnects\": %lu\n"
-        "   },\n"
-        "   \"ntrip\": {\n"
-        "      \"connected\": %s,\n"
-        "      \"uptime_sec\": %lu,\n"
-        "      \"reconnects\": %lu,\n"
-        "      \"rtcm_packets_total\": %lu\n"
-        "   },\n"
-        "   \"mqtt\": {\n"
-        "      \"uptime_sec\": %lu,\n"
-        "      \"messages_published\": %lu\n"
-        "   },\n"
-        "   \"gnss\": {\n"
-        "      \"current_fix\": %u\n"
-        "   }\n"
-        "}",
-        msg->timestamp,
-        msg->uptime_sec,
-        msg->heap_free,
-        msg->heap_min,
-        msg->wifi_rssi,
-        msg->wifi_reconnects,
-        msg->ntrip_connected ? "true" : "false",
-        msg->ntrip_uptime_sec,
-        msg->ntrip_reconnects,
-        msg->rtcm_packets_total,
-        msg->mqtt_uptime_sec,
-        msg->mqtt_published,
-        msg->current_fix
-    );
+static size_t format_status_json(const mqtt_status_message_t *msg, char *buffer, size_t size) {
+    JsonWriter json(buffer, size);
+    json.beginObject();
+    json.addString("timestamp", msg->timestamp);
+    json.addUInt("uptime_sec", msg->uptime_sec);
+    json.addUInt("heap_free", msg->heap_free);
+    json.addUInt("heap_min", msg->heap_min);
+    json.beginObject("wifi");
+    json.addInt("rssi_dbm", msg->wifi_rssi);
+    json.addUInt("reconnects", msg->wifi_reconnects);
+    json.endObject();
+    json.beginObject("ntrip");
+    json.addBool("connected", msg->ntrip_connected);
+    json.addUInt("uptime_sec", msg->ntrip_uptime_sec);
+    json.addUInt("reconnects", msg->ntrip_reconnects);
+    json.addUInt("rtcm_packets_total", msg->rtcm_packets_total);
+    json.endObject();
+    json.beginObject("mqtt");
+    json.addUInt("uptime_sec", msg->mqtt_uptime_sec);
+    json.addUInt("messages_published", msg->mqtt_published);
+    json.addUInt("gnss_batches", msg->gnss_batches);
+    json.addUInt("batched_epochs", msg->batched_epochs);
+    json.addUInt("messages_saved", msg->messages_saved);
+    json.addInt64("bytes_saved", msg->bytes_saved);
+    json.addUInt("gnss_epochs", msg->gnss_epochs);
+    json.addUInt("gnss_age_avg_us", msg->gnss_age_avg_us);
+    json.addUInt("gnss_age_max_us", msg->gnss_age_max_us);
+    json.addUInt("gnss_suppressed", msg->gnss_suppressed);
+    json.addInt64("gnss_suppressed_bytes", (int64_t)msg->gnss_suppressed_bytes);
+    json.addUInt("simplified_epochs", msg->simplified_epochs);
+    json.addUInt("outbox_backlog", msg->outbox_backlog);
+    json.addUInt("outbox_stored", msg->outbox_stored);
+    json.addUInt("outbox_drained", msg->outbox_drained);
+    json.addUInt("outbox_dropped", msg->outbox_dropped);
+    json.addUInt("qos_acked", msg->qos_acked);
+    json.addUInt("qos_dropped", msg->qos_dropped);
+    json.addUInt("puback_avg_ms", msg->puback_avg_ms);
+    json.endObject();
+    json.beginObject("gnss");
+    json.addUInt("current_fix", msg->current_fix);
+    json.endObject();
+    json.endObject();
+    return json_length(json, size);
 }
 
 // Format statistics JSON message
-static void format_stats_json(const mqtt_stats_message_t *msg, char *buffer, size_t size) {
-    snprintf(buffer, size,
-        "{\n"
-        "   \"timestamp\": \"%s\",\n"
-        "   \"period_sec\": %lu,\n"
-        "   \"rtcm\": {\n"
-        "      \"bytes_received\": %lu,\n"
-        "      \"message_rate\": %lu,\n"
-        "      \"data_gaps\": %lu,\n"
-        "      \"avg_latency_ms\": %lu,\n"
-        "      \"corrupted\": %lu\n"
-        "   },\n"
-        "   \"gnss\": {\n"
-        "      \"fix_duration\": {\n"
-        "         \"no_fix\": %lu,\n"
-        "         \"gps\": %lu,\n"
-        "         \"dgps\": %lu,\n"
-        "         \"rtk_float\": %lu,\n"
-        "         \"rtk_fixed\": %lu\n"
-        "      },\n"
-        "      \"rtk_fixed_percent\": %.1f,\n"
-        "      \"time_to_rtk_fixed_sec\": %lu,\n"
-        "      \"fix_downgrades\": %lu,\n"
-        "      \"fix_upgrades\": %lu,\n"
-        "      \"hdop_avg\": %.2f,\n"
-        "      \"hdop_min\": %.2f,\n"
-        "      \"hdop_max\": %.2f,\n"
-        "      \"sats_avg\": %u,\n"
-        "      \"baseline_distance_km\": %.2f,\n"
-        "      \"update_rate_hz\": %lu\n"
-        "   },\n"
-        "   \"gga\": {\n"
-        "      \"sent_count\": %lu,\n"
-        "      \"failures\": %lu,\n"
-        "      \"queue_overflows\": %lu\n"
-        "   },\n"
-        "   \"wifi\": {\n"
-        "      \"rssi_avg\": %d,\n"
-        "      \"rssi_min\": %d,\n"
-        "      \"rssi_max\": %d,\n"
-        "      \"uptime_percent\": %.1f\n"
-        "   },\n"
-        "   \"errors\": {\n"
-        "      \"nmea_checksum\": %lu,\n"
-        "      \"uart\": %lu,\n"
-        "      \"rtcm_queue_overflow\": %lu,\n"
-        "      \"ntrip_timeouts\": %lu\n"
-        "   }\n"
-        "}",
-        msg->timestamp,
-        msg->period_duration,
-        msg->rtcm_bytes_received,
-        msg->rtcm_message_rate,
-        msg->rtcm_data_gaps,
-        msg->rtcm_avg_latency_ms,
-        msg->rtcm_corrupted,
-        msg->fix_quality_duration[0],  // no_fix
-        msg->fix_quality_duration[1],  // gps
-        msg->fix_quality_duration[2],  // dgps
-        msg->fix_quality_duration[5],  // rtk_float
-        msg->fix_quality_duration[4],  // rtk_fixed
-        msg->rtk_fixed_percent,
-        msg->time_to_rtk_fixed_sec,
-        msg->fix_downgrades,
-        msg->fix_upgrades,
-        msg->hdop_avg,
-        msg->hdop_min,
-        msg->hdop_max,
-        msg->sats_avg,
-        msg->baseline_distance_km,
-        msg->gnss_update_rate_hz,
-        msg->gga_sent_count,
-        msg->gga_failures,
-        msg->gga_overflows,
-        msg->wifi_rssi_avg,
-        msg->wifi_rssi_min,
-        msg->wifi_rssi_max,
-        msg->wifi_uptime_percent,
-        msg->nmea_errors,
-        msg->uart_errors,
-        msg->rtcm_queue_overflows,
-        msg->ntrip_timeouts
-    );
+static size_t format_stats_json(const mqtt_stats_message_t *msg, char *buffer, size_t size) {
+    static const char *constellation_names[RTCM_CONSTELLATION_COUNT] = {"gps", "glonass", "galileo", "beidou"};
+    static const char *metric_names[STATS_METRIC_COUNT] = {"hdop", "satellites", "wifi_rssi", "correction_age"};
+    static const uint8_t metric_decimals[STATS_METRIC_COUNT] = {2, 0, 0, 1};
+    static const char *quantile_names[STATS_QUANTILE_COUNT] = {"p10", "p50", "p90", "p99"};
+
+    JsonWriter json(buffer, size);
+    json.beginObject();
+    json.addString("timestamp", msg->timestamp);
+    json.addUInt("period_sec", msg->period_duration);
+
+    json.beginObject("rtcm");
+    json.addUInt("bytes_received", msg->rtcm_bytes_received);
+    json.addUInt("message_rate", msg->rtcm_message_rate);
+    json.addUInt("data_gaps", msg->rtcm_data_gaps);
+    json.addUInt("avg_latency_ms", msg->rtcm_avg_latency_ms);
+    json.addUInt("corrupted", msg->rtcm_corrupted);
+    json.beginObject("constellations");
+    for (int i = 0; i < RTCM_CONSTELLATION_COUNT; i++) {
+        json.beginObject(constellation_names[i], true);
+        json.addUInt("satellites", msg->msm_satellites[i]);
+        json.addUInt("signals", msg->msm_signals[i]);
+        json.addFixed("message_rate", msg->msm_message_rate[i], 2);
+        json.endObject();
+    }
+    json.endObject();
+    json.endObject();
+
+    json.beginObject("gnss");
+    json.beginObject("fix_duration");
+    json.addUInt("no_fix", msg->fix_quality_duration[0]);
+    json.addUInt("gps", msg->fix_quality_duration[1]);
+    json.addUInt("dgps", msg->fix_quality_duration[2]);
+    json.addUInt("rtk_float", msg->fix_quality_duration[5]);
+    json.addUInt("rtk_fixed", msg->fix_quality_duration[4]);
+    json.endObject();
+    json.addFixed("rtk_fixed_percent", msg->rtk_fixed_percent, 1);
+    json.addUInt("time_to_rtk_fixed_sec", msg->time_to_rtk_fixed_sec);
+    json.addUInt("fix_downgrades", msg->fix_downgrades);
+    json.addUInt("fix_upgrades", msg->fix_upgrades);
+    json.addFixed("hdop_avg", msg->hdop_avg, 2);
+    json.addFixed("hdop_min", msg->hdop_min, 2);
+    json.addFixed("hdop_max", msg->hdop_max, 2);
+    json.addUInt("sats_avg", msg->sats_avg);
+    json.addFixed("baseline_distance_km", msg->baseline_distance_km, 2);
+    json.addUInt("update_rate_hz", msg->gnss_update_rate_hz);
+    json.endObject();
+
+    json.beginObject("position");
+    json.addUInt("samples", msg->position.samples);
+    json.addFixed("mean_lat", msg->position.mean_latitude, 8);
+    json.addFixed("mean_lon", msg->position.mean_longitude, 8);
+    json.addFixed("mean_alt_m", msg->position.mean_altitude_m, 3);
+    json.addFixed("std_east_m", msg->position.std_east_m, 3);
+    json.addFixed("std_north_m", msg->position.std_north_m, 3);
+    json.addFixed("std_up_m", msg->position.std_up_m, 3);
+    json.addFixed("cep50_m", msg->position.cep50_m, 3);
+    json.addFixed("cep95_m", msg->position.cep95_m, 3);
+    json.addFixed("drms2_m", msg->position.drms2_m, 3);
+    json.endObject();
+
+    json.beginObject("gga");
+    json.addUInt("sent_count", msg->gga_sent_count);
+    json.addUInt("failures", msg->gga_failures);
+    json.addUInt("queue_overflows", msg->gga_overflows);
+    json.addUInt("vrs_regenerations", msg->gga_vrs_regenerations);
+    json.addInt("bytes_saved", msg->gga_bytes_saved);
+    json.endObject();
+
+    json.beginObject("wifi");
+    json.addInt("rssi_avg", msg->wifi_rssi_avg);
+    json.addInt("rssi_min", msg->wifi_rssi_min);
+    json.addInt("rssi_max", msg->wifi_rssi_max);
+    json.addFixed("uptime_percent", msg->wifi_uptime_percent, 1);
+    json.endObject();
+
+    json.beginObject("errors");
+    json.addUInt("nmea_checksum", msg->nmea_errors);
+    json.addUInt("uart", msg->uart_errors);
+    json.addUInt("rtcm_queue_overflow", msg->rtcm_queue_overflows);
+    json.addUInt("ntrip_timeouts", msg->ntrip_timeouts);
+    json.endObject();
+
+    // Histogram bins as [gap, count, gap, count, ...]
+    json.beginObject("distributions");
+    for (int m = 0; m < STATS_METRIC_COUNT; m++) {
+        const statistics_histogram_t *histogram = &msg->histograms[m];
+        json.beginObject(metric_names[m], true);
+        json.addUInt("count", histogram->count);
+        for (int q = 0; q < STATS_QUANTILE_COUNT; q++) {
+            json.addFixed(quantile_names[q], msg->quantiles[m][q], metric_decimals[m]);
+        }
+        json.addUInt("shift", histogram->shift);
+        json.beginArray("bins");
+        for (int i = 0; i < histogram->bins && i < STATS_HISTOGRAM_MAX_BINS; i++) {
+            json.addItem(histogram->gaps[i]);
+            json.addItem(histogram->counts[i]);
+        }
+        json.endArray();
+        json.endObject();
+    }
+    json.endObject();
+    json.endObject();
+    return json_length(json, size);
+}
+
+// Length of the encoded message in the buffer (truncated if it did not fit)
+static size_t cbor_length(const CborWriter& cbor, size_t size) {
+    if (cbor.overflowed()) {
+        ESP_LOGW(TAG, "CBOR message truncated (%u of %u bytes)", (unsigned)size, (unsigned)cbor.length());
+        return size;
+    }
+    return cbor.length();
+}
+
+// Encode GNSS message as CBOR (keys MQTT_CBOR_GNSS_*)
+static size_t encode_gnss_cbor(const mqtt_gnss_message_t *msg, uint8_t *buffer, size_t size) {
+    CborWriter cbor(buffer, size);
+    cbor.beginMap(MQTT_CBOR_GNSS_KEY_COUNT);
+    cbor.addUInt(MQTT_CBOR_GNSS_VERSION, MQTT_CBOR_SCHEMA_VERSION);
+    cbor.addUInt(MQTT_CBOR_GNSS_NUM, msg->num);
+    cbor.addText(MQTT_CBOR_GNSS_DAYTIME, msg->daytime);
+    cbor.addDouble(MQTT_CBOR_GNSS_LAT, msg->lat);
+    cbor.addDouble(MQTT_CBOR_GNSS_LON, msg->lon);
+    cbor.addFloat(MQTT_CBOR_GNSS_ALT, msg->alt);
+    cbor.addUInt(MQTT_CBOR_GNSS_FIX_TYPE, msg->fix_type);
+    cbor.addFloat(MQTT_CBOR_GNSS_SPEED, msg->speed);
+    cbor.addFloat(MQTT_CBOR_GNSS_DIR, msg->dir);
+    cbor.addUInt(MQTT_CBOR_GNSS_SATS, msg->sats);
+    cbor.addFloat(MQTT_CBOR_GNSS_HDOP, msg->hdop);
+    cbor.addFloat(MQTT_CBOR_GNSS_AGE, msg->age);
+    return cbor_length(cbor, size);
+}
+
+// Encode system status message as CBOR (keys MQTT_CBOR_STATUS_*)
+static size_t encode_status_cbor(const mqtt_status_message_t *msg, uint8_t *buffer, size_t size) {
+    CborWriter cbor(buffer, size);
+    cbor.beginMap(MQTT_CBOR_STATUS_KEY_COUNT);
+    cbor.addUInt(MQTT_CBOR_STATUS_VERSION, MQTT_CBOR_SCHEMA_VERSION);
+    cbor.addText(MQTT_CBOR_STATUS_TIMESTAMP, msg->timestamp);
+    cbor.addUInt(MQTT_CBOR_STATUS_UPTIME_SEC, msg->uptime_sec);
+    cbor.addUInt(MQTT_CBOR_STATUS_HEAP_FREE, msg->heap_free);
+    cbor.addUInt(MQTT_CBOR_STATUS_HEAP_MIN, msg->heap_min);
+    cbor.addBool(MQTT_CBOR_STATUS_WIFI_CONNECTED, msg->wifi_connected);
+    cbor.addInt(MQTT_CBOR_STATUS_WIFI_RSSI, msg->wifi_rssi);
+    cbor.addBool(MQTT_CBOR_STATUS_NTRIP_CONNECTED, msg->ntrip_connected);
+    cbor.addUInt(MQTT_CBOR_STATUS_NTRIP_UPTIME_SEC, msg->ntrip_uptime_sec);
+    cbor.addUInt(MQTT_CBOR_STATUS_NTRIP_RECONNECTS, msg->ntrip_reconnects);
+    cbor.addUInt(MQTT_CBOR_STATUS_RTCM_PACKETS_TOTAL, msg->rtcm_packets_total);
+    cbor.addBool(MQTT_CBOR_STATUS_MQTT_CONNECTED, msg->mqtt_connected);
+    cbor.addUInt(MQTT_CBOR_STATUS_MQTT_UPTIME_SEC, msg->mqtt_uptime_sec);
+    cbor.addUInt(MQTT_CBOR_STATUS_MQTT_PUBLISHED, msg->mqtt_published);
+    cbor.addUInt(MQTT_CBOR_STATUS_WIFI_RECONNECTS, msg->wifi_reconnects);
+    cbor.addUInt(MQTT_CBOR_STATUS_CURRENT_FIX, msg->current_fix);
+    cbor.addUInt(MQTT_CBOR_STATUS_GNSS_BATCHES, msg->gnss_batches);
+    cbor.addUInt(MQTT_CBOR_STATUS_BATCHED_EPOCHS, msg->batched_epochs);
+    cbor.addUInt(MQTT_CBOR_STATUS_MESSAGES_SAVED, msg->messages_saved);
+    cbor.addInt(MQTT_CBOR_STATUS_BYTES_SAVED, msg->bytes_saved);
+    cbor.addUInt(MQTT_CBOR_STATUS_GNSS_EPOCHS, msg->gnss_epochs);
+    cbor.addUInt(MQTT_CBOR_STATUS_GNSS_AGE_AVG_US, msg->gnss_age_avg_us);
+    cbor.addUInt(MQTT_CBOR_STATUS_GNSS_AGE_MAX_US, msg->gnss_age_max_us);
+    cbor.addUInt(MQTT_CBOR_STATUS_GNSS_SUPPRESSED, msg->gnss_suppressed);
+    cbor.addUInt(MQTT_CBOR_STATUS_GNSS_SUPPRESSED_BYTES, msg->gnss_suppressed_bytes);
+    cbor.addUInt(MQTT_CBOR_STATUS_SIMPLIFIED_EPOCHS, msg->simplified_epochs);
+    cbor.addUInt(MQTT_CBOR_STATUS_OUTBOX_BACKLOG, msg->outbox_backlog);
+    cbor.addUInt(MQTT_CBOR_STATUS_OUTBOX_STORED, msg->outbox_stored);
+    cbor.addUInt(MQTT_CBOR_STATUS_OUTBOX_DRAINED, msg->outbox_drained);
+    cbor.addUInt(MQTT_CBOR_STATUS_OUTBOX_DROPPED, msg->outbox_dropped);
+    cbor.addUInt(MQTT_CBOR_STATUS_QOS_ACKED, msg->qos_acked);
+    cbor.addUInt(MQTT_CBOR_STATUS_QOS_DROPPED, msg->qos_dropped);
+    cbor.addUInt(MQTT_CBOR_STATUS_PUBACK_AVG_MS, msg->puback_avg_ms);
+    return cbor_length(cbor, size);
+}
+
+// Encode statistics message as CBOR (keys MQTT_CBOR_STATS_*)
+static size_t encode_stats_cbor(const mqtt_stats_message_t *msg, uint8_t *buffer, size_t size) {
+    CborWriter cbor(buffer, size);
+    cbor.beginMap(MQTT_CBOR_STATS_KEY_COUNT);
+    cbor.addUInt(MQTT_CBOR_STATS_VERSION, MQTT_CBOR_SCHEMA_VERSION);
+    cbor.addText(MQTT_CBOR_STATS_TIMESTAMP, msg->timestamp);
+    cbor.addUInt(MQTT_CBOR_STATS_PERIOD_DURATION, msg->period_duration);
+    cbor.addUInt(MQTT_CBOR_STATS_RTCM_BYTES_RECEIVED, msg->rtcm_bytes_received);
+    cbor.addUInt(MQTT_CBOR_STATS_RTCM_MESSAGE_RATE, msg->rtcm_message_rate);
+    cbor.addUInt(MQTT_CBOR_STATS_RTCM_DATA_GAPS, msg->rtcm_data_gaps);
+    cbor.addUInt(MQTT_CBOR_STATS_RTCM_AVG_LATENCY_MS, msg->rtcm_avg_latency_ms);
+    cbor.addUInt(MQTT_CBOR_STATS_RTCM_CORRUPTED, msg->rtcm_corrupted);
+
+    cbor.addUInt(MQTT_CBOR_STATS_MSM_SATELLITES);
+    cbor.beginArray(RTCM_CONSTELLATION_COUNT);
+    for (int i = 0; i < RTCM_CONSTELLATION_COUNT; i++) {
+        cbor.addUInt(msg->msm_satellites[i]);
+    }
+    cbor.addUInt(MQTT_CBOR_STATS_MSM_SIGNALS);
+    cbor.beginArray(RTCM_CONSTELLATION_COUNT);
+    for (int i = 0; i < RTCM_CONSTELLATION_COUNT; i++) {
+        cbor.addUInt(msg->msm_signals[i]);
+    }
+    cbor.addUInt(MQTT_CBOR_STATS_MSM_MESSAGE_RATE);
+    cbor.beginArray(RTCM_CONSTELLATION_COUNT);
+    for (int i = 0; i < RTCM_CONSTELLATION_COUNT; i++) {
+        cbor.addFloat(msg->msm_message_rate[i]);
+    }
+    size_t fix_states = sizeof(msg->fix_quality_duration) / sizeof(msg->fix_quality_duration[0]);
+    cbor.addUInt(MQTT_CBOR_STATS_FIX_QUALITY_DURATION);
+    cbor.beginArray(fix_states);
+    for (size_t i = 0; i < fix_states; i++) {
+        cbor.addUInt(msg->fix_quality_duration[i]);
+    }
+
+    cbor.addFloat(MQTT_CBOR_STATS_RTK_FIXED_PERCENT, msg->rtk_fixed_percent);
+    cbor.addUInt(MQTT_CBOR_STATS_TIME_TO_RTK_FIXED_SEC, msg->time_to_rtk_fixed_sec);
+    cbor.addUInt(MQTT_CBOR_STATS_FIX_DOWNGRADES, msg->fix_downgrades);
+    cbor.addUInt(MQTT_CBOR_STATS_FIX_UPGRADES, msg->fix_upgrades);
+    cbor.addFloat(MQTT_CBOR_STATS_HDOP_AVG, msg->hdop_avg);
+    cbor.addFloat(MQTT_CBOR_STATS_HDOP_MIN, msg->hdop_min);
+    cbor.addFloat(MQTT_CBOR_STATS_HDOP_MAX, msg->hdop_max);
+    cbor.addUInt(MQTT_CBOR_STATS_SATS_AVG, msg->sats_avg);
+    cbor.addFloat(MQTT_CBOR_STATS_BASELINE_DISTANCE_KM, msg->baseline_distance_km);
+    cbor.addUInt(MQTT_CBOR_STATS_GGA_SENT_COUNT, msg->gga_sent_count);
+    cbor.addUInt(MQTT_CBOR_STATS_GGA_FAILURES, msg->gga_failures);
+    cbor.addUInt(MQTT_CBOR_STATS_GGA_OVERFLOWS, msg->gga_overflows);
+    cbor.addUInt(MQTT_CBOR_STATS_GGA_VRS_REGENERATIONS, msg->gga_vrs_regenerations);
+    cbor.addInt(MQTT_CBOR_STATS_GGA_BYTES_SAVED, msg->gga_bytes_saved);
+    cbor.addInt(MQTT_CBOR_STATS_WIFI_RSSI_AVG, msg->wifi_rssi_avg);
+    cbor.addInt(MQTT_CBOR_STATS_WIFI_RSSI_MIN, msg->wifi_rssi_min);
+    cbor.addInt(MQTT_CBOR_STATS_WIFI_RSSI_MAX, msg->wifi_rssi_max);
+    cbor.addFloat(MQTT_CBOR_STATS_WIFI_UPTIME_PERCENT, msg->wifi_uptime_percent);
+    cbor.addUInt(MQTT_CBOR_STATS_GNSS_UPDATE_RATE_HZ, msg->gnss_update_rate_hz);
+    cbor.addUInt(MQTT_CBOR_STATS_NMEA_ERRORS, msg->nmea_errors);
+    cbor.addUInt(MQTT_CBOR_STATS_UART_ERRORS, msg->uart_errors);
+    cbor.addUInt(MQTT_CBOR_STATS_RTCM_QUEUE_OVERFLOWS, msg->rtcm_queue_overflows);
+    cbor.addUInt(MQTT_CBOR_STATS_NTRIP_TIMEOUTS, msg->ntrip_timeouts);
+
+    cbor.addUInt(MQTT_CBOR_STATS_QUANTILES);
+    cbor.beginArray(STATS_METRIC_COUNT);
+    for (int m = 0; m < STATS_METRIC_COUNT; m++) {
+        cbor.beginArray(STATS_QUANTILE_COUNT);
+        for (int q = 0; q < STATS_QUANTILE_COUNT; q++) {
+            cbor.addFloat(msg->quantiles[m][q]);
+        }
+    }
+    cbor.addUInt(MQTT_CBOR_STATS_HISTOGRAMS);
+    cbor.beginArray(STATS_METRIC_COUNT);
+    for (int m = 0; m < STATS_METRIC_COUNT; m++) {
+        const statistics_histogram_t *histogram = &msg->histograms[m];
+        size_t bins = histogram->bins < STATS_HISTOGRAM_MAX_BINS ? histogram->bins : STATS_HISTOGRAM_MAX_BINS;
+        cbor.beginArray(2 + 2 * bins);
+        cbor.addUInt(histogram->count);
+        cbor.addUInt(histogram->shift);
+        for (size_t i = 0; i < bins; i++) {
+            cbor.addUInt(histogram->gaps[i]);
+            cbor.addUInt(histogram->counts[i]);
+        }
+    }
+    cbor.addUInt(MQTT_CBOR_STATS_POSITION);
+    cbor.beginArray(10);
+    cbor.addUInt(msg->position.samples);
+    cbor.addDouble(msg->position.mean_latitude);
+    cbor.addDouble(msg->position.mean_longitude);
+    cbor.addFloat(msg->position.mean_altitude_m);
+    cbor.addFloat(msg->position.std_east_m);
+    cbor.addFloat(msg->position.std_north_m);
+    cbor.addFloat(msg->position.std_up_m);
+    cbor.addFloat(msg->position.cep50_m);
+    cbor.addFloat(msg->position.cep95_m);
+    cbor.addFloat(msg->position.drms2_m);
+    return cbor_length(cbor, size);
+}
+
+// Map pre-parsed GNSS data to the MQTT message structure (num is set by the caller)
+static void fill_gnss_message(const gnss_data_t *gnss_data, mqtt_gnss_message_t *msg) {
+    msg->lat = gnss_data->latitude;
+    msg->lon = gnss_data->longitude;
+    msg->alt = gnss_data->altitude;
+    msg->fix_type = gnss_data->fix_quality;
+    msg->speed = gnss_data->speed;
+    msg->dir = gnss_data->heading;
+    msg->sats = gnss_data->satellites;
+    msg->hdop = gnss_data->hdop;
+    msg->age = gnss_data->dgps_age;  // Age of differential data from GGA field 13
+    
+    // Format timestamp as ISO 8601
+    snprintf(msg->daytime, sizeof(msg->daytime),
+             "%04d-%02d-%02d %02d:%02d:%02d.%03d",
+             2000 + gnss_data->year, gnss_data->month, gnss_data->day,
+             gnss_data->hour, gnss_data->minute, gnss_data->second, gnss_data->millisecond);
+}
+
+// UTC time of day of the GNSS epoch in milliseconds
+static uint32_t gnss_time_of_day_ms(const gnss_data_t *gnss_data) {
+    return ((gnss_data->hour * 60u + gnss_data->minute) * 60u + gnss_data->second) * 1000u
+           + gnss_data->millisecond;
+}
+
+// Apply the GNSS publish policy: every Nth epoch, else the ms or the seconds interval
+static void configure_gnss_publish(const mqtt_config_t *config) {
+    uint32_t interval_ms = config->gnss_interval_sec * 1000u;
+    if (config->gnss_interval_ms > 0) {
+        interval_ms = config->gnss_interval_ms;
+        if (interval_ms < MQTT_GNSS_INTERVAL_MIN_MS) {
+            interval_ms = MQTT_GNSS_INTERVAL_MIN_MS;
+        } else if (interval_ms > MQTT_GNSS_INTERVAL_MAX_MS) {
+            interval_ms = MQTT_GNSS_INTERVAL_MAX_MS;
+        }
+    }
+    gnss_scheduler.configure(interval_ms, config->gnss_every_n);
+}
+
+// Publish the GNSS epoch just received if the publish policy selects it
+static void publish_gnss_epoch(const mqtt_config_t *config) {
+    gnss_data_t gnss_data;
+    gnss_get_data(&gnss_data);
+    if (!gnss_scheduler.onEpoch(gnss_time_of_day_ms(&gnss_data))) {
+        return;
+    }
+    if (!gnss_data.valid) {
+        ESP_LOGD(TAG, "No valid GNSS data, skipping GNSS publish");
+        return;
+    }
+    
+    mqtt_gnss_message_t gnss_msg = {};
+    fill_gnss_message(&gnss_data, &gnss_msg);
+    gnss_msg.num = message_counter + 1;
+    
+    // Format, then publish unless the deadband filter suppresses it
+    size_t length = (config->gnss_encoding == MQTT_ENCODING_CBOR)
+        ? encode_gnss_cbor(&gnss_msg, (uint8_t *)publish_buffer, sizeof(publish_buffer))
+        : format_gnss_json(&gnss_msg, publish_buffer, sizeof(publish_buffer));
+    
+    char topic[128];
+    snprintf(topic, sizeof(topic), "%s/GNSS", config->topic);
+    if (!gnss_deadband_pass(config, &gnss_data, mqtt_publish_packet_size(strlen(topic), length))) {
+        return;
+    }
+    message_counter++;
+    
+    if (mqtt_connected && mqtt_publish_message(topic, length, config->gnss_qos)) {
+        uint32_t age_us = (uint32_t)(esp_timer_get_time() - gnss_data.epoch_time_us);
+        gnss_scheduler.recordSampleAge(age_us);
+        total_published++;
+        led_update_mqtt_activity();  // Blink LED on publish
+        ESP_LOGD(TAG, "Published GNSS #%lu to %s (sample age %lu us)", message_counter, topic, age_us);
+    } else if (config->outbox_enabled && outbox_store(OUTBOX_TAG_GNSS, length)) {
+        ESP_LOGD(TAG, "Stored GNSS #%lu in the outbox (%lu waiting)", message_counter, outbox.getRecords());
+    } else {
+        ESP_LOGE(TAG, "Failed to publish GNSS message");
+    }
+}
+
+// Apply the deadband and heartbeat; the next position is published at once
+static void configure_gnss_deadband(const mqtt_config_t *config) {
+    uint32_t heartbeat_ms = (config->gnss_heartbeat_sec > 0 ? config->gnss_heartbeat_sec : 1) * 1000u;
+    gnss_deadband.configure(config->gnss_deadband_m, 0, heartbeat_ms);
+    gnss_deadband.reset();
+}
+
+// Deadband filter for one GNSS message of packet_size bytes; true if it is to be published
+static bool gnss_deadband_pass(const mqtt_config_t *config, const gnss_data_t *gnss_data, size_t packet_size) {
+    if (config->gnss_deadband_m == 0) {
+        return true;
+    }
+    
+    deadband_stats.evaluated++;
+    GgaSendReason reason = gnss_deadband.evaluate((uint32_t)(esp_timer_get_time() / 1000),
+                                                  gnss_data->latitude, gnss_data->longitude,
+                                                  gnss_data->fix_quality, packet_size);
+    switch (reason) {
+        case GGA_SEND_NONE:
+            deadband_stats.suppressed++;
+            deadband_stats.suppressed_bytes += packet_size;
+            return false;
+        case GGA_SEND_DISTANCE:
+            deadband_stats.moved++;
+            break;
+        case GGA_SEND_FIX_CHANGE:
+            deadband_stats.fix_changes++;
+            break;
+        case GGA_SEND_MAX_INTERVAL:
+            deadband_stats.heartbeats++;
+            break;
+        default:
+            break;
+    }
+    return true;
+}
+
+// Size of an MQTT 3.1.1 PUBLISH packet with QoS 0 (fixed header, topic, payload)
+static size_t mqtt_publish_packet_size(size_t topic_length, size_t payload_length) {
+    size_t remaining = 2 + topic_length + payload_length;
+    size_t length_bytes = 1;
+    for (size_t n = remaining; n >= 128; n /= 128) {
+        length_bytes++;
+    }
+    return 1 + length_bytes + remaining;
+}
+
+// Apply the batch limits; epochs already collected are dropped
+static void configure_gnss_batch(const mqtt_config_t *config) {
+    uint16_t latency_ms = config->gnss_batch_ms;
+    if (latency_ms < MQTT_GNSS_BATCH_MIN_MS) {
+        latency_ms = MQTT_GNSS_BATCH_MIN_MS;
+    } else if (latency_ms > MQTT_GNSS_BATCH_MAX_MS) {
+        latency_ms = MQTT_GNSS_BATCH_MAX_MS;
+    }
+    gnss_batch.configure(config->gnss_batch_size, latency_ms);
+    gnss_batch.reset();
+}
+
+// Add the current GNSS epoch to the batch if it is new
+static void sample_gnss_batch(const mqtt_config_t *config) {
+    gnss_data_t gnss_data;
+    gnss_get_data(&gnss_data);
+    if (!gnss_data.valid) {
+        return;
+    }
+    
+    GnssEpoch epoch = GnssBatch::quantize(gnss_time_of_day_ms(&gnss_data), gnss_data.latitude, gnss_data.longitude,
+                                          gnss_data.altitude, gnss_data.speed, gnss_data.heading,
+                                          gnss_data.hdop, gnss_data.dgps_age,
+                                          gnss_data.fix_quality, gnss_data.satellites);
+    if (gnss_batch.isRepeat(epoch.timeOfDayMs)) {
+        return;  // Same epoch as the last sample
+    }
+    
+    // Size of this epoch as a single GNSS message, for the savings counters
+    mqtt_gnss_message_t gnss_msg = {};
+    fill_gnss_message(&gnss_data, &gnss_msg);
+    gnss_msg.num = message_counter + 1;
+    size_t single_length = (config->gnss_encoding == MQTT_ENCODING_CBOR)
+        ? encode_gnss_cbor(&gnss_msg, (uint8_t *)publish_buffer, sizeof(publish_buffer))
+        : format_gnss_json(&gnss_msg, publish_buffer, sizeof(publish_buffer));
+    size_t single_packet = mqtt_publish_packet_size(strlen(config->topic) + strlen("/GNSS"), single_length);
+    if (!gnss_deadband_pass(config, &gnss_data, single_packet)) {
+        return;
+    }
+    
+    bool first = (gnss_batch.count() == 0);
+    if (gnss_batch.add(epoch, (uint32_t)(esp_timer_get_time() / 1000), single_packet) && first) {
+        memcpy(batch_daytime, gnss_msg.daytime, sizeof(batch_daytime));
+    }
+}
+
+// Publish the collected epochs as one message on <topic>/GNSS/batch
+static void publish_gnss_batch(const mqtt_config_t *config) {
+    uint8_t sampled = gnss_batch.count();
+    uint8_t simplified = gnss_batch.simplify(config->gnss_simplify_cm * 10u);
+    uint32_t num = ++message_counter;
+    size_t length = (config->gnss_encoding == MQTT_ENCODING_CBOR)
+        ? encode_gnss_batch_cbor(&gnss_batch, num, batch_daytime, (uint8_t *)publish_buffer, sizeof(publish_buffer))
+        : format_gnss_batch_json(&gnss_batch, num, batch_daytime, publish_buffer, sizeof(publish_buffer));
+    
+    char topic[128];
+    snprintf(topic, sizeof(topic), "%s/GNSS/batch", config->topic);
+    
+    if (mqtt_connected && mqtt_publish_message(topic, length, config->gnss_qos)) {
+        uint8_t epochs = gnss_batch.count();
+        total_published++;
+        batch_stats.batches++;
+        batch_stats.epochs += epochs;
+        batch_stats.messages_saved += sampled - 1;
+        batch_stats.simplified_epochs += simplified;
+        batch_stats.bytes_saved += (int64_t)gnss_batch.singleMessageBytes()
+                                   - (int64_t)mqtt_publish_packet_size(strlen(topic), length);
+        led_update_mqtt_activity();  // Blink LED on publish
+        ESP_LOGI(TAG, "Published GNSS batch #%lu (%u epochs, %u simplified away, %u bytes) to %s",
+                 num, epochs, simplified, (unsigned)length, topic);
+    } else if (config->outbox_enabled && outbox_store(OUTBOX_TAG_GNSS_BATCH, length)) {
+        ESP_LOGI(TAG, "Stored GNSS batch #%lu in the outbox (%lu waiting)", num, outbox.getRecords());
+    } else {
+        ESP_LOGE(TAG, "Failed to publish GNSS batch");
+    }
+    gnss_batch.clear();
+}
+
+// Flash access for the outbox ring (context is the partition)
+static bool outbox_flash_read(void *context, uint32_t address, void *data, size_t length) {
+    return esp_partition_read((const esp_partition_t *)context, address, data, length) == ESP_OK;
+}
+
+static bool outbox_flash_write(void *context, uint32_t address, const void *data, size_t length) {
+    return esp_partition_write((const esp_partition_t *)context, address, data, length) == ESP_OK;
+}
+
+static bool outbox_flash_erase(void *context, uint32_t address, size_t length) {
+    return esp_partition_erase_range((const esp_partition_t *)context, address, length) == ESP_OK;
+}
+
+// Mount the outbox; messages stored before a restart are drained after connecting
+static void outbox_init(void) {
+    const esp_partition_t *partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                                ESP_PARTITION_SUBTYPE_ANY,
+                                                                OUTBOX_PARTITION_LABEL);
+    if (partition == NULL) {
+        ESP_LOGW(TAG, "No '%s' partition, MQTT outbox not available", OUTBOX_PARTITION_LABEL);
+        return;
+    }
+    
+    FlashRingIo io = { outbox_flash_read, outbox_flash_write, outbox_flash_erase, (void *)partition };
+    outbox_ready = outbox.begin(io, OUTBOX_SECTOR_SIZE, partition->size / OUTBOX_SECTOR_SIZE);
+    if (!outbox_ready) {
+        ESP_LOGE(TAG, "Failed to mount the MQTT outbox");
+        return;
+    }
+    outbox_capacity = outbox.getCapacity();
+    outbox_backlog_peak = outbox.getRecords();
+    ESP_LOGI(TAG, "MQTT outbox: %lu bytes, %lu messages waiting, sector wear %lu erases",
+             outbox_capacity, outbox.getRecords(), outbox.getMaxSectorErases());
+}
+
+// Keep the message in the publish buffer for later
+static bool outbox_store(uint8_t tag, size_t length) {
+    if (!outbox_ready || !outbox.append(tag, (const uint8_t *)publish_buffer, length)) {
+        return false;
+    }
+    if (outbox.getRecords() > outbox_backlog_peak) {
+        outbox_backlog_peak = outbox.getRecords();
+    }
+    return true;
+}
+
+// Publish stored messages oldest first on <topic>/GNSS/backlog (or
+// <topic>/GNSS/batch/backlog), at most outbox_rate per second so live
+// messages keep their place
+static void outbox_drain(const mqtt_config_t *config) {
+    if (!outbox_ready || outbox.getRecords() == 0) {
+        return;
+    }
+    
+    uint16_t rate = config->outbox_rate;
+    if (rate < MQTT_OUTBOX_RATE_MIN) rate = MQTT_OUTBOX_RATE_MIN;
+    if (rate > MQTT_OUTBOX_RATE_MAX) rate = MQTT_OUTBOX_RATE_MAX;
+    
+    int64_t now_us = esp_timer_get_time();
+    if (outbox_drain_start_us == 0) {
+        outbox_drain_start_us = now_us;
+        outbox_drain_messages = 0;
+        outbox_tokens = 1.0f;
+    } else {
+        outbox_tokens += (now_us - outbox_last_refill_us) * rate / 1e6f;
+        if (outbox_tokens > rate) {
+            outbox_tokens = rate;
+        }
+    }
+    outbox_last_refill_us = now_us;
+    
+    // QoS 1: drained at the pace of the PUBACKs, live messages keep their place;
+    // the flash is not read while messages wait in the queue
+    bool qos_paced = config->gnss_qos == 1 && qos_buffer != NULL;
+    uint8_t tag;
+    size_t length;
+    while (outbox_tokens >= 1.0f && !(qos_paced && qos_queue.getQueued() > 0) &&
+           outbox.peek(&tag, (uint8_t *)publish_buffer, sizeof(publish_buffer), &length)) {
+        char topic[128];
+        snprintf(topic, sizeof(topic), (tag == OUTBOX_TAG_GNSS_BATCH) ? "%s/GNSS/batch/backlog" : "%s/GNSS/backlog",
+                 config->topic);
+        if (!mqtt_publish_message(topic, length, config->gnss_qos)) {
+            break;      // Retried on the next tick, the order is kept
+        }
+        outbox.pop();
+        outbox_tokens -= 1.0f;
+        outbox_drain_messages++;
+        total_published++;
+        led_update_mqtt_activity();  // Blink LED on publish
+    }
+    
+    if (outbox.getRecords() == 0) {
+        outbox_last_drain_messages = outbox_drain_messages;
+        outbox_last_drain_ms = (uint32_t)((now_us - outbox_drain_start_us) / 1000);
+        outbox_drain_start_us = 0;
+        ESP_LOGI(TAG, "MQTT outbox drained: %lu messages in %lu ms",
+                 outbox_last_drain_messages, outbox_last_drain_ms);
+    }
+}
+
+// Allocate the QoS 1 queue while a topic uses QoS 1; a new queue size drops
+// the queued messages and restarts the counters
+static void configure_qos(const mqtt_config_t *config) {
+    qos_levels[0] = config->gnss_qos;
+    qos_levels[1] = config->status_qos;
+    qos_levels[2] = config->stats_qos;
+    
+    uint8_t queue_kb = config->qos_queue_kb;
+    if (queue_kb < MQTT_QOS_QUEUE_MIN_KB) queue_kb = MQTT_QOS_QUEUE_MIN_KB;
+    if (queue_kb > MQTT_QOS_QUEUE_MAX_KB) queue_kb = MQTT_QOS_QUEUE_MAX_KB;
+    bool needed = config->gnss_qos == 1 || config->status_qos == 1 || config->stats_qos == 1;
+    uint32_t size = needed ? queue_kb * 1024u : 0;
+    if (size == qos_buffer_size && (size == 0 || qos_buffer != NULL)) {
+        qos_queue.setWindow(config->qos_window);
+        return;
+    }
+    
+    if (qos_buffer != NULL) {
+        free(qos_buffer);
+        qos_buffer = NULL;
+        qos_buffer_size = 0;
+    }
+    if (size > 0) {
+        qos_buffer = (uint8_t *)malloc(size);
+        if (qos_buffer == NULL) {
+            ESP_LOGE(TAG, "No memory for a %lu byte QoS 1 queue, publishing with QoS 0", size);
+        } else {
+            qos_buffer_size = size;
+            ESP_LOGI(TAG, "QoS 1 queue: %lu bytes, window %u", size, config->qos_window);
+        }
+    }
+    qos_queue.begin(qos_buffer, qos_buffer_size, config->qos_window);
+}
+
+// Publish the message in the publish buffer: QoS 0 at once, QoS 1 through the
+// queue (the oldest queued message is dropped when full) and the window
+static bool mqtt_publish_message(const char *topic, size_t length, uint8_t qos) {
+    if (qos == 0 || qos_buffer == NULL) {
+        TRACE_BEGIN(TRACE_MQTT_PUBLISH, length);
+        bool published = esp_mqtt_client_publish(mqtt_client, topic, publish_buffer, length, 0, 0) >= 0;
+        TRACE_END(TRACE_MQTT_PUBLISH, length);
+        return published;
+    }
+    if (!qos_queue.push(topic, (const uint8_t *)publish_buffer, length)) {
+        return false;
+    }
+    qos_service();
+    return true;
+}
+
+// Take the PUBACKs, then hand queued QoS 1 messages to the client while the
+// window has room
+static void qos_service(void) {
+    puback_event_t event;
+    while (puback_queue != NULL && xQueueReceive(puback_queue, &event, 0) == pdTRUE) {
+        if (event.deleted) {
+            qos_queue.released(event.msg_id);
+        } else {
+            qos_queue.acked(event.msg_id, event.time_us);
+        }
+    }
+    
+    uint32_t expired = qos_queue.expire(esp_timer_get_time(), QOS_ACK_TIMEOUT_US);
+    if (expired > 0) {
+        ESP_LOGW(TAG, "%lu QoS 1 messages without PUBACK, window slots freed", expired);
+    }
+    
+    while (mqtt_connected && qos_queue.canSend()) {
+        const char *topic;
+        const uint8_t *data;
+        size_t length;
+        qos_queue.front(&topic, &data, &length);
+        int64_t sent_us = esp_timer_get_time();
+        TRACE_BEGIN(TRACE_MQTT_PUBLISH, length);
+        int msg_id = esp_mqtt_client_publish(mqtt_client, topic, (const char *)data, length, 1, 0);
+        TRACE_END(TRACE_MQTT_PUBLISH, length);
+        if (msg_id < 0) {
+            break;      // Retried on the next tick, the order is kept
+        }
+        qos_queue.sent(msg_id, sent_us);
+    }
+}
+
+// Format batched GNSS message as JSON (base position, then one array per field)
+static size_t format_gnss_batch_json(const GnssBatch *batch, uint32_t num, const char *daytime, char *buffer, size_t size) {
+    uint8_t count = batch->count();
+    JsonWriter json(buffer, size);
+    json.beginObject();
+    json.addUInt("num", num);
+    json.addString("daytime", daytime);
+    json.addUInt("count", count);
+    if (count > 0) {
+        const GnssEpoch &base = batch->epoch(0);
+        json.addFixed("lat", base.latE7 / 1e7, 7);
+        json.addFixed("lon", base.lonE7 / 1e7, 7);
+        json.addFixed("alt", base.altMm / 1e3, 3);
+    }
+    
+    json.beginArray("t_ms");
+    for (uint8_t i = 0; i < count; i++) json.addItem(batch->timeOffsetMs(i));
+    json.endArray();
+    json.beginArray("dlat_e7");
+    for (uint8_t i = 0; i < count; i++) json.addItem(batch->latDelta(i));
+    json.endArray();
+    json.beginArray("dlon_e7");
+    for (uint8_t i = 0; i < count; i++) json.addItem(batch->lonDelta(i));
+    json.endArray();
+    json.beginArray("dalt_mm");
+    for (uint8_t i = 0; i < count; i++) json.addItem(batch->altDelta(i));
+    json.endArray();
+    json.beginArray("fix_type");
+    for (uint8_t i = 0; i < count; i++) json.addItem(batch->epoch(i).fixType);
+    json.endArray();
+    json.beginArray("sats");
+    for (uint8_t i = 0; i < count; i++) json.addItem(batch->epoch(i).sats);
+    json.endArray();
+    json.beginArray("speed_x100");
+    for (uint8_t i = 0; i < count; i++) json.addItem(batch->epoch(i).speedX100);
+    json.endArray();
+    json.beginArray("dir_x10");
+    for (uint8_t i = 0; i < count; i++) json.addItem(batch->epoch(i).dirX10);
+    json.endArray();
+    json.beginArray("hdop_x100");
+    for (uint8_t i = 0; i < count; i++) json.addItem(batch->epoch(i).hdopX100);
+    json.endArray();
+    json.beginArray("age_x100");
+    for (uint8_t i = 0; i < count; i++) json.addItem(batch->epoch(i).ageX100);
+    json.endArray();
+    json.endObject();
+    return json_length(json, size);
+}
+
+// Encode batched GNSS message as CBOR (keys MQTT_CBOR_BATCH_*)
+static size_t encode_gnss_batch_cbor(const GnssBatch *batch, uint32_t num, const char *daytime, uint8_t *buffer, size_t size) {
+    uint8_t count = batch->count();
+    int32_t lat = count > 0 ? batch->epoch(0).latE7 : 0;
+    int32_t lon = count > 0 ? batch->epoch(0).lonE7 : 0;
+    int32_t alt = count > 0 ? batch->epoch(0).altMm : 0;
+    
+    CborWriter cbor(buffer, size);
+    cbor.beginMap(MQTT_CBOR_BATCH_KEY_COUNT);
+    cbor.addUInt(MQTT_CBOR_BATCH_VERSION, MQTT_CBOR_SCHEMA_VERSION);
+    cbor.addUInt(MQTT_CBOR_BATCH_NUM, num);
+    cbor.addText(MQTT_CBOR_BATCH_DAYTIME, daytime);
+    cbor.addUInt(MQTT_CBOR_BATCH_COUNT, count);
+    cbor.addInt(MQTT_CBOR_BATCH_LAT_E7, lat);
+    cbor.addInt(MQTT_CBOR_BATCH_LON_E7, lon);
+    cbor.addInt(MQTT_CBOR_BATCH_ALT_MM, alt);
+    
+    cbor.addUInt(MQTT_CBOR_BATCH_T_MS);
+    cbor.beginArray(count);
+    for (uint8_t i = 0; i < count; i++) cbor.addUInt(batch->timeOffsetMs(i));
+    cbor.addUInt(MQTT_CBOR_BATCH_DLAT_E7);
+    cbor.beginArray(count);
+    for (uint8_t i = 0; i < count; i++) cbor.addInt(batch->latDelta(i));
+    cbor.addUInt(MQTT_CBOR_BATCH_DLON_E7);
+    cbor.beginArray(count);
+    for (uint8_t i = 0; i < count; i++) cbor.addInt(batch->lonDelta(i));
+    cbor.addUInt(MQTT_CBOR_BATCH_DALT_MM);
+    cbor.beginArray(count);
+    for (uint8_t i = 0; i < count; i++) cbor.addInt(batch->altDelta(i));
+    cbor.addUInt(MQTT_CBOR_BATCH_FIX_TYPE);
+    cbor.beginArray(count);
+    for (uint8_t i = 0; i < count; i++) cbor.addUInt(batch->epoch(i).fixType);
+    cbor.addUInt(MQTT_CBOR_BATCH_SATS);
+    cbor.beginArray(count);
+    for (uint8_t i = 0; i < count; i++) cbor.addUInt(batch->epoch(i).sats);
+    cbor.addUInt(MQTT_CBOR_BATCH_SPEED_X100);
+    cbor.beginArray(count);
+    for (uint8_t i = 0; i < count; i++) cbor.addUInt(batch->epoch(i).speedX100);
+    cbor.addUInt(MQTT_CBOR_BATCH_DIR_X10);
+    cbor.beginArray(count);
+    for (uint8_t i = 0; i < count; i++) cbor.addUInt(batch->epoch(i).dirX10);
+    cbor.addUInt(MQTT_CBOR_BATCH_HDOP_X100);
+    cbor.beginArray(count);
+    for (uint8_t i = 0; i < count; i++) cbor.addUInt(batch->epoch(i).hdopX100);
+    cbor.addUInt(MQTT_CBOR_BATCH_AGE_X100);
+    cbor.beginArray(count);
+    for (uint8_t i = 0; i < count; i++) cbor.addUInt(batch->epoch(i).ageX100);
+    return cbor_length(cbor, size);
 }
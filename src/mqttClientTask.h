@@ -5,6 +5,8 @@
 #include <stdbool.h>
 #include <time.h>
 #include "esp_err.h"
+#include "statisticsTask.h"
+#include "mqttCborSchema.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -44,8 +46,108 @@ typedef struct {
     uint32_t mqtt_published;     // Total messages published
     uint32_t wifi_reconnects;    // WiFi reconnect count
     uint8_t current_fix;         // Current GPS fix quality
+    uint32_t gnss_batches;       // Batched GNSS messages published
+    uint32_t batched_epochs;     // GNSS epochs published in batches
+    uint32_t messages_saved;     // MQTT messages saved by batching
+    int64_t bytes_saved;         // MQTT bytes saved by batching (packets incl. header and topic)
+    uint32_t gnss_epochs;        // GNSS epochs seen by the publisher
+    uint32_t gnss_age_avg_us;    // Average sample age of published GNSS messages
+    uint32_t gnss_age_max_us;    // Largest sample age of published GNSS messages
+    uint32_t gnss_suppressed;    // GNSS messages suppressed by the deadband filter
+    uint64_t gnss_suppressed_bytes; // MQTT packet bytes of those messages
+    uint32_t simplified_epochs;  // Batched epochs removed by track simplification
+    uint32_t outbox_backlog;     // GNSS messages waiting in the flash outbox
+    uint32_t outbox_stored;      // GNSS messages stored while disconnected
+    uint32_t outbox_drained;     // Stored messages published after reconnecting
+    uint32_t outbox_dropped;     // Stored messages overwritten in a full outbox
+    uint32_t qos_acked;          // QoS 1 messages acknowledged by the broker (PUBACK)
+    uint32_t qos_dropped;        // QoS 1 messages dropped from a full queue or never acknowledged
+    uint32_t puback_avg_ms;      // Average publish to PUBACK latency
 } mqtt_status_message_t;
 
+// Batched GNSS publishing counters (since boot)
+typedef struct {
+    uint32_t batches;            // Batched GNSS messages published
+    uint32_t epochs;             // Epochs in those messages
+    uint32_t messages_saved;     // Single GNSS messages not sent
+    int64_t bytes_saved;         // Single message packet bytes minus batch packet bytes
+    uint32_t simplified_epochs;  // Epochs removed by track simplification (not in epochs)
+} mqtt_batch_stats_t;
+
+// GNSS deadband filter counters (since boot); suppressed bytes are MQTT
+// packet bytes of the single GNSS messages that were not sent
+typedef struct {
+    uint32_t evaluated;          // GNSS messages presented to the filter
+    uint32_t suppressed;         // Not published: not moved, same fix, heartbeat not due
+    uint64_t suppressed_bytes;
+    uint32_t moved;              // Published after moving beyond the deadband
+    uint32_t fix_changes;        // Published on a fix quality change
+    uint32_t heartbeats;         // Published on the heartbeat timeout
+} mqtt_deadband_stats_t;
+
+// Store-and-forward outbox in the "outbox" flash partition; the counters are
+// since boot, except the backlog and max_sector_erases, which are kept in flash
+typedef struct {
+    bool available;              // Outbox partition found and mounted
+    uint32_t capacity_bytes;     // Partition size
+    uint32_t backlog;            // Messages waiting to be drained
+    uint32_t backlog_bytes;      // Payload bytes of those messages
+    uint32_t backlog_peak;       // Largest backlog since boot
+    uint32_t stored;             // Messages stored while disconnected
+    uint32_t drained;            // Stored messages published
+    uint32_t dropped;            // Stored messages overwritten in a full outbox
+    uint32_t corrupt;            // Stored messages skipped on a CRC error
+    uint32_t flash_errors;       // Failed flash writes and erases
+    uint32_t sector_erases;      // Sector erases since boot
+    uint32_t max_sector_erases;  // Highest erase count of any sector (flash wear)
+    uint64_t bytes_written;      // Bytes programmed since boot
+    uint32_t last_drain_messages; // Messages in the last completed drain
+    uint32_t last_drain_ms;      // Duration of the last completed drain
+    float last_drain_rate;       // Drain throughput in messages/sec
+} mqtt_outbox_stats_t;
+
+// PUBACK latency histogram buckets: 5, 10, 20, 50, 100, 200, 500, 1000, 2000,
+// 5000 ms and above
+#define MQTT_PUBACK_LATENCY_BUCKETS 11
+
+// QoS 1 publishing (since boot or the last change of the queue size): messages
+// wait in a RAM queue and at most window of them wait for their PUBACK
+typedef struct {
+    bool enabled;                // A topic uses QoS 1 and the queue is allocated
+    uint8_t gnss_qos;
+    uint8_t status_qos;
+    uint8_t stats_qos;
+    uint8_t window;              // Messages waiting for PUBACK at most
+    uint8_t in_flight;           // Messages waiting for PUBACK
+    uint8_t in_flight_peak;
+    uint32_t queued;             // Messages waiting for a window slot
+    uint32_t queued_bytes;       // Queue memory in use
+    uint32_t queued_peak_bytes;
+    uint32_t queue_limit_bytes;  // Queue memory ceiling
+    uint32_t client_outbox_bytes; // Memory held by the MQTT client outbox
+    uint32_t sent;               // Handed to the MQTT client
+    uint32_t acked;              // PUBACK received
+    uint32_t dropped;            // Pushed out of a full queue (oldest first)
+    uint32_t rejected;           // Larger than the whole queue
+    uint32_t lost;               // Deleted by the client or expired without PUBACK
+    uint32_t latency_min_ms;     // Publish to PUBACK latency
+    uint32_t latency_avg_ms;
+    uint32_t latency_max_ms;
+    uint32_t latency_last_ms;
+    uint32_t latency_bound_ms[MQTT_PUBACK_LATENCY_BUCKETS];  // Bucket upper bounds, 0 = no bound
+    uint32_t latency_count[MQTT_PUBACK_LATENCY_BUCKETS];
+} mqtt_qos_stats_t;
+
+// Epoch driven GNSS publishing (since boot); sample age is the time from
+// reception of the GGA to the publish call of a single GNSS message
+typedef struct {
+    uint32_t epochs;             // GNSS epochs seen while connected (or storing in the outbox)
+    uint32_t published;          // Single GNSS messages published
+    uint32_t sample_age_last_us;
+    uint32_t sample_age_avg_us;
+    uint32_t sample_age_max_us;
+} mqtt_gnss_timing_t;
+
 // Statistics message structure
 typedef struct {
     char timestamp[32];          // ISO 8601 timestamp
@@ -57,6 +159,9 @@ typedef struct {
     uint32_t rtcm_data_gaps;
     uint32_t rtcm_avg_latency_ms; // Average RTCM latency
     uint32_t rtcm_corrupted;     // Corrupted RTCM messages
+    uint8_t msm_satellites[RTCM_CONSTELLATION_COUNT];  // Satellites in last MSM epoch (GPS, GLO, GAL, BDS)
+    uint8_t msm_signals[RTCM_CONSTELLATION_COUNT];     // Signal types in last MSM epoch
+    float msm_message_rate[RTCM_CONSTELLATION_COUNT];  // MSM messages/sec per constellation
     
     // GNSS statistics (period)
     uint32_t fix_quality_duration[9]; // Seconds in each fix state
@@ -69,11 +174,14 @@ typedef struct {
     float hdop_max;              // Maximum HDOP
     uint8_t sats_avg;            // Average satellites
     float baseline_distance_km;  // Baseline distance to NTRIP caster
+    statistics_position_t position; // Measured position scatter
     
     // GGA transmission (period)
     uint32_t gga_sent_count;     // GGA messages sent
     uint32_t gga_failures;       // GGA send failures
     uint32_t gga_overflows;      // GGA queue overflows
+    uint32_t gga_vrs_regenerations; // GGA uploads after moving the distance threshold
+    int32_t gga_bytes_saved;     // GGA uplink bytes saved versus the fixed gga_interval_sec schedule
     
     // System health (period)
     int8_t wifi_rssi_avg;        // Average WiFi RSSI
@@ -87,6 +195,10 @@ typedef struct {
     uint32_t uart_errors;        // UART errors
     uint32_t rtcm_queue_overflows; // RTCM queue overflows
     uint32_t ntrip_timeouts;     // NTRIP timeouts
+    
+    // Distributions (period), order of statistics_metric_t
+    float quantiles[STATS_METRIC_COUNT][STATS_QUANTILE_COUNT]; // p10, p50, p90, p99
+    statistics_histogram_t histograms[STATS_METRIC_COUNT];     // Sparse histograms
 } mqtt_stats_message_t;
 
 /**
@@ -127,6 +239,41 @@ uint32_t mqtt_get_publish_count(void);
  */
 uint32_t mqtt_get_uptime_sec(void);
 
+/**
+ * @brief Get the batched GNSS publishing counters
+ * 
+ * @param stats Pointer to structure to fill
+ */
+void mqtt_get_batch_stats(mqtt_batch_stats_t *stats);
+
+/**
+ * @brief Get the GNSS epoch and sample age counters
+ * 
+ * @param timing Pointer to structure to fill
+ */
+void mqtt_get_gnss_timing(mqtt_gnss_timing_t *timing);
+
+/**
+ * @brief Get the GNSS deadband filter counters
+ * 
+ * @param stats Pointer to structure to fill
+ */
+void mqtt_get_deadband_stats(mqtt_deadband_stats_t *stats);
+
+/**
+ * @brief Get the store-and-forward outbox counters
+ * 
+ * @param stats Pointer to structure to fill
+ */
+void mqtt_get_outbox_stats(mqtt_outbox_stats_t *stats);
+
+/**
+ * @brief Get the QoS 1 queue, window and PUBACK latency counters
+ * 
+ * @param stats Pointer to structure to fill
+ */
+void mqtt_get_qos_stats(mqtt_qos_stats_t *stats);
+
 /**
  * @brief Update last activity timestamp for MQTT LED indicator
  * 
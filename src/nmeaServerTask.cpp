@@ -0,0 +1,598 @@
+/**
+ * @file nmeaServerTask.cpp
+ * @brief NMEA network server task implementation
+ *
+ * This task manages:
+ * - The TCP listening socket on the configured port
+ * - Streaming the shared NMEA buffer to all clients with non-blocking sends
+ * - Optional UDP broadcast of the same stream, several sentences per datagram
+ * - Dropping clients that fall behind instead of blocking the GNSS task
+ * - Configuration change monitoring via event groups
+ *
+ * All sockets are non-blocking and serviced from this single task with
+ * select(), so the number of clients does not add tasks or stacks.
+ */
+
+#include "nmeaServerTask.h"
+#include "lib/FanoutBuffer.h"
+#include "configurationManagerTask.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <freertos/event_groups.h>
+#include "lwip/sockets.h"
+#include <errno.h>
+#include <cstring>
+
+static const char* TAG = "NMEAServer";
+
+// Task configuration
+#define NMEA_SERVER_TASK_STACK_SIZE     4096
+#define NMEA_SERVER_TASK_PRIORITY       3
+
+// Buffer configuration: one block holds a standard sentence (82 characters),
+// longer proprietary sentences span two blocks. A client may fall
+// NMEA_SERVER_CLIENT_DEPTH blocks behind (about 1.5 s at 10 Hz with 8
+// sentences per epoch, plus the socket send buffer) before it is dropped
+#define NMEA_SERVER_BLOCK_SIZE          128
+#define NMEA_SERVER_CLIENT_DEPTH        128
+#define NMEA_SERVER_BLOCK_COUNT         (NMEA_SERVER_CLIENT_DEPTH + 32)
+
+#define NMEA_SERVER_LISTEN_BACKLOG      4
+#define NMEA_SERVER_SELECT_TIMEOUT_MS   20      // Upper bound on added forwarding latency
+#define NMEA_SERVER_RETRY_DELAY_MS      5000    // Retry delay when a socket cannot be opened
+
+// UDP datagrams carry whole sentences only; a sentence is at most
+// NMEA_LINE_MAX bytes including "\r\n"
+#define NMEA_UDP_DATAGRAM_SIZE          1024
+#define NMEA_LINE_MAX                   256
+
+typedef struct {
+    int fd;
+    int subscriber;
+} nmea_client_t;
+
+// Task handle
+static TaskHandle_t nmea_server_task_handle = NULL;
+
+// Shared NMEA buffer, protected by nmea_server_mutex
+static FanoutBuffer fanout;
+static SemaphoreHandle_t nmea_server_mutex = NULL;
+static volatile bool nmea_server_accepting = false;
+
+// Server state (owned by the server task)
+static int listen_fd = -1;
+static int udp_fd = -1;
+static int udp_subscriber = -1;
+static nmea_client_t clients[NMEA_SERVER_MAX_CLIENTS];
+static nmea_server_config_t active_config;
+static uint8_t udp_datagram[NMEA_UDP_DATAGRAM_SIZE];
+static size_t udp_datagram_len = 0;
+
+// Counters
+static nmea_server_stats_t server_stats;
+
+/**
+ * @brief Non-blocking send
+ * @return Bytes sent, 0 if the socket buffer is full, -1 on a fatal error
+ */
+static int nmea_server_send(int fd, const void* data, size_t length) {
+    int sent = send(fd, data, length, MSG_DONTWAIT);
+    if (sent < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;
+        }
+        return -1;
+    }
+    server_stats.bytes_out += sent;
+    return sent;
+}
+
+/**
+ * @brief Close a client and release its buffer subscription
+ */
+static void nmea_server_close_client(nmea_client_t* client) {
+    if (client->subscriber >= 0 &&
+        xSemaphoreTake(nmea_server_mutex, portMAX_DELAY) == pdTRUE) {
+        fanout.unsubscribe(client->subscriber);
+        xSemaphoreGive(nmea_server_mutex);
+        if (server_stats.clients > 0) {
+            server_stats.clients--;
+        }
+    }
+    if (client->fd >= 0) {
+        shutdown(client->fd, SHUT_RDWR);
+        close(client->fd);
+    }
+    client->fd = -1;
+    client->subscriber = -1;
+}
+
+/**
+ * @brief Close all sockets and free the shared buffer
+ */
+static void nmea_server_stop(void) {
+    nmea_server_accepting = false;
+    for (int i = 0; i < NMEA_SERVER_MAX_CLIENTS; i++) {
+        if (clients[i].fd >= 0) {
+            nmea_server_close_client(&clients[i]);
+        }
+    }
+    if (listen_fd >= 0) {
+        close(listen_fd);
+        listen_fd = -1;
+    }
+    if (udp_fd >= 0) {
+        close(udp_fd);
+        udp_fd = -1;
+    }
+    if (xSemaphoreTake(nmea_server_mutex, portMAX_DELAY) == pdTRUE) {
+        fanout.deinit();
+        xSemaphoreGive(nmea_server_mutex);
+    }
+    if (server_stats.tcp_running || server_stats.udp_running) {
+        ESP_LOGI(TAG, "NMEA server stopped");
+    }
+    udp_subscriber = -1;
+    udp_datagram_len = 0;
+    server_stats.tcp_running = false;
+    server_stats.udp_running = false;
+    server_stats.clients = 0;
+}
+
+/**
+ * @brief Open the TCP listening socket
+ */
+static bool nmea_server_open_listener(uint16_t port) {
+    listen_fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listen_fd < 0) {
+        ESP_LOGE(TAG, "Failed to create TCP socket: errno %d", errno);
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+
+    if (bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        listen(listen_fd, NMEA_SERVER_LISTEN_BACKLOG) != 0) {
+        ESP_LOGE(TAG, "Failed to listen on port %d: errno %d", port, errno);
+        close(listen_fd);
+        listen_fd = -1;
+        return false;
+    }
+    fcntl(listen_fd, F_SETFL, fcntl(listen_fd, F_GETFL, 0) | O_NONBLOCK);
+    return true;
+}
+
+/**
+ * @brief Open the UDP broadcast socket and subscribe it to the buffer
+ */
+static bool nmea_server_open_udp(void) {
+    udp_fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (udp_fd < 0) {
+        ESP_LOGE(TAG, "Failed to create UDP socket: errno %d", errno);
+        return false;
+    }
+
+    int broadcast = 1;
+    setsockopt(udp_fd, SOL_SOCKET, SO_BROADCAST, &broadcast, sizeof(broadcast));
+    fcntl(udp_fd, F_SETFL, fcntl(udp_fd, F_GETFL, 0) | O_NONBLOCK);
+
+    if (xSemaphoreTake(nmea_server_mutex, portMAX_DELAY) == pdTRUE) {
+        udp_subscriber = fanout.subscribe();
+        xSemaphoreGive(nmea_server_mutex);
+    }
+    if (udp_subscriber < 0) {
+        close(udp_fd);
+        udp_fd = -1;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Allocate the shared buffer and open the enabled sockets
+ */
+static bool nmea_server_start(const nmea_server_config_t* config) {
+    bool buffer_ok = false;
+    if (xSemaphoreTake(nmea_server_mutex, portMAX_DELAY) == pdTRUE) {
+        // One extra subscriber slot for the UDP broadcast
+        buffer_ok = fanout.init(NMEA_SERVER_BLOCK_COUNT, NMEA_SERVER_BLOCK_SIZE,
+                                config->max_clients + 1, NMEA_SERVER_CLIENT_DEPTH);
+        xSemaphoreGive(nmea_server_mutex);
+    }
+    if (!buffer_ok) {
+        ESP_LOGE(TAG, "Failed to allocate NMEA buffer (%d bytes)",
+                 NMEA_SERVER_BLOCK_COUNT * NMEA_SERVER_BLOCK_SIZE);
+        return false;
+    }
+
+    if (config->tcp_enabled) {
+        if (!nmea_server_open_listener(config->tcp_port)) {
+            nmea_server_stop();
+            return false;
+        }
+        server_stats.tcp_running = true;
+        ESP_LOGI(TAG, "NMEA TCP server listening on port %d (max %d clients)",
+                 config->tcp_port, config->max_clients);
+    }
+
+    if (config->udp_enabled) {
+        if (!nmea_server_open_udp()) {
+            nmea_server_stop();
+            return false;
+        }
+        server_stats.udp_running = true;
+        ESP_LOGI(TAG, "NMEA UDP broadcast on port %d", config->udp_port);
+    }
+
+    nmea_server_accepting = true;
+    return true;
+}
+
+/**
+ * @brief Accept all pending connections; clients are subscribed immediately
+ */
+static void nmea_server_accept_clients(void) {
+    while (1) {
+        struct sockaddr_in peer;
+        socklen_t peer_len = sizeof(peer);
+        int fd = accept(listen_fd, (struct sockaddr*)&peer, &peer_len);
+        if (fd < 0) {
+            return;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        int nodelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+        nmea_client_t* slot = NULL;
+        for (int i = 0; i < active_config.max_clients && i < NMEA_SERVER_MAX_CLIENTS; i++) {
+            if (clients[i].fd < 0) {
+                slot = &clients[i];
+                break;
+            }
+        }
+
+        int subscriber = -1;
+        if (slot != NULL && xSemaphoreTake(nmea_server_mutex, portMAX_DELAY) == pdTRUE) {
+            subscriber = fanout.subscribe();
+            xSemaphoreGive(nmea_server_mutex);
+        }
+        if (subscriber < 0) {
+            close(fd);
+            server_stats.rejected_total++;
+            ESP_LOGW(TAG, "Client refused, all %d slots in use", active_config.max_clients);
+            continue;
+        }
+
+        slot->fd = fd;
+        slot->subscriber = subscriber;
+        server_stats.clients++;
+        server_stats.connections_total++;
+        ESP_LOGI(TAG, "Client connected, %d connected", server_stats.clients);
+    }
+}
+
+/**
+ * @brief Send as much queued data as the socket accepts
+ *
+ * The oldest block is pinned under nmea_server_mutex and sent from the pool
+ * with the mutex released, so nmea_server_publish_line() never waits for a
+ * socket. The pin keeps the block alive if the client is evicted meanwhile.
+ *
+ * @param[out] evicted Set to true when the client was evicted for falling behind.
+ * @return false if the connection failed
+ */
+static bool nmea_server_flush_client(nmea_client_t* client, bool* evicted) {
+    *evicted = false;
+    while (1) {
+        const uint8_t* data = NULL;
+        size_t length = 0;
+        bool pinned = false;
+        if (xSemaphoreTake(nmea_server_mutex, portMAX_DELAY) == pdTRUE) {
+            *evicted = fanout.isEvicted(client->subscriber);
+            pinned = fanout.pin(client->subscriber, &data, &length);
+            xSemaphoreGive(nmea_server_mutex);
+        }
+        if (!pinned) {
+            return true;
+        }
+
+        int sent = nmea_server_send(client->fd, data, length);
+        if (xSemaphoreTake(nmea_server_mutex, portMAX_DELAY) == pdTRUE) {
+            fanout.consume(client->subscriber, sent > 0 ? sent : 0);
+            *evicted = fanout.isEvicted(client->subscriber);
+            xSemaphoreGive(nmea_server_mutex);
+        }
+        if (sent < 0) {
+            return false;
+        }
+        if (*evicted || (size_t)sent < length) {
+            return true;
+        }
+    }
+}
+
+/**
+ * @brief Send the collected sentences as one broadcast datagram
+ */
+static void nmea_server_send_datagram(void) {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_BROADCAST);
+    addr.sin_port = htons(active_config.udp_port);
+
+    // A full send buffer drops the datagram; UDP consumers tolerate loss
+    int sent = sendto(udp_fd, udp_datagram, udp_datagram_len, MSG_DONTWAIT,
+                      (struct sockaddr*)&addr, sizeof(addr));
+    if (sent > 0) {
+        server_stats.udp_datagrams++;
+        server_stats.bytes_out += sent;
+    }
+    udp_datagram_len = 0;
+}
+
+/**
+ * @brief Drain the UDP subscriber into datagrams of whole sentences
+ *
+ * Sentences are collected under nmea_server_mutex; sendto() runs after it is
+ * released. udp_datagram belongs to this task.
+ */
+static void nmea_server_flush_udp(void) {
+    bool datagram_full = true;
+    while (datagram_full) {
+        datagram_full = false;
+        if (xSemaphoreTake(nmea_server_mutex, portMAX_DELAY) != pdTRUE) {
+            return;
+        }
+        if (fanout.isEvicted(udp_subscriber)) {
+            fanout.unsubscribe(udp_subscriber);
+            udp_subscriber = fanout.subscribe();
+            udp_datagram_len = 0;
+        }
+
+        const uint8_t* data;
+        size_t length;
+        while (fanout.peek(udp_subscriber, &data, &length)) {
+            bool line_complete = udp_datagram_len == 0 || udp_datagram[udp_datagram_len - 1] == '\n';
+            if (line_complete && udp_datagram_len + NMEA_LINE_MAX > sizeof(udp_datagram)) {
+                datagram_full = true;
+                break;
+            }
+            memcpy(udp_datagram + udp_datagram_len, data, length);
+            udp_datagram_len += length;
+            fanout.consume(udp_subscriber, length);
+        }
+        xSemaphoreGive(nmea_server_mutex);
+
+        if (datagram_full) {
+            nmea_server_send_datagram();
+        }
+    }
+
+    if (udp_datagram_len > 0 && udp_datagram[udp_datagram_len - 1] == '\n') {
+        nmea_server_send_datagram();
+    }
+}
+
+/**
+ * @brief Service the listener, all clients and the broadcast once
+ */
+static void nmea_server_service(void) {
+    fd_set readfds;
+    FD_ZERO(&readfds);
+    int max_fd = -1;
+    if (listen_fd >= 0) {
+        FD_SET(listen_fd, &readfds);
+        max_fd = listen_fd;
+    }
+    for (int i = 0; i < NMEA_SERVER_MAX_CLIENTS; i++) {
+        if (clients[i].fd >= 0) {
+            FD_SET(clients[i].fd, &readfds);
+            if (clients[i].fd > max_fd) {
+                max_fd = clients[i].fd;
+            }
+        }
+    }
+
+    int ready = 0;
+    if (max_fd >= 0) {
+        struct timeval timeout;
+        timeout.tv_sec = 0;
+        timeout.tv_usec = NMEA_SERVER_SELECT_TIMEOUT_MS * 1000;
+        ready = select(max_fd + 1, &readfds, NULL, NULL, &timeout);
+        if (ready < 0) {
+            ESP_LOGW(TAG, "select failed: errno %d", errno);
+            vTaskDelay(pdMS_TO_TICKS(NMEA_SERVER_SELECT_TIMEOUT_MS));
+            return;
+        }
+    } else {
+        // UDP only: nothing to wait for but the next sentences
+        vTaskDelay(pdMS_TO_TICKS(NMEA_SERVER_SELECT_TIMEOUT_MS));
+    }
+
+    if (ready > 0 && listen_fd >= 0 && FD_ISSET(listen_fd, &readfds)) {
+        nmea_server_accept_clients();
+    }
+
+    for (int i = 0; i < NMEA_SERVER_MAX_CLIENTS; i++) {
+        nmea_client_t* client = &clients[i];
+        if (client->fd < 0) {
+            continue;
+        }
+
+        // Clients do not send anything meaningful; read to detect disconnects
+        if (ready > 0 && FD_ISSET(client->fd, &readfds)) {
+            char discard[64];
+            int received = recv(client->fd, discard, sizeof(discard), MSG_DONTWAIT);
+            if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+                ESP_LOGI(TAG, "Client disconnected, %d connected", server_stats.clients - 1);
+                nmea_server_close_client(client);
+                continue;
+            }
+        }
+
+        bool evicted = false;
+        bool ok = nmea_server_flush_client(client, &evicted);
+        if (evicted) {
+            server_stats.evicted_total++;
+            ESP_LOGW(TAG, "Client too slow, disconnected");
+            nmea_server_close_client(client);
+        } else if (!ok) {
+            ESP_LOGI(TAG, "Client connection lost");
+            nmea_server_close_client(client);
+        }
+    }
+
+    if (udp_fd >= 0) {
+        nmea_server_flush_udp();
+    }
+}
+
+/**
+ * @brief NMEA server task main function
+ */
+static void nmea_server_task(void* pvParameters) {
+    nmea_server_config_t config;
+    bool restart = true;
+    int64_t last_config_poll = 0;
+    int64_t retry_at = 0;
+
+    for (int i = 0; i < NMEA_SERVER_MAX_CLIENTS; i++) {
+        clients[i].fd = -1;
+        clients[i].subscriber = -1;
+    }
+
+    if (config_get_nmea_server(&config) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to get initial NMEA server configuration");
+        vTaskDelete(NULL);
+        return;
+    }
+
+    EventGroupHandle_t config_events = config_get_event_group();
+    ESP_LOGI(TAG, "NMEA Server Task started");
+
+    while (1) {
+        EventBits_t bits = xEventGroupGetBits(config_events);
+        if (bits & CONFIG_NMEA_SERVER_CHANGED_BIT) {
+            xEventGroupClearBits(config_events, CONFIG_NMEA_SERVER_CHANGED_BIT);
+            config_get_nmea_server(&config);
+            // Saving the web form rewrites every section; keep clients if nothing changed
+            if (memcmp(&config, &active_config, sizeof(config)) != 0) {
+                ESP_LOGI(TAG, "NMEA server configuration changed");
+                restart = true;
+            }
+        }
+
+        // Periodic config poll, other tasks may clear CONFIG_ALL_CHANGED_BIT first
+        int64_t now_us = esp_timer_get_time();
+        if ((now_us - last_config_poll) >= 1000000) {
+            last_config_poll = now_us;
+            nmea_server_config_t polled_config;
+            if (config_get_nmea_server(&polled_config) == ESP_OK &&
+                memcmp(&polled_config, &config, sizeof(config)) != 0) {
+                config = polled_config;
+                restart = true;
+            }
+        }
+
+        if (restart && now_us >= retry_at) {
+            restart = false;
+            nmea_server_stop();
+            active_config = config;
+            if (active_config.max_clients == 0 || active_config.max_clients > NMEA_SERVER_MAX_CLIENTS) {
+                active_config.max_clients = NMEA_SERVER_MAX_CLIENTS;
+            }
+            if ((active_config.tcp_enabled || active_config.udp_enabled) &&
+                !nmea_server_start(&active_config)) {
+                restart = true;
+                retry_at = now_us + (int64_t)NMEA_SERVER_RETRY_DELAY_MS * 1000;
+            }
+        }
+
+        if (listen_fd < 0 && udp_fd < 0) {
+            vTaskDelay(pdMS_TO_TICKS(1000));
+            continue;
+        }
+
+        nmea_server_service();
+    }
+}
+
+esp_err_t nmea_server_task_init(void) {
+    ESP_LOGI(TAG, "Initializing NMEA Server Task");
+
+    nmea_server_mutex = xSemaphoreCreateMutex();
+    if (nmea_server_mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create NMEA server mutex");
+        return ESP_ERR_NO_MEM;
+    }
+
+    BaseType_t result = xTaskCreate(
+        nmea_server_task,
+        "NMEA_Server",
+        NMEA_SERVER_TASK_STACK_SIZE,
+        NULL,
+        NMEA_SERVER_TASK_PRIORITY,
+        &nmea_server_task_handle
+    );
+
+    if (result != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create NMEA server task");
+        vSemaphoreDelete(nmea_server_mutex);
+        nmea_server_mutex = NULL;
+        return ESP_FAIL;
+    }
+
+    ESP_LOGI(TAG, "NMEA Server Task initialized successfully");
+    return ESP_OK;
+}
+
+void nmea_server_publish_line(const char* line, size_t length) {
+    if (!nmea_server_accepting || line == NULL || length == 0) {
+        return;
+    }
+
+    // Readers hold the mutex only to pin, consume or collect blocks, so no sentence is dropped
+    if (xSemaphoreTake(nmea_server_mutex, portMAX_DELAY) == pdTRUE) {
+        if (nmea_server_accepting) {
+            fanout.publish((const uint8_t*)line, length);
+            server_stats.lines_in++;
+        }
+        xSemaphoreGive(nmea_server_mutex);
+    }
+}
+
+void nmea_server_get_stats(nmea_server_stats_t* stats) {
+    if (stats == NULL) {
+        return;
+    }
+    memcpy(stats, &server_stats, sizeof(nmea_server_stats_t));
+}
+
+esp_err_t nmea_server_task_stop(void) {
+    ESP_LOGI(TAG, "Stopping NMEA Server Task");
+
+    if (nmea_server_task_handle != NULL) {
+        vTaskDelete(nmea_server_task_handle);
+        nmea_server_task_handle = NULL;
+    }
+
+    if (nmea_server_mutex != NULL) {
+        nmea_server_stop();
+        vSemaphoreDelete(nmea_server_mutex);
+        nmea_server_mutex = NULL;
+    }
+
+    ESP_LOGI(TAG, "NMEA Server Task stopped");
+    return ESP_OK;
+}
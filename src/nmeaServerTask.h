@@ -0,0 +1,84 @@
+/**
+ * @file nmeaServerTask.h
+ * @brief NMEA network server - forwards the raw receiver NMEA stream to LAN tools
+ *
+ * Every NMEA sentence from the GNSS receiver that passes the checksum check
+ * is published once into a shared reference counted buffer. The server task
+ * sends it from there to all TCP clients (port 10110 by default, the IEC
+ * 61162-450 style port used by OpenCPN, QGIS and similar tools) and, when
+ * enabled, as UDP broadcast datagrams.
+ *
+ * Clients that cannot keep up are disconnected; the GNSS receiver task never
+ * waits for a network client.
+ *
+ * @author ESP32-S3 NTRIP/GPS/MQTT System
+ * @date 2026
+ */
+
+#ifndef NMEA_SERVER_TASK_H
+#define NMEA_SERVER_TASK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <esp_err.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief NMEA server counters
+ */
+typedef struct {
+    bool tcp_running;             ///< TCP listening socket is open
+    bool udp_running;             ///< UDP broadcast socket is open
+    uint8_t clients;              ///< Currently connected TCP clients
+    uint32_t connections_total;   ///< TCP clients accepted since boot
+    uint32_t rejected_total;      ///< TCP clients refused because all slots were in use
+    uint32_t evicted_total;       ///< TCP clients dropped for falling behind
+    uint32_t lines_in;            ///< Validated sentences published to the server
+    uint32_t udp_datagrams;       ///< UDP broadcast datagrams sent
+    uint64_t bytes_out;           ///< Bytes sent to TCP clients and UDP broadcast
+} nmea_server_stats_t;
+
+/**
+ * @brief Initialize and start the NMEA server task
+ *
+ * The task monitors CONFIG_NMEA_SERVER_CHANGED_BIT and opens or closes the
+ * TCP listener and UDP broadcast socket when they are enabled or disabled.
+ *
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t nmea_server_task_init(void);
+
+/**
+ * @brief Publish one validated NMEA sentence to all network consumers
+ *
+ * Called from the GNSS receiver task for every sentence with a valid
+ * checksum. Returns immediately; the sentence is copied once into the shared
+ * buffer and sent by the server task.
+ *
+ * @param line Sentence including the terminating "\r\n"
+ * @param length Number of bytes
+ */
+void nmea_server_publish_line(const char* line, size_t length);
+
+/**
+ * @brief Get a snapshot of the NMEA server counters
+ *
+ * @param stats Pointer to structure to fill
+ */
+void nmea_server_get_stats(nmea_server_stats_t* stats);
+
+/**
+ * @brief Stop the NMEA server task, disconnect all clients and free the buffers
+ *
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t nmea_server_task_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NMEA_SERVER_TASK_H
@@ -0,0 +1,634 @@
+/**
+ * @file ntripCasterTask.cpp
+ * @brief Local NTRIP caster task implementation
+ *
+ * This task manages:
+ * - The listening socket on the configured port (NTRIP 1.0 and 2.0)
+ * - Request parsing, Basic authentication and the sourcetable
+ * - Streaming the shared RTCM buffer to all clients with non-blocking sends
+ * - Dropping clients that fall behind instead of blocking ingest
+ * - Configuration change monitoring via event groups
+ *
+ * All sockets are non-blocking and serviced from this single task with
+ * select(), so the number of clients does not add tasks or stacks.
+ */
+
+#include "ntripCasterTask.h"
+#include "NTRIPcaster/NTRIPCasterProtocol.h"
+#include "lib/FanoutBuffer.h"
+#include "configurationManagerTask.h"
+#include "gnssReceiverTask.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <freertos/event_groups.h>
+#include "lwip/sockets.h"
+#include <errno.h>
+#include <cstring>
+
+static const char* TAG = "NTRIPCaster";
+
+// Task configuration
+#define CASTER_TASK_STACK_SIZE      4096
+#define CASTER_TASK_PRIORITY        3
+
+// Buffer configuration: a client may fall CASTER_CLIENT_DEPTH blocks behind
+// (about 6 s of corrections at 10 reads/s) before it is dropped
+#define CASTER_BLOCK_SIZE           256
+#define CASTER_CLIENT_DEPTH         64
+#define CASTER_BLOCK_COUNT          (CASTER_CLIENT_DEPTH + 16)
+
+#define CASTER_LISTEN_BACKLOG       4
+#define CASTER_REQUEST_SIZE         384     // Request header limit per client
+#define CASTER_REQUEST_TIMEOUT_MS   5000    // Time allowed to send the request header
+#define CASTER_SELECT_TIMEOUT_MS    20      // Upper bound on added forwarding latency
+#define CASTER_RETRY_DELAY_MS       5000    // Retry delay when the listener cannot be opened
+#define CASTER_RESPONSE_SIZE        512
+
+typedef enum {
+    CLIENT_FREE = 0,
+    CLIENT_REQUEST,         // Waiting for the request header
+    CLIENT_STREAMING        // Subscribed to the RTCM buffer
+} caster_client_state_t;
+
+// NTRIP 2.0 chunked transfer state
+typedef enum {
+    CHUNK_IDLE = 0,
+    CHUNK_HEADER,
+    CHUNK_DATA,
+    CHUNK_TRAILER
+} caster_chunk_phase_t;
+
+typedef struct {
+    int fd;
+    caster_client_state_t state;
+    int version;
+    int subscriber;
+    int64_t accepted_us;
+    size_t request_len;
+    char request[CASTER_REQUEST_SIZE];
+    caster_chunk_phase_t chunk_phase;
+    char chunk_header[12];
+    uint8_t chunk_header_len;
+    uint8_t chunk_pos;          // Bytes of header or trailer already sent
+    size_t chunk_remaining;     // Payload bytes left in the current chunk
+} caster_client_t;
+
+// Task handle
+static TaskHandle_t caster_task_handle = NULL;
+
+// Shared RTCM buffer, protected by caster_mutex
+static FanoutBuffer fanout;
+static SemaphoreHandle_t caster_mutex = NULL;
+static volatile bool caster_accepting = false;
+
+// Server state (owned by the caster task)
+static int listen_fd = -1;
+static caster_client_t clients[CASTER_MAX_CLIENTS];
+static caster_config_t active_config;
+
+// Counters
+static ntrip_caster_stats_t caster_stats;
+
+/**
+ * @brief Non-blocking send
+ * @return Bytes sent, 0 if the socket buffer is full, -1 on a fatal error
+ */
+static int caster_send(int fd, const void* data, size_t length) {
+    int sent = send(fd, data, length, MSG_DONTWAIT);
+    if (sent < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;
+        }
+        return -1;
+    }
+    caster_stats.bytes_out += sent;
+    return sent;
+}
+
+/**
+ * @brief Send a short response header; a fresh socket buffer always holds it
+ */
+static bool caster_send_all(int fd, const char* data, size_t length) {
+    return caster_send(fd, data, length) == (int)length;
+}
+
+/**
+ * @brief Close a client and release its buffer subscription
+ */
+static void caster_close_client(caster_client_t* client) {
+    if (client->state == CLIENT_STREAMING &&
+        xSemaphoreTake(caster_mutex, portMAX_DELAY) == pdTRUE) {
+        fanout.unsubscribe(client->subscriber);
+        xSemaphoreGive(caster_mutex);
+        if (caster_stats.clients > 0) {
+            caster_stats.clients--;
+        }
+    }
+    if (client->fd >= 0) {
+        shutdown(client->fd, SHUT_RDWR);
+        close(client->fd);
+    }
+    memset(client, 0, sizeof(*client));
+    client->fd = -1;
+    client->subscriber = -1;
+}
+
+/**
+ * @brief Close the listener and all clients, free the shared buffer
+ */
+static void caster_stop_server(void) {
+    caster_accepting = false;
+    for (int i = 0; i < CASTER_MAX_CLIENTS; i++) {
+        if (clients[i].state != CLIENT_FREE) {
+            caster_close_client(&clients[i]);
+        }
+    }
+    if (listen_fd >= 0) {
+        close(listen_fd);
+        listen_fd = -1;
+        ESP_LOGI(TAG, "Caster stopped");
+    }
+    if (xSemaphoreTake(caster_mutex, portMAX_DELAY) == pdTRUE) {
+        fanout.deinit();
+        xSemaphoreGive(caster_mutex);
+    }
+    caster_stats.running = false;
+    caster_stats.clients = 0;
+}
+
+/**
+ * @brief Allocate the shared buffer and open the listening socket
+ */
+static bool caster_start_server(const caster_config_t* config) {
+    bool buffer_ok = false;
+    if (xSemaphoreTake(caster_mutex, portMAX_DELAY) == pdTRUE) {
+        buffer_ok = fanout.init(CASTER_BLOCK_COUNT, CASTER_BLOCK_SIZE,
+                                config->max_clients, CASTER_CLIENT_DEPTH);
+        xSemaphoreGive(caster_mutex);
+    }
+    if (!buffer_ok) {
+        ESP_LOGE(TAG, "Failed to allocate caster buffer (%d bytes)",
+                 CASTER_BLOCK_COUNT * CASTER_BLOCK_SIZE);
+        return false;
+    }
+
+    listen_fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listen_fd < 0) {
+        ESP_LOGE(TAG, "Failed to create socket: errno %d", errno);
+        caster_stop_server();
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(config->port);
+
+    if (bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        listen(listen_fd, CASTER_LISTEN_BACKLOG) != 0) {
+        ESP_LOGE(TAG, "Failed to listen on port %d: errno %d", config->port, errno);
+        caster_stop_server();
+        return false;
+    }
+    fcntl(listen_fd, F_SETFL, fcntl(listen_fd, F_GETFL, 0) | O_NONBLOCK);
+
+    caster_stats.running = true;
+    caster_accepting = true;
+    ESP_LOGI(TAG, "Caster listening on port %d, mountpoint /%s (max %d clients)",
+             config->port, config->mountpoint, config->max_clients);
+    return true;
+}
+
+/**
+ * @brief Accept all pending connections
+ */
+static void caster_accept_clients(void) {
+    while (1) {
+        struct sockaddr_in peer;
+        socklen_t peer_len = sizeof(peer);
+        int fd = accept(listen_fd, (struct sockaddr*)&peer, &peer_len);
+        if (fd < 0) {
+            return;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        int nodelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+        caster_client_t* slot = NULL;
+        for (int i = 0; i < active_config.max_clients && i < CASTER_MAX_CLIENTS; i++) {
+            if (clients[i].state == CLIENT_FREE) {
+                slot = &clients[i];
+                break;
+            }
+        }
+        if (slot == NULL) {
+            char response[CASTER_RESPONSE_SIZE];
+            size_t len = ntripFormatResponse(NTRIP_RESPONSE_UNAVAILABLE, 1, NULL, response, sizeof(response));
+            caster_send_all(fd, response, len);
+            close(fd);
+            caster_stats.rejected_total++;
+            ESP_LOGW(TAG, "Client refused, all %d slots in use", active_config.max_clients);
+            continue;
+        }
+
+        memset(slot, 0, sizeof(*slot));
+        slot->fd = fd;
+        slot->subscriber = -1;
+        slot->state = CLIENT_REQUEST;
+        slot->accepted_us = esp_timer_get_time();
+    }
+}
+
+/**
+ * @brief Read and answer the request header of a new client
+ */
+static void caster_handle_request(caster_client_t* client) {
+    int received = recv(client->fd, client->request + client->request_len,
+                        sizeof(client->request) - client->request_len, MSG_DONTWAIT);
+    if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+        caster_close_client(client);
+        return;
+    }
+    if (received > 0) {
+        client->request_len += received;
+    }
+
+    NtripRequest request;
+    NtripRequestStatus status = parseNtripRequest(client->request, client->request_len, &request);
+    if (status == NTRIP_REQUEST_INCOMPLETE) {
+        int64_t waited_ms = (esp_timer_get_time() - client->accepted_us) / 1000;
+        if (client->request_len < sizeof(client->request) && waited_ms < CASTER_REQUEST_TIMEOUT_MS) {
+            return;
+        }
+        status = NTRIP_REQUEST_INVALID;
+    }
+
+    char response[CASTER_RESPONSE_SIZE];
+    size_t len;
+    if (status == NTRIP_REQUEST_INVALID) {
+        len = ntripFormatResponse(NTRIP_RESPONSE_BAD_REQUEST, 2, NULL, response, sizeof(response));
+        caster_send_all(client->fd, response, len);
+        caster_stats.rejected_total++;
+        caster_close_client(client);
+        return;
+    }
+
+    client->version = request.version;
+    bool authenticate = active_config.user[0] != '\0';
+
+    // Empty or unknown mountpoint: sourcetable (NTRIP 1.0) or 404 (NTRIP 2.0)
+    if (strcmp(request.mountpoint, active_config.mountpoint) != 0) {
+        if (request.mountpoint[0] == '\0' || request.version < 2) {
+            gnss_data_t gnss;
+            gnss_get_data(&gnss);
+            len = ntripFormatSourcetable(request.version, active_config.mountpoint, authenticate,
+                                         gnss.latitude, gnss.longitude, response, sizeof(response));
+        } else {
+            len = ntripFormatResponse(NTRIP_RESPONSE_NOT_FOUND, request.version, NULL,
+                                      response, sizeof(response));
+            caster_stats.rejected_total++;
+        }
+        caster_send_all(client->fd, response, len);
+        caster_close_client(client);
+        return;
+    }
+
+    if (!ntripCheckAuthorization(&request, active_config.user, active_config.password)) {
+        len = ntripFormatResponse(NTRIP_RESPONSE_UNAUTHORIZED, request.version, active_config.mountpoint,
+                                  response, sizeof(response));
+        caster_send_all(client->fd, response, len);
+        caster_stats.rejected_total++;
+        caster_close_client(client);
+        return;
+    }
+
+    // Subscribe before answering so no data published after the response is missed
+    int subscriber = -1;
+    if (xSemaphoreTake(caster_mutex, portMAX_DELAY) == pdTRUE) {
+        subscriber = fanout.subscribe();
+        xSemaphoreGive(caster_mutex);
+    }
+    len = ntripFormatResponse(NTRIP_RESPONSE_STREAM, request.version, NULL, response, sizeof(response));
+    if (subscriber < 0 || !caster_send_all(client->fd, response, len)) {
+        if (subscriber >= 0 && xSemaphoreTake(caster_mutex, portMAX_DELAY) == pdTRUE) {
+            fanout.unsubscribe(subscriber);
+            xSemaphoreGive(caster_mutex);
+        }
+        caster_close_client(client);
+        return;
+    }
+
+    client->subscriber = subscriber;
+    client->state = CLIENT_STREAMING;
+    client->chunk_phase = CHUNK_IDLE;
+    caster_stats.clients++;
+    caster_stats.connections_total++;
+    ESP_LOGI(TAG, "Client streaming /%s (NTRIP %d.0), %d connected",
+             active_config.mountpoint, request.version, caster_stats.clients);
+}
+
+/**
+ * @brief Send as much queued data as the socket accepts
+ *
+ * The oldest block is pinned under caster_mutex and sent straight from the
+ * pool with the mutex released; the mutex is taken again only to consume what
+ * was sent. The pin keeps the block alive if the publisher evicts the client
+ * during the send.
+ *
+ * @param[out] evicted Set to true when the client was evicted for falling behind.
+ * @return false if the connection failed
+ */
+static bool caster_flush_client(caster_client_t* client, bool* evicted) {
+    static const char chunk_trailer[] = "\r\n";
+
+    *evicted = false;
+    while (1) {
+        int sent;
+        switch (client->chunk_phase) {
+            case CHUNK_HEADER:
+                sent = caster_send(client->fd, client->chunk_header + client->chunk_pos,
+                                   client->chunk_header_len - client->chunk_pos);
+                if (sent < 0) return false;
+                client->chunk_pos += sent;
+                if (client->chunk_pos < client->chunk_header_len) return true;
+                client->chunk_phase = CHUNK_DATA;
+                continue;
+
+            case CHUNK_TRAILER:
+                sent = caster_send(client->fd, chunk_trailer + client->chunk_pos, 2 - client->chunk_pos);
+                if (sent < 0) return false;
+                client->chunk_pos += sent;
+                if (client->chunk_pos < 2) return true;
+                client->chunk_phase = CHUNK_IDLE;
+                continue;
+
+            default:
+                break;
+        }
+
+        // NTRIP 2.0 frames each buffer block as one HTTP chunk
+        bool chunk_start = client->version >= 2 && client->chunk_phase == CHUNK_IDLE;
+        const uint8_t* data = NULL;
+        size_t length = 0;
+        bool pinned = false;
+        if (xSemaphoreTake(caster_mutex, portMAX_DELAY) == pdTRUE) {
+            *evicted = fanout.isEvicted(client->subscriber);
+            if (chunk_start) {
+                fanout.peek(client->subscriber, &data, &length);
+            } else {
+                pinned = fanout.pin(client->subscriber, &data, &length);
+            }
+            xSemaphoreGive(caster_mutex);
+        }
+
+        if (chunk_start) {
+            if (length == 0) {
+                return true;
+            }
+            client->chunk_header_len = (uint8_t)ntripFormatChunkHeader(length, client->chunk_header);
+            client->chunk_pos = 0;
+            client->chunk_remaining = length;
+            client->chunk_phase = CHUNK_HEADER;
+            continue;
+        }
+        if (!pinned) {
+            return true;
+        }
+
+        sent = caster_send(client->fd, data, length);
+        if (xSemaphoreTake(caster_mutex, portMAX_DELAY) == pdTRUE) {
+            fanout.consume(client->subscriber, sent > 0 ? sent : 0);
+            *evicted = fanout.isEvicted(client->subscriber);
+            xSemaphoreGive(caster_mutex);
+        }
+        if (sent < 0) return false;
+        if (*evicted) {
+            return true;
+        }
+        if (client->version >= 2) {
+            client->chunk_remaining -= sent;
+            if (client->chunk_remaining == 0) {
+                client->chunk_pos = 0;
+                client->chunk_phase = CHUNK_TRAILER;
+            }
+        }
+        if ((size_t)sent < length) {
+            return true;
+        }
+    }
+}
+
+/**
+ * @brief Service the listener and all clients once
+ */
+static void caster_service(void) {
+    fd_set readfds;
+    FD_ZERO(&readfds);
+    FD_SET(listen_fd, &readfds);
+    int max_fd = listen_fd;
+    for (int i = 0; i < CASTER_MAX_CLIENTS; i++) {
+        if (clients[i].state != CLIENT_FREE) {
+            FD_SET(clients[i].fd, &readfds);
+            if (clients[i].fd > max_fd) {
+                max_fd = clients[i].fd;
+            }
+        }
+    }
+
+    struct timeval timeout;
+    timeout.tv_sec = 0;
+    timeout.tv_usec = CASTER_SELECT_TIMEOUT_MS * 1000;
+    int ready = select(max_fd + 1, &readfds, NULL, NULL, &timeout);
+    if (ready < 0) {
+        ESP_LOGW(TAG, "select failed: errno %d", errno);
+        vTaskDelay(pdMS_TO_TICKS(CASTER_SELECT_TIMEOUT_MS));
+        return;
+    }
+
+    if (ready > 0 && FD_ISSET(listen_fd, &readfds)) {
+        caster_accept_clients();
+    }
+
+    for (int i = 0; i < CASTER_MAX_CLIENTS; i++) {
+        caster_client_t* client = &clients[i];
+        if (client->state == CLIENT_REQUEST) {
+            if (ready > 0 && FD_ISSET(client->fd, &readfds)) {
+                caster_handle_request(client);
+            } else if ((esp_timer_get_time() - client->accepted_us) / 1000 >= CASTER_REQUEST_TIMEOUT_MS) {
+                caster_stats.rejected_total++;
+                caster_close_client(client);
+            }
+            continue;
+        }
+        if (client->state != CLIENT_STREAMING) {
+            continue;
+        }
+
+        // Clients may send GGA upstream; it is not used and is discarded
+        if (ready > 0 && FD_ISSET(client->fd, &readfds)) {
+            char discard[128];
+            int received = recv(client->fd, discard, sizeof(discard), MSG_DONTWAIT);
+            if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+                ESP_LOGI(TAG, "Client disconnected, %d connected", caster_stats.clients - 1);
+                caster_close_client(client);
+                continue;
+            }
+        }
+
+        bool evicted = false;
+        bool ok = caster_flush_client(client, &evicted);
+        if (evicted) {
+            caster_stats.evicted_total++;
+            ESP_LOGW(TAG, "Client too slow, disconnected");
+            caster_close_client(client);
+        } else if (!ok) {
+            ESP_LOGI(TAG, "Client connection lost");
+            caster_close_client(client);
+        }
+    }
+}
+
+/**
+ * @brief Local NTRIP caster task main function
+ */
+static void ntrip_caster_task(void* pvParameters) {
+    caster_config_t config;
+    bool restart = true;
+    int64_t last_config_poll = 0;
+    int64_t retry_at = 0;
+
+    for (int i = 0; i < CASTER_MAX_CLIENTS; i++) {
+        clients[i].fd = -1;
+        clients[i].subscriber = -1;
+    }
+
+    if (config_get_caster(&config) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to get initial caster configuration");
+        vTaskDelete(NULL);
+        return;
+    }
+
+    EventGroupHandle_t config_events = config_get_event_group();
+    ESP_LOGI(TAG, "NTRIP Caster Task started");
+
+    while (1) {
+        EventBits_t bits = xEventGroupGetBits(config_events);
+        if (bits & CONFIG_CASTER_CHANGED_BIT) {
+            xEventGroupClearBits(config_events, CONFIG_CASTER_CHANGED_BIT);
+            config_get_caster(&config);
+            // Saving the web form rewrites every section; keep clients if nothing changed
+            if (memcmp(&config, &active_config, sizeof(config)) != 0) {
+                ESP_LOGI(TAG, "Caster configuration changed");
+                restart = true;
+            }
+        }
+
+        // Periodic config poll, other tasks may clear CONFIG_ALL_CHANGED_BIT first
+        int64_t now_us = esp_timer_get_time();
+        if ((now_us - last_config_poll) >= 1000000) {
+            last_config_poll = now_us;
+            caster_config_t polled_config;
+            if (config_get_caster(&polled_config) == ESP_OK &&
+                memcmp(&polled_config, &config, sizeof(config)) != 0) {
+                config = polled_config;
+                restart = true;
+            }
+        }
+
+        if (restart && now_us >= retry_at) {
+            restart = false;
+            caster_stop_server();
+            active_config = config;
+            if (active_config.max_clients == 0 || active_config.max_clients > CASTER_MAX_CLIENTS) {
+                active_config.max_clients = CASTER_MAX_CLIENTS;
+            }
+            if (active_config.enabled && !caster_start_server(&active_config)) {
+                restart = true;
+                retry_at = now_us + (int64_t)CASTER_RETRY_DELAY_MS * 1000;
+            }
+        }
+
+        if (listen_fd < 0) {
+            vTaskDelay(pdMS_TO_TICKS(1000));
+            continue;
+        }
+
+        caster_service();
+    }
+}
+
+esp_err_t ntrip_caster_task_init(void) {
+    ESP_LOGI(TAG, "Initializing NTRIP Caster Task");
+
+    caster_mutex = xSemaphoreCreateMutex();
+    if (caster_mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create caster mutex");
+        return ESP_ERR_NO_MEM;
+    }
+
+    BaseType_t result = xTaskCreate(
+        ntrip_caster_task,
+        "NTRIP_Caster",
+        CASTER_TASK_STACK_SIZE,
+        NULL,
+        CASTER_TASK_PRIORITY,
+        &caster_task_handle
+    );
+
+    if (result != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create NTRIP caster task");
+        vSemaphoreDelete(caster_mutex);
+        caster_mutex = NULL;
+        return ESP_FAIL;
+    }
+
+    ESP_LOGI(TAG, "NTRIP Caster Task initialized successfully");
+    return ESP_OK;
+}
+
+void ntrip_caster_publish(const uint8_t* data, size_t length) {
+    if (!caster_accepting || data == NULL || length == 0) {
+        return;
+    }
+
+    // Readers hold the mutex only to pin or consume a block, so the wait is short and no data is dropped
+    if (xSemaphoreTake(caster_mutex, portMAX_DELAY) == pdTRUE) {
+        if (caster_accepting) {
+            fanout.publish(data, length);
+            caster_stats.bytes_in += length;
+        }
+        xSemaphoreGive(caster_mutex);
+    }
+}
+
+void ntrip_caster_get_stats(ntrip_caster_stats_t* stats) {
+    if (stats == NULL) {
+        return;
+    }
+    memcpy(stats, &caster_stats, sizeof(ntrip_caster_stats_t));
+}
+
+esp_err_t ntrip_caster_task_stop(void) {
+    ESP_LOGI(TAG, "Stopping NTRIP Caster Task");
+
+    if (caster_task_handle != NULL) {
+        vTaskDelete(caster_task_handle);
+        caster_task_handle = NULL;
+    }
+
+    if (caster_mutex != NULL) {
+        caster_stop_server();
+        vSemaphoreDelete(caster_mutex);
+        caster_mutex = NULL;
+    }
+
+    ESP_LOGI(TAG, "NTRIP Caster Task stopped");
+    return ESP_OK;
+}
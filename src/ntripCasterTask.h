@@ -0,0 +1,80 @@
+/**
+ * @file ntripCasterTask.h
+ * @brief Local NTRIP caster - re-serves the received RTCM stream to LAN clients
+ *
+ * The caster listens on a configurable TCP port and accepts NTRIP 1.0 and
+ * NTRIP 2.0 clients on a single mountpoint. RTCM data received by the NTRIP
+ * client task is published once into a shared reference counted buffer and
+ * sent to every connected client from that buffer without a copy per client.
+ *
+ * Clients that cannot keep up are disconnected; ingest from the upstream
+ * caster never waits for a local client.
+ *
+ * @author ESP32-S3 NTRIP/GPS/MQTT System
+ * @date 2026
+ */
+
+#ifndef NTRIP_CASTER_TASK_H
+#define NTRIP_CASTER_TASK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <esp_err.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Local caster counters
+ */
+typedef struct {
+    bool running;                 ///< Listening socket is open
+    uint8_t clients;              ///< Currently streaming clients
+    uint32_t connections_total;   ///< Clients that started streaming since boot
+    uint32_t rejected_total;      ///< Requests refused (auth, mountpoint, full, malformed)
+    uint32_t evicted_total;       ///< Clients dropped for falling behind
+    uint64_t bytes_in;            ///< RTCM bytes published to the caster
+    uint64_t bytes_out;           ///< Bytes sent to all clients (including chunk framing)
+} ntrip_caster_stats_t;
+
+/**
+ * @brief Initialize and start the local NTRIP caster task
+ *
+ * The task monitors CONFIG_CASTER_CHANGED_BIT and opens or closes the
+ * listening socket when the caster is enabled or disabled.
+ *
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t ntrip_caster_task_init(void);
+
+/**
+ * @brief Publish received RTCM data to all connected caster clients
+ *
+ * Called from the NTRIP client task for every read. Returns immediately;
+ * the data is copied once into the shared buffer and sent by the caster task.
+ *
+ * @param data RTCM bytes
+ * @param length Number of bytes
+ */
+void ntrip_caster_publish(const uint8_t* data, size_t length);
+
+/**
+ * @brief Get a snapshot of the caster counters
+ *
+ * @param stats Pointer to structure to fill
+ */
+void ntrip_caster_get_stats(ntrip_caster_stats_t* stats);
+
+/**
+ * @brief Stop the caster task, disconnect all clients and free the buffers
+ *
+ * @return ESP_OK on success, error code otherwise
+ */
+esp_err_t ntrip_caster_task_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NTRIP_CASTER_TASK_H
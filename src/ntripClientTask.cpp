@@ -5,16 +5,23 @@
  * This task wraps the NTRIPClient class and manages:
  * - Connection to NTRIP caster based on configuration
  * - Receiving RTCM correction data and forwarding to GNSS
- * - Receiving GGA position data and sending to NTRIP caster
+ * - Framing the RTCM stream to count messages and decode MSM coverage
+ * - Publishing the RTCM stream to the local caster
+ * - Sending GGA positions selected by the GNSS task's GGA scheduler to the caster
  * - Reconnection on disconnect with configurable delay
+ * - Optional TLS with session resumption on reconnect
  * - Configuration change monitoring via event groups
  */
 
 #include "ntripClientTask.h"
 #include "NTRIPclient/NTRIPClient.h"
+#include "RTCMparser/RTCMParser.h"
+#include "ntripCasterTask.h"
 #include "configurationManagerTask.h"
 #include "wifiManager.h"
 #include "statisticsTask.h"
+#include "traceRecorder.h"
+#include "gnssReceiverTask.h"
 #include "esp_log.h"
 #include "esp_timer.h"
 #include <freertos/event_groups.h>
@@ -36,14 +43,49 @@ static bool ntrip_connected = false;
 static time_t ntrip_connection_start = 0;
 static uint32_t ntrip_uptime_accumulated = 0;
 
+// TLS handshake counters, copied from the client after each connection attempt
+static ntrip_tls_stats_t ntrip_tls_stats;
+
 // Queue configuration
 #define RTCM_QUEUE_LENGTH   10  // Can buffer 10 RTCM messages
 #define GGA_QUEUE_LENGTH    5   // Can buffer 5 GGA sentences
 
-// Task configuration
-#define NTRIP_TASK_STACK_SIZE   8192
+// Task configuration (the TLS handshake runs on this stack)
+#define NTRIP_TASK_STACK_SIZE   10240
 #define NTRIP_TASK_PRIORITY     3
 
+/**
+ * @brief RTCM frame callback, collects MSM coverage for the statistics task
+ */
+static void on_rtcm_frame(const RTCMFrameInfo& info, void* context) {
+    rtcm_msm_update_t* update = (rtcm_msm_update_t*)context;
+    if (!info.isMsm || info.msm.constellation >= RTCM_CONSTELLATION_COUNT) {
+        return;
+    }
+    int index = info.msm.constellation;
+    update->msm_messages[index]++;
+    if (info.msm.epochComplete) {
+        update->epoch_complete[index] = true;
+        update->satellites[index] = info.msm.epochSatellites;
+        update->signals[index] = info.msm.epochSignals;
+    }
+}
+
+/**
+ * @brief Copy the TLS handshake counters of the client for other tasks
+ */
+static void update_tls_stats(const NTRIPClient* client, bool enabled) {
+    const NTRIPTlsStats& stats = client->getTlsStats();
+    ntrip_tls_stats.enabled = enabled;
+    ntrip_tls_stats.full_handshakes = stats.fullHandshakes;
+    ntrip_tls_stats.resumed_handshakes = stats.resumedHandshakes;
+    ntrip_tls_stats.failed_handshakes = stats.failedHandshakes;
+    ntrip_tls_stats.full_avg_ms = stats.fullHandshakes ? (uint32_t)(stats.fullTotalMs / stats.fullHandshakes) : 0;
+    ntrip_tls_stats.resumed_avg_ms = stats.resumedHandshakes ? (uint32_t)(stats.resumedTotalMs / stats.resumedHandshakes) : 0;
+    ntrip_tls_stats.last_ms = stats.lastHandshakeMs;
+    ntrip_tls_stats.last_resumed = stats.lastResumed;
+}
+
 /**
  * @brief NTRIP Client Task main function
  */
@@ -55,12 +97,20 @@ static void ntrip_client_task(void* pvParameters) {
         return;
     }
     
+    // Custom CA for TLS, allocated when TLS is first used (NULL = certificate bundle)
+    char* tls_ca = NULL;
+    bool tls_ca_loaded = false;
+    
     ntrip_config_t ntrip_config;
-    int64_t last_gga_time = 0;
     int64_t last_connect_attempt = 0;
     bool reconnect_needed = false;
     int64_t last_config_poll = 0; // microseconds
     
+    // RTCM framing runs over the received bytes in place, payloads are not copied
+    RTCMParser rtcm_parser;
+    rtcm_msm_update_t msm_update;
+    rtcm_parser.setFrameCallback(on_rtcm_frame, &msm_update);
+    
     ESP_LOGI(TAG, "NTRIP Client Task started");
     
     // Get initial configuration
@@ -75,6 +125,9 @@ static void ntrip_client_task(void* pvParameters) {
     EventGroupHandle_t config_events = config_get_event_group();
 
     while (1) {
+        // Loop time up to the delay; iterations that wait and continue are not reported
+        int64_t loop_start_us = esp_timer_get_time();
+        
         // Poll for configuration changes and clear handled bits (matches MQTT behavior)
         EventBits_t bits = xEventGroupGetBits(config_events);
         if (bits & CONFIG_NTRIP_CHANGED_BIT) {
@@ -82,6 +135,10 @@ static void ntrip_client_task(void* pvParameters) {
             xEventGroupClearBits(config_events, CONFIG_NTRIP_CHANGED_BIT);
             ESP_LOGI(TAG, "NTRIP configuration changed");
             
+            // Host or CA may have changed: reload the CA, start with a full handshake
+            tls_ca_loaded = false;
+            client->clearTlsSession();
+            
             // Get new configuration first
             if (config_get_ntrip(&ntrip_config) != ESP_OK) {
                 ESP_LOGE(TAG, "Failed to get updated NTRIP configuration");
@@ -106,6 +163,8 @@ static void ntrip_client_task(void* pvParameters) {
             xEventGroupClearBits(config_events, CONFIG_ALL_CHANGED_BIT);
             // Global config changed; refresh NTRIP config and apply changes similarly
             ESP_LOGI(TAG, "Global configuration changed; refreshing NTRIP settings");
+            tls_ca_loaded = false;
+            client->clearTlsSession();
             if (config_get_ntrip(&ntrip_config) != ESP_OK) {
                 ESP_LOGE(TAG, "Failed to get updated NTRIP configuration");
                 vTaskDelay(pdMS_TO_TICKS(5000));
@@ -167,8 +226,9 @@ static void ntrip_client_task(void* pvParameters) {
                 last_connect_attempt = now;
                 reconnect_needed = false;
                 
-                ESP_LOGI(TAG, "Connecting to NTRIP caster: %s:%d/%s", 
-                         ntrip_config.host, ntrip_config.port, ntrip_config.mountpoint);
+                ESP_LOGI(TAG, "Connecting to NTRIP caster: %s:%d/%s%s", 
+                         ntrip_config.host, ntrip_config.port, ntrip_config.mountpoint,
+                         ntrip_config.use_tls ? " (TLS)" : "");
                 
                 // Initialize client
                 if (!client->init()) {
@@ -177,6 +237,20 @@ static void ntrip_client_task(void* pvParameters) {
                     continue;
                 }
                 
+                // Select the transport; a custom CA replaces the certificate bundle
+                if (ntrip_config.use_tls && !tls_ca_loaded) {
+                    if (tls_ca == NULL) {
+                        tls_ca = (char*)malloc(NTRIP_TLS_CA_MAX_LEN);
+                    }
+                    if (tls_ca != NULL && config_get_ntrip_ca(tls_ca, NTRIP_TLS_CA_MAX_LEN) == ESP_OK) {
+                        ESP_LOGI(TAG, "Using custom CA certificate for the caster");
+                    } else if (tls_ca != NULL) {
+                        tls_ca[0] = '\0';
+                    }
+                    tls_ca_loaded = true;
+                }
+                client->setTls(ntrip_config.use_tls, tls_ca);
+                
                 // Convert port to int for NTRIPClient API (expects int&)
                 int port = ntrip_config.port;
                 
@@ -190,11 +264,15 @@ static void ntrip_client_task(void* pvParameters) {
                     connect_success = client->reqRaw(ntrip_config.host, port, 
                                                      ntrip_config.mountpoint);
                 }
+                update_tls_stats(client, ntrip_config.use_tls);
                 
                 if (connect_success && client->isConnected()) {
                     ntrip_connected = true;
+                    rtcm_parser.reset(); // New stream, discard partial frame state
                     ntrip_connection_start = time(NULL);
-                    last_gga_time = -1; // Set to -1 to trigger immediate GGA send on first message
+                    // Drop positions queued while disconnected and ask for a fresh one
+                    xQueueReset(gga_queue);
+                    gnss_request_gga();
                     ESP_LOGI(TAG, "Successfully connected to NTRIP caster, waiting for first GGA");
                 } else {
                     ESP_LOGW(TAG, "Failed to connect to NTRIP caster, will retry in %d seconds", 
@@ -236,14 +314,25 @@ static void ntrip_client_task(void* pvParameters) {
                     ntrip_connected = false;
                     reconnect_needed = true;
                 } else if (bytes_read > 0) {
+                    TRACE_INSTANT(TRACE_RTCM_READ, bytes_read);
                     rtcm_msg.length = bytes_read;
                     
-                    // Update statistics (assume 1 message per read for now)
-                    statistics_rtcm_received(bytes_read, 1);
+                    // Frame the data to count messages, MSM coverage and CRC errors
+                    memset(&msm_update, 0, sizeof(msm_update));
+                    uint32_t crc_errors_before = rtcm_parser.getCrcErrorCount();
+                    size_t frames = rtcm_parser.parse(rtcm_msg.data, bytes_read);
+                    
+                    // Update statistics
+                    statistics_rtcm_received(bytes_read, frames);
+                    statistics_rtcm_msm(&msm_update);
+                    statistics_rtcm_corrupted(rtcm_parser.getCrcErrorCount() - crc_errors_before);
                     
                     // Notify LED task of RTCM data activity
                     led_update_ntrip_activity();
                     
+                    // Re-serve to local caster clients (returns immediately)
+                    ntrip_caster_publish(rtcm_msg.data, bytes_read);
+                    
                     // Send to GNSS via queue (ring buffer behavior - drop oldest if full)
                     if (xQueueSend(rtcm_queue, &rtcm_msg, 0) != pdTRUE) {
                         // Queue full - remove oldest item and add new one (ring buffer)
@@ -264,38 +353,13 @@ static void ntrip_client_task(void* pvParameters) {
                 }
             }
             
-            // Check for GGA sentences to send
+            // Send GGA sentences selected by the GGA scheduler in the GNSS task
             gga_data_t gga_msg;
             if (xQueueReceive(gga_queue, &gga_msg, 0) == pdTRUE) {
-                // Send immediately if this is the first GGA (last_gga_time == -1)
-                // or if the interval has elapsed
-                int64_t now = esp_timer_get_time();
-                int64_t time_since_last_gga = (last_gga_time == -1) ? INT64_MAX : (now - last_gga_time) / 1000000;
-                
-                if (last_gga_time == -1 || time_since_last_gga >= ntrip_config.gga_interval_sec) {
-                    client->sendGGA(gga_msg.sentence);
-                    last_gga_time = now;
-                    if (time_since_last_gga == INT64_MAX) {
-                        ESP_LOGI(TAG, "Sent first GGA to NTRIP server, starting %d sec interval: %s", 
-                                 ntrip_config.gga_interval_sec, gga_msg.sentence);
-                    } else {
-                        ESP_LOGI(TAG, "Sent GGA to NTRIP server: %s", gga_msg.sentence);
-                    }
-                } else {
-                    ESP_LOGD(TAG, "GGA received but interval not elapsed yet (%lld/%d sec)", 
-                             time_since_last_gga, ntrip_config.gga_interval_sec);
-                }
-            } else {
-                // Send GGA periodically even if not received from GNSS (keep connection alive)
-                int64_t now = esp_timer_get_time();
-                int64_t time_since_last_gga = (now - last_gga_time) / 1000000;
-                
-                if (time_since_last_gga >= ntrip_config.gga_interval_sec) {
-                    // Send a dummy GGA to keep connection alive
-                    // In real implementation, GNSS task should be sending actual GGA
-                    last_gga_time = now;
-                    ESP_LOGD(TAG, "GGA interval elapsed (%d sec), waiting for GNSS data", 
-                             ntrip_config.gga_interval_sec);
+                bool sent = client->sendGGA(gga_msg.sentence);
+                statistics_gga_sent(sent);
+                if (sent) {
+                    ESP_LOGI(TAG, "Sent GGA to NTRIP server: %s", gga_msg.sentence);
                 }
             }
             
@@ -307,6 +371,8 @@ static void ntrip_client_task(void* pvParameters) {
             }
         }
         
+        statistics_loop_time(STATS_TASK_NTRIP, (uint32_t)(esp_timer_get_time() - loop_start_us));
+        
         // Task delay to prevent tight loop
         vTaskDelay(pdMS_TO_TICKS(100));
     }
@@ -371,6 +437,13 @@ uint32_t ntrip_get_uptime_sec(void) {
     return ntrip_uptime_accumulated;
 }
 
+void ntrip_client_get_tls_stats(ntrip_tls_stats_t* stats) {
+    if (stats == NULL) {
+        return;
+    }
+    memcpy(stats, &ntrip_tls_stats, sizeof(ntrip_tls_stats_t));
+}
+
 esp_err_t ntrip_client_task_stop(void) {
     ESP_LOGI(TAG, "Stopping NTRIP Client Task");
     
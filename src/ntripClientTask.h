@@ -40,6 +40,24 @@ typedef struct {
     char sentence[128]; ///< GGA sentence string (NMEA max ~82 chars)
 } gga_data_t;
 
+/**
+ * @brief TLS handshake counters of the caster connection
+ *
+ * Handshake times include the TCP connect. A resumed handshake reuses the
+ * session (session ID or ticket) of the previous connection and skips the
+ * certificate exchange and key agreement.
+ */
+typedef struct {
+    bool enabled;                 ///< TLS is configured for the caster connection
+    uint32_t full_handshakes;     ///< Handshakes with certificate exchange
+    uint32_t resumed_handshakes;  ///< Handshakes that resumed the previous session
+    uint32_t failed_handshakes;   ///< Connects or handshakes that failed
+    uint32_t full_avg_ms;         ///< Average full handshake time
+    uint32_t resumed_avg_ms;      ///< Average resumed handshake time
+    uint32_t last_ms;             ///< Last successful handshake time
+    bool last_resumed;            ///< Last handshake was resumed
+} ntrip_tls_stats_t;
+
 /**
  * @brief Initialize NTRIP client task and queues
  * 
@@ -78,6 +96,13 @@ static inline bool ntrip_is_connected(void) {
  */
 uint32_t ntrip_get_uptime_sec(void);
 
+/**
+ * @brief Get the TLS handshake counters of the caster connection
+ * 
+ * @param stats Pointer to structure to fill
+ */
+void ntrip_client_get_tls_stats(ntrip_tls_stats_t* stats);
+
 /**
  * @brief Stop NTRIP client task and cleanup resources
  * 
@@ -10,12 +10,25 @@
 #include "gnssReceiverTask.h"
 #include "ntripClientTask.h"
 #include "wifiManager.h"
+#include "lib/CpuLoad.h"
+#include "lib/GGAScheduler.h"
+#include "lib/JsonWriter.h"
+#include "lib/LogHistogram.h"
+#include "lib/LoopProfiler.h"
+#include "lib/OpenMetricsWriter.h"
+#include "lib/PositionScatter.h"
+#include "lib/StatCounters.h"
+#include "lib/TimeSeriesStore.h"
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <freertos/semphr.h>
 #include <esp_log.h>
 #include <esp_heap_caps.h>
+#include <esp_timer.h>
 #include <esp_wifi.h>
+#include <atomic>
+#include <math.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/time.h>
 #include <stdio.h>
@@ -23,9 +36,11 @@
 static const char *TAG = "StatsTask";
 
 // Task configuration
-#define STATS_TASK_STACK_SIZE   4096
+#define STATS_TASK_STACK_SIZE   6144    // Collectors, history row and the float summary log
 #define STATS_TASK_PRIORITY     1
 #define STATS_UPDATE_RATE_MS    1000
+#define STATS_SNAPSHOT_ATTEMPTS 4       // Reads per shard before yielding to a preempted producer
+#define STATS_SNAPSHOT_RETRIES  5       // Yields before the snapshot is skipped
 
 // Task handle
 static TaskHandle_t stats_task_handle = NULL;
@@ -34,6 +49,39 @@ static TaskHandle_t stats_task_handle = NULL;
 static system_statistics_t stats;
 static SemaphoreHandle_t stats_mutex = NULL;
 
+// Producers of the lock-free counters, one task each
+enum {
+    STATS_PRODUCER_NTRIP = 0,
+    STATS_PRODUCER_GNSS,
+    STATS_PRODUCER_COUNT
+};
+
+// Counters written by the producer hooks; runtime totals, period values are differences
+enum {
+    STATS_COUNTER_RTCM_BYTES = 0,
+    STATS_COUNTER_RTCM_MESSAGES,
+    STATS_COUNTER_RTCM_CORRUPTED,
+    STATS_COUNTER_MSM_MESSAGES,                                                       // Per constellation
+    STATS_COUNTER_MSM_SATELLITES = STATS_COUNTER_MSM_MESSAGES + RTCM_CONSTELLATION_COUNT,  // Last complete epoch
+    STATS_COUNTER_MSM_SIGNALS = STATS_COUNTER_MSM_SATELLITES + RTCM_CONSTELLATION_COUNT,   // Last complete epoch
+    STATS_COUNTER_GGA_SENT = STATS_COUNTER_MSM_SIGNALS + RTCM_CONSTELLATION_COUNT,
+    STATS_COUNTER_GGA_FAILURES,
+    STATS_COUNTER_GGA_LAST_SENT_TIME,
+    STATS_COUNTER_GGA_VRS_REGENERATIONS,
+    STATS_COUNTER_GGA_FIX_CHANGE_SENDS,
+    STATS_COUNTER_GGA_BYTES_SAVED,
+    STATS_COUNTER_FIX_UPGRADES,
+    STATS_COUNTER_FIX_DOWNGRADES,
+    STATS_COUNTER_COUNT
+};
+
+// Hot path counters: producers never take stats_mutex
+static StatCounters stat_counters(STATS_PRODUCER_COUNT, STATS_COUNTER_COUNT);
+static uint64_t counter_totals[STATS_COUNTER_COUNT];   // Last snapshot folded into stats
+static uint64_t counter_period_base[STATS_COUNTER_COUNT]; // Snapshot at the start of the period
+static int64_t counter_taken_us = 0;                     // Time of the snapshot in counter_totals
+static uint8_t reported_fix_quality = 0;               // GNSS task only
+
 // Configuration
 static statistics_config_t config = {
     .interval_sec = 60,
@@ -45,12 +93,74 @@ static statistics_config_t config = {
 // Internal state tracking
 static uint8_t last_fix_quality = 0;
 static time_t last_fix_quality_change = 0;
-static uint32_t hdop_sample_count = 0;
-static float hdop_sum = 0.0f;
-static uint32_t sat_sample_count = 0;
-static uint32_t sat_sum = 0;
-static int32_t rssi_sample_count = 0;
-static int32_t rssi_sum = 0;
+static float last_correction_age = 0.0f;    // 0 without differential corrections
+
+// Metric distributions, only used with stats_mutex held. The period histograms
+// are merged into the runtime ones at the end of every period.
+static LogHistogram period_histograms[STATS_METRIC_COUNT];
+static LogHistogram runtime_histograms[STATS_METRIC_COUNT];
+
+// Position scatter of the period, only used with stats_mutex held. Its
+// reference moves to the mean position at the end of every period.
+static PositionScatter position_scatter;
+static int64_t last_scatter_epoch_us = 0;   // GGA epoch last added
+
+// Loop durations, written lock-free by each instrumented task. The period
+// histograms and sums are only used with stats_mutex held.
+static LoopProfiler loop_profilers[STATS_TASK_COUNT];
+static std::atomic<TaskHandle_t> loop_task_handles[STATS_TASK_COUNT];  // Set by the tasks themselves
+static LogHistogram loop_histograms[STATS_TASK_COUNT];
+static uint64_t loop_sum_us[STATS_TASK_COUNT];
+
+// CPU usage per task from the run-time counters, only used with stats_mutex held
+static CpuLoad cpu_load;
+static statistics_tasks_t task_list;
+#if defined(CONFIG_FREERTOS_USE_TRACE_FACILITY) && defined(CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS)
+static TaskStatus_t task_status[CPU_LOAD_MAX_TASKS];
+#endif
+
+// Metric history, only used with stats_mutex held. The memory is allocated
+// once and kept, in PSRAM when available.
+static TimeSeriesStore history;
+static uint8_t* history_memory = NULL;
+static runtime_statistics_t history_base;   // Runtime totals at the previous row
+static uint32_t history_last_sec = 0;       // Time of the previous row
+
+// History metric names and decimals (order of statistics_history_metric_t)
+static const char* const history_metric_names[STATS_HISTORY_METRIC_COUNT] = {
+    "fix_quality", "no_fix_seconds", "gps_seconds", "dgps_seconds", "rtk_float_seconds",
+    "rtk_fixed_seconds", "fix_downgrades", "fix_upgrades", "satellites", "hdop", "accuracy_m",
+    "correction_age_seconds", "baseline_km", "rtcm_bytes", "rtcm_messages", "rtcm_corrupted",
+    "msm_satellites_gps", "msm_satellites_glonass", "msm_satellites_galileo", "msm_satellites_beidou",
+    "gga_sent", "gga_failures", "ntrip_connected_seconds", "wifi_rssi_dbm", "wifi_connected_seconds",
+    "heap_free_bytes", "heap_largest_block_bytes", "heap_min_free_bytes",
+    "cpu_core0_percent", "cpu_core1_percent"
+};
+static const uint8_t history_metric_decimals[STATS_HISTORY_METRIC_COUNT] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 3, 1, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1
+};
+
+// Short names of the instrumented tasks (order of statistics_task_id_t)
+static const char* const loop_task_names[STATS_TASK_COUNT] = {
+    "gnss", "ntrip", "data_output", "mqtt", "led"
+};
+
+// Quantiles reported per metric (order of the quantiles arrays)
+static const float quantile_levels[STATS_QUANTILE_COUNT] = {0.10f, 0.50f, 0.90f, 0.99f};
+
+// Histogram units per metric unit (order of statistics_metric_t)
+static const float metric_scales[STATS_METRIC_COUNT] = {100.0f, 1.0f, 1.0f, 10.0f};
+
+// Metric names and decimals for the JSON output (order of statistics_metric_t)
+static const char* const metric_names[STATS_METRIC_COUNT] = {
+    "hdop", "satellites", "wifi_rssi", "correction_age"
+};
+static const int metric_decimals[STATS_METRIC_COUNT] = {2, 0, 0, 1};
+
+// Constellation names for MSM statistics (order of RTCM_CONSTELLATION_COUNT arrays)
+static const char* const msm_constellation_names[RTCM_CONSTELLATION_COUNT] = {
+    "gps", "glonass", "galileo", "beidou"
+};
 
 /**
  * @brief Initialize statistics structures to zero
@@ -73,6 +183,120 @@ static void init_statistics(void) {
     stats.period.wifi_rssi_min = 0;
 }
 
+/**
+ * @brief Take a consistent snapshot of the producer counters (call without stats_mutex)
+ * 
+ * A producer preempted in the middle of an update by this task keeps its
+ * shard busy until this task yields, so the read is retried after a tick.
+ * The yields are the reason this runs before stats_mutex is taken.
+ * 
+ * @param totals Receives STATS_COUNTER_COUNT sums over all producers
+ * @return Time of the snapshot (esp_timer), 0 when it failed
+ */
+static int64_t read_counters(uint64_t* totals) {
+    for (int retry = 0; retry < STATS_SNAPSHOT_RETRIES; retry++) {
+        if (stat_counters.sum(totals, STATS_SNAPSHOT_ATTEMPTS)) {
+            return esp_timer_get_time();
+        }
+        vTaskDelay(1);
+    }
+    return 0;
+}
+
+/**
+ * @brief Fold a counter snapshot into the statistics (call with stats_mutex held)
+ * 
+ * Snapshots are taken by several tasks before they lock; one older than the
+ * snapshot already folded in is ignored, so the totals never go back and the
+ * period values never drop below the period base.
+ * 
+ * @param totals Snapshot from read_counters()
+ * @param taken_us Time returned by read_counters()
+ */
+static void apply_counters(const uint64_t* totals, int64_t taken_us) {
+    if (taken_us == 0 || taken_us < counter_taken_us) {
+        return;
+    }
+    counter_taken_us = taken_us;
+    memcpy(counter_totals, totals, sizeof(counter_totals));
+    
+    // Period value of a counter: difference to the snapshot at the start of the period
+#define PERIOD(counter) (totals[counter] - counter_period_base[counter])
+    
+    stats.runtime.rtcm_bytes_received_total = totals[STATS_COUNTER_RTCM_BYTES];
+    stats.runtime.rtcm_messages_received_total = (uint32_t)totals[STATS_COUNTER_RTCM_MESSAGES];
+    stats.runtime.rtcm_corrupted_count_total = (uint32_t)totals[STATS_COUNTER_RTCM_CORRUPTED];
+    stats.period.rtcm_bytes_received = (uint32_t)PERIOD(STATS_COUNTER_RTCM_BYTES);
+    stats.period.rtcm_messages_received = (uint32_t)PERIOD(STATS_COUNTER_RTCM_MESSAGES);
+    stats.period.rtcm_corrupted_count = (uint32_t)PERIOD(STATS_COUNTER_RTCM_CORRUPTED);
+    
+    for (int i = 0; i < RTCM_CONSTELLATION_COUNT; i++) {
+        stats.runtime.rtcm_msm_messages_total[i] = (uint32_t)totals[STATS_COUNTER_MSM_MESSAGES + i];
+        stats.period.rtcm_msm_messages[i] = (uint32_t)PERIOD(STATS_COUNTER_MSM_MESSAGES + i);
+        stats.period.rtcm_msm_satellites[i] = (uint8_t)totals[STATS_COUNTER_MSM_SATELLITES + i];
+        stats.period.rtcm_msm_signals[i] = (uint8_t)totals[STATS_COUNTER_MSM_SIGNALS + i];
+        // Maximum of the epochs seen at each snapshot (MSM epochs are usually 1 Hz)
+        if (stats.period.rtcm_msm_satellites[i] > stats.period.rtcm_msm_satellites_max[i]) {
+            stats.period.rtcm_msm_satellites_max[i] = stats.period.rtcm_msm_satellites[i];
+        }
+    }
+    
+    stats.runtime.gga_sent_count_total = (uint32_t)totals[STATS_COUNTER_GGA_SENT];
+    stats.runtime.gga_send_failures_total = (uint32_t)totals[STATS_COUNTER_GGA_FAILURES];
+    stats.runtime.last_gga_sent_time = (time_t)totals[STATS_COUNTER_GGA_LAST_SENT_TIME];
+    stats.runtime.gga_vrs_regenerations_total = (uint32_t)totals[STATS_COUNTER_GGA_VRS_REGENERATIONS];
+    stats.runtime.gga_fix_change_sends_total = (uint32_t)totals[STATS_COUNTER_GGA_FIX_CHANGE_SENDS];
+    stats.runtime.gga_bytes_saved_total = (int64_t)totals[STATS_COUNTER_GGA_BYTES_SAVED];
+    stats.period.gga_sent_count = (uint32_t)PERIOD(STATS_COUNTER_GGA_SENT);
+    stats.period.gga_send_failures = (uint32_t)PERIOD(STATS_COUNTER_GGA_FAILURES);
+    stats.period.gga_vrs_regenerations = (uint32_t)PERIOD(STATS_COUNTER_GGA_VRS_REGENERATIONS);
+    stats.period.gga_bytes_saved = (int32_t)(int64_t)PERIOD(STATS_COUNTER_GGA_BYTES_SAVED);
+    
+    stats.runtime.fix_upgrades_total = (uint32_t)totals[STATS_COUNTER_FIX_UPGRADES];
+    stats.runtime.fix_downgrades_total = (uint32_t)totals[STATS_COUNTER_FIX_DOWNGRADES];
+    stats.period.fix_upgrades = (uint32_t)PERIOD(STATS_COUNTER_FIX_UPGRADES);
+    stats.period.fix_downgrades = (uint32_t)PERIOD(STATS_COUNTER_FIX_DOWNGRADES);
+#undef PERIOD
+}
+
+/**
+ * @brief Calculate the reported quantiles of the metric histograms
+ * 
+ * WiFi RSSI is recorded as -dBm, so its low quantiles are the high ones of
+ * the histogram.
+ * 
+ * @param histograms Histograms of one scope (STATS_METRIC_COUNT)
+ * @param quantiles Receives the quantiles in the unit of each metric
+ */
+static void calculate_quantiles(const LogHistogram* histograms, float quantiles[][STATS_QUANTILE_COUNT]) {
+    for (int m = 0; m < STATS_METRIC_COUNT; m++) {
+        for (int q = 0; q < STATS_QUANTILE_COUNT; q++) {
+            if (m == STATS_METRIC_WIFI_RSSI) {
+                quantiles[m][q] = -(float)histograms[m].quantile(1.0f - quantile_levels[q]);
+            } else {
+                quantiles[m][q] = (float)histograms[m].quantile(quantile_levels[q]) / metric_scales[m];
+            }
+        }
+    }
+}
+
+/**
+ * @brief Copy the position scatter into the statistics
+ * 
+ * @param position Receives the scatter of the current period
+ */
+static void update_position_stats(statistics_position_t* position) {
+    position->samples = position_scatter.getCount();
+    position_scatter.getMeanPosition(&position->mean_latitude, &position->mean_longitude,
+                                     &position->mean_altitude_m);
+    position->std_east_m = position_scatter.getStdDev(SCATTER_EAST);
+    position->std_north_m = position_scatter.getStdDev(SCATTER_NORTH);
+    position->std_up_m = position_scatter.getStdDev(SCATTER_UP);
+    position->cep50_m = position_scatter.getCep(0.50f);
+    position->cep95_m = position_scatter.getCep(0.95f);
+    position->drms2_m = position_scatter.getDrms2();
+}
+
 /**
  * @brief Reset period statistics
  */
@@ -84,21 +308,40 @@ static void reset_period_stats(void) {
         stats.period_duration_sec = tv.tv_sec - stats.period_start_time;
         stats.period_start_time = tv.tv_sec;
         
+        // Keep last complete MSM epoch coverage, it stays valid across periods
+        uint8_t msm_satellites[RTCM_CONSTELLATION_COUNT];
+        uint8_t msm_signals[RTCM_CONSTELLATION_COUNT];
+        memcpy(msm_satellites, stats.period.rtcm_msm_satellites, sizeof(msm_satellites));
+        memcpy(msm_signals, stats.period.rtcm_msm_signals, sizeof(msm_signals));
+        
         // Reset period structure
         memset(&stats.period, 0, sizeof(period_statistics_t));
         
+        memcpy(stats.period.rtcm_msm_satellites, msm_satellites, sizeof(msm_satellites));
+        memcpy(stats.period.rtcm_msm_signals, msm_signals, sizeof(msm_signals));
+        
+        // The new period counts from the last snapshot, later events are not lost
+        memcpy(counter_period_base, counter_totals, sizeof(counter_period_base));
+        
         // Reinitialize min values
         stats.period.hdop_min = 99.9f;
         stats.period.satellites_min = 255;
         stats.period.wifi_rssi_min = 0;
         
-        // Reset accumulator variables
-        hdop_sample_count = 0;
-        hdop_sum = 0.0f;
-        sat_sample_count = 0;
-        sat_sum = 0;
-        rssi_sample_count = 0;
-        rssi_sum = 0;
+        // The completed period joins the runtime distributions
+        for (int m = 0; m < STATS_METRIC_COUNT; m++) {
+            runtime_histograms[m].merge(period_histograms[m]);
+            period_histograms[m].reset();
+        }
+        calculate_quantiles(runtime_histograms, stats.runtime.quantiles_boot);
+        position_scatter.recenter();
+        
+        // Loop durations and CPU time count from here
+        for (int t = 0; t < STATS_TASK_COUNT; t++) {
+            loop_histograms[t].reset();
+            loop_sum_us[t] = 0;
+        }
+        cpu_load.reset();
         
         xSemaphoreGive(stats_mutex);
     }
@@ -134,40 +377,123 @@ static void collect_heap_stats(void) {
     stats.period.heap_largest_block = largest_block;
 }
 
+/**
+ * @brief Update a stack high water mark with the least free stack of a task
+ * 
+ * @param hwm Stored minimum (0 until the first reading)
+ * @param task Task handle, NULL if not known yet
+ */
+static void update_stack_hwm(uint32_t* hwm, TaskHandle_t task) {
+    if (task != NULL) {
+        uint32_t free_stack = uxTaskGetStackHighWaterMark(task);
+        if (free_stack < *hwm || *hwm == 0) {
+            *hwm = free_stack;
+        }
+    }
+}
+
 /**
  * @brief Collect stack high water marks
  * 
- * Note: Stack monitoring requires task handles to be exported from each module.
- * Currently disabled to avoid linker errors. To enable:
- * 1. Make task handles non-static in each task module
- * 2. Declare them in task headers as: extern TaskHandle_t <task>_handle;
+ * The instrumented tasks are known from their loop reports, this task from
+ * its own handle.
  */
 static void collect_stack_hwm(void) {
-    // Stack monitoring disabled - task handles not exported
-    // Future: Add accessor functions in each task module to query stack usage
-    
-    /*
-    // Example implementation when handles are exported:
-    extern TaskHandle_t ntrip_task_handle;
-    extern TaskHandle_t gnss_task_handle;
-    extern TaskHandle_t data_output_task_handle;
-    extern TaskHandle_t led_task_handle;
-    
-    if (ntrip_task_handle != NULL) {
-        UBaseType_t hwm = uxTaskGetStackHighWaterMark(ntrip_task_handle);
-        if (hwm < stats.runtime.stack_hwm_ntrip || stats.runtime.stack_hwm_ntrip == 0) {
-            stats.runtime.stack_hwm_ntrip = hwm;
+    update_stack_hwm(&stats.runtime.stack_hwm_ntrip, loop_task_handles[STATS_TASK_NTRIP].load(std::memory_order_relaxed));
+    update_stack_hwm(&stats.runtime.stack_hwm_gnss, loop_task_handles[STATS_TASK_GNSS].load(std::memory_order_relaxed));
+    update_stack_hwm(&stats.runtime.stack_hwm_dataout, loop_task_handles[STATS_TASK_DATA_OUTPUT].load(std::memory_order_relaxed));
+    update_stack_hwm(&stats.runtime.stack_hwm_led, loop_task_handles[STATS_TASK_LED].load(std::memory_order_relaxed));
+    update_stack_hwm(&stats.runtime.stack_hwm_stats, stats_task_handle);
+}
+
+/**
+ * @brief Collect the loop durations reported since the last call
+ */
+static void collect_loop_stats(void) {
+    for (int t = 0; t < STATS_TASK_COUNT; t++) {
+        uint64_t sum_us = 0;
+        uint32_t max_us = 0;
+        uint32_t samples = loop_profilers[t].collect(&loop_histograms[t], &sum_us, &max_us);
+        
+        statistics_loop_t* loop = &stats.period.task_loops[t];
+        if (samples > 0) {
+            loop->loops += samples;
+            loop_sum_us[t] += sum_us;
+            loop->avg_us = (uint32_t)(loop_sum_us[t] / loop->loops);
+            if (max_us > loop->max_us) {
+                loop->max_us = max_us;
+            }
+        }
+        // Bucket middles can lie above the exact maximum
+        const LogHistogram& histogram = loop_histograms[t];
+        loop->p50_us = histogram.quantile(0.50f);
+        loop->p99_us = histogram.quantile(0.99f);
+        if (loop->p50_us > loop->max_us) {
+            loop->p50_us = loop->max_us;
+        }
+        if (loop->p99_us > loop->max_us) {
+            loop->p99_us = loop->max_us;
         }
     }
-    */
+}
+
+/**
+ * @brief Collect the CPU usage per task and per core
+ * 
+ * Needs CONFIG_FREERTOS_USE_TRACE_FACILITY and
+ * CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS; without them the CPU usage
+ * stays 0 and the task list is marked unavailable.
+ */
+static void collect_cpu_stats(void) {
+#if defined(CONFIG_FREERTOS_USE_TRACE_FACILITY) && defined(CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS)
+    configRUN_TIME_COUNTER_TYPE total_run_time = 0;
+    UBaseType_t count = uxTaskGetSystemState(task_status, CPU_LOAD_MAX_TASKS, &total_run_time);
+    if (count == 0) {
+        // More tasks than CPU_LOAD_MAX_TASKS
+        return;
+    }
     
-    // Monitor own task stack
-    if (stats_task_handle != NULL) {
-        UBaseType_t hwm = uxTaskGetStackHighWaterMark(stats_task_handle);
-        if (hwm < stats.runtime.stack_hwm_stats || stats.runtime.stack_hwm_stats == 0) {
-            stats.runtime.stack_hwm_stats = hwm;
+    static CpuLoadSample samples[CPU_LOAD_MAX_TASKS];    // Statistics task only, like task_status
+    for (UBaseType_t i = 0; i < count; i++) {
+        samples[i].taskNumber = task_status[i].xTaskNumber;
+        samples[i].runTime = (uint32_t)task_status[i].ulRunTimeCounter;
+    }
+    cpu_load.update(samples, count, (uint32_t)total_run_time);
+    
+    task_list.available = true;
+    task_list.elapsed_ms = (uint32_t)(cpu_load.getElapsed() / 1000);
+    task_list.cores = portNUM_PROCESSORS < STATS_CPU_CORE_COUNT ? portNUM_PROCESSORS : STATS_CPU_CORE_COUNT;
+    task_list.task_count = 0;
+    for (UBaseType_t i = 0; i < count; i++) {
+        const TaskStatus_t* status = &task_status[i];
+        float percent = cpu_load.getPercent(status->xTaskNumber);
+        
+        for (int core = 0; core < task_list.cores; core++) {
+            if (status->xHandle == xTaskGetIdleTaskHandleForCore(core)) {
+                task_list.core_load_percent[core] = 100.0f - percent;
+            }
+        }
+        for (int t = 0; t < STATS_TASK_COUNT; t++) {
+            if (status->xHandle == loop_task_handles[t].load(std::memory_order_relaxed)) {
+                stats.period.cpu_usage_percent[t] = percent;
+            }
+        }
+        
+        if (task_list.task_count < STATS_TASK_LIST_MAX) {
+            statistics_task_info_t* info = &task_list.tasks[task_list.task_count++];
+            strncpy(info->name, status->pcTaskName, sizeof(info->name) - 1);
+            info->name[sizeof(info->name) - 1] = '\0';
+            info->task_number = status->xTaskNumber;
+            info->priority = (uint8_t)status->uxCurrentPriority;
+            BaseType_t core = xTaskGetCoreID(status->xHandle);
+            info->core = (core >= 0 && core < portNUM_PROCESSORS) ? (int8_t)core : -1;
+            info->stack_hwm_bytes = status->usStackHighWaterMark;
+            info->cpu_percent = percent;
         }
     }
+    memcpy(stats.period.cpu_core_load_percent, task_list.core_load_percent,
+           sizeof(stats.period.cpu_core_load_percent));
+#endif
 }
 
 /**
@@ -194,9 +520,9 @@ static void collect_wifi_stats(void) {
             if (rssi > stats.period.wifi_rssi_max) {
                 stats.period.wifi_rssi_max = rssi;
             }
-            rssi_sum += rssi;
-            rssi_sample_count++;
-            stats.period.wifi_rssi_avg = rssi_sample_count > 0 ? (rssi_sum / rssi_sample_count) : 0;
+            LogHistogram& histogram = period_histograms[STATS_METRIC_WIFI_RSSI];
+            histogram.record(rssi < 0 ? (uint32_t)(-rssi) : 0);
+            stats.period.wifi_rssi_avg = (int8_t)-(int32_t)(histogram.getMean() + 0.5f);
             
             // Update runtime
             if (rssi < stats.runtime.wifi_rssi_min_boot || stats.runtime.wifi_rssi_min_boot == 0) {
@@ -225,16 +551,8 @@ static void collect_gnss_stats(void) {
     
     if (gnss_data.valid) {
         // Track fix quality changes
+        // Upgrades and downgrades are counted per epoch by statistics_fix_quality_changed()
         if (gnss_data.fix_quality != last_fix_quality) {
-            // Increment appropriate counter
-            if (gnss_data.fix_quality < last_fix_quality) {
-                stats.runtime.fix_downgrades_total++;
-                stats.period.fix_downgrades++;
-            } else if (gnss_data.fix_quality > last_fix_quality) {
-                stats.runtime.fix_upgrades_total++;
-                stats.period.fix_upgrades++;
-            }
-            
             // Update timestamps for fix progression
             struct timeval tv;
             gettimeofday(&tv, NULL);
@@ -290,9 +608,9 @@ static void collect_gnss_stats(void) {
             if (gnss_data.hdop > stats.period.hdop_max) {
                 stats.period.hdop_max = gnss_data.hdop;
             }
-            hdop_sum += gnss_data.hdop;
-            hdop_sample_count++;
-            stats.period.hdop_avg = hdop_sum / hdop_sample_count;
+            LogHistogram& histogram = period_histograms[STATS_METRIC_HDOP];
+            histogram.record((uint32_t)(gnss_data.hdop * metric_scales[STATS_METRIC_HDOP] + 0.5f));
+            stats.period.hdop_avg = histogram.getMean() / metric_scales[STATS_METRIC_HDOP];
             
             // Runtime HDOP
             if (gnss_data.hdop < stats.runtime.hdop_min_boot) {
@@ -321,9 +639,9 @@ static void collect_gnss_stats(void) {
             if (gnss_data.satellites > stats.period.satellites_max) {
                 stats.period.satellites_max = gnss_data.satellites;
             }
-            sat_sum += gnss_data.satellites;
-            sat_sample_count++;
-            stats.period.satellites_avg = sat_sample_count > 0 ? (sat_sum / sat_sample_count) : 0;
+            LogHistogram& histogram = period_histograms[STATS_METRIC_SATELLITES];
+            histogram.record(gnss_data.satellites);
+            stats.period.satellites_avg = (uint8_t)histogram.getMean();
             
             // Runtime satellites
             if (gnss_data.satellites < stats.runtime.satellites_min_boot) {
@@ -333,6 +651,120 @@ static void collect_gnss_stats(void) {
                 stats.runtime.satellites_max_boot = gnss_data.satellites;
             }
         }
+        
+        // Position scatter, once per epoch
+        if (gnss_data.fix_quality >= 1 && gnss_data.epoch_time_us != last_scatter_epoch_us) {
+            last_scatter_epoch_us = gnss_data.epoch_time_us;
+            position_scatter.add(gnss_data.latitude, gnss_data.longitude, gnss_data.altitude);
+            update_position_stats(&stats.period.position);
+        }
+        
+        // Correction age with differential, RTK float or RTK fixed corrections
+        if (gnss_data.fix_quality == 2 || gnss_data.fix_quality == 4 || gnss_data.fix_quality == 5) {
+            float age = gnss_data.dgps_age > 0.0f ? gnss_data.dgps_age : 0.0f;
+            period_histograms[STATS_METRIC_CORRECTION_AGE].record(
+                (uint32_t)(age * metric_scales[STATS_METRIC_CORRECTION_AGE] + 0.5f));
+            last_correction_age = age;
+        } else {
+            last_correction_age = 0.0f;
+        }
+    }
+}
+
+/**
+ * @brief Allocate the metric history, in PSRAM when the build enables it
+ */
+static void init_history(void) {
+    if (history_memory != NULL) {
+        return;
+    }
+    size_t size = STATS_HISTORY_PSRAM_BYTES;
+    const char* location = "PSRAM";
+    history_memory = (uint8_t*)heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    if (history_memory == NULL) {
+        size = STATS_HISTORY_RAM_BYTES;
+        location = "internal RAM";
+        history_memory = (uint8_t*)heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    if (history_memory == NULL) {
+        ESP_LOGW(TAG, "No memory for the metric history");
+        return;
+    }
+    history.init(history_memory, size, STATS_HISTORY_BLOCK_SIZE, STATS_HISTORY_METRIC_COUNT,
+                 STATS_HISTORY_INTERVAL_SEC);
+    ESP_LOGI(TAG, "Metric history: %u KB in %s", (unsigned)(size / 1024), location);
+}
+
+/**
+ * @brief History value of a metric with decimals, as a scaled integer
+ */
+static int32_t history_scaled(statistics_history_metric_t metric, float value) {
+    static const float scales[4] = {1.0f, 10.0f, 100.0f, 1000.0f};
+    return (int32_t)lroundf(value * scales[history_metric_decimals[metric]]);
+}
+
+/**
+ * @brief Add a row to the metric history once per interval
+ * 
+ * Rows are at whole intervals of the uptime. Seconds and counts are the
+ * differences of the runtime totals since the previous row.
+ */
+static void record_history(void) {
+    const runtime_statistics_t* rt = &stats.runtime;
+    const runtime_statistics_t* base = &history_base;
+    const period_statistics_t* pd = &stats.period;
+    uint32_t time = rt->system_uptime_sec - rt->system_uptime_sec % STATS_HISTORY_INTERVAL_SEC;
+    if (history_memory == NULL || time == 0 || time == history_last_sec) {
+        return;
+    }
+    
+    int32_t values[STATS_HISTORY_METRIC_COUNT];
+    values[STATS_HISTORY_FIX_QUALITY] = last_fix_quality;
+    values[STATS_HISTORY_NO_FIX_SEC] = (int32_t)(rt->fix_quality_duration_total[0] - base->fix_quality_duration_total[0]);
+    values[STATS_HISTORY_GPS_SEC] = (int32_t)(rt->fix_quality_duration_total[1] - base->fix_quality_duration_total[1]);
+    values[STATS_HISTORY_DGPS_SEC] = (int32_t)(rt->fix_quality_duration_total[2] - base->fix_quality_duration_total[2]);
+    values[STATS_HISTORY_RTK_FLOAT_SEC] = (int32_t)(rt->fix_quality_duration_total[5] - base->fix_quality_duration_total[5]);
+    values[STATS_HISTORY_RTK_FIXED_SEC] = (int32_t)(rt->fix_quality_duration_total[4] - base->fix_quality_duration_total[4]);
+    values[STATS_HISTORY_FIX_DOWNGRADES] = (int32_t)(rt->fix_downgrades_total - base->fix_downgrades_total);
+    values[STATS_HISTORY_FIX_UPGRADES] = (int32_t)(rt->fix_upgrades_total - base->fix_upgrades_total);
+    values[STATS_HISTORY_SATELLITES] = pd->satellites_current;
+    values[STATS_HISTORY_HDOP] = history_scaled(STATS_HISTORY_HDOP, pd->hdop_current);
+    values[STATS_HISTORY_ACCURACY_M] = history_scaled(STATS_HISTORY_ACCURACY_M, pd->estimated_accuracy_m);
+    values[STATS_HISTORY_CORRECTION_AGE_SEC] = history_scaled(STATS_HISTORY_CORRECTION_AGE_SEC, last_correction_age);
+    values[STATS_HISTORY_BASELINE_KM] = history_scaled(STATS_HISTORY_BASELINE_KM, pd->baseline_distance_km);
+    values[STATS_HISTORY_RTCM_BYTES] = (int32_t)(rt->rtcm_bytes_received_total - base->rtcm_bytes_received_total);
+    values[STATS_HISTORY_RTCM_MESSAGES] = (int32_t)(rt->rtcm_messages_received_total - base->rtcm_messages_received_total);
+    values[STATS_HISTORY_RTCM_CORRUPTED] = (int32_t)(rt->rtcm_corrupted_count_total - base->rtcm_corrupted_count_total);
+    for (int i = 0; i < RTCM_CONSTELLATION_COUNT; i++) {
+        values[STATS_HISTORY_MSM_SATELLITES_GPS + i] = pd->rtcm_msm_satellites[i];
+    }
+    values[STATS_HISTORY_GGA_SENT] = (int32_t)(rt->gga_sent_count_total - base->gga_sent_count_total);
+    values[STATS_HISTORY_GGA_FAILURES] = (int32_t)(rt->gga_send_failures_total - base->gga_send_failures_total);
+    values[STATS_HISTORY_NTRIP_CONNECTED_SEC] = (int32_t)(rt->ntrip_uptime_sec - base->ntrip_uptime_sec);
+    values[STATS_HISTORY_WIFI_RSSI_DBM] = pd->wifi_rssi_dbm;
+    values[STATS_HISTORY_WIFI_CONNECTED_SEC] = (int32_t)(rt->wifi_uptime_sec - base->wifi_uptime_sec);
+    values[STATS_HISTORY_HEAP_FREE_BYTES] = (int32_t)pd->heap_free_bytes;
+    values[STATS_HISTORY_HEAP_LARGEST_BLOCK_BYTES] = (int32_t)pd->heap_largest_block;
+    values[STATS_HISTORY_HEAP_MIN_FREE_BYTES] = (int32_t)rt->heap_min_free_bytes;
+    values[STATS_HISTORY_CPU_CORE0_PERCENT] = history_scaled(STATS_HISTORY_CPU_CORE0_PERCENT, pd->cpu_core_load_percent[0]);
+    values[STATS_HISTORY_CPU_CORE1_PERCENT] = history_scaled(STATS_HISTORY_CPU_CORE1_PERCENT, pd->cpu_core_load_percent[1]);
+    
+    history.append(time, values);
+    memcpy(&history_base, rt, sizeof(runtime_statistics_t));
+    history_last_sec = time;
+}
+
+/**
+ * @brief Calculate period rates from the period counters
+ * 
+ * @param period Period statistics to update
+ * @param period_sec Elapsed period duration in seconds (must be > 0)
+ */
+static void calculate_period_rates(period_statistics_t* period, uint32_t period_sec) {
+    period->rtcm_bytes_per_sec = period->rtcm_bytes_received / period_sec;
+    period->rtcm_message_rate = period->rtcm_messages_received / period_sec;
+    for (int i = 0; i < RTCM_CONSTELLATION_COUNT; i++) {
+        period->rtcm_msm_rate[i] = (float)period->rtcm_msm_messages[i] / period_sec;
     }
 }
 
@@ -346,17 +778,39 @@ static void log_statistics_summary(void) {
     ESP_LOGI(TAG, "GNSS: Fix=%d, HDOP=%.2f, Sats=%d, Accuracy=%.3fm",
              last_fix_quality, stats.period.hdop_current, stats.period.satellites_current, 
              stats.period.estimated_accuracy_m);
+    ESP_LOGI(TAG, "Position: %lu samples, std E/N/U=%.3f/%.3f/%.3fm, CEP50=%.3fm, CEP95=%.3fm, 2DRMS=%.3fm",
+             stats.period.position.samples, stats.period.position.std_east_m,
+             stats.period.position.std_north_m, stats.period.position.std_up_m,
+             stats.period.position.cep50_m, stats.period.position.cep95_m, stats.period.position.drms2_m);
     ESP_LOGI(TAG, "RTK Fixed: %.1f%% (period), %lu sec (total)",
              stats.period.rtk_fixed_stability_percent, stats.runtime.fix_quality_duration_total[4]);
     ESP_LOGI(TAG, "RTCM: %lu bytes (%lu B/s), %lu msgs (%lu msg/s)",
              stats.period.rtcm_bytes_received, stats.period.rtcm_bytes_per_sec,
              stats.period.rtcm_messages_received, stats.period.rtcm_message_rate);
+    ESP_LOGI(TAG, "MSM sats/signals: GPS=%u/%u, GLO=%u/%u, GAL=%u/%u, BDS=%u/%u, CRC errors=%lu",
+             stats.period.rtcm_msm_satellites[0], stats.period.rtcm_msm_signals[0],
+             stats.period.rtcm_msm_satellites[1], stats.period.rtcm_msm_signals[1],
+             stats.period.rtcm_msm_satellites[2], stats.period.rtcm_msm_signals[2],
+             stats.period.rtcm_msm_satellites[3], stats.period.rtcm_msm_signals[3],
+             stats.period.rtcm_corrupted_count);
     ESP_LOGI(TAG, "WiFi: Connected %.1f%%, RSSI=%d dBm (avg=%d)",
              stats.period.wifi_uptime_percent, stats.period.wifi_rssi_dbm, stats.period.wifi_rssi_avg);
-    ESP_LOGI(TAG, "GGA: Sent=%lu, Failures=%lu (period)",
-             stats.period.gga_sent_count, stats.period.gga_send_failures);
+    ESP_LOGI(TAG, "GGA: Sent=%lu, Failures=%lu, VRS regenerations=%lu, Bytes saved=%ld (period)",
+             stats.period.gga_sent_count, stats.period.gga_send_failures,
+             stats.period.gga_vrs_regenerations, stats.period.gga_bytes_saved);
     ESP_LOGI(TAG, "Errors: NMEA=%lu, UART=%lu, NTRIP timeouts=%lu (period)",
              stats.period.nmea_checksum_errors, stats.period.uart_errors, stats.period.ntrip_timeouts);
+    ESP_LOGI(TAG, "CPU: core0=%.1f%%, core1=%.1f%%, GNSS=%.1f%%, NTRIP=%.1f%%, output=%.1f%%, MQTT=%.1f%%, LED=%.1f%%",
+             stats.period.cpu_core_load_percent[0], stats.period.cpu_core_load_percent[1],
+             stats.period.cpu_usage_percent[STATS_TASK_GNSS], stats.period.cpu_usage_percent[STATS_TASK_NTRIP],
+             stats.period.cpu_usage_percent[STATS_TASK_DATA_OUTPUT], stats.period.cpu_usage_percent[STATS_TASK_MQTT],
+             stats.period.cpu_usage_percent[STATS_TASK_LED]);
+    ESP_LOGI(TAG, "Loop p99/max: GNSS=%lu/%lu us, NTRIP=%lu/%lu us, output=%lu/%lu us, MQTT=%lu/%lu us, LED=%lu/%lu us",
+             stats.period.task_loops[STATS_TASK_GNSS].p99_us, stats.period.task_loops[STATS_TASK_GNSS].max_us,
+             stats.period.task_loops[STATS_TASK_NTRIP].p99_us, stats.period.task_loops[STATS_TASK_NTRIP].max_us,
+             stats.period.task_loops[STATS_TASK_DATA_OUTPUT].p99_us, stats.period.task_loops[STATS_TASK_DATA_OUTPUT].max_us,
+             stats.period.task_loops[STATS_TASK_MQTT].p99_us, stats.period.task_loops[STATS_TASK_MQTT].max_us,
+             stats.period.task_loops[STATS_TASK_LED].p99_us, stats.period.task_loops[STATS_TASK_LED].max_us);
 }
 
 /**
@@ -370,15 +824,22 @@ static void statistics_task(void *pvParameters) {
     ESP_LOGI(TAG, "Statistics Task started (interval: %lu sec)", config.interval_sec);
     
     while (1) {
+        static uint64_t totals[STATS_COUNTER_COUNT];    // Statistics task only
+        int64_t taken_us = config.enabled ? read_counters(totals) : 0;
         if (config.enabled && xSemaphoreTake(stats_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
             // Update uptime
             update_uptime();
             
             // Collect all statistics
+            apply_counters(totals, taken_us);
             collect_heap_stats();
             collect_stack_hwm();
+            collect_loop_stats();
+            collect_cpu_stats();
             collect_wifi_stats();
             collect_gnss_stats();
+            calculate_quantiles(period_histograms, stats.period.quantiles);
+            record_history();
             
             xSemaphoreGive(stats_mutex);
             
@@ -388,8 +849,7 @@ static void statistics_task(void *pvParameters) {
                 // Calculate period rates
                 if (stats.period_duration_sec > 0 || log_counter > 0) {
                     uint32_t period_sec = (stats.period_duration_sec > 0) ? stats.period_duration_sec : log_counter;
-                    stats.period.rtcm_bytes_per_sec = stats.period.rtcm_bytes_received / period_sec;
-                    stats.period.rtcm_message_rate = stats.period.rtcm_messages_received / period_sec;
+                    calculate_period_rates(&stats.period, period_sec);
                 }
                 
                 // Log summary
@@ -420,6 +880,7 @@ void statistics_task_init(void) {
     
     // Initialize statistics
     init_statistics();
+    init_history();
     
     // Create task
     BaseType_t result = xTaskCreate(
@@ -453,7 +914,13 @@ void statistics_task_stop(void) {
  * @brief Get current statistics (thread-safe)
  */
 void statistics_get(system_statistics_t* out_stats) {
-    if (out_stats != NULL && xSemaphoreTake(stats_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+    if (out_stats == NULL) {
+        return;
+    }
+    uint64_t totals[STATS_COUNTER_COUNT];
+    int64_t taken_us = read_counters(totals);
+    if (xSemaphoreTake(stats_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        apply_counters(totals, taken_us);
         memcpy(out_stats, &stats, sizeof(system_statistics_t));
         xSemaphoreGive(stats_mutex);
     }
@@ -463,7 +930,13 @@ void statistics_get(system_statistics_t* out_stats) {
  * @brief Get runtime statistics only (thread-safe)
  */
 void statistics_get_runtime(runtime_statistics_t* out_stats) {
-    if (out_stats != NULL && xSemaphoreTake(stats_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+    if (out_stats == NULL) {
+        return;
+    }
+    uint64_t totals[STATS_COUNTER_COUNT];
+    int64_t taken_us = read_counters(totals);
+    if (xSemaphoreTake(stats_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+        apply_counters(totals, taken_us);
         memcpy(out_stats, &stats.runtime, sizeof(runtime_statistics_t));
         xSemaphoreGive(stats_mutex);
     }
@@ -473,8 +946,14 @@ void statistics_get_runtime(runtime_statistics_t* out_stats) {
  * @brief Get period statistics only (thread-safe)
  */
 void statistics_get_period(period_statistics_t* out_stats) {
-    if (out_stats != NULL && xSemaphoreTake(stats_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+    if (out_stats == NULL) {
+        return;
+    }
+    uint64_t totals[STATS_COUNTER_COUNT];
+    int64_t taken_us = read_counters(totals);
+    if (xSemaphoreTake(stats_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
         // Copy period stats
+        apply_counters(totals, taken_us);
         memcpy(out_stats, &stats.period, sizeof(period_statistics_t));
         
         // Calculate rates on-the-fly if period duration is available
@@ -483,14 +962,63 @@ void statistics_get_period(period_statistics_t* out_stats) {
         uint32_t period_sec = tv.tv_sec - stats.period_start_time;
         
         if (period_sec > 0) {
-            out_stats->rtcm_bytes_per_sec = stats.period.rtcm_bytes_received / period_sec;
-            out_stats->rtcm_message_rate = stats.period.rtcm_messages_received / period_sec;
+            calculate_period_rates(out_stats, period_sec);
         }
         
         xSemaphoreGive(stats_mutex);
     }
 }
 
+/**
+ * @brief Get the histogram of a metric (thread-safe)
+ */
+bool statistics_get_histogram(statistics_metric_t metric, bool runtime, statistics_histogram_t* histogram) {
+    if (histogram == NULL || metric < 0 || metric >= STATS_METRIC_COUNT) {
+        return false;
+    }
+    if (xSemaphoreTake(stats_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return false;
+    }
+    const LogHistogram& source = runtime ? runtime_histograms[metric] : period_histograms[metric];
+    histogram->count = source.getCount();
+    histogram->bins = (uint8_t)source.exportSparse(histogram->gaps, histogram->counts,
+                                                   STATS_HISTOGRAM_MAX_BINS, &histogram->shift);
+    xSemaphoreGive(stats_mutex);
+    return true;
+}
+
+/**
+ * @brief Get the CPU usage of all tasks this period (thread-safe)
+ */
+bool statistics_get_tasks(statistics_tasks_t* tasks) {
+    if (tasks == NULL || xSemaphoreTake(stats_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return false;
+    }
+    memcpy(tasks, &task_list, sizeof(statistics_tasks_t));
+    xSemaphoreGive(stats_mutex);
+    return true;
+}
+
+/**
+ * @brief Short name of an instrumented task
+ */
+const char* statistics_task_name(statistics_task_id_t task) {
+    if (task < 0 || task >= STATS_TASK_COUNT) {
+        return "unknown";
+    }
+    return loop_task_names[task];
+}
+
+/**
+ * @brief Name of a history metric
+ */
+const char* statistics_history_metric_name(statistics_history_metric_t metric) {
+    if (metric < 0 || metric >= STATS_HISTORY_METRIC_COUNT) {
+        return "unknown";
+    }
+    return history_metric_names[metric];
+}
+
 /**
  * @brief Reset period statistics
  */
@@ -502,42 +1030,98 @@ void statistics_reset_period(void) {
  * @brief Update RTCM data received counter
  */
 void statistics_rtcm_received(uint32_t bytes, uint32_t messages) {
-    if (xSemaphoreTake(stats_mutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-        stats.runtime.rtcm_bytes_received_total += bytes;
-        stats.runtime.rtcm_messages_received_total += messages;
-        stats.period.rtcm_bytes_received += bytes;
-        stats.period.rtcm_messages_received += messages;
-        xSemaphoreGive(stats_mutex);
+    stat_counters.beginUpdate(STATS_PRODUCER_NTRIP);
+    stat_counters.add(STATS_PRODUCER_NTRIP, STATS_COUNTER_RTCM_BYTES, bytes);
+    stat_counters.add(STATS_PRODUCER_NTRIP, STATS_COUNTER_RTCM_MESSAGES, messages);
+    stat_counters.endUpdate(STATS_PRODUCER_NTRIP);
+}
+
+/**
+ * @brief Update per-constellation MSM coverage
+ */
+void statistics_rtcm_msm(const rtcm_msm_update_t* update) {
+    if (update == NULL) {
+        return;
+    }
+    stat_counters.beginUpdate(STATS_PRODUCER_NTRIP);
+    for (int i = 0; i < RTCM_CONSTELLATION_COUNT; i++) {
+        stat_counters.add(STATS_PRODUCER_NTRIP, STATS_COUNTER_MSM_MESSAGES + i, update->msm_messages[i]);
+        if (update->epoch_complete[i]) {
+            stat_counters.set(STATS_PRODUCER_NTRIP, STATS_COUNTER_MSM_SATELLITES + i, update->satellites[i]);
+            stat_counters.set(STATS_PRODUCER_NTRIP, STATS_COUNTER_MSM_SIGNALS + i, update->signals[i]);
+        }
+    }
+    stat_counters.endUpdate(STATS_PRODUCER_NTRIP);
+}
+
+/**
+ * @brief Update RTCM corrupted frame counter
+ */
+void statistics_rtcm_corrupted(uint32_t count) {
+    if (count == 0) {
+        return;
     }
+    stat_counters.beginUpdate(STATS_PRODUCER_NTRIP);
+    stat_counters.add(STATS_PRODUCER_NTRIP, STATS_COUNTER_RTCM_CORRUPTED, count);
+    stat_counters.endUpdate(STATS_PRODUCER_NTRIP);
 }
 
 /**
  * @brief Update GPS fix quality event
  */
 void statistics_fix_quality_changed(uint8_t new_quality) {
-    // Fix quality changes are tracked in collect_gnss_stats()
-    // This function provided for explicit notifications if needed
-    (void)new_quality;
+    if (new_quality == reported_fix_quality) {
+        return;
+    }
+    stat_counters.beginUpdate(STATS_PRODUCER_GNSS);
+    stat_counters.add(STATS_PRODUCER_GNSS, (new_quality > reported_fix_quality) ?
+                      STATS_COUNTER_FIX_UPGRADES : STATS_COUNTER_FIX_DOWNGRADES, 1);
+    stat_counters.endUpdate(STATS_PRODUCER_GNSS);
+    reported_fix_quality = new_quality;
 }
 
 /**
  * @brief Update GGA transmission counter
  */
 void statistics_gga_sent(bool success) {
-    if (xSemaphoreTake(stats_mutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-        if (success) {
-            stats.runtime.gga_sent_count_total++;
-            stats.period.gga_sent_count++;
-            
-            struct timeval tv;
-            gettimeofday(&tv, NULL);
-            stats.runtime.last_gga_sent_time = tv.tv_sec;
-        } else {
-            stats.runtime.gga_send_failures_total++;
-            stats.period.gga_send_failures++;
-        }
-        xSemaphoreGive(stats_mutex);
+    stat_counters.beginUpdate(STATS_PRODUCER_NTRIP);
+    if (success) {
+        stat_counters.add(STATS_PRODUCER_NTRIP, STATS_COUNTER_GGA_SENT, 1);
+        
+        struct timeval tv;
+        gettimeofday(&tv, NULL);
+        stat_counters.set(STATS_PRODUCER_NTRIP, STATS_COUNTER_GGA_LAST_SENT_TIME, (uint64_t)tv.tv_sec);
+    } else {
+        stat_counters.add(STATS_PRODUCER_NTRIP, STATS_COUNTER_GGA_FAILURES, 1);
+    }
+    stat_counters.endUpdate(STATS_PRODUCER_NTRIP);
+}
+
+/**
+ * @brief Update GGA upload policy counters
+ */
+void statistics_gga_scheduled(uint8_t reason, int32_t bytes_saved) {
+    stat_counters.beginUpdate(STATS_PRODUCER_GNSS);
+    if (reason == GGA_SEND_DISTANCE) {
+        stat_counters.add(STATS_PRODUCER_GNSS, STATS_COUNTER_GGA_VRS_REGENERATIONS, 1);
+    } else if (reason == GGA_SEND_FIX_CHANGE) {
+        stat_counters.add(STATS_PRODUCER_GNSS, STATS_COUNTER_GGA_FIX_CHANGE_SENDS, 1);
     }
+    // A negative change wraps and is read back as int64_t
+    stat_counters.add(STATS_PRODUCER_GNSS, STATS_COUNTER_GGA_BYTES_SAVED, (uint64_t)(int64_t)bytes_saved);
+    stat_counters.endUpdate(STATS_PRODUCER_GNSS);
+}
+
+/**
+ * @brief Report the duration of one loop iteration
+ */
+void statistics_loop_time(statistics_task_id_t task, uint32_t duration_us) {
+    if (task < 0 || task >= STATS_TASK_COUNT) {
+        return;
+    }
+    // A restarted task reports its new handle
+    loop_task_handles[task].store(xTaskGetCurrentTaskHandle(), std::memory_order_relaxed);
+    loop_profilers[task].record(duration_us);
 }
 
 /**
@@ -551,6 +1135,14 @@ int statistics_format_json(char* buffer, size_t buffer_size) {
     system_statistics_t local_stats;
     statistics_get(&local_stats);
     
+    // MSM rates are derived from the running period like statistics_get_period()
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    uint32_t period_sec = tv.tv_sec - local_stats.period_start_time;
+    if (period_sec > 0) {
+        calculate_period_rates(&local_stats.period, period_sec);
+    }
+    
     int len = snprintf(buffer, buffer_size,
         "{"
         "\"system\":{"
@@ -565,6 +1157,18 @@ int statistics_format_json(char* buffer, size_t buffer_size) {
             "\"hdop\":%.2f,"
             "\"rtk_fixed_percent\":%.1f"
         "},"
+        "\"position\":{"
+            "\"samples\":%lu,"
+            "\"mean_lat\":%.8f,"
+            "\"mean_lon\":%.8f,"
+            "\"mean_alt_m\":%.3f,"
+            "\"std_east_m\":%.3f,"
+            "\"std_north_m\":%.3f,"
+            "\"std_up_m\":%.3f,"
+            "\"cep50_m\":%.3f,"
+            "\"cep95_m\":%.3f,"
+            "\"drms2_m\":%.3f"
+        "},"
         "\"ntrip\":{"
             "\"uptime_sec\":%lu,"
             "\"reconnects\":%lu"
@@ -573,14 +1177,9 @@ int statistics_format_json(char* buffer, size_t buffer_size) {
             "\"bytes_total\":%llu,"
             "\"rate_bps\":%lu,"
             "\"messages\":%lu,"
-            "\"msg_rate\":%lu"
-        "},"
-        "\"wifi\":{"
-            "\"uptime_percent\":%.1f,"
-            "\"rssi_dbm\":%d,"
-            "\"reconnects\":%lu"
-        "}"
-        "}",
+            "\"msg_rate\":%lu,"
+            "\"corrupted\":%lu,"
+            "\"constellations\":{",
         local_stats.runtime.system_uptime_sec,
         local_stats.period.heap_free_bytes,
         local_stats.runtime.heap_min_free_bytes,
@@ -589,16 +1188,795 @@ int statistics_format_json(char* buffer, size_t buffer_size) {
         local_stats.period.satellites_current,
         local_stats.period.hdop_current,
         local_stats.period.rtk_fixed_stability_percent,
+        local_stats.period.position.samples,
+        local_stats.period.position.mean_latitude,
+        local_stats.period.position.mean_longitude,
+        local_stats.period.position.mean_altitude_m,
+        local_stats.period.position.std_east_m,
+        local_stats.period.position.std_north_m,
+        local_stats.period.position.std_up_m,
+        local_stats.period.position.cep50_m,
+        local_stats.period.position.cep95_m,
+        local_stats.period.position.drms2_m,
         local_stats.runtime.ntrip_uptime_sec,
         local_stats.runtime.ntrip_reconnect_count,
         local_stats.runtime.rtcm_bytes_received_total,
         local_stats.period.rtcm_bytes_per_sec,
         local_stats.period.rtcm_messages_received,
         local_stats.period.rtcm_message_rate,
-        local_stats.period.wifi_uptime_percent,
-        local_stats.period.wifi_rssi_dbm,
-        local_stats.runtime.wifi_reconnect_count_total
+        local_stats.period.rtcm_corrupted_count
     );
     
+    // Per-constellation MSM coverage
+    for (int i = 0; i < RTCM_CONSTELLATION_COUNT && len > 0 && (size_t)len < buffer_size; i++) {
+        len += snprintf(buffer + len, buffer_size - len,
+            "%s\"%s\":{"
+                "\"satellites\":%u,"
+                "\"satellites_max\":%u,"
+                "\"signals\":%u,"
+                "\"messages\":%lu,"
+                "\"msg_rate\":%.2f"
+            "}",
+            (i > 0) ? "," : "",
+            msm_constellation_names[i],
+            local_stats.period.rtcm_msm_satellites[i],
+            local_stats.period.rtcm_msm_satellites_max[i],
+            local_stats.period.rtcm_msm_signals[i],
+            local_stats.period.rtcm_msm_messages[i],
+            local_stats.period.rtcm_msm_rate[i]
+        );
+    }
+    
+    if (len > 0 && (size_t)len < buffer_size) {
+        len += snprintf(buffer + len, buffer_size - len,
+            "}"
+            "},"
+            "\"gga\":{"
+                "\"sent\":%lu,"
+                "\"vrs_regenerations\":%lu,"
+                "\"bytes_saved\":%lld"
+            "},"
+            "\"wifi\":{"
+                "\"uptime_percent\":%.1f,"
+                "\"rssi_dbm\":%d,"
+                "\"reconnects\":%lu"
+            "},"
+            "\"distributions\":{",
+            local_stats.runtime.gga_sent_count_total,
+            local_stats.runtime.gga_vrs_regenerations_total,
+            local_stats.runtime.gga_bytes_saved_total,
+            local_stats.period.wifi_uptime_percent,
+            local_stats.period.wifi_rssi_dbm,
+            local_stats.runtime.wifi_reconnect_count_total
+        );
+    }
+    
+    // Period quantiles and sparse histograms: [gap, count, gap, count, ...]
+    for (int m = 0; m < STATS_METRIC_COUNT && len > 0 && (size_t)len < buffer_size; m++) {
+        statistics_histogram_t histogram;
+        if (!statistics_get_histogram((statistics_metric_t)m, false, &histogram)) {
+            histogram.count = 0;
+            histogram.shift = 0;
+            histogram.bins = 0;
+        }
+        const float* quantiles = local_stats.period.quantiles[m];
+        len += snprintf(buffer + len, buffer_size - len,
+            "%s\"%s\":{"
+                "\"count\":%lu,"
+                "\"p10\":%.*f,"
+                "\"p50\":%.*f,"
+                "\"p90\":%.*f,"
+                "\"p99\":%.*f,"
+                "\"scale\":%d,"
+                "\"shift\":%u,"
+                "\"bins\":[",
+            (m > 0) ? "," : "",
+            metric_names[m],
+            histogram.count,
+            metric_decimals[m], quantiles[0],
+            metric_decimals[m], quantiles[1],
+            metric_decimals[m], quantiles[2],
+            metric_decimals[m], quantiles[3],
+            (int)metric_scales[m],
+            histogram.shift
+        );
+        for (int i = 0; i < histogram.bins && len > 0 && (size_t)len < buffer_size; i++) {
+            len += snprintf(buffer + len, buffer_size - len, "%s%u,%lu",
+                            (i > 0) ? "," : "", histogram.gaps[i], histogram.counts[i]);
+        }
+        if (len > 0 && (size_t)len < buffer_size) {
+            len += snprintf(buffer + len, buffer_size - len, "]}");
+        }
+    }
+    
+    // CPU usage and loop durations per instrumented task
+    if (len > 0 && (size_t)len < buffer_size) {
+        len += snprintf(buffer + len, buffer_size - len,
+            "},"
+            "\"tasks\":{"
+                "\"core_load_percent\":[%.1f,%.1f]",
+            local_stats.period.cpu_core_load_percent[0],
+            local_stats.period.cpu_core_load_percent[1]
+        );
+    }
+    for (int t = 0; t < STATS_TASK_COUNT && len > 0 && (size_t)len < buffer_size; t++) {
+        const statistics_loop_t* loop = &local_stats.period.task_loops[t];
+        len += snprintf(buffer + len, buffer_size - len,
+            ",\"%s\":{"
+                "\"cpu_percent\":%.1f,"
+                "\"loops\":%lu,"
+                "\"avg_us\":%lu,"
+                "\"p50_us\":%lu,"
+                "\"p99_us\":%lu,"
+                "\"max_us\":%lu"
+            "}",
+            loop_task_names[t],
+            local_stats.period.cpu_usage_percent[t],
+            loop->loops,
+            loop->avg_us,
+            loop->p50_us,
+            loop->p99_us,
+            loop->max_us
+        );
+    }
+    
+    if (len > 0 && (size_t)len < buffer_size) {
+        len += snprintf(buffer + len, buffer_size - len, "}}");
+    }
+    
     return (len > 0 && (size_t)len < buffer_size) ? len : -1;
 }
+
+// Metric family names of the OpenMetrics output
+#define METRIC(name) "ntrip_client_" name
+
+// Fix types of runtime time_to_*_sec
+static const char* const time_to_fix_names[3] = {"first", "rtk_float", "rtk_fixed"};
+
+// Statistics copied for one OpenMetrics exposition, with the chunk buffer
+typedef struct {
+    system_statistics_t stats;
+    statistics_tasks_t tasks;
+    statistics_histogram_t histograms[2][STATS_METRIC_COUNT];  // Completed periods, current period
+    char chunk[STATS_OPENMETRICS_CHUNK];
+} openmetrics_snapshot_t;
+
+// Family with one unsigned sample
+static void openmetrics_uint(OpenMetricsWriter& out, const char* name, OpenMetricsType type,
+                             const char* unit, const char* help, uint64_t value) {
+    out.family(name, type, unit, help);
+    out.valueUInt(value);
+}
+
+// Family with one gauge sample with decimals
+static void openmetrics_fixed(OpenMetricsWriter& out, const char* name, const char* unit,
+                              const char* help, double value, uint8_t decimals) {
+    out.family(name, OPENMETRICS_GAUGE, unit, help);
+    out.valueFixed(value, decimals);
+}
+
+// Family with a sample per constellation
+static void openmetrics_constellations(OpenMetricsWriter& out, const char* name, OpenMetricsType type,
+                                       const char* help, const uint32_t* values) {
+    out.family(name, type, NULL, help);
+    for (int i = 0; i < RTCM_CONSTELLATION_COUNT; i++) {
+        out.label("constellation", msm_constellation_names[i]);
+        out.valueUInt(values[i]);
+    }
+}
+
+// Family with the seconds per fix quality
+static void openmetrics_fix_qualities(OpenMetricsWriter& out, const char* name, OpenMetricsType type,
+                                      const char* help, const uint32_t* seconds) {
+    out.family(name, type, "seconds", help);
+    for (uint32_t q = 0; q < 9; q++) {
+        out.label("quality", q);
+        out.valueUInt(seconds[q]);
+    }
+}
+
+// Family with the reported quantiles of a metric
+static void openmetrics_quantiles(OpenMetricsWriter& out, const char* name, const char* help,
+                                  int metric, const float* quantiles) {
+    out.family(name, OPENMETRICS_GAUGE, NULL, help);
+    for (int q = 0; q < STATS_QUANTILE_COUNT; q++) {
+        out.labelFixed("quantile", quantile_levels[q], 2);
+        out.valueFixed(quantiles[q], (uint8_t)metric_decimals[metric]);
+    }
+}
+
+/**
+ * @brief Write a sparse metric histogram with bounds in the unit of the metric
+ * 
+ * The le bound of a bin is the largest value of its last bucket. The top
+ * bucket also holds the values above the histogram range, so it only has
+ * the +Inf bound. WiFi RSSI is recorded as -dBm: its bins are written in
+ * reverse with the negated smallest value as bound.
+ */
+static void openmetrics_histogram(OpenMetricsWriter& out, const char* name, OpenMetricsType type,
+                                  const char* help, int metric, const statistics_histogram_t* histogram) {
+    out.family(name, type, NULL, help);
+    uint32_t first_bucket[STATS_HISTOGRAM_MAX_BINS];
+    uint32_t bin = 0;
+    for (int i = 0; i < histogram->bins; i++) {
+        bin += histogram->gaps[i];
+        first_bucket[i] = bin << histogram->shift;
+    }
+    bool negated = (metric == STATS_METRIC_WIFI_RSSI);
+    uint32_t cumulative = 0;
+    for (int k = 0; k < histogram->bins; k++) {
+        int i = negated ? histogram->bins - 1 - k : k;
+        cumulative += histogram->counts[i];
+        size_t last_bucket = first_bucket[i] + (1u << histogram->shift) - 1;
+        double bound;
+        if (negated) {
+            bound = -(double)LogHistogram::bucketLow(first_bucket[i]);
+        } else if (last_bucket < LOG_HISTOGRAM_BUCKETS - 1) {
+            bound = LogHistogram::bucketHigh(last_bucket) / metric_scales[metric];
+        } else {
+            continue;
+        }
+        out.sample("_bucket");
+        out.labelFixed("le", bound, (uint8_t)metric_decimals[metric]);
+        out.valueUInt(cumulative);
+    }
+    out.sample("_bucket");
+    out.labelFixed("le", INFINITY, 0);
+    out.valueUInt(histogram->count);
+    out.sample(type == OPENMETRICS_GAUGE_HISTOGRAM ? "_gcount" : "_count");
+    out.valueUInt(histogram->count);
+}
+
+// Writer of the caller, for the chunks of the OpenMetrics output
+typedef struct {
+    statistics_write_fn write;
+    void* context;
+} openmetrics_output_t;
+
+static bool openmetrics_flush(const char* data, size_t length, void* context) {
+    openmetrics_output_t* output = (openmetrics_output_t*)context;
+    return output->write(data, length, output->context);
+}
+
+/**
+ * @brief Write all statistics in the OpenMetrics text format (thread-safe)
+ * 
+ * Runtime statistics are counters and gauges named after their fields; the
+ * period statistics are gauges with the prefix period_, so the period
+ * values of the log and the MQTT stats message can be graphed as well.
+ */
+int statistics_write_openmetrics(statistics_write_fn write, void* context) {
+    if (write == NULL) {
+        return -1;
+    }
+    openmetrics_snapshot_t* snapshot = (openmetrics_snapshot_t*)malloc(sizeof(openmetrics_snapshot_t));
+    if (snapshot == NULL) {
+        return -1;
+    }
+    uint64_t totals[STATS_COUNTER_COUNT];
+    int64_t taken_us = read_counters(totals);
+    if (xSemaphoreTake(stats_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        free(snapshot);
+        return -1;
+    }
+    // One consistent copy; the text is generated without the mutex
+    apply_counters(totals, taken_us);
+    memcpy(&snapshot->stats, &stats, sizeof(system_statistics_t));
+    memcpy(&snapshot->tasks, &task_list, sizeof(statistics_tasks_t));
+    for (int m = 0; m < STATS_METRIC_COUNT; m++) {
+        for (int scope = 0; scope < 2; scope++) {
+            const LogHistogram& source = (scope == 0) ? runtime_histograms[m] : period_histograms[m];
+            statistics_histogram_t* histogram = &snapshot->histograms[scope][m];
+            histogram->count = source.getCount();
+            histogram->bins = (uint8_t)source.exportSparse(histogram->gaps, histogram->counts,
+                                                           STATS_HISTOGRAM_MAX_BINS, &histogram->shift);
+        }
+    }
+    xSemaphoreGive(stats_mutex);
+
+    const runtime_statistics_t* rt = &snapshot->stats.runtime;
+    period_statistics_t* pd = &snapshot->stats.period;
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    uint32_t period_sec = tv.tv_sec - snapshot->stats.period_start_time;
+    if (period_sec > 0) {
+        calculate_period_rates(pd, period_sec);
+    }
+
+    openmetrics_output_t output = {write, context};
+    OpenMetricsWriter out(snapshot->chunk, sizeof(snapshot->chunk), openmetrics_flush, &output);
+
+    // System [Runtime]
+    openmetrics_uint(out, METRIC("uptime_seconds"), OPENMETRICS_GAUGE, "seconds",
+                     "Time since boot.", rt->system_uptime_sec);
+    openmetrics_uint(out, METRIC("heap_min_free_bytes"), OPENMETRICS_GAUGE, "bytes",
+                     "Least free heap since boot.", rt->heap_min_free_bytes);
+    out.family(METRIC("stack_min_free_bytes"), OPENMETRICS_GAUGE, "bytes", "Least free stack of a task since it started.");
+    const uint32_t stacks[5] = {rt->stack_hwm_ntrip, rt->stack_hwm_gnss, rt->stack_hwm_dataout,
+                                rt->stack_hwm_stats, rt->stack_hwm_led};
+    const char* const stack_tasks[5] = {"ntrip", "gnss", "data_output", "statistics", "led"};
+    for (int i = 0; i < 5; i++) {
+        out.label("task", stack_tasks[i]);
+        out.valueUInt(stacks[i]);
+    }
+
+    // NTRIP [Runtime]
+    openmetrics_uint(out, METRIC("caster_connected_seconds"), OPENMETRICS_COUNTER, "seconds",
+                     "Time connected to the NTRIP caster since boot.", rt->ntrip_uptime_sec);
+    openmetrics_uint(out, METRIC("caster_reconnects"), OPENMETRICS_COUNTER, NULL,
+                     "Reconnects to the NTRIP caster.", rt->ntrip_reconnect_count);
+    openmetrics_fixed(out, METRIC("caster_reconnect_time_avg_seconds"), "seconds",
+                      "Average time to reconnect to the NTRIP caster.", rt->ntrip_avg_reconnect_time_ms / 1000.0, 3);
+    openmetrics_uint(out, METRIC("caster_auth_failures"), OPENMETRICS_COUNTER, NULL,
+                     "NTRIP authentication failures.", rt->ntrip_auth_failures);
+    openmetrics_uint(out, METRIC("caster_timeouts"), OPENMETRICS_COUNTER, NULL,
+                     "NTRIP timeouts.", rt->ntrip_timeouts_total);
+    openmetrics_uint(out, METRIC("caster_state_change_timestamp_seconds"), OPENMETRICS_GAUGE, "seconds",
+                     "Time of the last NTRIP connection state change.", (uint64_t)rt->last_connection_state_change);
+
+    // RTCM [Runtime]
+    openmetrics_uint(out, METRIC("rtcm_received_bytes"), OPENMETRICS_COUNTER, "bytes",
+                     "RTCM bytes received since boot.", rt->rtcm_bytes_received_total);
+    openmetrics_uint(out, METRIC("rtcm_messages"), OPENMETRICS_COUNTER, NULL,
+                     "RTCM messages received.", rt->rtcm_messages_received_total);
+    openmetrics_uint(out, METRIC("rtcm_data_gaps"), OPENMETRICS_COUNTER, NULL,
+                     "Gaps in the RTCM stream.", rt->rtcm_data_gaps_total);
+    openmetrics_uint(out, METRIC("rtcm_corrupted_messages"), OPENMETRICS_COUNTER, NULL,
+                     "RTCM frames that failed the CRC-24Q check.", rt->rtcm_corrupted_count_total);
+    openmetrics_uint(out, METRIC("rtcm_queue_overflows"), OPENMETRICS_COUNTER, NULL,
+                     "RTCM queue overflows.", rt->rtcm_queue_overflows_total);
+    openmetrics_uint(out, METRIC("rtcm_queue_peak"), OPENMETRICS_GAUGE, NULL,
+                     "Most RTCM queue entries since boot.", rt->rtcm_queue_peak_count);
+    openmetrics_constellations(out, METRIC("rtcm_msm_messages"), OPENMETRICS_COUNTER,
+                               "MSM messages per constellation.", rt->rtcm_msm_messages_total);
+
+    // GNSS fix [Runtime]
+    out.family(METRIC("time_to_fix_seconds"), OPENMETRICS_GAUGE, "seconds", "Time from boot to the first fix of a type, 0 before it.");
+    const uint32_t times_to_fix[3] = {rt->time_to_first_fix_sec, rt->time_to_rtk_float_sec, rt->time_to_rtk_fixed_sec};
+    for (int i = 0; i < 3; i++) {
+        out.label("fix", time_to_fix_names[i]);
+        out.valueUInt(times_to_fix[i]);
+    }
+    openmetrics_fix_qualities(out, METRIC("fix_quality_seconds"), OPENMETRICS_COUNTER,
+                              "Time in each GGA fix quality.", rt->fix_quality_duration_total);
+    openmetrics_uint(out, METRIC("fix_downgrades"), OPENMETRICS_COUNTER, NULL,
+                     "Fix quality downgrades.", rt->fix_downgrades_total);
+    openmetrics_uint(out, METRIC("fix_upgrades"), OPENMETRICS_COUNTER, NULL,
+                     "Fix quality upgrades.", rt->fix_upgrades_total);
+    openmetrics_uint(out, METRIC("fix_duration_seconds"), OPENMETRICS_GAUGE, "seconds",
+                     "Time in the current fix quality.", rt->current_fix_duration_sec);
+    openmetrics_fixed(out, METRIC("hdop_boot_min"), NULL, "Lowest HDOP since boot.", rt->hdop_min_boot, 2);
+    openmetrics_fixed(out, METRIC("hdop_boot_max"), NULL, "Highest HDOP since boot.", rt->hdop_max_boot, 2);
+    openmetrics_uint(out, METRIC("satellites_boot_min"), OPENMETRICS_GAUGE, NULL,
+                     "Fewest satellites since boot.", rt->satellites_min_boot);
+    openmetrics_uint(out, METRIC("satellites_boot_max"), OPENMETRICS_GAUGE, NULL,
+                     "Most satellites since boot.", rt->satellites_max_boot);
+
+    // GGA [Runtime]
+    openmetrics_uint(out, METRIC("gga_sent"), OPENMETRICS_COUNTER, NULL,
+                     "GGA sentences sent to the caster.", rt->gga_sent_count_total);
+    openmetrics_uint(out, METRIC("gga_send_failures"), OPENMETRICS_COUNTER, NULL,
+                     "GGA sentences that could not be sent.", rt->gga_send_failures_total);
+    openmetrics_uint(out, METRIC("gga_queue_overflows"), OPENMETRICS_COUNTER, NULL,
+                     "GGA queue overflows.", rt->gga_queue_overflows_total);
+    openmetrics_uint(out, METRIC("gga_queue_peak"), OPENMETRICS_GAUGE, NULL,
+                     "Most GGA queue entries since boot.", rt->gga_queue_peak_count);
+    openmetrics_uint(out, METRIC("gga_sent_timestamp_seconds"), OPENMETRICS_GAUGE, "seconds",
+                     "Time the last GGA sentence was sent.", (uint64_t)rt->last_gga_sent_time);
+    openmetrics_uint(out, METRIC("gga_vrs_regenerations"), OPENMETRICS_COUNTER, NULL,
+                     "GGA uploads after moving the distance threshold.", rt->gga_vrs_regenerations_total);
+    openmetrics_uint(out, METRIC("gga_fix_change_sends"), OPENMETRICS_COUNTER, NULL,
+                     "GGA uploads after a fix quality change.", rt->gga_fix_change_sends_total);
+    out.family(METRIC("gga_saved_bytes"), OPENMETRICS_GAUGE, "bytes", "GGA uplink bytes saved versus a fixed minimum interval.");
+    out.valueInt(rt->gga_bytes_saved_total);
+
+    // WiFi [Runtime]
+    openmetrics_uint(out, METRIC("wifi_connected_seconds"), OPENMETRICS_COUNTER, "seconds",
+                     "Time connected to the WiFi access point since boot.", rt->wifi_uptime_sec);
+    openmetrics_uint(out, METRIC("wifi_reconnects"), OPENMETRICS_COUNTER, NULL,
+                     "WiFi reconnects.", rt->wifi_reconnect_count_total);
+    out.family(METRIC("wifi_rssi_boot_min_dbm"), OPENMETRICS_GAUGE, NULL, "Weakest WiFi RSSI since boot.");
+    out.valueInt(rt->wifi_rssi_min_boot);
+    out.family(METRIC("wifi_rssi_boot_max_dbm"), OPENMETRICS_GAUGE, NULL, "Strongest WiFi RSSI since boot.");
+    out.valueInt(rt->wifi_rssi_max_boot);
+
+    // Errors [Runtime]
+    openmetrics_uint(out, METRIC("nmea_checksum_errors"), OPENMETRICS_COUNTER, NULL,
+                     "NMEA sentences with a wrong checksum.", rt->nmea_checksum_errors_total);
+    openmetrics_uint(out, METRIC("uart_errors"), OPENMETRICS_COUNTER, NULL,
+                     "GNSS UART errors.", rt->uart_errors_total);
+    openmetrics_uint(out, METRIC("config_load_failures"), OPENMETRICS_COUNTER, NULL,
+                     "Configuration load failures.", rt->config_load_failures_total);
+    openmetrics_uint(out, METRIC("memory_alloc_failures"), OPENMETRICS_COUNTER, NULL,
+                     "Memory allocation failures.", rt->memory_alloc_failures_total);
+    openmetrics_uint(out, METRIC("task_creation_failures"), OPENMETRICS_COUNTER, NULL,
+                     "Task creation failures.", rt->task_creation_failures_total);
+
+    // Distributions of the completed periods [Runtime]
+    static const char* const quantile_families[STATS_METRIC_COUNT] = {
+        METRIC("hdop_quantiles"), METRIC("satellites_quantiles"),
+        METRIC("wifi_rssi_dbm_quantiles"), METRIC("correction_age_seconds_quantiles")
+    };
+    static const char* const histogram_families[STATS_METRIC_COUNT] = {
+        METRIC("hdop_distribution"), METRIC("satellites_distribution"),
+        METRIC("wifi_rssi_dbm_distribution"), METRIC("correction_age_seconds_distribution")
+    };
+    for (int m = 0; m < STATS_METRIC_COUNT; m++) {
+        openmetrics_quantiles(out, quantile_families[m], "Quantiles of the completed periods, sampled every second.",
+                              m, rt->quantiles_boot[m]);
+        openmetrics_histogram(out, histogram_families[m], OPENMETRICS_HISTOGRAM,
+                              "Samples of the completed periods, every second.", m, &snapshot->histograms[0][m]);
+    }
+
+    // Period
+    openmetrics_uint(out, METRIC("period_start_timestamp_seconds"), OPENMETRICS_GAUGE, "seconds",
+                     "Start of the current statistics period.", (uint64_t)snapshot->stats.period_start_time);
+    openmetrics_uint(out, METRIC("period_duration_seconds"), OPENMETRICS_GAUGE, "seconds",
+                     "Duration of the last completed statistics period.", snapshot->stats.period_duration_sec);
+
+    // RTCM [Period]
+    openmetrics_uint(out, METRIC("period_rtcm_received_bytes"), OPENMETRICS_GAUGE, "bytes",
+                     "RTCM bytes received this period.", pd->rtcm_bytes_received);
+    openmetrics_uint(out, METRIC("period_rtcm_bytes_per_second"), OPENMETRICS_GAUGE, NULL,
+                     "RTCM data rate this period.", pd->rtcm_bytes_per_sec);
+    openmetrics_uint(out, METRIC("period_rtcm_messages"), OPENMETRICS_GAUGE, NULL,
+                     "RTCM messages received this period.", pd->rtcm_messages_received);
+    openmetrics_uint(out, METRIC("period_rtcm_messages_per_second"), OPENMETRICS_GAUGE, NULL,
+                     "RTCM message rate this period.", pd->rtcm_message_rate);
+    openmetrics_fixed(out, METRIC("period_rtcm_latency_avg_seconds"), "seconds",
+                      "Average RTCM latency this period.", pd->rtcm_avg_latency_ms / 1000.0, 3);
+    openmetrics_uint(out, METRIC("period_rtcm_data_gaps"), OPENMETRICS_GAUGE, NULL,
+                     "Gaps in the RTCM stream this period.", pd->rtcm_data_gaps);
+    openmetrics_uint(out, METRIC("period_rtcm_gap_seconds"), OPENMETRICS_GAUGE, "seconds",
+                     "Time without RTCM data this period.", pd->rtcm_gap_duration_sec);
+    openmetrics_uint(out, METRIC("period_rtcm_corrupted_messages"), OPENMETRICS_GAUGE, NULL,
+                     "RTCM frames that failed the CRC-24Q check this period.", pd->rtcm_corrupted_count);
+    openmetrics_uint(out, METRIC("period_rtcm_queue_overflows"), OPENMETRICS_GAUGE, NULL,
+                     "RTCM queue overflows this period.", pd->rtcm_queue_overflows);
+    openmetrics_uint(out, METRIC("period_rtcm_queue_avg"), OPENMETRICS_GAUGE, NULL,
+                     "Average RTCM queue entries this period.", pd->rtcm_queue_avg_count);
+    openmetrics_constellations(out, METRIC("period_rtcm_msm_messages"), OPENMETRICS_GAUGE,
+                               "MSM messages per constellation this period.", pd->rtcm_msm_messages);
+    out.family(METRIC("period_rtcm_msm_messages_per_second"), OPENMETRICS_GAUGE, NULL, "MSM message rate per constellation this period.");
+    for (int i = 0; i < RTCM_CONSTELLATION_COUNT; i++) {
+        out.label("constellation", msm_constellation_names[i]);
+        out.valueFixed(pd->rtcm_msm_rate[i], 2);
+    }
+    const uint8_t* msm_values[3] = {pd->rtcm_msm_satellites, pd->rtcm_msm_satellites_max, pd->rtcm_msm_signals};
+    static const char* const msm_families[3][2] = {
+        {METRIC("period_rtcm_msm_satellites"), "Satellites in the last complete MSM epoch."},
+        {METRIC("period_rtcm_msm_satellites_max"), "Most satellites in an MSM epoch this period."},
+        {METRIC("period_rtcm_msm_signals"), "Signal types in the last complete MSM epoch."}
+    };
+    for (int f = 0; f < 3; f++) {
+        out.family(msm_families[f][0], OPENMETRICS_GAUGE, NULL, msm_families[f][1]);
+        for (int i = 0; i < RTCM_CONSTELLATION_COUNT; i++) {
+            out.label("constellation", msm_constellation_names[i]);
+            out.valueUInt(msm_values[f][i]);
+        }
+    }
+
+    // GNSS fix and accuracy [Period]
+    openmetrics_fix_qualities(out, METRIC("period_fix_quality_seconds"), OPENMETRICS_GAUGE,
+                              "Time in each GGA fix quality this period.", pd->fix_quality_duration);
+    openmetrics_fixed(out, METRIC("period_rtk_fixed_stability_percent"), NULL,
+                      "Share of the period in RTK fixed.", pd->rtk_fixed_stability_percent, 1);
+    openmetrics_uint(out, METRIC("period_fix_downgrades"), OPENMETRICS_GAUGE, NULL,
+                     "Fix quality downgrades this period.", pd->fix_downgrades);
+    openmetrics_uint(out, METRIC("period_fix_upgrades"), OPENMETRICS_GAUGE, NULL,
+                     "Fix quality upgrades this period.", pd->fix_upgrades);
+    openmetrics_fixed(out, METRIC("hdop"), NULL, "Current HDOP.", pd->hdop_current, 2);
+    openmetrics_fixed(out, METRIC("period_hdop_min"), NULL, "Lowest HDOP this period.", pd->hdop_min, 2);
+    openmetrics_fixed(out, METRIC("period_hdop_max"), NULL, "Highest HDOP this period.", pd->hdop_max, 2);
+    openmetrics_fixed(out, METRIC("period_hdop_avg"), NULL, "Average HDOP this period.", pd->hdop_avg, 2);
+    openmetrics_fixed(out, METRIC("estimated_accuracy_meters"), "meters",
+                      "Estimated accuracy, HDOP times the UERE of the fix type.", pd->estimated_accuracy_m, 3);
+    openmetrics_uint(out, METRIC("satellites"), OPENMETRICS_GAUGE, NULL, "Satellites used.", pd->satellites_current);
+    openmetrics_uint(out, METRIC("period_satellites_min"), OPENMETRICS_GAUGE, NULL,
+                     "Fewest satellites this period.", pd->satellites_min);
+    openmetrics_uint(out, METRIC("period_satellites_max"), OPENMETRICS_GAUGE, NULL,
+                     "Most satellites this period.", pd->satellites_max);
+    openmetrics_uint(out, METRIC("period_satellites_avg"), OPENMETRICS_GAUGE, NULL,
+                     "Average satellites this period.", pd->satellites_avg);
+    openmetrics_fixed(out, METRIC("baseline_distance_meters"), "meters",
+                      "Distance to the reference station.", pd->baseline_distance_km * 1000.0, 0);
+
+    // Position scatter [Period]
+    const statistics_position_t* position = &pd->position;
+    openmetrics_uint(out, METRIC("period_position_samples"), OPENMETRICS_GAUGE, NULL,
+                     "Positions in the scatter this period.", position->samples);
+    openmetrics_fixed(out, METRIC("period_position_latitude_degrees"), "degrees",
+                      "Mean latitude this period.", position->mean_latitude, 8);
+    openmetrics_fixed(out, METRIC("period_position_longitude_degrees"), "degrees",
+                      "Mean longitude this period.", position->mean_longitude, 8);
+    openmetrics_fixed(out, METRIC("period_position_altitude_meters"), "meters",
+                      "Mean altitude this period.", position->mean_altitude_m, 3);
+    out.family(METRIC("period_position_std_meters"), OPENMETRICS_GAUGE, "meters", "Standard deviation of the positions this period.");
+    out.label("axis", "east");
+    out.valueFixed(position->std_east_m, 4);
+    out.label("axis", "north");
+    out.valueFixed(position->std_north_m, 4);
+    out.label("axis", "up");
+    out.valueFixed(position->std_up_m, 4);
+    out.family(METRIC("period_position_cep_meters"), OPENMETRICS_GAUGE, "meters", "Radius around the mean position holding a share of the positions.");
+    out.labelFixed("probability", 0.5, 2);
+    out.valueFixed(position->cep50_m, 4);
+    out.labelFixed("probability", 0.95, 2);
+    out.valueFixed(position->cep95_m, 4);
+    openmetrics_fixed(out, METRIC("period_position_drms2_meters"), "meters",
+                      "2DRMS, twice the RMS horizontal distance to the mean position.", position->drms2_m, 4);
+
+    // GGA [Period]
+    openmetrics_uint(out, METRIC("period_gga_sent"), OPENMETRICS_GAUGE, NULL,
+                     "GGA sentences sent this period.", pd->gga_sent_count);
+    openmetrics_uint(out, METRIC("period_gga_send_failures"), OPENMETRICS_GAUGE, NULL,
+                     "GGA sentences that could not be sent this period.", pd->gga_send_failures);
+    openmetrics_uint(out, METRIC("period_gga_interval_seconds"), OPENMETRICS_GAUGE, "seconds",
+                     "Actual GGA interval this period.", pd->gga_actual_interval_sec);
+    openmetrics_uint(out, METRIC("period_gga_queue_overflows"), OPENMETRICS_GAUGE, NULL,
+                     "GGA queue overflows this period.", pd->gga_queue_overflows);
+    openmetrics_uint(out, METRIC("period_gga_queue_avg"), OPENMETRICS_GAUGE, NULL,
+                     "Average GGA queue entries this period.", pd->gga_queue_avg_count);
+    openmetrics_uint(out, METRIC("period_gga_vrs_regenerations"), OPENMETRICS_GAUGE, NULL,
+                     "GGA uploads after moving the distance threshold this period.", pd->gga_vrs_regenerations);
+    out.family(METRIC("period_gga_saved_bytes"), OPENMETRICS_GAUGE, "bytes", "GGA uplink bytes saved this period.");
+    out.valueInt(pd->gga_bytes_saved);
+
+    // System health [Period]
+    openmetrics_uint(out, METRIC("period_wifi_connected_seconds"), OPENMETRICS_GAUGE, "seconds",
+                     "Time connected to the WiFi access point this period.", pd->wifi_uptime_sec);
+    openmetrics_fixed(out, METRIC("period_wifi_uptime_percent"), NULL,
+                      "Share of the period connected to WiFi.", pd->wifi_uptime_percent, 1);
+    out.family(METRIC("wifi_rssi_dbm"), OPENMETRICS_GAUGE, NULL, "Current WiFi RSSI.");
+    out.valueInt(pd->wifi_rssi_dbm);
+    out.family(METRIC("period_wifi_rssi_min_dbm"), OPENMETRICS_GAUGE, NULL, "Weakest WiFi RSSI this period.");
+    out.valueInt(pd->wifi_rssi_min);
+    out.family(METRIC("period_wifi_rssi_max_dbm"), OPENMETRICS_GAUGE, NULL, "Strongest WiFi RSSI this period.");
+    out.valueInt(pd->wifi_rssi_max);
+    out.family(METRIC("period_wifi_rssi_avg_dbm"), OPENMETRICS_GAUGE, NULL, "Average WiFi RSSI this period.");
+    out.valueInt(pd->wifi_rssi_avg);
+    openmetrics_uint(out, METRIC("period_wifi_reconnects"), OPENMETRICS_GAUGE, NULL,
+                     "WiFi reconnects this period.", pd->wifi_reconnect_count);
+    openmetrics_uint(out, METRIC("heap_free_bytes"), OPENMETRICS_GAUGE, "bytes", "Free heap.", pd->heap_free_bytes);
+    openmetrics_uint(out, METRIC("heap_largest_block_bytes"), OPENMETRICS_GAUGE, "bytes",
+                     "Largest free heap block.", pd->heap_largest_block);
+
+    // Errors and performance [Period]
+    openmetrics_uint(out, METRIC("period_nmea_checksum_errors"), OPENMETRICS_GAUGE, NULL,
+                     "NMEA sentences with a wrong checksum this period.", pd->nmea_checksum_errors);
+    openmetrics_uint(out, METRIC("period_uart_errors"), OPENMETRICS_GAUGE, NULL,
+                     "GNSS UART errors this period.", pd->uart_errors);
+    openmetrics_uint(out, METRIC("period_caster_timeouts"), OPENMETRICS_GAUGE, NULL,
+                     "NTRIP timeouts this period.", pd->ntrip_timeouts);
+    openmetrics_uint(out, METRIC("period_gnss_update_rate_hertz"), OPENMETRICS_GAUGE, "hertz",
+                     "GNSS update rate this period.", pd->gnss_update_rate_hz);
+    openmetrics_uint(out, METRIC("period_telemetry_output_rate_hertz"), OPENMETRICS_GAUGE, "hertz",
+                     "Telemetry output rate this period.", pd->telemetry_output_rate_hz);
+    openmetrics_fixed(out, METRIC("period_event_latency_seconds"), "seconds",
+                      "Event latency this period.", pd->event_latency_ms / 1000.0, 3);
+
+    // Tasks [Period]
+    out.family(METRIC("period_core_load_percent"), OPENMETRICS_GAUGE, NULL, "Load of a core this period.");
+    for (uint32_t core = 0; core < STATS_CPU_CORE_COUNT; core++) {
+        out.label("core", core);
+        out.valueFixed(pd->cpu_core_load_percent[core], 1);
+    }
+    out.family(METRIC("period_task_cpu_percent"), OPENMETRICS_GAUGE, NULL, "CPU usage of an instrumented task this period, percent of one core.");
+    for (int t = 0; t < STATS_TASK_COUNT; t++) {
+        out.label("task", loop_task_names[t]);
+        out.valueFixed(pd->cpu_usage_percent[t], 1);
+    }
+    out.family(METRIC("period_task_loops"), OPENMETRICS_GAUGE, NULL, "Loop iterations of an instrumented task this period.");
+    for (int t = 0; t < STATS_TASK_COUNT; t++) {
+        out.label("task", loop_task_names[t]);
+        out.valueUInt(pd->task_loops[t].loops);
+    }
+    out.family(METRIC("period_task_loop_seconds"), OPENMETRICS_GAUGE, "seconds", "Quantiles of the loop iterations of an instrumented task this period.");
+    for (int t = 0; t < STATS_TASK_COUNT; t++) {
+        out.label("task", loop_task_names[t]);
+        out.labelFixed("quantile", 0.5, 2);
+        out.valueFixed(pd->task_loops[t].p50_us / 1e6, 6);
+        out.label("task", loop_task_names[t]);
+        out.labelFixed("quantile", 0.99, 2);
+        out.valueFixed(pd->task_loops[t].p99_us / 1e6, 6);
+    }
+    out.family(METRIC("period_task_loop_avg_seconds"), OPENMETRICS_GAUGE, "seconds", "Average loop iteration of an instrumented task this period.");
+    for (int t = 0; t < STATS_TASK_COUNT; t++) {
+        out.label("task", loop_task_names[t]);
+        out.valueFixed(pd->task_loops[t].avg_us / 1e6, 6);
+    }
+    out.family(METRIC("period_task_loop_max_seconds"), OPENMETRICS_GAUGE, "seconds", "Longest loop iteration of an instrumented task this period.");
+    for (int t = 0; t < STATS_TASK_COUNT; t++) {
+        out.label("task", loop_task_names[t]);
+        out.valueFixed(pd->task_loops[t].max_us / 1e6, 6);
+    }
+
+    // All FreeRTOS tasks, with run-time statistics in the build
+    const statistics_tasks_t* tasks = &snapshot->tasks;
+    if (tasks->available) {
+        out.family(METRIC("freertos_task_cpu_percent"), OPENMETRICS_GAUGE, NULL, "CPU usage of a FreeRTOS task this period, percent of one core.");
+        for (int i = 0; i < tasks->task_count; i++) {
+            out.label("task", tasks->tasks[i].name);
+            out.valueFixed(tasks->tasks[i].cpu_percent, 1);
+        }
+        out.family(METRIC("freertos_task_stack_min_free_bytes"), OPENMETRICS_GAUGE, "bytes", "Least free stack of a FreeRTOS task since it started.");
+        for (int i = 0; i < tasks->task_count; i++) {
+            out.label("task", tasks->tasks[i].name);
+            out.valueUInt(tasks->tasks[i].stack_hwm_bytes);
+        }
+        out.family(METRIC("freertos_task_priority"), OPENMETRICS_GAUGE, NULL, "Current priority of a FreeRTOS task.");
+        for (int i = 0; i < tasks->task_count; i++) {
+            out.label("task", tasks->tasks[i].name);
+            out.valueUInt(tasks->tasks[i].priority);
+        }
+    }
+
+    // Distributions [Period]
+    static const char* const period_quantile_families[STATS_METRIC_COUNT] = {
+        METRIC("period_hdop_quantiles"), METRIC("period_satellites_quantiles"),
+        METRIC("period_wifi_rssi_dbm_quantiles"), METRIC("period_correction_age_seconds_quantiles")
+    };
+    static const char* const period_histogram_families[STATS_METRIC_COUNT] = {
+        METRIC("period_hdop_distribution"), METRIC("period_satellites_distribution"),
+        METRIC("period_wifi_rssi_dbm_distribution"), METRIC("period_correction_age_seconds_distribution")
+    };
+    for (int m = 0; m < STATS_METRIC_COUNT; m++) {
+        openmetrics_quantiles(out, period_quantile_families[m], "Quantiles of this period, sampled every second.",
+                              m, pd->quantiles[m]);
+        openmetrics_histogram(out, period_histogram_families[m], OPENMETRICS_GAUGE_HISTOGRAM,
+                              "Samples of this period, every second.", m, &snapshot->histograms[1][m]);
+    }
+
+    bool complete = out.finish();
+    free(snapshot);
+    return complete ? 0 : -2;
+}
+
+// Metric history output: the copied block and the chunk of JSON
+typedef struct {
+    uint8_t block[STATS_HISTORY_BLOCK_SIZE];
+    char chunk[STATS_HISTORY_CHUNK];
+    size_t used;
+    statistics_write_fn write;
+    void* context;
+    bool failed;
+    uint32_t step_sec;
+    uint32_t metrics;       // Mask of the metrics written
+    uint32_t rows;          // Rows written
+} history_output_t;
+
+static void history_flush(history_output_t* out) {
+    if (out->used > 0 && !out->failed && !out->write(out->chunk, out->used, out->context)) {
+        out->failed = true;
+    }
+    out->used = 0;
+}
+
+static void history_append(history_output_t* out, const char* text) {
+    size_t length = strlen(text);
+    while (length > 0 && !out->failed) {
+        if (out->used == sizeof(out->chunk)) {
+            history_flush(out);
+            continue;
+        }
+        size_t n = sizeof(out->chunk) - out->used < length ? sizeof(out->chunk) - out->used : length;
+        memcpy(out->chunk + out->used, text, n);
+        out->used += n;
+        text += n;
+        length -= n;
+    }
+}
+
+// Write one decoded row as [time,value,...]
+static bool history_write_row(uint32_t time, const int32_t* values, void* context) {
+    static const double scales[4] = {1.0, 10.0, 100.0, 1000.0};
+    history_output_t* out = (history_output_t*)context;
+    if (time % out->step_sec != 0) {
+        return true;
+    }
+    char text[24];
+    history_append(out, out->rows == 0 ? "[" : ",[");
+    formatFixed(time, 0, text, sizeof(text));
+    history_append(out, text);
+    for (int m = 0; m < STATS_HISTORY_METRIC_COUNT; m++) {
+        if (out->metrics & (1u << m)) {
+            uint8_t decimals = history_metric_decimals[m];
+            formatFixed(values[m] / scales[decimals], decimals, text, sizeof(text));
+            history_append(out, ",");
+            history_append(out, text);
+        }
+    }
+    history_append(out, "]");
+    out->rows++;
+    return !out->failed;
+}
+
+/**
+ * @brief Write a time range of the metric history as JSON (thread-safe)
+ * 
+ * The mutex is held only to copy one block at a time, so the statistics
+ * keep running while a long range is sent.
+ */
+int statistics_write_history(const statistics_history_query_t* query, statistics_write_fn write, void* context) {
+    if (query == NULL || write == NULL || history_memory == NULL) {
+        return -1;
+    }
+    history_output_t* out = (history_output_t*)malloc(sizeof(history_output_t));
+    if (out == NULL) {
+        return -1;
+    }
+    if (xSemaphoreTake(stats_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        free(out);
+        return -1;
+    }
+    uint32_t uptime = stats.runtime.system_uptime_sec;
+    uint32_t first_block = history.getFirstBlock();
+    uint32_t end_block = history.getEndBlock();
+    uint32_t oldest = history.getOldestTime();
+    uint32_t newest = history.getNewestTime();
+    uint32_t stored_rows = history.getRows();
+    size_t used_bytes = history.getUsedBytes();
+    size_t capacity_bytes = history.getCapacityBytes();
+    xSemaphoreGive(stats_mutex);
+
+    uint32_t from = query->from_sec;
+    uint32_t to = query->to_sec;
+    if (query->last_sec > 0) {
+        from = uptime > query->last_sec ? uptime - query->last_sec : 0;
+        to = uptime;
+    }
+    out->used = 0;
+    out->write = write;
+    out->context = context;
+    out->failed = false;
+    out->step_sec = query->step_sec - query->step_sec % STATS_HISTORY_INTERVAL_SEC;
+    if (out->step_sec == 0) {
+        out->step_sec = STATS_HISTORY_INTERVAL_SEC;
+    }
+    out->metrics = query->metrics & ((1u << STATS_HISTORY_METRIC_COUNT) - 1);
+    if (out->metrics == 0) {
+        out->metrics = (1u << STATS_HISTORY_METRIC_COUNT) - 1;
+    }
+    out->rows = 0;
+
+    char text[96];
+    snprintf(text, sizeof(text), "{\"interval_sec\":%u,\"uptime_sec\":%lu,\"oldest_sec\":%lu,\"newest_sec\":%lu,",
+             STATS_HISTORY_INTERVAL_SEC, uptime, oldest, newest);
+    history_append(out, text);
+    snprintf(text, sizeof(text), "\"stored_rows\":%lu,\"used_bytes\":%u,\"capacity_bytes\":%u,",
+             stored_rows, (unsigned)used_bytes, (unsigned)capacity_bytes);
+    history_append(out, text);
+    snprintf(text, sizeof(text), "\"from_sec\":%lu,\"to_sec\":%lu,\"step_sec\":%lu,\"metrics\":[",
+             from, to, out->step_sec);
+    history_append(out, text);
+    bool first_metric = true;
+    for (int m = 0; m < STATS_HISTORY_METRIC_COUNT; m++) {
+        if (out->metrics & (1u << m)) {
+            history_append(out, first_metric ? "\"" : ",\"");
+            history_append(out, history_metric_names[m]);
+            history_append(out, "\"");
+            first_metric = false;
+        }
+    }
+    history_append(out, "],\"rows\":[");
+
+    for (uint32_t block = first_block; block != end_block && !out->failed; block++) {
+        if (xSemaphoreTake(stats_mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+            continue;
+        }
+        // A block dropped since the start is skipped
+        bool copied = history.copyBlock(block, out->block);
+        xSemaphoreGive(stats_mutex);
+        if (copied) {
+            TimeSeriesStore::decodeBlock(out->block, sizeof(out->block), STATS_HISTORY_METRIC_COUNT,
+                                         STATS_HISTORY_INTERVAL_SEC, from, to, history_write_row, out, NULL);
+        }
+    }
+
+    snprintf(text, sizeof(text), "],\"count\":%lu}", out->rows);
+    history_append(out, text);
+    history_flush(out);
+    int result = out->failed ? -2 : 0;
+    free(out);
+    return result;
+}
@@ -10,6 +10,37 @@
  * - Period: For the duration of the current log interval only
  * 
  * All statistics are held in RAM and reset on system reboot.
+ * 
+ * The RTCM, GGA and fix quality hooks are called from the NTRIP and GNSS hot
+ * paths. They never block: each task writes its own lock-free counters
+ * (lib/StatCounters), which the Statistics Task and the getters fold into
+ * the statistics as a consistent snapshot. Each hook must only be called from
+ * the task named in its description.
+ * 
+ * HDOP, satellites, WiFi RSSI and correction age are also recorded in
+ * fixed-memory log-linear histograms (lib/LogHistogram), one per period and
+ * one for the completed periods since boot, for their quantiles and
+ * distribution.
+ * 
+ * Once per second the latest new position with a fix is added to online
+ * scatter statistics in local east, north, up (lib/PositionScatter):
+ * standard deviations, CEP50, CEP95 and 2DRMS per period, in constant memory.
+ * 
+ * CPU usage per task and per core comes from the FreeRTOS run-time counters
+ * (CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS), sampled once per second
+ * (lib/CpuLoad). The GNSS, NTRIP, Data Output, MQTT and LED tasks report the
+ * duration of every loop iteration with statistics_loop_time(), lock-free
+ * (lib/LoopProfiler).
+ * 
+ * statistics_write_openmetrics() exposes all of it for Prometheus in the
+ * OpenMetrics text format (lib/OpenMetricsWriter).
+ * 
+ * Once per minute STATS_HISTORY_METRIC_COUNT key metrics are added to a
+ * compressed history (lib/TimeSeriesStore) of fixed size, in PSRAM when the
+ * build enables it (STATS_HISTORY_PSRAM_BYTES, about 10 days) and otherwise
+ * in internal RAM (STATS_HISTORY_RAM_BYTES, about 29 hours). When it is full
+ * the oldest hour or so is dropped. statistics_write_history() returns a
+ * time range of it.
  */
 
 #ifndef STATISTICS_TASK_H
@@ -23,6 +54,222 @@ extern "C" {
 #include <stdbool.h>
 #include <time.h>
 
+/**
+ * @brief Number of constellations with decoded RTCM MSM headers.
+ *
+ * Per-constellation arrays are ordered GPS, GLONASS, Galileo, BeiDou.
+ */
+#define RTCM_CONSTELLATION_COUNT 4
+
+/**
+ * @brief Metrics recorded in histograms, once per second.
+ *
+ * Per-metric arrays use this order. The histograms count unsigned integers
+ * in the unit given; quantiles are reported in the unit of the metric.
+ */
+typedef enum {
+    STATS_METRIC_HDOP = 0,          /**< HDOP, recorded x100 */
+    STATS_METRIC_SATELLITES,        /**< Satellites used */
+    STATS_METRIC_WIFI_RSSI,         /**< WiFi RSSI in dBm, recorded as -dBm */
+    STATS_METRIC_CORRECTION_AGE,    /**< Age of the differential corrections in seconds, recorded x10 */
+    STATS_METRIC_COUNT
+} statistics_metric_t;
+
+/**
+ * @brief Quantiles reported per metric: p10, p50, p90 and p99.
+ */
+#define STATS_QUANTILE_COUNT 4
+
+/**
+ * @brief Maximum bins of an exported histogram.
+ */
+#define STATS_HISTOGRAM_MAX_BINS 16
+
+/**
+ * @brief Sparse copy of a metric histogram.
+ *
+ * Bins are the non-empty histogram buckets in ascending order; when there
+ * are more than STATS_HISTOGRAM_MAX_BINS, 2^shift neighbouring buckets are
+ * combined per bin. Bin i covers buckets bin << shift up to
+ * ((bin + 1) << shift) - 1, where bin is the sum of gaps[0..i]. Bucket
+ * bounds follow the LogHistogram layout: buckets 0-7 hold the values 0-7,
+ * then every power of two is split in 8 buckets.
+ */
+typedef struct {
+    uint32_t count;                            /**< Samples */
+    uint8_t shift;                             /**< Buckets combined per bin, as a power of two */
+    uint8_t bins;                              /**< Bins used */
+    uint8_t gaps[STATS_HISTOGRAM_MAX_BINS];    /**< Bin index minus the previous bin index (first: the index) */
+    uint32_t counts[STATS_HISTOGRAM_MAX_BINS]; /**< Samples per bin */
+} statistics_histogram_t;
+
+/**
+ * @brief Tasks with instrumented loops.
+ *
+ * Per-task arrays use this order.
+ */
+typedef enum {
+    STATS_TASK_GNSS = 0,            /**< GNSS Receiver Task */
+    STATS_TASK_NTRIP,               /**< NTRIP Client Task */
+    STATS_TASK_DATA_OUTPUT,         /**< Data Output Task */
+    STATS_TASK_MQTT,                /**< MQTT Client Task */
+    STATS_TASK_LED,                 /**< LED Indicator Task */
+    STATS_TASK_COUNT
+} statistics_task_id_t;
+
+/**
+ * @brief Cores reported in the CPU load (ESP32-S3).
+ */
+#define STATS_CPU_CORE_COUNT 2
+
+/**
+ * @brief Maximum tasks listed by statistics_get_tasks().
+ */
+#define STATS_TASK_LIST_MAX 24
+
+/**
+ * @brief Chunk size of statistics_write_openmetrics() (bytes).
+ */
+#define STATS_OPENMETRICS_CHUNK 1024
+
+/**
+ * @brief Metric history: time between rows (sec).
+ */
+#define STATS_HISTORY_INTERVAL_SEC 60
+
+/**
+ * @brief Metric history memory in PSRAM (bytes), about 10 days.
+ *
+ * Needs CONFIG_SPIRAM; PSRAM is taken with heap_caps_malloc(MALLOC_CAP_SPIRAM).
+ */
+#define STATS_HISTORY_PSRAM_BYTES (256 * 1024)
+
+/**
+ * @brief Metric history memory in internal RAM without PSRAM (bytes), about 29 hours.
+ */
+#define STATS_HISTORY_RAM_BYTES (32 * 1024)
+
+/**
+ * @brief Block size of the metric history (bytes); the unit dropped when full.
+ */
+#define STATS_HISTORY_BLOCK_SIZE 1024
+
+/**
+ * @brief Chunk size of statistics_write_history() (bytes).
+ */
+#define STATS_HISTORY_CHUNK 1024
+
+/**
+ * @brief Metrics of the history, one value each per minute.
+ *
+ * Seconds and counts are those since the previous row, one minute unless
+ * rows were missed; the other metrics are the values at the time of the row.
+ */
+typedef enum {
+    STATS_HISTORY_FIX_QUALITY = 0,          /**< GGA fix quality */
+    STATS_HISTORY_NO_FIX_SEC,               /**< Seconds without a fix */
+    STATS_HISTORY_GPS_SEC,                  /**< Seconds with a GPS fix */
+    STATS_HISTORY_DGPS_SEC,                 /**< Seconds with a DGPS fix */
+    STATS_HISTORY_RTK_FLOAT_SEC,            /**< Seconds with RTK float */
+    STATS_HISTORY_RTK_FIXED_SEC,            /**< Seconds with RTK fixed */
+    STATS_HISTORY_FIX_DOWNGRADES,           /**< Fix quality downgrades */
+    STATS_HISTORY_FIX_UPGRADES,             /**< Fix quality upgrades */
+    STATS_HISTORY_SATELLITES,               /**< Satellites used */
+    STATS_HISTORY_HDOP,                     /**< HDOP */
+    STATS_HISTORY_ACCURACY_M,               /**< Estimated accuracy (m) */
+    STATS_HISTORY_CORRECTION_AGE_SEC,       /**< Age of the differential corrections (sec), 0 without */
+    STATS_HISTORY_BASELINE_KM,              /**< Baseline distance (km) */
+    STATS_HISTORY_RTCM_BYTES,               /**< RTCM bytes received */
+    STATS_HISTORY_RTCM_MESSAGES,            /**< RTCM messages received */
+    STATS_HISTORY_RTCM_CORRUPTED,           /**< RTCM frames failing the CRC-24Q check */
+    STATS_HISTORY_MSM_SATELLITES_GPS,       /**< Satellites in the last GPS MSM epoch */
+    STATS_HISTORY_MSM_SATELLITES_GLONASS,   /**< Satellites in the last GLONASS MSM epoch */
+    STATS_HISTORY_MSM_SATELLITES_GALILEO,   /**< Satellites in the last Galileo MSM epoch */
+    STATS_HISTORY_MSM_SATELLITES_BEIDOU,    /**< Satellites in the last BeiDou MSM epoch */
+    STATS_HISTORY_GGA_SENT,                 /**< GGA sentences sent */
+    STATS_HISTORY_GGA_FAILURES,             /**< GGA send failures */
+    STATS_HISTORY_NTRIP_CONNECTED_SEC,      /**< Seconds connected to the NTRIP caster */
+    STATS_HISTORY_WIFI_RSSI_DBM,            /**< WiFi RSSI (dBm) */
+    STATS_HISTORY_WIFI_CONNECTED_SEC,       /**< Seconds connected to WiFi */
+    STATS_HISTORY_HEAP_FREE_BYTES,          /**< Free heap (bytes) */
+    STATS_HISTORY_HEAP_LARGEST_BLOCK_BYTES, /**< Largest free heap block (bytes) */
+    STATS_HISTORY_HEAP_MIN_FREE_BYTES,      /**< Least free heap since boot (bytes) */
+    STATS_HISTORY_CPU_CORE0_PERCENT,        /**< Load of core 0 this period (percent) */
+    STATS_HISTORY_CPU_CORE1_PERCENT,        /**< Load of core 1 this period (percent) */
+    STATS_HISTORY_METRIC_COUNT
+} statistics_history_metric_t;
+
+/**
+ * @brief Range of the metric history to return.
+ *
+ * Times are seconds since boot, the time base of the history.
+ */
+typedef struct {
+    uint32_t from_sec;         /**< First row time */
+    uint32_t to_sec;           /**< Last row time */
+    uint32_t last_sec;         /**< When > 0: the last last_sec seconds instead of from_sec and to_sec */
+    uint32_t step_sec;         /**< Only rows at a multiple of this time (rounded down to the interval, at least the interval) */
+    uint32_t metrics;          /**< Bit mask of the statistics_history_metric_t to return, 0 for all */
+} statistics_history_query_t;
+
+/**
+ * @brief Loop durations of an instrumented task in one period.
+ *
+ * A loop iteration lasts from the moment the task wakes up until it waits
+ * again, including preemption by higher priority tasks.
+ */
+typedef struct {
+    uint32_t loops;            /**< Loop iterations */
+    uint32_t avg_us;           /**< Average duration (us) */
+    uint32_t p50_us;           /**< Median duration (us) */
+    uint32_t p99_us;           /**< 99th percentile duration (us) */
+    uint32_t max_us;           /**< Longest duration (us) */
+} statistics_loop_t;
+
+/**
+ * @brief CPU usage and stack of one task.
+ */
+typedef struct {
+    char name[16];             /**< Task name */
+    uint32_t task_number;      /**< FreeRTOS task number */
+    uint8_t priority;          /**< Current priority */
+    int8_t core;               /**< Core the task is pinned to, -1 without affinity */
+    uint32_t stack_hwm_bytes;  /**< Least free stack since the task started (bytes) */
+    float cpu_percent;         /**< CPU usage this period (percent of one core) */
+} statistics_task_info_t;
+
+/**
+ * @brief CPU usage of all tasks in the current period.
+ */
+typedef struct {
+    bool available;            /**< Run-time statistics are enabled in the build */
+    uint32_t elapsed_ms;       /**< Time covered by the CPU usage */
+    uint8_t cores;             /**< Cores reported */
+    float core_load_percent[STATS_CPU_CORE_COUNT]; /**< Load per core (100% minus its idle task) */
+    uint8_t task_count;        /**< Tasks listed */
+    statistics_task_info_t tasks[STATS_TASK_LIST_MAX]; /**< Tasks, in FreeRTOS order */
+} statistics_tasks_t;
+
+/**
+ * @brief Measured position scatter of one period.
+ *
+ * Offsets are east, north and up from a reference at the mean position of
+ * the previous period (the first position after boot). CEP is the radius
+ * around the mean position holding 50% or 95% of the positions.
+ */
+typedef struct {
+    uint32_t samples;          /**< Positions recorded */
+    double mean_latitude;      /**< Mean latitude (decimal degrees) */
+    double mean_longitude;     /**< Mean longitude (decimal degrees) */
+    float mean_altitude_m;     /**< Mean altitude (m) */
+    float std_east_m;          /**< Standard deviation east (m) */
+    float std_north_m;         /**< Standard deviation north (m) */
+    float std_up_m;            /**< Standard deviation up (m) */
+    float cep50_m;             /**< CEP50 (m) */
+    float cep95_m;             /**< CEP95 (m) */
+    float drms2_m;             /**< 2DRMS, twice the RMS horizontal distance to the mean (m) */
+} statistics_position_t;
+
 /**
  * @brief Configuration structure for statistics collection.
  */
@@ -49,6 +296,7 @@ typedef struct {
     uint32_t rtcm_data_gaps_total;            /**< Total RTCM data gaps */
     uint32_t rtcm_corrupted_count_total;      /**< Total RTCM corrupted messages */
     uint32_t rtcm_queue_overflows_total;      /**< Total RTCM queue overflows */
+    uint32_t rtcm_msm_messages_total[RTCM_CONSTELLATION_COUNT]; /**< Total MSM messages per constellation */
     // GPS fix metrics [Runtime]
     uint32_t time_to_first_fix_sec;           /**< Time to first GPS fix (sec) */
     uint32_t time_to_rtk_float_sec;           /**< Time to RTK float (sec) */
@@ -67,10 +315,14 @@ typedef struct {
     uint32_t gga_send_failures_total;         /**< Total GGA send failures */
     uint32_t gga_queue_overflows_total;       /**< Total GGA queue overflows */
     time_t last_gga_sent_time;                /**< Last GGA sent timestamp */
+    uint32_t gga_vrs_regenerations_total;     /**< GGA uploads after moving the distance threshold */
+    uint32_t gga_fix_change_sends_total;      /**< GGA uploads after a fix quality change */
+    int64_t gga_bytes_saved_total;            /**< GGA uplink bytes saved versus the fixed gga_interval_sec schedule (may be negative) */
     // System health [Runtime]
     uint32_t wifi_uptime_sec;                 /**< WiFi uptime in seconds */
     int8_t wifi_rssi_min_boot;                /**< Minimum WiFi RSSI since boot */
     int8_t wifi_rssi_max_boot;                /**< Maximum WiFi RSSI since boot */
+    float quantiles_boot[STATS_METRIC_COUNT][STATS_QUANTILE_COUNT]; /**< p10, p50, p90, p99 per metric over the completed periods */
     uint32_t wifi_reconnect_count_total;      /**< Total WiFi reconnects */
     uint32_t heap_min_free_bytes;             /**< Minimum free heap bytes */
     uint32_t stack_hwm_ntrip;                 /**< NTRIP task stack high-water mark */
@@ -104,6 +356,11 @@ typedef struct {
     uint32_t rtcm_gap_duration_sec;        /**< RTCM gap duration (sec) */
     uint32_t rtcm_corrupted_count;         /**< RTCM corrupted messages this period */
     uint32_t rtcm_queue_overflows;         /**< RTCM queue overflows this period */
+    uint32_t rtcm_msm_messages[RTCM_CONSTELLATION_COUNT];     /**< MSM messages per constellation this period */
+    float rtcm_msm_rate[RTCM_CONSTELLATION_COUNT];            /**< MSM message rate per constellation (messages/sec) */
+    uint8_t rtcm_msm_satellites[RTCM_CONSTELLATION_COUNT];    /**< Satellites in last complete MSM epoch */
+    uint8_t rtcm_msm_satellites_max[RTCM_CONSTELLATION_COUNT]; /**< Maximum satellites in an MSM epoch this period */
+    uint8_t rtcm_msm_signals[RTCM_CONSTELLATION_COUNT];       /**< Signal types in last complete MSM epoch */
     // GPS fix metrics [Period]
     uint32_t fix_quality_duration[9];      /**< Seconds in each fix quality state this period */
     float rtk_fixed_stability_percent;     /**< RTK fixed stability percent */
@@ -114,17 +371,20 @@ typedef struct {
     float hdop_min;                        /**< Minimum HDOP this period */
     float hdop_max;                        /**< Maximum HDOP this period */
     float hdop_avg;                        /**< Average HDOP this period */
-    float estimated_accuracy_m;             /**< Estimated accuracy in meters */
+    float estimated_accuracy_m;             /**< Estimated accuracy in meters (HDOP x UERE of the fix type) */
     uint8_t satellites_current;            /**< Current satellites */
     uint8_t satellites_min;                /**< Minimum satellites this period */
     uint8_t satellites_max;                /**< Maximum satellites this period */
     uint8_t satellites_avg;                /**< Average satellites this period */
     float baseline_distance_km;            /**< Baseline distance in km */
+    statistics_position_t position;        /**< Measured position scatter this period */
     // GGA transmission [Period]
     uint32_t gga_sent_count;               /**< GGA sentences sent this period */
     uint32_t gga_send_failures;            /**< GGA send failures this period */
     uint32_t gga_actual_interval_sec;      /**< Actual GGA interval (sec) */
     uint32_t gga_queue_overflows;          /**< GGA queue overflows this period */
+    uint32_t gga_vrs_regenerations;        /**< GGA uploads after moving the distance threshold this period */
+    int32_t gga_bytes_saved;               /**< GGA uplink bytes saved this period */
     // System health [Period]
     uint32_t wifi_uptime_sec;              /**< WiFi uptime this period (sec) */
     float wifi_uptime_percent;             /**< WiFi uptime percent this period */
@@ -132,10 +392,12 @@ typedef struct {
     int8_t wifi_rssi_min;                  /**< Minimum WiFi RSSI this period */
     int8_t wifi_rssi_max;                  /**< Maximum WiFi RSSI this period */
     int8_t wifi_rssi_avg;                  /**< Average WiFi RSSI this period */
+    float quantiles[STATS_METRIC_COUNT][STATS_QUANTILE_COUNT]; /**< p10, p50, p90, p99 per metric this period */
     uint32_t wifi_reconnect_count;         /**< WiFi reconnects this period */
     uint32_t heap_free_bytes;              /**< Free heap bytes this period */
     uint32_t heap_largest_block;           /**< Largest heap block this period */
-    float cpu_usage_percent[5];            /**< CPU usage percent per task */
+    float cpu_usage_percent[STATS_TASK_COUNT];          /**< CPU usage per instrumented task (percent of one core) */
+    float cpu_core_load_percent[STATS_CPU_CORE_COUNT]; /**< Load per core (percent) */
     // Error counters [Period]
     uint32_t nmea_checksum_errors;         /**< NMEA checksum errors this period */
     uint32_t uart_errors;                  /**< UART errors this period */
@@ -143,7 +405,7 @@ typedef struct {
     // Performance metrics [Period]
     uint32_t gnss_update_rate_hz;          /**< GNSS update rate (Hz) */
     uint32_t telemetry_output_rate_hz;     /**< Telemetry output rate (Hz) */
-    uint32_t avg_task_loop_time_ms[5];     /**< Average task loop time (ms) */
+    statistics_loop_t task_loops[STATS_TASK_COUNT]; /**< Loop durations per instrumented task */
     uint32_t event_latency_ms;             /**< Event latency (ms) */
     uint32_t rtcm_queue_avg_count;         /**< RTCM queue average count */
     uint32_t gga_queue_avg_count;          /**< GGA queue average count */
@@ -159,6 +421,19 @@ typedef struct {
     uint32_t period_duration_sec;        /**< Actual duration of completed period */
 } system_statistics_t;
 
+/**
+ * @brief MSM observations from one batch of received RTCM data.
+ *
+ * Filled by the NTRIP task while framing the correction stream and passed
+ * to statistics_rtcm_msm() once per read.
+ */
+typedef struct {
+    uint32_t msm_messages[RTCM_CONSTELLATION_COUNT]; /**< MSM messages seen per constellation */
+    bool epoch_complete[RTCM_CONSTELLATION_COUNT];   /**< An epoch completed for the constellation */
+    uint8_t satellites[RTCM_CONSTELLATION_COUNT];    /**< Satellites in the last completed epoch */
+    uint8_t signals[RTCM_CONSTELLATION_COUNT];       /**< Signal types in the last completed epoch */
+} rtcm_msm_update_t;
+
 /**
  * @brief Initialize the Statistics Task
  * 
@@ -195,6 +470,32 @@ void statistics_get_runtime(runtime_statistics_t* stats);
  */
 void statistics_get_period(period_statistics_t* stats);
 
+/**
+ * @brief Get the histogram of a metric (thread-safe)
+ * 
+ * @param metric Metric to copy
+ * @param runtime true for the completed periods since boot, false for the current period
+ * @param histogram Pointer to structure to receive the sparse histogram
+ * @return true on success, false for an unknown metric or when the statistics are busy
+ */
+bool statistics_get_histogram(statistics_metric_t metric, bool runtime, statistics_histogram_t* histogram);
+
+/**
+ * @brief Get the CPU usage of all tasks this period (thread-safe)
+ * 
+ * @param tasks Pointer to structure to receive the task list
+ * @return true on success, false when the statistics are busy
+ */
+bool statistics_get_tasks(statistics_tasks_t* tasks);
+
+/**
+ * @brief Short name of an instrumented task, e.g. "gnss"
+ * 
+ * @param task Instrumented task
+ * @return Name, or "unknown"
+ */
+const char* statistics_task_name(statistics_task_id_t task);
+
 /**
  * @brief Reset period statistics
  * 
@@ -211,7 +512,7 @@ void statistics_reset_period(void);
 void statistics_ntrip_event(uint8_t event_type);
 
 /**
- * @brief Update RTCM data received counter (called by NTRIP/GNSS tasks)
+ * @brief Update RTCM data received counter (called by NTRIP task, lock-free)
  * 
  * @param bytes Number of bytes received
  * @param messages Number of messages received
@@ -219,19 +520,107 @@ void statistics_ntrip_event(uint8_t event_type);
 void statistics_rtcm_received(uint32_t bytes, uint32_t messages);
 
 /**
- * @brief Update GPS fix quality event (called by GNSS task)
+ * @brief Update per-constellation MSM coverage (called by NTRIP task, lock-free)
+ * 
+ * @param update MSM messages and completed epochs from one read
+ */
+void statistics_rtcm_msm(const rtcm_msm_update_t* update);
+
+/**
+ * @brief Update RTCM corrupted frame counter (called by NTRIP task, lock-free)
  * 
- * @param new_quality New fix quality value (0-8)
+ * @param count Number of frames that failed the CRC-24Q check
+ */
+void statistics_rtcm_corrupted(uint32_t count);
+
+/**
+ * @brief Update GPS fix quality event (called by GNSS task, lock-free)
+ * 
+ * Counts an upgrade or downgrade against the previously reported quality.
+ * 
+ * @param new_quality New fix quality value (0-8, 0 without a valid fix)
  */
 void statistics_fix_quality_changed(uint8_t new_quality);
 
 /**
- * @brief Update GGA transmission counter (called by NTRIP task)
+ * @brief Update GGA transmission counter (called by NTRIP task, lock-free)
  * 
  * @param success true if sent successfully, false if failed
  */
 void statistics_gga_sent(bool success);
 
+/**
+ * @brief Update GGA upload policy counters (called by GNSS task, lock-free)
+ * 
+ * @param reason GgaSendReason of the evaluated GGA (GGA_SEND_NONE if not sent)
+ * @param bytes_saved Change in uplink bytes saved versus a fixed minimum interval
+ */
+void statistics_gga_scheduled(uint8_t reason, int32_t bytes_saved);
+
+/**
+ * @brief Report the duration of one loop iteration (called by the task itself, lock-free)
+ * 
+ * Each task may only report its own loop.
+ * 
+ * @param task Instrumented task
+ * @param duration_us Time from waking up until waiting again (us)
+ */
+void statistics_loop_time(statistics_task_id_t task, uint32_t duration_us);
+
+/**
+ * @brief Receives the OpenMetrics output of the statistics in chunks
+ * 
+ * @param data Output
+ * @param length Bytes of output
+ * @param context Context given to statistics_write_openmetrics()
+ * @return false to stop the output
+ */
+typedef bool (*statistics_write_fn)(const char* data, size_t length, void* context);
+
+/**
+ * @brief Write all statistics in the OpenMetrics text format (thread-safe)
+ * 
+ * Writes the runtime and period statistics, the FreeRTOS task list and the
+ * metric histograms for a Prometheus scrape. The statistics are copied
+ * once; the text is generated in chunks of STATS_OPENMETRICS_CHUNK bytes
+ * and passed to write, so the exposition is never held in RAM.
+ * 
+ * @param write Receives the output
+ * @param context Passed to write
+ * @return 0 on success, -1 without memory or when the statistics are busy
+ *         (nothing written), -2 when write stopped the output
+ */
+int statistics_write_openmetrics(statistics_write_fn write, void* context);
+
+/**
+ * @brief Name of a history metric, e.g. "wifi_rssi_dbm"
+ * 
+ * @param metric History metric
+ * @return Name, or "unknown"
+ */
+const char* statistics_history_metric_name(statistics_history_metric_t metric);
+
+/**
+ * @brief Write a time range of the metric history as JSON (thread-safe)
+ * 
+ * The history is read one block at a time under the statistics mutex; the
+ * JSON is generated in chunks of STATS_HISTORY_CHUNK bytes and passed to
+ * write:
+ * 
+ *     {"interval_sec":60,"uptime_sec":7265,...,"metrics":["fix_quality",...],
+ *      "rows":[[60,4,...],[120,4,...]]}
+ * 
+ * Each row holds its time and the selected metrics in the order of the
+ * metrics member.
+ * 
+ * @param query Range and metrics
+ * @param write Receives the output
+ * @param context Passed to write
+ * @return 0 on success, -1 without history memory or when the statistics
+ *         are busy (nothing written), -2 when write stopped the output
+ */
+int statistics_write_history(const statistics_history_query_t* query, statistics_write_fn write, void* context);
+
 /**
  * @brief Format statistics as JSON string
  * 
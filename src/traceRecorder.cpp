@@ -0,0 +1,157 @@
+/**
+ * @file traceRecorder.cpp
+ * @brief Event trace of the tasks: rings per core and the download
+ */
+
+#include "traceRecorder.h"
+#include "lib/TraceDump.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "Trace";
+
+// Bytes encoded before they are passed to the writer
+#define TRACE_WRITE_CHUNK 512
+
+static TraceRing trace_rings[portNUM_PROCESSORS];
+static bool trace_initialized = false;
+
+// Names in the download, in trace_event_t order
+static const char* const trace_event_names[TRACE_EVENT_COUNT][2] = {
+    {"uart_rx", "bytes"},
+    {"nmea_sentence", "length"},
+    {"rtcm_read", "bytes"},
+    {"rtcm_forward", "bytes"},
+    {"frame_tx", "bytes"},
+    {"mqtt_publish", "bytes"},
+};
+
+esp_err_t trace_recorder_init(void) {
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        if (!trace_rings[core].init(TRACE_RING_RECORDS)) {
+            ESP_LOGE(TAG, "No memory for the trace rings");
+            for (int i = 0; i < core; i++) {
+                trace_rings[i].deinit();
+            }
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    trace_initialized = true;
+    ESP_LOGI(TAG, "Trace recorder: %d records per core", TRACE_RING_RECORDS);
+    return ESP_OK;
+}
+
+void trace_record(trace_event_t event, uint8_t phase, uint32_t arg) {
+    uint16_t task = 0;
+#if defined(CONFIG_FREERTOS_USE_TRACE_FACILITY)
+    task = (uint16_t)uxTaskGetTaskNumber(xTaskGetCurrentTaskHandle());
+#endif
+    // The task may move to the other core right after this; the ring is safe for any writer
+    trace_rings[xPortGetCoreID()].record((uint32_t)esp_timer_get_time(), (uint8_t)event, phase, task, arg);
+}
+
+// Buffered writer of the download
+typedef struct {
+    trace_write_fn write;
+    void* context;
+    uint8_t buffer[TRACE_WRITE_CHUNK];
+    size_t used;
+    bool failed;
+} trace_output_t;
+
+// Space for one entry of at most TRACE_DUMP_EVENT_SIZE bytes
+static uint8_t* trace_output_reserve(trace_output_t* output) {
+    if (output->used + TRACE_DUMP_EVENT_SIZE > sizeof(output->buffer)) {
+        if (!output->failed && !output->write(output->buffer, output->used, output->context)) {
+            output->failed = true;
+        }
+        output->used = 0;
+    }
+    return output->buffer + output->used;
+}
+
+esp_err_t trace_recorder_write(trace_write_fn write, void* context) {
+    if (!trace_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    TraceRecord* records[portNUM_PROCESSORS] = {};
+    size_t counts[portNUM_PROCESSORS] = {};
+    trace_output_t* output = (trace_output_t*)malloc(sizeof(trace_output_t));
+    bool allocated = (output != NULL);
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        records[core] = (TraceRecord*)malloc(TRACE_RING_RECORDS * sizeof(TraceRecord));
+        allocated = allocated && (records[core] != NULL);
+    }
+
+    TaskStatus_t* task_status = NULL;
+    UBaseType_t task_count = 0;
+#if defined(CONFIG_FREERTOS_USE_TRACE_FACILITY)
+    // Room for tasks created while the list is taken
+    UBaseType_t task_slots = uxTaskGetNumberOfTasks() + 4;
+    task_status = (TaskStatus_t*)malloc(task_slots * sizeof(TaskStatus_t));
+    allocated = allocated && (task_status != NULL);
+#endif
+
+    if (!allocated) {
+        ESP_LOGW(TAG, "No memory for a trace download");
+        free(output);
+        free(task_status);
+        for (int core = 0; core < portNUM_PROCESSORS; core++) {
+            free(records[core]);
+        }
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Snapshot first, so the download covers one moment
+    uint32_t records_total = 0;
+    uint32_t skipped = 0;
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        uint32_t written = trace_rings[core].getWritten();
+        counts[core] = trace_rings[core].snapshot(records[core], TRACE_RING_RECORDS);
+        uint32_t window = (written < TRACE_RING_RECORDS) ? written : TRACE_RING_RECORDS;
+        skipped += (window > counts[core]) ? window - counts[core] : 0;
+        records_total += counts[core];
+    }
+    // Taken after the snapshot, so it is later than every record
+    uint64_t now_us = (uint64_t)esp_timer_get_time();
+#if defined(CONFIG_FREERTOS_USE_TRACE_FACILITY)
+    task_count = uxTaskGetSystemState(task_status, task_slots, NULL);
+#endif
+
+    output->write = write;
+    output->context = context;
+    output->used = 0;
+    output->failed = false;
+
+    output->used += TraceDump::encodeHeader(trace_output_reserve(output), now_us, TRACE_EVENT_COUNT,
+                                            (uint16_t)task_count, records_total, skipped);
+    for (int event = 0; event < TRACE_EVENT_COUNT; event++) {
+        output->used += TraceDump::encodeEvent(trace_output_reserve(output), trace_event_names[event][0],
+                                               trace_event_names[event][1]);
+    }
+    for (UBaseType_t i = 0; i < task_count; i++) {
+        output->used += TraceDump::encodeTask(trace_output_reserve(output), task_status[i].xTaskNumber,
+                                              task_status[i].pcTaskName);
+    }
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        for (size_t i = 0; i < counts[core]; i++) {
+            output->used += TraceDump::encodeRecord(trace_output_reserve(output), records[core][i], (uint8_t)core);
+        }
+    }
+    if (output->used > 0 && !output->failed && !output->write(output->buffer, output->used, context)) {
+        output->failed = true;
+    }
+
+    esp_err_t result = output->failed ? ESP_FAIL : ESP_OK;
+    ESP_LOGI(TAG, "Trace download: %lu records, %lu skipped", records_total, skipped);
+    free(output);
+    free(task_status);
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        free(records[core]);
+    }
+    return result;
+}
@@ -0,0 +1,109 @@
+/**
+ * @file traceRecorder.h
+ * @brief Event trace of the tasks, for a timeline of late corrections and frames
+ *
+ * The tasks mark their steps with the TRACE_* macros: UART reads and parsed
+ * sentences in the GNSS task, RTCM reads in the NTRIP task, RTCM forwards
+ * to the receiver, telemetry frames and MQTT publishes. Every mark is a
+ * 16 byte binary record (time, event, begin/end/instant, task, argument) in
+ * a lock-free ring per core (lib/TraceRing); the newest records overwrite
+ * the oldest, so the trace holds the last seconds before a download.
+ *
+ * GET /api/trace downloads the rings in the format of lib/TraceDump. The
+ * host tool in tests/TRACEring converts the download to Chrome trace JSON
+ * for chrome://tracing or ui.perfetto.dev.
+ *
+ * A record costs an atomic increment, four stores and esp_timer_get_time();
+ * it never blocks. Set TRACE_ENABLED to 0 to compile the marks out.
+ *
+ * @author ESP32-S3 NTRIP/GPS/MQTT System
+ * @date 2026
+ */
+
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <esp_err.h>
+
+#include "lib/TraceRing.h"
+
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 1
+#endif
+
+/**
+ * @brief Records per core (16 bytes each)
+ */
+#define TRACE_RING_RECORDS 512
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Traced events
+ */
+typedef enum {
+    TRACE_UART_RX = 0,      ///< NMEA bytes read from the receiver UART (instant, bytes)
+    TRACE_NMEA_SENTENCE,    ///< Sentence validated and parsed (duration, length)
+    TRACE_RTCM_READ,        ///< RTCM read from the caster (instant, bytes)
+    TRACE_RTCM_FORWARD,     ///< RTCM written to the receiver UART (duration, bytes)
+    TRACE_FRAME_TX,         ///< Telemetry frame built and routed (duration, bytes)
+    TRACE_MQTT_PUBLISH,     ///< MQTT message handed to the client (duration, bytes)
+    TRACE_EVENT_COUNT
+} trace_event_t;
+
+/**
+ * @brief Writes a part of a trace download
+ * @return true to continue, false to stop
+ */
+typedef bool (*trace_write_fn)(const uint8_t* data, size_t length, void* context);
+
+/**
+ * @brief Allocate the rings; call before the tasks that record
+ *
+ * Marks before this call are ignored.
+ *
+ * @return ESP_OK on success, ESP_ERR_NO_MEM otherwise
+ */
+esp_err_t trace_recorder_init(void);
+
+/**
+ * @brief Add a record to the ring of the current core
+ *
+ * Use the TRACE_* macros instead, so the marks can be compiled out.
+ *
+ * @param event Event
+ * @param phase TRACE_PHASE_INSTANT, TRACE_PHASE_BEGIN or TRACE_PHASE_END
+ * @param arg Event argument
+ */
+void trace_record(trace_event_t event, uint8_t phase, uint32_t arg);
+
+/**
+ * @brief Write a snapshot of the rings as a lib/TraceDump download
+ *
+ * The writers are not stopped. Called from the HTTP server task.
+ *
+ * @param write Receives the download in parts
+ * @param context Passed to write
+ * @return ESP_OK, ESP_ERR_NO_MEM, ESP_ERR_INVALID_STATE before init, or ESP_FAIL when write stopped
+ */
+esp_err_t trace_recorder_write(trace_write_fn write, void* context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#if TRACE_ENABLED
+#define TRACE_INSTANT(event, arg) trace_record((event), TRACE_PHASE_INSTANT, (uint32_t)(arg))
+#define TRACE_BEGIN(event, arg)   trace_record((event), TRACE_PHASE_BEGIN, (uint32_t)(arg))
+#define TRACE_END(event, arg)     trace_record((event), TRACE_PHASE_END, (uint32_t)(arg))
+#else
+#define TRACE_INSTANT(event, arg) ((void)0)
+#define TRACE_BEGIN(event, arg)   ((void)0)
+#define TRACE_END(event, arg)     ((void)0)
+#endif
+
+#endif // TRACE_RECORDER_H
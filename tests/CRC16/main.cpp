@@ -205,3 +205,38 @@ TEST_CASE("CRC-16 consistency check", "[CRC16][consistency]") {
         REQUIRE(crc1 != crc2);
     }
 }
+
+// Bit-by-bit CRC-16, the former implementation of calculateCRC16
+static uint16_t bitwiseCRC16(const uint8_t* data, size_t length) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= (data[i] << 8);
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+TEST_CASE("CRC-16 table matches the bitwise calculation", "[CRC16][table]") {
+    uint8_t data[512];
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < sizeof(data); i++) {
+        seed = seed * 1103515245u + 12345u;
+        data[i] = (uint8_t)(seed >> 16);
+    }
+
+    SECTION("Every length up to 512 bytes") {
+        for (size_t length = 0; length <= sizeof(data); length++) {
+            REQUIRE(calculateCRC16(data, length) == bitwiseCRC16(data, length));
+        }
+    }
+
+    SECTION("Data in pieces gives the same CRC as in one buffer") {
+        for (size_t split = 0; split <= sizeof(data); split += 7) {
+            uint16_t crc = updateCRC16(CRC16_INIT, data, split);
+            crc = updateCRC16(crc, data + split, sizeof(data) - split);
+            REQUIRE(crc == calculateCRC16(data, sizeof(data)));
+        }
+    }
+}
@@ -0,0 +1,118 @@
+/*!
+ * \file EpochScheduler.h
+ * \brief Decides which GNSS epochs are published as MQTT GNSS messages.
+ *
+ * The MQTT Client Task is woken by every new GNSS epoch and asks the scheduler
+ * whether this epoch is published. Two policies are available:
+ * - every Nth epoch, independent of the receiver rate;
+ * - a millisecond interval, aligned to GNSS time.
+ *
+ * \section epoch_alignment Alignment
+ * For the interval policy the UTC time of day of the epoch is divided into
+ * slots of the interval length, and the first epoch of every slot is
+ * published. With a 1000 ms interval a 10 Hz receiver is therefore published
+ * at every whole second (xx.000), not at whatever phase the task happened to
+ * wake up, and jitter in the arrival time of the sentences has no effect.
+ *
+ * \section epoch_age Sample age
+ * recordSampleAge() takes the time from the reception of the epoch to the
+ * publish call, so the delay added by the publisher can be reported.
+ *
+ * \section epoch_jitter Jitter
+ * recordSendTime() compares the time between two sends with the GNSS time
+ * between their epochs. The difference is the jitter added by the sender:
+ * epochs 100 ms apart that are sent 130 ms apart have 30 ms of jitter.
+ */
+
+#ifndef EPOCH_SCHEDULER_STANDALONE_H
+#define EPOCH_SCHEDULER_STANDALONE_H
+
+#include <cstdint>
+#include <stddef.h>
+
+class EpochScheduler {
+public:
+    EpochScheduler();
+
+    /**
+     * \brief Set the publish policy.
+     * \param[in] intervalMs Publish interval in milliseconds, aligned to GNSS time.
+     * \param[in] everyNth Publish every Nth epoch instead (0 uses the interval).
+     */
+    void configure(uint32_t intervalMs, uint8_t everyNth);
+
+    /**
+     * \brief Publish the next epoch, e.g. after a (re)connect. Counters are kept.
+     */
+    void reset();
+
+    /**
+     * \brief Evaluate one epoch.
+     * \param[in] timeOfDayMs UTC time of day of the epoch in milliseconds.
+     * \return true if this epoch is to be published. An epoch with the same
+     *         time as the previous one is not counted and returns false.
+     */
+    bool onEpoch(uint32_t timeOfDayMs);
+
+    /**
+     * \brief Record the age of a published sample.
+     * \param[in] ageUs Time from reception of the epoch to publishing in microseconds.
+     */
+    void recordSampleAge(uint32_t ageUs);
+
+    /**
+     * \brief Record when a published sample was sent, for the jitter.
+     * \param[in] timeOfDayMs UTC time of day of the epoch of the sample in milliseconds.
+     * \param[in] sentUs Time the sample was sent in microseconds.
+     *
+     * The first send after reset() or configure() has no previous send and
+     * gives no jitter sample.
+     */
+    void recordSendTime(uint32_t timeOfDayMs, int64_t sentUs);
+
+    /** \brief Epochs evaluated since construction. */
+    uint32_t getEpochs() const { return epochs; }
+
+    /** \brief Samples recorded with recordSampleAge(). */
+    uint32_t getPublished() const { return published; }
+
+    uint32_t getLastAgeUs() const { return lastAgeUs; }
+    uint32_t getMaxAgeUs() const { return maxAgeUs; }
+
+    /** \brief Average sample age in microseconds (0 before the first sample). */
+    uint32_t getAverageAgeUs() const { return published > 0 ? (uint32_t)(ageSumUs / published) : 0; }
+
+    /** \brief Jitter samples recorded with recordSendTime(). */
+    uint32_t getJitterSamples() const { return jitterSamples; }
+
+    uint32_t getLastJitterUs() const { return lastJitterUs; }
+    uint32_t getMaxJitterUs() const { return maxJitterUs; }
+
+    /** \brief Average jitter in microseconds (0 before the first sample). */
+    uint32_t getAverageJitterUs() const { return jitterSamples > 0 ? (uint32_t)(jitterSumUs / jitterSamples) : 0; }
+
+private:
+    uint32_t intervalMs;
+    uint8_t everyNth;
+
+    bool haveLastEpoch;
+    uint32_t lastTimeOfDayMs;
+    uint32_t lastSlot;
+    uint8_t epochsSincePublish;
+
+    uint32_t epochs;
+    uint32_t published;
+    uint32_t lastAgeUs;
+    uint32_t maxAgeUs;
+    uint64_t ageSumUs;
+
+    bool haveLastSend;
+    uint32_t lastSendTimeOfDayMs;
+    int64_t lastSentUs;
+    uint32_t jitterSamples;
+    uint32_t lastJitterUs;
+    uint32_t maxJitterUs;
+    uint64_t jitterSumUs;
+};
+
+#endif // EPOCH_SCHEDULER_STANDALONE_H
@@ -0,0 +1,191 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch.hpp"
+#include "EpochScheduler_standalone.h"
+#include <vector>
+
+static const uint32_t MS_PER_DAY = 86400000u;
+
+// Feed epochs at a fixed rate and return the times that were published
+static std::vector<uint32_t> run(EpochScheduler& scheduler, uint32_t startMs, uint32_t periodMs, int count) {
+    std::vector<uint32_t> published;
+    for (int i = 0; i < count; i++) {
+        uint32_t time = (startMs + (uint32_t)i * periodMs) % MS_PER_DAY;
+        if (scheduler.onEpoch(time)) {
+            published.push_back(time);
+        }
+    }
+    return published;
+}
+
+TEST_CASE("Epoch scheduler - First epoch and repeats", "[EpochScheduler]") {
+    EpochScheduler scheduler;
+    scheduler.configure(1000, 0);
+
+    REQUIRE(scheduler.onEpoch(12345678));
+    REQUIRE_FALSE(scheduler.onEpoch(12345678));
+    REQUIRE(scheduler.getEpochs() == 1);
+
+    // reset() publishes the next epoch, also within the same slot
+    REQUIRE_FALSE(scheduler.onEpoch(12345778));
+    scheduler.reset();
+    REQUIRE(scheduler.onEpoch(12345878));
+    REQUIRE(scheduler.getEpochs() == 3);
+}
+
+TEST_CASE("Epoch scheduler - Interval aligned to GNSS time", "[EpochScheduler]") {
+    EpochScheduler scheduler;
+
+    SECTION("1000 ms at 10 Hz publishes every whole second") {
+        scheduler.configure(1000, 0);
+        std::vector<uint32_t> published = run(scheduler, 36000300, 100, 100);
+        REQUIRE(published.size() == 11);
+        REQUIRE(published[0] == 36000300);      // First epoch after reset
+        for (size_t i = 1; i < published.size(); i++) {
+            REQUIRE(published[i] % 1000 == 0);
+        }
+    }
+
+    SECTION("Receiver epochs with an offset publish the first epoch of each slot") {
+        scheduler.configure(1000, 0);
+        std::vector<uint32_t> published = run(scheduler, 36000050, 100, 50);
+        REQUIRE(published.size() == 5);
+        for (size_t i = 1; i < published.size(); i++) {
+            REQUIRE(published[i] % 1000 == 50);
+        }
+    }
+
+    SECTION("200 ms at 10 Hz publishes every other epoch") {
+        scheduler.configure(200, 0);
+        REQUIRE(run(scheduler, 0, 100, 100).size() == 50);
+    }
+
+    SECTION("An interval below the epoch period publishes every epoch") {
+        scheduler.configure(100, 0);
+        REQUIRE(run(scheduler, 0, 1000, 60).size() == 60);
+        scheduler.configure(1, 0);
+        REQUIRE(run(scheduler, 0, 50, 60).size() == 60);
+    }
+
+    SECTION("10 s at 1 Hz publishes at multiples of 10 s") {
+        scheduler.configure(10000, 0);
+        std::vector<uint32_t> published = run(scheduler, 3000, 1000, 60);
+        REQUIRE(published.size() == 7);
+        for (size_t i = 1; i < published.size(); i++) {
+            REQUIRE(published[i] % 10000 == 0);
+        }
+    }
+
+    SECTION("Missing epochs do not delay the next publish") {
+        scheduler.configure(1000, 0);
+        REQUIRE(scheduler.onEpoch(1000));
+        REQUIRE_FALSE(scheduler.onEpoch(1100));
+        REQUIRE(scheduler.onEpoch(4700));       // Three seconds without epochs
+        REQUIRE_FALSE(scheduler.onEpoch(4800));
+        REQUIRE(scheduler.onEpoch(5000));
+    }
+
+    SECTION("Midnight") {
+        scheduler.configure(1000, 0);
+        std::vector<uint32_t> published = run(scheduler, MS_PER_DAY - 2000, 100, 40);
+        std::vector<uint32_t> expected = {MS_PER_DAY - 2000, MS_PER_DAY - 1000, 0, 1000};
+        REQUIRE(published == expected);
+
+        // An interval that does not divide the day still starts a slot at midnight
+        scheduler.configure(7000, 0);
+        REQUIRE(scheduler.onEpoch(MS_PER_DAY - 100));
+        REQUIRE(scheduler.onEpoch(0));
+        REQUIRE_FALSE(scheduler.onEpoch(6900));
+        REQUIRE(scheduler.onEpoch(7000));
+    }
+}
+
+TEST_CASE("Epoch scheduler - Every Nth epoch", "[EpochScheduler]") {
+    EpochScheduler scheduler;
+
+    SECTION("Every 3rd epoch, independent of the time") {
+        scheduler.configure(1000, 3);
+        std::vector<uint32_t> published = run(scheduler, 250, 100, 10);
+        std::vector<uint32_t> expected = {250, 550, 850, 1150};
+        REQUIRE(published == expected);
+    }
+
+    SECTION("Every epoch and every 255th") {
+        scheduler.configure(1000, 1);
+        REQUIRE(run(scheduler, 0, 100, 100).size() == 100);
+        scheduler.configure(1000, 255);
+        REQUIRE(run(scheduler, 0, 100, 511).size() == 3);
+    }
+
+    SECTION("Repeated epochs are not counted") {
+        scheduler.configure(1000, 2);
+        REQUIRE(scheduler.onEpoch(100));
+        REQUIRE_FALSE(scheduler.onEpoch(100));
+        REQUIRE_FALSE(scheduler.onEpoch(200));
+        REQUIRE_FALSE(scheduler.onEpoch(200));
+        REQUIRE(scheduler.onEpoch(300));
+    }
+}
+
+TEST_CASE("Epoch scheduler - Sample age", "[EpochScheduler]") {
+    EpochScheduler scheduler;
+    REQUIRE(scheduler.getAverageAgeUs() == 0);
+
+    scheduler.recordSampleAge(1500);
+    scheduler.recordSampleAge(500);
+    scheduler.recordSampleAge(4000000000u);
+    REQUIRE(scheduler.getPublished() == 3);
+    REQUIRE(scheduler.getLastAgeUs() == 4000000000u);
+    REQUIRE(scheduler.getMaxAgeUs() == 4000000000u);
+    REQUIRE(scheduler.getAverageAgeUs() == 1333334000u);
+
+    // Counters survive configure() and reset()
+    scheduler.configure(500, 0);
+    REQUIRE(scheduler.getPublished() == 3);
+}
+
+TEST_CASE("Epoch scheduler - Send jitter", "[EpochScheduler]") {
+    EpochScheduler scheduler;
+    REQUIRE(scheduler.getAverageJitterUs() == 0);
+
+    // The first send has nothing to compare with
+    scheduler.recordSendTime(1000, 5000000);
+    REQUIRE(scheduler.getJitterSamples() == 0);
+
+    // Sent exactly one epoch period later: no jitter
+    scheduler.recordSendTime(1100, 5100000);
+    REQUIRE(scheduler.getJitterSamples() == 1);
+    REQUIRE(scheduler.getLastJitterUs() == 0);
+
+    // 30 ms late, then 10 ms early
+    scheduler.recordSendTime(1200, 5230000);
+    REQUIRE(scheduler.getLastJitterUs() == 30000);
+    scheduler.recordSendTime(1300, 5320000);
+    REQUIRE(scheduler.getLastJitterUs() == 10000);
+    REQUIRE(scheduler.getMaxJitterUs() == 30000);
+    REQUIRE(scheduler.getAverageJitterUs() == 13333);
+
+    // Skipped epochs are covered by the GNSS time between the sends
+    scheduler.recordSendTime(1600, 5620000);
+    REQUIRE(scheduler.getLastJitterUs() == 0);
+
+    // Across midnight
+    scheduler.reset();
+    scheduler.recordSendTime(MS_PER_DAY - 100, 9000000);
+    scheduler.recordSendTime(100, 9200500);
+    REQUIRE(scheduler.getLastJitterUs() == 500);
+    REQUIRE(scheduler.getJitterSamples() == 5);
+
+    // reset() and configure() start over without a jitter sample; counters are kept
+    scheduler.configure(100, 0);
+    scheduler.recordSendTime(5000, 60000000);
+    REQUIRE(scheduler.getJitterSamples() == 5);
+    REQUIRE(scheduler.getMaxJitterUs() == 30000);
+}
+
+TEST_CASE("Epoch scheduler - Every epoch of a 20 Hz receiver", "[EpochScheduler]") {
+    EpochScheduler scheduler;
+    scheduler.configure(1, 1);
+    std::vector<uint32_t> published = run(scheduler, 43200000, 50, 100);
+    REQUIRE(published.size() == 100);
+    REQUIRE(scheduler.getEpochs() == 100);
+}
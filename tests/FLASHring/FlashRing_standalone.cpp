@@ -0,0 +1,380 @@
+// Standalone build for FlashRing tests using Code::Blocks
+// This file contains a copy of the FlashRing implementation for standalone compilation
+
+#include <cstdint>
+#include <stddef.h>
+#include <string.h>
+
+#include "FlashRing_standalone.h"
+#include "../CRC16/CRC16_standalone.h"
+
+#define FLASH_RING_MAGIC 0x3158424Fu    // "OBX1"
+
+// Record state flags, cleared (programmed to 0) when set
+#define FLAG_COMMITTED 0x01
+#define FLAG_SENT      0x02
+
+#define LENGTH_ERASED 0xFFFF
+
+struct SectorHeader {
+    uint32_t magic;
+    uint32_t sequence;
+    uint32_t eraseCount;
+    uint32_t reserved;
+};
+
+struct RecordHeader {
+    uint16_t length;
+    uint16_t crc;
+    uint8_t tag;
+    uint8_t flags;
+    uint16_t reserved;
+};
+
+static const uint32_t SECTOR_HEADER_SIZE = sizeof(SectorHeader);
+static const uint32_t RECORD_HEADER_SIZE = sizeof(RecordHeader);
+static const uint32_t FLAGS_OFFSET = offsetof(RecordHeader, flags);
+
+// Space taken by a record, 4 byte aligned
+static uint32_t recordSize(uint32_t length) {
+    return RECORD_HEADER_SIZE + ((length + 3) & ~3u);
+}
+
+static bool isPending(const RecordHeader& header) {
+    return (header.flags & FLAG_COMMITTED) == 0 && (header.flags & FLAG_SENT) != 0;
+}
+
+FlashRing::FlashRing()
+    : sectorSize(0),
+      sectorCount(0),
+      mounted(false),
+      headOpen(false),
+      headSector(0),
+      headOffset(0),
+      headSequence(0),
+      tailSector(0),
+      tailOffset(0),
+      records(0),
+      bytes(0),
+      appended(0),
+      drained(0),
+      dropped(0),
+      corrupt(0),
+      flashErrors(0),
+      erases(0),
+      maxSectorErases(0),
+      bytesWritten(0) {
+    memset(&io, 0, sizeof(io));
+}
+
+bool FlashRing::begin(const FlashRingIo& flash, uint32_t size, uint32_t count) {
+    mounted = false;
+    if (count < 2 || size < SECTOR_HEADER_SIZE + RECORD_HEADER_SIZE + 4 || size % 4 != 0 ||
+        flash.read == NULL || flash.write == NULL || flash.erase == NULL) {
+        return false;
+    }
+    io = flash;
+    sectorSize = size;
+    sectorCount = count;
+    headOpen = false;
+    headSector = sectorCount - 1;   // The first sector opened is sector 0
+    headOffset = sectorSize;
+    headSequence = 0;
+    records = 0;
+    bytes = 0;
+    maxSectorErases = 0;
+
+    // The newest sector has the highest sequence number
+    for (uint32_t sector = 0; sector < sectorCount; sector++) {
+        uint32_t sequence;
+        uint32_t eraseCount;
+        if (!readSectorHeader(sector, &sequence, &eraseCount)) {
+            continue;
+        }
+        if (eraseCount > maxSectorErases) {
+            maxSectorErases = eraseCount;
+        }
+        if (!headOpen || (int32_t)(sequence - headSequence) > 0) {
+            headOpen = true;
+            headSector = sector;
+            headSequence = sequence;
+        }
+    }
+    if (headOpen) {
+        headOffset = findEnd(headSector);
+    }
+
+    mounted = true;
+    countBacklog();
+    return true;
+}
+
+size_t FlashRing::maxRecordLength() const {
+    size_t length = sectorSize - SECTOR_HEADER_SIZE - RECORD_HEADER_SIZE;
+    return (length < LENGTH_ERASED) ? length : LENGTH_ERASED - 1;
+}
+
+bool FlashRing::append(uint8_t tag, const uint8_t* data, size_t length) {
+    if (!mounted || length > maxRecordLength()) {
+        return false;
+    }
+
+    uint32_t size = recordSize(length);
+    if (!headOpen || headOffset + size > sectorSize) {
+        if (!openSector()) {
+            return false;
+        }
+    }
+
+    RecordHeader header;
+    header.length = (uint16_t)length;
+    header.crc = calculateCRC16(data, length);
+    header.tag = tag;
+    header.flags = 0xFF;
+    header.reserved = 0xFFFF;
+
+    // Header and data first, the commit flag last
+    uint32_t address = headSector * sectorSize + headOffset;
+    uint8_t committed = (uint8_t)~FLAG_COMMITTED;
+    bool ok = io.write(io.context, address, &header, RECORD_HEADER_SIZE) &&
+              (length == 0 || io.write(io.context, address + RECORD_HEADER_SIZE, data, length)) &&
+              io.write(io.context, address + FLAGS_OFFSET, &committed, 1);
+    uint32_t offset = headOffset;
+    headOffset += size;
+    bytesWritten += RECORD_HEADER_SIZE + length + 1;
+    if (!ok) {
+        flashErrors++;
+        return false;
+    }
+
+    if (records == 0) {
+        tailSector = headSector;
+        tailOffset = offset;
+    }
+    records++;
+    bytes += length;
+    appended++;
+    return true;
+}
+
+bool FlashRing::peek(uint8_t* tag, uint8_t* data, size_t size, size_t* length) {
+    while (records > 0) {
+        RecordHeader header;
+        uint32_t address = tailSector * sectorSize + tailOffset;
+        if (!io.read(io.context, address, &header, RECORD_HEADER_SIZE)) {
+            return false;
+        }
+        if (header.length <= size &&
+            io.read(io.context, address + RECORD_HEADER_SIZE, data, header.length) &&
+            calculateCRC16(data, header.length) == header.crc) {
+            *tag = header.tag;
+            *length = header.length;
+            return true;
+        }
+
+        // Damaged record: skip it for good
+        corrupt++;
+        markSent(header.length);
+    }
+    return false;
+}
+
+bool FlashRing::pop() {
+    if (records == 0) {
+        return false;
+    }
+    RecordHeader header;
+    if (!io.read(io.context, tailSector * sectorSize + tailOffset, &header, RECORD_HEADER_SIZE)) {
+        return false;
+    }
+    drained++;
+    markSent(header.length);
+    return true;
+}
+
+bool FlashRing::readSectorHeader(uint32_t sector, uint32_t* sequence, uint32_t* eraseCount) {
+    SectorHeader header;
+    if (!io.read(io.context, sector * sectorSize, &header, SECTOR_HEADER_SIZE) ||
+        header.magic != FLASH_RING_MAGIC) {
+        return false;
+    }
+    *sequence = header.sequence;
+    *eraseCount = header.eraseCount;
+    return true;
+}
+
+// A sector written in the current lap of the ring
+bool FlashRing::isLive(uint32_t sector) {
+    uint32_t sequence;
+    uint32_t eraseCount;
+    return headOpen && readSectorHeader(sector, &sequence, &eraseCount) &&
+           (uint32_t)(headSequence - sequence) < sectorCount;
+}
+
+// Offset after the last record of a sector
+uint32_t FlashRing::findEnd(uint32_t sector) {
+    uint32_t offset = SECTOR_HEADER_SIZE;
+    while (offset + RECORD_HEADER_SIZE <= sectorSize) {
+        RecordHeader header;
+        if (!io.read(io.context, sector * sectorSize + offset, &header, RECORD_HEADER_SIZE) ||
+            header.length == LENGTH_ERASED) {
+            return offset;
+        }
+        if (offset + recordSize(header.length) > sectorSize) {
+            return sectorSize;      // Damaged header: the sector is full
+        }
+        offset += recordSize(header.length);
+    }
+    return offset;
+}
+
+// Erase the next sector of the ring and make it the head
+bool FlashRing::openSector() {
+    uint32_t next = (headSector + 1) % sectorCount;
+
+    // A full ring overwrites the oldest sector
+    bool overwritten = records > 0 && tailSector == next;
+    if (overwritten) {
+        for (uint32_t offset = tailOffset; offset + RECORD_HEADER_SIZE <= sectorSize;) {
+            RecordHeader header;
+            if (!io.read(io.context, next * sectorSize + offset, &header, RECORD_HEADER_SIZE) ||
+                header.length == LENGTH_ERASED || offset + recordSize(header.length) > sectorSize) {
+                break;
+            }
+            if (isPending(header) && records > 0) {
+                records--;
+                bytes -= (header.length <= bytes) ? header.length : bytes;
+                dropped++;
+            }
+            offset += recordSize(header.length);
+        }
+    }
+
+    uint32_t sequence;
+    uint32_t eraseCount;
+    if (!readSectorHeader(next, &sequence, &eraseCount)) {
+        eraseCount = 0;
+    }
+    eraseCount++;
+
+    // The head moves on also when the flash fails, so a bad sector is skipped next time
+    headSector = next;
+    headOffset = sectorSize;
+    headOpen = true;
+    headSequence++;
+    erases++;
+    if (eraseCount > maxSectorErases) {
+        maxSectorErases = eraseCount;
+    }
+
+    SectorHeader header;
+    header.magic = FLASH_RING_MAGIC;
+    header.sequence = headSequence;
+    header.eraseCount = eraseCount;
+    header.reserved = 0xFFFFFFFF;
+    bool ok = io.erase(io.context, next * sectorSize, sectorSize) &&
+              io.write(io.context, next * sectorSize, &header, SECTOR_HEADER_SIZE);
+    bytesWritten += SECTOR_HEADER_SIZE;
+    if (ok) {
+        headOffset = SECTOR_HEADER_SIZE;
+    } else {
+        flashErrors++;
+    }
+
+    if (overwritten) {
+        seekTail((next + 1) % sectorCount, SECTOR_HEADER_SIZE);
+    }
+    return ok;
+}
+
+// Count the pending records from the oldest sector to the head
+void FlashRing::countBacklog() {
+    records = 0;
+    bytes = 0;
+    tailSector = headSector;
+    tailOffset = headOffset;
+    if (!headOpen) {
+        return;
+    }
+
+    bool tailFound = false;
+    for (uint32_t i = 1; i <= sectorCount; i++) {
+        uint32_t sector = (headSector + i) % sectorCount;
+        if (!isLive(sector)) {
+            continue;
+        }
+        uint32_t end = (sector == headSector) ? headOffset : sectorSize;
+        for (uint32_t offset = SECTOR_HEADER_SIZE; offset + RECORD_HEADER_SIZE <= end;) {
+            RecordHeader header;
+            if (!io.read(io.context, sector * sectorSize + offset, &header, RECORD_HEADER_SIZE) ||
+                header.length == LENGTH_ERASED || offset + recordSize(header.length) > sectorSize) {
+                break;
+            }
+            if (isPending(header)) {
+                if (!tailFound) {
+                    tailFound = true;
+                    tailSector = sector;
+                    tailOffset = offset;
+                }
+                records++;
+                bytes += header.length;
+            }
+            offset += recordSize(header.length);
+        }
+    }
+}
+
+// Point the tail at the first pending record from sector/offset on
+void FlashRing::seekTail(uint32_t sector, uint32_t offset) {
+    for (uint32_t i = 0; records > 0 && i <= sectorCount; i++) {
+        if (sector == headSector || isLive(sector)) {
+            uint32_t end = (sector == headSector) ? headOffset : sectorSize;
+            while (offset + RECORD_HEADER_SIZE <= end) {
+                RecordHeader header;
+                if (!io.read(io.context, sector * sectorSize + offset, &header, RECORD_HEADER_SIZE) ||
+                    header.length == LENGTH_ERASED || offset + recordSize(header.length) > sectorSize) {
+                    break;
+                }
+                if (isPending(header)) {
+                    tailSector = sector;
+                    tailOffset = offset;
+                    return;
+                }
+                offset += recordSize(header.length);
+            }
+        }
+        if (sector == headSector) {
+            break;
+        }
+        sector = (sector + 1) % sectorCount;
+        offset = SECTOR_HEADER_SIZE;
+    }
+
+    // Nothing pending up to the head
+    records = 0;
+    bytes = 0;
+    tailSector = headSector;
+    tailOffset = headOffset;
+}
+
+// Mark the tail record sent and move on to the next one
+void FlashRing::markSent(uint32_t length) {
+    uint8_t sent = (uint8_t)~(FLAG_COMMITTED | FLAG_SENT);
+    if (io.write(io.context, tailSector * sectorSize + tailOffset + FLAGS_OFFSET, &sent, 1)) {
+        bytesWritten++;
+    } else {
+        flashErrors++;
+    }
+    records--;
+    bytes -= (length <= bytes) ? length : bytes;
+
+    uint32_t next = tailOffset + recordSize(length);
+    if (records == 0) {
+        tailSector = headSector;
+        tailOffset = headOffset;
+    } else if (next + RECORD_HEADER_SIZE <= sectorSize) {
+        seekTail(tailSector, next);
+    } else {
+        seekTail((tailSector + 1) % sectorCount, SECTOR_HEADER_SIZE);
+    }
+}
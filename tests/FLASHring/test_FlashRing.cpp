@@ -0,0 +1,331 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch.hpp"
+#include "FlashRing_standalone.h"
+#include <string.h>
+#include <deque>
+#include <random>
+#include <vector>
+
+// Small sectors so the tests wrap the ring many times
+static const uint32_t SECTOR_SIZE = 512;
+static const uint32_t SECTOR_COUNT = 8;
+
+/**
+ * NOR flash stand-in: erase sets all bits to 1, programming only clears bits.
+ * A power cut is simulated with a budget of bytes that can still be programmed.
+ */
+struct SimulatedFlash {
+    std::vector<uint8_t> memory;
+    std::vector<uint32_t> sectorErases;
+    long writeBudget;           // -1 = no power cut
+    uint32_t bitsSet;           // Writes that tried to set a programmed bit back to 1
+
+    explicit SimulatedFlash(uint32_t sectors)
+        : memory(sectors * SECTOR_SIZE, 0xFF), sectorErases(sectors, 0), writeBudget(-1), bitsSet(0) {}
+};
+
+static bool simRead(void* context, uint32_t address, void* data, size_t length) {
+    SimulatedFlash* flash = (SimulatedFlash*)context;
+    if (address + length > flash->memory.size()) {
+        return false;
+    }
+    memcpy(data, &flash->memory[address], length);
+    return true;
+}
+
+static bool simWrite(void* context, uint32_t address, const void* data, size_t length) {
+    SimulatedFlash* flash = (SimulatedFlash*)context;
+    if (address + length > flash->memory.size()) {
+        return false;
+    }
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (size_t i = 0; i < length; i++) {
+        if (flash->writeBudget == 0) {
+            return false;
+        }
+        if (flash->writeBudget > 0) {
+            flash->writeBudget--;
+        }
+        if ((bytes[i] & ~flash->memory[address + i]) != 0) {
+            flash->bitsSet++;
+        }
+        flash->memory[address + i] &= bytes[i];
+    }
+    return true;
+}
+
+static bool simErase(void* context, uint32_t address, size_t length) {
+    SimulatedFlash* flash = (SimulatedFlash*)context;
+    if (address % SECTOR_SIZE != 0 || length != SECTOR_SIZE || address + length > flash->memory.size() ||
+        flash->writeBudget == 0) {
+        return false;
+    }
+    memset(&flash->memory[address], 0xFF, length);
+    flash->sectorErases[address / SECTOR_SIZE]++;
+    return true;
+}
+
+static bool mount(FlashRing& ring, SimulatedFlash& flash) {
+    FlashRingIo io = {simRead, simWrite, simErase, &flash};
+    return ring.begin(io, SECTOR_SIZE, (uint32_t)flash.sectorErases.size());
+}
+
+// Record n: a length between 1 and 150 bytes and a pattern derived from n
+static std::vector<uint8_t> makeRecord(uint32_t n) {
+    std::vector<uint8_t> data(1 + (n * 37) % 150);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = (uint8_t)(n * 31 + i);
+    }
+    memcpy(&data[0], &n, data.size() < 4 ? data.size() : 4);
+    return data;
+}
+
+static bool append(FlashRing& ring, uint32_t n) {
+    std::vector<uint8_t> data = makeRecord(n);
+    return ring.append((uint8_t)(n % 3), &data[0], data.size());
+}
+
+// Read, compare and pop the next record
+static bool drainNext(FlashRing& ring, uint32_t expected) {
+    uint8_t tag = 0;
+    uint8_t buffer[512];
+    size_t length = 0;
+    if (!ring.peek(&tag, buffer, sizeof(buffer), &length)) {
+        return false;
+    }
+    std::vector<uint8_t> data = makeRecord(expected);
+    bool same = tag == expected % 3 && length == data.size() && memcmp(buffer, &data[0], length) == 0;
+    return ring.pop() && same;
+}
+
+TEST_CASE("FlashRing - Records are drained in order and survive a restart", "[FlashRing]") {
+    SimulatedFlash flash(SECTOR_COUNT);
+    FlashRing ring;
+    REQUIRE(mount(ring, flash));
+    REQUIRE(ring.getRecords() == 0);
+    uint8_t tag;
+    uint8_t buffer[16];
+    size_t length;
+    REQUIRE_FALSE(ring.peek(&tag, buffer, sizeof(buffer), &length));
+    REQUIRE_FALSE(ring.pop());
+
+    uint32_t totalBytes = 0;
+    for (uint32_t n = 0; n < 30; n++) {
+        REQUIRE(append(ring, n));
+        totalBytes += (uint32_t)makeRecord(n).size();
+    }
+    REQUIRE(ring.getRecords() == 30);
+    REQUIRE(ring.getBytes() == totalBytes);
+    for (uint32_t n = 0; n < 10; n++) {
+        REQUIRE(drainNext(ring, n));
+    }
+
+    // Restart: the records that were drained stay drained
+    FlashRing restarted;
+    REQUIRE(mount(restarted, flash));
+    REQUIRE(restarted.getRecords() == 20);
+    for (uint32_t n = 30; n < 40; n++) {
+        REQUIRE(append(restarted, n));
+    }
+    for (uint32_t n = 10; n < 40; n++) {
+        REQUIRE(drainNext(restarted, n));
+    }
+    REQUIRE(restarted.getRecords() == 0);
+    REQUIRE(restarted.getBytes() == 0);
+    REQUIRE(restarted.getDrained() == 30);
+    REQUIRE(flash.bitsSet == 0);
+
+    // Empty after a restart too
+    FlashRing empty;
+    REQUIRE(mount(empty, flash));
+    REQUIRE(empty.getRecords() == 0);
+}
+
+TEST_CASE("FlashRing - Geometry and record length limits", "[FlashRing]") {
+    SimulatedFlash flash(SECTOR_COUNT);
+    FlashRing ring;
+    FlashRingIo io = {simRead, simWrite, simErase, &flash};
+    REQUIRE_FALSE(ring.begin(io, SECTOR_SIZE, 1));
+    REQUIRE_FALSE(ring.begin(io, 16, SECTOR_COUNT));
+    REQUIRE_FALSE(ring.append(0, NULL, 0));
+    REQUIRE(mount(ring, flash));
+    REQUIRE(ring.getCapacity() == SECTOR_SIZE * SECTOR_COUNT);
+
+    std::vector<uint8_t> large(ring.maxRecordLength() + 1, 0x55);
+    REQUIRE_FALSE(ring.append(1, &large[0], large.size()));
+    REQUIRE(ring.append(1, &large[0], large.size() - 1));
+    REQUIRE(ring.append(2, &large[0], 0));
+    REQUIRE(ring.getRecords() == 2);
+
+    // A buffer too small for a record skips it
+    uint8_t tag;
+    uint8_t small[8];
+    size_t length;
+    REQUIRE(ring.peek(&tag, small, sizeof(small), &length));
+    REQUIRE(tag == 2);
+    REQUIRE(length == 0);
+    REQUIRE(ring.getCorrupt() == 1);
+}
+
+TEST_CASE("FlashRing - A full ring drops the oldest records", "[FlashRing]") {
+    SimulatedFlash flash(SECTOR_COUNT);
+    FlashRing ring;
+    REQUIRE(mount(ring, flash));
+
+    const uint32_t total = 1000;
+    for (uint32_t n = 0; n < total; n++) {
+        REQUIRE(append(ring, n));
+        REQUIRE(ring.getRecords() + ring.getDropped() == n + 1);
+    }
+    REQUIRE(ring.getDropped() > 0);
+    REQUIRE(ring.getBytes() < ring.getCapacity());
+
+    // The newest records remain, without a gap
+    uint32_t first = ring.getDropped();
+    FlashRing restarted;
+    REQUIRE(mount(restarted, flash));
+    REQUIRE(restarted.getRecords() == total - first);
+    for (uint32_t n = first; n < total; n++) {
+        REQUIRE(drainNext(restarted, n));
+    }
+    REQUIRE(restarted.getRecords() == 0);
+}
+
+TEST_CASE("FlashRing - Power loss during append", "[FlashRing]") {
+    // The record after 5 records fits in the first sector, after 6 it needs a new one
+    const uint32_t firstRecords[] = {5, 6};
+    for (uint32_t before : firstRecords) {
+        for (long cut = 0; cut < 200; cut++) {
+            SimulatedFlash flash(SECTOR_COUNT);
+            FlashRing ring;
+            REQUIRE(mount(ring, flash));
+            for (uint32_t n = 0; n < before; n++) {
+                REQUIRE(append(ring, n));
+            }
+            REQUIRE(drainNext(ring, 0));
+
+            flash.writeBudget = cut;
+            bool appended = append(ring, before);
+            flash.writeBudget = -1;
+
+            FlashRing restarted;
+            REQUIRE(mount(restarted, flash));
+            // The record exists only when its commit flag was written
+            REQUIRE(restarted.getRecords() == before - 1 + (appended ? 1 : 0));
+
+            // Earlier records are intact and the ring keeps working
+            REQUIRE(append(restarted, 100));
+            for (uint32_t n = 1; n < before; n++) {
+                REQUIRE(drainNext(restarted, n));
+            }
+            if (appended) {
+                REQUIRE(drainNext(restarted, before));
+            }
+            REQUIRE(drainNext(restarted, 100));
+            REQUIRE(restarted.getRecords() == 0);
+            REQUIRE(restarted.getCorrupt() == 0);
+        }
+    }
+}
+
+TEST_CASE("FlashRing - Damaged records are skipped", "[FlashRing]") {
+    SimulatedFlash flash(SECTOR_COUNT);
+    FlashRing ring;
+    REQUIRE(mount(ring, flash));
+    for (uint32_t n = 0; n < 6; n++) {
+        REQUIRE(append(ring, n));
+    }
+
+    // Flip a bit in the data of record 3
+    uint32_t offset = 16;
+    for (uint32_t n = 0; n < 3; n++) {
+        offset += 8 + (((uint32_t)makeRecord(n).size() + 3) & ~3u);
+    }
+    flash.memory[offset + 8] ^= 0x10;
+
+    REQUIRE(drainNext(ring, 0));
+    REQUIRE(drainNext(ring, 1));
+    REQUIRE(drainNext(ring, 2));
+    REQUIRE(drainNext(ring, 4));
+    REQUIRE(drainNext(ring, 5));
+    REQUIRE(ring.getCorrupt() == 1);
+    REQUIRE(ring.getDrained() == 5);
+    REQUIRE(ring.getRecords() == 0);
+}
+
+TEST_CASE("FlashRing - Wear is spread evenly and kept across restarts", "[FlashRing]") {
+    SimulatedFlash flash(SECTOR_COUNT);
+    FlashRing ring;
+    REQUIRE(mount(ring, flash));
+
+    // An outage that fills half the ring, drained after every reconnect
+    uint32_t n = 0;
+    uint32_t next = 0;
+    for (int outage = 0; outage < 200; outage++) {
+        for (int i = 0; i < 15; i++) {
+            REQUIRE(append(ring, n++));
+        }
+        while (ring.getRecords() > 0) {
+            REQUIRE(drainNext(ring, next++));
+        }
+    }
+    REQUIRE(ring.getDropped() == 0);
+
+    uint32_t lowest = flash.sectorErases[0];
+    uint32_t highest = flash.sectorErases[0];
+    uint32_t total = 0;
+    for (uint32_t erases : flash.sectorErases) {
+        lowest = erases < lowest ? erases : lowest;
+        highest = erases > highest ? erases : highest;
+        total += erases;
+    }
+    REQUIRE(highest - lowest <= 1);
+    REQUIRE(ring.getErases() == total);
+    REQUIRE(ring.getMaxSectorErases() == highest);
+    REQUIRE(ring.getBytesWritten() > 0);
+    REQUIRE(flash.bitsSet == 0);
+
+    // The erase count is kept in flash
+    FlashRing restarted;
+    REQUIRE(mount(restarted, flash));
+    REQUIRE(restarted.getErases() == 0);
+    REQUIRE(restarted.getMaxSectorErases() == highest);
+}
+
+TEST_CASE("FlashRing - Random appends, drains and restarts match a queue", "[FlashRing]") {
+    std::mt19937 rng(36);
+    SimulatedFlash flash(SECTOR_COUNT);
+    FlashRing* ring = new FlashRing();
+    REQUIRE(mount(*ring, flash));
+    std::deque<uint32_t> model;
+    uint32_t n = 0;
+
+    for (int step = 0; step < 20000; step++) {
+        uint32_t action = rng() % 100;
+        if (action < 55) {
+            uint32_t droppedBefore = ring->getDropped();
+            REQUIRE(append(*ring, n));
+            model.push_back(n++);
+            for (uint32_t d = droppedBefore; d < ring->getDropped(); d++) {
+                model.pop_front();
+            }
+        } else if (action < 98) {
+            if (model.empty()) {
+                uint8_t tag;
+                uint8_t buffer[512];
+                size_t length;
+                REQUIRE_FALSE(ring->peek(&tag, buffer, sizeof(buffer), &length));
+            } else {
+                REQUIRE(drainNext(*ring, model.front()));
+                model.pop_front();
+            }
+        } else {
+            delete ring;
+            ring = new FlashRing();
+            REQUIRE(mount(*ring, flash));
+        }
+        REQUIRE(ring->getRecords() == model.size());
+    }
+    delete ring;
+    REQUIRE(flash.bitsSet == 0);
+}
@@ -0,0 +1,225 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch.hpp"
+#include "GGAScheduler_standalone.h"
+#include <math.h>
+
+// Firmware defaults: 100 m, 10 s minimum, 120 s maximum interval
+static const uint32_t DISTANCE_M = 100;
+static const uint32_t MIN_MS = 10000;
+static const uint32_t MAX_MS = 120000;
+static const size_t GGA_LENGTH = 80;
+
+static const double START_LAT = 52.2155;
+static const double START_LON = 6.0090;
+
+// Reference distance on a sphere (haversine) in meters
+static double haversine(double lat1, double lon1, double lat2, double lon2) {
+    const double r = 6371000.0;
+    const double rad = M_PI / 180.0;
+    double dLat = (lat2 - lat1) * rad;
+    double dLon = (lon2 - lon1) * rad;
+    double a = sin(dLat / 2) * sin(dLat / 2) + cos(lat1 * rad) * cos(lat2 * rad) * sin(dLon / 2) * sin(dLon / 2);
+    return 2 * r * asin(sqrt(a));
+}
+
+// Position moved east by a number of meters
+static double eastOf(double lat, double lon, double meters) {
+    return lon + meters / (111194.93 * cos(lat * M_PI / 180.0));
+}
+
+TEST_CASE("GGA scheduler - First valid fix is sent, no fix never", "[GGAScheduler]") {
+    GGAScheduler scheduler;
+    scheduler.configure(DISTANCE_M, MIN_MS, MAX_MS);
+
+    REQUIRE(scheduler.evaluate(0, 0.0, 0.0, 0, GGA_LENGTH) == GGA_SEND_NONE);
+    REQUIRE(scheduler.evaluate(1000, START_LAT, START_LON, 1, GGA_LENGTH) == GGA_SEND_FIRST);
+    REQUIRE(scheduler.evaluate(2000, START_LAT, START_LON, 1, GGA_LENGTH) == GGA_SEND_NONE);
+    REQUIRE(scheduler.evaluate(MAX_MS * 10, START_LAT, START_LON, 0, GGA_LENGTH) == GGA_SEND_NONE);
+    REQUIRE(scheduler.getSendCount(GGA_SEND_FIRST) == 1);
+    REQUIRE(scheduler.getBytesSent() == GGA_LENGTH);
+}
+
+TEST_CASE("GGA scheduler - Stationary rover only sends on the maximum interval", "[GGAScheduler]") {
+    GGAScheduler scheduler;
+    scheduler.configure(DISTANCE_M, MIN_MS, MAX_MS);
+
+    // One hour at 1 Hz with 2 m position noise
+    int sends = 0;
+    for (uint32_t t = 0; t < 3600; t++) {
+        double noise = ((t * 7919) % 5) - 2.0;
+        if (scheduler.evaluate(t * 1000, START_LAT, eastOf(START_LAT, START_LON, noise), 4, GGA_LENGTH) != GGA_SEND_NONE) {
+            sends++;
+        }
+    }
+    REQUIRE(sends == 1 + 3599 / 120);
+    REQUIRE(scheduler.getSendCount(GGA_SEND_MAX_INTERVAL) == 29);
+    REQUIRE(scheduler.getSendCount(GGA_SEND_DISTANCE) == 0);
+
+    // The fixed 120 s schedule sends the same 30 sentences: nothing saved, nothing spent
+    REQUIRE(scheduler.getBaselineBytes() == 30 * GGA_LENGTH);
+    REQUIRE(scheduler.getBytesSaved() == 0);
+}
+
+TEST_CASE("GGA scheduler - Moving rover sends after the distance threshold", "[GGAScheduler]") {
+    GGAScheduler scheduler;
+    scheduler.configure(DISTANCE_M, MIN_MS, MAX_MS);
+
+    SECTION("Walking speed: one upload per 100 m") {
+        // 1.5 m/s east for 10 minutes at 1 Hz
+        double lastSentMeters = 0.0;
+        for (uint32_t t = 0; t <= 600; t++) {
+            double meters = 1.5 * t;
+            GgaSendReason reason = scheduler.evaluate(t * 1000, START_LAT, eastOf(START_LAT, START_LON, meters), 4, GGA_LENGTH);
+            if (reason == GGA_SEND_DISTANCE) {
+                REQUIRE(meters - lastSentMeters >= 99.0);
+                REQUIRE(meters - lastSentMeters <= 101.5);
+            }
+            if (reason != GGA_SEND_NONE) {
+                lastSentMeters = meters;
+            }
+        }
+        REQUIRE(scheduler.getSendCount(GGA_SEND_DISTANCE) == 8);
+    }
+
+    SECTION("Highway speed: limited by the minimum interval") {
+        // 33 m/s, the threshold is passed every 3 s
+        for (uint32_t t = 0; t <= 600; t++) {
+            scheduler.evaluate(t * 1000, START_LAT, eastOf(START_LAT, START_LON, 33.0 * t), 4, GGA_LENGTH);
+        }
+        REQUIRE(scheduler.getSendCount(GGA_SEND_DISTANCE) == 60);
+        // 61 uploads where the fixed 120 s schedule sends 6
+        REQUIRE(scheduler.getBaselineBytes() == 6 * GGA_LENGTH);
+        REQUIRE(scheduler.getBytesSaved() == -55 * (int64_t)GGA_LENGTH);
+    }
+
+    SECTION("Distance trigger disabled") {
+        scheduler.configure(0, MIN_MS, MAX_MS);
+        for (uint32_t t = 0; t <= 600; t++) {
+            scheduler.evaluate(t * 1000, START_LAT, eastOf(START_LAT, START_LON, 33.0 * t), 4, GGA_LENGTH);
+        }
+        REQUIRE(scheduler.getSendCount(GGA_SEND_DISTANCE) == 0);
+        REQUIRE(scheduler.getSendCount(GGA_SEND_MAX_INTERVAL) == 5);
+    }
+}
+
+TEST_CASE("GGA scheduler - Fix changes are sent after the minimum interval", "[GGAScheduler]") {
+    GGAScheduler scheduler;
+    scheduler.configure(DISTANCE_M, MIN_MS, MAX_MS);
+
+    REQUIRE(scheduler.evaluate(0, START_LAT, START_LON, 5, GGA_LENGTH) == GGA_SEND_FIRST);
+    REQUIRE(scheduler.evaluate(3000, START_LAT, START_LON, 4, GGA_LENGTH) == GGA_SEND_NONE);
+    REQUIRE(scheduler.evaluate(10000, START_LAT, START_LON, 4, GGA_LENGTH) == GGA_SEND_FIX_CHANGE);
+    REQUIRE(scheduler.evaluate(15000, START_LAT, START_LON, 4, GGA_LENGTH) == GGA_SEND_NONE);
+
+    // Losing the fix is not sent, regaining a different fix is
+    REQUIRE(scheduler.evaluate(30000, START_LAT, START_LON, 0, GGA_LENGTH) == GGA_SEND_NONE);
+    REQUIRE(scheduler.evaluate(31000, START_LAT, START_LON, 1, GGA_LENGTH) == GGA_SEND_FIX_CHANGE);
+}
+
+TEST_CASE("GGA scheduler - reset() sends the next position at once", "[GGAScheduler]") {
+    GGAScheduler scheduler;
+    scheduler.configure(DISTANCE_M, MIN_MS, MAX_MS);
+
+    REQUIRE(scheduler.evaluate(0, START_LAT, START_LON, 4, GGA_LENGTH) == GGA_SEND_FIRST);
+    scheduler.reset();
+    REQUIRE(scheduler.evaluate(1000, START_LAT, START_LON, 4, GGA_LENGTH) == GGA_SEND_FIRST);
+    REQUIRE(scheduler.getSendCount(GGA_SEND_FIRST) == 2);
+}
+
+TEST_CASE("GGA scheduler - Millisecond timer wrap-around", "[GGAScheduler]") {
+    GGAScheduler scheduler;
+    scheduler.configure(DISTANCE_M, MIN_MS, MAX_MS);
+
+    uint32_t start = 0xFFFFFFFFu - 5000;
+    REQUIRE(scheduler.evaluate(start, START_LAT, START_LON, 4, GGA_LENGTH) == GGA_SEND_FIRST);
+    REQUIRE(scheduler.evaluate(start + 60000, START_LAT, START_LON, 4, GGA_LENGTH) == GGA_SEND_NONE);
+    REQUIRE(scheduler.evaluate(start + MAX_MS, START_LAT, START_LON, 4, GGA_LENGTH) == GGA_SEND_MAX_INTERVAL);
+}
+
+TEST_CASE("GGA scheduler - Approximated distance matches haversine", "[GGAScheduler]") {
+    const double latitudes[] = {0.0, 35.0, 52.2, 60.0, 70.0, -45.0};
+    const double bearings[] = {0.0, 45.0, 90.0, 135.0, 200.0, 300.0};
+    const double distances[] = {20.0, 100.0, 1000.0, 20000.0};
+
+    for (size_t l = 0; l < 6; l++) {
+        for (size_t b = 0; b < 6; b++) {
+            for (size_t d = 0; d < 4; d++) {
+                GGAScheduler scheduler;
+                scheduler.configure(DISTANCE_M, 0, MAX_MS);
+                double lon0 = 6.0;
+                scheduler.evaluate(0, latitudes[l], lon0, 4, GGA_LENGTH);
+
+                double north = distances[d] * cos(bearings[b] * M_PI / 180.0);
+                double east = distances[d] * sin(bearings[b] * M_PI / 180.0);
+                double lat = latitudes[l] + north / 111194.93;
+                double lon = eastOf(latitudes[l], lon0, east);
+
+                double expected = haversine(latitudes[l], lon0, lat, lon);
+                double approx = sqrt(scheduler.squaredDistanceFromReference(lat, lon));
+                REQUIRE(fabs(approx - expected) <= expected * 0.01 + 0.05);
+            }
+        }
+    }
+
+    // Across the antimeridian
+    GGAScheduler scheduler;
+    scheduler.configure(DISTANCE_M, 0, MAX_MS);
+    scheduler.evaluate(0, -17.0, 179.9995, 4, GGA_LENGTH);
+    double expected = haversine(-17.0, 179.9995, -17.0, -179.9995);
+    REQUIRE(fabs(sqrt(scheduler.squaredDistanceFromReference(-17.0, -179.9995)) - expected) < 0.5);
+}
+
+TEST_CASE("GGA scheduler - Parked, driving and parked again", "[GGAScheduler]") {
+    GGAScheduler scheduler;
+    scheduler.configure(DISTANCE_M, MIN_MS, MAX_MS);
+
+    // 30 min parked, 20 min at 15 m/s north, 30 min parked, 1 Hz epochs
+    double lat = START_LAT;
+    for (uint32_t t = 0; t < 80 * 60; t++) {
+        if (t >= 30 * 60 && t < 50 * 60) {
+            lat += 15.0 / 111194.93;
+        }
+        scheduler.evaluate(t * 1000, lat, START_LON, 4, GGA_LENGTH);
+    }
+
+    // 18 km driven: one VRS regeneration per 100 m, limited to one per 10 s
+    REQUIRE(scheduler.getSendCount(GGA_SEND_DISTANCE) == 120);
+    // 60 min parked: one upload per 2 minutes
+    REQUIRE(scheduler.getSendCount(GGA_SEND_MAX_INTERVAL) >= 28);
+    REQUIRE(scheduler.getSendCount(GGA_SEND_MAX_INTERVAL) <= 31);
+    // The fixed 120 s schedule sends 40 sentences; the VRS regenerations cost more uplink
+    REQUIRE(scheduler.getBaselineBytes() == 40 * GGA_LENGTH);
+    REQUIRE(scheduler.getBytesSaved() == (int64_t)scheduler.getBaselineBytes() - (int64_t)scheduler.getBytesSent());
+    REQUIRE(scheduler.getBytesSaved() <= -(int64_t)(100 * GGA_LENGTH));
+}
+
+TEST_CASE("GGA scheduler - MQTT GNSS deadband without a minimum interval", "[GGAScheduler]") {
+    // The MQTT Client Task uses the scheduler as deadband filter: 5 m, no minimum interval, 300 s heartbeat
+    GGAScheduler scheduler;
+    scheduler.configure(5, 0, 300000);
+    const size_t MESSAGE_LENGTH = 150;
+
+    // 10 min parked with 2 m noise, 100 s at 2 m/s east, 10 min parked, 1 Hz epochs
+    double lon = START_LON;
+    uint32_t suppressed = 0;
+    for (uint32_t t = 0; t < 1300; t++) {
+        if (t >= 600 && t < 700) {
+            lon = eastOf(START_LAT, lon, 2.0);
+        }
+        double noise = (t < 600 || t >= 700) ? ((t * 7919) % 5) - 2.0 : 0.0;
+        if (scheduler.evaluate(t * 1000, START_LAT, eastOf(START_LAT, lon, noise), 4, MESSAGE_LENGTH) == GGA_SEND_NONE) {
+            suppressed++;
+        }
+    }
+
+    // Every 6 m while driving, every 5 min while parked
+    REQUIRE(scheduler.getSendCount(GGA_SEND_FIRST) == 1);
+    REQUIRE(scheduler.getSendCount(GGA_SEND_DISTANCE) >= 32);
+    REQUIRE(scheduler.getSendCount(GGA_SEND_DISTANCE) <= 34);
+    REQUIRE(scheduler.getSendCount(GGA_SEND_MAX_INTERVAL) == 4);
+
+    // The baseline is the 300 s heartbeat alone; the MQTT task counts suppressed bytes itself
+    REQUIRE(scheduler.getBaselineBytes() == 5 * MESSAGE_LENGTH);
+    REQUIRE(scheduler.getBytesSent() == (1300 - suppressed) * MESSAGE_LENGTH);
+    REQUIRE(suppressed > 1200);
+}
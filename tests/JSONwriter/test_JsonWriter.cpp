@@ -0,0 +1,695 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch.hpp"
+#include "JsonWriter_standalone.h"
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#if defined(__linux__)
+#include <pthread.h>
+#endif
+
+// Copies of the MQTT message structures in src/mqttClientTask.h
+#define RTCM_CONSTELLATION_COUNT 4
+
+typedef struct {
+    uint32_t num;
+    char daytime[32];
+    double lat;
+    double lon;
+    float alt;
+    uint8_t fix_type;
+    float speed;
+    float dir;
+    uint8_t sats;
+    float hdop;
+    float age;
+} mqtt_gnss_message_t;
+
+typedef struct {
+    char timestamp[32];
+    uint32_t uptime_sec;
+    uint32_t heap_free;
+    uint32_t heap_min;
+    bool wifi_connected;
+    int8_t wifi_rssi;
+    bool ntrip_connected;
+    uint32_t ntrip_uptime_sec;
+    uint32_t ntrip_reconnects;
+    uint32_t rtcm_packets_total;
+    bool mqtt_connected;
+    uint32_t mqtt_uptime_sec;
+    uint32_t mqtt_published;
+    uint32_t wifi_reconnects;
+    uint8_t current_fix;
+} mqtt_status_message_t;
+
+typedef struct {
+    char timestamp[32];
+    uint32_t period_duration;
+    uint32_t rtcm_bytes_received;
+    uint32_t rtcm_message_rate;
+    uint32_t rtcm_data_gaps;
+    uint32_t rtcm_avg_latency_ms;
+    uint32_t rtcm_corrupted;
+    uint8_t msm_satellites[RTCM_CONSTELLATION_COUNT];
+    uint8_t msm_signals[RTCM_CONSTELLATION_COUNT];
+    float msm_message_rate[RTCM_CONSTELLATION_COUNT];
+    uint32_t fix_quality_duration[9];
+    float rtk_fixed_percent;
+    uint32_t time_to_rtk_fixed_sec;
+    uint32_t fix_downgrades;
+    uint32_t fix_upgrades;
+    float hdop_avg;
+    float hdop_min;
+    float hdop_max;
+    uint8_t sats_avg;
+    float baseline_distance_km;
+    uint32_t gga_sent_count;
+    uint32_t gga_failures;
+    uint32_t gga_overflows;
+    uint32_t gga_vrs_regenerations;
+    int32_t gga_bytes_saved;
+    int8_t wifi_rssi_avg;
+    int8_t wifi_rssi_min;
+    int8_t wifi_rssi_max;
+    float wifi_uptime_percent;
+    uint32_t gnss_update_rate_hz;
+    uint32_t nmea_errors;
+    uint32_t uart_errors;
+    uint32_t rtcm_queue_overflows;
+    uint32_t ntrip_timeouts;
+} mqtt_stats_message_t;
+
+// Reference: the former snprintf formatting of src/mqttClientTask.cpp
+// (%lu replaced by PRIu32 for the host)
+
+static size_t snprintf_gnss_json(const mqtt_gnss_message_t *msg, char *buffer, size_t size) {
+    return snprintf(buffer, size,
+        "{\n"
+        "   \"num\": %" PRIu32 ",\n"
+        "   \"daytime\": \"%s\",\n"
+        "   \"lat\": %.7f,\n"
+        "   \"lon\": %.7f,\n"
+        "   \"alt\": %.3f,\n"
+        "   \"fix_type\": %u,\n"
+        "   \"speed\": %.2f,\n"
+        "   \"dir\": %.1f,\n"
+        "   \"sats\": %u,\n"
+        "   \"hdop\": %.2f,\n"
+        "   \"age\": %.2f\n"
+        "}",
+        msg->num, msg->daytime, msg->lat, msg->lon, msg->alt, msg->fix_type,
+        msg->speed, msg->dir, msg->sats, msg->hdop, (double)msg->age);
+}
+
+static size_t snprintf_status_json(const mqtt_status_message_t *msg, char *buffer, size_t size) {
+    return snprintf(buffer, size,
+        "{\n"
+        "   \"timestamp\": \"%s\",\n"
+        "   \"uptime_sec\": %" PRIu32 ",\n"
+        "   \"heap_free\": %" PRIu32 ",\n"
+        "   \"heap_min\": %" PRIu32 ",\n"
+        "   \"wifi\": {\n"
+        "      \"rssi_dbm\": %d,\n"
+        "      \"reconnects\": %" PRIu32 "\n"
+        "   },\n"
+        "   \"ntrip\": {\n"
+        "      \"connected\": %s,\n"
+        "      \"uptime_sec\": %" PRIu32 ",\n"
+        "      \"reconnects\": %" PRIu32 ",\n"
+        "      \"rtcm_packets_total\": %" PRIu32 "\n"
+        "   },\n"
+        "   \"mqtt\": {\n"
+        "      \"uptime_sec\": %" PRIu32 ",\n"
+        "      \"messages_published\": %" PRIu32 "\n"
+        "   },\n"
+        "   \"gnss\": {\n"
+        "      \"current_fix\": %u\n"
+        "   }\n"
+        "}",
+        msg->timestamp, msg->uptime_sec, msg->heap_free, msg->heap_min, msg->wifi_rssi,
+        msg->wifi_reconnects, msg->ntrip_connected ? "true" : "false", msg->ntrip_uptime_sec,
+        msg->ntrip_reconnects, msg->rtcm_packets_total, msg->mqtt_uptime_sec, msg->mqtt_published,
+        msg->current_fix);
+}
+
+static size_t snprintf_stats_json(const mqtt_stats_message_t *msg, char *buffer, size_t size) {
+    return snprintf(buffer, size,
+        "{\n"
+        "   \"timestamp\": \"%s\",\n"
+        "   \"period_sec\": %" PRIu32 ",\n"
+        "   \"rtcm\": {\n"
+        "      \"bytes_received\": %" PRIu32 ",\n"
+        "      \"message_rate\": %" PRIu32 ",\n"
+        "      \"data_gaps\": %" PRIu32 ",\n"
+        "      \"avg_latency_ms\": %" PRIu32 ",\n"
+        "      \"corrupted\": %" PRIu32 ",\n"
+        "      \"constellations\": {\n"
+        "         \"gps\": { \"satellites\": %u, \"signals\": %u, \"message_rate\": %.2f },\n"
+        "         \"glonass\": { \"satellites\": %u, \"signals\": %u, \"message_rate\": %.2f },\n"
+        "         \"galileo\": { \"satellites\": %u, \"signals\": %u, \"message_rate\": %.2f },\n"
+        "         \"beidou\": { \"satellites\": %u, \"signals\": %u, \"message_rate\": %.2f }\n"
+        "      }\n"
+        "   },\n"
+        "   \"gnss\": {\n"
+        "      \"fix_duration\": {\n"
+        "         \"no_fix\": %" PRIu32 ",\n"
+        "         \"gps\": %" PRIu32 ",\n"
+        "         \"dgps\": %" PRIu32 ",\n"
+        "         \"rtk_float\": %" PRIu32 ",\n"
+        "         \"rtk_fixed\": %" PRIu32 "\n"
+        "      },\n"
+        "      \"rtk_fixed_percent\": %.1f,\n"
+        "      \"time_to_rtk_fixed_sec\": %" PRIu32 ",\n"
+        "      \"fix_downgrades\": %" PRIu32 ",\n"
+        "      \"fix_upgrades\": %" PRIu32 ",\n"
+        "      \"hdop_avg\": %.2f,\n"
+        "      \"hdop_min\": %.2f,\n"
+        "      \"hdop_max\": %.2f,\n"
+        "      \"sats_avg\": %u,\n"
+        "      \"baseline_distance_km\": %.2f,\n"
+        "      \"update_rate_hz\": %" PRIu32 "\n"
+        "   },\n"
+        "   \"gga\": {\n"
+        "      \"sent_count\": %" PRIu32 ",\n"
+        "      \"failures\": %" PRIu32 ",\n"
+        "      \"queue_overflows\": %" PRIu32 ",\n"
+        "      \"vrs_regenerations\": %" PRIu32 ",\n"
+        "      \"bytes_saved\": %" PRId32 "\n"
+        "   },\n"
+        "   \"wifi\": {\n"
+        "      \"rssi_avg\": %d,\n"
+        "      \"rssi_min\": %d,\n"
+        "      \"rssi_max\": %d,\n"
+        "      \"uptime_percent\": %.1f\n"
+        "   },\n"
+        "   \"errors\": {\n"
+        "      \"nmea_checksum\": %" PRIu32 ",\n"
+        "      \"uart\": %" PRIu32 ",\n"
+        "      \"rtcm_queue_overflow\": %" PRIu32 ",\n"
+        "      \"ntrip_timeouts\": %" PRIu32 "\n"
+        "   }\n"
+        "}",
+        msg->timestamp, msg->period_duration, msg->rtcm_bytes_received, msg->rtcm_message_rate,
+        msg->rtcm_data_gaps, msg->rtcm_avg_latency_ms, msg->rtcm_corrupted,
+        msg->msm_satellites[0], msg->msm_signals[0], msg->msm_message_rate[0],
+        msg->msm_satellites[1], msg->msm_signals[1], msg->msm_message_rate[1],
+        msg->msm_satellites[2], msg->msm_signals[2], msg->msm_message_rate[2],
+        msg->msm_satellites[3], msg->msm_signals[3], msg->msm_message_rate[3],
+        msg->fix_quality_duration[0], msg->fix_quality_duration[1], msg->fix_quality_duration[2],
+        msg->fix_quality_duration[5], msg->fix_quality_duration[4],
+        msg->rtk_fixed_percent, msg->time_to_rtk_fixed_sec, msg->fix_downgrades, msg->fix_upgrades,
+        msg->hdop_avg, msg->hdop_min, msg->hdop_max, msg->sats_avg, msg->baseline_distance_km,
+        msg->gnss_update_rate_hz, msg->gga_sent_count, msg->gga_failures, msg->gga_overflows,
+        msg->gga_vrs_regenerations, msg->gga_bytes_saved, msg->wifi_rssi_avg, msg->wifi_rssi_min,
+        msg->wifi_rssi_max, msg->wifi_uptime_percent, msg->nmea_errors, msg->uart_errors,
+        msg->rtcm_queue_overflows, msg->ntrip_timeouts);
+}
+
+// Copies of the JsonWriter formatting in src/mqttClientTask.cpp
+
+static size_t writer_gnss_json(const mqtt_gnss_message_t *msg, char *buffer, size_t size) {
+    JsonWriter json(buffer, size);
+    json.beginObject();
+    json.addUInt("num", msg->num);
+    json.addString("daytime", msg->daytime);
+    json.addFixed("lat", msg->lat, 7);
+    json.addFixed("lon", msg->lon, 7);
+    json.addFixed("alt", msg->alt, 3);
+    json.addUInt("fix_type", msg->fix_type);
+    json.addFixed("speed", msg->speed, 2);
+    json.addFixed("dir", msg->dir, 1);
+    json.addUInt("sats", msg->sats);
+    json.addFixed("hdop", msg->hdop, 2);
+    json.addFixed("age", msg->age, 2);
+    json.endObject();
+    return json.length();
+}
+
+static size_t writer_status_json(const mqtt_status_message_t *msg, char *buffer, size_t size) {
+    JsonWriter json(buffer, size);
+    json.beginObject();
+    json.addString("timestamp", msg->timestamp);
+    json.addUInt("uptime_sec", msg->uptime_sec);
+    json.addUInt("heap_free", msg->heap_free);
+    json.addUInt("heap_min", msg->heap_min);
+    json.beginObject("wifi");
+    json.addInt("rssi_dbm", msg->wifi_rssi);
+    json.addUInt("reconnects", msg->wifi_reconnects);
+    json.endObject();
+    json.beginObject("ntrip");
+    json.addBool("connected", msg->ntrip_connected);
+    json.addUInt("uptime_sec", msg->ntrip_uptime_sec);
+    json.addUInt("reconnects", msg->ntrip_reconnects);
+    json.addUInt("rtcm_packets_total", msg->rtcm_packets_total);
+    json.endObject();
+    json.beginObject("mqtt");
+    json.addUInt("uptime_sec", msg->mqtt_uptime_sec);
+    json.addUInt("messages_published", msg->mqtt_published);
+    json.endObject();
+    json.beginObject("gnss");
+    json.addUInt("current_fix", msg->current_fix);
+    json.endObject();
+    json.endObject();
+    return json.length();
+}
+
+static size_t writer_stats_json(const mqtt_stats_message_t *msg, char *buffer, size_t size) {
+    static const char *constellation_names[RTCM_CONSTELLATION_COUNT] = {"gps", "glonass", "galileo", "beidou"};
+
+    JsonWriter json(buffer, size);
+    json.beginObject();
+    json.addString("timestamp", msg->timestamp);
+    json.addUInt("period_sec", msg->period_duration);
+
+    json.beginObject("rtcm");
+    json.addUInt("bytes_received", msg->rtcm_bytes_received);
+    json.addUInt("message_rate", msg->rtcm_message_rate);
+    json.addUInt("data_gaps", msg->rtcm_data_gaps);
+    json.addUInt("avg_latency_ms", msg->rtcm_avg_latency_ms);
+    json.addUInt("corrupted", msg->rtcm_corrupted);
+    json.beginObject("constellations");
+    for (int i = 0; i < RTCM_CONSTELLATION_COUNT; i++) {
+        json.beginObject(constellation_names[i], true);
+        json.addUInt("satellites", msg->msm_satellites[i]);
+        json.addUInt("signals", msg->msm_signals[i]);
+        json.addFixed("message_rate", msg->msm_message_rate[i], 2);
+        json.endObject();
+    }
+    json.endObject();
+    json.endObject();
+
+    json.beginObject("gnss");
+    json.beginObject("fix_duration");
+    json.addUInt("no_fix", msg->fix_quality_duration[0]);
+    json.addUInt("gps", msg->fix_quality_duration[1]);
+    json.addUInt("dgps", msg->fix_quality_duration[2]);
+    json.addUInt("rtk_float", msg->fix_quality_duration[5]);
+    json.addUInt("rtk_fixed", msg->fix_quality_duration[4]);
+    json.endObject();
+    json.addFixed("rtk_fixed_percent", msg->rtk_fixed_percent, 1);
+    json.addUInt("time_to_rtk_fixed_sec", msg->time_to_rtk_fixed_sec);
+    json.addUInt("fix_downgrades", msg->fix_downgrades);
+    json.addUInt("fix_upgrades", msg->fix_upgrades);
+    json.addFixed("hdop_avg", msg->hdop_avg, 2);
+    json.addFixed("hdop_min", msg->hdop_min, 2);
+    json.addFixed("hdop_max", msg->hdop_max, 2);
+    json.addUInt("sats_avg", msg->sats_avg);
+    json.addFixed("baseline_distance_km", msg->baseline_distance_km, 2);
+    json.addUInt("update_rate_hz", msg->gnss_update_rate_hz);
+    json.endObject();
+
+    json.beginObject("gga");
+    json.addUInt("sent_count", msg->gga_sent_count);
+    json.addUInt("failures", msg->gga_failures);
+    json.addUInt("queue_overflows", msg->gga_overflows);
+    json.addUInt("vrs_regenerations", msg->gga_vrs_regenerations);
+    json.addInt("bytes_saved", msg->gga_bytes_saved);
+    json.endObject();
+
+    json.beginObject("wifi");
+    json.addInt("rssi_avg", msg->wifi_rssi_avg);
+    json.addInt("rssi_min", msg->wifi_rssi_min);
+    json.addInt("rssi_max", msg->wifi_rssi_max);
+    json.addFixed("uptime_percent", msg->wifi_uptime_percent, 1);
+    json.endObject();
+
+    json.beginObject("errors");
+    json.addUInt("nmea_checksum", msg->nmea_errors);
+    json.addUInt("uart", msg->uart_errors);
+    json.addUInt("rtcm_queue_overflow", msg->rtcm_queue_overflows);
+    json.addUInt("ntrip_timeouts", msg->ntrip_timeouts);
+    json.endObject();
+    json.endObject();
+    return json.length();
+}
+
+// Random message contents in realistic ranges
+
+static mqtt_gnss_message_t makeGnssMessage(std::mt19937& rng) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    mqtt_gnss_message_t msg = {};
+    msg.num = rng();
+    snprintf(msg.daytime, sizeof(msg.daytime), "2026-10-17 12:%02u:%02u.%03u",
+             (unsigned)(rng() % 60), (unsigned)(rng() % 60), (unsigned)(rng() % 1000));
+    msg.lat = unit(rng) * 180.0 - 90.0;
+    msg.lon = unit(rng) * 360.0 - 180.0;
+    msg.alt = (float)(unit(rng) * 9000.0 - 400.0);
+    msg.fix_type = rng() % 9;
+    msg.speed = (float)(unit(rng) * 60.0);
+    msg.dir = (float)(unit(rng) * 360.0);
+    msg.sats = rng() % 64;
+    msg.hdop = (float)(unit(rng) * 25.0);
+    msg.age = (float)(unit(rng) * 30.0);
+    return msg;
+}
+
+static mqtt_status_message_t makeStatusMessage(std::mt19937& rng) {
+    mqtt_status_message_t msg = {};
+    snprintf(msg.timestamp, sizeof(msg.timestamp), "2026-10-17T12:%02u:%02uZ",
+             (unsigned)(rng() % 60), (unsigned)(rng() % 60));
+    msg.uptime_sec = rng();
+    msg.heap_free = rng() % 300000;
+    msg.heap_min = rng() % 300000;
+    msg.wifi_rssi = (int8_t)(-(int)(rng() % 100));
+    msg.ntrip_connected = (rng() & 1) != 0;
+    msg.ntrip_uptime_sec = rng();
+    msg.ntrip_reconnects = rng() % 1000;
+    msg.rtcm_packets_total = rng();
+    msg.mqtt_uptime_sec = rng();
+    msg.mqtt_published = rng();
+    msg.wifi_reconnects = rng() % 100;
+    msg.current_fix = rng() % 9;
+    return msg;
+}
+
+static mqtt_stats_message_t makeStatsMessage(std::mt19937& rng) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    mqtt_stats_message_t msg = {};
+    snprintf(msg.timestamp, sizeof(msg.timestamp), "2026-10-17T12:%02u:%02uZ",
+             (unsigned)(rng() % 60), (unsigned)(rng() % 60));
+    msg.period_duration = rng() % 3600;
+    msg.rtcm_bytes_received = rng();
+    msg.rtcm_message_rate = rng() % 100;
+    msg.rtcm_data_gaps = rng() % 10;
+    msg.rtcm_avg_latency_ms = rng() % 5000;
+    msg.rtcm_corrupted = rng() % 10;
+    for (int i = 0; i < RTCM_CONSTELLATION_COUNT; i++) {
+        msg.msm_satellites[i] = rng() % 40;
+        msg.msm_signals[i] = rng() % 32;
+        msg.msm_message_rate[i] = (float)(unit(rng) * 2.0);
+    }
+    for (int i = 0; i < 9; i++) {
+        msg.fix_quality_duration[i] = rng() % 3600;
+    }
+    msg.rtk_fixed_percent = (float)(unit(rng) * 100.0);
+    msg.time_to_rtk_fixed_sec = rng() % 600;
+    msg.fix_downgrades = rng() % 50;
+    msg.fix_upgrades = rng() % 50;
+    msg.hdop_avg = (float)(unit(rng) * 5.0);
+    msg.hdop_min = (float)(unit(rng) * 5.0);
+    msg.hdop_max = (float)(unit(rng) * 50.0);
+    msg.sats_avg = rng() % 40;
+    msg.baseline_distance_km = (float)(unit(rng) * 100.0);
+    msg.gga_sent_count = rng() % 400;
+    msg.gga_failures = rng() % 10;
+    msg.gga_overflows = rng() % 10;
+    msg.gga_vrs_regenerations = rng() % 400;
+    msg.gga_bytes_saved = (int32_t)(rng() % 60000) - 10000;
+    msg.wifi_rssi_avg = (int8_t)(-(int)(rng() % 100));
+    msg.wifi_rssi_min = (int8_t)(-(int)(rng() % 100));
+    msg.wifi_rssi_max = (int8_t)(-(int)(rng() % 100));
+    msg.wifi_uptime_percent = (float)(unit(rng) * 100.0);
+    msg.gnss_update_rate_hz = rng() % 20;
+    msg.nmea_errors = rng() % 100;
+    msg.uart_errors = rng() % 100;
+    msg.rtcm_queue_overflows = rng() % 100;
+    msg.ntrip_timeouts = rng() % 100;
+    return msg;
+}
+
+static std::string fixed(double value, int decimals) {
+    char buffer[400];
+    formatFixed(value, (uint8_t)decimals, buffer, sizeof(buffer));
+    return buffer;
+}
+
+static std::string printfFixed(double value, int decimals) {
+    char buffer[400];
+    snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+    return buffer;
+}
+
+TEST_CASE("formatFixed - Same digits as printf", "[JsonWriter]") {
+    SECTION("Simple values") {
+        REQUIRE(fixed(0.0, 2) == "0.00");
+        REQUIRE(fixed(52.2155123, 7) == "52.2155123");
+        REQUIRE(fixed(-6.0090001, 7) == "-6.0090001");
+        REQUIRE(fixed(12.0, 0) == "12");
+        REQUIRE(fixed(0.05, 1) == printfFixed(0.05, 1));
+    }
+
+    SECTION("Negative zero and small negative values keep the sign") {
+        REQUIRE(fixed(-0.0, 3) == printfFixed(-0.0, 3));
+        REQUIRE(fixed(-0.0004, 3) == printfFixed(-0.0004, 3));
+        REQUIRE(fixed(-0.0004, 3) == "-0.000");
+    }
+
+    SECTION("Exact binary ties round to even like printf") {
+        const double ties[] = {0.5, 1.5, 2.5, 0.125, 0.375, -0.125, 1.0625, 2.25, 1e6 + 0.5};
+        const int decimals[] = {0, 0, 0, 2, 2, 2, 3, 1, 0};
+        for (size_t i = 0; i < sizeof(ties) / sizeof(ties[0]); i++) {
+            REQUIRE(fixed(ties[i], decimals[i]) == printfFixed(ties[i], decimals[i]));
+        }
+    }
+
+    SECTION("Decimal halfway values that are not exact in binary") {
+        // 1.005 is stored as 1.00499999999999989... and must round down
+        REQUIRE(fixed(1.005, 2) == printfFixed(1.005, 2));
+        REQUIRE(fixed(2.675, 2) == printfFixed(2.675, 2));
+        for (int i = 0; i < 100000; i++) {
+            double value = i / 1000.0 + 0.0005;
+            REQUIRE(fixed(value, 3) == printfFixed(value, 3));
+            REQUIRE(fixed(-value, 3) == printfFixed(-value, 3));
+        }
+    }
+
+    SECTION("Random values over the whole range") {
+        std::mt19937 rng(20261017);
+        std::uniform_real_distribution<double> mantissa(-1.0, 1.0);
+        for (int i = 0; i < 200000; i++) {
+            int exponent = (int)(rng() % 24) - 8;
+            double value = mantissa(rng) * pow(10.0, exponent);
+            int decimals = rng() % 10;
+            REQUIRE(fixed(value, decimals) == printfFixed(value, decimals));
+            float single = (float)value;
+            REQUIRE(fixed(single, decimals) == printfFixed(single, decimals));
+        }
+    }
+
+    SECTION("Values outside the integer path") {
+        REQUIRE(fixed(1e20, 2) == printfFixed(1e20, 2));
+        REQUIRE(fixed(-3.4e38, 1) == printfFixed(-3.4e38, 1));
+        REQUIRE(fixed(1e300, 2) == printfFixed(1e300, 2));
+        REQUIRE(fixed(INFINITY, 2) == printfFixed(INFINITY, 2));
+        REQUIRE(fixed(NAN, 2) == printfFixed(NAN, 2));
+    }
+
+    SECTION("Truncated output") {
+        char buffer[5];
+        REQUIRE(formatFixed(123.456, 2, buffer, sizeof(buffer)) == 6);
+        REQUIRE(std::string(buffer) == "123.");
+    }
+}
+
+TEST_CASE("JsonWriter - Layout, escaping and overflow", "[JsonWriter]") {
+    char buffer[256];
+
+    SECTION("Nested and inline objects") {
+        JsonWriter json(buffer, sizeof(buffer));
+        json.beginObject();
+        json.addInt("a", -5);
+        json.beginObject("b");
+        json.beginObject("c", true);
+        json.addBool("d", true);
+        json.addInt64("e", -9000000000LL);
+        json.endObject();
+        json.endObject();
+        json.endObject();
+        std::string expected = "{\n"
+                               "   \"a\": -5,\n"
+                               "   \"b\": {\n"
+                               "      \"c\": { \"d\": true, \"e\": -9000000000 }\n"
+                               "   }\n"
+                               "}";
+        REQUIRE(std::string(buffer) == expected);
+        REQUIRE(json.length() == expected.size());
+        REQUIRE_FALSE(json.overflowed());
+    }
+
+    SECTION("Integer limits") {
+        JsonWriter json(buffer, sizeof(buffer));
+        json.beginObject();
+        json.addUInt("u", 4294967295u);
+        json.addInt("i", INT32_MIN);
+        json.addInt64("l", INT64_MIN);
+        json.endObject();
+        REQUIRE(std::string(buffer) == "{\n   \"u\": 4294967295,\n   \"i\": -2147483648,\n   \"l\": -9223372036854775808\n}");
+    }
+
+    SECTION("Inline integer arrays") {
+        JsonWriter json(buffer, sizeof(buffer));
+        json.beginObject();
+        json.beginArray("a");
+        json.addItem(0);
+        json.addItem(-12);
+        json.addItem(4294967296LL);
+        json.endArray();
+        json.beginArray("empty");
+        json.endArray();
+        json.addUInt("n", 3);
+        json.endObject();
+        std::string expected = "{\n"
+                               "   \"a\": [0,-12,4294967296],\n"
+                               "   \"empty\": [],\n"
+                               "   \"n\": 3\n"
+                               "}";
+        REQUIRE(std::string(buffer) == expected);
+        REQUIRE(json.length() == expected.size());
+    }
+
+    SECTION("Strings are escaped") {
+        JsonWriter json(buffer, sizeof(buffer));
+        json.beginObject();
+        json.addString("s", "a\"b\\c\n");
+        json.endObject();
+        REQUIRE(std::string(buffer) == "{\n   \"s\": \"a\\\"b\\\\c\\u000a\"\n}");
+    }
+
+    SECTION("Truncation matches snprintf") {
+        std::mt19937 rng(1);
+        mqtt_gnss_message_t msg = makeGnssMessage(rng);
+        char reference[512];
+        size_t full = snprintf_gnss_json(&msg, reference, sizeof(reference));
+        for (size_t size = 1; size < full + 4; size += 7) {
+            char expected[512];
+            char actual[512];
+            size_t expectedLength = snprintf_gnss_json(&msg, expected, size);
+            size_t actualLength = writer_gnss_json(&msg, actual, size);
+            REQUIRE(actualLength == expectedLength);
+            REQUIRE(std::string(actual) == std::string(expected));
+        }
+    }
+}
+
+TEST_CASE("JsonWriter - MQTT messages identical to snprintf", "[JsonWriter]") {
+    std::mt19937 rng(42);
+    char expected[2048];
+    char actual[2048];
+
+    for (int i = 0; i < 20000; i++) {
+        mqtt_gnss_message_t gnss = makeGnssMessage(rng);
+        size_t length = writer_gnss_json(&gnss, actual, sizeof(actual));
+        REQUIRE(length == snprintf_gnss_json(&gnss, expected, sizeof(expected)));
+        REQUIRE(std::string(actual) == std::string(expected));
+    }
+    for (int i = 0; i < 5000; i++) {
+        mqtt_status_message_t status = makeStatusMessage(rng);
+        size_t length = writer_status_json(&status, actual, sizeof(actual));
+        REQUIRE(length == snprintf_status_json(&status, expected, sizeof(expected)));
+        REQUIRE(std::string(actual) == std::string(expected));
+    }
+    for (int i = 0; i < 5000; i++) {
+        mqtt_stats_message_t stats = makeStatsMessage(rng);
+        size_t length = writer_stats_json(&stats, actual, sizeof(actual));
+        REQUIRE(length == snprintf_stats_json(&stats, expected, sizeof(expected)));
+        REQUIRE(std::string(actual) == std::string(expected));
+    }
+}
+
+// Benchmark
+
+template <typename Message>
+struct FormatJob {
+    size_t (*format)(const Message*, char*, size_t);
+    const Message* message;
+};
+
+template <typename Message>
+static void* runFormat(void* arg) {
+    FormatJob<Message>* job = (FormatJob<Message>*)arg;
+    char buffer[2048];
+    job->format(job->message, buffer, sizeof(buffer));
+    return NULL;
+}
+
+static void* runNothing(void* arg) {
+    (void)arg;
+    return NULL;
+}
+
+// Peak stack use of one call, measured on a painted thread stack (0 if not supported)
+static size_t measureStack(void* (*function)(void*), void* arg) {
+#if defined(__linux__)
+    const size_t size = 256 * 1024;
+    std::vector<uint8_t> memory(size + 4096);
+    uint8_t* stack = (uint8_t*)(((uintptr_t)memory.data() + 4095) & ~(uintptr_t)4095);
+    memset(stack, 0xA5, size);
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, stack, size);
+    pthread_t thread;
+    if (pthread_create(&thread, &attr, function, arg) != 0) {
+        pthread_attr_destroy(&attr);
+        return 0;
+    }
+    pthread_join(thread, NULL);
+    pthread_attr_destroy(&attr);
+
+    size_t untouched = 0;
+    while (untouched < size && stack[untouched] == 0xA5) {
+        untouched++;
+    }
+    return size - untouched;
+#else
+    (void)function;
+    (void)arg;
+    return 0;
+#endif
+}
+
+template <typename Message>
+static void benchmarkMessage(const char* name, const std::vector<Message>& messages,
+                             size_t (*reference)(const Message*, char*, size_t),
+                             size_t (*writer)(const Message*, char*, size_t)) {
+    const int rounds = 20;
+    char buffer[2048];
+    size_t checksum[2] = {0, 0};
+    double rate[2];
+    size_t (*formatters[2])(const Message*, char*, size_t) = {reference, writer};
+
+    for (int f = 0; f < 2; f++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; r++) {
+            for (size_t i = 0; i < messages.size(); i++) {
+                checksum[f] += formatters[f](&messages[i], buffer, sizeof(buffer));
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        rate[f] = rounds * messages.size() / seconds;
+    }
+    REQUIRE(checksum[0] == checksum[1]);
+
+    size_t baseline = measureStack(runNothing, NULL);
+    size_t stack[2];
+    for (int f = 0; f < 2; f++) {
+        FormatJob<Message> job = {formatters[f], &messages[0]};
+        size_t used = measureStack(runFormat<Message>, &job);
+        // Exclude the thread start and the 2 KB output buffer of runFormat()
+        stack[f] = used > baseline + sizeof(buffer) ? used - baseline - sizeof(buffer) : 0;
+    }
+    printf("%-8s %14.0f %14.0f %12u %12u\n", name, rate[0], rate[1], (unsigned)stack[0], (unsigned)stack[1]);
+}
+
+TEST_CASE("JSON formatting benchmark - messages per second and stack use", "[.benchmark]") {
+    std::mt19937 rng(7);
+    std::vector<mqtt_gnss_message_t> gnss;
+    std::vector<mqtt_status_message_t> status;
+    std::vector<mqtt_stats_message_t> stats;
+    for (int i = 0; i < 5000; i++) {
+        gnss.push_back(makeGnssMessage(rng));
+        status.push_back(makeStatusMessage(rng));
+        stats.push_back(makeStatsMessage(rng));
+    }
+
+    printf("\n%-8s %14s %14s %12s %12s\n", "message", "snprintf msg/s", "writer msg/s", "snprintf B", "writer B");
+    benchmarkMessage("GNSS", gnss, snprintf_gnss_json, writer_gnss_json);
+    benchmarkMessage("status", status, snprintf_status_json, writer_status_json);
+    benchmarkMessage("stats", stats, snprintf_stats_json, writer_stats_json);
+}
@@ -0,0 +1,67 @@
+/*!
+ * \file CborWriter.h
+ * \brief Minimal CBOR (RFC 8949) encoder for the MQTT telemetry payloads.
+ *
+ * Only definite length maps and arrays are written, so the number of items
+ * is passed when a container is opened. Integers use the shortest head (a
+ * value below 24 takes one byte). Floats are written as single precision,
+ * doubles as double precision, so the decoder gets the firmware values
+ * unchanged.
+ *
+ * Keyed variants write an unsigned integer map key followed by the value,
+ * which is how the MQTT CBOR schema identifies fields.
+ *
+ * Like JsonWriter, nothing is allocated, output that does not fit is
+ * truncated and length() returns the full length that was needed.
+ */
+
+#ifndef CBOR_WRITER_STANDALONE_H
+#define CBOR_WRITER_STANDALONE_H
+
+#include <cstdint>
+#include <stddef.h>
+
+class CborWriter {
+public:
+    /**
+     * \param[out] buffer Output buffer.
+     * \param[in] size Size of the output buffer.
+     */
+    CborWriter(uint8_t* buffer, size_t size);
+
+    /** \brief Open a map with count key/value pairs. */
+    void beginMap(size_t count);
+
+    /** \brief Open an array with count items. */
+    void beginArray(size_t count);
+
+    void addUInt(uint64_t value);
+    void addInt(int64_t value);
+    void addFloat(float value);
+    void addDouble(double value);
+    void addBool(bool value);
+    void addText(const char* text);
+
+    void addUInt(uint32_t key, uint64_t value) { addUInt((uint64_t)key); addUInt(value); }
+    void addInt(uint32_t key, int64_t value) { addUInt((uint64_t)key); addInt(value); }
+    void addFloat(uint32_t key, float value) { addUInt((uint64_t)key); addFloat(value); }
+    void addDouble(uint32_t key, double value) { addUInt((uint64_t)key); addDouble(value); }
+    void addBool(uint32_t key, bool value) { addUInt((uint64_t)key); addBool(value); }
+    void addText(uint32_t key, const char* text) { addUInt((uint64_t)key); addText(text); }
+
+    /** \brief Length of the complete output, also when it was truncated. */
+    size_t length() const { return written; }
+
+    /** \brief true if the output did not fit in the buffer. */
+    bool overflowed() const { return written > capacity; }
+
+private:
+    void writeHead(uint8_t majorType, uint64_t value);
+    void append(const uint8_t* data, size_t length);
+
+    uint8_t* buffer;
+    size_t capacity;
+    size_t written;
+};
+
+#endif // CBOR_WRITER_STANDALONE_H
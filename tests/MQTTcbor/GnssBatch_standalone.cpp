@@ -0,0 +1,201 @@
+// Standalone build for MQTT CBOR tests using Code::Blocks
+// This file contains a copy of the GnssBatch implementation for standalone compilation
+
+#include <cstdint>
+#include <stddef.h>
+#include <math.h>
+
+#include "GnssBatch_standalone.h"
+
+#define MS_PER_DAY 86400000u
+
+// Millimeters per 1e-7 degree of latitude on a sphere with the mean earth radius
+#define MM_PER_E7 11.119493f
+#define DEG_TO_RAD 0.017453292519943295
+
+// Round to an integer in [low, high]
+static int64_t roundClamped(double value, double low, double high) {
+    if (!(value >= low)) {      // also catches NaN
+        return (int64_t)low;
+    }
+    if (value > high) {
+        return (int64_t)high;
+    }
+    return (int64_t)llround(value);
+}
+
+GnssBatch::GnssBatch()
+    : size(0),
+      maxEpochs(MAX_EPOCHS),
+      maxLatencyMs(1000),
+      firstAddedMs(0),
+      unbatchedBytes(0),
+      haveLastTime(false),
+      lastTimeOfDayMs(0) {
+}
+
+GnssEpoch GnssBatch::quantize(uint32_t timeOfDayMs, double latitude, double longitude, float altitude,
+                              float speed, float heading, float hdop, float age,
+                              uint8_t fixType, uint8_t sats) {
+    GnssEpoch epoch;
+    epoch.timeOfDayMs = timeOfDayMs % MS_PER_DAY;
+    epoch.latE7 = (int32_t)roundClamped(latitude * 1e7, -900000000.0, 900000000.0);
+    epoch.lonE7 = (int32_t)roundClamped(longitude * 1e7, -1800000000.0, 1800000000.0);
+    epoch.altMm = (int32_t)roundClamped(altitude * 1000.0, -2147483647.0, 2147483647.0);
+    epoch.speedX100 = (uint32_t)roundClamped(speed * 100.0, 0.0, 4294967295.0);
+    epoch.dirX10 = (uint16_t)roundClamped(heading * 10.0, 0.0, 65535.0);
+    epoch.hdopX100 = (uint16_t)roundClamped(hdop * 100.0, 0.0, 65535.0);
+    epoch.ageX100 = (uint16_t)roundClamped(age * 100.0, 0.0, 65535.0);
+    epoch.fixType = fixType;
+    epoch.sats = sats;
+    return epoch;
+}
+
+void GnssBatch::configure(uint8_t epochLimit, uint32_t latencyMs) {
+    if (epochLimit < 1) {
+        epochLimit = 1;
+    } else if (epochLimit > MAX_EPOCHS) {
+        epochLimit = MAX_EPOCHS;
+    }
+    maxEpochs = epochLimit;
+    maxLatencyMs = latencyMs;
+}
+
+bool GnssBatch::add(const GnssEpoch& epoch, uint32_t nowMs, size_t singleMessageBytes) {
+    if (isRepeat(epoch.timeOfDayMs) || size >= maxEpochs) {
+        return false;
+    }
+    if (size == 0) {
+        firstAddedMs = nowMs;
+    }
+    epochs[size++] = epoch;
+    unbatchedBytes += singleMessageBytes;
+    haveLastTime = true;
+    lastTimeOfDayMs = epoch.timeOfDayMs;
+    return true;
+}
+
+bool GnssBatch::isDue(uint32_t nowMs) const {
+    if (size == 0) {
+        return false;
+    }
+    // Unsigned difference stays correct when the timer wraps
+    return size >= maxEpochs || (uint32_t)(nowMs - firstAddedMs) >= maxLatencyMs;
+}
+
+void GnssBatch::clear() {
+    size = 0;
+    unbatchedBytes = 0;
+}
+
+void GnssBatch::reset() {
+    clear();
+    haveLastTime = false;
+}
+
+uint32_t GnssBatch::timeOffsetMs(uint8_t index) const {
+    uint32_t first = epochs[0].timeOfDayMs;
+    uint32_t time = epochs[index].timeOfDayMs;
+    return time >= first ? time - first : time + MS_PER_DAY - first;
+}
+
+int64_t GnssBatch::latDelta(uint8_t index) const {
+    return index == 0 ? 0 : (int64_t)epochs[index].latE7 - epochs[index - 1].latE7;
+}
+
+int64_t GnssBatch::lonDelta(uint8_t index) const {
+    return index == 0 ? 0 : (int64_t)epochs[index].lonE7 - epochs[index - 1].lonE7;
+}
+
+int64_t GnssBatch::altDelta(uint8_t index) const {
+    return index == 0 ? 0 : (int64_t)epochs[index].altMm - epochs[index - 1].altMm;
+}
+
+uint8_t GnssBatch::simplify(uint32_t toleranceMm) {
+    if (toleranceMm == 0 || size <= 2) {
+        return 0;
+    }
+
+    // Local horizontal coordinates in mm relative to the first epoch
+    float x[MAX_EPOCHS];
+    float y[MAX_EPOCHS];
+    float cosLatitude = (float)cos(epochs[0].latE7 * 1e-7 * DEG_TO_RAD);
+    for (uint8_t i = 0; i < size; i++) {
+        int64_t dLon = (int64_t)epochs[i].lonE7 - epochs[0].lonE7;
+        if (dLon > 1800000000LL) {
+            dLon -= 3600000000LL;
+        } else if (dLon < -1800000000LL) {
+            dLon += 3600000000LL;
+        }
+        x[i] = (float)dLon * MM_PER_E7 * cosLatitude;
+        y[i] = (float)((int64_t)epochs[i].latE7 - epochs[0].latE7) * MM_PER_E7;
+    }
+
+    // Douglas-Peucker with an explicit stack of segments instead of recursion
+    bool keep[MAX_EPOCHS] = {};
+    keep[0] = true;
+    keep[size - 1] = true;
+    uint8_t stackFirst[MAX_EPOCHS];
+    uint8_t stackLast[MAX_EPOCHS];
+    uint8_t depth = 0;
+    stackFirst[depth] = 0;
+    stackLast[depth] = size - 1;
+    depth++;
+    float toleranceSquared = (float)toleranceMm * (float)toleranceMm;
+
+    while (depth > 0) {
+        depth--;
+        uint8_t first = stackFirst[depth];
+        uint8_t last = stackLast[depth];
+        float segmentX = x[last] - x[first];
+        float segmentY = y[last] - y[first];
+        float segmentSquared = segmentX * segmentX + segmentY * segmentY;
+
+        // Farthest epoch from the segment (not the infinite line, so a rover
+        // that returns to its start is not collapsed)
+        float farthestSquared = 0.0f;
+        uint8_t farthest = first;
+        for (uint8_t i = first + 1; i < last; i++) {
+            float px = x[i] - x[first];
+            float py = y[i] - y[first];
+            float t = segmentSquared > 0.0f ? (px * segmentX + py * segmentY) / segmentSquared : 0.0f;
+            if (t < 0.0f) {
+                t = 0.0f;
+            } else if (t > 1.0f) {
+                t = 1.0f;
+            }
+            float dx = px - t * segmentX;
+            float dy = py - t * segmentY;
+            float distanceSquared = dx * dx + dy * dy;
+            if (distanceSquared > farthestSquared) {
+                farthestSquared = distanceSquared;
+                farthest = i;
+            }
+        }
+
+        if (farthestSquared > toleranceSquared) {
+            keep[farthest] = true;
+            // Each push splits a segment of at least three epochs, so the stack cannot overflow
+            if (farthest - first > 1) {
+                stackFirst[depth] = first;
+                stackLast[depth] = farthest;
+                depth++;
+            }
+            if (last - farthest > 1) {
+                stackFirst[depth] = farthest;
+                stackLast[depth] = last;
+                depth++;
+            }
+        }
+    }
+
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < size; i++) {
+        if (keep[i]) {
+            epochs[kept++] = epochs[i];
+        }
+    }
+    uint8_t removed = size - kept;
+    size = kept;
+    return removed;
+}
@@ -0,0 +1,610 @@
+#include <cstdint>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+#include "MqttCborDecoder.h"
+
+// Nesting limit for skipped items
+#define CBOR_MAX_DEPTH 16
+
+CborReader::CborReader(const uint8_t* bytes, size_t size)
+    : data(bytes),
+      length(size),
+      position(0) {
+}
+
+bool CborReader::readHead(uint8_t* majorType, uint8_t* info, uint64_t* argument) {
+    if (position >= length) {
+        return false;
+    }
+    uint8_t initial = data[position++];
+    *majorType = initial >> 5;
+    *info = initial & 0x1F;
+    if (*info < 24) {
+        *argument = *info;
+        return true;
+    }
+    if (*info > 27) {
+        // Indefinite length (31) and reserved values are not used by the schema
+        return false;
+    }
+    size_t bytes = (size_t)1 << (*info - 24);
+    if (length - position < bytes) {
+        return false;
+    }
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        value = (value << 8) | data[position++];
+    }
+    *argument = value;
+    return true;
+}
+
+bool CborReader::readMap(size_t* count) {
+    uint8_t major, info;
+    uint64_t argument;
+    if (!readHead(&major, &info, &argument) || major != 5) {
+        return false;
+    }
+    *count = (size_t)argument;
+    return true;
+}
+
+bool CborReader::readArray(size_t* count) {
+    uint8_t major, info;
+    uint64_t argument;
+    if (!readHead(&major, &info, &argument) || major != 4) {
+        return false;
+    }
+    *count = (size_t)argument;
+    return true;
+}
+
+bool CborReader::readUInt(uint64_t* value) {
+    uint8_t major, info;
+    if (!readHead(&major, &info, value)) {
+        return false;
+    }
+    return major == 0;
+}
+
+bool CborReader::readInt(int64_t* value) {
+    uint8_t major, info;
+    uint64_t argument;
+    if (!readHead(&major, &info, &argument) || argument > (uint64_t)INT64_MAX) {
+        return false;
+    }
+    if (major == 0) {
+        *value = (int64_t)argument;
+        return true;
+    }
+    if (major == 1) {
+        *value = -1 - (int64_t)argument;
+        return true;
+    }
+    return false;
+}
+
+// IEEE 754 half precision to double (RFC 8949 appendix D)
+static double halfToDouble(uint16_t half) {
+    int exponent = (half >> 10) & 0x1F;
+    int mantissa = half & 0x3FF;
+    double value;
+    if (exponent == 0) {
+        value = ldexp(mantissa, -24);
+    } else if (exponent != 31) {
+        value = ldexp(mantissa + 1024, exponent - 25);
+    } else {
+        value = mantissa == 0 ? INFINITY : NAN;
+    }
+    return (half & 0x8000) ? -value : value;
+}
+
+bool CborReader::readDouble(double* value) {
+    uint8_t major, info;
+    uint64_t argument;
+    if (!readHead(&major, &info, &argument)) {
+        return false;
+    }
+    if (major == 0) {
+        *value = (double)argument;
+        return true;
+    }
+    if (major == 1) {
+        *value = -1.0 - (double)argument;
+        return true;
+    }
+    if (major != 7) {
+        return false;
+    }
+    if (info == 25) {
+        *value = halfToDouble((uint16_t)argument);
+    } else if (info == 26) {
+        uint32_t bits = (uint32_t)argument;
+        float single;
+        memcpy(&single, &bits, sizeof(single));
+        *value = single;
+    } else if (info == 27) {
+        memcpy(value, &argument, sizeof(*value));
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool CborReader::readBool(bool* value) {
+    uint8_t major, info;
+    uint64_t argument;
+    if (!readHead(&major, &info, &argument) || major != 7 || (info != 20 && info != 21)) {
+        return false;
+    }
+    *value = (info == 21);
+    return true;
+}
+
+bool CborReader::readText(char* text, size_t size) {
+    uint8_t major, info;
+    uint64_t argument;
+    if (!readHead(&major, &info, &argument) || major != 3 || argument > length - position) {
+        return false;
+    }
+    size_t n = (size_t)argument < size - 1 ? (size_t)argument : size - 1;
+    memcpy(text, data + position, n);
+    text[n] = '\0';
+    position += (size_t)argument;
+    return true;
+}
+
+bool CborReader::skipItem(int depth) {
+    if (depth > CBOR_MAX_DEPTH) {
+        return false;
+    }
+    uint8_t major, info;
+    uint64_t argument;
+    if (!readHead(&major, &info, &argument)) {
+        return false;
+    }
+    switch (major) {
+        case 2:     // byte string
+        case 3:     // text string
+            if (argument > length - position) {
+                return false;
+            }
+            position += (size_t)argument;
+            return true;
+        case 4:     // array
+        case 5: {   // map
+            uint64_t items = major == 5 ? argument * 2 : argument;
+            // Every item takes at least one byte
+            if (items > length - position) {
+                return false;
+            }
+            for (uint64_t i = 0; i < items; i++) {
+                if (!skipItem(depth + 1)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        case 6:     // tag
+            return skipItem(depth + 1);
+        default:    // integers and simple values
+            return true;
+    }
+}
+
+bool CborReader::skip() {
+    return skipItem(0);
+}
+
+// Helpers that read into the fixed width struct fields
+
+static bool readU32(CborReader& reader, uint32_t* field) {
+    uint64_t value;
+    if (!reader.readUInt(&value) || value > 0xFFFFFFFFu) {
+        return false;
+    }
+    *field = (uint32_t)value;
+    return true;
+}
+
+static bool readU8(CborReader& reader, uint8_t* field) {
+    uint64_t value;
+    if (!reader.readUInt(&value) || value > 0xFF) {
+        return false;
+    }
+    *field = (uint8_t)value;
+    return true;
+}
+
+static bool readI32(CborReader& reader, int32_t* field) {
+    int64_t value;
+    if (!reader.readInt(&value) || value < INT32_MIN || value > INT32_MAX) {
+        return false;
+    }
+    *field = (int32_t)value;
+    return true;
+}
+
+static bool readI8(CborReader& reader, int8_t* field) {
+    int64_t value;
+    if (!reader.readInt(&value) || value < INT8_MIN || value > INT8_MAX) {
+        return false;
+    }
+    *field = (int8_t)value;
+    return true;
+}
+
+static bool readFloat(CborReader& reader, float* field) {
+    double value;
+    if (!reader.readDouble(&value)) {
+        return false;
+    }
+    *field = (float)value;
+    return true;
+}
+
+static bool readU8Array(CborReader& reader, uint8_t* fields, size_t count) {
+    size_t items;
+    if (!reader.readArray(&items) || items != count) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (!readU8(reader, &fields[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool readU32Array(CborReader& reader, uint32_t* fields, size_t count) {
+    size_t items;
+    if (!reader.readArray(&items) || items != count) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (!readU32(reader, &fields[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool readFloatArray(CborReader& reader, float* fields, size_t count) {
+    size_t items;
+    if (!reader.readArray(&items) || items != count) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (!readFloat(reader, &fields[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Any schema version is accepted, later versions only add keys
+// Quantiles: one array of STATS_QUANTILE_COUNT floats per metric
+static bool readQuantiles(CborReader& reader, float quantiles[][STATS_QUANTILE_COUNT]) {
+    size_t metrics;
+    if (!reader.readArray(&metrics) || metrics != STATS_METRIC_COUNT) {
+        return false;
+    }
+    for (size_t m = 0; m < metrics; m++) {
+        if (!readFloatArray(reader, quantiles[m], STATS_QUANTILE_COUNT)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Histograms: one array [count, shift, gap, count, ...] per metric
+static bool readHistograms(CborReader& reader, statistics_histogram_t* histograms) {
+    size_t metrics;
+    if (!reader.readArray(&metrics) || metrics != STATS_METRIC_COUNT) {
+        return false;
+    }
+    for (size_t m = 0; m < metrics; m++) {
+        statistics_histogram_t* histogram = &histograms[m];
+        size_t items;
+        if (!reader.readArray(&items) || items < 2 || (items % 2) != 0 ||
+            items > 2 + 2 * STATS_HISTOGRAM_MAX_BINS) {
+            return false;
+        }
+        if (!readU32(reader, &histogram->count) || !readU8(reader, &histogram->shift)) {
+            return false;
+        }
+        histogram->bins = (uint8_t)((items - 2) / 2);
+        for (size_t i = 0; i < histogram->bins; i++) {
+            if (!readU8(reader, &histogram->gaps[i]) || !readU32(reader, &histogram->counts[i])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Position scatter: [samples, mean lat, mean lon, mean alt, std E, std N, std U, CEP50, CEP95, 2DRMS]
+static bool readPosition(CborReader& reader, statistics_position_t* position) {
+    size_t items;
+    if (!reader.readArray(&items) || items != 10) {
+        return false;
+    }
+    return readU32(reader, &position->samples) &&
+           reader.readDouble(&position->mean_latitude) &&
+           reader.readDouble(&position->mean_longitude) &&
+           readFloat(reader, &position->mean_altitude_m) &&
+           readFloat(reader, &position->std_east_m) &&
+           readFloat(reader, &position->std_north_m) &&
+           readFloat(reader, &position->std_up_m) &&
+           readFloat(reader, &position->cep50_m) &&
+           readFloat(reader, &position->cep95_m) &&
+           readFloat(reader, &position->drms2_m);
+}
+
+static bool readVersion(CborReader& reader) {
+    uint64_t version;
+    return reader.readUInt(&version) && version >= 1;
+}
+
+bool mqttCborDecodeGnss(const uint8_t* data, size_t length, mqtt_gnss_message_t* message) {
+    CborReader reader(data, length);
+    memset(message, 0, sizeof(*message));
+    size_t pairs;
+    if (!reader.readMap(&pairs)) {
+        return false;
+    }
+    for (size_t i = 0; i < pairs; i++) {
+        uint64_t key;
+        if (!reader.readUInt(&key)) {
+            return false;
+        }
+        bool ok;
+        switch (key) {
+            case MQTT_CBOR_GNSS_VERSION:  ok = readVersion(reader); break;
+            case MQTT_CBOR_GNSS_NUM:      ok = readU32(reader, &message->num); break;
+            case MQTT_CBOR_GNSS_DAYTIME:  ok = reader.readText(message->daytime, sizeof(message->daytime)); break;
+            case MQTT_CBOR_GNSS_LAT:      ok = reader.readDouble(&message->lat); break;
+            case MQTT_CBOR_GNSS_LON:      ok = reader.readDouble(&message->lon); break;
+            case MQTT_CBOR_GNSS_ALT:      ok = readFloat(reader, &message->alt); break;
+            case MQTT_CBOR_GNSS_FIX_TYPE: ok = readU8(reader, &message->fix_type); break;
+            case MQTT_CBOR_GNSS_SPEED:    ok = readFloat(reader, &message->speed); break;
+            case MQTT_CBOR_GNSS_DIR:      ok = readFloat(reader, &message->dir); break;
+            case MQTT_CBOR_GNSS_SATS:     ok = readU8(reader, &message->sats); break;
+            case MQTT_CBOR_GNSS_HDOP:     ok = readFloat(reader, &message->hdop); break;
+            case MQTT_CBOR_GNSS_AGE:      ok = readFloat(reader, &message->age); break;
+            default:                      ok = reader.skip(); break;
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+    return reader.atEnd();
+}
+
+bool mqttCborDecodeStatus(const uint8_t* data, size_t length, mqtt_status_message_t* message) {
+    CborReader reader(data, length);
+    memset(message, 0, sizeof(*message));
+    size_t pairs;
+    if (!reader.readMap(&pairs)) {
+        return false;
+    }
+    for (size_t i = 0; i < pairs; i++) {
+        uint64_t key;
+        if (!reader.readUInt(&key)) {
+            return false;
+        }
+        bool ok;
+        switch (key) {
+            case MQTT_CBOR_STATUS_VERSION:            ok = readVersion(reader); break;
+            case MQTT_CBOR_STATUS_TIMESTAMP:          ok = reader.readText(message->timestamp, sizeof(message->timestamp)); break;
+            case MQTT_CBOR_STATUS_UPTIME_SEC:         ok = readU32(reader, &message->uptime_sec); break;
+            case MQTT_CBOR_STATUS_HEAP_FREE:          ok = readU32(reader, &message->heap_free); break;
+            case MQTT_CBOR_STATUS_HEAP_MIN:           ok = readU32(reader, &message->heap_min); break;
+            case MQTT_CBOR_STATUS_WIFI_CONNECTED:     ok = reader.readBool(&message->wifi_connected); break;
+            case MQTT_CBOR_STATUS_WIFI_RSSI:          ok = readI8(reader, &message->wifi_rssi); break;
+            case MQTT_CBOR_STATUS_NTRIP_CONNECTED:    ok = reader.readBool(&message->ntrip_connected); break;
+            case MQTT_CBOR_STATUS_NTRIP_UPTIME_SEC:   ok = readU32(reader, &message->ntrip_uptime_sec); break;
+            case MQTT_CBOR_STATUS_NTRIP_RECONNECTS:   ok = readU32(reader, &message->ntrip_reconnects); break;
+            case MQTT_CBOR_STATUS_RTCM_PACKETS_TOTAL: ok = readU32(reader, &message->rtcm_packets_total); break;
+            case MQTT_CBOR_STATUS_MQTT_CONNECTED:     ok = reader.readBool(&message->mqtt_connected); break;
+            case MQTT_CBOR_STATUS_MQTT_UPTIME_SEC:    ok = readU32(reader, &message->mqtt_uptime_sec); break;
+            case MQTT_CBOR_STATUS_MQTT_PUBLISHED:     ok = readU32(reader, &message->mqtt_published); break;
+            case MQTT_CBOR_STATUS_WIFI_RECONNECTS:    ok = readU32(reader, &message->wifi_reconnects); break;
+            case MQTT_CBOR_STATUS_CURRENT_FIX:        ok = readU8(reader, &message->current_fix); break;
+            case MQTT_CBOR_STATUS_GNSS_BATCHES:       ok = readU32(reader, &message->gnss_batches); break;
+            case MQTT_CBOR_STATUS_BATCHED_EPOCHS:     ok = readU32(reader, &message->batched_epochs); break;
+            case MQTT_CBOR_STATUS_MESSAGES_SAVED:     ok = readU32(reader, &message->messages_saved); break;
+            case MQTT_CBOR_STATUS_BYTES_SAVED:        ok = reader.readInt(&message->bytes_saved); break;
+            case MQTT_CBOR_STATUS_GNSS_EPOCHS:        ok = readU32(reader, &message->gnss_epochs); break;
+            case MQTT_CBOR_STATUS_GNSS_AGE_AVG_US:    ok = readU32(reader, &message->gnss_age_avg_us); break;
+            case MQTT_CBOR_STATUS_GNSS_AGE_MAX_US:    ok = readU32(reader, &message->gnss_age_max_us); break;
+            case MQTT_CBOR_STATUS_GNSS_SUPPRESSED:    ok = readU32(reader, &message->gnss_suppressed); break;
+            case MQTT_CBOR_STATUS_GNSS_SUPPRESSED_BYTES: ok = reader.readUInt(&message->gnss_suppressed_bytes); break;
+            case MQTT_CBOR_STATUS_SIMPLIFIED_EPOCHS:  ok = readU32(reader, &message->simplified_epochs); break;
+            case MQTT_CBOR_STATUS_OUTBOX_BACKLOG:     ok = readU32(reader, &message->outbox_backlog); break;
+            case MQTT_CBOR_STATUS_OUTBOX_STORED:      ok = readU32(reader, &message->outbox_stored); break;
+            case MQTT_CBOR_STATUS_OUTBOX_DRAINED:     ok = readU32(reader, &message->outbox_drained); break;
+            case MQTT_CBOR_STATUS_OUTBOX_DROPPED:     ok = readU32(reader, &message->outbox_dropped); break;
+            case MQTT_CBOR_STATUS_QOS_ACKED:          ok = readU32(reader, &message->qos_acked); break;
+            case MQTT_CBOR_STATUS_QOS_DROPPED:        ok = readU32(reader, &message->qos_dropped); break;
+            case MQTT_CBOR_STATUS_PUBACK_AVG_MS:      ok = readU32(reader, &message->puback_avg_ms); break;
+            default:                                  ok = reader.skip(); break;
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+    return reader.atEnd();
+}
+
+bool mqttCborDecodeStats(const uint8_t* data, size_t length, mqtt_stats_message_t* message) {
+    CborReader reader(data, length);
+    memset(message, 0, sizeof(*message));
+    size_t pairs;
+    if (!reader.readMap(&pairs)) {
+        return false;
+    }
+    const size_t fixStates = sizeof(message->fix_quality_duration) / sizeof(message->fix_quality_duration[0]);
+    for (size_t i = 0; i < pairs; i++) {
+        uint64_t key;
+        if (!reader.readUInt(&key)) {
+            return false;
+        }
+        bool ok;
+        switch (key) {
+            case MQTT_CBOR_STATS_VERSION:               ok = readVersion(reader); break;
+            case MQTT_CBOR_STATS_TIMESTAMP:             ok = reader.readText(message->timestamp, sizeof(message->timestamp)); break;
+            case MQTT_CBOR_STATS_PERIOD_DURATION:       ok = readU32(reader, &message->period_duration); break;
+            case MQTT_CBOR_STATS_RTCM_BYTES_RECEIVED:   ok = readU32(reader, &message->rtcm_bytes_received); break;
+            case MQTT_CBOR_STATS_RTCM_MESSAGE_RATE:     ok = readU32(reader, &message->rtcm_message_rate); break;
+            case MQTT_CBOR_STATS_RTCM_DATA_GAPS:        ok = readU32(reader, &message->rtcm_data_gaps); break;
+            case MQTT_CBOR_STATS_RTCM_AVG_LATENCY_MS:   ok = readU32(reader, &message->rtcm_avg_latency_ms); break;
+            case MQTT_CBOR_STATS_RTCM_CORRUPTED:        ok = readU32(reader, &message->rtcm_corrupted); break;
+            case MQTT_CBOR_STATS_MSM_SATELLITES:        ok = readU8Array(reader, message->msm_satellites, RTCM_CONSTELLATION_COUNT); break;
+            case MQTT_CBOR_STATS_MSM_SIGNALS:           ok = readU8Array(reader, message->msm_signals, RTCM_CONSTELLATION_COUNT); break;
+            case MQTT_CBOR_STATS_MSM_MESSAGE_RATE:      ok = readFloatArray(reader, message->msm_message_rate, RTCM_CONSTELLATION_COUNT); break;
+            case MQTT_CBOR_STATS_FIX_QUALITY_DURATION:  ok = readU32Array(reader, message->fix_quality_duration, fixStates); break;
+            case MQTT_CBOR_STATS_RTK_FIXED_PERCENT:     ok = readFloat(reader, &message->rtk_fixed_percent); break;
+            case MQTT_CBOR_STATS_TIME_TO_RTK_FIXED_SEC: ok = readU32(reader, &message->time_to_rtk_fixed_sec); break;
+            case MQTT_CBOR_STATS_FIX_DOWNGRADES:        ok = readU32(reader, &message->fix_downgrades); break;
+            case MQTT_CBOR_STATS_FIX_UPGRADES:          ok = readU32(reader, &message->fix_upgrades); break;
+            case MQTT_CBOR_STATS_HDOP_AVG:              ok = readFloat(reader, &message->hdop_avg); break;
+            case MQTT_CBOR_STATS_HDOP_MIN:              ok = readFloat(reader, &message->hdop_min); break;
+            case MQTT_CBOR_STATS_HDOP_MAX:              ok = readFloat(reader, &message->hdop_max); break;
+            case MQTT_CBOR_STATS_SATS_AVG:              ok = readU8(reader, &message->sats_avg); break;
+            case MQTT_CBOR_STATS_BASELINE_DISTANCE_KM:  ok = readFloat(reader, &message->baseline_distance_km); break;
+            case MQTT_CBOR_STATS_GGA_SENT_COUNT:        ok = readU32(reader, &message->gga_sent_count); break;
+            case MQTT_CBOR_STATS_GGA_FAILURES:          ok = readU32(reader, &message->gga_failures); break;
+            case MQTT_CBOR_STATS_GGA_OVERFLOWS:         ok = readU32(reader, &message->gga_overflows); break;
+            case MQTT_CBOR_STATS_GGA_VRS_REGENERATIONS: ok = readU32(reader, &message->gga_vrs_regenerations); break;
+            case MQTT_CBOR_STATS_GGA_BYTES_SAVED:       ok = readI32(reader, &message->gga_bytes_saved); break;
+            case MQTT_CBOR_STATS_WIFI_RSSI_AVG:         ok = readI8(reader, &message->wifi_rssi_avg); break;
+            case MQTT_CBOR_STATS_WIFI_RSSI_MIN:         ok = readI8(reader, &message->wifi_rssi_min); break;
+            case MQTT_CBOR_STATS_WIFI_RSSI_MAX:         ok = readI8(reader, &message->wifi_rssi_max); break;
+            case MQTT_CBOR_STATS_WIFI_UPTIME_PERCENT:   ok = readFloat(reader, &message->wifi_uptime_percent); break;
+            case MQTT_CBOR_STATS_GNSS_UPDATE_RATE_HZ:   ok = readU32(reader, &message->gnss_update_rate_hz); break;
+            case MQTT_CBOR_STATS_NMEA_ERRORS:           ok = readU32(reader, &message->nmea_errors); break;
+            case MQTT_CBOR_STATS_UART_ERRORS:           ok = readU32(reader, &message->uart_errors); break;
+            case MQTT_CBOR_STATS_RTCM_QUEUE_OVERFLOWS:  ok = readU32(reader, &message->rtcm_queue_overflows); break;
+            case MQTT_CBOR_STATS_NTRIP_TIMEOUTS:        ok = readU32(reader, &message->ntrip_timeouts); break;
+            case MQTT_CBOR_STATS_QUANTILES:             ok = readQuantiles(reader, message->quantiles); break;
+            case MQTT_CBOR_STATS_HISTOGRAMS:            ok = readHistograms(reader, message->histograms); break;
+            case MQTT_CBOR_STATS_POSITION:              ok = readPosition(reader, &message->position); break;
+            default:                                    ok = reader.skip(); break;
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+    return reader.atEnd();
+}
+
+// Largest difference between two int32 values
+#define BATCH_MAX_DELTA 4294967295LL
+
+// Read one batch column of count integers in [low, high] into values
+static bool readColumn(CborReader& reader, size_t count, int64_t low, int64_t high, int64_t* values) {
+    size_t items;
+    if (!reader.readArray(&items) || items != count) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (!reader.readInt(&values[i]) || values[i] < low || values[i] > high) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool mqttCborDecodeGnssBatch(const uint8_t* data, size_t length, mqtt_gnss_batch_t* batch) {
+    CborReader reader(data, length);
+    memset(batch, 0, sizeof(*batch));
+    size_t pairs;
+    if (!reader.readMap(&pairs)) {
+        return false;
+    }
+    bool haveCount = false;
+    int64_t base[3] = {0, 0, 0};            // lat, lon, alt
+    int64_t deltas[3][MQTT_GNSS_BATCH_MAX_EPOCHS] = {};
+    int64_t column[MQTT_GNSS_BATCH_MAX_EPOCHS];
+    for (size_t i = 0; i < pairs; i++) {
+        uint64_t key;
+        if (!reader.readUInt(&key)) {
+            return false;
+        }
+        // Array valued keys need the count first
+        bool isArray = key >= MQTT_CBOR_BATCH_T_MS && key < MQTT_CBOR_BATCH_KEY_COUNT;
+        if (isArray && !haveCount) {
+            return false;
+        }
+        size_t n = batch->count;
+        bool ok = true;
+        switch (key) {
+            case MQTT_CBOR_BATCH_VERSION: ok = readVersion(reader); break;
+            case MQTT_CBOR_BATCH_NUM:     ok = readU32(reader, &batch->num); break;
+            case MQTT_CBOR_BATCH_DAYTIME: ok = reader.readText(batch->daytime, sizeof(batch->daytime)); break;
+            case MQTT_CBOR_BATCH_COUNT:
+                ok = readU8(reader, &batch->count) && batch->count <= MQTT_GNSS_BATCH_MAX_EPOCHS;
+                haveCount = true;
+                break;
+            case MQTT_CBOR_BATCH_LAT_E7:  ok = reader.readInt(&base[0]) && base[0] >= INT32_MIN && base[0] <= INT32_MAX; break;
+            case MQTT_CBOR_BATCH_LON_E7:  ok = reader.readInt(&base[1]) && base[1] >= INT32_MIN && base[1] <= INT32_MAX; break;
+            case MQTT_CBOR_BATCH_ALT_MM:  ok = reader.readInt(&base[2]) && base[2] >= INT32_MIN && base[2] <= INT32_MAX; break;
+            case MQTT_CBOR_BATCH_DLAT_E7: ok = readColumn(reader, n, -BATCH_MAX_DELTA, BATCH_MAX_DELTA, deltas[0]); break;
+            case MQTT_CBOR_BATCH_DLON_E7: ok = readColumn(reader, n, -BATCH_MAX_DELTA, BATCH_MAX_DELTA, deltas[1]); break;
+            case MQTT_CBOR_BATCH_DALT_MM: ok = readColumn(reader, n, -BATCH_MAX_DELTA, BATCH_MAX_DELTA, deltas[2]); break;
+            case MQTT_CBOR_BATCH_T_MS:
+                ok = readColumn(reader, n, 0, 0xFFFFFFFF, column);
+                for (size_t e = 0; ok && e < n; e++) batch->epochs[e].t_ms = (uint32_t)column[e];
+                break;
+            case MQTT_CBOR_BATCH_FIX_TYPE:
+                ok = readColumn(reader, n, 0, 0xFF, column);
+                for (size_t e = 0; ok && e < n; e++) batch->epochs[e].fix_type = (uint8_t)column[e];
+                break;
+            case MQTT_CBOR_BATCH_SATS:
+                ok = readColumn(reader, n, 0, 0xFF, column);
+                for (size_t e = 0; ok && e < n; e++) batch->epochs[e].sats = (uint8_t)column[e];
+                break;
+            case MQTT_CBOR_BATCH_SPEED_X100:
+                ok = readColumn(reader, n, 0, 0xFFFFFFFF, column);
+                for (size_t e = 0; ok && e < n; e++) batch->epochs[e].speed_x100 = (uint32_t)column[e];
+                break;
+            case MQTT_CBOR_BATCH_DIR_X10:
+                ok = readColumn(reader, n, 0, 0xFFFF, column);
+                for (size_t e = 0; ok && e < n; e++) batch->epochs[e].dir_x10 = (uint16_t)column[e];
+                break;
+            case MQTT_CBOR_BATCH_HDOP_X100:
+                ok = readColumn(reader, n, 0, 0xFFFF, column);
+                for (size_t e = 0; ok && e < n; e++) batch->epochs[e].hdop_x100 = (uint16_t)column[e];
+                break;
+            case MQTT_CBOR_BATCH_AGE_X100:
+                ok = readColumn(reader, n, 0, 0xFFFF, column);
+                for (size_t e = 0; ok && e < n; e++) batch->epochs[e].age_x100 = (uint16_t)column[e];
+                break;
+            default: ok = reader.skip(); break;
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+    if (!reader.atEnd()) {
+        return false;
+    }
+
+    // Apply the deltas to the base position
+    int64_t position[3] = {base[0], base[1], base[2]};
+    for (size_t e = 0; e < batch->count; e++) {
+        for (int c = 0; c < 3; c++) {
+            position[c] += deltas[c][e];
+            if (position[c] < INT32_MIN || position[c] > INT32_MAX) {
+                return false;
+            }
+        }
+        batch->epochs[e].lat_e7 = (int32_t)position[0];
+        batch->epochs[e].lon_e7 = (int32_t)position[1];
+        batch->epochs[e].alt_mm = (int32_t)position[2];
+    }
+    return true;
+}
@@ -0,0 +1,224 @@
+/*!
+ * \file MqttCborDecoder.h
+ * \brief Host side decoder for the MQTT messages in CBOR encoding.
+ *
+ * Decodes the `<topic>/GNSS`, `<topic>/status` and `<topic>/stats` payloads
+ * of a device whose topic encoding is set to CBOR into the same structures
+ * the firmware fills (copies of the structures in src/mqttClientTask.h). The
+ * map keys come from src/mqttCborSchema.h.
+ *
+ * The decoder follows the schema rules: keys it does not know are skipped,
+ * fields that are missing stay zero, and numbers are accepted in any CBOR
+ * width (including half precision floats). Malformed or truncated input,
+ * indefinite length items and values of the wrong type are rejected.
+ *
+ * Plain C++11 without dependencies, for use in consumer applications.
+ */
+
+#ifndef MQTT_CBOR_DECODER_H
+#define MQTT_CBOR_DECODER_H
+
+#include <cstdint>
+#include <stddef.h>
+
+#include "../../src/mqttCborSchema.h"
+
+#define RTCM_CONSTELLATION_COUNT 4
+
+// Copies of the distribution definitions in src/statisticsTask.h
+#define STATS_METRIC_COUNT 4            // HDOP, satellites, WiFi RSSI, correction age
+#define STATS_QUANTILE_COUNT 4          // p10, p50, p90, p99
+#define STATS_HISTOGRAM_MAX_BINS 16
+
+typedef struct {
+    uint32_t count;
+    uint8_t shift;
+    uint8_t bins;
+    uint8_t gaps[STATS_HISTOGRAM_MAX_BINS];
+    uint32_t counts[STATS_HISTOGRAM_MAX_BINS];
+} statistics_histogram_t;
+
+typedef struct {
+    uint32_t samples;
+    double mean_latitude;
+    double mean_longitude;
+    float mean_altitude_m;
+    float std_east_m;
+    float std_north_m;
+    float std_up_m;
+    float cep50_m;
+    float cep95_m;
+    float drms2_m;
+} statistics_position_t;
+
+// Copies of the message structures in src/mqttClientTask.h
+
+typedef struct {
+    uint32_t num;
+    char daytime[32];
+    double lat;
+    double lon;
+    float alt;
+    uint8_t fix_type;
+    float speed;
+    float dir;
+    uint8_t sats;
+    float hdop;
+    float age;
+} mqtt_gnss_message_t;
+
+typedef struct {
+    char timestamp[32];
+    uint32_t uptime_sec;
+    uint32_t heap_free;
+    uint32_t heap_min;
+    bool wifi_connected;
+    int8_t wifi_rssi;
+    bool ntrip_connected;
+    uint32_t ntrip_uptime_sec;
+    uint32_t ntrip_reconnects;
+    uint32_t rtcm_packets_total;
+    bool mqtt_connected;
+    uint32_t mqtt_uptime_sec;
+    uint32_t mqtt_published;
+    uint32_t wifi_reconnects;
+    uint8_t current_fix;
+    uint32_t gnss_batches;
+    uint32_t batched_epochs;
+    uint32_t messages_saved;
+    int64_t bytes_saved;
+    uint32_t gnss_epochs;
+    uint32_t gnss_age_avg_us;
+    uint32_t gnss_age_max_us;
+    uint32_t gnss_suppressed;
+    uint64_t gnss_suppressed_bytes;
+    uint32_t simplified_epochs;
+    uint32_t outbox_backlog;
+    uint32_t outbox_stored;
+    uint32_t outbox_drained;
+    uint32_t outbox_dropped;
+    uint32_t qos_acked;
+    uint32_t qos_dropped;
+    uint32_t puback_avg_ms;
+} mqtt_status_message_t;
+
+typedef struct {
+    char timestamp[32];
+    uint32_t period_duration;
+    uint32_t rtcm_bytes_received;
+    uint32_t rtcm_message_rate;
+    uint32_t rtcm_data_gaps;
+    uint32_t rtcm_avg_latency_ms;
+    uint32_t rtcm_corrupted;
+    uint8_t msm_satellites[RTCM_CONSTELLATION_COUNT];
+    uint8_t msm_signals[RTCM_CONSTELLATION_COUNT];
+    float msm_message_rate[RTCM_CONSTELLATION_COUNT];
+    uint32_t fix_quality_duration[9];
+    float rtk_fixed_percent;
+    uint32_t time_to_rtk_fixed_sec;
+    uint32_t fix_downgrades;
+    uint32_t fix_upgrades;
+    float hdop_avg;
+    float hdop_min;
+    float hdop_max;
+    uint8_t sats_avg;
+    float baseline_distance_km;
+    statistics_position_t position;
+    uint32_t gga_sent_count;
+    uint32_t gga_failures;
+    uint32_t gga_overflows;
+    uint32_t gga_vrs_regenerations;
+    int32_t gga_bytes_saved;
+    int8_t wifi_rssi_avg;
+    int8_t wifi_rssi_min;
+    int8_t wifi_rssi_max;
+    float wifi_uptime_percent;
+    uint32_t gnss_update_rate_hz;
+    uint32_t nmea_errors;
+    uint32_t uart_errors;
+    uint32_t rtcm_queue_overflows;
+    uint32_t ntrip_timeouts;
+    float quantiles[STATS_METRIC_COUNT][STATS_QUANTILE_COUNT];
+    statistics_histogram_t histograms[STATS_METRIC_COUNT];
+} mqtt_stats_message_t;
+
+// Largest number of epochs in a batched GNSS message (GnssBatch::MAX_EPOCHS)
+#define MQTT_GNSS_BATCH_MAX_EPOCHS 32
+
+/**
+ * \brief One epoch of a batched GNSS message, deltas already applied.
+ */
+typedef struct {
+    uint32_t t_ms;          // Offset to the first epoch
+    int32_t lat_e7;         // Latitude in 1e-7 degrees
+    int32_t lon_e7;         // Longitude in 1e-7 degrees
+    int32_t alt_mm;         // Altitude in mm
+    uint8_t fix_type;
+    uint8_t sats;
+    uint32_t speed_x100;    // Speed in 0.01 km/h
+    uint16_t dir_x10;       // Heading in 0.1 degrees
+    uint16_t hdop_x100;
+    uint16_t age_x100;      // Age of differential data in 0.01 s
+} mqtt_gnss_batch_epoch_t;
+
+/**
+ * \brief Batched GNSS message (`<topic>/GNSS/batch`).
+ */
+typedef struct {
+    uint32_t num;
+    char daytime[32];       // Time of the first epoch
+    uint8_t count;
+    mqtt_gnss_batch_epoch_t epochs[MQTT_GNSS_BATCH_MAX_EPOCHS];
+} mqtt_gnss_batch_t;
+
+/**
+ * \brief Pull parser for one CBOR data item at a time.
+ */
+class CborReader {
+public:
+    CborReader(const uint8_t* data, size_t length);
+
+    bool readMap(size_t* count);
+    bool readArray(size_t* count);
+    bool readUInt(uint64_t* value);
+    bool readInt(int64_t* value);
+    /** \brief Read a half, single or double precision float, or an integer. */
+    bool readDouble(double* value);
+    bool readBool(bool* value);
+    /** \brief Read a text string; it is truncated to fit and always terminated. */
+    bool readText(char* text, size_t size);
+    /** \brief Skip one data item including nested items. */
+    bool skip();
+
+    bool atEnd() const { return position == length; }
+
+private:
+    bool readHead(uint8_t* majorType, uint8_t* info, uint64_t* argument);
+    bool skipItem(int depth);
+
+    const uint8_t* data;
+    size_t length;
+    size_t position;
+};
+
+/**
+ * \brief Decode a `<topic>/GNSS` payload.
+ * \return true on success, false on malformed input (message is then undefined).
+ */
+bool mqttCborDecodeGnss(const uint8_t* data, size_t length, mqtt_gnss_message_t* message);
+
+/** \brief Decode a `<topic>/status` payload. */
+bool mqttCborDecodeStatus(const uint8_t* data, size_t length, mqtt_status_message_t* message);
+
+/** \brief Decode a `<topic>/stats` payload. */
+bool mqttCborDecodeStats(const uint8_t* data, size_t length, mqtt_stats_message_t* message);
+
+/**
+ * \brief Decode a `<topic>/GNSS/batch` payload into absolute epochs.
+ *
+ * COUNT must come before the arrays, all arrays must have COUNT items and
+ * COUNT must not exceed MQTT_GNSS_BATCH_MAX_EPOCHS.
+ */
+bool mqttCborDecodeGnssBatch(const uint8_t* data, size_t length, mqtt_gnss_batch_t* batch);
+
+#endif // MQTT_CBOR_DECODER_H
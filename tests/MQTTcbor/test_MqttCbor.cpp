@@ -0,0 +1,1422 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch.hpp"
+#include "CborWriter_standalone.h"
+#include "GnssBatch_standalone.h"
+#include "JsonWriter_standalone.h"
+#include "MqttCborDecoder.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+// Copies of the CBOR encoding in src/mqttClientTask.cpp
+// (cbor_length() only adds a log message, so the length is returned directly)
+
+// Encode GNSS message as CBOR (keys MQTT_CBOR_GNSS_*)
+static size_t encode_gnss_cbor(const mqtt_gnss_message_t *msg, uint8_t *buffer, size_t size) {
+    CborWriter cbor(buffer, size);
+    cbor.beginMap(MQTT_CBOR_GNSS_KEY_COUNT);
+    cbor.addUInt(MQTT_CBOR_GNSS_VERSION, MQTT_CBOR_SCHEMA_VERSION);
+    cbor.addUInt(MQTT_CBOR_GNSS_NUM, msg->num);
+    cbor.addText(MQTT_CBOR_GNSS_DAYTIME, msg->daytime);
+    cbor.addDouble(MQTT_CBOR_GNSS_LAT, msg->lat);
+    cbor.addDouble(MQTT_CBOR_GNSS_LON, msg->lon);
+    cbor.addFloat(MQTT_CBOR_GNSS_ALT, msg->alt);
+    cbor.addUInt(MQTT_CBOR_GNSS_FIX_TYPE, msg->fix_type);
+    cbor.addFloat(MQTT_CBOR_GNSS_SPEED, msg->speed);
+    cbor.addFloat(MQTT_CBOR_GNSS_DIR, msg->dir);
+    cbor.addUInt(MQTT_CBOR_GNSS_SATS, msg->sats);
+    cbor.addFloat(MQTT_CBOR_GNSS_HDOP, msg->hdop);
+    cbor.addFloat(MQTT_CBOR_GNSS_AGE, msg->age);
+    return cbor.length();
+}
+
+// Encode system status message as CBOR (keys MQTT_CBOR_STATUS_*)
+static size_t encode_status_cbor(const mqtt_status_message_t *msg, uint8_t *buffer, size_t size) {
+    CborWriter cbor(buffer, size);
+    cbor.beginMap(MQTT_CBOR_STATUS_KEY_COUNT);
+    cbor.addUInt(MQTT_CBOR_STATUS_VERSION, MQTT_CBOR_SCHEMA_VERSION);
+    cbor.addText(MQTT_CBOR_STATUS_TIMESTAMP, msg->timestamp);
+    cbor.addUInt(MQTT_CBOR_STATUS_UPTIME_SEC, msg->uptime_sec);
+    cbor.addUInt(MQTT_CBOR_STATUS_HEAP_FREE, msg->heap_free);
+    cbor.addUInt(MQTT_CBOR_STATUS_HEAP_MIN, msg->heap_min);
+    cbor.addBool(MQTT_CBOR_STATUS_WIFI_CONNECTED, msg->wifi_connected);
+    cbor.addInt(MQTT_CBOR_STATUS_WIFI_RSSI, msg->wifi_rssi);
+    cbor.addBool(MQTT_CBOR_STATUS_NTRIP_CONNECTED, msg->ntrip_connected);
+    cbor.addUInt(MQTT_CBOR_STATUS_NTRIP_UPTIME_SEC, msg->ntrip_uptime_sec);
+    cbor.addUInt(MQTT_CBOR_STATUS_NTRIP_RECONNECTS, msg->ntrip_reconnects);
+    cbor.addUInt(MQTT_CBOR_STATUS_RTCM_PACKETS_TOTAL, msg->rtcm_packets_total);
+    cbor.addBool(MQTT_CBOR_STATUS_MQTT_CONNECTED, msg->mqtt_connected);
+    cbor.addUInt(MQTT_CBOR_STATUS_MQTT_UPTIME_SEC, msg->mqtt_uptime_sec);
+    cbor.addUInt(MQTT_CBOR_STATUS_MQTT_PUBLISHED, msg->mqtt_published);
+    cbor.addUInt(MQTT_CBOR_STATUS_WIFI_RECONNECTS, msg->wifi_reconnects);
+    cbor.addUInt(MQTT_CBOR_STATUS_CURRENT_FIX, msg->current_fix);
+    cbor.addUInt(MQTT_CBOR_STATUS_GNSS_BATCHES, msg->gnss_batches);
+    cbor.addUInt(MQTT_CBOR_STATUS_BATCHED_EPOCHS, msg->batched_epochs);
+    cbor.addUInt(MQTT_CBOR_STATUS_MESSAGES_SAVED, msg->messages_saved);
+    cbor.addInt(MQTT_CBOR_STATUS_BYTES_SAVED, msg->bytes_saved);
+    cbor.addUInt(MQTT_CBOR_STATUS_GNSS_EPOCHS, msg->gnss_epochs);
+    cbor.addUInt(MQTT_CBOR_STATUS_GNSS_AGE_AVG_US, msg->gnss_age_avg_us);
+    cbor.addUInt(MQTT_CBOR_STATUS_GNSS_AGE_MAX_US, msg->gnss_age_max_us);
+    cbor.addUInt(MQTT_CBOR_STATUS_GNSS_SUPPRESSED, msg->gnss_suppressed);
+    cbor.addUInt(MQTT_CBOR_STATUS_GNSS_SUPPRESSED_BYTES, msg->gnss_suppressed_bytes);
+    cbor.addUInt(MQTT_CBOR_STATUS_SIMPLIFIED_EPOCHS, msg->simplified_epochs);
+    cbor.addUInt(MQTT_CBOR_STATUS_OUTBOX_BACKLOG, msg->outbox_backlog);
+    cbor.addUInt(MQTT_CBOR_STATUS_OUTBOX_STORED, msg->outbox_stored);
+    cbor.addUInt(MQTT_CBOR_STATUS_OUTBOX_DRAINED, msg->outbox_drained);
+    cbor.addUInt(MQTT_CBOR_STATUS_OUTBOX_DROPPED, msg->outbox_dropped);
+    cbor.addUInt(MQTT_CBOR_STATUS_QOS_ACKED, msg->qos_acked);
+    cbor.addUInt(MQTT_CBOR_STATUS_QOS_DROPPED, msg->qos_dropped);
+    cbor.addUInt(MQTT_CBOR_STATUS_PUBACK_AVG_MS, msg->puback_avg_ms);
+    return cbor.length();
+}
+
+// Encode statistics message as CBOR (keys MQTT_CBOR_STATS_*)
+static size_t encode_stats_cbor(const mqtt_stats_message_t *msg, uint8_t *buffer, size_t size) {
+    CborWriter cbor(buffer, size);
+    cbor.beginMap(MQTT_CBOR_STATS_KEY_COUNT);
+    cbor.addUInt(MQTT_CBOR_STATS_VERSION, MQTT_CBOR_SCHEMA_VERSION);
+    cbor.addText(MQTT_CBOR_STATS_TIMESTAMP, msg->timestamp);
+    cbor.addUInt(MQTT_CBOR_STATS_PERIOD_DURATION, msg->period_duration);
+    cbor.addUInt(MQTT_CBOR_STATS_RTCM_BYTES_RECEIVED, msg->rtcm_bytes_received);
+    cbor.addUInt(MQTT_CBOR_STATS_RTCM_MESSAGE_RATE, msg->rtcm_message_rate);
+    cbor.addUInt(MQTT_CBOR_STATS_RTCM_DATA_GAPS, msg->rtcm_data_gaps);
+    cbor.addUInt(MQTT_CBOR_STATS_RTCM_AVG_LATENCY_MS, msg->rtcm_avg_latency_ms);
+    cbor.addUInt(MQTT_CBOR_STATS_RTCM_CORRUPTED, msg->rtcm_corrupted);
+
+    cbor.addUInt(MQTT_CBOR_STATS_MSM_SATELLITES);
+    cbor.beginArray(RTCM_CONSTELLATION_COUNT);
+    for (int i = 0; i < RTCM_CONSTELLATION_COUNT; i++) {
+        cbor.addUInt(msg->msm_satellites[i]);
+    }
+    cbor.addUInt(MQTT_CBOR_STATS_MSM_SIGNALS);
+    cbor.beginArray(RTCM_CONSTELLATION_COUNT);
+    for (int i = 0; i < RTCM_CONSTELLATION_COUNT; i++) {
+        cbor.addUInt(msg->msm_signals[i]);
+    }
+    cbor.addUInt(MQTT_CBOR_STATS_MSM_MESSAGE_RATE);
+    cbor.beginArray(RTCM_CONSTELLATION_COUNT);
+    for (int i = 0; i < RTCM_CONSTELLATION_COUNT; i++) {
+        cbor.addFloat(msg->msm_message_rate[i]);
+    }
+    size_t fix_states = sizeof(msg->fix_quality_duration) / sizeof(msg->fix_quality_duration[0]);
+    cbor.addUInt(MQTT_CBOR_STATS_FIX_QUALITY_DURATION);
+    cbor.beginArray(fix_states);
+    for (size_t i = 0; i < fix_states; i++) {
+        cbor.addUInt(msg->fix_quality_duration[i]);
+    }
+
+    cbor.addFloat(MQTT_CBOR_STATS_RTK_FIXED_PERCENT, msg->rtk_fixed_percent);
+    cbor.addUInt(MQTT_CBOR_STATS_TIME_TO_RTK_FIXED_SEC, msg->time_to_rtk_fixed_sec);
+    cbor.addUInt(MQTT_CBOR_STATS_FIX_DOWNGRADES, msg->fix_downgrades);
+    cbor.addUInt(MQTT_CBOR_STATS_FIX_UPGRADES, msg->fix_upgrades);
+    cbor.addFloat(MQTT_CBOR_STATS_HDOP_AVG, msg->hdop_avg);
+    cbor.addFloat(MQTT_CBOR_STATS_HDOP_MIN, msg->hdop_min);
+    cbor.addFloat(MQTT_CBOR_STATS_HDOP_MAX, msg->hdop_max);
+    cbor.addUInt(MQTT_CBOR_STATS_SATS_AVG, msg->sats_avg);
+    cbor.addFloat(MQTT_CBOR_STATS_BASELINE_DISTANCE_KM, msg->baseline_distance_km);
+    cbor.addUInt(MQTT_CBOR_STATS_GGA_SENT_COUNT, msg->gga_sent_count);
+    cbor.addUInt(MQTT_CBOR_STATS_GGA_FAILURES, msg->gga_failures);
+    cbor.addUInt(MQTT_CBOR_STATS_GGA_OVERFLOWS, msg->gga_overflows);
+    cbor.addUInt(MQTT_CBOR_STATS_GGA_VRS_REGENERATIONS, msg->gga_vrs_regenerations);
+    cbor.addInt(MQTT_CBOR_STATS_GGA_BYTES_SAVED, msg->gga_bytes_saved);
+    cbor.addInt(MQTT_CBOR_STATS_WIFI_RSSI_AVG, msg->wifi_rssi_avg);
+    cbor.addInt(MQTT_CBOR_STATS_WIFI_RSSI_MIN, msg->wifi_rssi_min);
+    cbor.addInt(MQTT_CBOR_STATS_WIFI_RSSI_MAX, msg->wifi_rssi_max);
+    cbor.addFloat(MQTT_CBOR_STATS_WIFI_UPTIME_PERCENT, msg->wifi_uptime_percent);
+    cbor.addUInt(MQTT_CBOR_STATS_GNSS_UPDATE_RATE_HZ, msg->gnss_update_rate_hz);
+    cbor.addUInt(MQTT_CBOR_STATS_NMEA_ERRORS, msg->nmea_errors);
+    cbor.addUInt(MQTT_CBOR_STATS_UART_ERRORS, msg->uart_errors);
+    cbor.addUInt(MQTT_CBOR_STATS_RTCM_QUEUE_OVERFLOWS, msg->rtcm_queue_overflows);
+    cbor.addUInt(MQTT_CBOR_STATS_NTRIP_TIMEOUTS, msg->ntrip_timeouts);
+
+    cbor.addUInt(MQTT_CBOR_STATS_QUANTILES);
+    cbor.beginArray(STATS_METRIC_COUNT);
+    for (int m = 0; m < STATS_METRIC_COUNT; m++) {
+        cbor.beginArray(STATS_QUANTILE_COUNT);
+        for (int q = 0; q < STATS_QUANTILE_COUNT; q++) {
+            cbor.addFloat(msg->quantiles[m][q]);
+        }
+    }
+    cbor.addUInt(MQTT_CBOR_STATS_HISTOGRAMS);
+    cbor.beginArray(STATS_METRIC_COUNT);
+    for (int m = 0; m < STATS_METRIC_COUNT; m++) {
+        const statistics_histogram_t *histogram = &msg->histograms[m];
+        size_t bins = histogram->bins < STATS_HISTOGRAM_MAX_BINS ? histogram->bins : STATS_HISTOGRAM_MAX_BINS;
+        cbor.beginArray(2 + 2 * bins);
+        cbor.addUInt(histogram->count);
+        cbor.addUInt(histogram->shift);
+        for (size_t i = 0; i < bins; i++) {
+            cbor.addUInt(histogram->gaps[i]);
+            cbor.addUInt(histogram->counts[i]);
+        }
+    }
+    cbor.addUInt(MQTT_CBOR_STATS_POSITION);
+    cbor.beginArray(10);
+    cbor.addUInt(msg->position.samples);
+    cbor.addDouble(msg->position.mean_latitude);
+    cbor.addDouble(msg->position.mean_longitude);
+    cbor.addFloat(msg->position.mean_altitude_m);
+    cbor.addFloat(msg->position.std_east_m);
+    cbor.addFloat(msg->position.std_north_m);
+    cbor.addFloat(msg->position.std_up_m);
+    cbor.addFloat(msg->position.cep50_m);
+    cbor.addFloat(msg->position.cep95_m);
+    cbor.addFloat(msg->position.drms2_m);
+    return cbor.length();
+}
+
+// Encode batched GNSS message as CBOR (keys MQTT_CBOR_BATCH_*)
+static size_t encode_gnss_batch_cbor(const GnssBatch *batch, uint32_t num, const char *daytime, uint8_t *buffer, size_t size) {
+    uint8_t count = batch->count();
+    int32_t lat = count > 0 ? batch->epoch(0).latE7 : 0;
+    int32_t lon = count > 0 ? batch->epoch(0).lonE7 : 0;
+    int32_t alt = count > 0 ? batch->epoch(0).altMm : 0;
+    
+    CborWriter cbor(buffer, size);
+    cbor.beginMap(MQTT_CBOR_BATCH_KEY_COUNT);
+    cbor.addUInt(MQTT_CBOR_BATCH_VERSION, MQTT_CBOR_SCHEMA_VERSION);
+    cbor.addUInt(MQTT_CBOR_BATCH_NUM, num);
+    cbor.addText(MQTT_CBOR_BATCH_DAYTIME, daytime);
+    cbor.addUInt(MQTT_CBOR_BATCH_COUNT, count);
+    cbor.addInt(MQTT_CBOR_BATCH_LAT_E7, lat);
+    cbor.addInt(MQTT_CBOR_BATCH_LON_E7, lon);
+    cbor.addInt(MQTT_CBOR_BATCH_ALT_MM, alt);
+    
+    cbor.addUInt(MQTT_CBOR_BATCH_T_MS);
+    cbor.beginArray(count);
+    for (uint8_t i = 0; i < count; i++) cbor.addUInt(batch->timeOffsetMs(i));
+    cbor.addUInt(MQTT_CBOR_BATCH_DLAT_E7);
+    cbor.beginArray(count);
+    for (uint8_t i = 0; i < count; i++) cbor.addInt(batch->latDelta(i));
+    cbor.addUInt(MQTT_CBOR_BATCH_DLON_E7);
+    cbor.beginArray(count);
+    for (uint8_t i = 0; i < count; i++) cbor.addInt(batch->lonDelta(i));
+    cbor.addUInt(MQTT_CBOR_BATCH_DALT_MM);
+    cbor.beginArray(count);
+    for (uint8_t i = 0; i < count; i++) cbor.addInt(batch->altDelta(i));
+    cbor.addUInt(MQTT_CBOR_BATCH_FIX_TYPE);
+    cbor.beginArray(count);
+    for (uint8_t i = 0; i < count; i++) cbor.addUInt(batch->epoch(i).fixType);
+    cbor.addUInt(MQTT_CBOR_BATCH_SATS);
+    cbor.beginArray(count);
+    for (uint8_t i = 0; i < count; i++) cbor.addUInt(batch->epoch(i).sats);
+    cbor.addUInt(MQTT_CBOR_BATCH_SPEED_X100);
+    cbor.beginArray(count);
+    for (uint8_t i = 0; i < count; i++) cbor.addUInt(batch->epoch(i).speedX100);
+    cbor.addUInt(MQTT_CBOR_BATCH_DIR_X10);
+    cbor.beginArray(count);
+    for (uint8_t i = 0; i < count; i++) cbor.addUInt(batch->epoch(i).dirX10);
+    cbor.addUInt(MQTT_CBOR_BATCH_HDOP_X100);
+    cbor.beginArray(count);
+    for (uint8_t i = 0; i < count; i++) cbor.addUInt(batch->epoch(i).hdopX100);
+    cbor.addUInt(MQTT_CBOR_BATCH_AGE_X100);
+    cbor.beginArray(count);
+    for (uint8_t i = 0; i < count; i++) cbor.addUInt(batch->epoch(i).ageX100);
+    return cbor.length();
+}
+
+// Copies of the JsonWriter formatting in src/mqttClientTask.cpp
+
+static size_t writer_gnss_json(const mqtt_gnss_message_t *msg, char *buffer, size_t size) {
+    JsonWriter json(buffer, size);
+    json.beginObject();
+    json.addUInt("num", msg->num);
+    json.addString("daytime", msg->daytime);
+    json.addFixed("lat", msg->lat, 7);
+    json.addFixed("lon", msg->lon, 7);
+    json.addFixed("alt", msg->alt, 3);
+    json.addUInt("fix_type", msg->fix_type);
+    json.addFixed("speed", msg->speed, 2);
+    json.addFixed("dir", msg->dir, 1);
+    json.addUInt("sats", msg->sats);
+    json.addFixed("hdop", msg->hdop, 2);
+    json.addFixed("age", msg->age, 2);
+    json.endObject();
+    return json.length();
+}
+
+static size_t writer_status_json(const mqtt_status_message_t *msg, char *buffer, size_t size) {
+    JsonWriter json(buffer, size);
+    json.beginObject();
+    json.addString("timestamp", msg->timestamp);
+    json.addUInt("uptime_sec", msg->uptime_sec);
+    json.addUInt("heap_free", msg->heap_free);
+    json.addUInt("heap_min", msg->heap_min);
+    json.beginObject("wifi");
+    json.addInt("rssi_dbm", msg->wifi_rssi);
+    json.addUInt("reconnects", msg->wifi_reconnects);
+    json.endObject();
+    json.beginObject("ntrip");
+    json.addBool("connected", msg->ntrip_connected);
+    json.addUInt("uptime_sec", msg->ntrip_uptime_sec);
+    json.addUInt("reconnects", msg->ntrip_reconnects);
+    json.addUInt("rtcm_packets_total", msg->rtcm_packets_total);
+    json.endObject();
+    json.beginObject("mqtt");
+    json.addUInt("uptime_sec", msg->mqtt_uptime_sec);
+    json.addUInt("messages_published", msg->mqtt_published);
+    json.addUInt("gnss_batches", msg->gnss_batches);
+    json.addUInt("batched_epochs", msg->batched_epochs);
+    json.addUInt("messages_saved", msg->messages_saved);
+    json.addInt64("bytes_saved", msg->bytes_saved);
+    json.addUInt("gnss_epochs", msg->gnss_epochs);
+    json.addUInt("gnss_age_avg_us", msg->gnss_age_avg_us);
+    json.addUInt("gnss_age_max_us", msg->gnss_age_max_us);
+    json.addUInt("gnss_suppressed", msg->gnss_suppressed);
+    json.addInt64("gnss_suppressed_bytes", (int64_t)msg->gnss_suppressed_bytes);
+    json.addUInt("simplified_epochs", msg->simplified_epochs);
+    json.addUInt("outbox_backlog", msg->outbox_backlog);
+    json.addUInt("outbox_stored", msg->outbox_stored);
+    json.addUInt("outbox_drained", msg->outbox_drained);
+    json.addUInt("outbox_dropped", msg->outbox_dropped);
+    json.addUInt("qos_acked", msg->qos_acked);
+    json.addUInt("qos_dropped", msg->qos_dropped);
+    json.addUInt("puback_avg_ms", msg->puback_avg_ms);
+    json.endObject();
+    json.beginObject("gnss");
+    json.addUInt("current_fix", msg->current_fix);
+    json.endObject();
+    json.endObject();
+    return json.length();
+}
+
+static size_t writer_stats_json(const mqtt_stats_message_t *msg, char *buffer, size_t size) {
+    static const char *constellation_names[RTCM_CONSTELLATION_COUNT] = {"gps", "glonass", "galileo", "beidou"};
+
+    static const char *metric_names[STATS_METRIC_COUNT] = {"hdop", "satellites", "wifi_rssi", "correction_age"};
+    static const uint8_t metric_decimals[STATS_METRIC_COUNT] = {2, 0, 0, 1};
+    static const char *quantile_names[STATS_QUANTILE_COUNT] = {"p10", "p50", "p90", "p99"};
+
+    JsonWriter json(buffer, size);
+    json.beginObject();
+    json.addString("timestamp", msg->timestamp);
+    json.addUInt("period_sec", msg->period_duration);
+
+    json.beginObject("rtcm");
+    json.addUInt("bytes_received", msg->rtcm_bytes_received);
+    json.addUInt("message_rate", msg->rtcm_message_rate);
+    json.addUInt("data_gaps", msg->rtcm_data_gaps);
+    json.addUInt("avg_latency_ms", msg->rtcm_avg_latency_ms);
+    json.addUInt("corrupted", msg->rtcm_corrupted);
+    json.beginObject("constellations");
+    for (int i = 0; i < RTCM_CONSTELLATION_COUNT; i++) {
+        json.beginObject(constellation_names[i], true);
+        json.addUInt("satellites", msg->msm_satellites[i]);
+        json.addUInt("signals", msg->msm_signals[i]);
+        json.addFixed("message_rate", msg->msm_message_rate[i], 2);
+        json.endObject();
+    }
+    json.endObject();
+    json.endObject();
+
+    json.beginObject("gnss");
+    json.beginObject("fix_duration");
+    json.addUInt("no_fix", msg->fix_quality_duration[0]);
+    json.addUInt("gps", msg->fix_quality_duration[1]);
+    json.addUInt("dgps", msg->fix_quality_duration[2]);
+    json.addUInt("rtk_float", msg->fix_quality_duration[5]);
+    json.addUInt("rtk_fixed", msg->fix_quality_duration[4]);
+    json.endObject();
+    json.addFixed("rtk_fixed_percent", msg->rtk_fixed_percent, 1);
+    json.addUInt("time_to_rtk_fixed_sec", msg->time_to_rtk_fixed_sec);
+    json.addUInt("fix_downgrades", msg->fix_downgrades);
+    json.addUInt("fix_upgrades", msg->fix_upgrades);
+    json.addFixed("hdop_avg", msg->hdop_avg, 2);
+    json.addFixed("hdop_min", msg->hdop_min, 2);
+    json.addFixed("hdop_max", msg->hdop_max, 2);
+    json.addUInt("sats_avg", msg->sats_avg);
+    json.addFixed("baseline_distance_km", msg->baseline_distance_km, 2);
+    json.addUInt("update_rate_hz", msg->gnss_update_rate_hz);
+    json.endObject();
+
+    json.beginObject("position");
+    json.addUInt("samples", msg->position.samples);
+    json.addFixed("mean_lat", msg->position.mean_latitude, 8);
+    json.addFixed("mean_lon", msg->position.mean_longitude, 8);
+    json.addFixed("mean_alt_m", msg->position.mean_altitude_m, 3);
+    json.addFixed("std_east_m", msg->position.std_east_m, 3);
+    json.addFixed("std_north_m", msg->position.std_north_m, 3);
+    json.addFixed("std_up_m", msg->position.std_up_m, 3);
+    json.addFixed("cep50_m", msg->position.cep50_m, 3);
+    json.addFixed("cep95_m", msg->position.cep95_m, 3);
+    json.addFixed("drms2_m", msg->position.drms2_m, 3);
+    json.endObject();
+
+    json.beginObject("gga");
+    json.addUInt("sent_count", msg->gga_sent_count);
+    json.addUInt("failures", msg->gga_failures);
+    json.addUInt("queue_overflows", msg->gga_overflows);
+    json.addUInt("vrs_regenerations", msg->gga_vrs_regenerations);
+    json.addInt("bytes_saved", msg->gga_bytes_saved);
+    json.endObject();
+
+    json.beginObject("wifi");
+    json.addInt("rssi_avg", msg->wifi_rssi_avg);
+    json.addInt("rssi_min", msg->wifi_rssi_min);
+    json.addInt("rssi_max", msg->wifi_rssi_max);
+    json.addFixed("uptime_percent", msg->wifi_uptime_percent, 1);
+    json.endObject();
+
+    json.beginObject("errors");
+    json.addUInt("nmea_checksum", msg->nmea_errors);
+    json.addUInt("uart", msg->uart_errors);
+    json.addUInt("rtcm_queue_overflow", msg->rtcm_queue_overflows);
+    json.addUInt("ntrip_timeouts", msg->ntrip_timeouts);
+    json.endObject();
+
+    // Histogram bins as [gap, count, gap, count, ...]
+    json.beginObject("distributions");
+    for (int m = 0; m < STATS_METRIC_COUNT; m++) {
+        const statistics_histogram_t *histogram = &msg->histograms[m];
+        json.beginObject(metric_names[m], true);
+        json.addUInt("count", histogram->count);
+        for (int q = 0; q < STATS_QUANTILE_COUNT; q++) {
+            json.addFixed(quantile_names[q], msg->quantiles[m][q], metric_decimals[m]);
+        }
+        json.addUInt("shift", histogram->shift);
+        json.beginArray("bins");
+        for (int i = 0; i < histogram->bins && i < STATS_HISTOGRAM_MAX_BINS; i++) {
+            json.addItem(histogram->gaps[i]);
+            json.addItem(histogram->counts[i]);
+        }
+        json.endArray();
+        json.endObject();
+    }
+    json.endObject();
+    json.endObject();
+    return json.length();
+}
+
+// Format batched GNSS message as JSON (base position, then one array per field)
+static size_t writer_gnss_batch_json(const GnssBatch *batch, uint32_t num, const char *daytime, char *buffer, size_t size) {
+    uint8_t count = batch->count();
+    JsonWriter json(buffer, size);
+    json.beginObject();
+    json.addUInt("num", num);
+    json.addString("daytime", daytime);
+    json.addUInt("count", count);
+    if (count > 0) {
+        const GnssEpoch &base = batch->epoch(0);
+        json.addFixed("lat", base.latE7 / 1e7, 7);
+        json.addFixed("lon", base.lonE7 / 1e7, 7);
+        json.addFixed("alt", base.altMm / 1e3, 3);
+    }
+    
+    json.beginArray("t_ms");
+    for (uint8_t i = 0; i < count; i++) json.addItem(batch->timeOffsetMs(i));
+    json.endArray();
+    json.beginArray("dlat_e7");
+    for (uint8_t i = 0; i < count; i++) json.addItem(batch->latDelta(i));
+    json.endArray();
+    json.beginArray("dlon_e7");
+    for (uint8_t i = 0; i < count; i++) json.addItem(batch->lonDelta(i));
+    json.endArray();
+    json.beginArray("dalt_mm");
+    for (uint8_t i = 0; i < count; i++) json.addItem(batch->altDelta(i));
+    json.endArray();
+    json.beginArray("fix_type");
+    for (uint8_t i = 0; i < count; i++) json.addItem(batch->epoch(i).fixType);
+    json.endArray();
+    json.beginArray("sats");
+    for (uint8_t i = 0; i < count; i++) json.addItem(batch->epoch(i).sats);
+    json.endArray();
+    json.beginArray("speed_x100");
+    for (uint8_t i = 0; i < count; i++) json.addItem(batch->epoch(i).speedX100);
+    json.endArray();
+    json.beginArray("dir_x10");
+    for (uint8_t i = 0; i < count; i++) json.addItem(batch->epoch(i).dirX10);
+    json.endArray();
+    json.beginArray("hdop_x100");
+    for (uint8_t i = 0; i < count; i++) json.addItem(batch->epoch(i).hdopX100);
+    json.endArray();
+    json.beginArray("age_x100");
+    for (uint8_t i = 0; i < count; i++) json.addItem(batch->epoch(i).ageX100);
+    json.endArray();
+    json.endObject();
+    return json.length();
+}
+
+// Size of an MQTT 3.1.1 PUBLISH packet with QoS 0 (fixed header, topic, payload)
+static size_t mqtt_publish_packet_size(size_t topic_length, size_t payload_length) {
+    size_t remaining = 2 + topic_length + payload_length;
+    size_t length_bytes = 1;
+    for (size_t n = remaining; n >= 128; n /= 128) {
+        length_bytes++;
+    }
+    return 1 + length_bytes + remaining;
+}
+
+// Random message contents in realistic ranges
+
+static mqtt_gnss_message_t makeGnssMessage(std::mt19937& rng) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    mqtt_gnss_message_t msg = {};
+    msg.num = rng();
+    snprintf(msg.daytime, sizeof(msg.daytime), "2026-10-17 12:%02u:%02u.%03u",
+             (unsigned)(rng() % 60), (unsigned)(rng() % 60), (unsigned)(rng() % 1000));
+    msg.lat = unit(rng) * 180.0 - 90.0;
+    msg.lon = unit(rng) * 360.0 - 180.0;
+    msg.alt = (float)(unit(rng) * 9000.0 - 400.0);
+    msg.fix_type = rng() % 9;
+    msg.speed = (float)(unit(rng) * 60.0);
+    msg.dir = (float)(unit(rng) * 360.0);
+    msg.sats = rng() % 64;
+    msg.hdop = (float)(unit(rng) * 25.0);
+    msg.age = (float)(unit(rng) * 30.0);
+    return msg;
+}
+
+static mqtt_status_message_t makeStatusMessage(std::mt19937& rng) {
+    mqtt_status_message_t msg = {};
+    snprintf(msg.timestamp, sizeof(msg.timestamp), "2026-10-17T12:%02u:%02uZ",
+             (unsigned)(rng() % 60), (unsigned)(rng() % 60));
+    msg.uptime_sec = rng();
+    msg.heap_free = rng() % 300000;
+    msg.heap_min = rng() % 300000;
+    msg.wifi_connected = (rng() & 1) != 0;
+    msg.wifi_rssi = (int8_t)(-(int)(rng() % 100));
+    msg.ntrip_connected = (rng() & 1) != 0;
+    msg.ntrip_uptime_sec = rng();
+    msg.ntrip_reconnects = rng() % 1000;
+    msg.rtcm_packets_total = rng();
+    msg.mqtt_uptime_sec = rng();
+    msg.mqtt_published = rng();
+    msg.mqtt_connected = (rng() & 1) != 0;
+    msg.wifi_reconnects = rng() % 100;
+    msg.current_fix = rng() % 9;
+    msg.gnss_batches = rng() % 100000;
+    msg.batched_epochs = rng();
+    msg.messages_saved = rng();
+    msg.bytes_saved = (int64_t)(rng() % 1000000) * 10000 - 1000000;
+    msg.gnss_epochs = rng();
+    msg.gnss_age_avg_us = rng() % 100000;
+    msg.gnss_age_max_us = rng() % 10000000;
+    msg.gnss_suppressed = rng();
+    msg.gnss_suppressed_bytes = (uint64_t)rng() * 100;
+    msg.simplified_epochs = rng();
+    msg.outbox_backlog = rng() % 100000;
+    msg.outbox_stored = rng();
+    msg.outbox_drained = rng();
+    msg.outbox_dropped = rng() % 1000;
+    msg.qos_acked = rng();
+    msg.qos_dropped = rng() % 1000;
+    msg.puback_avg_ms = rng() % 5000;
+    return msg;
+}
+
+static mqtt_stats_message_t makeStatsMessage(std::mt19937& rng) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    mqtt_stats_message_t msg = {};
+    snprintf(msg.timestamp, sizeof(msg.timestamp), "2026-10-17T12:%02u:%02uZ",
+             (unsigned)(rng() % 60), (unsigned)(rng() % 60));
+    msg.period_duration = rng() % 3600;
+    msg.rtcm_bytes_received = rng();
+    msg.rtcm_message_rate = rng() % 100;
+    msg.rtcm_data_gaps = rng() % 10;
+    msg.rtcm_avg_latency_ms = rng() % 5000;
+    msg.rtcm_corrupted = rng() % 10;
+    for (int i = 0; i < RTCM_CONSTELLATION_COUNT; i++) {
+        msg.msm_satellites[i] = rng() % 40;
+        msg.msm_signals[i] = rng() % 32;
+        msg.msm_message_rate[i] = (float)(unit(rng) * 2.0);
+    }
+    for (int i = 0; i < 9; i++) {
+        msg.fix_quality_duration[i] = rng() % 3600;
+    }
+    msg.rtk_fixed_percent = (float)(unit(rng) * 100.0);
+    msg.time_to_rtk_fixed_sec = rng() % 600;
+    msg.fix_downgrades = rng() % 50;
+    msg.fix_upgrades = rng() % 50;
+    msg.hdop_avg = (float)(unit(rng) * 5.0);
+    msg.hdop_min = (float)(unit(rng) * 5.0);
+    msg.hdop_max = (float)(unit(rng) * 50.0);
+    msg.sats_avg = rng() % 40;
+    msg.baseline_distance_km = (float)(unit(rng) * 100.0);
+    msg.position.samples = rng() % 3600;
+    msg.position.mean_latitude = unit(rng) * 180.0 - 90.0;
+    msg.position.mean_longitude = unit(rng) * 360.0 - 180.0;
+    msg.position.mean_altitude_m = (float)(unit(rng) * 1000.0);
+    msg.position.std_east_m = (float)(unit(rng) * 0.05);
+    msg.position.std_north_m = (float)(unit(rng) * 0.05);
+    msg.position.std_up_m = (float)(unit(rng) * 0.1);
+    msg.position.cep50_m = (float)(unit(rng) * 0.05);
+    msg.position.cep95_m = (float)(unit(rng) * 0.1);
+    msg.position.drms2_m = (float)(unit(rng) * 0.15);
+    msg.gga_sent_count = rng() % 400;
+    msg.gga_failures = rng() % 10;
+    msg.gga_overflows = rng() % 10;
+    msg.gga_vrs_regenerations = rng() % 400;
+    msg.gga_bytes_saved = (int32_t)(rng() % 60000) - 10000;
+    msg.wifi_rssi_avg = (int8_t)(-(int)(rng() % 100));
+    msg.wifi_rssi_min = (int8_t)(-(int)(rng() % 100));
+    msg.wifi_rssi_max = (int8_t)(-(int)(rng() % 100));
+    msg.wifi_uptime_percent = (float)(unit(rng) * 100.0);
+    msg.gnss_update_rate_hz = rng() % 20;
+    msg.nmea_errors = rng() % 100;
+    msg.uart_errors = rng() % 100;
+    msg.rtcm_queue_overflows = rng() % 100;
+    msg.ntrip_timeouts = rng() % 100;
+    for (int m = 0; m < STATS_METRIC_COUNT; m++) {
+        for (int q = 0; q < STATS_QUANTILE_COUNT; q++) {
+            msg.quantiles[m][q] = (float)(unit(rng) * 100.0);
+        }
+        // A period of samples spread over up to all bins
+        statistics_histogram_t *histogram = &msg.histograms[m];
+        histogram->shift = rng() % 3;
+        histogram->bins = rng() % (STATS_HISTOGRAM_MAX_BINS + 1);
+        for (int i = 0; i < histogram->bins; i++) {
+            histogram->gaps[i] = (i == 0) ? rng() % 100 : 1 + rng() % 4;
+            histogram->counts[i] = 1 + rng() % 600;
+            histogram->count += histogram->counts[i];
+        }
+    }
+    return msg;
+}
+
+static std::string hex(const uint8_t* data, size_t length) {
+    static const char digits[] = "0123456789abcdef";
+    std::string text;
+    for (size_t i = 0; i < length; i++) {
+        text += digits[data[i] >> 4];
+        text += digits[data[i] & 0x0F];
+    }
+    return text;
+}
+
+template <typename Add>
+static std::string encoded(Add add) {
+    uint8_t buffer[64];
+    CborWriter cbor(buffer, sizeof(buffer));
+    add(cbor);
+    return hex(buffer, cbor.length());
+}
+
+static bool sameGnss(const mqtt_gnss_message_t& a, const mqtt_gnss_message_t& b) {
+    return a.num == b.num && strcmp(a.daytime, b.daytime) == 0 && a.lat == b.lat && a.lon == b.lon &&
+           a.alt == b.alt && a.fix_type == b.fix_type && a.speed == b.speed && a.dir == b.dir &&
+           a.sats == b.sats && a.hdop == b.hdop && a.age == b.age;
+}
+
+static bool sameStatus(const mqtt_status_message_t& a, const mqtt_status_message_t& b) {
+    return strcmp(a.timestamp, b.timestamp) == 0 && a.uptime_sec == b.uptime_sec &&
+           a.heap_free == b.heap_free && a.heap_min == b.heap_min && a.wifi_connected == b.wifi_connected &&
+           a.wifi_rssi == b.wifi_rssi && a.ntrip_connected == b.ntrip_connected &&
+           a.ntrip_uptime_sec == b.ntrip_uptime_sec && a.ntrip_reconnects == b.ntrip_reconnects &&
+           a.rtcm_packets_total == b.rtcm_packets_total && a.mqtt_connected == b.mqtt_connected &&
+           a.mqtt_uptime_sec == b.mqtt_uptime_sec && a.mqtt_published == b.mqtt_published &&
+           a.wifi_reconnects == b.wifi_reconnects && a.current_fix == b.current_fix &&
+           a.gnss_batches == b.gnss_batches && a.batched_epochs == b.batched_epochs &&
+           a.messages_saved == b.messages_saved && a.bytes_saved == b.bytes_saved &&
+           a.gnss_epochs == b.gnss_epochs && a.gnss_age_avg_us == b.gnss_age_avg_us &&
+           a.gnss_age_max_us == b.gnss_age_max_us && a.gnss_suppressed == b.gnss_suppressed &&
+           a.gnss_suppressed_bytes == b.gnss_suppressed_bytes && a.simplified_epochs == b.simplified_epochs &&
+           a.outbox_backlog == b.outbox_backlog && a.outbox_stored == b.outbox_stored &&
+           a.outbox_drained == b.outbox_drained && a.outbox_dropped == b.outbox_dropped &&
+           a.qos_acked == b.qos_acked && a.qos_dropped == b.qos_dropped && a.puback_avg_ms == b.puback_avg_ms;
+}
+
+static bool sameStats(const mqtt_stats_message_t& a, const mqtt_stats_message_t& b) {
+    for (int i = 0; i < RTCM_CONSTELLATION_COUNT; i++) {
+        if (a.msm_satellites[i] != b.msm_satellites[i] || a.msm_signals[i] != b.msm_signals[i] ||
+            a.msm_message_rate[i] != b.msm_message_rate[i]) {
+            return false;
+        }
+    }
+    for (int i = 0; i < 9; i++) {
+        if (a.fix_quality_duration[i] != b.fix_quality_duration[i]) {
+            return false;
+        }
+    }
+    const statistics_position_t& pa = a.position;
+    const statistics_position_t& pb = b.position;
+    if (pa.samples != pb.samples || pa.mean_latitude != pb.mean_latitude ||
+        pa.mean_longitude != pb.mean_longitude || pa.mean_altitude_m != pb.mean_altitude_m ||
+        pa.std_east_m != pb.std_east_m || pa.std_north_m != pb.std_north_m || pa.std_up_m != pb.std_up_m ||
+        pa.cep50_m != pb.cep50_m || pa.cep95_m != pb.cep95_m || pa.drms2_m != pb.drms2_m) {
+        return false;
+    }
+    for (int m = 0; m < STATS_METRIC_COUNT; m++) {
+        const statistics_histogram_t& ha = a.histograms[m];
+        const statistics_histogram_t& hb = b.histograms[m];
+        if (memcmp(a.quantiles[m], b.quantiles[m], sizeof(a.quantiles[m])) != 0 ||
+            ha.count != hb.count || ha.shift != hb.shift || ha.bins != hb.bins) {
+            return false;
+        }
+        for (int i = 0; i < ha.bins; i++) {
+            if (ha.gaps[i] != hb.gaps[i] || ha.counts[i] != hb.counts[i]) {
+                return false;
+            }
+        }
+    }
+    return strcmp(a.timestamp, b.timestamp) == 0 && a.period_duration == b.period_duration &&
+           a.rtcm_bytes_received == b.rtcm_bytes_received && a.rtcm_message_rate == b.rtcm_message_rate &&
+           a.rtcm_data_gaps == b.rtcm_data_gaps && a.rtcm_avg_latency_ms == b.rtcm_avg_latency_ms &&
+           a.rtcm_corrupted == b.rtcm_corrupted && a.rtk_fixed_percent == b.rtk_fixed_percent &&
+           a.time_to_rtk_fixed_sec == b.time_to_rtk_fixed_sec && a.fix_downgrades == b.fix_downgrades &&
+           a.fix_upgrades == b.fix_upgrades && a.hdop_avg == b.hdop_avg && a.hdop_min == b.hdop_min &&
+           a.hdop_max == b.hdop_max && a.sats_avg == b.sats_avg &&
+           a.baseline_distance_km == b.baseline_distance_km && a.gga_sent_count == b.gga_sent_count &&
+           a.gga_failures == b.gga_failures && a.gga_overflows == b.gga_overflows &&
+           a.gga_vrs_regenerations == b.gga_vrs_regenerations && a.gga_bytes_saved == b.gga_bytes_saved &&
+           a.wifi_rssi_avg == b.wifi_rssi_avg && a.wifi_rssi_min == b.wifi_rssi_min &&
+           a.wifi_rssi_max == b.wifi_rssi_max && a.wifi_uptime_percent == b.wifi_uptime_percent &&
+           a.gnss_update_rate_hz == b.gnss_update_rate_hz && a.nmea_errors == b.nmea_errors &&
+           a.uart_errors == b.uart_errors && a.rtcm_queue_overflows == b.rtcm_queue_overflows &&
+           a.ntrip_timeouts == b.ntrip_timeouts;
+}
+
+static mqtt_gnss_message_t fixedGnssMessage() {
+    mqtt_gnss_message_t msg = {};
+    msg.num = 42;
+    strcpy(msg.daytime, "12:00");
+    msg.lat = 52.0;
+    msg.lon = 5.0;
+    msg.alt = 10.5f;
+    msg.fix_type = 4;
+    msg.sats = 12;
+    msg.hdop = 0.5f;
+    msg.age = 1.0f;
+    return msg;
+}
+
+TEST_CASE("CborWriter - RFC 8949 examples", "[CborWriter]") {
+    SECTION("Integers use the shortest head") {
+        REQUIRE(encoded([](CborWriter& c) { c.addUInt(0); }) == "00");
+        REQUIRE(encoded([](CborWriter& c) { c.addUInt(23); }) == "17");
+        REQUIRE(encoded([](CborWriter& c) { c.addUInt(24); }) == "1818");
+        REQUIRE(encoded([](CborWriter& c) { c.addUInt(100); }) == "1864");
+        REQUIRE(encoded([](CborWriter& c) { c.addUInt(1000); }) == "1903e8");
+        REQUIRE(encoded([](CborWriter& c) { c.addUInt(1000000); }) == "1a000f4240");
+        REQUIRE(encoded([](CborWriter& c) { c.addUInt(1000000000000ULL); }) == "1b000000e8d4a51000");
+        REQUIRE(encoded([](CborWriter& c) { c.addUInt(UINT64_MAX); }) == "1bffffffffffffffff");
+    }
+
+    SECTION("Negative integers") {
+        REQUIRE(encoded([](CborWriter& c) { c.addInt(-1); }) == "20");
+        REQUIRE(encoded([](CborWriter& c) { c.addInt(-10); }) == "29");
+        REQUIRE(encoded([](CborWriter& c) { c.addInt(-100); }) == "3863");
+        REQUIRE(encoded([](CborWriter& c) { c.addInt(-1000); }) == "3903e7");
+        REQUIRE(encoded([](CborWriter& c) { c.addInt(INT64_MIN); }) == "3b7fffffffffffffff");
+        REQUIRE(encoded([](CborWriter& c) { c.addInt(10); }) == "0a");
+    }
+
+    SECTION("Floats, booleans and text") {
+        REQUIRE(encoded([](CborWriter& c) { c.addFloat(100000.0f); }) == "fa47c35000");
+        REQUIRE(encoded([](CborWriter& c) { c.addFloat(-4.0f); }) == "fac0800000");
+        REQUIRE(encoded([](CborWriter& c) { c.addDouble(1.1); }) == "fb3ff199999999999a");
+        REQUIRE(encoded([](CborWriter& c) { c.addDouble(-4.1); }) == "fbc010666666666666");
+        REQUIRE(encoded([](CborWriter& c) { c.addBool(false); }) == "f4");
+        REQUIRE(encoded([](CborWriter& c) { c.addBool(true); }) == "f5");
+        REQUIRE(encoded([](CborWriter& c) { c.addText(""); }) == "60");
+        REQUIRE(encoded([](CborWriter& c) { c.addText("IETF"); }) == "6449455446");
+    }
+
+    SECTION("Containers and keyed values") {
+        REQUIRE(encoded([](CborWriter& c) { c.beginArray(0); }) == "80");
+        REQUIRE(encoded([](CborWriter& c) { c.beginMap(0); }) == "a0");
+        REQUIRE(encoded([](CborWriter& c) {
+            c.beginArray(3);
+            c.addUInt(1);
+            c.beginArray(2);
+            c.addUInt(2);
+            c.addUInt(3);
+            c.beginArray(2);
+            c.addUInt(4);
+            c.addUInt(5);
+        }) == "8301820203820405");
+        REQUIRE(encoded([](CborWriter& c) {
+            c.beginMap(2);
+            c.addUInt(1, 2);
+            c.addInt(3, -4);
+        }) == "a201020323");
+    }
+
+    SECTION("Truncated output") {
+        uint8_t buffer[8];
+        memset(buffer, 0xEE, sizeof(buffer));
+        CborWriter cbor(buffer, 4);
+        cbor.addUInt(1000000);
+        REQUIRE(cbor.overflowed());
+        REQUIRE(cbor.length() == 5);
+        REQUIRE(hex(buffer, sizeof(buffer)) == "1a000f42eeeeeeee");
+
+        CborWriter exact(buffer, 5);
+        exact.addUInt(1000000);
+        REQUIRE_FALSE(exact.overflowed());
+        REQUIRE(exact.length() == 5);
+    }
+}
+
+TEST_CASE("MQTT CBOR - GNSS message encoding", "[MqttCbor]") {
+    mqtt_gnss_message_t msg = fixedGnssMessage();
+    uint8_t buffer[256];
+    size_t length = encode_gnss_cbor(&msg, buffer, sizeof(buffer));
+
+    REQUIRE(hex(buffer, length) ==
+            "ac"                    // map with 12 pairs
+            "0001"                  // 0: schema version 1
+            "01182a"                // 1: num 42
+            "026531323a3030"        // 2: daytime "12:00"
+            "03fb404a000000000000"  // 3: lat 52.0
+            "04fb4014000000000000"  // 4: lon 5.0
+            "05fa41280000"          // 5: alt 10.5
+            "0604"                  // 6: fix_type 4
+            "07fa00000000"          // 7: speed 0.0
+            "08fa00000000"          // 8: dir 0.0
+            "090c"                  // 9: sats 12
+            "0afa3f000000"          // 10: hdop 0.5
+            "0bfa3f800000");        // 11: age 1.0
+
+    mqtt_gnss_message_t decoded;
+    REQUIRE(mqttCborDecodeGnss(buffer, length, &decoded));
+    REQUIRE(sameGnss(msg, decoded));
+}
+
+TEST_CASE("MQTT CBOR - Random messages decode to the same fields", "[MqttCbor]") {
+    std::mt19937 rng(32);
+    uint8_t buffer[1024];
+
+    for (int i = 0; i < 10000; i++) {
+        mqtt_gnss_message_t gnss = makeGnssMessage(rng);
+        size_t length = encode_gnss_cbor(&gnss, buffer, sizeof(buffer));
+        mqtt_gnss_message_t decodedGnss;
+        REQUIRE(mqttCborDecodeGnss(buffer, length, &decodedGnss));
+        REQUIRE(sameGnss(gnss, decodedGnss));
+
+        mqtt_status_message_t status = makeStatusMessage(rng);
+        length = encode_status_cbor(&status, buffer, sizeof(buffer));
+        mqtt_status_message_t decodedStatus;
+        REQUIRE(mqttCborDecodeStatus(buffer, length, &decodedStatus));
+        REQUIRE(sameStatus(status, decodedStatus));
+
+        mqtt_stats_message_t stats = makeStatsMessage(rng);
+        length = encode_stats_cbor(&stats, buffer, sizeof(buffer));
+        mqtt_stats_message_t decodedStats;
+        REQUIRE(mqttCborDecodeStats(buffer, length, &decodedStats));
+        REQUIRE(sameStats(stats, decodedStats));
+    }
+}
+
+TEST_CASE("MQTT CBOR - Decoder schema rules and malformed input", "[MqttCbor]") {
+    mqtt_gnss_message_t msg = fixedGnssMessage();
+    uint8_t valid[256];
+    size_t validLength = encode_gnss_cbor(&msg, valid, sizeof(valid));
+    mqtt_gnss_message_t decoded;
+
+    SECTION("Unknown keys are skipped") {
+        // A later schema version with three extra fields of other types
+        uint8_t buffer[256];
+        CborWriter cbor(buffer, sizeof(buffer));
+        cbor.beginMap(MQTT_CBOR_GNSS_KEY_COUNT + 3);
+        cbor.addUInt(MQTT_CBOR_GNSS_VERSION, 2);
+        cbor.addUInt(100);
+        cbor.beginMap(1);
+        cbor.addText("nested");
+        cbor.beginArray(2);
+        cbor.addInt(-5);
+        cbor.addDouble(1.5);
+        cbor.addText(101, "text");
+        cbor.addInt(102, -1000000);
+        // Fields of the current schema, taken from the valid message without its map head and version
+        memcpy(buffer + cbor.length(), valid + 3, validLength - 3);
+        size_t length = cbor.length() + validLength - 3;
+
+        REQUIRE(mqttCborDecodeGnss(buffer, length, &decoded));
+        REQUIRE(sameGnss(msg, decoded));
+    }
+
+    SECTION("Missing keys stay zero") {
+        uint8_t buffer[64];
+        CborWriter cbor(buffer, sizeof(buffer));
+        cbor.beginMap(2);
+        cbor.addUInt(MQTT_CBOR_GNSS_VERSION, 1);
+        cbor.addUInt(MQTT_CBOR_GNSS_SATS, 7);
+        REQUIRE(mqttCborDecodeGnss(buffer, cbor.length(), &decoded));
+        REQUIRE(decoded.sats == 7);
+        REQUIRE(decoded.num == 0);
+        REQUIRE(decoded.lat == 0.0);
+        REQUIRE(decoded.daytime[0] == '\0');
+    }
+
+    SECTION("Half precision floats and integers are accepted for float fields") {
+        const uint8_t buffer[] = {0xA2, 0x0A, 0xF9, 0x3C, 0x00, 0x05, 0x38, 0x63};
+        REQUIRE(mqttCborDecodeGnss(buffer, sizeof(buffer), &decoded));
+        REQUIRE(decoded.hdop == 1.0f);
+        REQUIRE(decoded.alt == -100.0f);
+    }
+
+    SECTION("Every truncated message is rejected") {
+        for (size_t length = 0; length < validLength; length++) {
+            REQUIRE_FALSE(mqttCborDecodeGnss(valid, length, &decoded));
+        }
+        REQUIRE(mqttCborDecodeGnss(valid, validLength, &decoded));
+    }
+
+    SECTION("Trailing bytes are rejected") {
+        uint8_t buffer[256];
+        memcpy(buffer, valid, validLength);
+        buffer[validLength] = 0x00;
+        REQUIRE_FALSE(mqttCborDecodeGnss(buffer, validLength + 1, &decoded));
+    }
+
+    SECTION("Values of the wrong type or range are rejected") {
+        const uint8_t textForNumber[] = {0xA1, 0x01, 0x61, 0x41};
+        const uint8_t floatForNumber[] = {0xA1, 0x01, 0xFA, 0x3F, 0x80, 0x00, 0x00};
+        const uint8_t negativeForNumber[] = {0xA1, 0x01, 0x20};
+        const uint8_t tooLargeForByte[] = {0xA1, 0x09, 0x19, 0x01, 0x00};
+        const uint8_t textKey[] = {0xA1, 0x61, 0x41, 0x00};
+        const uint8_t arrayForMessage[] = {0x81, 0x00};
+        const uint8_t indefiniteMap[] = {0xBF, 0xFF};
+        REQUIRE_FALSE(mqttCborDecodeGnss(textForNumber, sizeof(textForNumber), &decoded));
+        REQUIRE_FALSE(mqttCborDecodeGnss(floatForNumber, sizeof(floatForNumber), &decoded));
+        REQUIRE_FALSE(mqttCborDecodeGnss(negativeForNumber, sizeof(negativeForNumber), &decoded));
+        REQUIRE_FALSE(mqttCborDecodeGnss(tooLargeForByte, sizeof(tooLargeForByte), &decoded));
+        REQUIRE_FALSE(mqttCborDecodeGnss(textKey, sizeof(textKey), &decoded));
+        REQUIRE_FALSE(mqttCborDecodeGnss(arrayForMessage, sizeof(arrayForMessage), &decoded));
+        REQUIRE_FALSE(mqttCborDecodeGnss(indefiniteMap, sizeof(indefiniteMap), &decoded));
+    }
+
+    SECTION("Arrays of the wrong length are rejected") {
+        mqtt_stats_message_t stats;
+        const uint8_t shortArray[] = {0xA1, MQTT_CBOR_STATS_MSM_SATELLITES, 0x83, 0x01, 0x02, 0x03};
+        REQUIRE_FALSE(mqttCborDecodeStats(shortArray, sizeof(shortArray), &stats));
+        const uint8_t fullArray[] = {0xA1, MQTT_CBOR_STATS_MSM_SATELLITES, 0x84, 0x01, 0x02, 0x03, 0x04};
+        REQUIRE(mqttCborDecodeStats(fullArray, sizeof(fullArray), &stats));
+        REQUIRE(stats.msm_satellites[3] == 4);
+    }
+
+    SECTION("Histograms with an odd item count or too many bins are rejected") {
+        mqtt_stats_message_t stats;
+        uint8_t buffer[256];
+        const size_t itemCounts[] = {4, 3, 1, 2 + 2 * (STATS_HISTOGRAM_MAX_BINS + 1)};
+        for (size_t items : itemCounts) {
+            CborWriter cbor(buffer, sizeof(buffer));
+            cbor.beginMap(1);
+            cbor.addUInt(MQTT_CBOR_STATS_HISTOGRAMS);
+            cbor.beginArray(STATS_METRIC_COUNT);
+            for (int m = 0; m < STATS_METRIC_COUNT; m++) {
+                // Metric 1 gets the item count under test, the others one bin
+                size_t count = (m == 1) ? items : 4;
+                cbor.beginArray(count);
+                for (size_t i = 0; i < count; i++) {
+                    cbor.addUInt(i == 0 ? 7 : (i == 1 ? 0 : 3 + i));
+                }
+            }
+            INFO("items=" << items);
+            bool decoded = mqttCborDecodeStats(buffer, cbor.length(), &stats);
+            REQUIRE(decoded == (items == 4));
+            if (decoded) {
+                REQUIRE(stats.histograms[1].count == 7);
+                REQUIRE(stats.histograms[1].bins == 1);
+                REQUIRE(stats.histograms[1].gaps[0] == 5);
+                REQUIRE(stats.histograms[1].counts[0] == 6);
+            }
+        }
+    }
+
+    SECTION("A position array of the wrong length is rejected") {
+        mqtt_stats_message_t stats;
+        uint8_t buffer[128];
+        const size_t itemCounts[] = {9, 10, 11};
+        for (size_t items : itemCounts) {
+            CborWriter cbor(buffer, sizeof(buffer));
+            cbor.beginMap(1);
+            cbor.addUInt(MQTT_CBOR_STATS_POSITION);
+            cbor.beginArray(items);
+            cbor.addUInt(60);
+            cbor.addDouble(52.5);
+            cbor.addDouble(5.25);
+            for (size_t i = 3; i < items; i++) {
+                cbor.addFloat(0.25f * i);
+            }
+            INFO("items=" << items);
+            bool decoded = mqttCborDecodeStats(buffer, cbor.length(), &stats);
+            REQUIRE(decoded == (items == 10));
+            if (decoded) {
+                REQUIRE(stats.position.samples == 60);
+                REQUIRE(stats.position.mean_latitude == 52.5);
+                REQUIRE(stats.position.mean_longitude == 5.25);
+                REQUIRE(stats.position.drms2_m == 2.25f);
+            }
+        }
+    }
+
+    SECTION("Long strings are truncated to the field") {
+        uint8_t buffer[128];
+        CborWriter cbor(buffer, sizeof(buffer));
+        cbor.beginMap(1);
+        cbor.addText(MQTT_CBOR_GNSS_DAYTIME, "0123456789012345678901234567890123456789");
+        REQUIRE(mqttCborDecodeGnss(buffer, cbor.length(), &decoded));
+        REQUIRE(strlen(decoded.daytime) == sizeof(decoded.daytime) - 1);
+    }
+}
+
+// A moving rover at 10 Hz, crossing the antimeridian when lon starts near 180
+static GnssBatch makeBatch(std::mt19937& rng, uint8_t count, double lon) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    GnssBatch batch;
+    batch.configure(count, 60000);
+    double lat = unit(rng) * 160.0 - 80.0;
+    float alt = (float)(unit(rng) * 1000.0);
+    uint32_t time = 86399000u - (rng() % 3) * 1000u;    // Sometimes across midnight
+    for (uint8_t i = 0; i < count; i++) {
+        lat += (unit(rng) - 0.5) * 1e-4;
+        lon += (unit(rng) - 0.3) * 1e-4;
+        if (lon >= 180.0) {
+            lon -= 360.0;
+        }
+        alt += (float)(unit(rng) - 0.5);
+        GnssEpoch epoch = GnssBatch::quantize(time, lat, lon, alt, (float)(unit(rng) * 100.0),
+                                              (float)(unit(rng) * 360.0), (float)(unit(rng) * 3.0),
+                                              (float)(unit(rng) * 5.0), rng() % 6, rng() % 40);
+        batch.add(epoch, i * 100, 100);
+        time = (time + 100) % 86400000u;
+    }
+    return batch;
+}
+
+TEST_CASE("MQTT CBOR - Batched GNSS message", "[MqttCbor]") {
+    std::mt19937 rng(34);
+    uint8_t buffer[2048];
+    mqtt_gnss_batch_t decoded;
+
+    SECTION("Random batches decode to the same epochs") {
+        for (int n = 0; n < 2000; n++) {
+            uint8_t count = 1 + rng() % GnssBatch::MAX_EPOCHS;
+            GnssBatch batch = makeBatch(rng, count, (n % 4 == 0) ? 179.9999 : -10.0);
+            size_t length = encode_gnss_batch_cbor(&batch, n, "2026-10-17 23:59:59.000", buffer, sizeof(buffer));
+            REQUIRE(mqttCborDecodeGnssBatch(buffer, length, &decoded));
+            REQUIRE(decoded.num == (uint32_t)n);
+            REQUIRE(decoded.count == count);
+            REQUIRE(std::string(decoded.daytime) == "2026-10-17 23:59:59.000");
+            for (uint8_t i = 0; i < count; i++) {
+                const GnssEpoch& e = batch.epoch(i);
+                REQUIRE(decoded.epochs[i].t_ms == batch.timeOffsetMs(i));
+                REQUIRE(decoded.epochs[i].lat_e7 == e.latE7);
+                REQUIRE(decoded.epochs[i].lon_e7 == e.lonE7);
+                REQUIRE(decoded.epochs[i].alt_mm == e.altMm);
+                REQUIRE(decoded.epochs[i].fix_type == e.fixType);
+                REQUIRE(decoded.epochs[i].sats == e.sats);
+                REQUIRE(decoded.epochs[i].speed_x100 == e.speedX100);
+                REQUIRE(decoded.epochs[i].dir_x10 == e.dirX10);
+                REQUIRE(decoded.epochs[i].hdop_x100 == e.hdopX100);
+                REQUIRE(decoded.epochs[i].age_x100 == e.ageX100);
+            }
+        }
+    }
+
+    SECTION("Malformed batches are rejected") {
+        GnssBatch batch = makeBatch(rng, 10, 5.0);
+        size_t length = encode_gnss_batch_cbor(&batch, 1, "", buffer, sizeof(buffer));
+        for (size_t cut = 0; cut < length; cut++) {
+            REQUIRE_FALSE(mqttCborDecodeGnssBatch(buffer, cut, &decoded));
+        }
+
+        // Array before the count, array of the wrong length, too many epochs
+        const uint8_t arrayFirst[] = {0xA2, MQTT_CBOR_BATCH_T_MS, 0x81, 0x00, MQTT_CBOR_BATCH_COUNT, 0x01};
+        const uint8_t wrongLength[] = {0xA2, MQTT_CBOR_BATCH_COUNT, 0x02, MQTT_CBOR_BATCH_T_MS, 0x81, 0x00};
+        const uint8_t tooMany[] = {0xA1, MQTT_CBOR_BATCH_COUNT, 0x18, 0x21};
+        REQUIRE_FALSE(mqttCborDecodeGnssBatch(arrayFirst, sizeof(arrayFirst), &decoded));
+        REQUIRE_FALSE(mqttCborDecodeGnssBatch(wrongLength, sizeof(wrongLength), &decoded));
+        REQUIRE_FALSE(mqttCborDecodeGnssBatch(tooMany, sizeof(tooMany), &decoded));
+
+        // Deltas that leave the int32 range
+        const uint8_t overflow[] = {0xA3, MQTT_CBOR_BATCH_COUNT, 0x02, MQTT_CBOR_BATCH_LAT_E7, 0x1A, 0x7F, 0xFF, 0xFF, 0xFF,
+                                    MQTT_CBOR_BATCH_DLAT_E7, 0x82, 0x00, 0x01};
+        REQUIRE_FALSE(mqttCborDecodeGnssBatch(overflow, sizeof(overflow), &decoded));
+    }
+}
+
+TEST_CASE("GnssBatch - Collecting epochs", "[GnssBatch]") {
+    GnssBatch batch;
+
+    SECTION("Quantization rounds to the single message resolution and clamps") {
+        GnssEpoch e = GnssBatch::quantize(90000000u, 52.12345675, -4.99999995, 12.3456f, 3.456f, 359.96f, 0.87f, 1.5f, 4, 21);
+        REQUIRE(e.timeOfDayMs == 3600000u);
+        REQUIRE(e.latE7 == 521234568);
+        REQUIRE(e.lonE7 == -50000000);
+        REQUIRE(e.altMm == 12346);
+        REQUIRE(e.speedX100 == 346);
+        REQUIRE(e.dirX10 == 3600);
+        REQUIRE(e.hdopX100 == 87);
+        REQUIRE(e.ageX100 == 150);
+        REQUIRE(e.fixType == 4);
+        REQUIRE(e.sats == 21);
+
+        e = GnssBatch::quantize(0, 95.0, -200.0, -1e12f, -1.0f, NAN, 1e9f, 99.0f, 0, 0);
+        REQUIRE(e.latE7 == 900000000);
+        REQUIRE(e.lonE7 == -1800000000);
+        REQUIRE(e.altMm == -2147483647);
+        REQUIRE(e.speedX100 == 0);
+        REQUIRE(e.dirX10 == 0);
+        REQUIRE(e.hdopX100 == 65535);
+    }
+
+    SECTION("Repeated epochs are skipped, also after clear()") {
+        GnssEpoch e = GnssBatch::quantize(1000, 0.0, 0.0, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1, 5);
+        REQUIRE(batch.add(e, 0, 100));
+        REQUIRE_FALSE(batch.add(e, 100, 100));
+        batch.clear();
+        REQUIRE(batch.isRepeat(1000));
+        REQUIRE_FALSE(batch.add(e, 200, 100));
+        batch.reset();
+        REQUIRE(batch.add(e, 300, 100));
+        REQUIRE(batch.singleMessageBytes() == 100);
+    }
+
+    SECTION("Count and latency triggers") {
+        batch.configure(3, 1000);
+        REQUIRE_FALSE(batch.isDue(0));
+        for (uint32_t t = 0; t < 3; t++) {
+            REQUIRE_FALSE(batch.isDue(t * 100));
+            GnssEpoch e = GnssBatch::quantize(t * 100, 0.0, 0.0, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1, 5);
+            REQUIRE(batch.add(e, t * 100, 50));
+        }
+        REQUIRE(batch.isDue(200));
+        GnssEpoch extra = GnssBatch::quantize(300, 0.0, 0.0, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1, 5);
+        REQUIRE_FALSE(batch.add(extra, 300, 50));
+        REQUIRE(batch.singleMessageBytes() == 150);
+
+        // Latency across a wrap of the millisecond timer
+        batch.clear();
+        batch.configure(32, 1000);
+        REQUIRE(batch.add(extra, 0xFFFFFF00u, 50));
+        REQUIRE_FALSE(batch.isDue(0xFFFFFFFFu));
+        REQUIRE_FALSE(batch.isDue(0x000002E7u));
+        REQUIRE(batch.isDue(0x000002E8u));
+    }
+
+    SECTION("Time offsets and deltas across midnight and the antimeridian") {
+        const double lon[] = {179.9999999, -179.9999999, -179.9999990};
+        for (int i = 0; i < 3; i++) {
+            GnssEpoch e = GnssBatch::quantize(86399900u + i * 50u, 10.0 + i * 1e-7, lon[i], 5.0f - i, 0.0f, 0.0f, 0.0f, 0.0f, 4, 12);
+            REQUIRE(batch.add(e, i, 0));
+        }
+        REQUIRE(batch.timeOffsetMs(0) == 0);
+        REQUIRE(batch.timeOffsetMs(1) == 50);
+        REQUIRE(batch.timeOffsetMs(2) == 100);
+        REQUIRE(batch.latDelta(0) == 0);
+        REQUIRE(batch.latDelta(2) == 1);
+        REQUIRE(batch.lonDelta(1) == -3599999998LL);
+        REQUIRE(batch.lonDelta(2) == 9);
+        REQUIRE(batch.altDelta(1) == -1000);
+    }
+}
+
+// Batch of positions 100 ms apart
+static GnssBatch makeTrack(const double* lat, const double* lon, uint8_t count) {
+    GnssBatch batch;
+    batch.configure(count, 60000);
+    for (uint8_t i = 0; i < count; i++) {
+        GnssEpoch e = GnssBatch::quantize(i * 100u, lat[i], lon[i], 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 4, 12);
+        batch.add(e, i * 100u, 100);
+    }
+    return batch;
+}
+
+// Local coordinates in mm, the same approximation as GnssBatch::simplify() in double
+static void localMm(const GnssEpoch& origin, const GnssEpoch& e, double* x, double* y) {
+    double dLon = (double)e.lonE7 - origin.lonE7;
+    if (dLon > 1.8e9) {
+        dLon -= 3.6e9;
+    } else if (dLon < -1.8e9) {
+        dLon += 3.6e9;
+    }
+    *x = dLon * 11.119493 * cos(origin.latE7 * 1e-7 * M_PI / 180.0);
+    *y = ((double)e.latE7 - origin.latE7) * 11.119493;
+}
+
+static double segmentDistanceMm(const GnssEpoch& origin, const GnssEpoch& a, const GnssEpoch& b, const GnssEpoch& p) {
+    double ax, ay, bx, by, px, py;
+    localMm(origin, a, &ax, &ay);
+    localMm(origin, b, &bx, &by);
+    localMm(origin, p, &px, &py);
+    double sx = bx - ax, sy = by - ay;
+    double lengthSquared = sx * sx + sy * sy;
+    double t = lengthSquared > 0.0 ? ((px - ax) * sx + (py - ay) * sy) / lengthSquared : 0.0;
+    t = t < 0.0 ? 0.0 : (t > 1.0 ? 1.0 : t);
+    return hypot(px - ax - t * sx, py - ay - t * sy);
+}
+
+TEST_CASE("GnssBatch - Track simplification", "[GnssBatch]") {
+    SECTION("A straight line keeps only its end points") {
+        double lat[10], lon[10];
+        for (int i = 0; i < 10; i++) {
+            lat[i] = 52.0 + i * 1e-5;
+            lon[i] = 5.0 + i * 2e-5;
+        }
+        GnssBatch batch = makeTrack(lat, lon, 10);
+        REQUIRE(batch.simplify(10) == 8);
+        REQUIRE(batch.count() == 2);
+        REQUIRE(batch.epoch(0).timeOfDayMs == 0);
+        REQUIRE(batch.epoch(1).timeOfDayMs == 900);
+        REQUIRE(batch.timeOffsetMs(1) == 900);
+        REQUIRE(batch.singleMessageBytes() == 1000);
+    }
+
+    SECTION("Tolerance 0 and short batches are left alone") {
+        double lat[3] = {52.0, 52.0001, 52.0002};
+        double lon[3] = {5.0, 5.0, 5.0};
+        GnssBatch batch = makeTrack(lat, lon, 3);
+        REQUIRE(batch.simplify(0) == 0);
+        REQUIRE(batch.count() == 3);
+        GnssBatch pair = makeTrack(lat, lon, 2);
+        REQUIRE(pair.simplify(100000) == 0);
+        REQUIRE(pair.count() == 2);
+    }
+
+    SECTION("A zig-zag beyond the tolerance is kept") {
+        // About 1.1 m to either side of the center line
+        double lat[8], lon[8];
+        for (int i = 0; i < 8; i++) {
+            lat[i] = 52.0 + ((i % 2) ? 1e-5 : -1e-5);
+            lon[i] = 5.0 + i * 1e-4;
+        }
+        GnssBatch batch = makeTrack(lat, lon, 8);
+        REQUIRE(batch.simplify(500) == 0);
+        REQUIRE(batch.count() == 8);
+        GnssBatch coarse = makeTrack(lat, lon, 8);
+        REQUIRE(coarse.simplify(5000) == 6);
+    }
+
+    SECTION("A rover that returns to its start is not collapsed") {
+        double lat[5] = {52.0, 52.0, 52.001, 52.0, 52.0};
+        double lon[5] = {5.0, 5.0005, 5.0005, 5.0005, 5.0};
+        GnssBatch batch = makeTrack(lat, lon, 5);
+        batch.simplify(1000);
+        REQUIRE(batch.count() >= 3);
+        REQUIRE(batch.epoch(0).latE7 == batch.epoch(batch.count() - 1).latE7);
+        bool farPointKept = false;
+        for (uint8_t i = 0; i < batch.count(); i++) {
+            farPointKept |= (batch.epoch(i).latE7 == 520010000);
+        }
+        REQUIRE(farPointKept);
+    }
+
+    SECTION("A straight line across the antimeridian") {
+        double lat[6], lon[6];
+        for (int i = 0; i < 6; i++) {
+            lat[i] = -17.0;
+            lon[i] = 179.99995 + i * 2e-5;
+            if (lon[i] >= 180.0) {
+                lon[i] -= 360.0;
+            }
+        }
+        GnssBatch batch = makeTrack(lat, lon, 6);
+        REQUIRE(batch.simplify(10) == 4);
+        REQUIRE(batch.count() == 2);
+    }
+
+    SECTION("Removed epochs stay within the tolerance of the kept track") {
+        std::mt19937 rng(35);
+        for (int n = 0; n < 2000; n++) {
+            uint8_t count = 1 + rng() % GnssBatch::MAX_EPOCHS;
+            uint32_t toleranceMm = 1 + rng() % 5000;
+            GnssBatch original = makeBatch(rng, count, (n % 4 == 0) ? 179.9999 : -10.0);
+            GnssBatch simplified = original;
+            uint8_t removed = simplified.simplify(toleranceMm);
+            REQUIRE(simplified.count() + removed == count);
+            REQUIRE(simplified.singleMessageBytes() == original.singleMessageBytes());
+
+            // Each original epoch lies within the tolerance of the segment around it
+            uint8_t k = 0;
+            for (uint8_t i = 0; i < count; i++) {
+                const GnssEpoch& e = original.epoch(i);
+                if (k < simplified.count() && simplified.epoch(k).timeOfDayMs == e.timeOfDayMs) {
+                    REQUIRE(simplified.epoch(k).latE7 == e.latE7);
+                    k++;
+                    continue;
+                }
+                REQUIRE(k > 0);
+                REQUIRE(k < simplified.count());
+                double distance = segmentDistanceMm(original.epoch(0), simplified.epoch(k - 1), simplified.epoch(k), e);
+                REQUIRE(distance <= toleranceMm + 1.0);
+            }
+            REQUIRE(k == simplified.count());
+        }
+    }
+}
+
+TEST_CASE("MQTT JSON - Batched GNSS message", "[MqttCbor]") {
+    GnssBatch batch;
+    batch.add(GnssBatch::quantize(43200000u, 52.0, 5.0, 10.0f, 1.5f, 90.0f, 0.8f, 1.0f, 4, 20), 0, 0);
+    batch.add(GnssBatch::quantize(43200100u, 52.0000001, 4.9999998, 10.012f, 1.52f, 90.1f, 0.8f, 1.1f, 4, 20), 100, 0);
+    char json[512];
+    size_t length = writer_gnss_batch_json(&batch, 7, "2026-10-17 12:00:00.000", json, sizeof(json));
+    REQUIRE(std::string(json, length) ==
+        "{\n"
+        "   \"num\": 7,\n"
+        "   \"daytime\": \"2026-10-17 12:00:00.000\",\n"
+        "   \"count\": 2,\n"
+        "   \"lat\": 52.0000000,\n"
+        "   \"lon\": 5.0000000,\n"
+        "   \"alt\": 10.000,\n"
+        "   \"t_ms\": [0,100],\n"
+        "   \"dlat_e7\": [0,1],\n"
+        "   \"dlon_e7\": [0,-2],\n"
+        "   \"dalt_mm\": [0,12],\n"
+        "   \"fix_type\": [4,4],\n"
+        "   \"sats\": [20,20],\n"
+        "   \"speed_x100\": [150,152],\n"
+        "   \"dir_x10\": [900,901],\n"
+        "   \"hdop_x100\": [80,80],\n"
+        "   \"age_x100\": [100,110]\n"
+        "}");
+}
+
+// Packet bytes of `count` single GNSS messages and of the same epochs as one batch
+struct BatchSizes {
+    size_t singleJson, batchJson, singleCbor, batchCbor;
+};
+
+static BatchSizes batchSizes(std::mt19937& rng, uint8_t count) {
+    const size_t topic = strlen("rover/GNSS");
+    GnssBatch batch = makeBatch(rng, count, 5.0);
+    BatchSizes sizes = {0, 0, 0, 0};
+    char json[4096];
+    uint8_t cbor[2048];
+    for (uint8_t i = 0; i < count; i++) {
+        const GnssEpoch& e = batch.epoch(i);
+        mqtt_gnss_message_t msg = {};
+        msg.num = 1000 + i;
+        snprintf(msg.daytime, sizeof(msg.daytime), "2026-10-17 %02u:%02u:%02u.%03u",
+                 (unsigned)(e.timeOfDayMs / 3600000), (unsigned)(e.timeOfDayMs / 60000 % 60),
+                 (unsigned)(e.timeOfDayMs / 1000 % 60), (unsigned)(e.timeOfDayMs % 1000));
+        msg.lat = e.latE7 / 1e7;
+        msg.lon = e.lonE7 / 1e7;
+        msg.alt = e.altMm / 1e3f;
+        msg.fix_type = e.fixType;
+        msg.speed = e.speedX100 / 100.0f;
+        msg.dir = e.dirX10 / 10.0f;
+        msg.sats = e.sats;
+        msg.hdop = e.hdopX100 / 100.0f;
+        msg.age = e.ageX100 / 100.0f;
+        sizes.singleJson += mqtt_publish_packet_size(topic, writer_gnss_json(&msg, json, sizeof(json)));
+        sizes.singleCbor += mqtt_publish_packet_size(topic, encode_gnss_cbor(&msg, cbor, sizeof(cbor)));
+    }
+    const char* daytime = "2026-10-17 23:59:59.000";
+    sizes.batchJson = mqtt_publish_packet_size(topic + 6, writer_gnss_batch_json(&batch, 1000, daytime, json, sizeof(json)));
+    sizes.batchCbor = mqtt_publish_packet_size(topic + 6, encode_gnss_batch_cbor(&batch, 1000, daytime, cbor, sizeof(cbor)));
+    return sizes;
+}
+
+TEST_CASE("MQTT batch - Fewer bytes than single messages", "[MqttCbor]") {
+    std::mt19937 rng(35);
+    REQUIRE(mqtt_publish_packet_size(10, 100) == 114);
+    REQUIRE(mqtt_publish_packet_size(10, 116) == 131);
+
+    for (int i = 0; i < 200; i++) {
+        BatchSizes sizes = batchSizes(rng, 10);
+        REQUIRE(sizes.batchJson * 3 < sizes.singleJson);
+        REQUIRE(sizes.batchCbor * 3 < sizes.singleCbor);
+        REQUIRE(sizes.batchCbor < sizes.batchJson);
+    }
+}
+
+TEST_CASE("MQTT CBOR - Smaller than JSON", "[MqttCbor]") {
+    std::mt19937 rng(33);
+    char json[2048];
+    uint8_t cbor[1024];
+
+    for (int i = 0; i < 1000; i++) {
+        mqtt_gnss_message_t gnss = makeGnssMessage(rng);
+        size_t jsonLength = writer_gnss_json(&gnss, json, sizeof(json));
+        size_t cborLength = encode_gnss_cbor(&gnss, cbor, sizeof(cbor));
+        REQUIRE(cborLength < 100);
+        REQUIRE(cborLength * 2 < jsonLength);
+
+        mqtt_status_message_t status = makeStatusMessage(rng);
+        REQUIRE(encode_status_cbor(&status, cbor, sizeof(cbor)) * 2 < writer_status_json(&status, json, sizeof(json)));
+
+        mqtt_stats_message_t stats = makeStatsMessage(rng);
+        REQUIRE(encode_stats_cbor(&stats, cbor, sizeof(cbor)) * 2 < writer_stats_json(&stats, json, sizeof(json)));
+    }
+}
+
+// Benchmark
+
+template <typename Message>
+static void benchmarkMessage(const char* name, const std::vector<Message>& messages,
+                             size_t (*json)(const Message*, char*, size_t),
+                             size_t (*cbor)(const Message*, uint8_t*, size_t),
+                             bool (*decode)(const uint8_t*, size_t, Message*)) {
+    const int rounds = 20;
+    char text[2048];
+    uint8_t binary[1024];
+    size_t bytes[2] = {0, 0};
+    double rate[3];
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < messages.size(); i++) {
+            bytes[0] += json(&messages[i], text, sizeof(text));
+        }
+    }
+    rate[0] = rounds * messages.size() /
+              std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < messages.size(); i++) {
+            bytes[1] += cbor(&messages[i], binary, sizeof(binary));
+        }
+    }
+    rate[1] = rounds * messages.size() /
+              std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t decoded = 0;
+    size_t length = cbor(&messages[0], binary, sizeof(binary));
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds * (int)messages.size(); r++) {
+        Message message;
+        decoded += decode(binary, length, &message) ? 1 : 0;
+    }
+    rate[2] = rounds * messages.size() /
+              std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    REQUIRE(decoded == rounds * messages.size());
+
+    double count = (double)rounds * messages.size();
+    printf("%-8s %8.0f %8.0f %14.0f %14.0f %14.0f\n", name, bytes[0] / count, bytes[1] / count,
+           rate[0], rate[1], rate[2]);
+}
+
+TEST_CASE("MQTT batch benchmark - bytes per epoch", "[.benchmark]") {
+    std::mt19937 rng(36);
+    const uint8_t counts[] = {1, 5, 10, 32};
+    std::cout << "\nPacket bytes per epoch at 10 Hz (single messages -> batch)\n";
+    for (uint8_t count : counts) {
+        BatchSizes total = {0, 0, 0, 0};
+        for (int i = 0; i < 100; i++) {
+            BatchSizes sizes = batchSizes(rng, count);
+            total.singleJson += sizes.singleJson;
+            total.batchJson += sizes.batchJson;
+            total.singleCbor += sizes.singleCbor;
+            total.batchCbor += sizes.batchCbor;
+        }
+        double epochs = 100.0 * count;
+        std::cout << "  " << (int)count << " epochs: JSON " << total.singleJson / epochs << " -> " << total.batchJson / epochs
+                  << ", CBOR " << total.singleCbor / epochs << " -> " << total.batchCbor / epochs << "\n";
+    }
+}
+
+TEST_CASE("MQTT encoding benchmark - size and encode time", "[.benchmark]") {
+    std::mt19937 rng(7);
+    std::vector<mqtt_gnss_message_t> gnss;
+    std::vector<mqtt_status_message_t> status;
+    std::vector<mqtt_stats_message_t> stats;
+    for (int i = 0; i < 5000; i++) {
+        gnss.push_back(makeGnssMessage(rng));
+        status.push_back(makeStatusMessage(rng));
+        stats.push_back(makeStatsMessage(rng));
+    }
+
+    printf("\n%-8s %8s %8s %14s %14s %14s\n", "message", "JSON B", "CBOR B",
+           "JSON msg/s", "CBOR msg/s", "decode msg/s");
+    benchmarkMessage("GNSS", gnss, writer_gnss_json, encode_gnss_cbor, mqttCborDecodeGnss);
+    benchmarkMessage("status", status, writer_status_json, encode_status_cbor, mqttCborDecodeStatus);
+    benchmarkMessage("stats", stats, writer_stats_json, encode_stats_cbor, mqttCborDecodeStats);
+}
@@ -0,0 +1,256 @@
+// Standalone build for PublishQueue tests using Code::Blocks
+// This file contains a copy of the PublishQueue implementation for standalone compilation
+
+#include <cstdint>
+#include <stddef.h>
+#include <string.h>
+
+#include "PublishQueue_standalone.h"
+
+struct RecordHeader {
+    uint16_t length;        // Payload length
+    uint8_t topicSize;      // Topic length including the NUL
+    uint8_t reserved;
+};
+
+static const uint32_t RECORD_HEADER_SIZE = sizeof(RecordHeader);
+
+static const uint32_t LATENCY_BOUNDS_MS[PUBLISH_LATENCY_BUCKETS] = {
+    5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 0
+};
+
+// Space taken by a record, 4 byte aligned
+static uint32_t recordSize(size_t topicSize, size_t length) {
+    return RECORD_HEADER_SIZE + (((uint32_t)(topicSize + length) + 3) & ~3u);
+}
+
+PublishQueue::PublishQueue() {
+    begin(NULL, 0, 1);
+}
+
+void PublishQueue::begin(uint8_t* memory, size_t size, uint8_t windowSize) {
+    buffer = memory;
+    capacity = (memory != NULL) ? (uint32_t)(size & ~(size_t)3) : 0;
+    head = 0;
+    tail = 0;
+    end = capacity;
+    wrapped = false;
+    queued = 0;
+    used = 0;
+    usedPeak = 0;
+
+    inFlight = 0;
+    inFlightPeak = 0;
+    setWindow(windowSize);
+
+    sentCount = 0;
+    ackedCount = 0;
+    dropped = 0;
+    rejected = 0;
+    lost = 0;
+
+    memset(latencyCounts, 0, sizeof(latencyCounts));
+    latencyMinUs = 0;
+    latencyMaxUs = 0;
+    latencyLastUs = 0;
+    latencySumUs = 0;
+}
+
+void PublishQueue::setWindow(uint8_t windowSize) {
+    if (windowSize < 1) windowSize = 1;
+    if (windowSize > PUBLISH_WINDOW_MAX) windowSize = PUBLISH_WINDOW_MAX;
+    window = windowSize;
+}
+
+// Offset where a record of this size can be written, -1 if it does not fit.
+// Records are never split: a record that does not fit before the end of the
+// buffer goes to the start, the end is skipped.
+int32_t PublishQueue::reserve(uint32_t size) const {
+    if (queued == 0) {
+        return (size <= capacity) ? 0 : -1;
+    }
+    if (!wrapped) {
+        if (head + size <= capacity) {
+            return (int32_t)head;
+        }
+        return (size <= tail) ? 0 : -1;
+    }
+    return (head + size <= tail) ? (int32_t)head : -1;
+}
+
+bool PublishQueue::fits(size_t topicLength, size_t length) const {
+    if (topicLength + 1 > 0xFF || length > 0xFFFF) {
+        return false;
+    }
+    return reserve(recordSize(topicLength + 1, length)) >= 0;
+}
+
+bool PublishQueue::push(const char* topic, const uint8_t* data, size_t length) {
+    size_t topicSize = strlen(topic) + 1;
+    uint32_t size = recordSize(topicSize, length);
+    if (topicSize > 0xFF || length > 0xFFFF || size > capacity) {
+        rejected++;
+        return false;
+    }
+
+    // Drop-oldest: make room by removing queued messages
+    int32_t offset;
+    while ((offset = reserve(size)) < 0) {
+        popFront();
+        dropped++;
+    }
+    if (queued == 0) {
+        tail = 0;
+        end = capacity;
+        wrapped = false;
+    } else if (!wrapped && (uint32_t)offset < head) {
+        end = head;
+        wrapped = true;
+    }
+
+    RecordHeader header;
+    header.length = (uint16_t)length;
+    header.topicSize = (uint8_t)topicSize;
+    header.reserved = 0;
+    memcpy(buffer + offset, &header, RECORD_HEADER_SIZE);
+    memcpy(buffer + offset + RECORD_HEADER_SIZE, topic, topicSize);
+    if (length > 0) {
+        memcpy(buffer + offset + RECORD_HEADER_SIZE + topicSize, data, length);
+    }
+
+    head = offset + size;
+    queued++;
+    used += size;
+    if (used > usedPeak) {
+        usedPeak = used;
+    }
+    return true;
+}
+
+bool PublishQueue::front(const char** topic, const uint8_t** data, size_t* length) const {
+    if (queued == 0) {
+        return false;
+    }
+    RecordHeader header;
+    memcpy(&header, buffer + tail, RECORD_HEADER_SIZE);
+    *topic = (const char*)(buffer + tail + RECORD_HEADER_SIZE);
+    *data = buffer + tail + RECORD_HEADER_SIZE + header.topicSize;
+    *length = header.length;
+    return true;
+}
+
+void PublishQueue::popFront() {
+    RecordHeader header;
+    memcpy(&header, buffer + tail, RECORD_HEADER_SIZE);
+    uint32_t size = recordSize(header.topicSize, header.length);
+    tail += size;
+    used -= size;
+    queued--;
+
+    if (queued == 0) {
+        head = 0;
+        tail = 0;
+        end = capacity;
+        wrapped = false;
+    } else if (wrapped && tail >= end) {
+        tail = 0;
+        end = capacity;
+        wrapped = false;
+    }
+}
+
+void PublishQueue::sent(int msgId, int64_t nowUs) {
+    if (queued == 0) {
+        return;
+    }
+    popFront();
+    sentCount++;
+
+    // The caller checks canSend(); a full window loses track of its oldest message
+    if (inFlight >= PUBLISH_WINDOW_MAX) {
+        removeInFlight(0);
+        lost++;
+    }
+    inFlightMessages[inFlight].msgId = msgId;
+    inFlightMessages[inFlight].sentUs = nowUs;
+    inFlight++;
+    if (inFlight > inFlightPeak) {
+        inFlightPeak = inFlight;
+    }
+}
+
+// Keeps the remaining messages in the order they were sent
+void PublishQueue::removeInFlight(uint8_t index) {
+    for (uint8_t i = index; i + 1 < inFlight; i++) {
+        inFlightMessages[i] = inFlightMessages[i + 1];
+    }
+    inFlight--;
+}
+
+bool PublishQueue::acked(int msgId, int64_t nowUs) {
+    for (uint8_t i = 0; i < inFlight; i++) {
+        if (inFlightMessages[i].msgId != msgId) {
+            continue;
+        }
+        int64_t latency = nowUs - inFlightMessages[i].sentUs;
+        uint32_t latencyUs = (latency < 0) ? 0 : (latency > 0xFFFFFFFF) ? 0xFFFFFFFF : (uint32_t)latency;
+        removeInFlight(i);
+
+        uint8_t bucket = 0;
+        while (LATENCY_BOUNDS_MS[bucket] != 0 && latencyUs > LATENCY_BOUNDS_MS[bucket] * 1000u) {
+            bucket++;
+        }
+        latencyCounts[bucket]++;
+        if (ackedCount == 0 || latencyUs < latencyMinUs) {
+            latencyMinUs = latencyUs;
+        }
+        if (latencyUs > latencyMaxUs) {
+            latencyMaxUs = latencyUs;
+        }
+        latencyLastUs = latencyUs;
+        latencySumUs += latencyUs;
+        ackedCount++;
+        return true;
+    }
+    return false;
+}
+
+bool PublishQueue::released(int msgId) {
+    for (uint8_t i = 0; i < inFlight; i++) {
+        if (inFlightMessages[i].msgId == msgId) {
+            removeInFlight(i);
+            lost++;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t PublishQueue::expire(int64_t nowUs, int64_t timeoutUs) {
+    uint32_t expired = 0;
+    while (inFlight > 0 && nowUs - inFlightMessages[0].sentUs > timeoutUs) {
+        removeInFlight(0);
+        lost++;
+        expired++;
+    }
+    return expired;
+}
+
+uint32_t PublishQueue::releaseAll() {
+    uint32_t released = inFlight;
+    lost += inFlight;
+    inFlight = 0;
+    return released;
+}
+
+uint32_t PublishQueue::latencyBound(uint8_t bucket) {
+    return (bucket < PUBLISH_LATENCY_BUCKETS) ? LATENCY_BOUNDS_MS[bucket] : 0;
+}
+
+uint32_t PublishQueue::getLatencyCount(uint8_t bucket) const {
+    return (bucket < PUBLISH_LATENCY_BUCKETS) ? latencyCounts[bucket] : 0;
+}
+
+uint32_t PublishQueue::getLatencyAvgMs() const {
+    return ackedCount ? (uint32_t)((latencySumUs / ackedCount + 500) / 1000) : 0;
+}
@@ -0,0 +1,397 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch.hpp"
+#include "PublishQueue_standalone.h"
+#include <stdio.h>
+#include <string.h>
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * Mosquitto-style broker stand-in: accepts QoS 1 PUBLISH packets with client
+ * message ids (1 to 65535, as esp-mqtt), delivers them to a subscriber list
+ * and sends the PUBACK after a configurable latency. A stalled broker keeps
+ * its PUBACKs until it recovers, an offline broker refuses publishing and a
+ * lossy broker never acknowledges every n-th message.
+ */
+struct BrokerStandIn {
+    struct Delivery {
+        std::string topic;
+        std::string payload;
+    };
+    struct PendingAck {
+        int msgId;
+        int64_t dueUs;
+    };
+
+    std::vector<Delivery> delivered;
+    std::deque<PendingAck> pendingAcks;
+    int64_t latencyUs;
+    bool online;
+    bool stalled;
+    uint32_t loseEvery;         // 0 = every message gets a PUBACK
+    int nextMsgId;
+    uint32_t received;
+
+    BrokerStandIn()
+        : latencyUs(20000), online(true), stalled(false), loseEvery(0), nextMsgId(1), received(0) {}
+
+    // esp_mqtt_client_publish() with QoS 1: the message id, or -1 when not connected
+    int publish(const char* topic, const uint8_t* data, size_t length, int64_t nowUs) {
+        if (!online) {
+            return -1;
+        }
+        int msgId = nextMsgId;
+        nextMsgId = (nextMsgId == 65535) ? 1 : nextMsgId + 1;
+        received++;
+        Delivery delivery;
+        delivery.topic = topic;
+        delivery.payload.assign((const char*)data, length);
+        delivered.push_back(delivery);
+        if (loseEvery == 0 || received % loseEvery != 0) {
+            PendingAck ack = { msgId, nowUs + latencyUs };
+            pendingAcks.push_back(ack);
+        }
+        return msgId;
+    }
+
+    // MQTT_EVENT_PUBLISHED for every PUBACK due by now
+    void deliverAcks(PublishQueue& queue, int64_t nowUs) {
+        while (!stalled && !pendingAcks.empty() && pendingAcks.front().dueUs <= nowUs) {
+            queue.acked(pendingAcks.front().msgId, pendingAcks.front().dueUs);
+            pendingAcks.pop_front();
+        }
+    }
+};
+
+// One pass of the MQTT task: PUBACKs, expired messages, then fill the window
+static void service(PublishQueue& queue, BrokerStandIn& broker, int64_t nowUs, int64_t timeoutUs = 30000000) {
+    broker.deliverAcks(queue, nowUs);
+    queue.expire(nowUs, timeoutUs);
+    while (queue.canSend()) {
+        const char* topic;
+        const uint8_t* data;
+        size_t length;
+        REQUIRE(queue.front(&topic, &data, &length));
+        int msgId = broker.publish(topic, data, length, nowUs);
+        if (msgId < 0) {
+            break;
+        }
+        queue.sent(msgId, nowUs);
+    }
+}
+
+static std::string makePayload(uint32_t number, size_t length) {
+    char text[16];
+    snprintf(text, sizeof(text), "%08u", (unsigned)number);
+    std::string payload(text);
+    while (payload.size() < length) {
+        payload += (char)('a' + (payload.size() + number) % 26);
+    }
+    payload.resize(length);
+    return payload;
+}
+
+static uint32_t payloadNumber(const std::string& payload) {
+    return (uint32_t)strtoul(payload.substr(0, 8).c_str(), NULL, 10);
+}
+
+static bool pushNumbered(PublishQueue& queue, const char* topic, uint32_t number, size_t length) {
+    std::string payload = makePayload(number, length);
+    return queue.push(topic, (const uint8_t*)payload.data(), payload.size());
+}
+
+TEST_CASE("PublishQueue - Messages are delivered in order with their PUBACK latency", "[qos]") {
+    static uint8_t memory[16384];
+    PublishQueue queue;
+    queue.begin(memory, sizeof(memory), 4);
+    BrokerStandIn broker;
+    broker.latencyUs = 30000;
+
+    // One GNSS message every 10 ms, a status message every 100 ms
+    uint32_t pushed = 0;
+    for (int64_t now = 0; now < 11000000; now += 1000) {
+        if (now % 10000 == 0 && pushed < 1000) {
+            REQUIRE(pushNumbered(queue, (now % 100000 == 0) ? "ntrip/status" : "ntrip/GNSS", pushed++, 90));
+        }
+        service(queue, broker, now);
+        REQUIRE(queue.getInFlight() <= 4);
+    }
+
+    REQUIRE(broker.delivered.size() == 1000);
+    for (uint32_t i = 0; i < broker.delivered.size(); i++) {
+        REQUIRE(payloadNumber(broker.delivered[i].payload) == i);
+        REQUIRE(broker.delivered[i].payload == makePayload(i, 90));
+        REQUIRE(broker.delivered[i].topic == ((i % 10 == 0) ? "ntrip/status" : "ntrip/GNSS"));
+    }
+    REQUIRE(queue.getSent() == 1000);
+    REQUIRE(queue.getAcked() == 1000);
+    REQUIRE(queue.getDropped() == 0);
+    REQUIRE(queue.getLost() == 0);
+    REQUIRE(queue.getQueued() == 0);
+    REQUIRE(queue.getQueuedBytes() == 0);
+    REQUIRE(queue.getInFlight() == 0);
+    REQUIRE(queue.getInFlightPeak() == 3);      // 30 ms latency, a message every 10 ms
+
+    // Every PUBACK after exactly 30 ms: the 50 ms bucket
+    REQUIRE(queue.getLatencyCount(3) == 1000);
+    REQUIRE(PublishQueue::latencyBound(3) == 50);
+    REQUIRE(queue.getLatencyMinMs() == 30);
+    REQUIRE(queue.getLatencyAvgMs() == 30);
+    REQUIRE(queue.getLatencyMaxMs() == 30);
+    REQUIRE(queue.getLatencyLastMs() == 30);
+}
+
+TEST_CASE("PublishQueue - The window bounds the messages in flight", "[qos]") {
+    static uint8_t memory[65536];
+    const uint8_t windows[] = { 1, 2, 4, 8, 16 };
+
+    for (uint8_t window : windows) {
+        SECTION("Window " + std::to_string(window)) {
+            PublishQueue queue;
+            queue.begin(memory, sizeof(memory), window);
+            BrokerStandIn broker;
+            broker.latencyUs = 100000;
+
+            for (uint32_t i = 0; i < 160; i++) {
+                REQUIRE(pushNumbered(queue, "ntrip/GNSS", i, 100));
+            }
+
+            int64_t now = 0;
+            while (queue.getAcked() < 160) {
+                service(queue, broker, now);
+                REQUIRE(queue.getInFlight() <= window);
+                REQUIRE(broker.pendingAcks.size() <= window);
+                now += 1000;
+                REQUIRE(now < 100000000);
+            }
+
+            // One round trip per window of messages
+            int64_t rounds = (160 + window - 1) / window;
+            REQUIRE(now == rounds * 100000 + 1000);
+            REQUIRE(queue.getInFlightPeak() == window);
+            REQUIRE(queue.getLatencyCount(4) == 160);       // 100 ms bucket
+            for (uint32_t i = 0; i < 160; i++) {
+                REQUIRE(payloadNumber(broker.delivered[i].payload) == i);
+            }
+        }
+    }
+}
+
+TEST_CASE("PublishQueue - The memory ceiling drops the oldest messages", "[qos]") {
+    static uint8_t memory[1024];
+    PublishQueue queue;
+    queue.begin(memory, sizeof(memory), 4);
+    BrokerStandIn broker;
+    broker.stalled = true;
+
+    const size_t topicLength = strlen("ntrip/GNSS");
+    uint32_t pushed = 0;
+    uint32_t droppedBefore = 0;
+    for (int64_t now = 0; now < 2000000; now += 10000) {
+        bool fits = queue.fits(topicLength, 60);
+        REQUIRE(pushNumbered(queue, "ntrip/GNSS", pushed++, 60));
+        REQUIRE((queue.getDropped() == droppedBefore) == fits);
+        droppedBefore = queue.getDropped();
+        service(queue, broker, now);
+        REQUIRE(queue.getQueuedBytes() <= sizeof(memory));
+        REQUIRE(queue.getQueuedPeakBytes() <= sizeof(memory));
+    }
+
+    // The window is full of unacknowledged messages, the rest waits
+    REQUIRE(queue.getInFlight() == 4);
+    REQUIRE(queue.getSent() == 4);
+    REQUIRE(queue.getDropped() > 0);
+    REQUIRE(queue.getDropped() + queue.getQueued() + queue.getSent() == pushed);
+    uint32_t queued = queue.getQueued();
+
+    broker.stalled = false;
+    for (int64_t now = 2000000; queue.getAcked() < 4 + queued; now += 1000) {
+        service(queue, broker, now);
+        REQUIRE(now < 10000000);
+    }
+
+    // The first window, then the newest messages without a gap
+    REQUIRE(broker.delivered.size() == 4 + queued);
+    for (uint32_t i = 0; i < 4; i++) {
+        REQUIRE(payloadNumber(broker.delivered[i].payload) == i);
+    }
+    for (uint32_t i = 0; i < queued; i++) {
+        REQUIRE(payloadNumber(broker.delivered[4 + i].payload) == pushed - queued + i);
+    }
+
+    // Larger than the whole queue
+    std::string large(1100, 'x');
+    REQUIRE_FALSE(queue.push("ntrip/GNSS", (const uint8_t*)large.data(), large.size()));
+    REQUIRE(queue.getRejected() == 1);
+    REQUIRE(queue.getQueued() == 0);
+}
+
+TEST_CASE("PublishQueue - Messages without PUBACK do not block the window", "[qos]") {
+    static uint8_t memory[8192];
+    PublishQueue queue;
+    queue.begin(memory, sizeof(memory), 2);
+    BrokerStandIn broker;
+    broker.loseEvery = 5;
+
+    SECTION("Expired after the timeout") {
+        for (uint32_t i = 0; i < 50; i++) {
+            REQUIRE(pushNumbered(queue, "ntrip/GNSS", i, 40));
+        }
+        int64_t now = 0;
+        while (queue.getQueued() > 0 || queue.getInFlight() > 0) {
+            service(queue, broker, now, 200000);
+            now += 1000;
+            REQUIRE(now < 100000000);
+        }
+        REQUIRE(broker.delivered.size() == 50);
+        REQUIRE(queue.getAcked() == 40);
+        REQUIRE(queue.getLost() == 10);
+        REQUIRE(queue.getLatencyMaxMs() == 20);
+    }
+
+    SECTION("Released by the client") {
+        for (uint32_t i = 0; i < 5; i++) {
+            REQUIRE(pushNumbered(queue, "ntrip/GNSS", i, 40));
+        }
+        service(queue, broker, 0);
+        REQUIRE(queue.getInFlight() == 2);
+        REQUIRE(queue.released(1));
+        REQUIRE_FALSE(queue.released(1));
+        REQUIRE_FALSE(queue.acked(1, 1000));
+        REQUIRE(queue.getInFlight() == 1);
+        service(queue, broker, 1000);
+        REQUIRE(queue.getInFlight() == 2);
+        REQUIRE(broker.delivered.size() == 3);
+        REQUIRE(queue.getLost() == 1);
+
+        // Client destroyed: the queued messages wait for the next client
+        REQUIRE(queue.releaseAll() == 2);
+        REQUIRE(queue.getInFlight() == 0);
+        REQUIRE(queue.getQueued() == 2);
+        REQUIRE(queue.getLost() == 3);
+        REQUIRE_FALSE(queue.acked(3, 2000));
+    }
+
+    SECTION("A smaller window waits for the messages in flight") {
+        for (uint32_t i = 0; i < 5; i++) {
+            REQUIRE(pushNumbered(queue, "ntrip/GNSS", i, 40));
+        }
+        service(queue, broker, 0);
+        REQUIRE(queue.getInFlight() == 2);
+        queue.setWindow(1);
+        REQUIRE_FALSE(queue.canSend());
+        queue.setWindow(0);
+        REQUIRE(queue.getWindow() == 1);
+        queue.setWindow(200);
+        REQUIRE(queue.getWindow() == PUBLISH_WINDOW_MAX);
+    }
+}
+
+TEST_CASE("PublishQueue - PUBACK latency histogram", "[qos]") {
+    static uint8_t memory[4096];
+    PublishQueue queue;
+    queue.begin(memory, sizeof(memory), PUBLISH_WINDOW_MAX);
+
+    const uint32_t bounds[PUBLISH_LATENCY_BUCKETS] = { 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 0 };
+    for (uint8_t bucket = 0; bucket < PUBLISH_LATENCY_BUCKETS; bucket++) {
+        REQUIRE(PublishQueue::latencyBound(bucket) == bounds[bucket]);
+    }
+    REQUIRE(PublishQueue::latencyBound(PUBLISH_LATENCY_BUCKETS) == 0);
+    REQUIRE(queue.getLatencyMinMs() == 0);
+    REQUIRE(queue.getLatencyAvgMs() == 0);
+
+    // Latency in us: on a bound, just above, far in the overflow bucket
+    const int64_t latencies[] = { 5000, 5001, 0, 10000, 99999, 5000000, 5000001, 60000000 };
+    const uint8_t expected[] = { 0, 1, 0, 1, 4, 9, 10, 10 };
+    int msgId = 100;
+    for (int64_t latency : latencies) {
+        REQUIRE(queue.push("t", (const uint8_t*)"x", 1));
+        queue.sent(msgId, 1000000);
+        REQUIRE(queue.acked(msgId, 1000000 + latency));
+        msgId++;
+    }
+    uint32_t counts[PUBLISH_LATENCY_BUCKETS] = {};
+    for (uint8_t bucket : expected) {
+        counts[bucket]++;
+    }
+    for (uint8_t bucket = 0; bucket < PUBLISH_LATENCY_BUCKETS; bucket++) {
+        REQUIRE(queue.getLatencyCount(bucket) == counts[bucket]);
+    }
+    REQUIRE(queue.getLatencyMinMs() == 0);
+    REQUIRE(queue.getLatencyMaxMs() == 60000);
+    REQUIRE(queue.getLatencyLastMs() == 60000);
+    REQUIRE(queue.getLatencyAvgMs() == ((5000 + 5001 + 0 + 10000 + 99999 + 5000000 + 5000001 + 60000000) / 8 + 500) / 1000);
+
+    // A PUBACK before the publish call returned counts as 0 ms
+    REQUIRE(queue.push("t", (const uint8_t*)"x", 1));
+    queue.sent(msgId, 2000000);
+    REQUIRE(queue.acked(msgId, 1999000));
+    REQUIRE(queue.getLatencyCount(0) == counts[0] + 1);
+}
+
+TEST_CASE("PublishQueue - Random traffic against a queue model", "[qos]") {
+    static uint8_t memory[3000];
+    const size_t maxPayload = 300;
+    const size_t maxRecord = 4 + 32 + maxPayload + 3;
+
+    std::mt19937 rng(3701);
+    PublishQueue queue;
+    queue.begin(memory, sizeof(memory), 3);
+    std::deque<std::pair<std::string, std::string> > model;
+    uint32_t number = 0;
+    int msgId = 1;
+    std::vector<int> inFlight;
+
+    for (int step = 0; step < 50000; step++) {
+        uint32_t action = rng() % 10;
+        if (action < 6) {
+            std::string topic = "ntrip/" + std::string(rng() % 24, 't');
+            std::string payload = makePayload(number++, 8 + rng() % (maxPayload - 8));
+            uint32_t usedBefore = queue.getQueuedBytes();
+            uint32_t droppedBefore = queue.getDropped();
+            bool fits = queue.fits(topic.size(), payload.size());
+            REQUIRE(queue.push(topic.c_str(), (const uint8_t*)payload.data(), payload.size()));
+            uint32_t drops = queue.getDropped() - droppedBefore;
+            REQUIRE((drops == 0) == fits);
+
+            // Drop-oldest only when the ring is nearly full
+            if (drops > 0) {
+                REQUIRE(usedBefore + 2 * maxRecord > sizeof(memory));
+            }
+            for (uint32_t i = 0; i < drops; i++) {
+                model.pop_front();
+            }
+            model.push_back(std::make_pair(topic, payload));
+        } else if (action < 8) {
+            if (queue.canSend()) {
+                const char* topic;
+                const uint8_t* data;
+                size_t length;
+                REQUIRE(queue.front(&topic, &data, &length));
+                REQUIRE(topic == model.front().first);
+                REQUIRE(std::string((const char*)data, length) == model.front().second);
+                model.pop_front();
+                queue.sent(msgId, step);
+                inFlight.push_back(msgId++);
+            }
+        } else if (!inFlight.empty()) {
+            size_t index = rng() % inFlight.size();
+            REQUIRE(queue.acked(inFlight[index], step + 10));
+            inFlight.erase(inFlight.begin() + index);
+        }
+
+        REQUIRE(queue.getQueued() == model.size());
+        REQUIRE(queue.getInFlight() == inFlight.size());
+        REQUIRE(queue.getInFlight() <= 3);
+        REQUIRE(queue.getQueuedBytes() <= sizeof(memory));
+        uint32_t modelBytes = 0;
+        for (size_t i = 0; i < model.size(); i++) {
+            modelBytes += (4 + model[i].first.size() + 1 + model[i].second.size() + 3) & ~3u;
+        }
+        REQUIRE(queue.getQueuedBytes() == modelBytes);
+    }
+    REQUIRE(queue.getDropped() > 100);
+    REQUIRE(queue.getAcked() > 1000);
+}
@@ -0,0 +1,251 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch.hpp"
+#include "FanoutBuffer_standalone.h"
+#include <vector>
+#include <string>
+#include <deque>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+// Buffer dimensions used by nmeaServerTask.cpp
+static const size_t BLOCK_SIZE = 128;
+static const size_t CLIENT_DEPTH = 128;
+static const size_t BLOCK_COUNT = CLIENT_DEPTH + 32;
+
+// Build "$<body>*HH\r\n" with a valid checksum
+static std::string makeSentence(const char* body) {
+    uint8_t checksum = 0;
+    for (const char* p = body; *p; p++) {
+        checksum ^= (uint8_t)*p;
+    }
+    char tail[8];
+    snprintf(tail, sizeof(tail), "*%02X\r\n", checksum);
+    return std::string("$") + body + tail;
+}
+
+// One 10 Hz epoch of a typical receiver configuration, including a long
+// proprietary sentence that spans two buffer blocks
+static std::vector<std::string> makeEpoch() {
+    std::vector<std::string> epoch;
+    epoch.push_back(makeSentence("GNGGA,123519.00,5213.12345,N,00600.54321,E,4,12,0.8,45.3,M,46.9,M,1.0,0000"));
+    epoch.push_back(makeSentence("GNRMC,123519.00,A,5213.12345,N,00600.54321,E,0.021,,171026,,,R,V"));
+    epoch.push_back(makeSentence("GNGSA,A,3,02,05,07,09,13,15,18,20,,,,,1.4,0.8,1.1,1"));
+    epoch.push_back(makeSentence("GPGSV,3,1,10,02,45,123,44,05,67,280,47,07,12,040,38,09,33,190,42,1"));
+    epoch.push_back(makeSentence("GPGSV,3,2,10,13,21,310,40,15,55,090,46,18,08,350,35,20,61,210,48,1"));
+    epoch.push_back(makeSentence("GNVTG,,T,,M,0.021,N,0.039,K,R"));
+    epoch.push_back(makeSentence("GNGST,123519.00,0.010,0.012,0.009,45.1,0.011,0.010,0.018"));
+    epoch.push_back(makeSentence("PUBX,00,123519.00,5213.12345,N,00600.54321,E,45.300,R2,0.012,0.018,0.039,"
+                                 "0.00,0.010,,0.80,1.10,0.90,12,0,0,EXTRA,FIELDS,FOR,A,LONG,PROPRIETARY,SENTENCE"));
+    return epoch;
+}
+
+// Drain everything queued for a subscriber into a client stream
+static void drain(FanoutBuffer& buffer, int id, std::string& out) {
+    const uint8_t* data;
+    size_t length;
+    while (buffer.peek(id, &data, &length)) {
+        out.append((const char*)data, length);
+        buffer.consume(id, length);
+    }
+}
+
+// Check that a received stream consists of whole, valid sentences
+static bool allSentencesValid(const std::string& stream, size_t* count) {
+    size_t start = 0;
+    *count = 0;
+    while (start < stream.size()) {
+        size_t end = stream.find("\r\n", start);
+        if (end == std::string::npos || stream[start] != '$') {
+            return false;
+        }
+        size_t star = stream.rfind('*', end);
+        if (star == std::string::npos || star < start || end - star != 3) {
+            return false;
+        }
+        uint8_t checksum = 0;
+        for (size_t i = start + 1; i < star; i++) {
+            checksum ^= (uint8_t)stream[i];
+        }
+        if (strtoul(stream.substr(star + 1, 2).c_str(), NULL, 16) != checksum) {
+            return false;
+        }
+        (*count)++;
+        start = end + 2;
+    }
+    return true;
+}
+
+TEST_CASE("NMEA fan-out - Every client receives whole sentences", "[NMEAServer]") {
+    const size_t clientCounts[] = {1, 10, 50};
+    std::vector<std::string> epoch = makeEpoch();
+    REQUIRE(epoch.back().size() > BLOCK_SIZE);
+
+    for (size_t c = 0; c < 3; c++) {
+        size_t clientCount = clientCounts[c];
+        FanoutBuffer buffer;
+        REQUIRE(buffer.init(BLOCK_COUNT, BLOCK_SIZE, clientCount, CLIENT_DEPTH));
+
+        std::vector<int> ids;
+        for (size_t i = 0; i < clientCount; i++) {
+            ids.push_back(buffer.subscribe());
+        }
+
+        std::vector<std::string> received(clientCount);
+        std::string expected;
+        for (int e = 0; e < 100; e++) {
+            for (size_t s = 0; s < epoch.size(); s++) {
+                REQUIRE(buffer.publish((const uint8_t*)epoch[s].data(), epoch[s].size()) == clientCount);
+                expected += epoch[s];
+            }
+            for (size_t i = 0; i < clientCount; i++) {
+                drain(buffer, ids[i], received[i]);
+            }
+        }
+
+        for (size_t i = 0; i < clientCount; i++) {
+            REQUIRE(received[i] == expected);
+            size_t count;
+            REQUIRE(allSentencesValid(received[i], &count));
+            REQUIRE(count == 100 * epoch.size());
+        }
+        REQUIRE(buffer.getBlocksInUse() == 0);
+        REQUIRE(buffer.getEvictionCount() == 0);
+    }
+}
+
+TEST_CASE("NMEA fan-out - A stalled client is evicted, others keep the full stream", "[NMEAServer]") {
+    std::vector<std::string> epoch = makeEpoch();
+    FanoutBuffer buffer;
+    REQUIRE(buffer.init(BLOCK_COUNT, BLOCK_SIZE, 10, CLIENT_DEPTH));
+
+    std::vector<int> ids;
+    for (int i = 0; i < 10; i++) {
+        ids.push_back(buffer.subscribe());
+    }
+    int stalled = ids[3];
+
+    std::vector<std::string> received(10);
+    std::string expected;
+    for (int e = 0; e < 50; e++) {
+        for (size_t s = 0; s < epoch.size(); s++) {
+            buffer.publish((const uint8_t*)epoch[s].data(), epoch[s].size());
+            expected += epoch[s];
+        }
+        for (int i = 0; i < 10; i++) {
+            if (ids[i] != stalled) {
+                drain(buffer, ids[i], received[i]);
+            }
+        }
+    }
+
+    REQUIRE(buffer.isEvicted(stalled));
+    REQUIRE(buffer.getEvictionCount() == 1);
+    for (int i = 0; i < 10; i++) {
+        if (ids[i] != stalled) {
+            REQUIRE_FALSE(buffer.isEvicted(ids[i]));
+            REQUIRE(received[i] == expected);
+        }
+    }
+
+    // The freed slot is usable again, the new client starts at the next sentence
+    buffer.unsubscribe(stalled);
+    int rejoined = buffer.subscribe();
+    REQUIRE(rejoined >= 0);
+    buffer.publish((const uint8_t*)epoch[0].data(), epoch[0].size());
+    std::string fresh;
+    drain(buffer, rejoined, fresh);
+    REQUIRE(fresh == epoch[0]);
+}
+
+// Send simulation: copy into a per-client socket buffer that wraps around
+struct SinkClient {
+    char socketBuffer[4096];
+    size_t position;
+    uint64_t bytes;
+    SinkClient() : position(0), bytes(0) {}
+    void send(const void* data, size_t length) {
+        if (position + length > sizeof(socketBuffer)) {
+            position = 0;
+        }
+        memcpy(socketBuffer + position, data, length);
+        position += length;
+        bytes += length;
+    }
+};
+
+static double benchmarkFanout(const std::vector<std::string>& epoch, size_t clientCount, int epochs,
+                              uint64_t* bytesPerClient) {
+    FanoutBuffer buffer;
+    buffer.init(BLOCK_COUNT, BLOCK_SIZE, clientCount, CLIENT_DEPTH);
+    std::vector<int> ids;
+    for (size_t i = 0; i < clientCount; i++) {
+        ids.push_back(buffer.subscribe());
+    }
+    std::vector<SinkClient> sinks(clientCount);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int e = 0; e < epochs; e++) {
+        for (size_t s = 0; s < epoch.size(); s++) {
+            buffer.publish((const uint8_t*)epoch[s].data(), epoch[s].size());
+        }
+        for (size_t i = 0; i < clientCount; i++) {
+            const uint8_t* data;
+            size_t length;
+            while (buffer.peek(ids[i], &data, &length)) {
+                sinks[i].send(data, length);
+                buffer.consume(ids[i], length);
+            }
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    *bytesPerClient = sinks[0].bytes;
+    return (double)epochs * epoch.size() / seconds;
+}
+
+// Reference: a private queue of line copies per client
+static double benchmarkCopyPerClient(const std::vector<std::string>& epoch, size_t clientCount, int epochs,
+                                     uint64_t* bytesPerClient) {
+    std::vector<std::deque<std::string> > queues(clientCount);
+    std::vector<SinkClient> sinks(clientCount);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int e = 0; e < epochs; e++) {
+        for (size_t s = 0; s < epoch.size(); s++) {
+            for (size_t i = 0; i < clientCount; i++) {
+                queues[i].push_back(epoch[s]);
+            }
+        }
+        for (size_t i = 0; i < clientCount; i++) {
+            while (!queues[i].empty()) {
+                sinks[i].send(queues[i].front().data(), queues[i].front().size());
+                queues[i].pop_front();
+            }
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    *bytesPerClient = sinks[0].bytes;
+    return (double)epochs * epoch.size() / seconds;
+}
+
+TEST_CASE("NMEA fan-out benchmark - lines per second at 1, 10 and 50 clients", "[.benchmark]") {
+    const size_t clientCounts[] = {1, 10, 50};
+    const int epochs = 20000;
+    std::vector<std::string> epoch = makeEpoch();
+    size_t epochBytes = 0;
+    for (size_t s = 0; s < epoch.size(); s++) {
+        epochBytes += epoch[s].size();
+    }
+
+    printf("\n%8s %18s %18s\n", "clients", "fan-out lines/s", "copy lines/s");
+    for (size_t c = 0; c < 3; c++) {
+        uint64_t fanoutBytes = 0;
+        uint64_t copyBytes = 0;
+        double fanout = benchmarkFanout(epoch, clientCounts[c], epochs, &fanoutBytes);
+        double copy = benchmarkCopyPerClient(epoch, clientCounts[c], epochs, &copyBytes);
+        printf("%8u %18.0f %18.0f\n", (unsigned)clientCounts[c], fanout, copy);
+
+        REQUIRE(fanoutBytes == (uint64_t)epochs * epochBytes);
+        REQUIRE(copyBytes == fanoutBytes);
+    }
+}
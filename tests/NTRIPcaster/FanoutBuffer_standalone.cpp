@@ -0,0 +1,295 @@
+// Standalone build for NTRIP caster tests using Code::Blocks
+// This file contains a copy of the FanoutBuffer implementation for standalone compilation
+
+#include <cstdint>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FanoutBuffer_standalone.h"
+
+FanoutBuffer::FanoutBuffer()
+    : storage(NULL),
+      blocks(NULL),
+      subscribers(NULL),
+      rings(NULL),
+      blockCount(0),
+      blockSize(0),
+      maxSubscribers(0),
+      subscriberDepth(0),
+      nextFree(0),
+      evictionCount(0),
+      publishedBlocks(0),
+      publishedBytes(0) {
+}
+
+FanoutBuffer::~FanoutBuffer() {
+    deinit();
+}
+
+bool FanoutBuffer::init(size_t count, size_t size, size_t subscriberSlots, size_t depth) {
+    deinit();
+
+    // Block indices and lengths are stored as 16 bit values
+    if (count == 0 || count > 0xFFFF || size == 0 || size > 0xFFFF ||
+        subscriberSlots == 0 || depth == 0 || depth > 0xFFFF) {
+        return false;
+    }
+
+    storage = (uint8_t*)malloc(count * size);
+    blocks = (Block*)calloc(count, sizeof(Block));
+    subscribers = (Subscriber*)calloc(subscriberSlots, sizeof(Subscriber));
+    rings = (uint16_t*)calloc(subscriberSlots * depth, sizeof(uint16_t));
+    if (storage == NULL || blocks == NULL || subscribers == NULL || rings == NULL) {
+        deinit();
+        return false;
+    }
+
+    blockCount = count;
+    blockSize = size;
+    maxSubscribers = subscriberSlots;
+    subscriberDepth = depth;
+    for (size_t i = 0; i < maxSubscribers; i++) {
+        subscribers[i].ring = rings + i * subscriberDepth;
+    }
+    return true;
+}
+
+void FanoutBuffer::deinit() {
+    free(storage);
+    free(blocks);
+    free(subscribers);
+    free(rings);
+    storage = NULL;
+    blocks = NULL;
+    subscribers = NULL;
+    rings = NULL;
+    blockCount = 0;
+    blockSize = 0;
+    maxSubscribers = 0;
+    subscriberDepth = 0;
+    nextFree = 0;
+    evictionCount = 0;
+    publishedBlocks = 0;
+    publishedBytes = 0;
+}
+
+bool FanoutBuffer::validId(int id) const {
+    return id >= 0 && (size_t)id < maxSubscribers && subscribers[id].active;
+}
+
+int FanoutBuffer::subscribe() {
+    for (size_t i = 0; i < maxSubscribers; i++) {
+        Subscriber& subscriber = subscribers[i];
+        if (!subscriber.active) {
+            subscriber.active = true;
+            subscriber.evicted = false;
+            subscriber.pinned = false;
+            subscriber.head = 0;
+            subscriber.count = 0;
+            subscriber.offset = 0;
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+void FanoutBuffer::unsubscribe(int id) {
+    if (!validId(id)) {
+        return;
+    }
+    unpin(subscribers[id]);
+    dropQueue(subscribers[id]);
+    subscribers[id].active = false;
+    subscribers[id].evicted = false;
+}
+
+void FanoutBuffer::release(uint16_t block) {
+    if (blocks[block].refs > 0) {
+        blocks[block].refs--;
+    }
+}
+
+void FanoutBuffer::dropQueue(Subscriber& subscriber) {
+    while (subscriber.count > 0) {
+        release(subscriber.ring[subscriber.head]);
+        subscriber.head = (uint16_t)((subscriber.head + 1) % subscriberDepth);
+        subscriber.count--;
+    }
+    subscriber.head = 0;
+    subscriber.offset = 0;
+}
+
+void FanoutBuffer::unpin(Subscriber& subscriber) {
+    if (subscriber.pinned) {
+        release(subscriber.pinnedBlock);
+        subscriber.pinned = false;
+    }
+}
+
+void FanoutBuffer::evict(Subscriber& subscriber) {
+    dropQueue(subscriber);
+    subscriber.evicted = true;
+    evictionCount++;
+}
+
+int FanoutBuffer::allocateBlock() {
+    // Round robin search keeps recently released blocks cold a little longer
+    for (size_t n = 0; n < blockCount; n++) {
+        size_t index = (nextFree + n) % blockCount;
+        if (blocks[index].refs == 0) {
+            nextFree = (index + 1) % blockCount;
+            return (int)index;
+        }
+    }
+    return -1;
+}
+
+size_t FanoutBuffer::publish(const uint8_t* data, size_t length) {
+    size_t delivered = 0;
+
+    if (storage == NULL || data == NULL) {
+        return 0;
+    }
+
+    while (length > 0) {
+        size_t chunk = (length > blockSize) ? blockSize : length;
+
+        // Subscribers that cannot take another block are evicted, ingest never waits
+        size_t receivers = 0;
+        for (size_t i = 0; i < maxSubscribers; i++) {
+            Subscriber& subscriber = subscribers[i];
+            if (!subscriber.active || subscriber.evicted) {
+                continue;
+            }
+            if (subscriber.count >= subscriberDepth) {
+                evict(subscriber);
+            } else {
+                receivers++;
+            }
+        }
+        if (receivers == 0) {
+            return delivered;
+        }
+
+        int block = allocateBlock();
+        while (block < 0) {
+            // Pool exhausted: evict the subscriber with the largest backlog
+            Subscriber* slowest = NULL;
+            for (size_t i = 0; i < maxSubscribers; i++) {
+                Subscriber& subscriber = subscribers[i];
+                if (subscriber.active && !subscriber.evicted &&
+                    (slowest == NULL || subscriber.count > slowest->count)) {
+                    slowest = &subscriber;
+                }
+            }
+            if (slowest == NULL || slowest->count == 0) {
+                return delivered;
+            }
+            evict(*slowest);
+            receivers--;
+            block = allocateBlock();
+        }
+        if (receivers == 0) {
+            return delivered;
+        }
+
+        memcpy(storage + (size_t)block * blockSize, data, chunk);
+        blocks[block].length = (uint16_t)chunk;
+        blocks[block].refs = 0;
+
+        for (size_t i = 0; i < maxSubscribers; i++) {
+            Subscriber& subscriber = subscribers[i];
+            if (!subscriber.active || subscriber.evicted) {
+                continue;
+            }
+            size_t tail = (subscriber.head + subscriber.count) % subscriberDepth;
+            subscriber.ring[tail] = (uint16_t)block;
+            subscriber.count++;
+            blocks[block].refs++;
+        }
+
+        delivered = receivers;
+        publishedBlocks++;
+        publishedBytes += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+
+    return delivered;
+}
+
+bool FanoutBuffer::peek(int id, const uint8_t** data, size_t* length) const {
+    if (!validId(id) || data == NULL || length == NULL) {
+        return false;
+    }
+    const Subscriber& subscriber = subscribers[id];
+    if (subscriber.evicted || subscriber.count == 0) {
+        return false;
+    }
+    uint16_t block = subscriber.ring[subscriber.head];
+    *data = storage + (size_t)block * blockSize + subscriber.offset;
+    *length = blocks[block].length - subscriber.offset;
+    return true;
+}
+
+bool FanoutBuffer::pin(int id, const uint8_t** data, size_t* length) {
+    if (!validId(id) || subscribers[id].pinned || !peek(id, data, length)) {
+        return false;
+    }
+    // Extra reference so eviction or publish() cannot recycle the block mid-send
+    Subscriber& subscriber = subscribers[id];
+    subscriber.pinnedBlock = subscriber.ring[subscriber.head];
+    subscriber.pinned = true;
+    blocks[subscriber.pinnedBlock].refs++;
+    return true;
+}
+
+void FanoutBuffer::consume(int id, size_t bytes) {
+    if (!validId(id)) {
+        return;
+    }
+    Subscriber& subscriber = subscribers[id];
+    unpin(subscriber);
+    while (bytes > 0 && subscriber.count > 0) {
+        uint16_t block = subscriber.ring[subscriber.head];
+        size_t remaining = blocks[block].length - subscriber.offset;
+        if (bytes < remaining) {
+            subscriber.offset = (uint16_t)(subscriber.offset + bytes);
+            return;
+        }
+        bytes -= remaining;
+        release(block);
+        subscriber.head = (uint16_t)((subscriber.head + 1) % subscriberDepth);
+        subscriber.count--;
+        subscriber.offset = 0;
+    }
+}
+
+bool FanoutBuffer::isEvicted(int id) const {
+    return validId(id) && subscribers[id].evicted;
+}
+
+size_t FanoutBuffer::pendingBlocks(int id) const {
+    return validId(id) ? subscribers[id].count : 0;
+}
+
+size_t FanoutBuffer::getSubscriberCount() const {
+    size_t count = 0;
+    for (size_t i = 0; i < maxSubscribers; i++) {
+        if (subscribers[i].active && !subscribers[i].evicted) {
+            count++;
+        }
+    }
+    return count;
+}
+
+size_t FanoutBuffer::getBlocksInUse() const {
+    size_t count = 0;
+    for (size_t i = 0; i < blockCount; i++) {
+        if (blocks[i].refs > 0) {
+            count++;
+        }
+    }
+    return count;
+}
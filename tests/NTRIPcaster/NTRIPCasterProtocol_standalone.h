@@ -0,0 +1,102 @@
+#ifndef NTRIPCASTERPROTOCOL_STANDALONE_H
+#define NTRIPCASTERPROTOCOL_STANDALONE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/** Maximum mountpoint length including terminator. */
+#define NTRIP_MOUNTPOINT_MAX_LEN    64
+/** Maximum Basic authorization token length including terminator. */
+#define NTRIP_AUTH_MAX_LEN          128
+
+/**
+ * @brief Result of parsing a client request.
+ */
+enum NtripRequestStatus {
+    NTRIP_REQUEST_INCOMPLETE = 0,   /**< Header terminator not received yet */
+    NTRIP_REQUEST_OK,               /**< Complete and valid GET request */
+    NTRIP_REQUEST_INVALID           /**< Not an NTRIP GET request or a field is too long */
+};
+
+/**
+ * @brief Response types the caster sends before streaming or closing.
+ */
+enum NtripResponseType {
+    NTRIP_RESPONSE_STREAM = 0,      /**< Mountpoint accepted, RTCM data follows */
+    NTRIP_RESPONSE_UNAUTHORIZED,    /**< Missing or wrong credentials */
+    NTRIP_RESPONSE_NOT_FOUND,       /**< Unknown mountpoint (NTRIP v2 only) */
+    NTRIP_RESPONSE_UNAVAILABLE,     /**< All client slots in use */
+    NTRIP_RESPONSE_BAD_REQUEST      /**< Malformed request */
+};
+
+/**
+ * @brief Parsed NTRIP client request.
+ */
+struct NtripRequest {
+    int version;                                /**< 1 for NTRIP 1.0, 2 for NTRIP 2.0 */
+    char mountpoint[NTRIP_MOUNTPOINT_MAX_LEN];  /**< Requested mountpoint without leading '/' (empty = sourcetable) */
+    char authorization[NTRIP_AUTH_MAX_LEN];     /**< Base64 token from "Authorization: Basic" */
+    bool hasAuthorization;                      /**< True if a Basic authorization header was present */
+    size_t headerLength;                        /**< Bytes up to and including the blank line */
+};
+
+/**
+ * @brief Parse an NTRIP 1.0 or 2.0 GET request from a client.
+ *
+ * The buffer may hold a partial request; call again when more bytes
+ * arrive. Header names are matched case-insensitively.
+ *
+ * @param buffer Received bytes (not required to be terminated).
+ * @param length Number of bytes in the buffer.
+ * @param request Receives the parsed request when NTRIP_REQUEST_OK is returned.
+ * @return Parse status.
+ */
+NtripRequestStatus parseNtripRequest(const char* buffer, size_t length, NtripRequest* request);
+
+/**
+ * @brief Check the Basic credentials of a request.
+ *
+ * An empty configured user disables authentication.
+ *
+ * @param request Parsed request.
+ * @param user Configured user name.
+ * @param password Configured password.
+ * @return true if access is granted.
+ */
+bool ntripCheckAuthorization(const NtripRequest* request, const char* user, const char* password);
+
+/**
+ * @brief Format the response header for a request.
+ * @param type Response type.
+ * @param version NTRIP version of the client (1 or 2).
+ * @param mountpoint Mountpoint used for the authentication realm.
+ * @param buffer Output buffer.
+ * @param size Output buffer size.
+ * @return Length of the response, or 0 if the buffer is too small.
+ */
+size_t ntripFormatResponse(NtripResponseType type, int version, const char* mountpoint,
+                           char* buffer, size_t size);
+
+/**
+ * @brief Format a complete sourcetable response with one STR entry.
+ * @param version NTRIP version of the client (1 or 2).
+ * @param mountpoint Served mountpoint.
+ * @param authentication True if the mountpoint requires Basic authentication.
+ * @param latitude Approximate latitude of the base in decimal degrees.
+ * @param longitude Approximate longitude of the base in decimal degrees.
+ * @param buffer Output buffer.
+ * @param size Output buffer size.
+ * @return Length of the response, or 0 if the buffer is too small.
+ */
+size_t ntripFormatSourcetable(int version, const char* mountpoint, bool authentication,
+                              double latitude, double longitude, char* buffer, size_t size);
+
+/**
+ * @brief Format an HTTP/1.1 chunk size line ("<hex>\r\n") for NTRIP 2.0 streaming.
+ * @param length Chunk payload length (must be greater than zero).
+ * @param buffer Output buffer, at least 11 bytes.
+ * @return Length of the chunk size line.
+ */
+size_t ntripFormatChunkHeader(size_t length, char* buffer);
+
+#endif // NTRIPCASTERPROTOCOL_STANDALONE_H
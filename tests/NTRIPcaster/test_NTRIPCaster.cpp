@@ -0,0 +1,386 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch.hpp"
+#include "FanoutBuffer_standalone.h"
+#include "NTRIPCasterProtocol_standalone.h"
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+
+// Deterministic pseudo random generator so load test runs are reproducible
+static uint32_t nextRandom(uint32_t& state) {
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+// Drain everything queued for a subscriber, at most maxBytes
+static size_t drain(FanoutBuffer& buffer, int id, std::vector<uint8_t>& out, size_t maxBytes) {
+    size_t total = 0;
+    const uint8_t* data;
+    size_t length;
+    while (total < maxBytes && buffer.peek(id, &data, &length)) {
+        size_t take = length;
+        if (take > maxBytes - total) {
+            take = maxBytes - total;
+        }
+        out.insert(out.end(), data, data + take);
+        buffer.consume(id, take);
+        total += take;
+    }
+    return total;
+}
+
+static std::string asString(const char* buffer, size_t length) {
+    return std::string(buffer, length);
+}
+
+TEST_CASE("FanoutBuffer - Data arrives in order and is split over blocks", "[FanoutBuffer]") {
+    FanoutBuffer buffer;
+    REQUIRE(buffer.init(8, 16, 2, 8));
+    int id = buffer.subscribe();
+    REQUIRE(id >= 0);
+
+    uint8_t data[40];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)i;
+    }
+    REQUIRE(buffer.publish(data, sizeof(data)) == 1);
+    REQUIRE(buffer.pendingBlocks(id) == 3);
+
+    std::vector<uint8_t> received;
+    REQUIRE(drain(buffer, id, received, 1000) == sizeof(data));
+    REQUIRE(std::memcmp(received.data(), data, sizeof(data)) == 0);
+    REQUIRE(buffer.getBlocksInUse() == 0);
+}
+
+TEST_CASE("FanoutBuffer - Subscribers share one copy", "[FanoutBuffer]") {
+    FanoutBuffer buffer;
+    REQUIRE(buffer.init(4, 32, 3, 4));
+    int a = buffer.subscribe();
+    int b = buffer.subscribe();
+
+    const uint8_t data[] = { 0xD3, 0x00, 0x13 };
+    REQUIRE(buffer.publish(data, sizeof(data)) == 2);
+    REQUIRE(buffer.getBlocksInUse() == 1);
+
+    const uint8_t* pa;
+    const uint8_t* pb;
+    size_t la, lb;
+    REQUIRE(buffer.peek(a, &pa, &la));
+    REQUIRE(buffer.peek(b, &pb, &lb));
+    REQUIRE(pa == pb);
+    REQUIRE(la == sizeof(data));
+
+    SECTION("Block is released after the last reader") {
+        buffer.consume(a, la);
+        REQUIRE(buffer.getBlocksInUse() == 1);
+        buffer.consume(b, lb);
+        REQUIRE(buffer.getBlocksInUse() == 0);
+    }
+
+    SECTION("Partial consume continues inside the block") {
+        buffer.consume(a, 1);
+        REQUIRE(buffer.peek(a, &pa, &la));
+        REQUIRE(la == 2);
+        REQUIRE(pa[0] == 0x00);
+    }
+
+    SECTION("Unsubscribe releases queued blocks") {
+        buffer.unsubscribe(a);
+        buffer.unsubscribe(b);
+        REQUIRE(buffer.getBlocksInUse() == 0);
+        REQUIRE(buffer.getSubscriberCount() == 0);
+    }
+}
+
+TEST_CASE("FanoutBuffer - Late subscriber only sees new data", "[FanoutBuffer]") {
+    FanoutBuffer buffer;
+    REQUIRE(buffer.init(4, 8, 2, 4));
+    int a = buffer.subscribe();
+    const uint8_t first[] = { 1, 2, 3 };
+    const uint8_t second[] = { 4, 5 };
+    buffer.publish(first, sizeof(first));
+    int b = buffer.subscribe();
+    buffer.publish(second, sizeof(second));
+
+    std::vector<uint8_t> ra, rb;
+    drain(buffer, a, ra, 100);
+    drain(buffer, b, rb, 100);
+    REQUIRE(ra.size() == 5);
+    REQUIRE(rb.size() == 2);
+    REQUIRE(rb[0] == 4);
+}
+
+TEST_CASE("FanoutBuffer - Slow subscribers are evicted, not waited for", "[FanoutBuffer]") {
+    const uint8_t data[] = { 0xAA };
+
+    SECTION("Full ring evicts only the slow subscriber") {
+        FanoutBuffer buffer;
+        REQUIRE(buffer.init(8, 4, 2, 3));
+        int fast = buffer.subscribe();
+        int slow = buffer.subscribe();
+        std::vector<uint8_t> out;
+        for (int i = 0; i < 4; i++) {
+            buffer.publish(data, sizeof(data));
+            drain(buffer, fast, out, 100);
+        }
+        REQUIRE(buffer.isEvicted(slow));
+        REQUIRE_FALSE(buffer.isEvicted(fast));
+        REQUIRE(buffer.getEvictionCount() == 1);
+        REQUIRE(out.size() == 4);
+
+        // Evicted slot is reusable after the owner unsubscribes
+        buffer.unsubscribe(slow);
+        REQUIRE(buffer.subscribe() == slow);
+    }
+
+    SECTION("Exhausted pool evicts the largest backlog") {
+        FanoutBuffer buffer;
+        REQUIRE(buffer.init(3, 4, 2, 8));
+        int a = buffer.subscribe();
+        int b = buffer.subscribe();
+        std::vector<uint8_t> out;
+        buffer.publish(data, sizeof(data));
+        buffer.publish(data, sizeof(data));
+        drain(buffer, a, out, 100);
+        buffer.publish(data, sizeof(data));
+        REQUIRE(buffer.publish(data, sizeof(data)) == 1);
+        REQUIRE(buffer.isEvicted(b));
+        REQUIRE_FALSE(buffer.isEvicted(a));
+    }
+
+    SECTION("Publishing without subscribers uses no blocks") {
+        FanoutBuffer buffer;
+        REQUIRE(buffer.init(2, 4, 2, 2));
+        REQUIRE(buffer.publish(data, sizeof(data)) == 0);
+        REQUIRE(buffer.getBlocksInUse() == 0);
+    }
+}
+
+TEST_CASE("FanoutBuffer - A pinned block outlives eviction and pool reuse", "[FanoutBuffer]") {
+    const uint8_t first[] = { 0x11, 0x22, 0x33, 0x44 };
+    const uint8_t other[] = { 0x55, 0x66, 0x77, 0x88 };
+    FanoutBuffer buffer;
+    REQUIRE(buffer.init(2, 4, 2, 1));
+    int slow = buffer.subscribe();
+    REQUIRE(buffer.publish(first, sizeof(first)) == 1);
+
+    const uint8_t* data;
+    size_t length;
+    REQUIRE(buffer.pin(slow, &data, &length));
+    REQUIRE(length == sizeof(first));
+    REQUIRE_FALSE(buffer.pin(slow, &data, &length));
+
+    SECTION("Eviction and new blocks leave the pinned block alone") {
+        // Ring depth 1: the next block evicts the reader while its send is in progress
+        int fast = buffer.subscribe();
+        std::vector<uint8_t> out;
+        for (int i = 0; i < 4; i++) {
+            REQUIRE(buffer.publish(other, sizeof(other)) == 1);
+            drain(buffer, fast, out, 100);
+        }
+        REQUIRE(buffer.isEvicted(slow));
+        REQUIRE(std::memcmp(data, first, sizeof(first)) == 0);
+        REQUIRE(buffer.getBlocksInUse() == 1);
+
+        buffer.consume(slow, length);
+        REQUIRE(buffer.getBlocksInUse() == 0);
+        buffer.unsubscribe(slow);
+    }
+
+    SECTION("Consume drops the pin and advances the reader") {
+        buffer.consume(slow, 2);
+        REQUIRE(buffer.pin(slow, &data, &length));
+        REQUIRE(length == 2);
+        REQUIRE(data[0] == 0x33);
+        buffer.consume(slow, 2);
+        REQUIRE(buffer.getBlocksInUse() == 0);
+    }
+
+    SECTION("Unsubscribe drops an outstanding pin") {
+        buffer.unsubscribe(slow);
+        REQUIRE(buffer.getBlocksInUse() == 0);
+    }
+}
+
+TEST_CASE("parseNtripRequest - NTRIP 1.0 and 2.0 requests", "[NTRIPCasterProtocol]") {
+    NtripRequest request;
+
+    SECTION("NTRIP 1.0 request") {
+        const char* text = "GET /ESP32 HTTP/1.0\r\nUser-Agent: NTRIP RTKLIB/2.4.3\r\n"
+                           "Authorization: Basic dGVzdDpzZWNyZXQ=\r\n\r\n";
+        REQUIRE(parseNtripRequest(text, strlen(text), &request) == NTRIP_REQUEST_OK);
+        REQUIRE(request.version == 1);
+        REQUIRE(std::string(request.mountpoint) == "ESP32");
+        REQUIRE(request.hasAuthorization);
+        REQUIRE(std::string(request.authorization) == "dGVzdDpzZWNyZXQ=");
+        REQUIRE(request.headerLength == strlen(text));
+    }
+
+    SECTION("NTRIP 2.0 request, header names in any case") {
+        const char* text = "GET /ESP32 HTTP/1.1\r\nHost: 192.168.4.1\r\nntrip-version: Ntrip/2.0\r\n\r\n";
+        REQUIRE(parseNtripRequest(text, strlen(text), &request) == NTRIP_REQUEST_OK);
+        REQUIRE(request.version == 2);
+        REQUIRE_FALSE(request.hasAuthorization);
+    }
+
+    SECTION("Sourcetable request") {
+        const char* text = "GET / HTTP/1.0\n\n";
+        REQUIRE(parseNtripRequest(text, strlen(text), &request) == NTRIP_REQUEST_OK);
+        REQUIRE(request.mountpoint[0] == '\0');
+    }
+
+    SECTION("Partial and malformed requests") {
+        const char* partial = "GET /ESP32 HTTP/1.0\r\nUser-Agent: NTRIP";
+        REQUIRE(parseNtripRequest(partial, strlen(partial), &request) == NTRIP_REQUEST_INCOMPLETE);
+        const char* post = "POST /ESP32 HTTP/1.1\r\n";
+        REQUIRE(parseNtripRequest(post, strlen(post), &request) == NTRIP_REQUEST_INVALID);
+        const char* nopath = "GET ESP32 HTTP/1.0\r\n\r\n";
+        REQUIRE(parseNtripRequest(nopath, strlen(nopath), &request) == NTRIP_REQUEST_INVALID);
+    }
+}
+
+TEST_CASE("ntripCheckAuthorization - Basic credentials", "[NTRIPCasterProtocol]") {
+    NtripRequest request;
+    const char* text = "GET /ESP32 HTTP/1.0\r\nAuthorization: Basic dGVzdDpzZWNyZXQ=\r\n\r\n";
+    REQUIRE(parseNtripRequest(text, strlen(text), &request) == NTRIP_REQUEST_OK);
+
+    REQUIRE(ntripCheckAuthorization(&request, "test", "secret"));
+    REQUIRE_FALSE(ntripCheckAuthorization(&request, "test", "wrong"));
+    REQUIRE(ntripCheckAuthorization(&request, "", ""));     // Authentication disabled
+
+    request.hasAuthorization = false;
+    REQUIRE_FALSE(ntripCheckAuthorization(&request, "test", "secret"));
+}
+
+TEST_CASE("ntripFormatResponse - Response headers", "[NTRIPCasterProtocol]") {
+    char buffer[512];
+
+    size_t len = ntripFormatResponse(NTRIP_RESPONSE_STREAM, 1, NULL, buffer, sizeof(buffer));
+    REQUIRE(asString(buffer, len) == "ICY 200 OK\r\n\r\n");
+
+    len = ntripFormatResponse(NTRIP_RESPONSE_STREAM, 2, NULL, buffer, sizeof(buffer));
+    std::string v2 = asString(buffer, len);
+    REQUIRE(v2.find("HTTP/1.1 200 OK\r\n") == 0);
+    REQUIRE(v2.find("Ntrip-Version: Ntrip/2.0\r\n") != std::string::npos);
+    REQUIRE(v2.find("Transfer-Encoding: chunked\r\n") != std::string::npos);
+
+    len = ntripFormatResponse(NTRIP_RESPONSE_UNAUTHORIZED, 1, "ESP32", buffer, sizeof(buffer));
+    REQUIRE(asString(buffer, len).find("realm=\"/ESP32\"") != std::string::npos);
+
+    REQUIRE(ntripFormatResponse(NTRIP_RESPONSE_STREAM, 2, NULL, buffer, 16) == 0);
+}
+
+TEST_CASE("ntripFormatSourcetable - Content length matches body", "[NTRIPCasterProtocol]") {
+    char buffer[512];
+    size_t len = ntripFormatSourcetable(1, "ESP32", true, 52.1, 5.2, buffer, sizeof(buffer));
+    std::string response = asString(buffer, len);
+    REQUIRE(response.find("SOURCETABLE 200 OK\r\n") == 0);
+    REQUIRE(response.find("STR;ESP32;ESP32;RTCM 3;") != std::string::npos);
+    REQUIRE(response.find(";52.10;5.20;") != std::string::npos);
+    REQUIRE(response.find(";B;N;") != std::string::npos);
+
+    size_t body = response.find("\r\n\r\n") + 4;
+    size_t field = response.find("Content-Length: ") + 16;
+    REQUIRE((size_t)atoi(response.c_str() + field) == response.size() - body);
+    REQUIRE(response.compare(response.size() - 16, 16, "ENDSOURCETABLE\r\n") == 0);
+}
+
+TEST_CASE("ntripFormatChunkHeader - Hexadecimal chunk sizes", "[NTRIPCasterProtocol]") {
+    char buffer[12];
+    REQUIRE(asString(buffer, ntripFormatChunkHeader(1, buffer)) == "1\r\n");
+    REQUIRE(asString(buffer, ntripFormatChunkHeader(0x1A, buffer)) == "1A\r\n");
+    REQUIRE(asString(buffer, ntripFormatChunkHeader(512, buffer)) == "200\r\n");
+}
+
+TEST_CASE("Caster load - dozens of simulated clients", "[FanoutBuffer][load]") {
+    // Same dimensions as the firmware caster, with more clients than it allows
+    const size_t blockSize = 256;
+    const size_t depth = 64;
+    const size_t clientCount = 48;
+    const size_t slowCount = 8;
+
+    FanoutBuffer buffer;
+    REQUIRE(buffer.init(depth + 16, blockSize, clientCount, depth));
+
+    struct SimClient {
+        int id;
+        bool slow;
+        bool evicted;
+        size_t joinedAt;
+        std::vector<uint8_t> received;
+    };
+    std::vector<SimClient> clients(clientCount);
+    std::vector<uint8_t> stream;
+    uint32_t seed = 12345;
+
+    // Half of the fast clients join at the start, the rest while data flows
+    for (size_t i = 0; i < clientCount; i++) {
+        clients[i].slow = i < slowCount;
+        clients[i].evicted = false;
+        clients[i].id = -1;
+        clients[i].joinedAt = 0;
+    }
+
+    const size_t reads = 4000;
+    size_t maxBlocksInUse = 0;
+    for (size_t tick = 0; tick < reads; tick++) {
+        for (size_t i = 0; i < clientCount; i++) {
+            if (clients[i].id < 0 && !clients[i].evicted && tick == (i % 2) * (reads / 4)) {
+                clients[i].id = buffer.subscribe();
+                REQUIRE(clients[i].id >= 0);
+                clients[i].joinedAt = stream.size();
+            }
+        }
+
+        // One upstream read of 1..512 bytes, as from the NTRIP client
+        size_t length = 1 + nextRandom(seed) % 512;
+        std::vector<uint8_t> read(length);
+        for (size_t n = 0; n < length; n++) {
+            read[n] = (uint8_t)(stream.size() + n);
+        }
+        stream.insert(stream.end(), read.begin(), read.end());
+        buffer.publish(read.data(), read.size());
+
+        if (buffer.getBlocksInUse() > maxBlocksInUse) {
+            maxBlocksInUse = buffer.getBlocksInUse();
+        }
+
+        // Fast clients drain a random amount each tick (average above the ingest
+        // rate), slow clients stall after the first few hundred reads
+        for (size_t i = 0; i < clientCount; i++) {
+            SimClient& client = clients[i];
+            if (client.id < 0 || client.evicted) {
+                continue;
+            }
+            if (buffer.isEvicted(client.id)) {
+                client.evicted = true;
+                buffer.unsubscribe(client.id);
+                continue;
+            }
+            size_t budget = client.slow ? (tick < 300 ? 600 : 8) : 200 + nextRandom(seed) % 800;
+            drain(buffer, client.id, client.received, budget);
+        }
+    }
+
+    size_t evictedFast = 0;
+    size_t evictedSlow = 0;
+    for (size_t i = 0; i < clientCount; i++) {
+        SimClient& client = clients[i];
+        if (client.evicted) {
+            (client.slow ? evictedSlow : evictedFast)++;
+            continue;
+        }
+        drain(buffer, client.id, client.received, (size_t)-1);
+        INFO("client " << i);
+        REQUIRE(client.received.size() == stream.size() - client.joinedAt);
+        REQUIRE(std::memcmp(client.received.data(), stream.data() + client.joinedAt,
+                            client.received.size()) == 0);
+    }
+
+    REQUIRE(evictedSlow == slowCount);
+    REQUIRE(evictedFast == 0);
+    REQUIRE(buffer.getEvictionCount() == slowCount);
+    REQUIRE(maxBlocksInUse <= depth + 16);
+    REQUIRE(buffer.getPublishedBytes() == stream.size());
+}
@@ -0,0 +1,102 @@
+#ifndef NTRIPRESPONSE_STANDALONE_H
+#define NTRIPRESPONSE_STANDALONE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief Result of parsing a caster response header.
+ */
+enum NtripHeaderStatus {
+    NTRIP_HEADER_INCOMPLETE = 0,    /**< Header terminator not received yet */
+    NTRIP_HEADER_OK,                /**< Complete ICY, SOURCETABLE or HTTP status header */
+    NTRIP_HEADER_INVALID            /**< Not an NTRIP or HTTP response */
+};
+
+/**
+ * @brief Parsed caster response header.
+ */
+struct NtripResponseHeader {
+    int statusCode;         /**< HTTP status code (200 for "ICY 200 OK" and "SOURCETABLE 200 OK") */
+    bool icy;               /**< NTRIP 1.0 "ICY 200 OK" stream response */
+    bool sourcetable;       /**< Caster answered with a sourcetable instead of a stream */
+    bool chunked;           /**< "Transfer-Encoding: chunked" (NTRIP 2.0 streams) */
+    size_t headerLength;    /**< Bytes up to and including the header terminator */
+};
+
+/**
+ * @brief Parse the response header sent by a caster after a GET request.
+ *
+ * Accepts "ICY 200 OK" (NTRIP 1.0), "SOURCETABLE 200 OK" and HTTP/1.x status
+ * lines with headers (NTRIP 2.0). The buffer may hold a partial header and
+ * bytes following the header; the caller keeps bytes after headerLength as
+ * stream data.
+ *
+ * @param buffer Received bytes (not required to be terminated).
+ * @param length Number of bytes in the buffer.
+ * @param header Receives the parsed header when NTRIP_HEADER_OK is returned.
+ * @return Parse status.
+ */
+NtripHeaderStatus parseNtripResponseHeader(const char* buffer, size_t length, NtripResponseHeader* header);
+
+/**
+ * @brief Format an NTRIP 2.0 GET request for a mountpoint.
+ * @param host Caster host name (Host header).
+ * @param mountpoint Mountpoint without leading '/' (empty for the sourcetable).
+ * @param authorization Base64 Basic token, or NULL/empty for no authentication.
+ * @param buffer Output buffer.
+ * @param size Output buffer size.
+ * @return Length of the request, or 0 if the buffer is too small.
+ */
+size_t ntripFormatRequest(const char* host, const char* mountpoint, const char* authorization,
+                          char* buffer, size_t size);
+
+/**
+ * @class NtripChunkDecoder
+ * @brief Removes HTTP/1.1 chunked transfer framing from an NTRIP 2.0 stream.
+ *
+ * Data is decoded in place as it arrives, in pieces of any size; chunk
+ * boundaries do not need to line up with reads.
+ */
+class NtripChunkDecoder {
+public:
+    NtripChunkDecoder();
+
+    /** @brief Start a new stream. */
+    void reset();
+
+    /**
+     * @brief Decode received bytes in place.
+     * @param data Received bytes; the payload is moved to the start of the buffer.
+     * @param length Number of received bytes.
+     * @return Number of payload bytes now at the start of the buffer.
+     */
+    size_t decode(uint8_t* data, size_t length);
+
+    /** @brief True after malformed framing; the connection should be dropped. */
+    bool hasError() const { return state == STATE_ERROR; }
+
+    /** @brief True after the terminating zero-length chunk. */
+    bool isFinished() const { return state == STATE_FINISHED; }
+
+private:
+    enum State {
+        STATE_SIZE,
+        STATE_EXTENSION,
+        STATE_SIZE_LF,
+        STATE_DATA,
+        STATE_DATA_CR,
+        STATE_DATA_LF,
+        STATE_TRAILER,
+        STATE_TRAILER_LF,
+        STATE_FINISHED,
+        STATE_ERROR
+    };
+
+    State state;
+    size_t remaining;
+    uint8_t sizeDigits;
+    bool trailerLineEmpty;
+};
+
+#endif // NTRIPRESPONSE_STANDALONE_H
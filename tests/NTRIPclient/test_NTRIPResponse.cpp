@@ -0,0 +1,192 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch.hpp"
+#include "NTRIPResponse_standalone.h"
+#include <string>
+#include <vector>
+#include <cstring>
+
+static NtripHeaderStatus parse(const std::string& response, NtripResponseHeader* header) {
+    return parseNtripResponseHeader(response.data(), response.size(), header);
+}
+
+// Encode a payload as chunks of the given size
+static std::string chunkEncode(const std::string& payload, size_t chunkSize, const char* extension = "") {
+    std::string out;
+    for (size_t i = 0; i < payload.size(); i += chunkSize) {
+        size_t n = payload.size() - i < chunkSize ? payload.size() - i : chunkSize;
+        char sizeLine[32];
+        snprintf(sizeLine, sizeof(sizeLine), "%zX%s\r\n", n, extension);
+        out += sizeLine;
+        out.append(payload, i, n);
+        out += "\r\n";
+    }
+    out += "0\r\n\r\n";
+    return out;
+}
+
+// Binary payload with CR/LF and hex digit bytes that must not confuse the decoder
+static std::string makePayload(size_t length) {
+    std::string payload;
+    for (size_t i = 0; i < length; i++) {
+        payload += (char)((i * 37 + 11) & 0xFF);
+    }
+    payload += "\r\n0\r\n\r\n";
+    return payload;
+}
+
+TEST_CASE("Response header - NTRIP 1.0 ICY response", "[NTRIPResponse]") {
+    NtripResponseHeader header;
+
+    SECTION("Status line only") {
+        REQUIRE(parse("ICY 200 OK\r\n\xD3\x00\x13", &header) == NTRIP_HEADER_OK);
+        REQUIRE(header.statusCode == 200);
+        REQUIRE(header.icy);
+        REQUIRE_FALSE(header.chunked);
+        REQUIRE(header.headerLength == 12);
+    }
+
+    SECTION("Status line followed by a blank line") {
+        REQUIRE(parse("ICY 200 OK\r\n\r\n\xD3", &header) == NTRIP_HEADER_OK);
+        REQUIRE(header.headerLength == 14);
+    }
+
+    SECTION("Wait for the byte after a CR") {
+        REQUIRE(parse("ICY 200 OK\r\n\r", &header) == NTRIP_HEADER_INCOMPLETE);
+    }
+
+    SECTION("Partial status line") {
+        REQUIRE(parse("IC", &header) == NTRIP_HEADER_INCOMPLETE);
+        REQUIRE(parse("ICY 200 OK", &header) == NTRIP_HEADER_INCOMPLETE);
+        REQUIRE(parse("", &header) == NTRIP_HEADER_INCOMPLETE);
+    }
+}
+
+TEST_CASE("Response header - NTRIP 2.0 HTTP response", "[NTRIPResponse]") {
+    NtripResponseHeader header;
+    std::string response = "HTTP/1.1 200 OK\r\n"
+                           "Ntrip-Version: Ntrip/2.0\r\n"
+                           "content-type: gnss/data\r\n"
+                           "TRANSFER-ENCODING: Chunked\r\n"
+                           "\r\n";
+
+    REQUIRE(parse(response + "13\r\n", &header) == NTRIP_HEADER_OK);
+    REQUIRE(header.statusCode == 200);
+    REQUIRE_FALSE(header.icy);
+    REQUIRE_FALSE(header.sourcetable);
+    REQUIRE(header.chunked);
+    REQUIRE(header.headerLength == response.size());
+
+    // Every shorter prefix is incomplete
+    for (size_t n = 0; n < response.size(); n++) {
+        REQUIRE(parse(response.substr(0, n), &header) == NTRIP_HEADER_INCOMPLETE);
+    }
+}
+
+TEST_CASE("Response header - Errors and sourcetables", "[NTRIPResponse]") {
+    NtripResponseHeader header;
+
+    REQUIRE(parse("HTTP/1.1 401 Unauthorized\r\nWWW-Authenticate: Basic realm=\"x\"\r\n\r\n", &header) == NTRIP_HEADER_OK);
+    REQUIRE(header.statusCode == 401);
+
+    REQUIRE(parse("SOURCETABLE 200 OK\r\nContent-Length: 0\r\n\r\n", &header) == NTRIP_HEADER_OK);
+    REQUIRE(header.statusCode == 200);
+    REQUIRE(header.sourcetable);
+
+    REQUIRE(parse("HTTP/1.1 200 OK\r\nContent-Type: gnss/sourcetable\r\n\r\nSTR;", &header) == NTRIP_HEADER_OK);
+    REQUIRE(header.sourcetable);
+
+    REQUIRE(parse("SSH-2.0-OpenSSH\r\n", &header) == NTRIP_HEADER_INVALID);
+    REQUIRE(parse("HTTP/1.1 OK\r\n\r\n", &header) == NTRIP_HEADER_INVALID);
+    REQUIRE(parseNtripResponseHeader(NULL, 0, &header) == NTRIP_HEADER_INVALID);
+}
+
+TEST_CASE("Request - NTRIP 2.0 GET with authentication", "[NTRIPResponse]") {
+    char buffer[512];
+    size_t length = ntripFormatRequest("caster.example.com", "MOUNT1", "dXNlcjpwYXNz", buffer, sizeof(buffer));
+    std::string request(buffer, length);
+
+    REQUIRE(length == strlen(buffer));
+    REQUIRE(request.find("GET /MOUNT1 HTTP/1.1\r\n") == 0);
+    REQUIRE(request.find("Host: caster.example.com\r\n") != std::string::npos);
+    REQUIRE(request.find("Ntrip-Version: Ntrip/2.0\r\n") != std::string::npos);
+    REQUIRE(request.find("Authorization: Basic dXNlcjpwYXNz\r\n") != std::string::npos);
+    REQUIRE(request.substr(request.size() - 4) == "\r\n\r\n");
+
+    // No authorization header without credentials
+    length = ntripFormatRequest("caster.example.com", "MOUNT1", "", buffer, sizeof(buffer));
+    REQUIRE(std::string(buffer, length).find("Authorization") == std::string::npos);
+
+    // Buffer too small
+    REQUIRE(ntripFormatRequest("caster.example.com", "MOUNT1", NULL, buffer, 32) == 0);
+}
+
+TEST_CASE("Chunk decoder - Payload is restored for any read size", "[NTRIPResponse]") {
+    std::string payload = makePayload(1500);
+    const size_t chunkSizes[] = {1, 7, 256, 4096};
+    const size_t readSizes[] = {1, 2, 3, 5, 13, 64, 1024, 8192};
+
+    for (size_t c = 0; c < 4; c++) {
+        std::string encoded = chunkEncode(payload, chunkSizes[c]);
+        for (size_t r = 0; r < 8; r++) {
+            NtripChunkDecoder decoder;
+            std::string decoded;
+            for (size_t i = 0; i < encoded.size(); i += readSizes[r]) {
+                std::vector<uint8_t> read(encoded.begin() + i,
+                                          encoded.begin() + std::min(encoded.size(), i + readSizes[r]));
+                size_t n = decoder.decode(read.data(), read.size());
+                decoded.append((const char*)read.data(), n);
+                REQUIRE_FALSE(decoder.hasError());
+            }
+            REQUIRE(decoder.isFinished());
+            REQUIRE(decoded == payload);
+        }
+    }
+}
+
+TEST_CASE("Chunk decoder - Extensions and trailers", "[NTRIPResponse]") {
+    std::string encoded = chunkEncode("RTCM", 2, ";name=value");
+    encoded.resize(encoded.size() - 2);
+    encoded += "Trailer: x\r\n\r\n";
+
+    NtripChunkDecoder decoder;
+    std::vector<uint8_t> data(encoded.begin(), encoded.end());
+    size_t n = decoder.decode(data.data(), data.size());
+    REQUIRE(std::string((const char*)data.data(), n) == "RTCM");
+    REQUIRE(decoder.isFinished());
+
+    // Lower case hex size
+    std::string lower = "a\r\n0123456789\r\n";
+    NtripChunkDecoder decoder2;
+    std::vector<uint8_t> data2(lower.begin(), lower.end());
+    REQUIRE(decoder2.decode(data2.data(), data2.size()) == 10);
+    REQUIRE_FALSE(decoder2.isFinished());
+}
+
+TEST_CASE("Chunk decoder - Malformed framing is reported", "[NTRIPResponse]") {
+    const char* malformed[] = {
+        "G\r\n",                    // not a hex digit
+        "\r\n",                     // empty size
+        "123456789\r\n",            // size does not fit 32 bits
+        "2\r\nABX\r\n",             // missing CR after the data
+        "2\r\nAB\rX",               // missing LF after the data
+        "2\rX",                     // missing LF after the size
+    };
+    for (size_t i = 0; i < sizeof(malformed) / sizeof(malformed[0]); i++) {
+        NtripChunkDecoder decoder;
+        std::vector<uint8_t> data(malformed[i], malformed[i] + strlen(malformed[i]));
+        decoder.decode(data.data(), data.size());
+        REQUIRE(decoder.hasError());
+        REQUIRE_FALSE(decoder.isFinished());
+    }
+
+    // reset() starts a new stream
+    NtripChunkDecoder decoder;
+    uint8_t bad[] = {'X'};
+    decoder.decode(bad, 1);
+    REQUIRE(decoder.hasError());
+    decoder.reset();
+    std::string good = "1\r\nA\r\n";
+    std::vector<uint8_t> data(good.begin(), good.end());
+    REQUIRE(decoder.decode(data.data(), data.size()) == 1);
+    REQUIRE_FALSE(decoder.hasError());
+}
@@ -0,0 +1,213 @@
+#!/usr/bin/env python3
+"""Local NTRIP caster over TLS for testing the firmware TLS transport.
+
+Serves one mountpoint with synthetic RTCM 1005 frames once per second, as an
+NTRIP 1.0 ("ICY 200 OK") or NTRIP 2.0 (chunked) stream depending on the
+request. Every connection logs whether the TLS session was resumed, so the
+firmware reconnect behaviour can be checked next to the handshake counters in
+/api/status.
+
+A CA and server certificate are created with openssl in the working directory
+on first start. Upload ca.pem through the web interface (NTRIP CA
+Certificate) so the device accepts the server certificate.
+
+Usage:
+    python3 tls_caster_standin.py --host 192.168.1.10 [--port 8443]
+    python3 tls_caster_standin.py --selftest
+"""
+
+import argparse
+import base64
+import os
+import socket
+import ssl
+import struct
+import subprocess
+import sys
+import threading
+import time
+
+MOUNTPOINT = "TEST"
+
+
+def crc24q(data):
+    crc = 0
+    for byte in data:
+        crc ^= byte << 16
+        for _ in range(8):
+            crc <<= 1
+            if crc & 0x1000000:
+                crc ^= 0x1864CFB
+    return crc & 0xFFFFFF
+
+
+def rtcm_frame(message_type, body):
+    """Frame a message body: preamble, 10-bit length, payload and CRC-24Q."""
+    payload = struct.pack(">H", message_type << 4) + body
+    header = bytes([0xD3, (len(payload) >> 8) & 0x03, len(payload) & 0xFF])
+    crc = crc24q(header + payload)
+    return header + payload + crc.to_bytes(3, "big")
+
+
+def make_certificates(directory, host):
+    ca_key = os.path.join(directory, "ca.key")
+    ca_pem = os.path.join(directory, "ca.pem")
+    key = os.path.join(directory, "server.key")
+    csr = os.path.join(directory, "server.csr")
+    pem = os.path.join(directory, "server.pem")
+    ext = os.path.join(directory, "server.ext")
+    if os.path.exists(ca_pem) and os.path.exists(pem):
+        return ca_pem, pem, key
+
+    def openssl(*args):
+        subprocess.run(["openssl"] + list(args), check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+
+    openssl("req", "-x509", "-newkey", "ec", "-pkeyopt", "ec_paramgen_curve:prime256v1", "-nodes",
+            "-keyout", ca_key, "-out", ca_pem, "-days", "3650", "-subj", "/CN=NTRIP test CA")
+    openssl("req", "-newkey", "ec", "-pkeyopt", "ec_paramgen_curve:prime256v1", "-nodes",
+            "-keyout", key, "-out", csr, "-subj", "/CN=" + host)
+    kind = "IP" if host.replace(".", "").isdigit() else "DNS"
+    with open(ext, "w") as f:
+        f.write("subjectAltName=%s:%s\n" % (kind, host))
+    openssl("x509", "-req", "-in", csr, "-CA", ca_pem, "-CAkey", ca_key, "-CAcreateserial",
+            "-out", pem, "-days", "3650", "-extfile", ext)
+    return ca_pem, pem, key
+
+
+def server_context(cert, key):
+    context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+    # The firmware runs TLS 1.2 (TLS 1.3 is not enabled in sdkconfig)
+    context.maximum_version = ssl.TLSVersion.TLSv1_2
+    context.load_cert_chain(cert, key)
+    return context
+
+
+def handle_client(connection, address, credentials):
+    try:
+        request = b""
+        while b"\r\n\r\n" not in request:
+            data = connection.recv(1024)
+            if not data:
+                return
+            request += data
+        lines = request.split(b"\r\n")
+        path = lines[0].split(b" ")[1].decode().lstrip("/")
+        headers = {}
+        for line in lines[1:]:
+            if b":" in line:
+                name, value = line.split(b":", 1)
+                headers[name.strip().lower()] = value.strip()
+        ntrip2 = headers.get(b"ntrip-version", b"").lower() == b"ntrip/2.0"
+        print("%s: GET /%s %s, session %s" % (address[0], path, "NTRIP 2.0" if ntrip2 else "NTRIP 1.0",
+                                              "resumed" if connection.session_reused else "new"))
+
+        if credentials:
+            token = base64.b64encode(credentials.encode()).decode()
+            if headers.get(b"authorization", b"").decode() != "Basic " + token:
+                connection.sendall(b"HTTP/1.1 401 Unauthorized\r\nWWW-Authenticate: Basic realm=\"/" +
+                                   MOUNTPOINT.encode() + b"\"\r\n\r\n")
+                return
+        if path != MOUNTPOINT:
+            table = "STR;%s;%s;RTCM 3.3;1005(1);2;GPS;TEST;NLD;52.0;6.0;1;0;standin;none;B;N;0;\r\n" % (MOUNTPOINT, MOUNTPOINT)
+            table += "ENDSOURCETABLE\r\n"
+            connection.sendall(("SOURCETABLE 200 OK\r\nContent-Length: %d\r\n\r\n%s" % (len(table), table)).encode())
+            return
+
+        if ntrip2:
+            connection.sendall(b"HTTP/1.1 200 OK\r\nNtrip-Version: Ntrip/2.0\r\n"
+                               b"Content-Type: gnss/data\r\nTransfer-Encoding: chunked\r\n\r\n")
+        else:
+            connection.sendall(b"ICY 200 OK\r\n")
+
+        # Reference station 1005 with a fixed ECEF position
+        body = bytes(range(1, 18))
+        while True:
+            frame = rtcm_frame(1005, body)
+            if ntrip2:
+                frame = b"%X\r\n" % len(frame) + frame + b"\r\n"
+            connection.sendall(frame)
+            time.sleep(1.0)
+    except (OSError, ssl.SSLError) as e:
+        print("%s: closed (%s)" % (address[0], e))
+    finally:
+        connection.close()
+
+
+def serve(args):
+    ca_pem, cert, key = make_certificates(args.dir, args.host)
+    context = server_context(cert, key)
+    listener = socket.create_server(("", args.port))
+    print("TLS caster on port %d, mountpoint /%s, CA certificate: %s" % (args.port, MOUNTPOINT, ca_pem))
+    while True:
+        client, address = listener.accept()
+        try:
+            connection = context.wrap_socket(client, server_side=True)
+        except (OSError, ssl.SSLError) as e:
+            print("%s: handshake failed (%s)" % (address[0], e))
+            client.close()
+            continue
+        threading.Thread(target=handle_client, args=(connection, address, args.credentials), daemon=True).start()
+
+
+def selftest(args):
+    """Connect repeatedly with session reuse and compare handshake times."""
+    ca_pem, cert, key = make_certificates(args.dir, "localhost")
+    context = server_context(cert, key)
+    listener = socket.create_server(("localhost", 0))
+    port = listener.getsockname()[1]
+    threading.Thread(target=lambda: serve_selftest(listener, context), daemon=True).start()
+
+    client_context = ssl.create_default_context(cafile=ca_pem)
+    client_context.maximum_version = ssl.TLSVersion.TLSv1_2
+    session = None
+    times = {"full": [], "resumed": []}
+    for _ in range(args.rounds):
+        start = time.perf_counter()
+        sock = socket.create_connection(("localhost", port))
+        connection = client_context.wrap_socket(sock, server_hostname="localhost", session=session)
+        elapsed = (time.perf_counter() - start) * 1000.0
+        times["resumed" if connection.session_reused else "full"].append(elapsed)
+        connection.sendall(b"GET /" + MOUNTPOINT.encode() + b" HTTP/1.1\r\nNtrip-Version: Ntrip/2.0\r\n\r\n")
+        response = connection.recv(256)
+        assert response.startswith(b"HTTP/1.1 200 OK"), response
+        session = connection.session
+        connection.close()
+
+    for kind in ("full", "resumed"):
+        values = times[kind]
+        if values:
+            print("%-8s %3d handshakes, average %.2f ms" % (kind, len(values), sum(values) / len(values)))
+    if len(times["full"]) != 1 or len(times["resumed"]) != args.rounds - 1:
+        print("FAILED: expected 1 full and %d resumed handshakes" % (args.rounds - 1))
+        return 1
+    print("OK")
+    return 0
+
+
+def serve_selftest(listener, context):
+    while True:
+        client, address = listener.accept()
+        connection = context.wrap_socket(client, server_side=True)
+        request = connection.recv(1024)
+        if b"Ntrip-Version" in request:
+            connection.sendall(b"HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n")
+        connection.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="NTRIP caster over TLS for firmware testing")
+    parser.add_argument("--host", default="localhost", help="address the device connects to (certificate name)")
+    parser.add_argument("--port", type=int, default=8443)
+    parser.add_argument("--credentials", default="", help="require user:password")
+    parser.add_argument("--dir", default=".", help="directory for the generated certificates")
+    parser.add_argument("--selftest", action="store_true", help="compare full and resumed handshakes locally")
+    parser.add_argument("--rounds", type=int, default=20)
+    args = parser.parse_args()
+    if args.selftest:
+        return selftest(args)
+    serve(args)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,212 @@
+// Standalone build for OpenMetrics writer tests using Code::Blocks
+// This file contains a copy of the OpenMetricsWriter implementation for standalone compilation
+
+#include <cstdint>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+#include "OpenMetricsWriter_standalone.h"
+#include "../JSONwriter/JsonWriter_standalone.h"
+
+static const char* const TYPE_NAMES[] = {
+    "counter", "gauge", "histogram", "gaugehistogram"
+};
+
+OpenMetricsWriter::OpenMetricsWriter(char* buffer, size_t size, OpenMetricsFlush flush, void* context)
+    : buffer(buffer), capacity(size), used(0), flushed(0), flushFunction(flush), context(context),
+      failed(buffer == NULL || size == 0 || flush == NULL), familyName(""), familyType(OPENMETRICS_GAUGE),
+      inSample(false), hasLabels(false) {
+}
+
+void OpenMetricsWriter::flushBuffer() {
+    if (used > 0 && !failed) {
+        if (flushFunction(buffer, used, context)) {
+            flushed += used;
+        } else {
+            failed = true;
+        }
+    }
+    used = 0;
+}
+
+void OpenMetricsWriter::append(const char* text, size_t length) {
+    while (length > 0 && !failed) {
+        if (used == capacity) {
+            flushBuffer();
+            continue;
+        }
+        size_t n = capacity - used < length ? capacity - used : length;
+        memcpy(buffer + used, text, n);
+        used += n;
+        text += n;
+        length -= n;
+    }
+}
+
+void OpenMetricsWriter::appendString(const char* text) {
+    append(text, strlen(text));
+}
+
+void OpenMetricsWriter::appendEscaped(const char* text, bool quote) {
+    // Runs without special characters are copied in one piece
+    const char* run = text;
+    for (const char* c = text; *c != '\0'; c++) {
+        const char* escape = NULL;
+        if (*c == '\\') {
+            escape = "\\\\";
+        } else if (*c == '\n') {
+            escape = "\\n";
+        } else if (*c == '"' && quote) {
+            escape = "\\\"";
+        }
+        if (escape != NULL) {
+            append(run, (size_t)(c - run));
+            append(escape, 2);
+            run = c + 1;
+        }
+    }
+    appendString(run);
+}
+
+void OpenMetricsWriter::appendUInt(uint64_t value) {
+    char text[24];
+    char* end = text + sizeof(text);
+    char* start = end;
+    // 64-bit division is a library call on the ESP32, use 32 bits when possible
+    while (value > 0xFFFFFFFFu) {
+        *--start = (char)('0' + (value % 10));
+        value /= 10;
+    }
+    uint32_t small = (uint32_t)value;
+    do {
+        *--start = (char)('0' + (small % 10));
+        small /= 10;
+    } while (small != 0);
+    append(start, (size_t)(end - start));
+}
+
+void OpenMetricsWriter::appendFixed(double value, uint8_t decimals) {
+    if (isnan(value)) {
+        appendString("NaN");
+        return;
+    }
+    if (isinf(value)) {
+        appendString(value > 0 ? "+Inf" : "-Inf");
+        return;
+    }
+    char text[48];
+    size_t length = formatFixed(value, decimals, text, sizeof(text));
+    if (length >= sizeof(text)) {
+        // Far beyond any statistic of this device
+        appendString(value > 0 ? "+Inf" : "-Inf");
+        return;
+    }
+    // "-0.00" is valid but odd in a scrape
+    if (text[0] == '-' && strspn(text + 1, "0.") == length - 1) {
+        append(text + 1, length - 1);
+    } else {
+        append(text, length);
+    }
+}
+
+void OpenMetricsWriter::family(const char* name, OpenMetricsType type, const char* unit, const char* help) {
+    familyName = name;
+    familyType = type;
+    appendString("# TYPE ");
+    appendString(name);
+    append(" ", 1);
+    appendString(TYPE_NAMES[type]);
+    append("\n", 1);
+    if (unit != NULL) {
+        appendString("# UNIT ");
+        appendString(name);
+        append(" ", 1);
+        appendString(unit);
+        append("\n", 1);
+    }
+    if (help != NULL) {
+        appendString("# HELP ");
+        appendString(name);
+        append(" ", 1);
+        appendEscaped(help, false);
+        append("\n", 1);
+    }
+}
+
+void OpenMetricsWriter::sample(const char* suffix) {
+    appendString(familyName);
+    appendString(suffix);
+    inSample = true;
+    hasLabels = false;
+}
+
+void OpenMetricsWriter::beginLabel(const char* name) {
+    if (!inSample) {
+        sample(familyType == OPENMETRICS_COUNTER ? "_total" : "");
+    }
+    append(hasLabels ? "," : "{", 1);
+    hasLabels = true;
+    appendString(name);
+    append("=\"", 2);
+}
+
+void OpenMetricsWriter::label(const char* name, const char* value) {
+    beginLabel(name);
+    appendEscaped(value, true);
+    append("\"", 1);
+}
+
+void OpenMetricsWriter::label(const char* name, uint32_t value) {
+    beginLabel(name);
+    appendUInt(value);
+    append("\"", 1);
+}
+
+void OpenMetricsWriter::labelFixed(const char* name, double value, uint8_t decimals) {
+    beginLabel(name);
+    appendFixed(value, decimals);
+    append("\"", 1);
+}
+
+// Close the label set and start the value
+void OpenMetricsWriter::endSample() {
+    if (!inSample) {
+        sample(familyType == OPENMETRICS_COUNTER ? "_total" : "");
+    }
+    if (hasLabels) {
+        append("}", 1);
+    }
+    append(" ", 1);
+    inSample = false;
+    hasLabels = false;
+}
+
+void OpenMetricsWriter::valueUInt(uint64_t value) {
+    endSample();
+    appendUInt(value);
+    append("\n", 1);
+}
+
+void OpenMetricsWriter::valueInt(int64_t value) {
+    endSample();
+    if (value < 0) {
+        append("-", 1);
+        appendUInt((uint64_t)0 - (uint64_t)value);
+    } else {
+        appendUInt((uint64_t)value);
+    }
+    append("\n", 1);
+}
+
+void OpenMetricsWriter::valueFixed(double value, uint8_t decimals) {
+    endSample();
+    appendFixed(value, decimals);
+    append("\n", 1);
+}
+
+bool OpenMetricsWriter::finish() {
+    appendString("# EOF\n");
+    flushBuffer();
+    return !failed;
+}
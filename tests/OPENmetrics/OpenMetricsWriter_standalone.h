@@ -0,0 +1,147 @@
+/*!
+ * \file OpenMetricsWriter.h
+ * \brief Streaming writer of the OpenMetrics text format.
+ *
+ * Writes metric families for a Prometheus scrape into a small caller
+ * supplied buffer and passes the buffer to a flush function whenever it is
+ * full, so a response of any size is sent in chunks without being built in
+ * RAM:
+ *
+ *     # TYPE ntrip_client_rtcm_received_bytes counter
+ *     # UNIT ntrip_client_rtcm_received_bytes bytes
+ *     # HELP ntrip_client_rtcm_received_bytes RTCM bytes received since boot.
+ *     ntrip_client_rtcm_received_bytes_total 1234567
+ *
+ * A family is started with family(); each sample is then written in order
+ * with an optional suffix (sample()), labels (label()) and a value, which
+ * ends the sample. Counter samples get the suffix `_total` unless another
+ * one is given. Histograms are written by the caller as `_bucket` samples
+ * with an `le` label, ending with `le="+Inf"`, and `_count` (`_gcount` for
+ * gauge histograms).
+ *
+ * Names must already be valid metric and label names; label values and help
+ * texts are escaped. Numbers are converted without printf where possible
+ * (formatFixed() of lib/JsonWriter); NaN and infinities are written as
+ * `NaN`, `+Inf` and `-Inf`.
+ *
+ * When the flush function fails, the rest of the output is dropped and
+ * finish() returns false.
+ *
+ * No ESP-IDF dependencies; the writer is plain C++11.
+ */
+
+#ifndef OPEN_METRICS_WRITER_STANDALONE_H
+#define OPEN_METRICS_WRITER_STANDALONE_H
+
+#include <cstdint>
+#include <stddef.h>
+
+/**
+ * \brief Metric types of a family.
+ */
+enum OpenMetricsType {
+    OPENMETRICS_COUNTER = 0,
+    OPENMETRICS_GAUGE,
+    OPENMETRICS_HISTOGRAM,
+    OPENMETRICS_GAUGE_HISTOGRAM
+};
+
+/**
+ * \brief Receives the output in chunks.
+ * \param[in] data Output.
+ * \param[in] length Bytes of output, at least 1.
+ * \param[in] context Context given to the writer.
+ * \return false to stop the output.
+ */
+typedef bool (*OpenMetricsFlush)(const char* data, size_t length, void* context);
+
+class OpenMetricsWriter {
+public:
+    /**
+     * \param[in] buffer Chunk buffer.
+     * \param[in] size Size of the chunk buffer, at least 64 bytes for sensible chunks.
+     * \param[in] flush Receives every full chunk and the last one.
+     * \param[in] context Passed to flush.
+     */
+    OpenMetricsWriter(char* buffer, size_t size, OpenMetricsFlush flush, void* context);
+
+    /**
+     * \brief Start a metric family.
+     * \param[in] name Family name, without `_total` for a counter; kept until the next family.
+     * \param[in] type Metric type.
+     * \param[in] unit Unit the name ends with (e.g. "seconds"), or NULL.
+     * \param[in] help Description, or NULL.
+     */
+    void family(const char* name, OpenMetricsType type, const char* unit, const char* help);
+
+    /**
+     * \brief Start a sample with a suffix to the family name.
+     * \param[in] suffix Suffix such as "_bucket" or "_count"; "" for none.
+     *
+     * Only needed for histograms and to override the counter `_total`.
+     */
+    void sample(const char* suffix);
+
+    /** \brief Add a label to the current sample. */
+    void label(const char* name, const char* value);
+
+    /** \brief Add a label with an integer value to the current sample. */
+    void label(const char* name, uint32_t value);
+
+    /**
+     * \brief Add a label with a number, such as `le` or `quantile`.
+     * \param[in] name Label name.
+     * \param[in] value Value; infinity gives "+Inf".
+     * \param[in] decimals Decimals written (0-9).
+     */
+    void labelFixed(const char* name, double value, uint8_t decimals);
+
+    /** \brief End the current sample with an unsigned value. */
+    void valueUInt(uint64_t value);
+
+    /** \brief End the current sample with a signed value. */
+    void valueInt(int64_t value);
+
+    /**
+     * \brief End the current sample with a number of fixed decimals.
+     * \param[in] value Value; NaN and infinities are allowed.
+     * \param[in] decimals Decimals written (0-9).
+     */
+    void valueFixed(double value, uint8_t decimals);
+
+    /**
+     * \brief Write `# EOF` and flush the last chunk.
+     * \return true when all output was accepted by the flush function.
+     */
+    bool finish();
+
+    /** \brief The flush function refused output. */
+    bool hasFailed() const { return failed; }
+
+    /** \brief Bytes passed to the flush function. */
+    size_t getFlushed() const { return flushed; }
+
+private:
+    void append(const char* text, size_t length);
+    void appendString(const char* text);
+    void appendEscaped(const char* text, bool quote);
+    void appendUInt(uint64_t value);
+    void appendFixed(double value, uint8_t decimals);
+    void beginLabel(const char* name);
+    void endSample();
+    void flushBuffer();
+
+    char* buffer;
+    size_t capacity;
+    size_t used;
+    size_t flushed;
+    OpenMetricsFlush flushFunction;
+    void* context;
+    bool failed;
+    const char* familyName;
+    OpenMetricsType familyType;
+    bool inSample;          // Name of the current sample written
+    bool hasLabels;         // Label set of the current sample open
+};
+
+#endif // OPEN_METRICS_WRITER_STANDALONE_H
@@ -0,0 +1,593 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch.hpp"
+#include "OpenMetricsWriter_standalone.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <set>
+#include <string>
+#include <vector>
+
+// Collects the chunks of a writer
+struct Output {
+    std::string text;
+    std::vector<size_t> chunks;
+    size_t failAfter = (size_t)-1;     // Refuse the chunk after this many
+};
+
+static bool collect(const char* data, size_t length, void* context) {
+    Output* output = (Output*)context;
+    if (output->chunks.size() >= output->failAfter) {
+        return false;
+    }
+    output->text.append(data, length);
+    output->chunks.push_back(length);
+    return true;
+}
+
+static std::vector<std::string> lines(const std::string& text) {
+    std::vector<std::string> result;
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        result.push_back(text.substr(start, end - start));
+        start = end + 1;
+    }
+    return result;
+}
+
+static bool isNameChar(char c, bool first) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == ':' ||
+           (!first && c >= '0' && c <= '9');
+}
+
+static bool validName(const std::string& name) {
+    if (name.empty()) {
+        return false;
+    }
+    for (size_t i = 0; i < name.size(); i++) {
+        if (!isNameChar(name[i], i == 0)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+static bool validNumber(const std::string& text) {
+    if (text == "NaN" || text == "+Inf" || text == "-Inf") {
+        return true;
+    }
+    char* end = NULL;
+    strtod(text.c_str(), &end);
+    return !text.empty() && *end == '\0';
+}
+
+/**
+ * Checks an exposition against the OpenMetrics text format as used here:
+ * metadata before the samples of a family, each family once, sample names
+ * with the suffixes of the type, label sets, numbers and the final # EOF.
+ * Returns an empty string or the first problem.
+ */
+static std::string checkExposition(const std::string& text, size_t* families = NULL, size_t* samples = NULL) {
+    std::vector<std::string> all = lines(text);
+    if (text.empty() || text.back() != '\n' || all.empty() || all.back() != "# EOF") {
+        return "no # EOF at the end";
+    }
+    std::set<std::string> seen;
+    std::string family;
+    std::string type;
+    std::string unit;
+    size_t sampleCount = 0;
+    for (size_t n = 0; n + 1 < all.size(); n++) {
+        const std::string& line = all[n];
+        if (line.compare(0, 2, "# ") == 0) {
+            size_t space = line.find(' ', 2);
+            size_t nameEnd = line.find(' ', space + 1);
+            if (space == std::string::npos || nameEnd == std::string::npos) {
+                return "bad metadata: " + line;
+            }
+            std::string keyword = line.substr(2, space - 2);
+            std::string name = line.substr(space + 1, nameEnd - space - 1);
+            std::string value = line.substr(nameEnd + 1);
+            if (keyword == "TYPE") {
+                if (!validName(name) || seen.count(name) != 0) {
+                    return "bad or repeated family: " + line;
+                }
+                if (value != "counter" && value != "gauge" && value != "histogram" && value != "gaugehistogram") {
+                    return "bad type: " + line;
+                }
+                seen.insert(name);
+                family = name;
+                type = value;
+                unit.clear();
+            } else if (keyword == "UNIT") {
+                if (name != family || !endsWith(name, "_" + value)) {
+                    return "bad unit: " + line;
+                }
+                unit = value;
+            } else if (keyword == "HELP") {
+                if (name != family) {
+                    return "help of another family: " + line;
+                }
+            } else {
+                return "unknown metadata: " + line;
+            }
+            continue;
+        }
+
+        // Sample: name, optional {labels}, space, value
+        size_t nameEnd = 0;
+        while (nameEnd < line.size() && isNameChar(line[nameEnd], nameEnd == 0)) {
+            nameEnd++;
+        }
+        std::string name = line.substr(0, nameEnd);
+        std::string suffix = name.compare(0, family.size(), family) == 0 ? name.substr(family.size()) : "?";
+        bool suffixOk = false;
+        if (type == "counter") {
+            suffixOk = (suffix == "_total" || suffix == "_created");
+        } else if (type == "gauge") {
+            suffixOk = suffix.empty();
+        } else if (type == "histogram") {
+            suffixOk = (suffix == "_bucket" || suffix == "_count" || suffix == "_sum");
+        } else if (type == "gaugehistogram") {
+            suffixOk = (suffix == "_bucket" || suffix == "_gcount" || suffix == "_gsum");
+        }
+        if (family.empty() || !suffixOk) {
+            return "sample outside its family: " + line;
+        }
+        size_t pos = nameEnd;
+        bool hasLe = false;
+        if (pos < line.size() && line[pos] == '{') {
+            pos++;
+            while (true) {
+                size_t labelEnd = pos;
+                while (labelEnd < line.size() && isNameChar(line[labelEnd], labelEnd == pos)) {
+                    labelEnd++;
+                }
+                if (labelEnd == pos || line.compare(labelEnd, 2, "=\"") != 0) {
+                    return "bad label: " + line;
+                }
+                hasLe = hasLe || line.substr(pos, labelEnd - pos) == "le";
+                pos = labelEnd + 2;
+                while (pos < line.size() && line[pos] != '"') {
+                    if (line[pos] == '\\') {
+                        if (pos + 1 >= line.size() || strchr("\\\"n", line[pos + 1]) == NULL) {
+                            return "bad escape: " + line;
+                        }
+                        pos++;
+                    }
+                    pos++;
+                }
+                if (pos >= line.size()) {
+                    return "open label value: " + line;
+                }
+                pos++;
+                if (pos < line.size() && line[pos] == ',') {
+                    pos++;
+                    continue;
+                }
+                if (pos < line.size() && line[pos] == '}') {
+                    pos++;
+                    break;
+                }
+                return "bad label set: " + line;
+            }
+        }
+        if (suffix == "_bucket" && !hasLe) {
+            return "bucket without le: " + line;
+        }
+        if (pos >= line.size() || line[pos] != ' ' || !validNumber(line.substr(pos + 1))) {
+            return "bad value: " + line;
+        }
+        sampleCount++;
+    }
+    if (families != NULL) {
+        *families = seen.size();
+    }
+    if (samples != NULL) {
+        *samples = sampleCount;
+    }
+    return "";
+}
+
+// An exposition with every kind of family, like statistics_write_openmetrics()
+static void writeExample(OpenMetricsWriter& out, uint32_t seed) {
+    out.family("ntrip_client_uptime_seconds", OPENMETRICS_GAUGE, "seconds", "Time since boot.");
+    out.valueUInt(3600 + seed);
+    out.family("ntrip_client_rtcm_received_bytes", OPENMETRICS_COUNTER, "bytes", "RTCM bytes received since boot.");
+    out.valueUInt(12345678901ull + seed);
+    static const char* const constellations[4] = {"gps", "glonass", "galileo", "beidou"};
+    out.family("ntrip_client_rtcm_msm_messages", OPENMETRICS_COUNTER, NULL, "MSM messages per constellation.");
+    for (int i = 0; i < 4; i++) {
+        out.label("constellation", constellations[i]);
+        out.valueUInt(1000u * (i + 1) + seed);
+    }
+    out.family("ntrip_client_fix_quality_seconds", OPENMETRICS_COUNTER, "seconds", "Time in each GGA fix quality.");
+    for (uint32_t q = 0; q < 9; q++) {
+        out.label("quality", q);
+        out.valueUInt(q * 10 + seed);
+    }
+    out.family("ntrip_client_gga_saved_bytes", OPENMETRICS_GAUGE, "bytes", "GGA uplink bytes saved.");
+    out.valueInt(-(int64_t)seed - 12);
+    out.family("ntrip_client_hdop", OPENMETRICS_GAUGE, NULL, "Current HDOP.");
+    out.valueFixed(0.8 + seed / 100.0, 2);
+    out.family("ntrip_client_period_position_std_meters", OPENMETRICS_GAUGE, "meters", "Standard deviation of the positions.");
+    out.label("axis", "east");
+    out.valueFixed(0.0061, 4);
+    out.label("axis", "north");
+    out.valueFixed(0.0083, 4);
+    out.family("ntrip_client_hdop_quantiles", OPENMETRICS_GAUGE, NULL, "Quantiles of the completed periods.");
+    static const double levels[4] = {0.10, 0.50, 0.90, 0.99};
+    for (int q = 0; q < 4; q++) {
+        out.labelFixed("quantile", levels[q], 2);
+        out.valueFixed(0.7 + q * 0.1, 2);
+    }
+    out.family("ntrip_client_hdop_distribution", OPENMETRICS_HISTOGRAM, NULL, "Samples of the completed periods.");
+    uint32_t cumulative = 0;
+    for (int b = 0; b < 16; b++) {
+        cumulative += 10 + b;
+        out.sample("_bucket");
+        out.labelFixed("le", 0.5 + b * 0.08, 2);
+        out.valueUInt(cumulative);
+    }
+    out.sample("_bucket");
+    out.labelFixed("le", INFINITY, 0);
+    out.valueUInt(cumulative + 3);
+    out.sample("_count");
+    out.valueUInt(cumulative + 3);
+    out.family("ntrip_client_period_wifi_rssi_dbm_distribution", OPENMETRICS_GAUGE_HISTOGRAM, NULL, "Samples of this period.");
+    out.sample("_bucket");
+    out.labelFixed("le", -72, 0);
+    out.valueUInt(5);
+    out.sample("_bucket");
+    out.labelFixed("le", -64, 0);
+    out.valueUInt(60);
+    out.sample("_bucket");
+    out.labelFixed("le", INFINITY, 0);
+    out.valueUInt(60);
+    out.sample("_gcount");
+    out.valueUInt(60);
+    out.family("ntrip_client_freertos_task_cpu_percent", OPENMETRICS_GAUGE, NULL, "CPU usage of a FreeRTOS task.");
+    static const char* const tasks[5] = {"NTRIP_Client", "GNSS_Rx", "IDLE0", "IDLE1", "tiT"};
+    for (int t = 0; t < 5; t++) {
+        out.label("task", tasks[t]);
+        out.valueFixed(t * 1.5, 1);
+    }
+}
+
+TEST_CASE("OpenMetricsWriter - Families and samples", "[OpenMetrics]") {
+    char buffer[1024];
+    Output output;
+    OpenMetricsWriter out(buffer, sizeof(buffer), collect, &output);
+
+    SECTION("Counter with unit and help") {
+        out.family("ntrip_client_rtcm_received_bytes", OPENMETRICS_COUNTER, "bytes", "RTCM bytes received since boot.");
+        out.valueUInt(1234567);
+        REQUIRE(out.finish());
+        REQUIRE(output.text ==
+                "# TYPE ntrip_client_rtcm_received_bytes counter\n"
+                "# UNIT ntrip_client_rtcm_received_bytes bytes\n"
+                "# HELP ntrip_client_rtcm_received_bytes RTCM bytes received since boot.\n"
+                "ntrip_client_rtcm_received_bytes_total 1234567\n"
+                "# EOF\n");
+        REQUIRE(output.chunks.size() == 1);
+        REQUIRE(out.getFlushed() == output.text.size());
+    }
+
+    SECTION("Gauge without unit and help") {
+        out.family("ntrip_client_satellites", OPENMETRICS_GAUGE, NULL, NULL);
+        out.valueUInt(18);
+        REQUIRE(out.finish());
+        REQUIRE(output.text == "# TYPE ntrip_client_satellites gauge\nntrip_client_satellites 18\n# EOF\n");
+    }
+
+    SECTION("Labels") {
+        out.family("m", OPENMETRICS_COUNTER, NULL, NULL);
+        out.label("constellation", "gps");
+        out.label("quality", (uint32_t)4);
+        out.valueUInt(7);
+        out.label("constellation", "beidou");
+        out.valueUInt(0);
+        out.family("g", OPENMETRICS_GAUGE, NULL, NULL);
+        out.labelFixed("quantile", 0.99, 2);
+        out.valueFixed(1.25, 2);
+        out.labelFixed("le", INFINITY, 0);
+        out.valueUInt(3);
+        REQUIRE(out.finish());
+        REQUIRE(output.text ==
+                "# TYPE m counter\n"
+                "m_total{constellation=\"gps\",quality=\"4\"} 7\n"
+                "m_total{constellation=\"beidou\"} 0\n"
+                "# TYPE g gauge\n"
+                "g{quantile=\"0.99\"} 1.25\n"
+                "g{le=\"+Inf\"} 3\n"
+                "# EOF\n");
+    }
+
+    SECTION("Suffixes of histograms override _total") {
+        out.family("h", OPENMETRICS_HISTOGRAM, NULL, NULL);
+        out.sample("_bucket");
+        out.labelFixed("le", 1.5, 1);
+        out.valueUInt(2);
+        out.sample("_count");
+        out.valueUInt(2);
+        out.family("c", OPENMETRICS_COUNTER, NULL, NULL);
+        out.sample("_created");
+        out.valueUInt(1700000000);
+        REQUIRE(out.finish());
+        REQUIRE(output.text ==
+                "# TYPE h histogram\n"
+                "h_bucket{le=\"1.5\"} 2\n"
+                "h_count 2\n"
+                "# TYPE c counter\n"
+                "c_created 1700000000\n"
+                "# EOF\n");
+    }
+
+    SECTION("Escaping of label values and help") {
+        out.family("t", OPENMETRICS_GAUGE, NULL, "Help with \\ and \"quotes\"\nand a new line.");
+        out.label("task", "a\"b\\c\nd");
+        out.valueUInt(1);
+        REQUIRE(out.finish());
+        REQUIRE(output.text ==
+                "# TYPE t gauge\n"
+                "# HELP t Help with \\\\ and \"quotes\"\\nand a new line.\n"
+                "t{task=\"a\\\"b\\\\c\\nd\"} 1\n"
+                "# EOF\n");
+        REQUIRE(checkExposition(output.text) == "");
+    }
+
+    SECTION("Numbers") {
+        out.family("n", OPENMETRICS_GAUGE, NULL, NULL);
+        out.valueUInt(0);
+        out.valueUInt(UINT64_MAX);
+        out.valueInt(-128);
+        out.valueInt(INT64_MIN);
+        out.valueFixed(2.345, 2);
+        out.valueFixed(-0.004, 2);
+        out.valueFixed(52.12345678, 8);
+        out.valueFixed(NAN, 2);
+        out.valueFixed(INFINITY, 2);
+        out.valueFixed(-INFINITY, 2);
+        out.valueFixed(1e300, 2);
+        REQUIRE(out.finish());
+        std::vector<std::string> got = lines(output.text);
+        REQUIRE(got.size() == 13);
+        REQUIRE(got[1] == "n 0");
+        REQUIRE(got[2] == "n 18446744073709551615");
+        REQUIRE(got[3] == "n -128");
+        REQUIRE(got[4] == "n -9223372036854775808");
+        REQUIRE(got[5] == "n 2.35");
+        REQUIRE(got[6] == "n 0.00");
+        REQUIRE(got[7] == "n 52.12345678");
+        REQUIRE(got[8] == "n NaN");
+        REQUIRE(got[9] == "n +Inf");
+        REQUIRE(got[10] == "n -Inf");
+        REQUIRE(got[11] == "n +Inf");
+    }
+
+    SECTION("Only # EOF") {
+        REQUIRE(out.finish());
+        REQUIRE(output.text == "# EOF\n");
+    }
+}
+
+TEST_CASE("OpenMetricsWriter - Chunks", "[OpenMetrics]") {
+    // Reference with a buffer that holds everything
+    std::vector<char> large(1 << 16);
+    Output reference;
+    {
+        OpenMetricsWriter out(large.data(), large.size(), collect, &reference);
+        writeExample(out, 7);
+        REQUIRE(out.finish());
+    }
+    REQUIRE(reference.chunks.size() == 1);
+    size_t families = 0;
+    size_t samples = 0;
+    REQUIRE(checkExposition(reference.text, &families, &samples) == "");
+    REQUIRE(families == 11);
+    REQUIRE(samples == 50);
+
+    SECTION("Every buffer size gives the same text in full chunks") {
+        for (size_t size = 1; size <= 1100; size += (size < 64 ? 1 : 37)) {
+            std::vector<char> buffer(size);
+            Output output;
+            OpenMetricsWriter out(buffer.data(), buffer.size(), collect, &output);
+            writeExample(out, 7);
+            REQUIRE(out.finish());
+            REQUIRE(output.text == reference.text);
+            REQUIRE(out.getFlushed() == reference.text.size());
+            // All chunks are full except the last
+            for (size_t i = 0; i + 1 < output.chunks.size(); i++) {
+                REQUIRE(output.chunks[i] == size);
+            }
+            REQUIRE(output.chunks.back() > 0);
+            REQUIRE(output.chunks.back() <= size);
+            REQUIRE(output.chunks.size() == (reference.text.size() + size - 1) / size);
+        }
+    }
+
+    SECTION("A refused chunk stops the output") {
+        char buffer[64];
+        Output output;
+        output.failAfter = 3;
+        OpenMetricsWriter out(buffer, sizeof(buffer), collect, &output);
+        writeExample(out, 7);
+        REQUIRE(out.hasFailed());
+        REQUIRE_FALSE(out.finish());
+        REQUIRE(output.chunks.size() == 3);
+        REQUIRE(out.getFlushed() == 3 * sizeof(buffer));
+        REQUIRE(output.text == reference.text.substr(0, 3 * sizeof(buffer)));
+    }
+
+    SECTION("No buffer or flush function") {
+        Output output;
+        OpenMetricsWriter noBuffer(NULL, 64, collect, &output);
+        writeExample(noBuffer, 7);
+        REQUIRE_FALSE(noBuffer.finish());
+        char buffer[64];
+        OpenMetricsWriter noFlush(buffer, sizeof(buffer), NULL, NULL);
+        writeExample(noFlush, 7);
+        REQUIRE_FALSE(noFlush.finish());
+        REQUIRE(output.text.empty());
+    }
+}
+
+TEST_CASE("OpenMetricsWriter - Exposition checker", "[OpenMetrics]") {
+    // The checker itself must reject what a scraper rejects
+    REQUIRE(checkExposition("# TYPE a gauge\na 1\n# EOF\n") == "");
+    REQUIRE(checkExposition("# TYPE a gauge\na 1\n") != "");
+    REQUIRE(checkExposition("# TYPE a counter\na 1\n# EOF\n") != "");
+    REQUIRE(checkExposition("# TYPE a gauge\n# TYPE a gauge\n# EOF\n") != "");
+    REQUIRE(checkExposition("# TYPE a_seconds gauge\n# UNIT a_seconds bytes\n# EOF\n") != "");
+    REQUIRE(checkExposition("# TYPE a histogram\na_bucket 1\n# EOF\n") != "");
+    REQUIRE(checkExposition("# TYPE a gauge\na{b=\"c} 1\n# EOF\n") != "");
+    REQUIRE(checkExposition("# TYPE a gauge\na{b=\"c\\x\"} 1\n# EOF\n") != "");
+    REQUIRE(checkExposition("# TYPE a gauge\na 1.2.3\n# EOF\n") != "");
+    REQUIRE(checkExposition("# TYPE a gauge\nb 1\n# EOF\n") != "");
+}
+
+// Same exposition with snprintf into one buffer, as statistics_format_json() builds its JSON
+static size_t writeExampleSnprintf(char* buffer, size_t size, uint32_t seed) {
+    int len = 0;
+    len += snprintf(buffer + len, size - len,
+                    "# TYPE ntrip_client_uptime_seconds gauge\n# UNIT ntrip_client_uptime_seconds seconds\n"
+                    "# HELP ntrip_client_uptime_seconds Time since boot.\nntrip_client_uptime_seconds %u\n",
+                    3600 + seed);
+    len += snprintf(buffer + len, size - len,
+                    "# TYPE ntrip_client_rtcm_received_bytes counter\n# UNIT ntrip_client_rtcm_received_bytes bytes\n"
+                    "# HELP ntrip_client_rtcm_received_bytes RTCM bytes received since boot.\n"
+                    "ntrip_client_rtcm_received_bytes_total %llu\n",
+                    12345678901ull + seed);
+    static const char* const constellations[4] = {"gps", "glonass", "galileo", "beidou"};
+    len += snprintf(buffer + len, size - len,
+                    "# TYPE ntrip_client_rtcm_msm_messages counter\n"
+                    "# HELP ntrip_client_rtcm_msm_messages MSM messages per constellation.\n");
+    for (int i = 0; i < 4; i++) {
+        len += snprintf(buffer + len, size - len, "ntrip_client_rtcm_msm_messages_total{constellation=\"%s\"} %u\n",
+                        constellations[i], 1000u * (i + 1) + seed);
+    }
+    len += snprintf(buffer + len, size - len,
+                    "# TYPE ntrip_client_fix_quality_seconds counter\n# UNIT ntrip_client_fix_quality_seconds seconds\n"
+                    "# HELP ntrip_client_fix_quality_seconds Time in each GGA fix quality.\n");
+    for (unsigned q = 0; q < 9; q++) {
+        len += snprintf(buffer + len, size - len, "ntrip_client_fix_quality_seconds_total{quality=\"%u\"} %u\n",
+                        q, q * 10 + seed);
+    }
+    len += snprintf(buffer + len, size - len,
+                    "# TYPE ntrip_client_gga_saved_bytes gauge\n# UNIT ntrip_client_gga_saved_bytes bytes\n"
+                    "# HELP ntrip_client_gga_saved_bytes GGA uplink bytes saved.\nntrip_client_gga_saved_bytes %lld\n",
+                    -(long long)seed - 12);
+    len += snprintf(buffer + len, size - len,
+                    "# TYPE ntrip_client_hdop gauge\n# HELP ntrip_client_hdop Current HDOP.\nntrip_client_hdop %.2f\n",
+                    0.8 + seed / 100.0);
+    len += snprintf(buffer + len, size - len,
+                    "# TYPE ntrip_client_period_position_std_meters gauge\n"
+                    "# UNIT ntrip_client_period_position_std_meters meters\n"
+                    "# HELP ntrip_client_period_position_std_meters Standard deviation of the positions.\n"
+                    "ntrip_client_period_position_std_meters{axis=\"east\"} %.4f\n"
+                    "ntrip_client_period_position_std_meters{axis=\"north\"} %.4f\n",
+                    0.0061, 0.0083);
+    len += snprintf(buffer + len, size - len,
+                    "# TYPE ntrip_client_hdop_quantiles gauge\n"
+                    "# HELP ntrip_client_hdop_quantiles Quantiles of the completed periods.\n");
+    static const double levels[4] = {0.10, 0.50, 0.90, 0.99};
+    for (int q = 0; q < 4; q++) {
+        len += snprintf(buffer + len, size - len, "ntrip_client_hdop_quantiles{quantile=\"%.2f\"} %.2f\n",
+                        levels[q], 0.7 + q * 0.1);
+    }
+    len += snprintf(buffer + len, size - len,
+                    "# TYPE ntrip_client_hdop_distribution histogram\n"
+                    "# HELP ntrip_client_hdop_distribution Samples of the completed periods.\n");
+    unsigned cumulative = 0;
+    for (int b = 0; b < 16; b++) {
+        cumulative += 10 + b;
+        len += snprintf(buffer + len, size - len, "ntrip_client_hdop_distribution_bucket{le=\"%.2f\"} %u\n",
+                        0.5 + b * 0.08, cumulative);
+    }
+    len += snprintf(buffer + len, size - len,
+                    "ntrip_client_hdop_distribution_bucket{le=\"+Inf\"} %u\nntrip_client_hdop_distribution_count %u\n",
+                    cumulative + 3, cumulative + 3);
+    len += snprintf(buffer + len, size - len,
+                    "# TYPE ntrip_client_period_wifi_rssi_dbm_distribution gaugehistogram\n"
+                    "# HELP ntrip_client_period_wifi_rssi_dbm_distribution Samples of this period.\n"
+                    "ntrip_client_period_wifi_rssi_dbm_distribution_bucket{le=\"%d\"} %u\n"
+                    "ntrip_client_period_wifi_rssi_dbm_distribution_bucket{le=\"%d\"} %u\n"
+                    "ntrip_client_period_wifi_rssi_dbm_distribution_bucket{le=\"+Inf\"} %u\n"
+                    "ntrip_client_period_wifi_rssi_dbm_distribution_gcount %u\n",
+                    -72, 5u, -64, 60u, 60u, 60u);
+    len += snprintf(buffer + len, size - len,
+                    "# TYPE ntrip_client_freertos_task_cpu_percent gauge\n"
+                    "# HELP ntrip_client_freertos_task_cpu_percent CPU usage of a FreeRTOS task.\n");
+    static const char* const tasks[5] = {"NTRIP_Client", "GNSS_Rx", "IDLE0", "IDLE1", "tiT"};
+    for (int t = 0; t < 5; t++) {
+        len += snprintf(buffer + len, size - len, "ntrip_client_freertos_task_cpu_percent{task=\"%s\"} %.1f\n",
+                        tasks[t], t * 1.5);
+    }
+    len += snprintf(buffer + len, size - len, "# EOF\n");
+    return (size_t)len;
+}
+
+static bool discard(const char* data, size_t length, void* context) {
+    *(size_t*)context += length + (uint8_t)data[0];
+    return true;
+}
+
+TEST_CASE("OpenMetrics benchmark - chunked writer versus one snprintf buffer", "[.benchmark]") {
+    // The firmware exposition has about 10 times the families of the example
+    const int repeat = 10;
+    const int scrapes = 20000;
+    std::vector<char> whole(64 * 1024);
+
+    // Same text
+    Output reference;
+    {
+        OpenMetricsWriter out(whole.data(), whole.size(), collect, &reference);
+        writeExample(out, 7);
+        out.finish();
+    }
+    size_t snprintfLength = writeExampleSnprintf(whole.data(), whole.size(), 7);
+    REQUIRE(std::string(whole.data(), snprintfLength) == reference.text);
+    size_t exampleSize = reference.text.size();
+
+    printf("\nOpenMetrics exposition of %d x %zu bytes, %d scrapes\n", repeat, exampleSize, scrapes);
+    printf("%-28s %10s %12s\n", "method", "us/scrape", "RAM (bytes)");
+
+    size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int s = 0; s < scrapes; s++) {
+        size_t length = 0;
+        for (int r = 0; r < repeat; r++) {
+            length += writeExampleSnprintf(whole.data() + length, whole.size() - length, (uint32_t)(s + r));
+        }
+        sink += discard(whole.data(), length, &sink);
+    }
+    double snprintfUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / scrapes;
+    printf("%-28s %10.1f %12zu\n", "snprintf, whole body", snprintfUs, repeat * exampleSize);
+
+    static const size_t chunkSizes[3] = {256, 1024, 4096};
+    for (size_t c = 0; c < 3; c++) {
+        std::vector<char> chunk(chunkSizes[c]);
+        start = std::chrono::steady_clock::now();
+        for (int s = 0; s < scrapes; s++) {
+            OpenMetricsWriter out(chunk.data(), chunk.size(), discard, &sink);
+            for (int r = 0; r < repeat; r++) {
+                writeExample(out, (uint32_t)(s + r));
+            }
+            out.finish();
+        }
+        double writerUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / scrapes;
+        char name[48];
+        snprintf(name, sizeof(name), "OpenMetricsWriter, %zu chunks", chunkSizes[c]);
+        printf("%-28s %10.1f %12zu\n", name, writerUs, chunkSizes[c]);
+    }
+    printf("(sink %zu)\n", sink % 10);
+}
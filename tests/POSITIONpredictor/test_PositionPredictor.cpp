@@ -0,0 +1,612 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch.hpp"
+#include "PositionPredictor_standalone.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+static const uint32_t MS_PER_DAY = 86400000u;
+static const double METERS_PER_DEGREE = 111194.93;
+static const double DEG = 0.017453292519943295;
+static const double BASE_LATITUDE = 52.0;
+static const double BASE_LONGITUDE = 5.9;
+static const int64_t LOCAL_OFFSET_US = 5000000000LL;   // Local clock minus GNSS time
+static const uint32_t START_TIME = 43200000u;          // 12:00:00.000
+static const uint32_t RECEIVER_DELAY_MS = 30;          // Shortest epoch to GGA delay
+static const uint32_t MAX_DELAY_MS = 110;
+static const uint32_t WARMUP_MS = 1000;
+
+static int64_t localUs(uint32_t timeOfDayMs) {
+    return LOCAL_OFFSET_US + (int64_t)timeOfDayMs * 1000;
+}
+
+static double eastOf(double longitude) {
+    return (longitude - BASE_LONGITUDE) * METERS_PER_DEGREE * cos(BASE_LATITUDE * DEG);
+}
+
+static double northOf(double latitude) {
+    return (latitude - BASE_LATITUDE) * METERS_PER_DEGREE;
+}
+
+// Meters east and north of a predicted position from a reference position
+static void offsetOf(const PredictedPosition& position, double latitude, double longitude,
+                     double* east, double* north) {
+    *east = (position.longitude - longitude) * METERS_PER_DEGREE * cos(latitude * DEG);
+    *north = (position.latitude - latitude) * METERS_PER_DEGREE;
+}
+
+// ---------------------------------------------------------------------------
+// Ground truth tracks
+// ---------------------------------------------------------------------------
+
+// Ground truth every millisecond
+struct TruthSample {
+    double east;        // m
+    double north;       // m
+    double heading;     // degrees
+    double speed;       // m/s
+};
+
+// Driving profile: acceleration (m/s2) and turn rate (degrees/s) at time t (s)
+typedef void (*Profile)(double t, double* acceleration, double* turnRate);
+
+static void highway(double, double* acceleration, double* turnRate) {
+    *acceleration = 0.0;
+    *turnRate = 0.0;
+}
+
+// 30 km/h around a roundabout with a 15 m radius
+static void roundabout(double, double* acceleration, double* turnRate) {
+    *acceleration = 0.0;
+    *turnRate = (30.0 / 3.6) / 15.0 / DEG;
+}
+
+// Bends left and right, up to 20 degrees/s, 6 s period
+static void sCurves(double t, double* acceleration, double* turnRate) {
+    *acceleration = 0.0;
+    *turnRate = 20.0 * sin(2.0 * M_PI * t / 6.0);
+}
+
+// Cruise 5 s, brake at 6 m/s2 to a stop, stand still
+static void braking(double t, double* acceleration, double* turnRate) {
+    *acceleration = (t < 5.0) ? 0.0 : -6.0;
+    *turnRate = 0.0;
+}
+
+// Slow maneuvering: accelerate, turn into a street, slow down
+static void maneuvering(double t, double* acceleration, double* turnRate) {
+    double phase = fmod(t, 12.0);
+    *acceleration = (phase < 3.0) ? 1.5 : (phase < 9.0 ? 0.0 : -1.5);
+    *turnRate = (phase >= 4.0 && phase < 7.0) ? 30.0 : 0.0;
+}
+
+static std::vector<TruthSample> simulate(Profile profile, double speedKmh, double heading, double seconds) {
+    std::vector<TruthSample> track;
+    TruthSample sample = {0.0, 0.0, heading, speedKmh / 3.6};
+    int samples = (int)(seconds * 1000.0);
+    track.reserve(samples);
+    for (int i = 0; i < samples; i++) {
+        track.push_back(sample);
+        double acceleration;
+        double turnRate;
+        profile(i * 0.001, &acceleration, &turnRate);
+        // Midpoint integration over 1 ms
+        double h = (sample.heading + turnRate * 0.0005) * DEG;
+        double v = std::max(0.0, sample.speed + acceleration * 0.0005);
+        sample.east += v * 0.001 * sin(h);
+        sample.north += v * 0.001 * cos(h);
+        sample.heading = fmod(sample.heading + turnRate * 0.001 + 360.0, 360.0);
+        sample.speed = std::max(0.0, sample.speed + acceleration * 0.001);
+    }
+    return track;
+}
+
+// ---------------------------------------------------------------------------
+// Replay: 10 Hz epochs with receiver noise and receive delays
+// ---------------------------------------------------------------------------
+
+struct Observation {
+    uint32_t arrivalMs;     // Since the start of the track
+    double latitude;
+    double longitude;
+    float speedKmh;
+    float heading;
+};
+
+static std::vector<Observation> observe(const std::vector<TruthSample>& track, uint32_t seed,
+                                        double positionNoise = 0.02) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> position(0.0, positionNoise);
+    std::normal_distribution<double> heading(0.0, 0.2);
+    std::normal_distribution<double> speed(0.0, 0.05);
+    std::uniform_int_distribution<uint32_t> delay(RECEIVER_DELAY_MS, MAX_DELAY_MS);
+    std::uniform_real_distribution<double> anyHeading(0.0, 360.0);
+
+    std::vector<Observation> observations;
+    for (uint32_t ms = 0; ms < track.size(); ms += 100) {
+        const TruthSample& truth = track[ms];
+        Observation observation;
+        observation.arrivalMs = ms + delay(rng);
+        observation.latitude = BASE_LATITUDE + (truth.north + position(rng)) / METERS_PER_DEGREE;
+        observation.longitude = BASE_LONGITUDE +
+            (truth.east + position(rng)) / (METERS_PER_DEGREE * cos(BASE_LATITUDE * DEG));
+        double measuredSpeed = std::max(0.0, truth.speed + speed(rng));
+        observation.speedKmh = (float)(measuredSpeed * 3.6);
+        // The course of a receiver standing still is noise
+        observation.heading = (float)(truth.speed < 0.5 ? anyHeading(rng) : fmod(truth.heading + heading(rng) + 360.0, 360.0));
+        observations.push_back(observation);
+    }
+    return observations;
+}
+
+struct ErrorStats {
+    double mean;
+    double p95;
+    double max;
+    size_t frames;
+};
+
+static ErrorStats statsOf(std::vector<double> errors) {
+    ErrorStats stats = {0.0, 0.0, 0.0, errors.size()};
+    if (errors.empty()) {
+        return stats;
+    }
+    std::sort(errors.begin(), errors.end());
+    for (size_t i = 0; i < errors.size(); i++) {
+        stats.mean += errors[i];
+    }
+    stats.mean /= errors.size();
+    stats.p95 = errors[errors.size() * 95 / 100];
+    stats.max = errors.back();
+    return stats;
+}
+
+static double errorAt(const std::vector<TruthSample>& track, uint32_t ms, double latitude, double longitude) {
+    const TruthSample& truth = track[std::min<size_t>(ms, track.size() - 1)];
+    double east = eastOf(longitude) - truth.east;
+    double north = northOf(latitude) - truth.north;
+    return sqrt(east * east + north * north);
+}
+
+/*
+ * Replay a track the way the Data Output Task sends it.
+ * outputPeriodMs 0: a frame for every epoch, sent 2 ms after it was received.
+ * outputPeriodMs > 0: a frame every period, aligned to GNSS time.
+ * Without a predictor a frame holds the last received position. The error is
+ * the distance to the true position when the frame is sent.
+ */
+static ErrorStats replay(const std::vector<TruthSample>& track, const std::vector<Observation>& observations,
+                         PositionPredictor* predictor, uint32_t outputPeriodMs, uint32_t startTime = START_TIME) {
+    std::vector<double> errors;
+    size_t next = 0;
+    bool haveObservation = false;
+    Observation last = observations[0];
+    bool slotScheduled = false;
+    uint32_t slot = 0;
+
+    for (uint32_t ms = 0; ms < track.size(); ms++) {
+        uint32_t timeOfDay = (startTime + ms) % MS_PER_DAY;
+        int64_t now = localUs(startTime + ms);
+
+        while (next < observations.size() && observations[next].arrivalMs == ms) {
+            last = observations[next];
+            haveObservation = true;
+            uint32_t epochTime = (startTime + (uint32_t)next * 100) % MS_PER_DAY;
+            if (predictor != NULL) {
+                predictor->addEpoch(epochTime, now, last.latitude, last.longitude, 10.0f,
+                                    last.speedKmh, last.heading);
+            }
+            if (outputPeriodMs == 0 && ms + 2 >= WARMUP_MS) {
+                PredictedPosition position;
+                position.latitude = last.latitude;
+                position.longitude = last.longitude;
+                if (predictor != NULL) {
+                    REQUIRE(predictor->predict(now + 2000, &position));
+                }
+                errors.push_back(errorAt(track, ms + 2, position.latitude, position.longitude));
+            }
+            next++;
+        }
+
+        if (outputPeriodMs == 0 || !haveObservation) {
+            continue;
+        }
+
+        bool send;
+        if (predictor == NULL) {
+            send = (timeOfDay % outputPeriodMs == 0);
+        } else {
+            if (!slotScheduled) {
+                slot = (predictor->timeOfDayAt(now) / outputPeriodMs + 1) * outputPeriodMs % MS_PER_DAY;
+                slotScheduled = true;
+            }
+            send = (now >= predictor->localTimeOf(slot));
+        }
+        if (!send) {
+            continue;
+        }
+        PredictedPosition position;
+        position.latitude = last.latitude;
+        position.longitude = last.longitude;
+        if (predictor != NULL) {
+            REQUIRE(predictor->predict(now, &position));
+            slot = (slot + outputPeriodMs) % MS_PER_DAY;
+        }
+        if (ms >= WARMUP_MS) {
+            errors.push_back(errorAt(track, ms, position.latitude, position.longitude));
+        }
+    }
+    return statsOf(errors);
+}
+
+static ErrorStats replayWith(const std::vector<TruthSample>& track, const std::vector<Observation>& observations,
+                             int model, uint32_t outputPeriodMs, uint32_t startTime = START_TIME) {
+    if (model < 0) {
+        return replay(track, observations, NULL, outputPeriodMs, startTime);
+    }
+    PositionPredictor predictor;
+    predictor.configure((PredictorModel)model, 500, RECEIVER_DELAY_MS);
+    return replay(track, observations, &predictor, outputPeriodMs, startTime);
+}
+
+static const int NO_PREDICTION = -1;
+
+// ---------------------------------------------------------------------------
+// Unit tests
+// ---------------------------------------------------------------------------
+
+TEST_CASE("Position predictor - GNSS time from the fastest epoch", "[PositionPredictor]") {
+    PositionPredictor predictor;
+    predictor.configure(PREDICTOR_CV, 500, 0);
+    REQUIRE_FALSE(predictor.hasEpoch());
+    PredictedPosition position;
+    REQUIRE_FALSE(predictor.predict(localUs(START_TIME), &position));
+
+    const uint32_t delays[5] = {60, 45, 80, 32, 90};
+    for (int i = 0; i < 5; i++) {
+        uint32_t epoch = START_TIME + i * 100;
+        predictor.addEpoch(epoch, localUs(epoch + delays[i]), BASE_LATITUDE, BASE_LONGITUDE, 0.0f, 0.0f, 0.0f);
+    }
+    REQUIRE(predictor.hasEpoch());
+    REQUIRE(predictor.getClockOffsetUs() == LOCAL_OFFSET_US + 32000);
+    REQUIRE(predictor.timeOfDayAt(localUs(START_TIME + 1000)) == START_TIME + 1000 - 32);
+    REQUIRE(predictor.localTimeOf(START_TIME + 1000) == localUs(START_TIME + 1032));
+
+    // The receiver delay moves the mapping to the time of the epoch
+    predictor.configure(PREDICTOR_CV, 500, 30);
+    predictor.addEpoch(START_TIME + 500, localUs(START_TIME + 550), BASE_LATITUDE, BASE_LONGITUDE, 0.0f, 0.0f, 0.0f);
+    REQUIRE(predictor.getClockOffsetUs() == LOCAL_OFFSET_US + 2000);
+
+    // The fastest epoch leaves the history after PREDICTOR_CLOCK_EPOCHS epochs
+    predictor.configure(PREDICTOR_CV, 500, 0);
+    for (int i = 6; i < 6 + PREDICTOR_CLOCK_EPOCHS; i++) {
+        uint32_t epoch = START_TIME + i * 100;
+        predictor.addEpoch(epoch, localUs(epoch + 50), BASE_LATITUDE, BASE_LONGITUDE, 0.0f, 0.0f, 0.0f);
+    }
+    REQUIRE(predictor.getClockOffsetUs() == LOCAL_OFFSET_US + 50000);
+
+    // Repeated epochs are ignored, an earlier epoch starts over
+    predictor.addEpoch(START_TIME + 3700, localUs(START_TIME + 3700), BASE_LATITUDE, BASE_LONGITUDE, 0.0f, 0.0f, 0.0f);
+    REQUIRE(predictor.getClockOffsetUs() == LOCAL_OFFSET_US + 50000);
+    predictor.addEpoch(START_TIME, localUs(START_TIME + 70), BASE_LATITUDE, BASE_LONGITUDE, 0.0f, 0.0f, 0.0f);
+    REQUIRE(predictor.getClockOffsetUs() == LOCAL_OFFSET_US + 70000);
+
+    predictor.reset();
+    REQUIRE_FALSE(predictor.hasEpoch());
+}
+
+TEST_CASE("Position predictor - Midnight", "[PositionPredictor]") {
+    PositionPredictor predictor;
+    predictor.configure(PREDICTOR_CV, 500, 0);
+    const int64_t dayUs = (int64_t)MS_PER_DAY * 1000;
+
+    predictor.addEpoch(MS_PER_DAY - 200, localUs(MS_PER_DAY - 160), BASE_LATITUDE, BASE_LONGITUDE, 0.0f, 36.0f, 90.0f);
+    predictor.addEpoch(MS_PER_DAY - 100, localUs(MS_PER_DAY - 50), BASE_LATITUDE, BASE_LONGITUDE, 0.0f, 36.0f, 90.0f);
+    REQUIRE(predictor.getClockOffsetUs() == LOCAL_OFFSET_US + 40000);
+
+    // Not past midnight: the date of the epoch stays valid
+    PredictedPosition position;
+    REQUIRE(predictor.predict(localUs(MS_PER_DAY + 300), &position));
+    REQUIRE(position.horizonMs == 99);
+    REQUIRE(position.timeOfDayMs == MS_PER_DAY - 1);
+
+    // Slots after midnight are on the next day
+    REQUIRE(predictor.localTimeOf(20) == localUs(MS_PER_DAY + 60));
+    REQUIRE(predictor.timeOfDayAt(localUs(MS_PER_DAY + 60)) == 20);
+
+    // The first epoch of the day keeps the clock offset
+    predictor.addEpoch(0, localUs(MS_PER_DAY + 45), BASE_LATITUDE, BASE_LONGITUDE, 0.0f, 36.0f, 90.0f);
+    REQUIRE(predictor.getClockOffsetUs() == LOCAL_OFFSET_US + 40000 + dayUs);
+    REQUIRE(predictor.timeOfDayAt(localUs(MS_PER_DAY + 140)) == 100);
+    REQUIRE(predictor.localTimeOf(MS_PER_DAY - 100) == localUs(MS_PER_DAY - 60));
+    REQUIRE(predictor.predict(localUs(MS_PER_DAY + 140), &position));
+    REQUIRE(position.horizonMs == 100);
+    REQUIRE(position.timeOfDayMs == 100);
+    // The turn rate is taken across midnight
+    REQUIRE(predictor.getTurnRate() == Approx(0.0f).margin(1e-6));
+}
+
+TEST_CASE("Position predictor - Horizon limits", "[PositionPredictor]") {
+    PositionPredictor predictor;
+    predictor.configure(PREDICTOR_CV, 300, 0);
+    predictor.addEpoch(START_TIME, localUs(START_TIME + 40), BASE_LATITUDE, BASE_LONGITUDE, 12.5f, 36.0f, 0.0f);
+    PredictedPosition position;
+
+    SECTION("A time before the epoch gives the epoch") {
+        REQUIRE(predictor.predict(localUs(START_TIME - 100), &position));
+        REQUIRE(position.horizonMs == 0);
+        REQUIRE(position.timeOfDayMs == START_TIME);
+        REQUIRE_FALSE(position.extrapolated);
+        REQUIRE(position.latitude == BASE_LATITUDE);
+    }
+
+    SECTION("Within the horizon") {
+        REQUIRE(predictor.predict(localUs(START_TIME + 240), &position));
+        REQUIRE(position.horizonMs == 200);
+        REQUIRE(position.timeOfDayMs == START_TIME + 200);
+        REQUIRE(position.extrapolated);
+        REQUIRE(northOf(position.latitude) == Approx(2.0).margin(1e-3));
+        REQUIRE(position.altitude == 12.5f);
+    }
+
+    SECTION("The prediction stops at the maximum horizon") {
+        REQUIRE(predictor.predict(localUs(START_TIME + 5040), &position));
+        REQUIRE(position.horizonMs == 300);
+        REQUIRE(position.timeOfDayMs == START_TIME + 300);
+        REQUIRE(northOf(position.latitude) == Approx(3.0).margin(1e-3));
+    }
+}
+
+TEST_CASE("Position predictor - Straight line and standing still", "[PositionPredictor]") {
+    PositionPredictor predictor;
+    predictor.configure(PREDICTOR_CTRV, 500, 0);
+    PredictedPosition position;
+    double east;
+    double north;
+
+    SECTION("East at 36 km/h") {
+        predictor.addEpoch(START_TIME, localUs(START_TIME), BASE_LATITUDE, BASE_LONGITUDE, 0.0f, 36.0f, 90.0f);
+        REQUIRE(predictor.predict(localUs(START_TIME + 500), &position));
+        offsetOf(position, BASE_LATITUDE, BASE_LONGITUDE, &east, &north);
+        REQUIRE(east == Approx(5.0).margin(1e-3));
+        REQUIRE(north == Approx(0.0).margin(1e-3));
+        REQUIRE(position.heading == Approx(90.0f));
+        REQUIRE(position.speed == Approx(36.0f));
+    }
+
+    SECTION("Across the antimeridian") {
+        predictor.addEpoch(START_TIME, localUs(START_TIME), 0.0, 179.99999, 0.0f, 36.0f, 90.0f);
+        REQUIRE(predictor.predict(localUs(START_TIME + 500), &position));
+        REQUIRE(position.longitude < -179.9999);
+        offsetOf(position, 0.0, 179.99999 - 360.0, &east, &north);
+        REQUIRE(east == Approx(5.0).margin(1e-3));
+    }
+
+    SECTION("Below the minimum speed the position is kept") {
+        predictor.addEpoch(START_TIME, localUs(START_TIME), BASE_LATITUDE, BASE_LONGITUDE, 0.0f, 0.9f, 123.0f);
+        REQUIRE(predictor.predict(localUs(START_TIME + 500), &position));
+        REQUIRE_FALSE(position.extrapolated);
+        REQUIRE(position.latitude == BASE_LATITUDE);
+        REQUIRE(position.longitude == BASE_LONGITUDE);
+        REQUIRE(position.timeOfDayMs == START_TIME + 500);
+    }
+
+    SECTION("Without VTG speed and heading come from the positions") {
+        for (int i = 0; i < 3; i++) {
+            uint32_t epoch = START_TIME + i * 100;
+            predictor.addEpoch(epoch, localUs(epoch), BASE_LATITUDE + i * 1.0 / METERS_PER_DEGREE,
+                               BASE_LONGITUDE, 0.0f, -1.0f, 0.0f);
+        }
+        REQUIRE(predictor.predict(localUs(START_TIME + 400), &position));
+        REQUIRE(position.speed == Approx(36.0f).epsilon(0.001));
+        REQUIRE((position.heading < 0.1f || position.heading > 359.9f));
+        offsetOf(position, BASE_LATITUDE, BASE_LONGITUDE, &east, &north);
+        REQUIRE(north == Approx(4.0).margin(0.01));
+    }
+}
+
+TEST_CASE("Position predictor - Turn rate", "[PositionPredictor]") {
+    PositionPredictor predictor;
+    predictor.configure(PREDICTOR_CTRV, 1000, 0);
+    PredictedPosition position;
+
+    SECTION("From the heading change over the last epochs, across north") {
+        const float headings[4] = {340.0f, 350.0f, 0.0f, 10.0f};
+        for (int i = 0; i < 4; i++) {
+            uint32_t epoch = START_TIME + i * 500;
+            predictor.addEpoch(epoch, localUs(epoch), BASE_LATITUDE, BASE_LONGITUDE, 0.0f, 36.0f, headings[i]);
+        }
+        REQUIRE(predictor.getTurnRate() == Approx(20.0f));
+    }
+
+    SECTION("Arc with constant turn rate") {
+        // 10 m/s with 90 degrees per second: a circle with a 6.37 m radius
+        predictor.addEpoch(START_TIME, localUs(START_TIME), BASE_LATITUDE, BASE_LONGITUDE, 0.0f, 36.0f, 0.0f);
+        predictor.addEpoch(START_TIME + 100, localUs(START_TIME + 100), BASE_LATITUDE, BASE_LONGITUDE, 0.0f, 36.0f, 5.0f);
+        REQUIRE(predictor.getTurnRate() == Approx(50.0f));
+        REQUIRE(predictor.predict(localUs(START_TIME + 1000), &position));
+        double radius = 10.0 / (50.0 * DEG);
+        double turned = 45.0 * DEG;
+        double east;
+        double north;
+        offsetOf(position, BASE_LATITUDE, BASE_LONGITUDE, &east, &north);
+        REQUIRE(north == Approx(radius * (sin(5.0 * DEG + turned) - sin(5.0 * DEG))).margin(1e-3));
+        REQUIRE(east == Approx(radius * (cos(5.0 * DEG) - cos(5.0 * DEG + turned))).margin(1e-3));
+        REQUIRE(position.heading == Approx(50.0f));
+
+        // The same epochs with CV: straight along the heading
+        predictor.configure(PREDICTOR_CV, 1000, 0);
+        REQUIRE(predictor.predict(localUs(START_TIME + 1000), &position));
+        offsetOf(position, BASE_LATITUDE, BASE_LONGITUDE, &east, &north);
+        REQUIRE(north == Approx(9.0 * cos(5.0 * DEG)).margin(1e-3));
+        REQUIRE(position.heading == Approx(5.0f));
+    }
+
+    SECTION("Limited to PREDICTOR_MAX_TURN_RATE") {
+        predictor.addEpoch(START_TIME, localUs(START_TIME), BASE_LATITUDE, BASE_LONGITUDE, 0.0f, 36.0f, 100.0f);
+        predictor.addEpoch(START_TIME + 100, localUs(START_TIME + 100), BASE_LATITUDE, BASE_LONGITUDE, 0.0f, 36.0f, 80.0f);
+        REQUIRE(predictor.getTurnRate() == Approx(-PREDICTOR_MAX_TURN_RATE));
+    }
+
+    SECTION("Not across a gap or standing still") {
+        predictor.addEpoch(START_TIME, localUs(START_TIME), BASE_LATITUDE, BASE_LONGITUDE, 0.0f, 36.0f, 0.0f);
+        predictor.addEpoch(START_TIME + 3000, localUs(START_TIME + 3000), BASE_LATITUDE, BASE_LONGITUDE, 0.0f, 36.0f, 30.0f);
+        REQUIRE(predictor.getTurnRate() == 0.0f);
+        predictor.addEpoch(START_TIME + 3100, localUs(START_TIME + 3100), BASE_LATITUDE, BASE_LONGITUDE, 0.0f, 0.5f, 90.0f);
+        REQUIRE(predictor.getTurnRate() == 0.0f);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Replayed tracks against ground truth
+// ---------------------------------------------------------------------------
+
+TEST_CASE("Replayed tracks - frame per epoch at the transmit time", "[PositionPredictor][replay]") {
+    SECTION("Highway, 120 km/h") {
+        std::vector<TruthSample> track = simulate(highway, 120.0, 45.0, 60.0);
+        std::vector<Observation> observations = observe(track, 1);
+        ErrorStats none = replayWith(track, observations, NO_PREDICTION, 0);
+        ErrorStats cv = replayWith(track, observations, PREDICTOR_CV, 0);
+        ErrorStats ctrv = replayWith(track, observations, PREDICTOR_CTRV, 0);
+        REQUIRE(none.frames == cv.frames);
+        // 30-110 ms old at 33 m/s
+        REQUIRE(none.mean > 1.5);
+        REQUIRE(cv.mean < 0.15);
+        REQUIRE(ctrv.mean < 0.15);
+        REQUIRE(ctrv.max < 0.5);
+    }
+
+    SECTION("Roundabout, 30 km/h with a 15 m radius") {
+        std::vector<TruthSample> track = simulate(roundabout, 30.0, 0.0, 30.0);
+        std::vector<Observation> observations = observe(track, 2);
+        ErrorStats none = replayWith(track, observations, NO_PREDICTION, 0);
+        ErrorStats cv = replayWith(track, observations, PREDICTOR_CV, 0);
+        ErrorStats ctrv = replayWith(track, observations, PREDICTOR_CTRV, 0);
+        // The arc matters little over 30-110 ms
+        REQUIRE(cv.mean < none.mean * 0.1);
+        REQUIRE(ctrv.mean < cv.mean);
+        REQUIRE(ctrv.mean < 0.05);
+    }
+
+    SECTION("S-curves, 60 km/h") {
+        std::vector<TruthSample> track = simulate(sCurves, 60.0, 270.0, 60.0);
+        std::vector<Observation> observations = observe(track, 3);
+        ErrorStats none = replayWith(track, observations, NO_PREDICTION, 0);
+        ErrorStats cv = replayWith(track, observations, PREDICTOR_CV, 0);
+        ErrorStats ctrv = replayWith(track, observations, PREDICTOR_CTRV, 0);
+        REQUIRE(ctrv.mean < none.mean * 0.1);
+        REQUIRE(ctrv.mean <= cv.mean);
+    }
+
+    SECTION("Braking to a stop") {
+        std::vector<TruthSample> track = simulate(braking, 100.0, 180.0, 15.0);
+        std::vector<Observation> observations = observe(track, 4);
+        ErrorStats none = replayWith(track, observations, NO_PREDICTION, 0);
+        ErrorStats ctrv = replayWith(track, observations, PREDICTOR_CTRV, 0);
+        REQUIRE(ctrv.mean < none.mean * 0.1);
+        REQUIRE(ctrv.max < 0.5);
+    }
+
+    SECTION("Slow maneuvering") {
+        std::vector<TruthSample> track = simulate(maneuvering, 0.0, 90.0, 60.0);
+        std::vector<Observation> observations = observe(track, 5);
+        ErrorStats none = replayWith(track, observations, NO_PREDICTION, 0);
+        ErrorStats ctrv = replayWith(track, observations, PREDICTOR_CTRV, 0);
+        REQUIRE(ctrv.mean < none.mean * 0.2);
+    }
+
+    SECTION("Standing still with a noisy course is not moved") {
+        std::vector<TruthSample> track = simulate(highway, 0.0, 0.0, 20.0);
+        std::vector<Observation> observations = observe(track, 6);
+        ErrorStats none = replayWith(track, observations, NO_PREDICTION, 0);
+        ErrorStats ctrv = replayWith(track, observations, PREDICTOR_CTRV, 0);
+        REQUIRE(ctrv.mean == Approx(none.mean));
+        REQUIRE(ctrv.max == Approx(none.max));
+    }
+}
+
+TEST_CASE("Replayed tracks - 50 Hz output from 10 Hz epochs", "[PositionPredictor][replay]") {
+    SECTION("Highway, 120 km/h") {
+        std::vector<TruthSample> track = simulate(highway, 120.0, 45.0, 60.0);
+        std::vector<Observation> observations = observe(track, 11);
+        ErrorStats none = replayWith(track, observations, NO_PREDICTION, 20);
+        ErrorStats ctrv = replayWith(track, observations, PREDICTOR_CTRV, 20);
+        // 50 frames per second after the warmup
+        REQUIRE(ctrv.frames >= 2945);
+        REQUIRE(ctrv.frames <= 2950);
+        REQUIRE(none.frames == 2950);
+        // Holding the last epoch is 30-210 ms old
+        REQUIRE(none.mean > 3.0);
+        REQUIRE(ctrv.mean < 0.2);
+        REQUIRE(ctrv.p95 < 0.4);
+    }
+
+    SECTION("Roundabout, 30 km/h with a 15 m radius") {
+        std::vector<TruthSample> track = simulate(roundabout, 30.0, 0.0, 30.0);
+        std::vector<Observation> observations = observe(track, 12);
+        ErrorStats none = replayWith(track, observations, NO_PREDICTION, 20);
+        ErrorStats cv = replayWith(track, observations, PREDICTOR_CV, 20);
+        ErrorStats ctrv = replayWith(track, observations, PREDICTOR_CTRV, 20);
+        // Up to 210 ms ahead the arc does matter
+        REQUIRE(ctrv.mean < cv.mean * 0.8);
+        REQUIRE(ctrv.p95 < cv.p95 * 0.8);
+        REQUIRE(ctrv.mean < none.mean * 0.1);
+    }
+
+    SECTION("Across midnight") {
+        std::vector<TruthSample> track = simulate(sCurves, 60.0, 0.0, 20.0);
+        std::vector<Observation> observations = observe(track, 13);
+        ErrorStats none = replayWith(track, observations, NO_PREDICTION, 20, MS_PER_DAY - 10000);
+        ErrorStats ctrv = replayWith(track, observations, PREDICTOR_CTRV, 20, MS_PER_DAY - 10000);
+        REQUIRE(ctrv.frames >= 945);
+        REQUIRE(ctrv.mean < none.mean * 0.2);
+        REQUIRE(ctrv.max < none.max);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Benchmark
+// ---------------------------------------------------------------------------
+
+static void reportScenario(const char* name, Profile profile, double speedKmh, double seconds, uint32_t seed) {
+    std::vector<TruthSample> track = simulate(profile, speedKmh, 30.0, seconds);
+    std::vector<Observation> observations = observe(track, seed);
+    const uint32_t periods[2] = {0, 20};
+    const int models[3] = {NO_PREDICTION, PREDICTOR_CV, PREDICTOR_CTRV};
+    const char* modelNames[3] = {"none", "CV", "CTRV"};
+    for (int p = 0; p < 2; p++) {
+        for (int m = 0; m < 3; m++) {
+            ErrorStats stats = replayWith(track, observations, models[m], periods[p]);
+            printf("%-13s %-9s %-5s %8.3f %8.3f %8.3f\n", name, periods[p] == 0 ? "epoch" : "50 Hz",
+                   modelNames[m], stats.mean, stats.p95, stats.max);
+        }
+    }
+}
+
+TEST_CASE("Prediction benchmark - error against ground truth", "[.benchmark]") {
+    printf("\n%-13s %-9s %-5s %8s %8s %8s\n", "track", "output", "model", "mean m", "p95 m", "max m");
+    reportScenario("highway", highway, 120.0, 60.0, 21);
+    reportScenario("roundabout", roundabout, 30.0, 60.0, 22);
+    reportScenario("S-curves", sCurves, 60.0, 60.0, 23);
+    reportScenario("braking", braking, 100.0, 15.0, 24);
+    reportScenario("maneuvering", maneuvering, 0.0, 60.0, 25);
+
+    PositionPredictor predictor;
+    predictor.configure(PREDICTOR_CTRV, 500, RECEIVER_DELAY_MS);
+    predictor.addEpoch(START_TIME, localUs(START_TIME + 40), BASE_LATITUDE, BASE_LONGITUDE, 0.0f, 50.0f, 10.0f);
+    predictor.addEpoch(START_TIME + 100, localUs(START_TIME + 140), BASE_LATITUDE, BASE_LONGITUDE, 0.0f, 50.0f, 12.0f);
+    const int rounds = 2000000;
+    double sum = 0.0;
+    PredictedPosition position;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        predictor.predict(localUs(START_TIME + 140) + (i % 400) * 1000, &position);
+        sum += position.latitude;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    REQUIRE(sum > 0.0);
+    printf("\nCTRV predictions: %.0f per second (%.0f ns each)\n", rounds / seconds, seconds / rounds * 1e9);
+}
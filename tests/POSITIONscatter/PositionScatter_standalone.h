@@ -0,0 +1,121 @@
+/*!
+ * \file PositionScatter.h
+ * \brief Online scatter statistics of GNSS positions in local east, north, up.
+ *
+ * Measures the actual precision of a static installation or an RTK fix from
+ * the positions themselves, instead of estimating it from the HDOP. Every
+ * position is converted to east, north and up offsets in meters from a
+ * reference point and added to Welford running means and variances per
+ * axis, which are exact and numerically stable over any number of samples.
+ * Standard deviations and 2DRMS follow from the variances.
+ *
+ * \section scatter_reference Reference
+ * The first position sets the reference. recenter() moves it to the mean of
+ * the samples so far and clears them; the Statistics Task calls it at the
+ * end of every period, so offsets stay small (equirectangular approximation,
+ * as in GGAScheduler) and each period measures the scatter about a reference
+ * that follows the installation.
+ *
+ * \section scatter_cep CEP
+ * CEP50 and CEP95 are quantiles of the horizontal distance to the mean,
+ * recorded in millimeters in a LogHistogram (within 1/16). A sample is
+ * measured against the mean of the samples before it, scaled by
+ * sqrt((n - 1) / n) so that on average it spreads like the distance to the
+ * final mean; the first sample after a reset has no distance. Memory is
+ * constant whatever the number of samples.
+ */
+
+#ifndef POSITION_SCATTER_STANDALONE_H
+#define POSITION_SCATTER_STANDALONE_H
+
+#include <cstdint>
+
+#include "../STATShistogram/LogHistogram_standalone.h"
+
+#define POSITION_SCATTER_UNITS_PER_METER 1000   // Radial distances are recorded in mm
+
+/**
+ * \brief Axis of the local frame.
+ */
+enum ScatterAxis {
+    SCATTER_EAST = 0,
+    SCATTER_NORTH,
+    SCATTER_UP,
+    SCATTER_AXIS_COUNT
+};
+
+class PositionScatter {
+public:
+    /** \brief Create an empty scatter without a reference. */
+    PositionScatter();
+
+    /** \brief Remove all samples; the reference is kept. */
+    void reset();
+
+    /** \brief Remove all samples and the reference; the next position sets a new one. */
+    void clear();
+
+    /**
+     * \brief Add a position.
+     * \param[in] latitude Latitude in decimal degrees.
+     * \param[in] longitude Longitude in decimal degrees.
+     * \param[in] altitude Altitude in meters.
+     */
+    void add(double latitude, double longitude, float altitude);
+
+    /**
+     * \brief Move the reference to the mean position and remove the samples.
+     *
+     * Without samples the reference is kept.
+     */
+    void recenter();
+
+    /** \brief Number of positions since the last reset. */
+    uint32_t getCount() const { return count; }
+
+    /** \brief A reference has been set. */
+    bool hasReference() const { return referenceValid; }
+
+    /**
+     * \brief Mean position of the samples.
+     * \param[out] latitude Latitude in decimal degrees.
+     * \param[out] longitude Longitude in decimal degrees.
+     * \param[out] altitude Altitude in meters.
+     * \return false without samples; the outputs are then the reference (or 0).
+     */
+    bool getMeanPosition(double* latitude, double* longitude, float* altitude) const;
+
+    /** \brief Mean offset from the reference along an axis in meters, 0 without samples. */
+    float getMeanOffset(ScatterAxis axis) const;
+
+    /** \brief Standard deviation along an axis in meters (population), 0 with fewer than 2 samples. */
+    float getStdDev(ScatterAxis axis) const;
+
+    /** \brief 2DRMS in meters: twice the RMS horizontal distance to the mean. */
+    float getDrms2() const;
+
+    /**
+     * \brief Circular error probable.
+     * \param[in] probability Fraction of positions inside the circle, e.g. 0.5 for CEP50 or 0.95 for CEP95.
+     * \return Radius in meters around the mean, 0 with fewer than 2 samples.
+     */
+    float getCep(float probability) const;
+
+    /** \brief Histogram of the horizontal distances in millimeters. */
+    const LogHistogram& getRadialHistogram() const { return radial; }
+
+private:
+    void toLocal(double latitude, double longitude, float altitude, double* offsets) const;
+
+    bool referenceValid;
+    double referenceLatitude;
+    double referenceLongitude;
+    float referenceAltitude;
+    float referenceCosLatitude;
+    uint32_t count;
+    double mean[SCATTER_AXIS_COUNT];     // Running means of the offsets
+    double m2[SCATTER_AXIS_COUNT];       // Sums of squared differences from the mean (Welford)
+    LogHistogram radial;
+};
+
+#endif // POSITION_SCATTER_STANDALONE_H
@@ -0,0 +1,413 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch.hpp"
+#include "PositionScatter_standalone.h"
+#include <math.h>
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+// Same sphere as PositionScatter
+static const double METERS_PER_DEGREE = 111194.93;
+static const double DEG_TO_RAD = 0.017453292519943295;
+
+struct Position {
+    double latitude;
+    double longitude;
+    float altitude;
+};
+
+// Position at east, north and up meters from an origin
+static Position offsetPosition(const Position& origin, double east, double north, double up) {
+    Position p;
+    p.latitude = origin.latitude + north / METERS_PER_DEGREE;
+    p.longitude = origin.longitude + east / (METERS_PER_DEGREE * cos(origin.latitude * DEG_TO_RAD));
+    if (p.longitude > 180.0) {
+        p.longitude -= 360.0;
+    } else if (p.longitude < -180.0) {
+        p.longitude += 360.0;
+    }
+    p.altitude = (float)(origin.altitude + up);
+    return p;
+}
+
+// Normal scatter about an origin with a standard deviation per axis
+static std::vector<Position> scatterAround(const Position& origin, double sigmaEast, double sigmaNorth,
+                                           double sigmaUp, size_t n, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> east(0.0, sigmaEast);
+    std::normal_distribution<double> north(0.0, sigmaNorth);
+    std::normal_distribution<double> up(0.0, sigmaUp);
+    std::vector<Position> positions;
+    for (size_t i = 0; i < n; i++) {
+        positions.push_back(offsetPosition(origin, east(rng), north(rng), up(rng)));
+    }
+    return positions;
+}
+
+// Local offsets of positions about their first one, as PositionScatter converts them
+static void localOffsets(const std::vector<Position>& positions, std::vector<double> axes[3]) {
+    const Position& reference = positions[0];
+    float cosLatitude = (float)cos(reference.latitude * DEG_TO_RAD);
+    for (const Position& p : positions) {
+        double lonDifference = p.longitude - reference.longitude;
+        if (lonDifference > 180.0) {
+            lonDifference -= 360.0;
+        } else if (lonDifference < -180.0) {
+            lonDifference += 360.0;
+        }
+        axes[0].push_back(lonDifference * METERS_PER_DEGREE * cosLatitude);
+        axes[1].push_back((p.latitude - reference.latitude) * METERS_PER_DEGREE);
+        axes[2].push_back((double)p.altitude - reference.altitude);
+    }
+}
+
+// Two-pass mean and population standard deviation
+static void twoPass(const std::vector<double>& values, double* mean, double* stdDev) {
+    double sum = 0.0;
+    for (double v : values) {
+        sum += v;
+    }
+    *mean = sum / values.size();
+    double squares = 0.0;
+    for (double v : values) {
+        squares += (v - *mean) * (v - *mean);
+    }
+    *stdDev = sqrt(squares / values.size());
+}
+
+static const Position STATION = {52.2129919, 5.2793703, 12.5f};
+
+TEST_CASE("PositionScatter - Empty and single samples", "[PositionScatter]") {
+    PositionScatter scatter;
+
+    SECTION("No samples") {
+        double latitude = 1.0;
+        double longitude = 1.0;
+        float altitude = 1.0f;
+        REQUIRE(scatter.getCount() == 0);
+        REQUIRE_FALSE(scatter.hasReference());
+        REQUIRE_FALSE(scatter.getMeanPosition(&latitude, &longitude, &altitude));
+        REQUIRE(latitude == 0.0);
+        REQUIRE(longitude == 0.0);
+        REQUIRE(altitude == 0.0f);
+        REQUIRE(scatter.getStdDev(SCATTER_EAST) == 0.0f);
+        REQUIRE(scatter.getDrms2() == 0.0f);
+        REQUIRE(scatter.getCep(0.5f) == 0.0f);
+        scatter.recenter();
+        REQUIRE_FALSE(scatter.hasReference());
+    }
+
+    SECTION("One sample sets the reference and has no scatter") {
+        scatter.add(STATION.latitude, STATION.longitude, STATION.altitude);
+        double latitude;
+        double longitude;
+        float altitude;
+        REQUIRE(scatter.getCount() == 1);
+        REQUIRE(scatter.hasReference());
+        REQUIRE(scatter.getMeanPosition(&latitude, &longitude, &altitude));
+        REQUIRE(latitude == STATION.latitude);
+        REQUIRE(longitude == STATION.longitude);
+        REQUIRE(altitude == STATION.altitude);
+        REQUIRE(scatter.getMeanOffset(SCATTER_NORTH) == 0.0f);
+        REQUIRE(scatter.getStdDev(SCATTER_UP) == 0.0f);
+        REQUIRE(scatter.getCep(0.95f) == 0.0f);
+        REQUIRE(scatter.getRadialHistogram().getCount() == 0);
+    }
+
+    SECTION("Unknown axes read zero") {
+        scatter.add(STATION.latitude, STATION.longitude, STATION.altitude);
+        scatter.add(STATION.latitude + 1e-5, STATION.longitude, STATION.altitude);
+        REQUIRE(scatter.getMeanOffset(SCATTER_AXIS_COUNT) == 0.0f);
+        REQUIRE(scatter.getStdDev(SCATTER_AXIS_COUNT) == 0.0f);
+    }
+
+    SECTION("Identical positions have no scatter") {
+        for (int i = 0; i < 100; i++) {
+            scatter.add(STATION.latitude, STATION.longitude, STATION.altitude);
+        }
+        REQUIRE(scatter.getCount() == 100);
+        REQUIRE(scatter.getStdDev(SCATTER_EAST) == 0.0f);
+        REQUIRE(scatter.getStdDev(SCATTER_NORTH) == 0.0f);
+        REQUIRE(scatter.getStdDev(SCATTER_UP) == 0.0f);
+        REQUIRE(scatter.getDrms2() == 0.0f);
+        REQUIRE(scatter.getCep(0.95f) == 0.0f);
+    }
+}
+
+TEST_CASE("PositionScatter - Means and deviations", "[PositionScatter]") {
+    struct Case {
+        const char* name;
+        double sigmaEast;
+        double sigmaNorth;
+        double sigmaUp;
+        size_t n;
+    };
+    const Case cases[] = {
+        {"RTK fixed", 0.008, 0.012, 0.020, 3600},
+        {"RTK float", 0.15, 0.25, 0.40, 3600},
+        {"GPS", 1.5, 2.5, 4.0, 86400},
+    };
+    uint32_t seed = 1;
+    for (const Case& c : cases) {
+        INFO(c.name);
+        std::vector<Position> positions = scatterAround(STATION, c.sigmaEast, c.sigmaNorth, c.sigmaUp, c.n, seed++);
+        PositionScatter scatter;
+        for (const Position& p : positions) {
+            scatter.add(p.latitude, p.longitude, p.altitude);
+        }
+        REQUIRE(scatter.getCount() == c.n);
+
+        // Welford matches a two-pass calculation over the same offsets
+        std::vector<double> axes[3];
+        localOffsets(positions, axes);
+        const ScatterAxis order[] = {SCATTER_EAST, SCATTER_NORTH, SCATTER_UP};
+        for (int a = 0; a < 3; a++) {
+            double mean;
+            double stdDev;
+            twoPass(axes[a], &mean, &stdDev);
+            REQUIRE(scatter.getMeanOffset(order[a]) == Approx(mean).margin(1e-6));
+            REQUIRE(scatter.getStdDev(order[a]) == Approx(stdDev).epsilon(1e-5));
+        }
+
+        // And the true scatter within the sampling error
+        REQUIRE(scatter.getStdDev(SCATTER_EAST) == Approx(c.sigmaEast).epsilon(0.05));
+        REQUIRE(scatter.getStdDev(SCATTER_NORTH) == Approx(c.sigmaNorth).epsilon(0.05));
+        REQUIRE(scatter.getStdDev(SCATTER_UP) == Approx(c.sigmaUp).epsilon(0.05));
+        double drms2 = 2.0 * sqrt(c.sigmaEast * c.sigmaEast + c.sigmaNorth * c.sigmaNorth);
+        REQUIRE(scatter.getDrms2() == Approx(drms2).epsilon(0.05));
+
+        // Mean position within a few standard errors of the station
+        double latitude;
+        double longitude;
+        float altitude;
+        REQUIRE(scatter.getMeanPosition(&latitude, &longitude, &altitude));
+        double north = (latitude - STATION.latitude) * METERS_PER_DEGREE;
+        double east = (longitude - STATION.longitude) * METERS_PER_DEGREE * cos(STATION.latitude * DEG_TO_RAD);
+        REQUIRE(fabs(north) < 5.0 * c.sigmaNorth / sqrt((double)c.n));
+        REQUIRE(fabs(east) < 5.0 * c.sigmaEast / sqrt((double)c.n));
+        REQUIRE(fabs(altitude - STATION.altitude) < 5.0 * c.sigmaUp / sqrt((double)c.n) + 1e-3);
+    }
+}
+
+TEST_CASE("PositionScatter - CEP", "[PositionScatter]") {
+    SECTION("Circular scatter matches the Rayleigh distribution") {
+        // CEP50 = 1.1774 sigma, CEP95 = 2.4477 sigma
+        const double sigma = 0.5;
+        std::vector<Position> positions = scatterAround(STATION, sigma, sigma, 1.0, 20000, 11);
+        PositionScatter scatter;
+        for (const Position& p : positions) {
+            scatter.add(p.latitude, p.longitude, p.altitude);
+        }
+        REQUIRE(scatter.getRadialHistogram().getCount() == positions.size() - 1);
+        REQUIRE(scatter.getCep(0.5f) == Approx(1.1774 * sigma).epsilon(0.08));
+        REQUIRE(scatter.getCep(0.95f) == Approx(2.4477 * sigma).epsilon(0.08));
+        REQUIRE(scatter.getCep(0.5f) < scatter.getCep(0.95f));
+    }
+
+    SECTION("Streaming CEP is close to the distances to the final mean") {
+        const double sigmas[][2] = {{0.01, 0.01}, {0.01, 0.03}, {2.0, 1.0}};
+        uint32_t seed = 20;
+        for (const auto& s : sigmas) {
+            std::vector<Position> positions = scatterAround(STATION, s[0], s[1], 0.1, 3600, seed++);
+            PositionScatter scatter;
+            for (const Position& p : positions) {
+                scatter.add(p.latitude, p.longitude, p.altitude);
+            }
+            std::vector<double> axes[3];
+            localOffsets(positions, axes);
+            double meanEast;
+            double meanNorth;
+            double unused;
+            twoPass(axes[0], &meanEast, &unused);
+            twoPass(axes[1], &meanNorth, &unused);
+            std::vector<double> distances;
+            for (size_t i = 0; i < positions.size(); i++) {
+                distances.push_back(hypot(axes[0][i] - meanEast, axes[1][i] - meanNorth));
+            }
+            std::sort(distances.begin(), distances.end());
+            double cep50 = distances[distances.size() / 2 - 1];
+            double cep95 = distances[(size_t)ceil(0.95 * distances.size()) - 1];
+            INFO("sigma " << s[0] << " x " << s[1] << ": CEP50 " << scatter.getCep(0.5f) << " exact " << cep50
+                 << ", CEP95 " << scatter.getCep(0.95f) << " exact " << cep95);
+            // Histogram resolution (1/16) plus sampling noise; 1 mm for the mm buckets
+            REQUIRE(fabs(scatter.getCep(0.5f) - cep50) <= 0.10 * cep50 + 0.001);
+            REQUIRE(fabs(scatter.getCep(0.95f) - cep95) <= 0.10 * cep95 + 0.001);
+        }
+    }
+
+    SECTION("Distances beyond the histogram range are counted as overflows and read as the largest one") {
+        PositionScatter scatter;
+        scatter.add(STATION.latitude, STATION.longitude, STATION.altitude);
+        Position far = offsetPosition(STATION, 0.0, 5000.0, 0.0);
+        scatter.add(far.latitude, far.longitude, far.altitude);
+        REQUIRE(scatter.getRadialHistogram().getOverflows() == 1);
+        // 5 km to the first sample, scaled by sqrt(1/2)
+        REQUIRE(scatter.getCep(0.5f) == Approx(5000.0 * sqrt(0.5)).epsilon(1e-4));
+    }
+}
+
+TEST_CASE("PositionScatter - Reference", "[PositionScatter]") {
+    SECTION("Recenter moves the reference to the mean and clears the samples") {
+        std::vector<Position> positions = scatterAround(offsetPosition(STATION, 3.0, -4.0, 2.0), 0.02, 0.02, 0.05, 1000, 5);
+        PositionScatter scatter;
+        for (const Position& p : positions) {
+            scatter.add(p.latitude, p.longitude, p.altitude);
+        }
+        double latitude;
+        double longitude;
+        float altitude;
+        scatter.getMeanPosition(&latitude, &longitude, &altitude);
+        scatter.recenter();
+        REQUIRE(scatter.getCount() == 0);
+        REQUIRE(scatter.hasReference());
+        REQUIRE(scatter.getRadialHistogram().getCount() == 0);
+
+        // The reference is kept without samples, and a repeat of the period is centered on it
+        double referenceLatitude;
+        double referenceLongitude;
+        float referenceAltitude;
+        REQUIRE_FALSE(scatter.getMeanPosition(&referenceLatitude, &referenceLongitude, &referenceAltitude));
+        REQUIRE(referenceLatitude == latitude);
+        REQUIRE(referenceLongitude == longitude);
+        REQUIRE(referenceAltitude == altitude);
+        for (const Position& p : positions) {
+            scatter.add(p.latitude, p.longitude, p.altitude);
+        }
+        REQUIRE(fabs(scatter.getMeanOffset(SCATTER_EAST)) < 1e-6);
+        REQUIRE(fabs(scatter.getMeanOffset(SCATTER_NORTH)) < 1e-6);
+        REQUIRE(fabs(scatter.getMeanOffset(SCATTER_UP)) < 1e-4);
+    }
+
+    SECTION("Reset keeps the reference, clear removes it") {
+        PositionScatter scatter;
+        scatter.add(STATION.latitude, STATION.longitude, STATION.altitude);
+        Position moved = offsetPosition(STATION, 10.0, 0.0, 0.0);
+        scatter.add(moved.latitude, moved.longitude, moved.altitude);
+        scatter.reset();
+        REQUIRE(scatter.getCount() == 0);
+        scatter.add(moved.latitude, moved.longitude, moved.altitude);
+        REQUIRE(scatter.getMeanOffset(SCATTER_EAST) == Approx(10.0).epsilon(1e-4));
+
+        scatter.clear();
+        REQUIRE_FALSE(scatter.hasReference());
+        scatter.add(moved.latitude, moved.longitude, moved.altitude);
+        REQUIRE(scatter.getMeanOffset(SCATTER_EAST) == 0.0f);
+    }
+
+    SECTION("Scatter across the antimeridian") {
+        const Position dateline = {-16.5, 179.99999, 5.0f};
+        std::vector<Position> positions = scatterAround(dateline, 1.0, 1.0, 1.0, 5000, 9);
+        size_t wrapped = 0;
+        for (const Position& p : positions) {
+            wrapped += p.longitude < 0.0 ? 1 : 0;
+        }
+        REQUIRE(wrapped > 0);
+        PositionScatter scatter;
+        for (const Position& p : positions) {
+            scatter.add(p.latitude, p.longitude, p.altitude);
+        }
+        REQUIRE(scatter.getStdDev(SCATTER_EAST) == Approx(1.0).epsilon(0.05));
+        double latitude;
+        double longitude;
+        scatter.getMeanPosition(&latitude, &longitude, NULL);
+        REQUIRE(longitude >= -180.0);
+        REQUIRE(longitude <= 180.0);
+        REQUIRE(fabs(fabs(longitude) - 180.0) < 1e-4);
+    }
+}
+
+TEST_CASE("PositionScatter - Long periods", "[PositionScatter]") {
+    // A day at 10 Hz of mm scatter 300 m from the reference: a float sum of
+    // squares loses the variance entirely, Welford keeps it
+    const Position origin = offsetPosition(STATION, 300.0, 200.0, 0.0);
+    std::mt19937 rng(3);
+    std::normal_distribution<double> noise(0.0, 0.005);
+    PositionScatter scatter;
+    scatter.add(STATION.latitude, STATION.longitude, STATION.altitude);
+    float sum = 0.0f;
+    float squares = 0.0f;
+    const uint32_t n = 864000;
+    for (uint32_t i = 0; i < n; i++) {
+        Position p = offsetPosition(origin, noise(rng), noise(rng), noise(rng));
+        scatter.add(p.latitude, p.longitude, p.altitude);
+        float north = (float)((p.latitude - STATION.latitude) * METERS_PER_DEGREE);
+        sum += north;
+        squares += north * north;
+    }
+    float naive = sqrtf(fabsf(squares / n - (sum / n) * (sum / n)));
+    INFO("naive float sigma " << naive);
+    REQUIRE(fabs(naive - 0.005) > 0.001);
+
+    // One distant first sample in 864001 adds about 0.24 m to the variance
+    // of the north axis; rebuild the expected value from the model
+    double expected = sqrt(0.005 * 0.005 * n / (n + 1.0) + 200.0 * 200.0 * n / ((n + 1.0) * (n + 1.0)));
+    REQUIRE(scatter.getStdDev(SCATTER_NORTH) == Approx(expected).epsilon(0.02));
+
+    // After a recenter the same noise reads back at mm level
+    scatter.recenter();
+    for (uint32_t i = 0; i < n; i++) {
+        Position p = offsetPosition(origin, noise(rng), noise(rng), noise(rng));
+        scatter.add(p.latitude, p.longitude, p.altitude);
+    }
+    REQUIRE(scatter.getStdDev(SCATTER_NORTH) == Approx(0.005).epsilon(0.02));
+    REQUIRE(scatter.getStdDev(SCATTER_EAST) == Approx(0.005).epsilon(0.02));
+    REQUIRE(scatter.getDrms2() == Approx(2.0 * sqrt(2.0) * 0.005).epsilon(0.02));
+}
+
+TEST_CASE("Position scatter benchmark - cost and accuracy", "[.benchmark]") {
+    const size_t n = 1000000;
+    std::vector<Position> positions = scatterAround(STATION, 0.010, 0.015, 0.025, n, 42);
+    std::vector<double> axes[3];
+    localOffsets(positions, axes);
+
+    // Online: Welford and the radial histogram
+    PositionScatter scatter;
+    auto start = std::chrono::steady_clock::now();
+    for (const Position& p : positions) {
+        scatter.add(p.latitude, p.longitude, p.altitude);
+    }
+    double onlineNs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e9 / n;
+
+    // Offline: keep every offset, two passes and a sort of the distances
+    start = std::chrono::steady_clock::now();
+    std::vector<double> kept[3];
+    for (int a = 0; a < 3; a++) {
+        kept[a].reserve(n);
+    }
+    for (size_t i = 0; i < n; i++) {
+        for (int a = 0; a < 3; a++) {
+            kept[a].push_back(axes[a][i]);
+        }
+    }
+    double means[3];
+    double sigmas[3];
+    for (int a = 0; a < 3; a++) {
+        twoPass(kept[a], &means[a], &sigmas[a]);
+    }
+    std::vector<double> distances;
+    distances.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        distances.push_back(hypot(kept[0][i] - means[0], kept[1][i] - means[1]));
+    }
+    std::sort(distances.begin(), distances.end());
+    double offlineNs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e9 / n;
+    double cep50 = distances[n / 2 - 1];
+    double cep95 = distances[(size_t)ceil(0.95 * n) - 1];
+    double drms2 = 2.0 * sqrt(sigmas[0] * sigmas[0] + sigmas[1] * sigmas[1]);
+
+    // HDOP x UERE as the statistics estimated it before, RTK fixed with HDOP 0.8
+    double hdopEstimate = 0.8 * 0.02;
+
+    printf("\nRTK fixed scatter (sigma 10/15/25 mm east/north/up), %u positions\n", (unsigned)n);
+    printf("method            ns/pos        bytes  std E mm  std N mm  std U mm  CEP50 mm  CEP95 mm  2DRMS mm\n");
+    printf("%-16s %7.1f %12u %9.2f %9.2f %9.2f %9.2f %9.2f %9.2f\n", "offline (sort)", offlineNs,
+           (unsigned)(n * 4 * sizeof(double)), sigmas[0] * 1000, sigmas[1] * 1000, sigmas[2] * 1000,
+           cep50 * 1000, cep95 * 1000, drms2 * 1000);
+    printf("%-16s %7.1f %12u %9.2f %9.2f %9.2f %9.2f %9.2f %9.2f\n", "online", onlineNs,
+           (unsigned)sizeof(PositionScatter), scatter.getStdDev(SCATTER_EAST) * 1000,
+           scatter.getStdDev(SCATTER_NORTH) * 1000, scatter.getStdDev(SCATTER_UP) * 1000,
+           scatter.getCep(0.5f) * 1000, scatter.getCep(0.95f) * 1000, scatter.getDrms2() * 1000);
+    printf("HDOP x UERE estimate: %.1f mm\n", hdopEstimate * 1000);
+}
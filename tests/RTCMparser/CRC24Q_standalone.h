@@ -0,0 +1,51 @@
+// Standalone CRC-24Q header for Code::Blocks testing
+/*!
+ * \file CRC24Q_standalone.h
+ * \brief Header file for CRC-24Q calculation.
+ *
+ * This file contains the function declarations for calculating the CRC-24Q
+ * checksum that protects every RTCM 3.x transport frame.
+ *
+ * \section crc24q_param CRC-24Q Parameterization
+ * The implemented CRC calculation is also known as:
+ *  - CRC-24/LTE-A
+ *  - CRC-24Q (Qualcomm)
+ *
+ * \section crc24q_details Parameterization Details
+ *  - Width: 24 bits
+ *  - Polynomial: 0x864CFB
+ *  - Initial Value: 0x000000
+ *  - Input Reflected: No
+ *  - Output Reflected: No
+ *  - Final XOR Value: 0x000000
+ *
+ * \section crc24q_usage Usage
+ * The checksum covers the preamble, the 6 reserved bits, the 10 bit length
+ * and the message payload. The incremental form allows the checksum to be
+ * computed while an RTCM stream is framed, without buffering the payload.
+ */
+
+#ifndef CRC24Q_STANDALONE_H
+#define CRC24Q_STANDALONE_H
+
+#include <cstdint>
+#include <stddef.h>
+
+/**
+ * \brief Continue a CRC-24Q calculation over the given data.
+ * \param[in] crc Running CRC value (use 0 for the first block).
+ * \param[in] data Pointer to the data buffer.
+ * \param[in] length Length of the data buffer.
+ * \return Updated CRC-24Q value (lower 24 bits).
+ */
+extern uint32_t updateCRC24Q(uint32_t crc, const uint8_t* data, size_t length);
+
+/**
+ * \brief Function to calculate CRC-24Q for the given data.
+ * \param[in] data Pointer to the data buffer.
+ * \param[in] length Length of the data buffer.
+ * \return Calculated CRC-24Q value (lower 24 bits).
+ */
+extern uint32_t calculateCRC24Q(const uint8_t* data, size_t length);
+
+#endif // CRC24Q_STANDALONE_H
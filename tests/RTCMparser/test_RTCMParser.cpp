@@ -0,0 +1,235 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch.hpp"
+#include "RTCMParser_standalone.h"
+#include "CRC24Q_standalone.h"
+#include <vector>
+#include <cstring>
+
+// Reference RTCM 1005 frame (stationary antenna reference point)
+static const uint8_t frame1005[] = {
+    0xD3, 0x00, 0x13, 0x3E, 0xD7, 0xD3, 0x02, 0x02, 0x98, 0x0E, 0xDE, 0xEF,
+    0x34, 0xB4, 0xBD, 0x62, 0xAC, 0x09, 0x41, 0x98, 0x6F, 0x33, 0x36, 0x0B, 0x98
+};
+
+// Helper to write bits MSB first into a payload buffer
+static void setBits(std::vector<uint8_t>& buffer, size_t pos, size_t len, uint64_t value) {
+    for (size_t i = 0; i < len; i++) {
+        size_t bit = pos + i;
+        uint8_t mask = (uint8_t)(0x80 >> (bit % 8));
+        if ((value >> (len - 1 - i)) & 0x01) {
+            buffer[bit / 8] |= mask;
+        } else {
+            buffer[bit / 8] &= (uint8_t)~mask;
+        }
+    }
+}
+
+// Helper to wrap a payload into a complete RTCM 3 frame
+static std::vector<uint8_t> makeFrame(const std::vector<uint8_t>& payload) {
+    std::vector<uint8_t> frame;
+    frame.push_back(0xD3);
+    frame.push_back((uint8_t)((payload.size() >> 8) & 0x03));
+    frame.push_back((uint8_t)(payload.size() & 0xFF));
+    frame.insert(frame.end(), payload.begin(), payload.end());
+    uint32_t crc = calculateCRC24Q(frame.data(), frame.size());
+    frame.push_back((uint8_t)(crc >> 16));
+    frame.push_back((uint8_t)(crc >> 8));
+    frame.push_back((uint8_t)crc);
+    return frame;
+}
+
+// Helper to build an MSM frame with the given header fields (observables zero filled)
+static std::vector<uint8_t> makeMsmFrame(uint16_t type, uint32_t epoch, bool multiple,
+                                         uint64_t satMask, uint32_t sigMask, size_t length = 60) {
+    std::vector<uint8_t> payload(length < 22 ? 22 : length, 0);
+    setBits(payload, 0, 12, type);
+    setBits(payload, 12, 12, 2003);     // Station ID
+    setBits(payload, 24, 30, epoch);
+    setBits(payload, 54, 1, multiple ? 1 : 0);
+    setBits(payload, 73, 64, satMask);
+    setBits(payload, 137, 32, sigMask);
+    payload.resize(length);
+    return makeFrame(payload);
+}
+
+// Collects callback results
+struct Collector {
+    std::vector<RTCMFrameInfo> frames;
+};
+
+static void collect(const RTCMFrameInfo& info, void* context) {
+    static_cast<Collector*>(context)->frames.push_back(info);
+}
+
+TEST_CASE("calculateCRC24Q - Check value", "[RTCMParser][CRC24Q]") {
+    const uint8_t check[] = "123456789";
+    REQUIRE(calculateCRC24Q(check, 9) == 0xCDE703);
+}
+
+TEST_CASE("calculateCRC24Q - Table matches the bitwise definition", "[RTCMParser][CRC24Q]") {
+    // A single byte runs through all 8 bits of the polynomial division
+    for (uint32_t value = 0; value < 256; value++) {
+        uint32_t crc = value << 16;
+        for (int bit = 0; bit < 8; bit++) {
+            crc <<= 1;
+            if (crc & 0x1000000) {
+                crc ^= 0x864CFB;
+            }
+        }
+        const uint8_t byte = (uint8_t)value;
+        REQUIRE(calculateCRC24Q(&byte, 1) == (crc & 0xFFFFFF));
+    }
+}
+
+TEST_CASE("updateCRC24Q - Incremental equals one shot", "[RTCMParser][CRC24Q]") {
+    uint32_t crc = updateCRC24Q(0, frame1005, 10);
+    crc = updateCRC24Q(crc, frame1005 + 10, sizeof(frame1005) - 3 - 10);
+    REQUIRE(crc == calculateCRC24Q(frame1005, sizeof(frame1005) - 3));
+    REQUIRE(crc == 0x360B98);
+}
+
+TEST_CASE("RTCMParser - Reference 1005 frame", "[RTCMParser]") {
+    RTCMParser parser;
+    Collector collector;
+    parser.setFrameCallback(collect, &collector);
+
+    REQUIRE(parser.parse(frame1005, sizeof(frame1005)) == 1);
+    REQUIRE(collector.frames.size() == 1);
+    REQUIRE(collector.frames[0].messageType == 1005);
+    REQUIRE(collector.frames[0].length == 19);
+    REQUIRE_FALSE(collector.frames[0].isMsm);
+    REQUIRE(parser.getCrcErrorCount() == 0);
+    REQUIRE(parser.getDiscardedBytes() == 0);
+}
+
+TEST_CASE("RTCMParser - Frames split over arbitrary reads", "[RTCMParser]") {
+    std::vector<uint8_t> stream;
+    for (int i = 0; i < 3; i++) {
+        stream.insert(stream.end(), frame1005, frame1005 + sizeof(frame1005));
+    }
+
+    SECTION("One byte at a time") {
+        RTCMParser parser;
+        size_t frames = 0;
+        for (size_t i = 0; i < stream.size(); i++) {
+            frames += parser.parse(&stream[i], 1);
+        }
+        REQUIRE(frames == 3);
+    }
+
+    SECTION("Uneven chunks") {
+        RTCMParser parser;
+        size_t frames = parser.parse(stream.data(), 7);
+        frames += parser.parse(stream.data() + 7, 30);
+        frames += parser.parse(stream.data() + 37, stream.size() - 37);
+        REQUIRE(frames == 3);
+        REQUIRE(parser.getFrameCount() == 3);
+    }
+}
+
+TEST_CASE("RTCMParser - Garbage and corrupted frames", "[RTCMParser]") {
+    RTCMParser parser;
+    std::vector<uint8_t> stream;
+
+    SECTION("Leading garbage is skipped") {
+        const uint8_t garbage[] = { 0x00, 0x55, 0xD3, 0xFF, 0x12 };
+        stream.insert(stream.end(), garbage, garbage + sizeof(garbage));
+        stream.insert(stream.end(), frame1005, frame1005 + sizeof(frame1005));
+        REQUIRE(parser.parse(stream.data(), stream.size()) == 1);
+        REQUIRE(parser.getDiscardedBytes() == sizeof(garbage));
+    }
+
+    SECTION("CRC error is counted and stream recovers") {
+        stream.insert(stream.end(), frame1005, frame1005 + sizeof(frame1005));
+        stream[10] ^= 0x01;
+        stream.insert(stream.end(), frame1005, frame1005 + sizeof(frame1005));
+        REQUIRE(parser.parse(stream.data(), stream.size()) == 1);
+        REQUIRE(parser.getCrcErrorCount() == 1);
+        REQUIRE(parser.getFrameCount() == 1);
+    }
+}
+
+TEST_CASE("RTCMParser - classifyMessage", "[RTCMParser]") {
+    uint8_t msm = 0;
+    REQUIRE(RTCMParser::classifyMessage(1074, &msm) == RTCM_CONST_GPS);
+    REQUIRE(msm == 4);
+    REQUIRE(RTCMParser::classifyMessage(1087, &msm) == RTCM_CONST_GLONASS);
+    REQUIRE(msm == 7);
+    REQUIRE(RTCMParser::classifyMessage(1094, &msm) == RTCM_CONST_GALILEO);
+    REQUIRE(RTCMParser::classifyMessage(1127, &msm) == RTCM_CONST_BEIDOU);
+    REQUIRE(RTCMParser::classifyMessage(1005, &msm) == RTCM_CONST_NONE);
+    REQUIRE(RTCMParser::classifyMessage(1117, &msm) == RTCM_CONST_NONE); // QZSS not tracked
+}
+
+TEST_CASE("RTCMParser - MSM header decoding", "[RTCMParser][MSM]") {
+    RTCMParser parser;
+    Collector collector;
+    parser.setFrameCallback(collect, &collector);
+
+    // GPS MSM4: satellites 1, 3 and 32; signals 2 (L1C) and 16 (L2W)
+    uint64_t satMask = (1ULL << 63) | (1ULL << 61) | (1ULL << 32);
+    uint32_t sigMask = (1UL << 30) | (1UL << 16);
+    std::vector<uint8_t> frame = makeMsmFrame(1074, 345600000, false, satMask, sigMask);
+
+    REQUIRE(parser.parse(frame.data(), frame.size()) == 1);
+    REQUIRE(collector.frames.size() == 1);
+    const RTCMFrameInfo& info = collector.frames[0];
+    REQUIRE(info.isMsm);
+    REQUIRE(info.msm.constellation == RTCM_CONST_GPS);
+    REQUIRE(info.msm.msmType == 4);
+    REQUIRE(info.msm.stationId == 2003);
+    REQUIRE(info.msm.epochTime == 345600000);
+    REQUIRE(info.msm.satelliteMask == satMask);
+    REQUIRE(info.msm.signalMask == sigMask);
+    REQUIRE(info.msm.satellites == 3);
+    REQUIRE(info.msm.signals == 2);
+    REQUIRE(info.msm.epochComplete);
+    REQUIRE(info.msm.epochSatellites == 3);
+}
+
+TEST_CASE("RTCMParser - MSM epoch spread over multiple messages", "[RTCMParser][MSM]") {
+    RTCMParser parser;
+    Collector collector;
+    parser.setFrameCallback(collect, &collector);
+
+    std::vector<uint8_t> stream;
+    std::vector<uint8_t> part1 = makeMsmFrame(1127, 1000, true, 0xFF00000000000000ULL, 0x80000000);
+    std::vector<uint8_t> part2 = makeMsmFrame(1127, 1000, false, 0x00F0000000000000ULL, 0x40000000);
+    std::vector<uint8_t> gal = makeMsmFrame(1097, 1000, false, 0x0000000000000003ULL, 0x00000001);
+    stream.insert(stream.end(), part1.begin(), part1.end());
+    stream.insert(stream.end(), gal.begin(), gal.end());
+    stream.insert(stream.end(), part2.begin(), part2.end());
+
+    REQUIRE(parser.parse(stream.data(), stream.size()) == 3);
+    REQUIRE(collector.frames.size() == 3);
+
+    SECTION("First part does not complete the epoch") {
+        REQUIRE(collector.frames[0].msm.constellation == RTCM_CONST_BEIDOU);
+        REQUIRE_FALSE(collector.frames[0].msm.epochComplete);
+        REQUIRE(collector.frames[0].msm.epochSatellites == 8);
+    }
+
+    SECTION("Other constellations are accumulated independently") {
+        REQUIRE(collector.frames[1].msm.constellation == RTCM_CONST_GALILEO);
+        REQUIRE(collector.frames[1].msm.epochComplete);
+        REQUIRE(collector.frames[1].msm.epochSatellites == 2);
+    }
+
+    SECTION("Last part reports the union of the epoch") {
+        REQUIRE(collector.frames[2].msm.epochComplete);
+        REQUIRE(collector.frames[2].msm.satellites == 4);
+        REQUIRE(collector.frames[2].msm.epochSatellites == 12);
+        REQUIRE(collector.frames[2].msm.epochSignals == 2);
+    }
+}
+
+TEST_CASE("RTCMParser - Truncated MSM payload is not decoded", "[RTCMParser][MSM]") {
+    RTCMParser parser;
+    Collector collector;
+    parser.setFrameCallback(collect, &collector);
+
+    std::vector<uint8_t> frame = makeMsmFrame(1077, 0, false, 1ULL << 63, 1UL << 31, 21);
+    REQUIRE(parser.parse(frame.data(), frame.size()) == 1);
+    REQUIRE(collector.frames[0].messageType == 1077);
+    REQUIRE_FALSE(collector.frames[0].isMsm);
+}
@@ -0,0 +1,110 @@
+// Standalone build for statistics counter tests using Code::Blocks
+// This file contains a copy of the StatCounters implementation for standalone compilation
+
+#include <atomic>
+#include <cstdint>
+#include <stddef.h>
+
+#include "StatCounters_standalone.h"
+
+StatCounters::StatCounters(size_t producers, size_t counters)
+    : producerCount(0),
+      counterCount(0) {
+    for (size_t p = 0; p < STAT_COUNTERS_MAX_PRODUCERS; p++) {
+        shards[p].sequence.store(0, std::memory_order_relaxed);
+        for (size_t c = 0; c < STAT_COUNTERS_MAX_COUNTERS; c++) {
+            shards[p].counters[c].low.store(0, std::memory_order_relaxed);
+            shards[p].counters[c].high.store(0, std::memory_order_relaxed);
+        }
+    }
+    if (producers > 0 && producers <= STAT_COUNTERS_MAX_PRODUCERS &&
+        counters > 0 && counters <= STAT_COUNTERS_MAX_COUNTERS) {
+        producerCount = producers;
+        counterCount = counters;
+    }
+}
+
+void StatCounters::beginUpdate(int producer) {
+    if (producer < 0 || (size_t)producer >= producerCount) {
+        return;
+    }
+    // Only this producer writes the sequence, a plain increment is enough
+    std::atomic<uint32_t>& sequence = shards[producer].sequence;
+    sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    // The odd sequence must be visible before any counter changes
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void StatCounters::add(int producer, size_t counter, uint64_t delta) {
+    if (producer < 0 || (size_t)producer >= producerCount || counter >= counterCount) {
+        return;
+    }
+    Counter& c = shards[producer].counters[counter];
+    uint64_t value = ((uint64_t)c.high.load(std::memory_order_relaxed) << 32) |
+                     c.low.load(std::memory_order_relaxed);
+    value += delta;
+    c.low.store((uint32_t)value, std::memory_order_relaxed);
+    c.high.store((uint32_t)(value >> 32), std::memory_order_relaxed);
+}
+
+void StatCounters::set(int producer, size_t counter, uint64_t value) {
+    if (producer < 0 || (size_t)producer >= producerCount || counter >= counterCount) {
+        return;
+    }
+    Counter& c = shards[producer].counters[counter];
+    c.low.store((uint32_t)value, std::memory_order_relaxed);
+    c.high.store((uint32_t)(value >> 32), std::memory_order_relaxed);
+}
+
+void StatCounters::endUpdate(int producer) {
+    if (producer < 0 || (size_t)producer >= producerCount) {
+        return;
+    }
+    // Release: the counters are visible before the even sequence
+    std::atomic<uint32_t>& sequence = shards[producer].sequence;
+    sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+bool StatCounters::read(int producer, uint64_t* values, unsigned attempts) const {
+    if (producer < 0 || (size_t)producer >= producerCount || values == NULL) {
+        return false;
+    }
+    const Shard& shard = shards[producer];
+    for (unsigned attempt = 0; attempt < attempts; attempt++) {
+        uint32_t before = shard.sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+        for (size_t c = 0; c < counterCount; c++) {
+            values[c] = ((uint64_t)shard.counters[c].high.load(std::memory_order_relaxed) << 32) |
+                        shard.counters[c].low.load(std::memory_order_relaxed);
+        }
+        // The counter loads complete before the sequence is checked again
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (shard.sequence.load(std::memory_order_relaxed) == before) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool StatCounters::sum(uint64_t* values, unsigned attempts) const {
+    if (values == NULL || producerCount == 0) {
+        return false;
+    }
+    uint64_t shard[STAT_COUNTERS_MAX_COUNTERS];
+    for (size_t c = 0; c < counterCount; c++) {
+        values[c] = 0;
+    }
+    bool complete = true;
+    for (size_t p = 0; p < producerCount; p++) {
+        if (!read((int)p, shard, attempts)) {
+            complete = false;
+            continue;
+        }
+        for (size_t c = 0; c < counterCount; c++) {
+            values[c] += shard[c];
+        }
+    }
+    return complete;
+}
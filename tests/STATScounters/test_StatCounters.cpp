@@ -0,0 +1,371 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch.hpp"
+#include "StatCounters_standalone.h"
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Counter layout of statisticsTask.cpp
+static const size_t PRODUCERS = 2;      // NTRIP and GNSS tasks
+static const size_t COUNTERS = 23;
+
+TEST_CASE("StatCounters - Setup and arguments", "[StatCounters]") {
+    uint64_t values[STAT_COUNTERS_MAX_COUNTERS];
+
+    SECTION("Invalid sizes give an object without shards") {
+        StatCounters none(0, 4);
+        StatCounters noCounters(2, 0);
+        StatCounters tooManyProducers(STAT_COUNTERS_MAX_PRODUCERS + 1, 4);
+        StatCounters tooManyCounters(2, STAT_COUNTERS_MAX_COUNTERS + 1);
+        REQUIRE(none.getProducerCount() == 0);
+        REQUIRE(noCounters.getCounterCount() == 0);
+        REQUIRE(tooManyProducers.getProducerCount() == 0);
+        REQUIRE(tooManyCounters.getProducerCount() == 0);
+
+        none.beginUpdate(0);
+        none.add(0, 0, 1);
+        none.endUpdate(0);
+        REQUIRE_FALSE(none.read(0, values, 1));
+        REQUIRE_FALSE(none.sum(values, 1));
+    }
+
+    SECTION("Maximum sizes") {
+        StatCounters counters(STAT_COUNTERS_MAX_PRODUCERS, STAT_COUNTERS_MAX_COUNTERS);
+        REQUIRE(counters.getProducerCount() == STAT_COUNTERS_MAX_PRODUCERS);
+        REQUIRE(counters.getCounterCount() == STAT_COUNTERS_MAX_COUNTERS);
+        REQUIRE(counters.sum(values, 1));
+        for (size_t c = 0; c < STAT_COUNTERS_MAX_COUNTERS; c++) {
+            REQUIRE(values[c] == 0);
+        }
+    }
+
+    SECTION("Unknown producers and counters are ignored") {
+        StatCounters counters(PRODUCERS, COUNTERS);
+        counters.beginUpdate(-1);
+        counters.add(-1, 0, 5);
+        counters.endUpdate(-1);
+        counters.beginUpdate((int)PRODUCERS);
+        counters.add((int)PRODUCERS, 0, 5);
+        counters.endUpdate((int)PRODUCERS);
+        counters.beginUpdate(0);
+        counters.add(0, COUNTERS, 5);
+        counters.set(0, COUNTERS, 5);
+        counters.endUpdate(0);
+
+        REQUIRE(counters.sum(values, 1));
+        for (size_t c = 0; c < COUNTERS; c++) {
+            REQUIRE(values[c] == 0);
+        }
+        REQUIRE_FALSE(counters.read(-1, values, 1));
+        REQUIRE_FALSE(counters.read((int)PRODUCERS, values, 1));
+        REQUIRE_FALSE(counters.read(0, NULL, 1));
+        REQUIRE_FALSE(counters.sum(NULL, 1));
+        REQUIRE_FALSE(counters.read(0, values, 0));
+    }
+}
+
+TEST_CASE("StatCounters - Add, set and sum", "[StatCounters]") {
+    StatCounters counters(PRODUCERS, COUNTERS);
+    uint64_t values[STAT_COUNTERS_MAX_COUNTERS];
+
+    SECTION("Shards are summed per counter") {
+        counters.beginUpdate(0);
+        counters.add(0, 0, 1000);
+        counters.add(0, 1, 3);
+        counters.endUpdate(0);
+        counters.beginUpdate(1);
+        counters.add(1, 1, 2);
+        counters.add(1, 2, 7);
+        counters.endUpdate(1);
+        counters.beginUpdate(0);
+        counters.add(0, 0, 24);
+        counters.endUpdate(0);
+
+        REQUIRE(counters.read(0, values, 1));
+        REQUIRE(values[0] == 1024);
+        REQUIRE(values[1] == 3);
+        REQUIRE(values[2] == 0);
+        REQUIRE(counters.read(1, values, 1));
+        REQUIRE(values[0] == 0);
+        REQUIRE(values[1] == 2);
+        REQUIRE(values[2] == 7);
+        REQUIRE(counters.sum(values, 1));
+        REQUIRE(values[0] == 1024);
+        REQUIRE(values[1] == 5);
+        REQUIRE(values[2] == 7);
+    }
+
+    SECTION("Counters are 64 bit") {
+        counters.beginUpdate(0);
+        counters.add(0, 0, 0xFFFFFFFFULL);
+        counters.endUpdate(0);
+        counters.beginUpdate(0);
+        counters.add(0, 0, 1);
+        counters.endUpdate(0);
+        counters.beginUpdate(1);
+        counters.add(1, 0, 0x200000000ULL);
+        counters.endUpdate(1);
+        REQUIRE(counters.sum(values, 1));
+        REQUIRE(values[0] == 0x300000000ULL);
+    }
+
+    SECTION("Negative deltas read back as int64_t") {
+        counters.beginUpdate(1);
+        counters.add(1, 5, (uint64_t)(int64_t)100);
+        counters.add(1, 5, (uint64_t)(int64_t)-250);
+        counters.endUpdate(1);
+        REQUIRE(counters.sum(values, 1));
+        REQUIRE((int64_t)values[5] == -150);
+
+        uint64_t base = values[5];
+        counters.beginUpdate(1);
+        counters.add(1, 5, (uint64_t)(int64_t)-50);
+        counters.endUpdate(1);
+        REQUIRE(counters.sum(values, 1));
+        REQUIRE((int64_t)(values[5] - base) == -50);
+    }
+
+    SECTION("Set overwrites a value") {
+        counters.beginUpdate(0);
+        counters.set(0, 3, 1792000000ULL);
+        counters.endUpdate(0);
+        counters.beginUpdate(0);
+        counters.set(0, 3, 1792000042ULL);
+        counters.endUpdate(0);
+        REQUIRE(counters.sum(values, 1));
+        REQUIRE(values[3] == 1792000042ULL);
+    }
+}
+
+TEST_CASE("StatCounters - A reader never sees an update in progress", "[StatCounters]") {
+    StatCounters counters(PRODUCERS, COUNTERS);
+    uint64_t values[STAT_COUNTERS_MAX_COUNTERS];
+
+    counters.beginUpdate(0);
+    counters.add(0, 0, 10);
+    counters.add(0, 1, 20);
+    counters.endUpdate(0);
+
+    // Producer 0 is preempted halfway through its next update
+    counters.beginUpdate(0);
+    counters.add(0, 0, 1);
+    REQUIRE_FALSE(counters.read(0, values, 100));
+    REQUIRE_FALSE(counters.sum(values, 100));
+
+    // Producer 1 is not affected
+    counters.beginUpdate(1);
+    counters.add(1, 0, 5);
+    counters.endUpdate(1);
+    REQUIRE(counters.read(1, values, 1));
+    REQUIRE(values[0] == 5);
+
+    counters.add(0, 1, 2);
+    counters.endUpdate(0);
+    REQUIRE(counters.read(0, values, 1));
+    REQUIRE(values[0] == 11);
+    REQUIRE(values[1] == 22);
+    REQUIRE(counters.sum(values, 1));
+    REQUIRE(values[0] == 16);
+}
+
+// One update of a test producer: events, bytes = 3 per event, a 64 bit counter
+// that carries into the high word every 16 events
+static const uint64_t WIDE_STEP = 0x10000000ULL;
+
+static void producerLoop(StatCounters* counters, int producer, uint32_t updates) {
+    for (uint32_t i = 0; i < updates; i++) {
+        counters->beginUpdate(producer);
+        counters->add(producer, 0, 1);
+        if ((i & 63) == 0) {
+            // Give the reader a chance to meet an update in progress
+            std::this_thread::yield();
+        }
+        counters->add(producer, 1, 3);
+        counters->add(producer, 2, WIDE_STEP);
+        counters->endUpdate(producer);
+    }
+}
+
+TEST_CASE("StatCounters - Concurrent producers and a reader", "[StatCounters]") {
+    const int producers = 3;
+    const uint32_t updates = 200000;
+    StatCounters counters(producers, 3);
+    std::atomic<bool> done(false);
+    uint32_t snapshots = 0;
+    uint32_t busy = 0;
+    uint32_t errors = 0;
+
+    std::thread reader([&]() {
+        uint64_t last[producers] = {0, 0, 0};
+        uint64_t values[STAT_COUNTERS_MAX_COUNTERS];
+        while (!done.load()) {
+            for (int p = 0; p < producers; p++) {
+                if (!counters.read(p, values, 1)) {
+                    busy++;
+                    continue;
+                }
+                snapshots++;
+                // All counters of an update or none of them, never a torn 64 bit value
+                if (values[1] != 3 * values[0] || values[2] != WIDE_STEP * values[0] || values[0] < last[p]) {
+                    errors++;
+                }
+                last[p] = values[0];
+            }
+        }
+    });
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.push_back(std::thread(producerLoop, &counters, p, updates));
+    }
+    for (size_t t = 0; t < threads.size(); t++) {
+        threads[t].join();
+    }
+    done.store(true);
+    reader.join();
+
+    INFO("snapshots " << snapshots << ", busy " << busy);
+    REQUIRE(errors == 0);
+    REQUIRE(snapshots > 0);
+
+    uint64_t values[STAT_COUNTERS_MAX_COUNTERS];
+    REQUIRE(counters.sum(values, 1));
+    REQUIRE(values[0] == (uint64_t)producers * updates);
+    REQUIRE(values[1] == 3ULL * producers * updates);
+    REQUIRE(values[2] == WIDE_STEP * producers * updates);
+    for (int p = 0; p < producers; p++) {
+        REQUIRE(counters.read(p, values, 1));
+        REQUIRE(values[0] == updates);
+    }
+}
+
+// Benchmark: the RTCM hook (bytes and messages, runtime and period) under contention
+
+// The former statistics_rtcm_received(): one mutex, runtime and period counters
+struct MutexStats {
+    std::mutex mutex;
+    uint64_t bytesTotal;
+    uint32_t messagesTotal;
+    uint32_t bytesPeriod;
+    uint32_t messagesPeriod;
+    uint32_t waited;    // Calls that found the mutex taken
+};
+
+// Shared atomic counters: lock-free, but one contended cache line and no consistent pair
+struct AtomicStats {
+    std::atomic<uint64_t> bytes;
+    std::atomic<uint64_t> messages;
+};
+
+enum BenchMode { MODE_MUTEX, MODE_ATOMIC, MODE_SHARDS };
+
+struct BenchResult {
+    double nsPerCall;
+    uint32_t waited;
+    uint32_t snapshots;
+    uint32_t busy;
+};
+
+static BenchResult runBenchmark(BenchMode mode, int producers, uint32_t calls) {
+    MutexStats mutexStats;
+    mutexStats.bytesTotal = 0;
+    mutexStats.messagesTotal = 0;
+    mutexStats.bytesPeriod = 0;
+    mutexStats.messagesPeriod = 0;
+    mutexStats.waited = 0;
+    AtomicStats atomicStats;
+    atomicStats.bytes.store(0);
+    atomicStats.messages.store(0);
+    StatCounters shards(producers, 2);
+
+    std::atomic<bool> done(false);
+    BenchResult result;
+    result.snapshots = 0;
+    result.busy = 0;
+
+    // The statistics task and the web server read about every millisecond
+    std::thread reader([&]() {
+        uint64_t values[STAT_COUNTERS_MAX_COUNTERS];
+        volatile uint64_t sink = 0;
+        while (!done.load()) {
+            if (mode == MODE_MUTEX) {
+                std::lock_guard<std::mutex> lock(mutexStats.mutex);
+                sink = mutexStats.bytesTotal + mutexStats.messagesTotal;
+            } else if (mode == MODE_ATOMIC) {
+                sink = atomicStats.bytes.load() + atomicStats.messages.load();
+            } else {
+                for (int p = 0; p < producers; p++) {
+                    if (shards.read(p, values, 1)) {
+                        sink = values[0];
+                    } else {
+                        result.busy++;
+                    }
+                }
+            }
+            result.snapshots++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        (void)sink;
+    });
+
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int p = 0; p < producers; p++) {
+        threads.push_back(std::thread([&, p]() {
+            for (uint32_t i = 0; i < calls; i++) {
+                uint32_t bytes = 100 + (i & 511);
+                if (mode == MODE_MUTEX) {
+                    if (!mutexStats.mutex.try_lock()) {
+                        mutexStats.mutex.lock();
+                        mutexStats.waited++;
+                    }
+                    mutexStats.bytesTotal += bytes;
+                    mutexStats.messagesTotal += 1;
+                    mutexStats.bytesPeriod += bytes;
+                    mutexStats.messagesPeriod += 1;
+                    mutexStats.mutex.unlock();
+                } else if (mode == MODE_ATOMIC) {
+                    atomicStats.bytes.fetch_add(bytes);
+                    atomicStats.messages.fetch_add(1);
+                } else {
+                    shards.beginUpdate(p);
+                    shards.add(p, 0, bytes);
+                    shards.add(p, 1, 1);
+                    shards.endUpdate(p);
+                }
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); t++) {
+        threads[t].join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    done.store(true);
+    reader.join();
+
+    result.nsPerCall = seconds * 1e9 / ((double)calls * producers);
+    result.waited = mutexStats.waited;
+    return result;
+}
+
+TEST_CASE("Statistics counters benchmark - hook cost under contention", "[.benchmark]") {
+    const uint32_t calls = 5000000;
+    const char* names[3] = {"mutex", "shared atomic", "per producer"};
+
+    printf("\nHook with bytes and messages, %u calls per producer, reader every 1 ms (%u CPUs)\n",
+           calls, std::thread::hardware_concurrency());
+    printf("%-14s %9s %12s %14s %11s %11s\n", "counters", "producers", "ns per call", "calls waited",
+           "snapshots", "busy reads");
+    const int producerCounts[3] = {1, 2, 4};
+    for (int m = 0; m < 3; m++) {
+        for (int c = 0; c < 3; c++) {
+            BenchResult r = runBenchmark((BenchMode)m, producerCounts[c], calls);
+            printf("%-14s %9d %12.1f %14u %11u %11u\n", names[m], producerCounts[c], r.nsPerCall,
+                   r.waited, r.snapshots, r.busy);
+        }
+    }
+}
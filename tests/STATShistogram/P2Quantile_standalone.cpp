@@ -0,0 +1,104 @@
+// Standalone build for statistics histogram tests using Code::Blocks
+// This file contains a copy of the P2Quantile implementation for standalone compilation
+
+#include <cstdint>
+#include <math.h>
+
+#include "P2Quantile_standalone.h"
+
+P2Quantile::P2Quantile(float quantile)
+    : p(quantile < 0.0f ? 0.0f : (quantile > 1.0f ? 1.0f : quantile)) {
+    reset();
+}
+
+void P2Quantile::reset() {
+    count = 0;
+    for (int i = 0; i < P2_QUANTILE_MARKERS; i++) {
+        heights[i] = 0.0f;
+        positions[i] = i + 1;
+    }
+    increments[0] = 0.0f;
+    increments[1] = p / 2.0f;
+    increments[2] = p;
+    increments[3] = (1.0f + p) / 2.0f;
+    increments[4] = 1.0f;
+}
+
+float P2Quantile::parabolic(int i, int d) const {
+    float n0 = (float)positions[i - 1];
+    float n1 = (float)positions[i];
+    float n2 = (float)positions[i + 1];
+    return heights[i] + d / (n2 - n0) *
+           ((n1 - n0 + d) * (heights[i + 1] - heights[i]) / (n2 - n1) +
+            (n2 - n1 - d) * (heights[i] - heights[i - 1]) / (n1 - n0));
+}
+
+float P2Quantile::linear(int i, int d) const {
+    return heights[i] + d * (heights[i + d] - heights[i]) / (float)(positions[i + d] - positions[i]);
+}
+
+void P2Quantile::add(float value) {
+    if (count < P2_QUANTILE_MARKERS) {
+        // Keep the first samples sorted; they become the initial markers
+        int i = (int)count;
+        while (i > 0 && heights[i - 1] > value) {
+            heights[i] = heights[i - 1];
+            i--;
+        }
+        heights[i] = value;
+        count++;
+        return;
+    }
+    count++;
+
+    // Cell of the sample; the outer markers follow minimum and maximum
+    int k;
+    if (value < heights[0]) {
+        heights[0] = value;
+        k = 0;
+    } else if (value >= heights[4]) {
+        heights[4] = value;
+        k = 3;
+    } else {
+        k = 0;
+        while (k < 3 && value >= heights[k + 1]) {
+            k++;
+        }
+    }
+    for (int i = k + 1; i < P2_QUANTILE_MARKERS; i++) {
+        positions[i]++;
+    }
+
+    // Move the middle markers that are a position or more off. The desired
+    // position is calculated from the count, not accumulated: a float sum of
+    // small increments stops growing after about a million samples.
+    for (int i = 1; i < P2_QUANTILE_MARKERS - 1; i++) {
+        float offset = (float)(1.0 + (double)(count - 1) * increments[i] - positions[i]);
+        if ((offset >= 1.0f && positions[i + 1] - positions[i] > 1) ||
+            (offset <= -1.0f && positions[i - 1] - positions[i] < -1)) {
+            int d = offset > 0.0f ? 1 : -1;
+            float height = parabolic(i, d);
+            if (heights[i - 1] < height && height < heights[i + 1]) {
+                heights[i] = height;
+            } else {
+                heights[i] = linear(i, d);
+            }
+            positions[i] += d;
+        }
+    }
+}
+
+float P2Quantile::get() const {
+    if (count == 0) {
+        return 0.0f;
+    }
+    if (count > P2_QUANTILE_MARKERS) {
+        return heights[2];
+    }
+    // Exact quantile of the few sorted samples
+    uint32_t rank = (uint32_t)ceilf(p * count);
+    if (rank < 1) {
+        rank = 1;
+    }
+    return heights[rank - 1];
+}
@@ -0,0 +1,521 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch.hpp"
+#include "LogHistogram_standalone.h"
+#include "P2Quantile_standalone.h"
+#include <math.h>
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+static const float QUANTILES[] = {0.01f, 0.10f, 0.50f, 0.90f, 0.99f, 0.999f};
+static const size_t QUANTILE_COUNT = sizeof(QUANTILES) / sizeof(QUANTILES[0]);
+
+// Exact quantile with the rank definition of LogHistogram::quantile()
+static uint32_t exactQuantile(const std::vector<uint32_t>& sorted, float q) {
+    uint32_t rank = (uint32_t)ceilf(q * sorted.size());
+    if (rank < 1) {
+        rank = 1;
+    }
+    return sorted[rank - 1];
+}
+
+// Fraction of the samples at or below a value
+static double rankOf(const std::vector<float>& sorted, float value) {
+    return (double)(std::upper_bound(sorted.begin(), sorted.end(), value) - sorted.begin()) / sorted.size();
+}
+
+// Latency-like samples in microseconds: log-normal around 2 ms with a tail
+static std::vector<uint32_t> latencySamples(size_t n, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::lognormal_distribution<double> body(log(2000.0), 0.5);
+    std::uniform_real_distribution<double> tail(0.0, 1.0);
+    std::vector<uint32_t> samples;
+    samples.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        double value = body(rng);
+        if (tail(rng) < 0.01) {
+            value *= 20.0;      // 1% of the epochs wait for a blocked task
+        }
+        samples.push_back((uint32_t)std::min(value, (double)LOG_HISTOGRAM_MAX_VALUE));
+    }
+    return samples;
+}
+
+TEST_CASE("LogHistogram - Bucket layout", "[LogHistogram]") {
+    SECTION("Buckets are contiguous from 0 to the maximum value") {
+        REQUIRE(LogHistogram::bucketLow(0) == 0);
+        for (size_t i = 0; i + 1 < LOG_HISTOGRAM_BUCKETS; i++) {
+            REQUIRE(LogHistogram::bucketHigh(i) + 1 == LogHistogram::bucketLow(i + 1));
+        }
+        REQUIRE(LogHistogram::bucketHigh(LOG_HISTOGRAM_BUCKETS - 1) == LOG_HISTOGRAM_MAX_VALUE);
+    }
+
+    SECTION("Every bucket holds its bounds") {
+        for (size_t i = 0; i < LOG_HISTOGRAM_BUCKETS; i++) {
+            REQUIRE(LogHistogram::bucketIndex(LogHistogram::bucketLow(i)) == i);
+            REQUIRE(LogHistogram::bucketIndex(LogHistogram::bucketHigh(i)) == i);
+        }
+    }
+
+    SECTION("Values up to 8 have a bucket each, larger buckets are at most 1/8 of their value wide") {
+        for (uint32_t v = 0; v < 8; v++) {
+            REQUIRE(LogHistogram::bucketLow(LogHistogram::bucketIndex(v)) == v);
+            REQUIRE(LogHistogram::bucketHigh(LogHistogram::bucketIndex(v)) == v);
+        }
+        for (size_t i = 8; i < LOG_HISTOGRAM_BUCKETS; i++) {
+            uint32_t width = LogHistogram::bucketHigh(i) - LogHistogram::bucketLow(i) + 1;
+            REQUIRE(width * 8 <= LogHistogram::bucketLow(i));
+        }
+    }
+
+    SECTION("Values above the range go to the top bucket") {
+        REQUIRE(LogHistogram::bucketIndex(LOG_HISTOGRAM_MAX_VALUE + 1) == LOG_HISTOGRAM_BUCKETS - 1);
+        REQUIRE(LogHistogram::bucketIndex(UINT32_MAX) == LOG_HISTOGRAM_BUCKETS - 1);
+    }
+}
+
+TEST_CASE("LogHistogram - Recording", "[LogHistogram]") {
+    LogHistogram histogram;
+
+    SECTION("An empty histogram reads zero") {
+        REQUIRE(histogram.getCount() == 0);
+        REQUIRE(histogram.getMin() == 0);
+        REQUIRE(histogram.getMax() == 0);
+        REQUIRE(histogram.getMean() == 0.0f);
+        REQUIRE(histogram.quantile(0.5f) == 0);
+    }
+
+    SECTION("Count, minimum, maximum and mean are exact") {
+        uint32_t values[] = {120, 95, 87, 250, 101};
+        for (uint32_t v : values) {
+            histogram.record(v);
+        }
+        REQUIRE(histogram.getCount() == 5);
+        REQUIRE(histogram.getMin() == 87);
+        REQUIRE(histogram.getMax() == 250);
+        REQUIRE(histogram.getMean() == Approx(130.6f));
+        REQUIRE(histogram.quantile(0.0f) == 87);
+        REQUIRE(histogram.quantile(1.0f) == 250);
+    }
+
+    SECTION("A single value is its own quantile") {
+        for (int i = 0; i < 100; i++) {
+            histogram.record(1234);
+        }
+        for (size_t i = 0; i < QUANTILE_COUNT; i++) {
+            REQUIRE(histogram.quantile(QUANTILES[i]) == 1234);
+        }
+    }
+
+    SECTION("Small integers are exact") {
+        // Satellites in view: every value has its own bucket
+        for (uint32_t v = 0; v < 8; v++) {
+            for (uint32_t n = 0; n <= v; n++) {
+                histogram.record(v);
+            }
+        }
+        REQUIRE(histogram.getCount() == 36);
+        REQUIRE(histogram.quantile(0.5f) == 5);
+        REQUIRE(histogram.getBucketCount(7) == 8);
+    }
+
+    SECTION("A sample counted several times equals repeated records") {
+        LogHistogram repeated;
+        for (int i = 0; i < 40; i++) {
+            repeated.record(3000);
+        }
+        repeated.record(150);
+        histogram.record(3000, 40);
+        histogram.record(150, 1);
+        histogram.record(999, 0);
+        REQUIRE(histogram.getCount() == repeated.getCount());
+        REQUIRE(histogram.getMin() == repeated.getMin());
+        REQUIRE(histogram.getMax() == repeated.getMax());
+        REQUIRE(histogram.getMean() == Approx(repeated.getMean()));
+        for (size_t i = 0; i < LOG_HISTOGRAM_BUCKETS; i++) {
+            REQUIRE(histogram.getBucketCount(i) == repeated.getBucketCount(i));
+        }
+        histogram.record(LOG_HISTOGRAM_MAX_VALUE + 1, 5);
+        REQUIRE(histogram.getOverflows() == 5);
+    }
+
+    SECTION("Values above the range are counted as overflows") {
+        histogram.record(LOG_HISTOGRAM_MAX_VALUE);
+        histogram.record(LOG_HISTOGRAM_MAX_VALUE + 1);
+        histogram.record(UINT32_MAX);
+        REQUIRE(histogram.getCount() == 3);
+        REQUIRE(histogram.getOverflows() == 2);
+        REQUIRE(histogram.getBucketCount(LOG_HISTOGRAM_BUCKETS - 1) == 3);
+        REQUIRE(histogram.getMax() == UINT32_MAX);
+        REQUIRE(histogram.quantile(0.5f) <= histogram.getMax());
+    }
+
+    SECTION("Reset empties the histogram") {
+        histogram.record(10);
+        histogram.record(LOG_HISTOGRAM_MAX_VALUE + 1);
+        histogram.reset();
+        REQUIRE(histogram.getCount() == 0);
+        REQUIRE(histogram.getOverflows() == 0);
+        REQUIRE(histogram.getMin() == 0);
+        for (size_t i = 0; i < LOG_HISTOGRAM_BUCKETS; i++) {
+            REQUIRE(histogram.getBucketCount(i) == 0);
+        }
+    }
+}
+
+TEST_CASE("LogHistogram - Quantile accuracy", "[LogHistogram]") {
+    struct Distribution {
+        const char* name;
+        std::vector<uint32_t> samples;
+    };
+    std::mt19937 rng(7);
+    std::vector<Distribution> distributions;
+
+    // HDOP times 100 between 0.5 and 4
+    std::uniform_int_distribution<uint32_t> hdop(50, 400);
+    std::vector<uint32_t> hdops;
+    for (int i = 0; i < 3600; i++) {
+        hdops.push_back(hdop(rng));
+    }
+    distributions.push_back({"hdop", hdops});
+    distributions.push_back({"latency", latencySamples(100000, 11)});
+
+    // Correction age in tenths of a second, mostly 1 s with outages
+    std::exponential_distribution<double> age(1.0 / 12.0);
+    std::vector<uint32_t> ages;
+    for (int i = 0; i < 3600; i++) {
+        ages.push_back(1 + (uint32_t)age(rng));
+    }
+    distributions.push_back({"correction age", ages});
+
+    for (const Distribution& d : distributions) {
+        LogHistogram histogram;
+        for (uint32_t v : d.samples) {
+            histogram.record(v);
+        }
+        std::vector<uint32_t> sorted = d.samples;
+        std::sort(sorted.begin(), sorted.end());
+        INFO(d.name);
+        for (size_t i = 0; i < QUANTILE_COUNT; i++) {
+            uint32_t exact = exactQuantile(sorted, QUANTILES[i]);
+            uint32_t estimate = histogram.quantile(QUANTILES[i]);
+            INFO("q=" << QUANTILES[i] << " exact=" << exact << " estimate=" << estimate);
+            // Half a bucket: at most 1/16 of the value
+            REQUIRE(fabs((double)estimate - exact) <= exact / 16.0);
+        }
+    }
+}
+
+TEST_CASE("LogHistogram - Merging scopes", "[LogHistogram]") {
+    std::vector<uint32_t> samples = latencySamples(6000, 3);
+    LogHistogram all;
+    LogHistogram runtime;
+    LogHistogram period;
+
+    // 60 periods of 100 samples, merged into the runtime scope at every period end
+    for (size_t i = 0; i < samples.size(); i++) {
+        all.record(samples[i]);
+        period.record(samples[i]);
+        if ((i + 1) % 100 == 0) {
+            runtime.merge(period);
+            REQUIRE(period.getCount() == 100);
+            period.reset();
+        }
+    }
+
+    REQUIRE(runtime.getCount() == all.getCount());
+    REQUIRE(runtime.getMin() == all.getMin());
+    REQUIRE(runtime.getMax() == all.getMax());
+    REQUIRE(runtime.getMean() == all.getMean());
+    for (size_t i = 0; i < LOG_HISTOGRAM_BUCKETS; i++) {
+        REQUIRE(runtime.getBucketCount(i) == all.getBucketCount(i));
+    }
+    for (size_t i = 0; i < QUANTILE_COUNT; i++) {
+        REQUIRE(runtime.quantile(QUANTILES[i]) == all.quantile(QUANTILES[i]));
+    }
+
+    SECTION("Merging an empty histogram changes nothing") {
+        LogHistogram empty;
+        runtime.merge(empty);
+        REQUIRE(runtime.getCount() == all.getCount());
+        REQUIRE(runtime.getMin() == all.getMin());
+
+        empty.merge(runtime);
+        REQUIRE(empty.getMin() == all.getMin());
+        REQUIRE(empty.quantile(0.99f) == all.quantile(0.99f));
+    }
+}
+
+TEST_CASE("LogHistogram - Sparse export", "[LogHistogram]") {
+    uint8_t gaps[LOG_HISTOGRAM_BUCKETS];
+    uint32_t counts[LOG_HISTOGRAM_BUCKETS];
+    uint8_t shift = 0xFF;
+    LogHistogram histogram;
+    LogHistogram imported;
+
+    SECTION("Empty histogram") {
+        REQUIRE(histogram.exportSparse(gaps, counts, 16, &shift) == 0);
+        REQUIRE(shift == 0);
+        REQUIRE(imported.importSparse(gaps, counts, 0, shift));
+        REQUIRE(imported.getCount() == 0);
+    }
+
+    SECTION("Invalid arguments") {
+        REQUIRE(histogram.exportSparse(NULL, counts, 16, &shift) == 0);
+        REQUIRE(histogram.exportSparse(gaps, counts, 0, &shift) == 0);
+        REQUIRE(histogram.exportSparse(gaps, counts, 16, NULL) == 0);
+        REQUIRE_FALSE(imported.importSparse(NULL, counts, 1, 0));
+
+        // Bin outside the histogram
+        gaps[0] = 100;
+        gaps[1] = 100;
+        counts[0] = 1;
+        counts[1] = 1;
+        REQUIRE_FALSE(imported.importSparse(gaps, counts, 2, 0));
+        REQUIRE(imported.getCount() == 0);
+        gaps[0] = 1;
+        REQUIRE_FALSE(imported.importSparse(gaps, counts, 1, 8));
+    }
+
+    SECTION("Few buckets round trip exactly") {
+        uint32_t values[] = {85, 90, 90, 110, 140, 140, 140, 900};
+        for (uint32_t v : values) {
+            histogram.record(v);
+        }
+        size_t bins = histogram.exportSparse(gaps, counts, 16, &shift);
+        REQUIRE(shift == 0);
+        REQUIRE(bins == 5);
+        REQUIRE(gaps[0] == LogHistogram::bucketIndex(85));
+        REQUIRE(counts[2] == 1);
+        REQUIRE(counts[3] == 3);
+
+        REQUIRE(imported.importSparse(gaps, counts, bins, shift));
+        REQUIRE(imported.getCount() == histogram.getCount());
+        for (size_t i = 0; i < LOG_HISTOGRAM_BUCKETS; i++) {
+            REQUIRE(imported.getBucketCount(i) == histogram.getBucketCount(i));
+        }
+        REQUIRE(imported.getMin() == LogHistogram::bucketLow(LogHistogram::bucketIndex(85)));
+        REQUIRE(imported.getMax() == LogHistogram::bucketHigh(LogHistogram::bucketIndex(900)));
+        REQUIRE(fabs((double)imported.quantile(0.5f) - histogram.quantile(0.5f)) <= 110 / 16.0);
+    }
+
+    SECTION("Many buckets are combined until they fit") {
+        std::vector<uint32_t> samples = latencySamples(20000, 5);
+        for (uint32_t v : samples) {
+            histogram.record(v);
+        }
+        std::vector<uint32_t> sorted = samples;
+        std::sort(sorted.begin(), sorted.end());
+
+        const size_t sizes[] = {64, 16, 8, 4, 1};
+        uint8_t lastShift = 0;
+        for (size_t maxBins : sizes) {
+            size_t bins = histogram.exportSparse(gaps, counts, maxBins, &shift);
+            INFO("maxBins=" << maxBins << " shift=" << (int)shift);
+            REQUIRE(bins > 0);
+            REQUIRE(bins <= maxBins);
+            REQUIRE(shift >= lastShift);
+            lastShift = shift;
+
+            uint64_t total = 0;
+            for (size_t i = 0; i < bins; i++) {
+                REQUIRE(counts[i] > 0);
+                if (i > 0) {
+                    REQUIRE(gaps[i] > 0);
+                }
+                total += counts[i];
+            }
+            REQUIRE(total == samples.size());
+
+            // The median lies in a bin whose bounds hold the exact median
+            REQUIRE(imported.importSparse(gaps, counts, bins, shift));
+            uint32_t exact = exactQuantile(sorted, 0.5f);
+            size_t bin = LogHistogram::bucketIndex(exact) >> shift;
+            uint32_t low = LogHistogram::bucketLow(bin << shift);
+            REQUIRE(imported.quantile(0.5f) >= low);
+            REQUIRE(imported.getCount() == histogram.getCount());
+        }
+        REQUIRE(lastShift > 0);
+    }
+}
+
+TEST_CASE("P2Quantile - Estimates", "[P2Quantile]") {
+    SECTION("No samples and few samples") {
+        P2Quantile median(0.5f);
+        REQUIRE(median.get() == 0.0f);
+        median.add(30.0f);
+        REQUIRE(median.get() == 30.0f);
+        median.add(10.0f);
+        median.add(20.0f);
+        REQUIRE(median.get() == 20.0f);
+        median.add(50.0f);
+        median.add(40.0f);
+        REQUIRE(median.getCount() == 5);
+        REQUIRE(median.get() == 30.0f);
+
+        median.reset();
+        REQUIRE(median.getCount() == 0);
+        REQUIRE(median.get() == 0.0f);
+    }
+
+    SECTION("Quantile is limited to 0 to 1") {
+        P2Quantile low(-1.0f);
+        P2Quantile high(2.0f);
+        REQUIRE(low.getQuantile() == 0.0f);
+        REQUIRE(high.getQuantile() == 1.0f);
+    }
+
+    SECTION("A constant stream") {
+        P2Quantile p99(0.99f);
+        for (int i = 0; i < 1000; i++) {
+            p99.add(42.0f);
+        }
+        REQUIRE(p99.get() == 42.0f);
+    }
+
+    SECTION("Distributions") {
+        struct Case {
+            const char* name;
+            std::vector<float> samples;
+        };
+        std::mt19937 rng(21);
+        std::vector<Case> cases;
+        std::vector<float> uniform;
+        std::vector<float> normal;
+        std::vector<float> latency;
+        std::vector<float> ascending;
+        std::uniform_real_distribution<float> u(0.0f, 1000.0f);
+        std::normal_distribution<float> n(500.0f, 50.0f);
+        for (int i = 0; i < 50000; i++) {
+            uniform.push_back(u(rng));
+            normal.push_back(n(rng));
+            ascending.push_back((float)i);
+        }
+        for (uint32_t v : latencySamples(50000, 9)) {
+            latency.push_back((float)v);
+        }
+        cases.push_back({"uniform", uniform});
+        cases.push_back({"normal", normal});
+        cases.push_back({"latency", latency});
+        cases.push_back({"ascending", ascending});
+
+        const float quantiles[] = {0.5f, 0.9f, 0.99f};
+        for (const Case& c : cases) {
+            std::vector<float> sorted = c.samples;
+            std::sort(sorted.begin(), sorted.end());
+            for (float q : quantiles) {
+                P2Quantile estimator(q);
+                for (float v : c.samples) {
+                    estimator.add(v);
+                }
+                // The estimate has the wanted rank within 1% of the samples
+                double rank = rankOf(sorted, estimator.get());
+                INFO(c.name << " q=" << q << " estimate=" << estimator.get() << " rank=" << rank);
+                REQUIRE(estimator.getCount() == c.samples.size());
+                REQUIRE(fabs(rank - q) <= 0.01);
+            }
+        }
+    }
+}
+
+TEST_CASE("P2Quantile - Long streams", "[P2Quantile]") {
+    // Three million samples: a float sum of the desired marker increments
+    // would stop growing long before this and the p99 would drift
+    std::mt19937 rng(4);
+    std::lognormal_distribution<float> latency(log(2000.0f), 0.5f);
+    std::vector<float> samples;
+    P2Quantile p99(0.99f);
+    for (int i = 0; i < 3000000; i++) {
+        float v = latency(rng);
+        samples.push_back(v);
+        p99.add(v);
+    }
+    std::sort(samples.begin(), samples.end());
+    double rank = rankOf(samples, p99.get());
+    INFO("estimate=" << p99.get() << " rank=" << rank);
+    REQUIRE(fabs(rank - 0.99) <= 0.001);
+}
+
+TEST_CASE("Statistics histogram benchmark - accuracy, memory and cost", "[.benchmark]") {
+    const size_t n = 1000000;
+    std::vector<uint32_t> samples = latencySamples(n, 1);
+    std::vector<uint32_t> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+    const float quantiles[] = {0.5f, 0.9f, 0.99f};
+    const size_t count = sizeof(quantiles) / sizeof(quantiles[0]);
+    volatile uint32_t sink = 0;
+
+    // Log-linear histogram: all quantiles from one structure
+    LogHistogram histogram;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t v : samples) {
+        histogram.record(v);
+    }
+    double histogramNs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e9 / n;
+    uint32_t histogramValues[3];
+    for (size_t i = 0; i < count; i++) {
+        histogramValues[i] = histogram.quantile(quantiles[i]);
+    }
+
+    // P²: one estimator per quantile
+    P2Quantile p50(0.5f);
+    P2Quantile p90(0.9f);
+    P2Quantile p99(0.99f);
+    start = std::chrono::steady_clock::now();
+    for (uint32_t v : samples) {
+        p50.add((float)v);
+        p90.add((float)v);
+        p99.add((float)v);
+    }
+    double p2Ns = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e9 / n;
+    uint32_t p2Values[3] = {(uint32_t)p50.get(), (uint32_t)p90.get(), (uint32_t)p99.get()};
+
+    // Exact: keep every sample and select the quantiles
+    std::vector<uint32_t> kept;
+    start = std::chrono::steady_clock::now();
+    for (uint32_t v : samples) {
+        kept.push_back(v);
+    }
+    uint32_t exactValues[3];
+    for (size_t i = 0; i < count; i++) {
+        uint32_t rank = (uint32_t)ceilf(quantiles[i] * kept.size());
+        std::nth_element(kept.begin(), kept.begin() + (rank - 1), kept.end());
+        exactValues[i] = kept[rank - 1];
+    }
+    double exactNs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e9 / n;
+    sink = exactValues[0];
+    (void)sink;
+
+    printf("\nLatency samples (log-normal around 2 ms, 1%% x20), %u samples\n", (unsigned)n);
+    printf("method            ns/sample        bytes     p50 us     p90 us     p99 us  max error\n");
+    const char* names[] = {"exact (sort)", "log histogram", "P2 (3 estimators)"};
+    const uint32_t* values[] = {exactValues, histogramValues, p2Values};
+    const double costs[] = {exactNs, histogramNs, p2Ns};
+    const size_t bytes[] = {n * sizeof(uint32_t), sizeof(LogHistogram), 3 * sizeof(P2Quantile)};
+    for (int m = 0; m < 3; m++) {
+        double maxError = 0.0;
+        for (size_t i = 0; i < count; i++) {
+            uint32_t exact = exactQuantile(sorted, quantiles[i]);
+            maxError = std::max(maxError, fabs((double)values[m][i] - exact) / exact);
+        }
+        printf("%-16s %10.1f %12u %10u %10u %10u %9.2f%%\n", names[m], costs[m], (unsigned)bytes[m],
+               (unsigned)values[m][0], (unsigned)values[m][1], (unsigned)values[m][2], maxError * 100.0);
+    }
+
+    // Sparse export as published in the MQTT stats message
+    uint8_t gaps[16];
+    uint32_t counts[16];
+    uint8_t shift = 0;
+    size_t bins = histogram.exportSparse(gaps, counts, 16, &shift);
+    printf("\nSparse export: %u of %u buckets in use, %u bins of 16 at shift %u\n",
+           (unsigned)[&]() {
+               size_t used = 0;
+               for (size_t i = 0; i < LOG_HISTOGRAM_BUCKETS; i++) {
+                   used += histogram.getBucketCount(i) ? 1 : 0;
+               }
+               return used;
+           }(),
+           (unsigned)LOG_HISTOGRAM_BUCKETS, (unsigned)bins, (unsigned)shift);
+}
@@ -0,0 +1,403 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch.hpp"
+#include "CpuLoad_standalone.h"
+#include "LoopProfiler_standalone.h"
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Run-time counters of a simulated system, microseconds in 32 bits like esp_timer
+struct SimTask {
+    uint32_t taskNumber;
+    double share;           // Fraction of one core
+    uint32_t runTime;       // Wrapping counter
+    uint64_t exact;         // Run time without wrapping
+};
+
+struct SimSystem {
+    std::vector<SimTask> tasks;
+    uint32_t total = 0;
+    uint64_t totalExact = 0;
+    std::mt19937 rng{42};
+
+    void add(uint32_t taskNumber, double share, uint32_t startRunTime = 0) {
+        SimTask task = {taskNumber, share, startRunTime, 0};
+        tasks.push_back(task);
+    }
+
+    // Advance by a time in microseconds; every task runs its share with some jitter
+    void advance(uint32_t us) {
+        std::uniform_real_distribution<double> jitter(0.9, 1.1);
+        for (SimTask& task : tasks) {
+            uint32_t ran = (uint32_t)std::min((double)us, task.share * us * jitter(rng));
+            task.runTime += ran;
+            task.exact += ran;
+        }
+        total += us;
+        totalExact += us;
+    }
+
+    void snapshot(CpuLoad& load) const {
+        std::vector<CpuLoadSample> samples;
+        for (const SimTask& task : tasks) {
+            CpuLoadSample sample = {task.taskNumber, task.runTime};
+            samples.push_back(sample);
+        }
+        load.update(samples.data(), samples.size(), total);
+    }
+
+    void resetExact() {
+        for (SimTask& task : tasks) {
+            task.exact = 0;
+        }
+        totalExact = 0;
+    }
+};
+
+TEST_CASE("CpuLoad - Snapshots", "[CpuLoad]") {
+    CpuLoad load;
+    CpuLoadSample samples[3] = {{1, 0}, {2, 0}, {3, 0}};
+
+    SECTION("Without snapshots nothing is known") {
+        REQUIRE(load.getTaskCount() == 0);
+        REQUIRE(load.getElapsed() == 0);
+        REQUIRE(load.getPercent(1) == 0.0f);
+        REQUIRE(load.getRunTime(1) == 0);
+    }
+
+    SECTION("The first snapshot only sets the starting points") {
+        samples[0].runTime = 5000000;
+        load.update(samples, 3, 9000000);
+        REQUIRE(load.getTaskCount() == 3);
+        REQUIRE(load.getElapsed() == 0);
+        REQUIRE(load.getRunTime(1) == 0);
+        REQUIRE(load.getPercent(1) == 0.0f);
+    }
+
+    SECTION("Shares of one core between snapshots") {
+        load.update(samples, 3, 0);
+        samples[0].runTime = 250000;
+        samples[1].runTime = 10000;
+        samples[2].runTime = 740000;
+        load.update(samples, 3, 1000000);
+        REQUIRE(load.getElapsed() == 1000000);
+        REQUIRE(load.getRunTime(1) == 250000);
+        REQUIRE(load.getPercent(1) == Approx(25.0f));
+        REQUIRE(load.getPercent(2) == Approx(1.0f));
+        REQUIRE(load.getPercent(3) == Approx(74.0f));
+        REQUIRE(load.getPercent(99) == 0.0f);
+    }
+
+    SECTION("Counters that wrap between snapshots") {
+        samples[0].runTime = UINT32_MAX - 99999;
+        load.update(samples, 3, UINT32_MAX - 499999);
+        samples[0].runTime = 400000;
+        load.update(samples, 3, 500000);
+        REQUIRE(load.getElapsed() == 1000000);
+        REQUIRE(load.getRunTime(1) == 500000);
+        REQUIRE(load.getPercent(1) == Approx(50.0f));
+    }
+
+    SECTION("A new task counts from its first snapshot") {
+        load.update(samples, 2, 0);
+        samples[0].runTime = 100000;
+        samples[2].runTime = 800000;    // Ran before it was first seen
+        load.update(samples, 3, 1000000);
+        REQUIRE(load.getTaskCount() == 3);
+        REQUIRE(load.getRunTime(3) == 0);
+        samples[2].runTime = 900000;
+        load.update(samples, 3, 2000000);
+        REQUIRE(load.getRunTime(3) == 100000);
+        REQUIRE(load.getPercent(3) == Approx(5.0f));
+    }
+
+    SECTION("A deleted task is dropped, a task with a new number starts over") {
+        load.update(samples, 3, 0);
+        samples[1].runTime = 300000;
+        load.update(samples, 3, 1000000);
+        REQUIRE(load.getRunTime(2) == 300000);
+
+        // Task 2 deleted, recreated as task 4
+        CpuLoadSample after[3] = {samples[0], samples[2], {4, 50000}};
+        load.update(after, 3, 2000000);
+        REQUIRE(load.getTaskCount() == 3);
+        REQUIRE(load.getRunTime(2) == 0);
+        REQUIRE(load.getRunTime(4) == 0);
+        after[2].runTime = 150000;
+        load.update(after, 3, 3000000);
+        REQUIRE(load.getRunTime(4) == 100000);
+    }
+
+    SECTION("Reset starts a period from the last snapshot") {
+        load.update(samples, 3, 0);
+        samples[0].runTime = 600000;
+        load.update(samples, 3, 1000000);
+        load.reset();
+        REQUIRE(load.getElapsed() == 0);
+        REQUIRE(load.getRunTime(1) == 0);
+        REQUIRE(load.getTaskCount() == 3);
+        samples[0].runTime = 700000;
+        load.update(samples, 3, 2000000);
+        REQUIRE(load.getElapsed() == 1000000);
+        REQUIRE(load.getPercent(1) == Approx(10.0f));
+    }
+
+    SECTION("Clear forgets the starting points") {
+        load.update(samples, 3, 0);
+        load.clear();
+        REQUIRE(load.getTaskCount() == 0);
+        samples[0].runTime = 500000;
+        load.update(samples, 3, 1000000);
+        REQUIRE(load.getElapsed() == 0);
+        REQUIRE(load.getRunTime(1) == 0);
+    }
+
+    SECTION("Tasks beyond the maximum and missing samples are ignored") {
+        std::vector<CpuLoadSample> many;
+        for (uint32_t i = 0; i < CPU_LOAD_MAX_TASKS + 8; i++) {
+            CpuLoadSample sample = {i + 1, 0};
+            many.push_back(sample);
+        }
+        load.update(many.data(), many.size(), 0);
+        REQUIRE(load.getTaskCount() == CPU_LOAD_MAX_TASKS);
+        load.update(NULL, 5, 1000000);
+        REQUIRE(load.getTaskCount() == 0);
+        REQUIRE(load.getElapsed() == 1000000);
+    }
+}
+
+TEST_CASE("CpuLoad - Two cores for two hours", "[CpuLoad]") {
+    // Idle tasks 1 and 2 (one per core), GNSS, NTRIP, WiFi and MQTT tasks;
+    // the counters wrap after 71 minutes
+    SimSystem system;
+    system.total = UINT32_MAX - 30000000;  // Wraps after 30 s
+    system.add(1, 0.80, UINT32_MAX - 20000000);
+    system.add(2, 0.60);
+    system.add(10, 0.12, UINT32_MAX - 1000);
+    system.add(11, 0.05);
+    system.add(12, 0.30);
+    system.add(13, 0.13);
+
+    CpuLoad load;
+    system.snapshot(load);
+    for (int period = 0; period < 2; period++) {
+        system.resetExact();
+        for (int second = 0; second < 3600; second++) {
+            system.advance(1000000);
+            system.snapshot(load);
+        }
+        REQUIRE(load.getElapsed() == system.totalExact);
+        for (const SimTask& task : system.tasks) {
+            REQUIRE(load.getRunTime(task.taskNumber) == task.exact);
+            REQUIRE(load.getPercent(task.taskNumber) == Approx(task.share * 100.0).epsilon(0.01));
+        }
+        // Core loads: 100% minus the idle task
+        REQUIRE(100.0f - load.getPercent(1) == Approx(20.0f).epsilon(0.02));
+        REQUIRE(100.0f - load.getPercent(2) == Approx(40.0f).epsilon(0.02));
+        load.reset();
+    }
+}
+
+TEST_CASE("LoopProfiler - Recording and collecting", "[LoopProfiler]") {
+    LoopProfiler profiler;
+    LogHistogram histogram;
+    uint64_t sum = 0;
+    uint32_t max = 0;
+
+    SECTION("Nothing recorded") {
+        REQUIRE(profiler.collect(&histogram, &sum, &max) == 0);
+        REQUIRE(sum == 0);
+        REQUIRE(max == 0);
+        REQUIRE(histogram.getCount() == 0);
+    }
+
+    SECTION("Count, sum and maximum are exact, quantiles within 1/16") {
+        std::mt19937 rng(7);
+        std::lognormal_distribution<double> duration(6.0, 0.8);   // Around 400 us
+        std::vector<uint32_t> durations;
+        uint64_t exactSum = 0;
+        for (int i = 0; i < 20000; i++) {
+            uint32_t us = (uint32_t)duration(rng);
+            durations.push_back(us);
+            exactSum += us;
+            profiler.record(us);
+        }
+        REQUIRE(profiler.collect(&histogram, &sum, &max) == durations.size());
+        REQUIRE(sum == exactSum);
+        REQUIRE(max == *std::max_element(durations.begin(), durations.end()));
+        REQUIRE(histogram.getCount() == durations.size());
+
+        std::sort(durations.begin(), durations.end());
+        const float levels[3] = {0.5f, 0.9f, 0.99f};
+        for (float q : levels) {
+            uint32_t exact = durations[(size_t)(q * durations.size()) - 1];
+            REQUIRE(fabs((double)histogram.quantile(q) - exact) <= exact / 16.0 + 1.0);
+        }
+    }
+
+    SECTION("Samples are moved once, the maximum restarts") {
+        profiler.record(100);
+        profiler.record(5000);
+        REQUIRE(profiler.collect(&histogram, &sum, &max) == 2);
+        REQUIRE(max == 5000);
+        profiler.record(300);
+        REQUIRE(profiler.collect(&histogram, &sum, &max) == 1);
+        REQUIRE(sum == 300);
+        REQUIRE(max == 300);
+        REQUIRE(histogram.getCount() == 3);
+        REQUIRE(profiler.collect(&histogram, &sum, &max) == 0);
+        REQUIRE(max == 0);
+        REQUIRE(histogram.getCount() == 3);
+    }
+
+    SECTION("Durations above the histogram range keep their exact maximum") {
+        profiler.record(4000000);   // A 4 s TLS handshake in the NTRIP loop
+        profiler.record(200);
+        REQUIRE(profiler.collect(&histogram, &sum, &max) == 2);
+        REQUIRE(max == 4000000);
+        REQUIRE(sum == 4000200);
+        REQUIRE(histogram.getBucketCount(LOG_HISTOGRAM_BUCKETS - 1) == 1);
+    }
+
+    SECTION("Optional outputs") {
+        profiler.record(42);
+        REQUIRE(profiler.collect(NULL, NULL, NULL) == 1);
+        REQUIRE(profiler.collect(&histogram, &sum, &max) == 0);
+        REQUIRE(histogram.getCount() == 0);
+    }
+}
+
+TEST_CASE("LoopProfiler - A task records while the statistics collect", "[LoopProfiler]") {
+    LoopProfiler profiler;
+    const uint32_t records = 2000000;
+    std::atomic<bool> done(false);
+    uint64_t exactSum = 0;
+    uint32_t exactMax = 0;
+
+    std::thread writer([&]() {
+        std::mt19937 rng(3);
+        std::uniform_int_distribution<uint32_t> duration(10, 3000);
+        for (uint32_t i = 0; i < records; i++) {
+            uint32_t us = duration(rng);
+            exactSum += us;
+            exactMax = std::max(exactMax, us);
+            profiler.record(us);
+        }
+        done.store(true);
+    });
+
+    LogHistogram histogram;
+    uint64_t collected = 0;
+    uint64_t collectedSum = 0;
+    uint32_t collectedMax = 0;
+    uint32_t collects = 0;
+    bool finished = false;
+    while (!finished) {
+        finished = done.load();
+        uint64_t sum = 0;
+        uint32_t max = 0;
+        collected += profiler.collect(&histogram, &sum, &max);
+        collectedSum += sum;
+        collectedMax = std::max(collectedMax, max);
+        collects++;
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    writer.join();
+    uint64_t sum = 0;
+    uint32_t max = 0;
+    collected += profiler.collect(&histogram, &sum, &max);
+    collectedSum += sum;
+
+    INFO("collects: " << collects);
+    REQUIRE(collected == records);
+    REQUIRE(histogram.getCount() == records);
+    REQUIRE(collectedSum == exactSum);
+    REQUIRE(std::max(collectedMax, max) == exactMax);
+}
+
+// Shared histogram behind a mutex, the straightforward alternative
+struct MutexProfiler {
+    std::mutex mutex;
+    LogHistogram histogram;
+    void record(uint32_t us) {
+        std::lock_guard<std::mutex> lock(mutex);
+        histogram.record(us);
+    }
+    void collect(LogHistogram* into) {
+        std::lock_guard<std::mutex> lock(mutex);
+        into->merge(histogram);
+        histogram.reset();
+    }
+};
+
+template <typename Profiler, typename Collect>
+static double benchmarkRecord(Profiler& profiler, Collect collect, uint32_t records) {
+    std::atomic<bool> done(false);
+    std::thread reader([&]() {
+        while (!done.load()) {
+            collect();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    auto start = std::chrono::steady_clock::now();
+    uint32_t us = 17;
+    for (uint32_t i = 0; i < records; i++) {
+        us = us * 1103515245u + 12345u;
+        profiler.record((us >> 16) & 0xFFF);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    done.store(true);
+    reader.join();
+    return seconds * 1e9 / records;
+}
+
+TEST_CASE("Task profiler benchmark - loop record cost and CPU usage over time", "[.benchmark]") {
+    const uint32_t records = 10000000;
+    printf("\nLoop duration record, %u records, collected every 1 ms (%u CPUs)\n",
+           records, std::thread::hardware_concurrency());
+    printf("%-22s %12s %12s\n", "profiler", "ns/record", "bytes");
+    {
+        MutexProfiler profiler;
+        LogHistogram into;
+        double ns = benchmarkRecord(profiler, [&]() { profiler.collect(&into); }, records);
+        printf("%-22s %12.1f %12zu\n", "mutex + LogHistogram", ns, sizeof(LogHistogram) + sizeof(std::mutex));
+    }
+    {
+        LoopProfiler profiler;
+        LogHistogram into;
+        double ns = benchmarkRecord(profiler, [&]() { profiler.collect(&into, NULL, NULL); }, records);
+        printf("%-22s %12.1f %12zu\n", "LoopProfiler", ns, sizeof(LoopProfiler));
+    }
+
+    // CPU usage of a system with 24 tasks, snapshots every second for 6 hours.
+    // Since boot is what the FreeRTOS run-time counters give by themselves.
+    SimSystem system;
+    for (uint32_t i = 0; i < 24; i++) {
+        system.add(i + 1, i == 0 ? 0.70 : 0.01 * (i % 5));
+    }
+    CpuLoad load;
+    system.snapshot(load);
+    auto start = std::chrono::steady_clock::now();
+    const int hours = 6;
+    printf("\nCPU usage of the busiest task (70%%), 24 tasks, 1 h periods\n");
+    printf("%5s %14s %14s\n", "hour", "since boot", "CpuLoad");
+    uint64_t updates = 0;
+    for (int hour = 1; hour <= hours; hour++) {
+        for (int second = 0; second < 3600; second++) {
+            system.advance(1000000);
+            system.snapshot(load);
+            updates++;
+        }
+        double sinceBoot = (double)system.tasks[0].runTime * 100.0 / system.total;
+        printf("%5d %13.1f%% %13.1f%%\n", hour, sinceBoot, load.getPercent(1));
+        load.reset();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("CpuLoad::update with 24 tasks: %.0f ns per snapshot (incl. simulation), %zu bytes\n",
+           seconds * 1e9 / updates, sizeof(CpuLoad));
+}
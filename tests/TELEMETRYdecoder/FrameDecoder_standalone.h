@@ -0,0 +1,134 @@
+/*!
+ * \file FrameDecoder.h
+ * \brief Streaming receiver for the SOH/DLE/CAN telemetry frames.
+ *
+ * Receiver side of lib/FrameEncoder, for hosts reading the telemetry UART:
+ *
+ *     [SOH] [payload (stuffed)] [CRC-16 high (stuffed)] [CRC-16 low (stuffed)] [CAN]
+ *
+ * Bytes are fed in chunks of any size as they arrive; a frame may be split
+ * over any number of chunks. The CRC-16 (lib/CRC16) is updated while the
+ * bytes pass, so a frame is checked as soon as its CAN arrives.
+ *
+ * \section decoder_resync Resynchronization
+ * Bytes outside a frame are skipped until the next SOH. An unescaped SOH
+ * inside a frame starts a new frame, so a lost CAN costs one frame only. A
+ * frame is dropped (and counted) when its CRC does not match, when DLE is
+ * followed by a byte that is not SOH, DLE or CAN, or when it does not fit the
+ * buffer; the decoder then waits for the next SOH.
+ *
+ * \section decoder_zero_copy Zero copy
+ * The payload is passed to the frame callback without copying it when the
+ * whole frame is in one chunk and has no escaped bytes, the common case: the
+ * callback gets a pointer into the fed data. Other frames are unstuffed into
+ * the buffer given to begin(). The payload is only valid during the callback.
+ *
+ * The decoder has no ESP-IDF dependencies and is not thread safe.
+ */
+
+#ifndef FRAME_DECODER_STANDALONE_H
+#define FRAME_DECODER_STANDALONE_H
+
+#include <cstdint>
+#include <stddef.h>
+
+/**
+ * \brief Buffer size for payloads of up to n bytes (the CRC-16 is kept with
+ * the payload while the frame is received).
+ */
+#define FRAME_DECODER_BUFFER_SIZE(n) ((n) + 2)
+
+class FrameDecoder {
+public:
+    /**
+     * \brief Callback invoked for every frame with a valid CRC.
+     * \param[in] payload Unstuffed payload without the CRC (only valid during the call).
+     * \param[in] length Payload length.
+     * \param[in] context User context passed to setFrameCallback().
+     */
+    typedef void (*FrameCallback)(const uint8_t* payload, size_t length, void* context);
+
+    FrameDecoder();
+
+    /**
+     * \brief Use a buffer for frames and clear state and counters.
+     * \param[in] buffer Frame buffer, FRAME_DECODER_BUFFER_SIZE() of the largest payload.
+     * \param[in] size Buffer size in bytes.
+     */
+    void begin(uint8_t* buffer, size_t size);
+
+    /**
+     * \brief Register the frame callback.
+     * \param[in] callback Function to call for each valid frame (may be NULL).
+     * \param[in] context User context passed to the callback.
+     */
+    void setFrameCallback(FrameCallback callback, void* context);
+
+    /**
+     * \brief Drop a partly received frame and wait for the next SOH, e.g.
+     * after reopening the port. Counters are kept.
+     */
+    void reset();
+
+    /**
+     * \brief Feed received bytes.
+     * \param[in] data Received bytes.
+     * \param[in] length Number of bytes.
+     * \return Number of valid frames completed within this call.
+     */
+    size_t feed(const uint8_t* data, size_t length);
+
+    /** \brief Largest payload that fits the buffer. */
+    size_t getMaxPayload() const { return capacity >= 2 ? capacity - 2 : 0; }
+
+    /** \brief Frames with a valid CRC. */
+    uint32_t getFrameCount() const { return frameCount; }
+
+    /** \brief Valid frames passed to the callback without copying. */
+    uint32_t getZeroCopyCount() const { return zeroCopyCount; }
+
+    /** \brief Frames with a CRC mismatch or shorter than the CRC. */
+    uint32_t getCrcErrorCount() const { return crcErrorCount; }
+
+    /** \brief Frames dropped for a DLE followed by a byte other than SOH, DLE or CAN. */
+    uint32_t getEscapeErrorCount() const { return escapeErrorCount; }
+
+    /** \brief Frames dropped because they did not fit the buffer. */
+    uint32_t getOverrunCount() const { return overrunCount; }
+
+    /** \brief Frames cut off by an SOH before their CAN. */
+    uint32_t getAbortedCount() const { return abortedCount; }
+
+    /** \brief Bytes skipped outside frames while waiting for an SOH. */
+    uint32_t getDiscardedBytes() const { return discardedBytes; }
+
+private:
+    enum State {
+        STATE_HUNT,
+        STATE_DATA,
+        STATE_ESCAPE
+    };
+
+    bool store(const uint8_t* data, size_t length);
+    void startFrame();
+    bool endFrame(const uint8_t* content, size_t length, bool zeroCopy);
+
+    uint8_t* buffer;
+    size_t capacity;
+    size_t used;
+    State state;
+    uint16_t crc;
+
+    FrameCallback frameCallback;
+    void* callbackContext;
+
+    uint32_t frameCount;
+    uint32_t zeroCopyCount;
+    uint32_t crcErrorCount;
+    uint32_t escapeErrorCount;
+    uint32_t overrunCount;
+    uint32_t abortedCount;
+    uint32_t discardedBytes;
+};
+
+#endif // FRAME_DECODER_STANDALONE_H
@@ -0,0 +1,480 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch.hpp"
+#include "FrameDecoder_standalone.h"
+#include "../TELEMETRYframe/FrameEncoder_standalone.h"
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+#define FRAME_SOH   0x01
+#define FRAME_CAN   0x18
+#define FRAME_DLE   0x10
+
+typedef std::vector<uint8_t> Bytes;
+
+// Collects the payloads passed to the frame callback
+struct Receiver {
+    std::vector<Bytes> payloads;
+    const uint8_t* lastPayload;
+
+    Receiver() : lastPayload(NULL) {}
+
+    static void onFrame(const uint8_t* payload, size_t length, void* context) {
+        Receiver* receiver = static_cast<Receiver*>(context);
+        receiver->payloads.push_back(Bytes(payload, payload + length));
+        receiver->lastPayload = payload;
+    }
+};
+
+static Bytes frameOf(const Bytes& payload) {
+    Bytes frame(FRAME_ENCODER_MAX_SIZE(payload.size()));
+    size_t length = FrameEncoder::encode(payload.data(), payload.size(), frame.data(), frame.size());
+    frame.resize(length);
+    return frame;
+}
+
+static Bytes frameOf(const char* text) {
+    return frameOf(Bytes(text, text + strlen(text)));
+}
+
+static Bytes join(const Bytes& a, const Bytes& b) {
+    Bytes joined(a);
+    joined.insert(joined.end(), b.begin(), b.end());
+    return joined;
+}
+
+static Bytes text(const char* value) {
+    return Bytes(value, value + strlen(value));
+}
+
+// Random payload; bias selects how often framing bytes occur
+static Bytes randomPayload(std::mt19937& rng, size_t length, int bias) {
+    static const uint8_t framing[3] = {FRAME_SOH, FRAME_DLE, FRAME_CAN};
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::uniform_int_distribution<int> percent(0, 99);
+    Bytes payload(length);
+    for (size_t i = 0; i < length; i++) {
+        payload[i] = (percent(rng) < bias) ? framing[byte(rng) % 3] : (uint8_t)byte(rng);
+    }
+    return payload;
+}
+
+TEST_CASE("FrameDecoder - Known frames", "[FrameDecoder]") {
+    uint8_t buffer[FRAME_DECODER_BUFFER_SIZE(64)];
+    FrameDecoder decoder;
+    Receiver receiver;
+    decoder.begin(buffer, sizeof(buffer));
+    decoder.setFrameCallback(Receiver::onFrame, &receiver);
+    REQUIRE(decoder.getMaxPayload() == 64);
+
+    SECTION("ASCII payload") {
+        const uint8_t stream[] = {FRAME_SOH, '1', '2', '3', '4', '5', 0x45, 0x60, FRAME_CAN};
+        REQUIRE(decoder.feed(stream, sizeof(stream)) == 1);
+        REQUIRE(receiver.payloads.size() == 1);
+        REQUIRE(receiver.payloads[0] == text("12345"));
+        REQUIRE(decoder.getFrameCount() == 1);
+        REQUIRE(decoder.getCrcErrorCount() == 0);
+    }
+
+    SECTION("Empty payload") {
+        const uint8_t stream[] = {FRAME_SOH, 0xFF, 0xFF, FRAME_CAN};
+        REQUIRE(decoder.feed(stream, sizeof(stream)) == 1);
+        REQUIRE(receiver.payloads.size() == 1);
+        REQUIRE(receiver.payloads[0].empty());
+    }
+
+    SECTION("Escaped framing bytes are payload") {
+        const Bytes payload = {FRAME_SOH, 'A', FRAME_DLE, FRAME_CAN, 'B'};
+        Bytes stream = frameOf(payload);
+        REQUIRE(decoder.feed(stream.data(), stream.size()) == 1);
+        REQUIRE(receiver.payloads.size() == 1);
+        REQUIRE(receiver.payloads[0] == payload);
+    }
+
+    SECTION("No callback") {
+        decoder.setFrameCallback(NULL, NULL);
+        Bytes stream = frameOf("no callback");
+        REQUIRE(decoder.feed(stream.data(), stream.size()) == 1);
+        REQUIRE(decoder.getFrameCount() == 1);
+    }
+}
+
+TEST_CASE("FrameDecoder - Zero copy", "[FrameDecoder]") {
+    uint8_t buffer[FRAME_DECODER_BUFFER_SIZE(64)];
+    FrameDecoder decoder;
+    Receiver receiver;
+    decoder.begin(buffer, sizeof(buffer));
+    decoder.setFrameCallback(Receiver::onFrame, &receiver);
+
+    SECTION("A frame in one chunk without escapes points into the fed data") {
+        Bytes stream = join(frameOf("12345"), frameOf("67890"));
+        REQUIRE(decoder.feed(stream.data(), stream.size()) == 2);
+        REQUIRE(receiver.lastPayload >= stream.data());
+        REQUIRE(receiver.lastPayload < stream.data() + stream.size());
+        REQUIRE(decoder.getZeroCopyCount() == 2);
+    }
+
+    SECTION("A frame with an escape is unstuffed into the buffer") {
+        const Bytes payload = {'a', FRAME_DLE, 'b'};
+        Bytes stream = frameOf(payload);
+        REQUIRE(decoder.feed(stream.data(), stream.size()) == 1);
+        REQUIRE(receiver.lastPayload == buffer);
+        REQUIRE(receiver.payloads[0] == payload);
+        REQUIRE(decoder.getZeroCopyCount() == 0);
+    }
+
+    SECTION("A frame split over chunks is copied into the buffer") {
+        Bytes stream = frameOf("12345");
+        REQUIRE(decoder.feed(stream.data(), 4) == 0);
+        REQUIRE(decoder.feed(stream.data() + 4, stream.size() - 4) == 1);
+        REQUIRE(receiver.lastPayload == buffer);
+        REQUIRE(receiver.payloads[0] == text("12345"));
+        REQUIRE(decoder.getZeroCopyCount() == 0);
+    }
+
+    SECTION("A frame whose SOH ends the previous chunk is not copied") {
+        Bytes stream = frameOf("12345");
+        REQUIRE(decoder.feed(stream.data(), 1) == 0);
+        REQUIRE(decoder.feed(stream.data() + 1, stream.size() - 1) == 1);
+        REQUIRE(receiver.lastPayload == stream.data() + 1);
+        REQUIRE(decoder.getZeroCopyCount() == 1);
+    }
+}
+
+TEST_CASE("FrameDecoder - Incremental feeding", "[FrameDecoder]") {
+    std::mt19937 rng(40);
+    std::uniform_int_distribution<int> lengths(0, 120);
+    std::uniform_int_distribution<int> chunks(1, 64);
+    std::vector<Bytes> sent;
+    Bytes stream;
+    for (int i = 0; i < 3000; i++) {
+        sent.push_back(randomPayload(rng, lengths(rng), (i % 4) * 10));
+        Bytes frame = frameOf(sent.back());
+        stream.insert(stream.end(), frame.begin(), frame.end());
+    }
+
+    uint8_t buffer[FRAME_DECODER_BUFFER_SIZE(120)];
+    FrameDecoder decoder;
+
+    SECTION("Random chunk sizes") {
+        Receiver receiver;
+        decoder.begin(buffer, sizeof(buffer));
+        decoder.setFrameCallback(Receiver::onFrame, &receiver);
+        size_t completed = 0;
+        for (size_t pos = 0; pos < stream.size();) {
+            size_t length = std::min((size_t)chunks(rng), stream.size() - pos);
+            completed += decoder.feed(stream.data() + pos, length);
+            pos += length;
+        }
+        REQUIRE(completed == sent.size());
+        REQUIRE(receiver.payloads == sent);
+        REQUIRE(decoder.getCrcErrorCount() == 0);
+        REQUIRE(decoder.getDiscardedBytes() == 0);
+    }
+
+    SECTION("One byte at a time") {
+        Receiver receiver;
+        decoder.begin(buffer, sizeof(buffer));
+        decoder.setFrameCallback(Receiver::onFrame, &receiver);
+        for (size_t pos = 0; pos < stream.size(); pos++) {
+            decoder.feed(stream.data() + pos, 1);
+        }
+        REQUIRE(receiver.payloads == sent);
+        REQUIRE(decoder.getZeroCopyCount() == 0);
+    }
+
+    SECTION("Whole stream at once") {
+        Receiver receiver;
+        decoder.begin(buffer, sizeof(buffer));
+        decoder.setFrameCallback(Receiver::onFrame, &receiver);
+        REQUIRE(decoder.feed(stream.data(), stream.size()) == sent.size());
+        REQUIRE(receiver.payloads == sent);
+    }
+}
+
+// A corrupted stream with the frames and error counts it must give
+struct CorpusCase {
+    const char* name;
+    Bytes stream;
+    std::vector<Bytes> payloads;
+    uint32_t crcErrors;
+    uint32_t escapeErrors;
+    uint32_t overruns;
+    uint32_t aborted;
+    int32_t discarded;      // -1: depends on how the stream is split
+};
+
+static std::vector<CorpusCase> corruptedCorpus() {
+    std::vector<CorpusCase> corpus;
+    const Bytes good = frameOf("good");
+    const Bytes next = frameOf("next");
+
+    CorpusCase noise = {"Noise before the first frame", join({0x00, 'x', FRAME_CAN, FRAME_DLE, 0xFF}, good),
+                        {text("good")}, 0, 0, 0, 0, 5};
+    corpus.push_back(noise);
+
+    CorpusCase cut = {"Frame cut off by an SOH", join({FRAME_SOH, 'a', 'b'}, good), {text("good")}, 0, 0, 0, 1, 0};
+    corpus.push_back(cut);
+
+    Bytes flipped = good;
+    flipped[2] ^= 0x04;
+    CorpusCase flip = {"Bit flip in the payload", join(flipped, next), {text("next")}, 1, 0, 0, 0, 0};
+    corpus.push_back(flip);
+
+    Bytes crcFlipped = good;
+    crcFlipped[crcFlipped.size() - 2] ^= 0x80;
+    CorpusCase crcFlip = {"Bit flip in the CRC", join(crcFlipped, next), {text("next")}, 1, 0, 0, 0, 0};
+    corpus.push_back(crcFlip);
+
+    Bytes dropped = good;
+    dropped.erase(dropped.begin() + 3);
+    CorpusCase drop = {"Dropped payload byte", join(dropped, next), {text("next")}, 1, 0, 0, 0, 0};
+    corpus.push_back(drop);
+
+    Bytes noCan(good.begin(), good.end() - 1);
+    CorpusCase lostCan = {"Lost CAN", join(noCan, next), {text("next")}, 0, 0, 0, 1, 0};
+    corpus.push_back(lostCan);
+
+    Bytes escapedCan(good.begin(), good.end() - 1);
+    escapedCan.push_back(FRAME_DLE);
+    escapedCan.push_back(FRAME_CAN);
+    CorpusCase escCan = {"DLE before the CAN", join(escapedCan, next), {text("next")}, 0, 0, 0, 1, 0};
+    corpus.push_back(escCan);
+
+    CorpusCase badEscape = {"DLE before a plain byte", join({FRAME_SOH, 'a', FRAME_DLE, 'b', 'c', FRAME_CAN}, next),
+                            {text("next")}, 0, 1, 0, 0, 2};
+    corpus.push_back(badEscape);
+
+    CorpusCase shortFrames = {"Frames shorter than the CRC", join({FRAME_SOH, FRAME_CAN, FRAME_SOH, 0x12, FRAME_CAN}, next),
+                              {text("next")}, 2, 0, 0, 0, 0};
+    corpus.push_back(shortFrames);
+
+    CorpusCase stray = {"Stray CAN and DLE between frames", join(join(good, {FRAME_CAN, FRAME_DLE, FRAME_CAN}), next),
+                        {text("good"), text("next")}, 0, 0, 0, 0, 3};
+    corpus.push_back(stray);
+
+    Bytes large(100, 'L');
+    CorpusCase overrun = {"Frame larger than the buffer", join(frameOf(large), next), {text("next")}, 0, 0, 1, 0, -1};
+    corpus.push_back(overrun);
+
+    const Bytes framing = {FRAME_DLE, FRAME_DLE, FRAME_SOH, FRAME_CAN};
+    CorpusCase allFraming = {"Payload of framing bytes only", join(frameOf(framing), next), {framing, text("next")},
+                             0, 0, 0, 0, 0};
+    corpus.push_back(allFraming);
+
+    CorpusCase empty = {"Empty stream", Bytes(), {}, 0, 0, 0, 0, 0};
+    corpus.push_back(empty);
+
+    return corpus;
+}
+
+static void checkCorpusCase(const CorpusCase& test, const std::vector<size_t>& splits) {
+    uint8_t buffer[FRAME_DECODER_BUFFER_SIZE(64)];
+    FrameDecoder decoder;
+    Receiver receiver;
+    decoder.begin(buffer, sizeof(buffer));
+    decoder.setFrameCallback(Receiver::onFrame, &receiver);
+
+    size_t pos = 0;
+    for (size_t i = 0; i <= splits.size(); i++) {
+        size_t end = (i < splits.size()) ? splits[i] : test.stream.size();
+        decoder.feed(test.stream.data() + pos, end - pos);
+        pos = end;
+    }
+
+    INFO(test.name);
+    REQUIRE(receiver.payloads == test.payloads);
+    REQUIRE(decoder.getFrameCount() == test.payloads.size());
+    REQUIRE(decoder.getCrcErrorCount() == test.crcErrors);
+    REQUIRE(decoder.getEscapeErrorCount() == test.escapeErrors);
+    REQUIRE(decoder.getOverrunCount() == test.overruns);
+    REQUIRE(decoder.getAbortedCount() == test.aborted);
+    if (test.discarded >= 0) {
+        REQUIRE(decoder.getDiscardedBytes() == (uint32_t)test.discarded);
+    }
+}
+
+TEST_CASE("FrameDecoder - Corrupted stream corpus", "[FrameDecoder]") {
+    std::vector<CorpusCase> corpus = corruptedCorpus();
+    for (size_t c = 0; c < corpus.size(); c++) {
+        const CorpusCase& test = corpus[c];
+
+        // In one chunk, one byte at a time and split at every position
+        checkCorpusCase(test, std::vector<size_t>());
+        std::vector<size_t> bytewise;
+        for (size_t i = 1; i < test.stream.size(); i++) {
+            bytewise.push_back(i);
+        }
+        checkCorpusCase(test, bytewise);
+        for (size_t i = 1; i < test.stream.size(); i++) {
+            checkCorpusCase(test, std::vector<size_t>(1, i));
+        }
+    }
+}
+
+TEST_CASE("FrameDecoder - Resynchronization after random corruption", "[FrameDecoder]") {
+    std::mt19937 rng(140);
+    std::uniform_int_distribution<int> lengths(0, 80);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::uniform_int_distribution<int> chunks(1, 300);
+    static const uint8_t framing[3] = {FRAME_SOH, FRAME_DLE, FRAME_CAN};
+
+    std::vector<Bytes> sent;
+    std::vector<bool> intact;
+    Bytes stream;
+    for (int i = 0; i < 5000; i++) {
+        sent.push_back(randomPayload(rng, lengths(rng), 5));
+        Bytes frame = frameOf(sent.back());
+        bool clean = true;
+        if (percent(rng) < 20) {
+            clean = false;
+            std::uniform_int_distribution<size_t> position(0, frame.size() - 1);
+            size_t at = position(rng);
+            switch (i % 5) {
+                case 0: frame[at] ^= (uint8_t)(1 << (byte(rng) % 8)); break;
+                case 1: frame.erase(frame.begin() + at); break;
+                case 2: frame.insert(frame.begin() + at, (uint8_t)byte(rng)); break;
+                case 3: frame.insert(frame.begin() + at, framing[byte(rng) % 3]); break;
+                default: frame[at] = framing[byte(rng) % 3]; break;
+            }
+        }
+        stream.insert(stream.end(), frame.begin(), frame.end());
+        if (percent(rng) < 5) {
+            // Line noise after the frame; it may swallow the next SOH
+            clean = false;
+            Bytes noise = randomPayload(rng, 1 + byte(rng) % 16, 20);
+            stream.insert(stream.end(), noise.begin(), noise.end());
+        }
+        intact.push_back(clean);
+    }
+
+    uint8_t buffer[FRAME_DECODER_BUFFER_SIZE(80)];
+    FrameDecoder decoder;
+    Receiver receiver;
+    decoder.begin(buffer, sizeof(buffer));
+    decoder.setFrameCallback(Receiver::onFrame, &receiver);
+    for (size_t pos = 0; pos < stream.size();) {
+        size_t length = std::min((size_t)chunks(rng), stream.size() - pos);
+        decoder.feed(stream.data() + pos, length);
+        pos += length;
+    }
+
+    // Every payload received was sent, in order
+    std::vector<bool> received(sent.size(), false);
+    size_t next = 0;
+    for (size_t r = 0; r < receiver.payloads.size(); r++) {
+        while (next < sent.size() && sent[next] != receiver.payloads[r]) {
+            next++;
+        }
+        REQUIRE(next < sent.size());
+        received[next] = true;
+        next++;
+    }
+
+    // A frame is only lost through damage to itself or to the bytes just before it
+    size_t required = 0;
+    for (size_t i = 0; i < sent.size(); i++) {
+        if (intact[i] && (i == 0 || intact[i - 1])) {
+            required++;
+            REQUIRE(received[i]);
+        }
+    }
+    REQUIRE(required > 2500);
+    REQUIRE(decoder.getCrcErrorCount() + decoder.getEscapeErrorCount() + decoder.getAbortedCount() > 0);
+}
+
+TEST_CASE("FrameDecoder - Reset and buffer limits", "[FrameDecoder]") {
+    uint8_t buffer[FRAME_DECODER_BUFFER_SIZE(8)];
+    FrameDecoder decoder;
+    Receiver receiver;
+    decoder.begin(buffer, sizeof(buffer));
+    decoder.setFrameCallback(Receiver::onFrame, &receiver);
+
+    SECTION("Reset drops a partly received frame and keeps the counters") {
+        Bytes first = frameOf("first");
+        Bytes second = frameOf("second");
+        REQUIRE(decoder.feed(first.data(), first.size()) == 1);
+        decoder.feed(second.data(), 4);
+        decoder.reset();
+        REQUIRE(decoder.feed(second.data() + 4, second.size() - 4) == 0);
+        REQUIRE(decoder.feed(second.data(), second.size()) == 1);
+        REQUIRE(decoder.getFrameCount() == 2);
+        REQUIRE(receiver.payloads.size() == 2);
+    }
+
+    SECTION("A payload of exactly the maximum size fits") {
+        Bytes exact(8, FRAME_DLE);
+        Bytes over(9, 'x');
+        Bytes stream = join(frameOf(exact), frameOf(over));
+        decoder.feed(stream.data(), stream.size());
+        REQUIRE(receiver.payloads.size() == 1);
+        REQUIRE(receiver.payloads[0] == exact);
+        REQUIRE(decoder.getOverrunCount() == 1);
+    }
+
+    SECTION("Without a buffer only frames in one chunk without escapes fit") {
+        FrameDecoder bare;
+        bare.setFrameCallback(Receiver::onFrame, &receiver);
+        REQUIRE(bare.getMaxPayload() == 0);
+        Bytes stream = frameOf("");
+        REQUIRE(bare.feed(stream.data(), stream.size()) == 0);
+        REQUIRE(bare.getOverrunCount() == 1);
+    }
+}
+
+static void benchmarkStream(const char* name, const std::vector<Bytes>& payloads, size_t chunk) {
+    Bytes stream;
+    size_t payloadBytes = 0;
+    for (size_t i = 0; i < payloads.size(); i++) {
+        Bytes frame = frameOf(payloads[i]);
+        stream.insert(stream.end(), frame.begin(), frame.end());
+        payloadBytes += payloads[i].size();
+    }
+
+    static uint8_t buffer[FRAME_DECODER_BUFFER_SIZE(1024)];
+    FrameDecoder decoder;
+    decoder.begin(buffer, sizeof(buffer));
+    const int rounds = 20;
+    size_t frames = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (size_t pos = 0; pos < stream.size(); pos += chunk) {
+            frames += decoder.feed(stream.data() + pos, std::min(chunk, stream.size() - pos));
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    REQUIRE(frames == rounds * payloads.size());
+    printf("%-13s %7u %12.1f %12.1f %12.0f %10.1f\n", name, (unsigned)chunk,
+           rounds * stream.size() / seconds / 1e6, rounds * payloadBytes / seconds / 1e6,
+           frames / seconds, 100.0 * decoder.getZeroCopyCount() / decoder.getFrameCount());
+}
+
+TEST_CASE("Deframing benchmark - stream MB/s", "[.benchmark]") {
+    std::mt19937 rng(7);
+    std::vector<Bytes> csv;
+    std::vector<Bytes> binary;
+    std::vector<Bytes> block;
+    for (int i = 0; i < 5000; i++) {
+        char line[96];
+        int n = snprintf(line, sizeof(line), "2026-10-17 12:%02d:%02d.%03d,%.6f,%.6f,%.2f,%.2f,%.2f,4",
+                         i % 60, (i / 60) % 60, i % 1000, 52.0 + i * 1e-6, 5.9 - i * 1e-6,
+                         10.0 + i * 0.01, (i * 7) % 360 + 0.25, (i % 50) * 1.5);
+        csv.push_back(Bytes(line, line + n));
+        binary.push_back(randomPayload(rng, 35, 0));
+        if (i < 500) {
+            block.push_back(randomPayload(rng, 1024, 0));
+        }
+    }
+
+    printf("\n%-13s %7s %12s %12s %12s %10s\n", "stream", "chunk B", "stream MB/s", "payload MB/s", "frames/s", "zero copy%");
+    const size_t chunkSizes[3] = {64, 1024, 65536};
+    for (int c = 0; c < 3; c++) {
+        benchmarkStream("CSV ~70 B", csv, chunkSizes[c]);
+        benchmarkStream("binary 35 B", binary, chunkSizes[c]);
+        benchmarkStream("random 1 KB", block, chunkSizes[c]);
+    }
+}
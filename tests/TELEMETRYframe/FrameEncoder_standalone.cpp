@@ -0,0 +1,114 @@
+// Standalone build for FrameEncoder tests using Code::Blocks
+// This file contains a copy of the FrameEncoder implementation for standalone compilation
+
+#include <cstdint>
+#include <stddef.h>
+#include <string.h>
+
+#include "FrameEncoder_standalone.h"
+#include "../CRC16/CRC16_standalone.h"
+
+#define ONES  0x01010101u
+#define HIGHS 0x80808080u
+
+// Non-zero if any byte of v is zero
+static inline uint32_t zeroByte(uint32_t v) {
+    return (v - ONES) & ~v & HIGHS;
+}
+
+// Non-zero if any byte of the word is SOH, DLE or CAN. DLE (0x10) and CAN
+// (0x18) differ only in bit 3, so one test with bit 3 set covers both.
+static inline uint32_t framingByte(uint32_t word) {
+    return zeroByte(word ^ (ONES * FrameEncoder::SOH)) |
+           zeroByte((word | (ONES * 0x08)) ^ (ONES * FrameEncoder::CAN));
+}
+
+static inline bool isFramingByte(uint8_t byte) {
+    return byte == FrameEncoder::SOH || byte == FrameEncoder::DLE || byte == FrameEncoder::CAN;
+}
+
+// Stuff one byte; false if it does not fit
+static inline bool stuffByte(uint8_t byte, uint8_t** out, const uint8_t* end) {
+    if (isFramingByte(byte)) {
+        if (end - *out < 2) {
+            return false;
+        }
+        *(*out)++ = FrameEncoder::DLE;
+    } else if (*out >= end) {
+        return false;
+    }
+    *(*out)++ = byte;
+    return true;
+}
+
+// Copy and stuff data while updating the CRC
+static bool stuffData(const uint8_t* data, size_t length, uint16_t* crcValue, uint8_t** outPos, const uint8_t* end) {
+    uint16_t crc = *crcValue;
+    uint8_t* out = *outPos;
+    size_t i = 0;
+
+    while (i + 4 <= length) {
+        uint32_t word;
+        memcpy(&word, data + i, 4);
+        if (framingByte(word) == 0) {
+            if (end - out < 4) {
+                return false;
+            }
+            memcpy(out, data + i, 4);
+            out += 4;
+            crc = stepCRC16(crc, data[i]);
+            crc = stepCRC16(crc, data[i + 1]);
+            crc = stepCRC16(crc, data[i + 2]);
+            crc = stepCRC16(crc, data[i + 3]);
+        } else {
+            for (size_t k = i; k < i + 4; k++) {
+                crc = stepCRC16(crc, data[k]);
+                if (!stuffByte(data[k], &out, end)) {
+                    return false;
+                }
+            }
+        }
+        i += 4;
+    }
+    for (; i < length; i++) {
+        crc = stepCRC16(crc, data[i]);
+        if (!stuffByte(data[i], &out, end)) {
+            return false;
+        }
+    }
+
+    *crcValue = crc;
+    *outPos = out;
+    return true;
+}
+
+size_t FrameEncoder::encode(const uint8_t* payload, size_t length, uint8_t* frame, size_t size) {
+    FrameSegment segment = {payload, length};
+    return encode(&segment, 1, frame, size);
+}
+
+size_t FrameEncoder::encode(const FrameSegment* segments, size_t count, uint8_t* frame, size_t size) {
+    if (frame == NULL || size < 4 || (segments == NULL && count > 0)) {
+        return 0;
+    }
+    uint8_t* out = frame;
+    const uint8_t* end = frame + size;
+    uint16_t crc = CRC16_INIT;
+
+    *out++ = SOH;
+    for (size_t s = 0; s < count; s++) {
+        if (segments[s].length == 0) {
+            continue;
+        }
+        if (segments[s].data == NULL || !stuffData(segments[s].data, segments[s].length, &crc, &out, end)) {
+            return 0;
+        }
+    }
+    if (!stuffByte((uint8_t)(crc >> 8), &out, end) ||
+        !stuffByte((uint8_t)crc, &out, end) ||
+        out >= end) {
+        return 0;
+    }
+    *out++ = CAN;
+    return (size_t)(out - frame);
+}
@@ -0,0 +1,306 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch.hpp"
+#include "FrameEncoder_standalone.h"
+#include "../CRC16/CRC16_standalone.h"
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#define FRAME_SOH   0x01
+#define FRAME_CAN   0x18
+#define FRAME_DLE   0x10
+
+// Reference: the former framing of src/dataOutputTask.cpp with the bitwise CRC-16
+static uint16_t bitwiseCRC16(const uint8_t* data, size_t length) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= (data[i] << 8);
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static size_t stuff_byte(uint8_t byte, uint8_t* output, size_t out_pos) {
+    if (byte == FRAME_SOH || byte == FRAME_CAN || byte == FRAME_DLE) {
+        output[out_pos++] = FRAME_DLE;
+    }
+    output[out_pos++] = byte;
+    return out_pos;
+}
+
+static size_t referenceFrame(const uint8_t* message, size_t msg_len, uint8_t* frame) {
+    uint16_t crc = bitwiseCRC16(message, msg_len);
+    size_t pos_out = 0;
+    frame[pos_out++] = FRAME_SOH;
+    for (size_t i = 0; i < msg_len; i++) {
+        pos_out = stuff_byte(message[i], frame, pos_out);
+    }
+    pos_out = stuff_byte((uint8_t)(crc >> 8), frame, pos_out);
+    pos_out = stuff_byte((uint8_t)crc, frame, pos_out);
+    frame[pos_out++] = FRAME_CAN;
+    return pos_out;
+}
+
+// Reference deframer: split a byte stream into payloads of frames with a valid CRC
+static std::vector<std::vector<uint8_t> > referenceDeframe(const uint8_t* data, size_t length) {
+    std::vector<std::vector<uint8_t> > payloads;
+    std::vector<uint8_t> current;
+    bool inFrame = false;
+    bool escaped = false;
+    for (size_t i = 0; i < length; i++) {
+        uint8_t byte = data[i];
+        if (escaped) {
+            current.push_back(byte);
+            escaped = false;
+        } else if (byte == FRAME_DLE && inFrame) {
+            escaped = true;
+        } else if (byte == FRAME_SOH) {
+            current.clear();
+            inFrame = true;
+        } else if (byte == FRAME_CAN && inFrame) {
+            inFrame = false;
+            if (current.size() >= 2) {
+                size_t n = current.size() - 2;
+                uint16_t crc = (uint16_t)((current[n] << 8) | current[n + 1]);
+                if (bitwiseCRC16(current.data(), n) == crc) {
+                    payloads.push_back(std::vector<uint8_t>(current.begin(), current.begin() + n));
+                }
+            }
+        } else if (inFrame) {
+            current.push_back(byte);
+        }
+    }
+    return payloads;
+}
+
+// Random payload; bias selects how often framing bytes occur
+static std::vector<uint8_t> randomPayload(std::mt19937& rng, size_t length, int bias) {
+    static const uint8_t framing[3] = {FRAME_SOH, FRAME_DLE, FRAME_CAN};
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::vector<uint8_t> payload(length);
+    for (size_t i = 0; i < length; i++) {
+        payload[i] = (percent(rng) < bias) ? framing[byte(rng) % 3] : (uint8_t)byte(rng);
+    }
+    return payload;
+}
+
+TEST_CASE("FrameEncoder - Known frames", "[FrameEncoder]") {
+    uint8_t frame[64];
+
+    SECTION("ASCII payload without stuffing") {
+        const uint8_t payload[] = {'1', '2', '3', '4', '5'};
+        const uint8_t expected[] = {FRAME_SOH, '1', '2', '3', '4', '5', 0x45, 0x60, FRAME_CAN};
+        REQUIRE(FrameEncoder::encode(payload, sizeof(payload), frame, sizeof(frame)) == sizeof(expected));
+        REQUIRE(memcmp(frame, expected, sizeof(expected)) == 0);
+    }
+
+    SECTION("Empty payload") {
+        const uint8_t expected[] = {FRAME_SOH, 0xFF, 0xFF, FRAME_CAN};
+        REQUIRE(FrameEncoder::encode((const uint8_t*)NULL, 0, frame, sizeof(frame)) == sizeof(expected));
+        REQUIRE(memcmp(frame, expected, sizeof(expected)) == 0);
+    }
+
+    SECTION("Framing bytes in the payload and the CRC are escaped") {
+        // CRC-16 of 0x01 is 0xF1D1
+        const uint8_t payload[] = {FRAME_SOH, 'A', FRAME_DLE, FRAME_CAN, 'B'};
+        uint8_t expected[32];
+        size_t expected_len = referenceFrame(payload, sizeof(payload), expected);
+        REQUIRE(FrameEncoder::encode(payload, sizeof(payload), frame, sizeof(frame)) == expected_len);
+        REQUIRE(memcmp(frame, expected, expected_len) == 0);
+        REQUIRE(frame[1] == FRAME_DLE);
+        REQUIRE(frame[2] == FRAME_SOH);
+    }
+
+    SECTION("Worst case size is known at compile time") {
+        static_assert(FRAME_ENCODER_MAX_SIZE(35) == 76, "Worst case of a 35 byte payload");
+        uint8_t payload[16];
+        memset(payload, FRAME_DLE, sizeof(payload));
+        size_t length = FrameEncoder::encode(payload, sizeof(payload), frame, sizeof(frame));
+        REQUIRE(length >= 2 + 2 * sizeof(payload) + 2);
+        REQUIRE(length <= FRAME_ENCODER_MAX_SIZE(sizeof(payload)));
+    }
+}
+
+TEST_CASE("FrameEncoder - Same frames as the reference framer", "[FrameEncoder]") {
+    std::mt19937 rng(39);
+    std::uniform_int_distribution<int> lengths(0, 300);
+    const int biases[4] = {0, 1, 10, 60};
+    std::vector<uint8_t> storage(300 + 8);
+    uint8_t frame[FRAME_ENCODER_MAX_SIZE(300)];
+    uint8_t expected[FRAME_ENCODER_MAX_SIZE(300)];
+
+    for (int i = 0; i < 20000; i++) {
+        std::vector<uint8_t> payload = randomPayload(rng, lengths(rng), biases[i % 4]);
+        // Every alignment of the payload in memory
+        uint8_t* data = storage.data() + (i % 4);
+        if (!payload.empty()) {
+            memcpy(data, payload.data(), payload.size());
+        }
+
+        size_t expected_len = referenceFrame(data, payload.size(), expected);
+        size_t length = FrameEncoder::encode(data, payload.size(), frame, sizeof(frame));
+        REQUIRE(length == expected_len);
+        REQUIRE(memcmp(frame, expected, length) == 0);
+        REQUIRE(length <= FRAME_ENCODER_MAX_SIZE(payload.size()));
+    }
+}
+
+TEST_CASE("FrameEncoder - Segments give the same frame as one buffer", "[FrameEncoder]") {
+    std::mt19937 rng(139);
+    std::uniform_int_distribution<int> lengths(0, 200);
+    uint8_t frame[FRAME_ENCODER_MAX_SIZE(200)];
+    uint8_t joined[FRAME_ENCODER_MAX_SIZE(200)];
+
+    for (int i = 0; i < 10000; i++) {
+        std::vector<uint8_t> payload = randomPayload(rng, lengths(rng), (i % 2) ? 5 : 40);
+        size_t joined_len = FrameEncoder::encode(payload.data(), payload.size(), joined, sizeof(joined));
+        REQUIRE(joined_len > 0);
+
+        // Split at random points, including empty segments
+        FrameSegment segments[8];
+        size_t count = 0;
+        size_t offset = 0;
+        while (count < 7) {
+            std::uniform_int_distribution<size_t> piece(0, payload.size() - offset);
+            size_t length = piece(rng);
+            segments[count].data = payload.data() + offset;
+            segments[count].length = length;
+            count++;
+            offset += length;
+        }
+        segments[count].data = payload.data() + offset;
+        segments[count].length = payload.size() - offset;
+        count++;
+
+        size_t length = FrameEncoder::encode(segments, count, frame, sizeof(frame));
+        REQUIRE(length == joined_len);
+        REQUIRE(memcmp(frame, joined, length) == 0);
+    }
+
+    SECTION("No segments is an empty payload") {
+        REQUIRE(FrameEncoder::encode((const FrameSegment*)NULL, 0, frame, sizeof(frame)) == 4);
+    }
+    SECTION("A segment without data is refused") {
+        FrameSegment broken = {NULL, 4};
+        REQUIRE(FrameEncoder::encode(&broken, 1, frame, sizeof(frame)) == 0);
+    }
+}
+
+TEST_CASE("FrameEncoder - Output buffer limits", "[FrameEncoder]") {
+    std::mt19937 rng(239);
+    std::uniform_int_distribution<int> lengths(0, 100);
+    uint8_t frame[FRAME_ENCODER_MAX_SIZE(100) + 1];
+
+    for (int i = 0; i < 5000; i++) {
+        std::vector<uint8_t> payload = randomPayload(rng, lengths(rng), (i % 3) * 20);
+        size_t length = FrameEncoder::encode(payload.data(), payload.size(), frame, sizeof(frame));
+        REQUIRE(length > 0);
+
+        // A buffer of exactly the frame size is enough, one byte less is not and is not overrun
+        std::vector<uint8_t> exact(length + 1, 0xA5);
+        REQUIRE(FrameEncoder::encode(payload.data(), payload.size(), exact.data(), length) == length);
+        REQUIRE(memcmp(exact.data(), frame, length) == 0);
+        REQUIRE(exact[length] == 0xA5);
+
+        std::vector<uint8_t> small(length, 0xA5);
+        REQUIRE(FrameEncoder::encode(payload.data(), payload.size(), small.data(), length - 1) == 0);
+        REQUIRE(small[length - 1] == 0xA5);
+    }
+
+    SECTION("Too small for an empty frame") {
+        REQUIRE(FrameEncoder::encode((const uint8_t*)NULL, 0, frame, 3) == 0);
+        REQUIRE(FrameEncoder::encode((const uint8_t*)NULL, 0, NULL, 16) == 0);
+    }
+}
+
+TEST_CASE("FrameEncoder - Round trip through the reference deframer", "[FrameEncoder]") {
+    std::mt19937 rng(339);
+    std::uniform_int_distribution<int> lengths(0, 120);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::vector<std::vector<uint8_t> > sent;
+    std::vector<uint8_t> stream;
+    uint8_t frame[FRAME_ENCODER_MAX_SIZE(120)];
+
+    for (int i = 0; i < 20000; i++) {
+        std::vector<uint8_t> payload = randomPayload(rng, lengths(rng), (i % 5) * 10);
+        size_t length = FrameEncoder::encode(payload.data(), payload.size(), frame, sizeof(frame));
+        REQUIRE(length > 0);
+        stream.insert(stream.end(), frame, frame + length);
+        sent.push_back(payload);
+
+        // Line noise between frames is ignored by the receiver
+        if (percent(rng) < 10) {
+            stream.push_back((uint8_t)'x');
+        }
+    }
+
+    std::vector<std::vector<uint8_t> > received = referenceDeframe(stream.data(), stream.size());
+    REQUIRE(received.size() == sent.size());
+    for (size_t i = 0; i < sent.size(); i++) {
+        REQUIRE(received[i] == sent[i]);
+    }
+}
+
+typedef size_t (*Framer)(const uint8_t*, size_t, uint8_t*, size_t);
+
+static size_t referenceFramer(const uint8_t* payload, size_t length, uint8_t* frame, size_t size) {
+    (void)size;
+    return referenceFrame(payload, length, frame);
+}
+
+static size_t encoderFramer(const uint8_t* payload, size_t length, uint8_t* frame, size_t size) {
+    return FrameEncoder::encode(payload, length, frame, size);
+}
+
+static void benchmarkPayloads(const char* name, const std::vector<std::vector<uint8_t> >& payloads) {
+    const Framer framers[2] = {referenceFramer, encoderFramer};
+    static uint8_t frame[FRAME_ENCODER_MAX_SIZE(1024)];
+    double rate[2];
+    size_t checksum[2] = {0, 0};
+    size_t bytes = 0;
+    for (size_t i = 0; i < payloads.size(); i++) {
+        bytes += payloads[i].size();
+    }
+
+    for (int f = 0; f < 2; f++) {
+        const int rounds = 20;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; r++) {
+            for (size_t i = 0; i < payloads.size(); i++) {
+                checksum[f] += framers[f](payloads[i].data(), payloads[i].size(), frame, sizeof(frame));
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        rate[f] = rounds * bytes / seconds / 1e6;
+    }
+    REQUIRE(checksum[0] == checksum[1]);
+    printf("%-14s %14.1f %14.1f %8.1fx\n", name, rate[0], rate[1], rate[1] / rate[0]);
+}
+
+TEST_CASE("Framing benchmark - payload MB/s", "[.benchmark]") {
+    std::mt19937 rng(7);
+    std::vector<std::vector<uint8_t> > csv;
+    std::vector<std::vector<uint8_t> > binary;
+    std::vector<std::vector<uint8_t> > block;
+    for (int i = 0; i < 5000; i++) {
+        char line[96];
+        int n = snprintf(line, sizeof(line), "2026-10-17 12:%02d:%02d.%03d,%.6f,%.6f,%.2f,%.2f,%.2f,4",
+                         i % 60, (i / 60) % 60, i % 1000, 52.0 + i * 1e-6, 5.9 - i * 1e-6,
+                         10.0 + i * 0.01, (i * 7) % 360 + 0.25, (i % 50) * 1.5);
+        csv.push_back(std::vector<uint8_t>(line, line + n));
+        binary.push_back(randomPayload(rng, 35, 0));
+        if (i < 500) {
+            block.push_back(randomPayload(rng, 1024, 0));
+        }
+    }
+
+    printf("\n%-14s %14s %14s %9s\n", "payload", "reference MB/s", "encoder MB/s", "speedup");
+    benchmarkPayloads("CSV ~70 B", csv);
+    benchmarkPayloads("binary 35 B", binary);
+    benchmarkPayloads("random 1 KB", block);
+}
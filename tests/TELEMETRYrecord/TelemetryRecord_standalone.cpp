@@ -0,0 +1,117 @@
+// Standalone build for TelemetryRecord tests using Code::Blocks
+// This file contains a copy of the TelemetryRecord implementation for standalone compilation
+
+#include <cstdint>
+#include <stddef.h>
+#include <math.h>
+
+#include "TelemetryRecord_standalone.h"
+
+#define MS_PER_DAY 86400000u
+
+// Round to an integer in [low, high]
+static int64_t roundClamped(double value, double low, double high) {
+    if (!(value >= low)) {      // also catches NaN
+        return (int64_t)low;
+    }
+    if (value > high) {
+        return (int64_t)high;
+    }
+    return (int64_t)llround(value);
+}
+
+static uint8_t* put16(uint8_t* out, uint16_t value) {
+    out[0] = (uint8_t)(value >> 8);
+    out[1] = (uint8_t)value;
+    return out + 2;
+}
+
+static uint8_t* put32(uint8_t* out, uint32_t value) {
+    out[0] = (uint8_t)(value >> 24);
+    out[1] = (uint8_t)(value >> 16);
+    out[2] = (uint8_t)(value >> 8);
+    out[3] = (uint8_t)value;
+    return out + 4;
+}
+
+static uint16_t get16(const uint8_t* in) {
+    return (uint16_t)((in[0] << 8) | in[1]);
+}
+
+static uint32_t get32(const uint8_t* in) {
+    return ((uint32_t)in[0] << 24) | ((uint32_t)in[1] << 16) | ((uint32_t)in[2] << 8) | in[3];
+}
+
+TelemetryRecord TelemetryBinary::quantize(uint32_t epoch, bool valid,
+                                          uint8_t year, uint8_t month, uint8_t day, uint32_t timeOfDayMs,
+                                          double latitude, double longitude, float altitude,
+                                          float heading, float speed, uint8_t fixQuality,
+                                          uint8_t sats, float hdop, float age) {
+    TelemetryRecord record;
+    record.version = TELEMETRY_RECORD_VERSION;
+    record.flags = valid ? TELEMETRY_FLAG_VALID : 0;
+    record.epoch = epoch;
+    record.year = year;
+    record.month = month;
+    record.day = day;
+    record.timeOfDayMs = timeOfDayMs % MS_PER_DAY;
+    record.latE7 = (int32_t)roundClamped(latitude * 1e7, -900000000.0, 900000000.0);
+    record.lonE7 = (int32_t)roundClamped(longitude * 1e7, -1800000000.0, 1800000000.0);
+    record.altMm = (int32_t)roundClamped(altitude * 1000.0, -2147483647.0, 2147483647.0);
+    record.headingX100 = (uint16_t)roundClamped(heading * 100.0, 0.0, 65535.0);
+    record.speedX100 = (uint16_t)roundClamped(speed * 100.0, 0.0, 65535.0);
+    record.fixQuality = fixQuality;
+    record.sats = sats;
+    record.hdopX100 = (uint16_t)roundClamped(hdop * 100.0, 0.0, 65535.0);
+    record.ageX100 = (uint16_t)roundClamped(age * 100.0, 0.0, 65535.0);
+    return record;
+}
+
+size_t TelemetryBinary::encode(const TelemetryRecord& record, uint8_t* buffer, size_t size) {
+    if (buffer == NULL || size < TELEMETRY_RECORD_SIZE) {
+        return 0;
+    }
+    uint8_t* out = buffer;
+    *out++ = TELEMETRY_RECORD_VERSION;
+    *out++ = record.flags;
+    out = put32(out, record.epoch);
+    *out++ = record.year;
+    *out++ = record.month;
+    *out++ = record.day;
+    out = put32(out, record.timeOfDayMs);
+    out = put32(out, (uint32_t)record.latE7);
+    out = put32(out, (uint32_t)record.lonE7);
+    out = put32(out, (uint32_t)record.altMm);
+    out = put16(out, record.headingX100);
+    out = put16(out, record.speedX100);
+    *out++ = record.fixQuality;
+    *out++ = record.sats;
+    out = put16(out, record.hdopX100);
+    out = put16(out, record.ageX100);
+    return (size_t)(out - buffer);
+}
+
+bool TelemetryBinary::decode(const uint8_t* payload, size_t length, TelemetryRecord* record) {
+    if (payload == NULL || record == NULL || length < TELEMETRY_RECORD_SIZE ||
+        payload[0] != TELEMETRY_RECORD_VERSION) {
+        return false;
+    }
+    const uint8_t* in = payload;
+    record->version = in[0];
+    record->flags = in[1];
+    record->epoch = get32(in + 2);
+    record->year = in[6];
+    record->month = in[7];
+    record->day = in[8];
+    record->timeOfDayMs = get32(in + 9);
+    record->latE7 = (int32_t)get32(in + 13);
+    record->lonE7 = (int32_t)get32(in + 17);
+    record->altMm = (int32_t)get32(in + 21);
+    record->headingX100 = get16(in + 25);
+    record->speedX100 = get16(in + 27);
+    record->fixQuality = in[29];
+    record->sats = in[30];
+    record->hdopX100 = get16(in + 31);
+    record->ageX100 = get16(in + 33);
+    return true;
+}
@@ -0,0 +1,380 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch.hpp"
+#include "TelemetryRecord_standalone.h"
+#include "../CRC16/CRC16_standalone.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+// Framing bytes of src/dataOutputTask.h
+#define FRAME_SOH   0x01
+#define FRAME_CAN   0x18
+#define FRAME_DLE   0x10
+
+// UART 8N1: 10 bit times per byte
+#define UART_BITS_PER_BYTE 10
+#define UART_BAUD_RATE 115200
+
+// Copy of position_data_t in src/dataOutputTask.h
+typedef struct {
+    uint8_t day;
+    uint8_t month;
+    uint8_t year;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+    uint16_t millisecond;
+    double latitude;
+    double longitude;
+    float altitude;
+    float heading;
+    float speed;
+    bool valid;
+    uint8_t fix_quality;
+    uint8_t satellites;
+    float hdop;
+    float age;
+    uint32_t epoch;
+} position_data_t;
+
+// Copies of the payload builders in src/dataOutputTask.cpp
+static size_t build_csv_payload(const position_data_t* pos, uint8_t* message, size_t size) {
+    int msg_len = snprintf((char*)message, size,
+                          "%04d-%02d-%02d %02d:%02d:%02d.%03d,%.6f,%.6f,%.2f,%.2f,%.2f,%u",
+                          2000 + pos->year, pos->month, pos->day,
+                          pos->hour, pos->minute, pos->second, pos->millisecond,
+                          pos->latitude, pos->longitude,
+                          pos->altitude, pos->heading, pos->speed,
+                          pos->fix_quality);
+    if (msg_len <= 0 || msg_len >= (int)size) {
+        return 0;
+    }
+    return (size_t)msg_len;
+}
+
+static size_t build_binary_payload(const position_data_t* pos, uint8_t* message, size_t size) {
+    uint32_t time_of_day_ms = ((pos->hour * 60u + pos->minute) * 60u + pos->second) * 1000u + pos->millisecond;
+    TelemetryRecord record = TelemetryBinary::quantize(
+        pos->epoch, pos->valid, pos->year, pos->month, pos->day, time_of_day_ms,
+        pos->latitude, pos->longitude, pos->altitude, pos->heading, pos->speed,
+        pos->fix_quality, pos->satellites, pos->hdop, pos->age);
+    return TelemetryBinary::encode(record, message, size);
+}
+
+typedef size_t (*PayloadBuilder)(const position_data_t*, uint8_t*, size_t);
+
+// Copy of the framing in src/dataOutputTask.cpp
+static size_t stuff_byte(uint8_t byte, uint8_t* output, size_t out_pos) {
+    if (byte == FRAME_SOH || byte == FRAME_CAN || byte == FRAME_DLE) {
+        output[out_pos++] = FRAME_DLE;
+    }
+    output[out_pos++] = byte;
+    return out_pos;
+}
+
+static size_t build_frame(const position_data_t* pos, PayloadBuilder builder, uint8_t* frame) {
+    uint8_t message[140];
+    size_t msg_len = builder(pos, message, sizeof(message));
+    if (msg_len == 0) {
+        return 0;
+    }
+    uint16_t crc = calculateCRC16(message, msg_len);
+    size_t pos_out = 0;
+    frame[pos_out++] = FRAME_SOH;
+    for (size_t i = 0; i < msg_len; i++) {
+        pos_out = stuff_byte(message[i], frame, pos_out);
+    }
+    pos_out = stuff_byte((uint8_t)(crc >> 8), frame, pos_out);
+    pos_out = stuff_byte((uint8_t)crc, frame, pos_out);
+    frame[pos_out++] = FRAME_CAN;
+    return pos_out;
+}
+
+// Host-side receiver: unstuff one frame and check its CRC; returns the payload length or -1
+static int deframe(const uint8_t* frame, size_t length, uint8_t* payload, size_t size) {
+    if (length < 4 || frame[0] != FRAME_SOH || frame[length - 1] != FRAME_CAN) {
+        return -1;
+    }
+    size_t out = 0;
+    for (size_t i = 1; i < length - 1; i++) {
+        uint8_t byte = frame[i];
+        if (byte == FRAME_DLE) {
+            if (++i >= length - 1) {
+                return -1;
+            }
+            byte = frame[i];
+        } else if (byte == FRAME_SOH || byte == FRAME_CAN) {
+            return -1;
+        }
+        if (out >= size) {
+            return -1;
+        }
+        payload[out++] = byte;
+    }
+    if (out < 2) {
+        return -1;
+    }
+    out -= 2;
+    uint16_t crc = (uint16_t)((payload[out] << 8) | payload[out + 1]);
+    return calculateCRC16(payload, out) == crc ? (int)out : -1;
+}
+
+static position_data_t makePosition(std::mt19937& rng, uint32_t epoch) {
+    std::uniform_real_distribution<double> lat(-90.0, 90.0);
+    std::uniform_real_distribution<double> lon(-180.0, 180.0);
+    std::uniform_real_distribution<float> alt(-100.0f, 3000.0f);
+    std::uniform_real_distribution<float> heading(0.0f, 359.99f);
+    std::uniform_real_distribution<float> speed(0.0f, 250.0f);
+    std::uniform_real_distribution<float> hdop(0.5f, 9.9f);
+    std::uniform_real_distribution<float> age(0.0f, 30.0f);
+    std::uniform_int_distribution<int> small(0, 59);
+
+    position_data_t pos;
+    memset(&pos, 0, sizeof(pos));
+    pos.year = 26;
+    pos.month = 1 + small(rng) % 12;
+    pos.day = 1 + small(rng) % 28;
+    pos.hour = small(rng) % 24;
+    pos.minute = small(rng);
+    pos.second = small(rng);
+    pos.millisecond = (small(rng) * 17) % 1000;
+    pos.latitude = lat(rng);
+    pos.longitude = lon(rng);
+    pos.altitude = alt(rng);
+    pos.heading = heading(rng);
+    pos.speed = speed(rng);
+    pos.valid = true;
+    pos.fix_quality = (uint8_t)(small(rng) % 6);
+    pos.satellites = (uint8_t)(4 + small(rng) % 30);
+    pos.hdop = hdop(rng);
+    pos.age = age(rng);
+    pos.epoch = epoch;
+    return pos;
+}
+
+TEST_CASE("Binary record - Layout is fixed and big-endian", "[TelemetryRecord]") {
+    TelemetryRecord record = TelemetryBinary::quantize(
+        0x01020304, true, 26, 1, 10, 52252123,
+        -34.1234567, 150.9876543, 123.456f, 270.15f, 45.67f, 4, 12, 0.9f, 1.5f);
+
+    uint8_t payload[TELEMETRY_RECORD_SIZE];
+    REQUIRE(TelemetryBinary::encode(record, payload, sizeof(payload)) == TELEMETRY_RECORD_SIZE);
+
+    const uint8_t expected[TELEMETRY_RECORD_SIZE] = {
+        0x01,                   // Version
+        0x01,                   // Flags: valid
+        0x01, 0x02, 0x03, 0x04, // Epoch
+        26, 1, 10,              // Date
+        0x03, 0x1D, 0x4D, 0xDB, // 52252123 ms = 14:30:52.123
+        0xEB, 0xA9, 0x2C, 0x79, // -341234567
+        0x59, 0xFE, 0xE3, 0x3F, // 1509876543
+        0x00, 0x01, 0xE2, 0x40, // 123456 mm
+        0x69, 0x87,             // 27015
+        0x11, 0xD7,             // 4567
+        4, 12,                  // Fix, satellites
+        0x00, 0x5A,             // HDOP 90
+        0x00, 0x96              // Age 150
+    };
+    REQUIRE(memcmp(payload, expected, sizeof(expected)) == 0);
+
+    SECTION("Buffer too small") {
+        REQUIRE(TelemetryBinary::encode(record, payload, TELEMETRY_RECORD_SIZE - 1) == 0);
+        REQUIRE(TelemetryBinary::encode(record, NULL, sizeof(payload)) == 0);
+    }
+}
+
+TEST_CASE("Binary record - Round trip keeps the quantized resolution", "[TelemetryRecord]") {
+    std::mt19937 rng(38);
+    for (uint32_t i = 0; i < 10000; i++) {
+        position_data_t pos = makePosition(rng, i * 7919);
+        uint8_t payload[TELEMETRY_RECORD_SIZE];
+        REQUIRE(build_binary_payload(&pos, payload, sizeof(payload)) == TELEMETRY_RECORD_SIZE);
+
+        TelemetryRecord record;
+        REQUIRE(TelemetryBinary::decode(payload, sizeof(payload), &record));
+        REQUIRE(record.version == TELEMETRY_RECORD_VERSION);
+        REQUIRE(record.flags == TELEMETRY_FLAG_VALID);
+        REQUIRE(record.epoch == pos.epoch);
+        REQUIRE(record.year == pos.year);
+        REQUIRE(record.month == pos.month);
+        REQUIRE(record.day == pos.day);
+        REQUIRE(record.timeOfDayMs ==
+                ((pos.hour * 60u + pos.minute) * 60u + pos.second) * 1000u + pos.millisecond);
+        // Within half a step of the resolution, at least as fine as the CSV text
+        REQUIRE(fabs(record.latE7 * 1e-7 - pos.latitude) <= 0.5e-7 + 1e-12);
+        REQUIRE(fabs(record.lonE7 * 1e-7 - pos.longitude) <= 0.5e-7 + 1e-12);
+        REQUIRE(fabs(record.altMm * 1e-3 - pos.altitude) <= 0.5e-3 + 1e-4);
+        REQUIRE(fabs(record.headingX100 * 0.01 - pos.heading) <= 0.005 + 1e-4);
+        REQUIRE(fabs(record.speedX100 * 0.01 - pos.speed) <= 0.005 + 1e-4);
+        REQUIRE(record.fixQuality == pos.fix_quality);
+        REQUIRE(record.sats == pos.satellites);
+        REQUIRE(fabs(record.hdopX100 * 0.01 - pos.hdop) <= 0.005 + 1e-5);
+        REQUIRE(fabs(record.ageX100 * 0.01 - pos.age) <= 0.005 + 1e-5);
+
+        // Encoding the decoded record gives the same bytes
+        uint8_t again[TELEMETRY_RECORD_SIZE];
+        REQUIRE(TelemetryBinary::encode(record, again, sizeof(again)) == TELEMETRY_RECORD_SIZE);
+        REQUIRE(memcmp(payload, again, sizeof(payload)) == 0);
+    }
+}
+
+TEST_CASE("Binary record - Out of range values are clamped", "[TelemetryRecord]") {
+    TelemetryRecord record = TelemetryBinary::quantize(
+        0, false, 26, 1, 1, 86400000u + 5,
+        95.0, -200.0, NAN, -1.0f, 1000.0f, 4, 12, 700.0f, -3.0f);
+    REQUIRE(record.flags == 0);
+    REQUIRE(record.timeOfDayMs == 5);
+    REQUIRE(record.latE7 == 900000000);
+    REQUIRE(record.lonE7 == -1800000000);
+    REQUIRE(record.altMm == -2147483647);
+    REQUIRE(record.headingX100 == 0);
+    REQUIRE(record.speedX100 == 65535);
+    REQUIRE(record.hdopX100 == 65535);
+    REQUIRE(record.ageX100 == 0);
+
+    record = TelemetryBinary::quantize(
+        1, true, 26, 1, 1, 0, -90.0, 180.0, -1e12f, 359.999f, 0.0f, 0, 0, 0.0f, 0.0f);
+    REQUIRE(record.latE7 == -900000000);
+    REQUIRE(record.lonE7 == 1800000000);
+    REQUIRE(record.altMm == -2147483647);
+    REQUIRE(record.headingX100 == 36000);
+}
+
+TEST_CASE("Binary record - Version and length checks", "[TelemetryRecord]") {
+    TelemetryRecord record = TelemetryBinary::quantize(
+        42, true, 26, 10, 17, 43200000, 52.0, 5.9, 10.0f, 90.0f, 3.6f, 5, 18, 0.7f, 2.0f);
+    uint8_t payload[TELEMETRY_RECORD_SIZE + 8];
+    memset(payload, 0xEE, sizeof(payload));
+    REQUIRE(TelemetryBinary::encode(record, payload, sizeof(payload)) == TELEMETRY_RECORD_SIZE);
+
+    TelemetryRecord decoded;
+    SECTION("Bytes after the known fields are ignored") {
+        REQUIRE(TelemetryBinary::decode(payload, sizeof(payload), &decoded));
+        REQUIRE(decoded.epoch == 42);
+        REQUIRE(decoded.fixQuality == 5);
+    }
+    SECTION("Short payload is refused") {
+        REQUIRE_FALSE(TelemetryBinary::decode(payload, TELEMETRY_RECORD_SIZE - 1, &decoded));
+        REQUIRE_FALSE(TelemetryBinary::decode(payload, 0, &decoded));
+    }
+    SECTION("Other version is refused") {
+        payload[0] = TELEMETRY_RECORD_VERSION + 1;
+        REQUIRE_FALSE(TelemetryBinary::decode(payload, TELEMETRY_RECORD_SIZE, &decoded));
+    }
+    SECTION("Binary payload and CSV line are told apart by the first byte") {
+        REQUIRE(TelemetryBinary::isBinary(payload, TELEMETRY_RECORD_SIZE));
+        const char* csv = "2026-10-17 12:00:00.000,52.000000,5.900000,10.00,90.00,3.60,5";
+        REQUIRE_FALSE(TelemetryBinary::isBinary((const uint8_t*)csv, strlen(csv)));
+        REQUIRE_FALSE(TelemetryBinary::isBinary(payload, 0));
+    }
+}
+
+TEST_CASE("Binary record - Frames survive stuffing and CRC like CSV frames", "[TelemetryRecord]") {
+    std::mt19937 rng(1038);
+    uint8_t frame[256];
+    uint8_t payload[256];
+    size_t stuffed = 0;
+
+    for (uint32_t i = 0; i < 5000; i++) {
+        position_data_t pos = makePosition(rng, i);
+        // Force bytes that need stuffing into the record
+        if (i % 10 == 0) {
+            pos.epoch = 0x10011810;
+            pos.fix_quality = FRAME_SOH;
+            pos.satellites = FRAME_CAN;
+        }
+        size_t frame_len = build_frame(&pos, build_binary_payload, frame);
+        REQUIRE(frame_len >= TELEMETRY_RECORD_SIZE + 4);
+        REQUIRE(frame_len <= 2 + 2 * (TELEMETRY_RECORD_SIZE + 2));
+        stuffed += frame_len - (TELEMETRY_RECORD_SIZE + 4);
+
+        // No framing byte inside the frame is left unescaped
+        for (size_t j = 1; j + 1 < frame_len; j++) {
+            if (frame[j] == FRAME_DLE) {
+                j++;
+            } else {
+                REQUIRE(frame[j] != FRAME_SOH);
+                REQUIRE(frame[j] != FRAME_CAN);
+            }
+        }
+
+        int length = deframe(frame, frame_len, payload, sizeof(payload));
+        REQUIRE(length == TELEMETRY_RECORD_SIZE);
+        REQUIRE(TelemetryBinary::isBinary(payload, length));
+        TelemetryRecord record;
+        REQUIRE(TelemetryBinary::decode(payload, length, &record));
+        REQUIRE(record.epoch == pos.epoch);
+        REQUIRE(record.fixQuality == pos.fix_quality);
+        REQUIRE(record.sats == pos.satellites);
+
+        // A flipped bit is caught by the CRC
+        frame[1 + i % (frame_len - 2)] ^= 0x40;
+        REQUIRE(deframe(frame, frame_len, payload, sizeof(payload)) == -1);
+    }
+    REQUIRE(stuffed > 0);
+}
+
+TEST_CASE("Binary record - Frames are smaller than CSV frames", "[TelemetryRecord]") {
+    std::mt19937 rng(2038);
+    uint8_t frame[256];
+    size_t csv_bytes = 0;
+    size_t binary_bytes = 0;
+    size_t binary_max = 0;
+    const uint32_t frames = 10000;
+
+    for (uint32_t i = 0; i < frames; i++) {
+        position_data_t pos = makePosition(rng, i);
+        size_t csv_len = build_frame(&pos, build_csv_payload, frame);
+        size_t binary_len = build_frame(&pos, build_binary_payload, frame);
+        REQUIRE(csv_len > 0);
+        REQUIRE(binary_len > 0);
+        REQUIRE(binary_len < csv_len);
+        csv_bytes += csv_len;
+        binary_bytes += binary_len;
+        if (binary_len > binary_max) {
+            binary_max = binary_len;
+        }
+    }
+
+    double csv_avg = (double)csv_bytes / frames;
+    double binary_avg = (double)binary_bytes / frames;
+    // A binary frame is about 60% of a CSV frame, the same UART carries 1.6 times the rate
+    REQUIRE(binary_avg < 0.65 * csv_avg);
+    REQUIRE(binary_max <= 2 + 2 * (TELEMETRY_RECORD_SIZE + 2));
+
+    double uart_bytes_per_s = (double)UART_BAUD_RATE / UART_BITS_PER_BYTE;
+    REQUIRE(uart_bytes_per_s / binary_avg > 100.0);
+}
+
+static void benchmarkFormat(const char* name, const std::vector<position_data_t>& positions, PayloadBuilder builder) {
+    const int rounds = 20;
+    uint8_t frame[256];
+    size_t bytes = 0;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < positions.size(); i++) {
+            bytes += build_frame(&positions[i], builder, frame);
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double count = (double)rounds * positions.size();
+    double frame_avg = bytes / count;
+    double uart_rate = (double)UART_BAUD_RATE / UART_BITS_PER_BYTE / frame_avg;
+    printf("%-8s %12.1f %12.0f %14.0f %10.2f\n", name, frame_avg, uart_rate, count / seconds, seconds * 1e9 / count);
+}
+
+TEST_CASE("Telemetry frame benchmark - size, UART rate and frames per second", "[.benchmark]") {
+    std::mt19937 rng(7);
+    std::vector<position_data_t> positions;
+    for (uint32_t i = 0; i < 5000; i++) {
+        positions.push_back(makePosition(rng, i));
+    }
+
+    printf("\n%-8s %12s %12s %14s %10s\n", "format", "frame B", "max Hz@115k2", "frames/s", "ns/frame");
+    benchmarkFormat("CSV", positions, build_csv_payload);
+    benchmarkFormat("binary", positions, build_binary_payload);
+}
@@ -0,0 +1,181 @@
+/*!
+ * \file OutputRouter.h
+ * \brief Fans complete telemetry frames out to several sinks with one shared copy.
+ *
+ * Used by the Data Output Task to send each frame to the telemetry UART, a
+ * second UART, UDP and TCP clients. A frame is copied once into a slot of a
+ * shared pool when it is routed; every sink gets a reference to that slot in
+ * its own queue and sends straight from the slot memory. A slot returns to
+ * the pool when the last sink has sent or dropped it.
+ *
+ * Unlike FanoutBuffer (a byte stream for the NMEA server and caster) the
+ * router keeps frames whole: a queue entry is always one complete frame, so a
+ * datagram sink sends one frame per datagram and a stream sink never receives
+ * a torn frame.
+ *
+ * \section router_backpressure Backpressure
+ * Routing never blocks and a sink is never disconnected by the router. When
+ * a sink's queue is full the oldest frame that it has not started sending is
+ * dropped to make room, so a slow sink gets the newest positions with gaps
+ * instead of an ever older backlog. A frame that is partly sent is kept, so
+ * the stream stays decodable. If the pool runs out of free slots, the sink
+ * with the largest backlog drops its oldest unsent frame until a slot is free.
+ * Every drop is counted for the sink it happened to; other sinks are not
+ * affected.
+ *
+ * \section router_threading Threading
+ * The class is not thread-safe. When routing and sending run in different
+ * tasks the caller protects all calls with one mutex.
+ */
+
+#ifndef OUTPUT_ROUTER_STANDALONE_H
+#define OUTPUT_ROUTER_STANDALONE_H
+
+#include <cstdint>
+#include <stddef.h>
+
+/**
+ * \brief Counters of one sink.
+ */
+struct OutputSinkStats {
+    uint32_t frames;        /**< Frames completely sent */
+    uint64_t bytes;         /**< Bytes sent */
+    uint32_t dropped;       /**< Frames dropped because the queue or the pool was full */
+    uint16_t pending;       /**< Frames queued now, including a partly sent one */
+    uint16_t maxPending;    /**< Most frames queued at once */
+};
+
+class OutputRouter {
+public:
+    OutputRouter();
+    ~OutputRouter();
+
+    /**
+     * \brief Allocate the frame pool and the sink queues.
+     * \param[in] frameCount Number of frame slots in the shared pool.
+     * \param[in] frameSize Largest frame in bytes.
+     * \param[in] maxSinks Maximum number of concurrent sinks.
+     * \param[in] maxDepth Largest queue depth a sink may ask for.
+     * \return true on success, false on invalid arguments or allocation failure.
+     */
+    bool init(size_t frameCount, size_t frameSize, size_t maxSinks, size_t maxDepth);
+
+    /**
+     * \brief Release all memory. All sinks are removed.
+     */
+    void deinit();
+
+    /**
+     * \brief Add a sink. It receives frames routed from now on.
+     * \param[in] depth Frames the sink may have queued (1 to maxDepth).
+     * \return Sink ID, or -1 if all sink slots are in use or the depth is invalid.
+     */
+    int addSink(size_t depth);
+
+    /**
+     * \brief Remove a sink and release its queued frames.
+     * \param[in] id Sink ID returned by addSink().
+     */
+    void removeSink(int id);
+
+    /**
+     * \brief Drop all frames queued for a sink, e.g. after its connection was lost.
+     *
+     * The frames are not counted as dropped.
+     * \param[in] id Sink ID.
+     */
+    void clearSink(int id);
+
+    /**
+     * \brief Queue a frame for all sinks.
+     * \param[in] frame Complete frame.
+     * \param[in] length Length of the frame (at most frameSize).
+     * \return Number of sinks the frame was queued for (0 without sinks or if the frame is too long).
+     */
+    size_t route(const uint8_t* frame, size_t length);
+
+    /**
+     * \brief Get the unsent part of the oldest queued frame of a sink.
+     * \param[in] id Sink ID.
+     * \param[out] data Receives a pointer into the frame slot (valid until consume() or route()).
+     * \param[out] length Receives the number of unsent bytes of the frame.
+     * \return true if a frame is pending, false otherwise.
+     */
+    bool peek(int id, const uint8_t** data, size_t* length) const;
+
+    /**
+     * \brief Mark bytes returned by peek() as sent.
+     * \param[in] id Sink ID.
+     * \param[in] bytes Number of bytes sent (at most the length from peek()).
+     */
+    void consume(int id, size_t bytes);
+
+    /**
+     * \brief Number of frames queued for a sink.
+     * \param[in] id Sink ID.
+     */
+    size_t pendingFrames(int id) const;
+
+    /**
+     * \brief Number of unsent bytes queued for a sink.
+     * \param[in] id Sink ID.
+     */
+    size_t pendingBytes(int id) const;
+
+    /**
+     * \brief Get the counters of a sink.
+     * \param[in] id Sink ID.
+     * \param[out] stats Counters since the sink was added.
+     * \return false for an unknown sink.
+     */
+    bool getSinkStats(int id, OutputSinkStats* stats) const;
+
+    /** \brief Number of sinks. */
+    size_t getSinkCount() const;
+
+    /** \brief Number of pool slots currently referenced. */
+    size_t getFramesInUse() const;
+
+    /** \brief Total frames routed to at least one sink since init(). */
+    uint32_t getRoutedFrames() const { return routedFrames; }
+
+    /** \brief Total bytes routed since init() (counted once, not per sink). */
+    uint64_t getRoutedBytes() const { return routedBytes; }
+
+private:
+    struct Slot {
+        uint16_t length;
+        uint16_t refs;
+    };
+
+    struct Sink {
+        bool active;
+        uint16_t depth;
+        uint16_t head;
+        uint16_t count;
+        uint16_t offset;
+        uint16_t* ring;
+        OutputSinkStats stats;
+    };
+
+    uint8_t* storage;
+    Slot* slots;
+    Sink* sinks;
+    uint16_t* rings;
+    size_t slotCount;
+    size_t slotSize;
+    size_t maxSinks;
+    size_t maxDepth;
+    size_t nextFree;
+
+    uint32_t routedFrames;
+    uint64_t routedBytes;
+
+    bool validId(int id) const;
+    int allocateSlot();
+    void release(uint16_t slot);
+    bool dropOldestUnsent(Sink& sink);
+    void dropQueue(Sink& sink);
+};
+
+#endif // OUTPUT_ROUTER_STANDALONE_H
@@ -0,0 +1,588 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch.hpp"
+#include "OutputRouter_standalone.h"
+#include "../TELEMETRYframe/FrameEncoder_standalone.h"
+#include "../TELEMETRYdecoder/FrameDecoder_standalone.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+// Router dimensions used by dataOutputTask.cpp
+static const size_t FRAME_SIZE = FRAME_ENCODER_MAX_SIZE(140);
+static const size_t POOL_FRAMES = 16;
+static const size_t MAX_SINKS = 7;          // UART, second UART, UDP and 4 TCP clients
+static const size_t UART_DEPTH = 1;
+static const size_t UDP_DEPTH = 2;
+static const size_t TCP_DEPTH = 8;
+static const size_t MAX_DEPTH = TCP_DEPTH;
+
+typedef std::vector<uint8_t> Bytes;
+
+// CSV telemetry frame with a sequence number as the epoch field
+static Bytes makeFrame(uint32_t sequence) {
+    char line[96];
+    int n = snprintf(line, sizeof(line), "%u,2026-10-17 12:%02u:%02u.%03u,%.6f,%.6f,%.2f,%.2f,%.2f,4",
+                     sequence, (sequence / 1000) % 60, (sequence / 20) % 60, (sequence % 20) * 50,
+                     52.0 + sequence * 1e-6, 5.9 - sequence * 1e-6, 10.0 + sequence * 0.01,
+                     (sequence * 7) % 360 + 0.25, (sequence % 50) * 1.5);
+    Bytes frame(FRAME_ENCODER_MAX_SIZE(n));
+    frame.resize(FrameEncoder::encode((const uint8_t*)line, n, frame.data(), frame.size()));
+    return frame;
+}
+
+// Decodes the byte stream of one sink and records the sequence numbers
+struct StreamReceiver {
+    uint8_t buffer[FRAME_DECODER_BUFFER_SIZE(160)];
+    FrameDecoder decoder;
+    std::vector<uint32_t> sequences;
+    std::vector<int64_t> arrivals;
+    int64_t now;
+
+    StreamReceiver() : now(0) {
+        decoder.begin(buffer, sizeof(buffer));
+        decoder.setFrameCallback(onFrame, this);
+    }
+
+    static void onFrame(const uint8_t* payload, size_t length, void* context) {
+        StreamReceiver* receiver = static_cast<StreamReceiver*>(context);
+        receiver->sequences.push_back((uint32_t)strtoul(std::string((const char*)payload, length).c_str(), NULL, 10));
+        receiver->arrivals.push_back(receiver->now);
+    }
+
+    bool clean() const {
+        return decoder.getCrcErrorCount() == 0 && decoder.getAbortedCount() == 0 &&
+               decoder.getEscapeErrorCount() == 0 && decoder.getOverrunCount() == 0;
+    }
+
+    bool increasing() const {
+        for (size_t i = 1; i < sequences.size(); i++) {
+            if (sequences[i] <= sequences[i - 1]) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// Send up to budget bytes of a sink, like a non-blocking socket or UART; returns bytes sent
+static size_t drain(OutputRouter& router, int id, StreamReceiver& receiver, size_t budget) {
+    size_t total = 0;
+    const uint8_t* data;
+    size_t length;
+    while (total < budget && router.peek(id, &data, &length)) {
+        size_t chunk = std::min(length, budget - total);
+        receiver.decoder.feed(data, chunk);
+        router.consume(id, chunk);
+        total += chunk;
+    }
+    return total;
+}
+
+// Frames in and out of a sink must add up
+static void requireBalanced(OutputRouter& router, int id, uint32_t routed) {
+    OutputSinkStats stats;
+    REQUIRE(router.getSinkStats(id, &stats));
+    REQUIRE(stats.frames + stats.dropped + stats.pending == routed);
+    REQUIRE(stats.pending == router.pendingFrames(id));
+}
+
+TEST_CASE("OutputRouter - Setup and arguments", "[OutputRouter]") {
+    OutputRouter router;
+    REQUIRE_FALSE(router.init(0, FRAME_SIZE, MAX_SINKS, MAX_DEPTH));
+    REQUIRE_FALSE(router.init(POOL_FRAMES, 0, MAX_SINKS, MAX_DEPTH));
+    REQUIRE_FALSE(router.init(POOL_FRAMES, FRAME_SIZE, 0, MAX_DEPTH));
+    REQUIRE_FALSE(router.init(POOL_FRAMES, FRAME_SIZE, MAX_SINKS, 0));
+    REQUIRE_FALSE(router.init(0x10000, FRAME_SIZE, MAX_SINKS, MAX_DEPTH));
+    REQUIRE(router.init(POOL_FRAMES, FRAME_SIZE, 2, MAX_DEPTH));
+
+    Bytes frame = makeFrame(1);
+    REQUIRE(router.route(frame.data(), frame.size()) == 0);   // No sinks
+    REQUIRE(router.getRoutedFrames() == 0);
+
+    REQUIRE(router.addSink(0) == -1);
+    REQUIRE(router.addSink(MAX_DEPTH + 1) == -1);
+    int a = router.addSink(UART_DEPTH);
+    int b = router.addSink(TCP_DEPTH);
+    REQUIRE(a >= 0);
+    REQUIRE(b >= 0);
+    REQUIRE(router.addSink(1) == -1);     // All slots in use
+    REQUIRE(router.getSinkCount() == 2);
+
+    Bytes tooLong(FRAME_SIZE + 1, 'x');
+    REQUIRE(router.route(tooLong.data(), tooLong.size()) == 0);
+    REQUIRE(router.route(NULL, 10) == 0);
+    REQUIRE(router.route(frame.data(), 0) == 0);
+
+    REQUIRE(router.route(frame.data(), frame.size()) == 2);
+    REQUIRE(router.getFramesInUse() == 1);
+    REQUIRE(router.pendingBytes(a) == frame.size());
+    REQUIRE(router.pendingBytes(b) == frame.size());
+
+    const uint8_t* data;
+    size_t length;
+    REQUIRE(router.peek(a, &data, &length));
+    REQUIRE(length == frame.size());
+    REQUIRE(memcmp(data, frame.data(), length) == 0);
+    router.consume(a, 10);
+    REQUIRE(router.pendingBytes(a) == frame.size() - 10);
+    REQUIRE(router.peek(a, &data, &length));
+    REQUIRE(length == frame.size() - 10);
+
+    // Cleared and removed queues release the frame without counting a drop
+    router.clearSink(a);
+    REQUIRE(router.pendingFrames(a) == 0);
+    REQUIRE(router.getFramesInUse() == 1);
+    router.removeSink(b);
+    REQUIRE(router.getFramesInUse() == 0);
+    REQUIRE(router.getSinkCount() == 1);
+    OutputSinkStats stats;
+    REQUIRE(router.getSinkStats(a, &stats));
+    REQUIRE(stats.dropped == 0);
+    REQUIRE(stats.bytes == 10);
+    REQUIRE_FALSE(router.getSinkStats(b, &stats));
+
+    // A removed slot can be used again, with fresh counters
+    int c = router.addSink(UDP_DEPTH);
+    REQUIRE(c == b);
+    REQUIRE(router.getSinkStats(c, &stats));
+    REQUIRE(stats.frames == 0);
+    REQUIRE(stats.bytes == 0);
+
+    router.deinit();
+    REQUIRE(router.route(frame.data(), frame.size()) == 0);
+    REQUIRE_FALSE(router.peek(a, &data, &length));
+}
+
+TEST_CASE("OutputRouter - Every sink receives every frame once and whole", "[OutputRouter]") {
+    OutputRouter router;
+    REQUIRE(router.init(POOL_FRAMES, FRAME_SIZE, MAX_SINKS, MAX_DEPTH));
+
+    const size_t depths[MAX_SINKS] = {UART_DEPTH, UART_DEPTH, UDP_DEPTH, TCP_DEPTH, TCP_DEPTH, TCP_DEPTH, TCP_DEPTH};
+    int ids[MAX_SINKS];
+    StreamReceiver receivers[MAX_SINKS];
+    for (size_t s = 0; s < MAX_SINKS; s++) {
+        ids[s] = router.addSink(depths[s]);
+        REQUIRE(ids[s] >= 0);
+    }
+
+    // Sinks send in different chunk sizes: whole frames, UART FIFO, small TCP segments
+    const size_t budgets[MAX_SINKS] = {1000, 128, 1000, 1, 7, 64, 1000};
+    const uint32_t frames = 2000;
+    uint64_t bytes = 0;
+    for (uint32_t i = 1; i <= frames; i++) {
+        Bytes frame = makeFrame(i);
+        bytes += frame.size();
+        REQUIRE(router.route(frame.data(), frame.size()) == MAX_SINKS);
+        for (size_t s = 0; s < MAX_SINKS; s++) {
+            while (drain(router, ids[s], receivers[s], budgets[s]) > 0) {
+            }
+        }
+    }
+
+    REQUIRE(router.getRoutedFrames() == frames);
+    REQUIRE(router.getRoutedBytes() == bytes);
+    REQUIRE(router.getFramesInUse() == 0);
+    for (size_t s = 0; s < MAX_SINKS; s++) {
+        REQUIRE(receivers[s].clean());
+        REQUIRE(receivers[s].sequences.size() == frames);
+        REQUIRE(receivers[s].increasing());
+        OutputSinkStats stats;
+        REQUIRE(router.getSinkStats(ids[s], &stats));
+        REQUIRE(stats.frames == frames);
+        REQUIRE(stats.bytes == bytes);
+        REQUIRE(stats.dropped == 0);
+        REQUIRE(stats.pending == 0);
+        REQUIRE(stats.maxPending == 1);
+    }
+}
+
+TEST_CASE("OutputRouter - A full queue drops its oldest unsent frame", "[OutputRouter]") {
+    OutputRouter router;
+    REQUIRE(router.init(POOL_FRAMES, FRAME_SIZE, 2, MAX_DEPTH));
+    StreamReceiver receiver;
+
+    SECTION("Newest frames are kept") {
+        int id = router.addSink(3);
+        for (uint32_t i = 1; i <= 5; i++) {
+            Bytes frame = makeFrame(i);
+            REQUIRE(router.route(frame.data(), frame.size()) == 1);
+        }
+        OutputSinkStats stats;
+        REQUIRE(router.getSinkStats(id, &stats));
+        REQUIRE(stats.dropped == 2);
+        REQUIRE(stats.pending == 3);
+        REQUIRE(stats.maxPending == 3);
+        REQUIRE(router.getFramesInUse() == 3);
+
+        drain(router, id, receiver, 100000);
+        REQUIRE(receiver.clean());
+        REQUIRE(receiver.sequences == std::vector<uint32_t>({3, 4, 5}));
+        requireBalanced(router, id, 5);
+    }
+
+    SECTION("A partly sent frame stays, the one behind it is dropped") {
+        int id = router.addSink(2);
+        Bytes first = makeFrame(1);
+        router.route(first.data(), first.size());
+        drain(router, id, receiver, first.size() / 2);
+
+        for (uint32_t i = 2; i <= 4; i++) {
+            Bytes frame = makeFrame(i);
+            REQUIRE(router.route(frame.data(), frame.size()) == 1);
+        }
+        drain(router, id, receiver, 100000);
+        REQUIRE(receiver.clean());
+        REQUIRE(receiver.sequences == std::vector<uint32_t>({1, 4}));
+        requireBalanced(router, id, 4);
+    }
+
+    SECTION("Queue of one with a partly sent frame: the new frame is dropped") {
+        int id = router.addSink(1);
+        int other = router.addSink(4);
+        Bytes first = makeFrame(1);
+        router.route(first.data(), first.size());
+        drain(router, id, receiver, 5);
+
+        Bytes second = makeFrame(2);
+        REQUIRE(router.route(second.data(), second.size()) == 1);   // Only the other sink
+        Bytes third = makeFrame(3);
+        REQUIRE(router.route(third.data(), third.size()) == 1);
+        drain(router, id, receiver, 100000);
+
+        Bytes fourth = makeFrame(4);
+        REQUIRE(router.route(fourth.data(), fourth.size()) == 2);
+        drain(router, id, receiver, 100000);
+        REQUIRE(receiver.clean());
+        REQUIRE(receiver.sequences == std::vector<uint32_t>({1, 4}));
+        requireBalanced(router, id, 4);
+        REQUIRE(router.pendingFrames(other) == 4);
+    }
+}
+
+TEST_CASE("OutputRouter - A stalled sink does not delay the others", "[OutputRouter]") {
+    OutputRouter router;
+    REQUIRE(router.init(POOL_FRAMES, FRAME_SIZE, MAX_SINKS, MAX_DEPTH));
+
+    // 50 Hz for 60 s: UART at 115200 baud, UDP, a TCP client that reads, one
+    // that stopped reading, and a UART at 9600 baud that is too slow for 50 Hz
+    int uart = router.addSink(UART_DEPTH);
+    int udp = router.addSink(UDP_DEPTH);
+    int tcp = router.addSink(TCP_DEPTH);
+    int stalled = router.addSink(TCP_DEPTH);
+    int slowUart = router.addSink(UART_DEPTH);
+    StreamReceiver uartRx, udpRx, tcpRx, stalledRx, slowRx;
+
+    // The UART driver ring takes whole frames while two fit, the wire empties it
+    const size_t ring = 2 * FRAME_SIZE;
+    size_t uartRing = 0;
+    size_t slowRing = 0;
+    const uint32_t frames = 3000;
+    for (uint32_t i = 1; i <= frames; i++) {
+        Bytes frame = makeFrame(i);
+        router.route(frame.data(), frame.size());
+
+        const uint8_t* data;
+        size_t length;
+        while (router.peek(uart, &data, &length) && uartRing + length <= ring) {
+            uartRx.decoder.feed(data, length);
+            router.consume(uart, length);
+            uartRing += length;
+        }
+        while (router.peek(slowUart, &data, &length) && slowRing + length <= ring) {
+            slowRx.decoder.feed(data, length);
+            router.consume(slowUart, length);
+            slowRing += length;
+        }
+        drain(router, udp, udpRx, 100000);
+        drain(router, tcp, tcpRx, 100000);
+
+        // 20 ms on the wire: 230 bytes at 115200, 19 bytes at 9600 baud
+        uartRing -= std::min(uartRing, (size_t)230);
+        slowRing -= std::min(slowRing, (size_t)19);
+    }
+
+    // Fast sinks get every frame, the stalled TCP client only fills its queue
+    REQUIRE(uartRx.sequences.size() == frames);
+    REQUIRE(udpRx.sequences.size() == frames);
+    REQUIRE(tcpRx.sequences.size() == frames);
+    REQUIRE(stalledRx.sequences.empty());
+    REQUIRE(router.pendingFrames(stalled) == TCP_DEPTH);
+
+    OutputSinkStats stats;
+    router.getSinkStats(stalled, &stats);
+    REQUIRE(stats.dropped == frames - TCP_DEPTH);
+    REQUIRE(stats.frames == 0);
+
+    // The slow UART gets a decodable stream of recent frames with gaps
+    REQUIRE(slowRx.clean());
+    REQUIRE(slowRx.increasing());
+    REQUIRE(slowRx.sequences.size() > frames / 8);
+    REQUIRE(slowRx.sequences.size() < frames / 2);
+    REQUIRE(slowRx.sequences.back() >= frames - 6);
+    router.getSinkStats(slowUart, &stats);
+    REQUIRE(stats.dropped > frames / 2);
+
+    requireBalanced(router, uart, frames);
+    requireBalanced(router, udp, frames);
+    requireBalanced(router, tcp, frames);
+    requireBalanced(router, stalled, frames);
+    requireBalanced(router, slowUart, frames);
+    REQUIRE(uartRx.clean());
+    REQUIRE(tcpRx.clean());
+}
+
+TEST_CASE("OutputRouter - An exhausted pool takes frames from the largest backlog", "[OutputRouter]") {
+    OutputRouter router;
+    REQUIRE(router.init(6, FRAME_SIZE, 4, MAX_DEPTH));
+    int fast = router.addSink(UART_DEPTH);
+    int a = router.addSink(TCP_DEPTH);
+    int b = router.addSink(TCP_DEPTH);
+    int c = router.addSink(3);
+    StreamReceiver fastRx, aRx;
+
+    // a is half way through a frame; b and c never read
+    Bytes first = makeFrame(1);
+    router.route(first.data(), first.size());
+    drain(router, a, aRx, first.size() / 2);
+    drain(router, fast, fastRx, 100000);
+
+    const uint32_t frames = 100;
+    for (uint32_t i = 2; i <= frames; i++) {
+        Bytes frame = makeFrame(i);
+        REQUIRE(router.route(frame.data(), frame.size()) == 4);
+        REQUIRE(router.getFramesInUse() <= 6);
+        drain(router, fast, fastRx, 100000);
+    }
+    drain(router, fast, fastRx, 100000);
+    REQUIRE(fastRx.sequences.size() == frames);
+
+    // The stalled sinks share the pool, none holds more than it
+    REQUIRE(router.pendingFrames(a) <= 6);
+    REQUIRE(router.pendingFrames(b) <= 6);
+    REQUIRE(router.pendingFrames(c) <= 3);
+
+    // a still finishes its partly sent frame and then gets recent frames
+    drain(router, a, aRx, 100000);
+    REQUIRE(aRx.clean());
+    REQUIRE(aRx.sequences.front() == 1);
+    REQUIRE(aRx.sequences.back() == frames);
+    REQUIRE(aRx.increasing());
+
+    requireBalanced(router, fast, frames);
+    requireBalanced(router, a, frames);
+    requireBalanced(router, b, frames);
+    requireBalanced(router, c, frames);
+}
+
+TEST_CASE("OutputRouter - Random routing and sending keeps every stream decodable", "[OutputRouter]") {
+    std::mt19937 rng(43);
+    for (int round = 0; round < 20; round++) {
+        OutputRouter router;
+        std::uniform_int_distribution<int> poolSizes(1, 24);
+        size_t poolSize = poolSizes(rng);
+        REQUIRE(router.init(poolSize, FRAME_SIZE, MAX_SINKS, MAX_DEPTH));
+
+        std::uniform_int_distribution<int> depth(1, (int)MAX_DEPTH);
+        std::uniform_int_distribution<int> budget(0, 400);
+        std::uniform_int_distribution<int> percent(0, 99);
+        int ids[MAX_SINKS];
+        StreamReceiver receivers[MAX_SINKS];
+        for (size_t s = 0; s < MAX_SINKS; s++) {
+            ids[s] = router.addSink(depth(rng));
+        }
+
+        uint32_t routed = 0;
+        for (uint32_t i = 1; i <= 2000; i++) {
+            if (percent(rng) < 70) {
+                Bytes frame = makeFrame(i);
+                router.route(frame.data(), frame.size());
+                routed++;
+            }
+            for (size_t s = 0; s < MAX_SINKS; s++) {
+                // Sink s sends on (100 - 10 s) % of the turns, sink 6 is the slowest
+                if (percent(rng) < 100 - 10 * (int)s) {
+                    drain(router, ids[s], receivers[s], budget(rng));
+                }
+            }
+            REQUIRE(router.getFramesInUse() <= poolSize);
+        }
+
+        for (size_t s = 0; s < MAX_SINKS; s++) {
+            requireBalanced(router, ids[s], routed);
+            drain(router, ids[s], receivers[s], 1000000);
+            REQUIRE(receivers[s].clean());
+            REQUIRE(receivers[s].increasing());
+            OutputSinkStats stats;
+            router.getSinkStats(ids[s], &stats);
+            REQUIRE(receivers[s].sequences.size() == stats.frames);
+        }
+        REQUIRE(router.getFramesInUse() == 0);
+    }
+}
+
+// Frames per second through the router (one copy) for a number of sinks
+static double benchmarkRouter(const std::vector<Bytes>& frames, size_t sinkCount, int rounds) {
+    OutputRouter router;
+    router.init(POOL_FRAMES, FRAME_SIZE, sinkCount, MAX_DEPTH);
+    std::vector<int> ids;
+    for (size_t s = 0; s < sinkCount; s++) {
+        ids.push_back(router.addSink(TCP_DEPTH));
+    }
+    static uint8_t wire[4096];
+    size_t checksum = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < frames.size(); i++) {
+            router.route(frames[i].data(), frames[i].size());
+            for (size_t s = 0; s < sinkCount; s++) {
+                const uint8_t* data;
+                size_t length;
+                while (router.peek(ids[s], &data, &length)) {
+                    memcpy(wire, data, length);     // The send
+                    checksum += wire[length / 2];
+                    router.consume(ids[s], length);
+                }
+            }
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    REQUIRE(checksum > 0);
+    return rounds * frames.size() / seconds;
+}
+
+// The same with a private ring of frame copies per sink, for reference
+static double benchmarkCopyPerSink(const std::vector<Bytes>& frames, size_t sinkCount, int rounds) {
+    struct Queue {
+        uint8_t slots[TCP_DEPTH][FRAME_SIZE];
+        size_t lengths[TCP_DEPTH];
+        size_t head;
+        size_t count;
+    };
+    std::vector<Queue> queues(sinkCount);
+    for (size_t s = 0; s < sinkCount; s++) {
+        queues[s].head = 0;
+        queues[s].count = 0;
+    }
+    static uint8_t wire[4096];
+    size_t checksum = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < frames.size(); i++) {
+            for (size_t s = 0; s < sinkCount; s++) {
+                Queue& q = queues[s];
+                size_t tail = (q.head + q.count) % TCP_DEPTH;
+                memcpy(q.slots[tail], frames[i].data(), frames[i].size());
+                q.lengths[tail] = frames[i].size();
+                q.count++;
+            }
+            for (size_t s = 0; s < sinkCount; s++) {
+                Queue& q = queues[s];
+                while (q.count > 0) {
+                    memcpy(wire, q.slots[q.head], q.lengths[q.head]);
+                    checksum += wire[q.lengths[q.head] / 2];
+                    q.head = (q.head + 1) % TCP_DEPTH;
+                    q.count--;
+                }
+            }
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    REQUIRE(checksum > 0);
+    return rounds * frames.size() / seconds;
+}
+
+// Delay of a UDP sink behind a 9600 baud UART at 20 Hz over 60 s: sinks
+// written one after the other with a blocking UART write, or through the router
+static void benchmarkSlowSink(bool blocking, double* meanMs, double* maxMs, size_t* udpFrames, size_t* uartFrames) {
+    const int64_t periodUs = 50000;
+    const int64_t byteUs = 10000000 / 9600;
+    const size_t ring = 2 * FRAME_SIZE;
+    const uint32_t frames = 1200;
+
+    OutputRouter router;
+    router.init(POOL_FRAMES, FRAME_SIZE, 2, MAX_DEPTH);
+    int uart = router.addSink(UART_DEPTH);
+    int udp = router.addSink(UDP_DEPTH);
+    StreamReceiver uartRx, udpRx;
+
+    int64_t now = 0;            // Task time
+    int64_t wireFreeAt = 0;     // Time the UART ring is empty
+    double total = 0;
+    double worst = 0;
+    for (uint32_t i = 1; i <= frames; i++) {
+        int64_t due = (int64_t)i * periodUs;
+        if (now < due) {
+            now = due;
+        }
+        Bytes frame = makeFrame(i);
+        if (blocking) {
+            // uart_write_bytes() waits until the ring has room for the frame
+            int64_t queued = std::max<int64_t>(0, wireFreeAt - now) / byteUs;
+            if (queued + frame.size() > ring) {
+                now = wireFreeAt - (int64_t)(ring - frame.size()) * byteUs;
+            }
+            wireFreeAt = std::max(wireFreeAt, now) + (int64_t)frame.size() * byteUs;
+            uartRx.now = now;
+            uartRx.decoder.feed(frame.data(), frame.size());
+            udpRx.now = now;
+            udpRx.decoder.feed(frame.data(), frame.size());
+        } else {
+            router.route(frame.data(), frame.size());
+            const uint8_t* data;
+            size_t length;
+            while (router.peek(uart, &data, &length) &&
+                   (size_t)(std::max<int64_t>(0, wireFreeAt - now) / byteUs) + length <= ring) {
+                wireFreeAt = std::max(wireFreeAt, now) + (int64_t)length * byteUs;
+                uartRx.decoder.feed(data, length);
+                router.consume(uart, length);
+            }
+            udpRx.now = now;
+            drain(router, udp, udpRx, 100000);
+        }
+        if (!udpRx.arrivals.empty() && udpRx.sequences.back() == i) {
+            double delayMs = (udpRx.arrivals.back() - due) / 1000.0;
+            total += delayMs;
+            worst = std::max(worst, delayMs);
+        }
+        now += 1000;    // Building the frame
+    }
+    *meanMs = udpRx.sequences.empty() ? 0 : total / udpRx.sequences.size();
+    *maxMs = worst;
+    *udpFrames = udpRx.sequences.size();
+    *uartFrames = uartRx.sequences.size();
+}
+
+TEST_CASE("Output router benchmark - frames per second and slow sink delay", "[.benchmark]") {
+    std::vector<Bytes> frames;
+    for (uint32_t i = 1; i <= 1000; i++) {
+        frames.push_back(makeFrame(i));
+    }
+
+    printf("\n%6s %16s %16s %14s %14s\n", "sinks", "router frames/s", "copy frames/s", "router bytes", "copy bytes");
+    const size_t sinkCounts[4] = {1, 3, 7, 16};
+    for (int c = 0; c < 4; c++) {
+        double routed = benchmarkRouter(frames, sinkCounts[c], 500);
+        double copied = benchmarkCopyPerSink(frames, sinkCounts[c], 500);
+        size_t routerBytes = POOL_FRAMES * FRAME_SIZE + sinkCounts[c] * TCP_DEPTH * sizeof(uint16_t);
+        size_t copyBytes = sinkCounts[c] * TCP_DEPTH * FRAME_SIZE;
+        printf("%6u %16.0f %16.0f %14u %14u\n", (unsigned)sinkCounts[c], routed, copied,
+               (unsigned)routerBytes, (unsigned)copyBytes);
+    }
+
+    printf("\nUDP sink behind a 9600 baud UART, 20 Hz for 60 s\n");
+    printf("%-20s %12s %12s %11s %11s\n", "sending", "UDP mean ms", "UDP max ms", "UDP frames", "UART frames");
+    for (int blocking = 1; blocking >= 0; blocking--) {
+        double meanMs;
+        double maxMs;
+        size_t udpFrames;
+        size_t uartFrames;
+        benchmarkSlowSink(blocking != 0, &meanMs, &maxMs, &udpFrames, &uartFrames);
+        printf("%-20s %12.1f %12.1f %11u %11u\n", blocking ? "blocking, in turn" : "router",
+               meanMs, maxMs, (unsigned)udpFrames, (unsigned)uartFrames);
+    }
+}
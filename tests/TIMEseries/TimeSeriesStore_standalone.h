@@ -0,0 +1,162 @@
+/*!
+ * \file TimeSeriesStore.h
+ * \brief Compressed history of integer metrics at a fixed interval.
+ *
+ * Used by the Statistics Task to keep the last hours of fix quality, RTCM
+ * rate, WiFi RSSI, heap and other metrics at one row per minute. A row holds
+ * one signed 32 bit value per metric (scaled integers, e.g. HDOP x100).
+ *
+ * \section timeseries_blocks Blocks
+ * The memory given to init() is split in blocks of a fixed size, used as a
+ * ring: when all blocks are full the oldest block is dropped as a whole, so
+ * the memory use never grows. A block starts with an 8 byte header: the
+ * time of its first row, the number of rows and the bytes used. Rows are at
+ * the store interval from the first one; a row that does not follow the
+ * previous one after exactly one interval starts a new block.
+ *
+ * \section timeseries_encoding Encoding
+ * Values are stored as zigzag varints (LEB128 of (v << 1) ^ (v >> 31)), so
+ * small positive and negative numbers take one byte. The first row of a
+ * block holds every value; each following row holds a mask of the metrics
+ * that changed (one bit per metric) and only their differences to the
+ * previous row. A metric that did not change costs one bit, a metric that
+ * changed by less than 64 one byte. Every block decodes on its own.
+ *
+ * \section timeseries_readers Readers
+ * query() decodes the rows in a time range in place. To read without
+ * blocking the writer for the whole range, a reader copies one block at a
+ * time with copyBlock() under the writer's lock and decodes the copy with
+ * decodeBlock(). Blocks are numbered from 0 at init(); a block dropped
+ * before it was copied is simply missing from the result.
+ *
+ * No ESP-IDF dependencies; the store is plain C++11 and allocates nothing.
+ */
+
+#ifndef TIME_SERIES_STORE_STANDALONE_H
+#define TIME_SERIES_STORE_STANDALONE_H
+
+#include <cstdint>
+#include <stddef.h>
+
+// Most metrics per row
+#define TIMESERIES_MAX_METRICS 32
+
+// Bytes of the block header: first row time, rows, bytes used
+#define TIMESERIES_BLOCK_HEADER 8
+
+/**
+ * \brief Receives the rows of a query, oldest first.
+ * \param[in] time Time of the row.
+ * \param[in] values One value per metric.
+ * \param[in] context Context given to the query.
+ * \return false to stop the query.
+ */
+typedef bool (*TimeSeriesVisitor)(uint32_t time, const int32_t* values, void* context);
+
+class TimeSeriesStore {
+public:
+    TimeSeriesStore();
+
+    /**
+     * \brief Use a memory area for the history and clear it.
+     * \param[in] memory Memory of the blocks, owned by the caller.
+     * \param[in] size Size of the memory; whole blocks are used.
+     * \param[in] blockSize Bytes per block, at least maxBlockRow() plus the header and at most 65535.
+     * \param[in] metrics Values per row (1 to TIMESERIES_MAX_METRICS).
+     * \param[in] interval Time between rows, in the unit of the row times (> 0).
+     * \return true on success, false on invalid parameters or fewer than 2 blocks.
+     */
+    bool init(uint8_t* memory, size_t size, size_t blockSize, uint8_t metrics, uint32_t interval);
+
+    /** \brief Drop all rows. Block numbers continue. */
+    void clear();
+
+    /**
+     * \brief Add a row, dropping the oldest block when the memory is full.
+     * \param[in] time Time of the row, later than the previous row.
+     * \param[in] values One value per metric.
+     * \return false before init() or when time is not later than the newest row.
+     */
+    bool append(uint32_t time, const int32_t* values);
+
+    /**
+     * \brief Decode the rows with from <= time <= to, oldest first.
+     * \param[in] from First time of the range.
+     * \param[in] to Last time of the range.
+     * \param[in] visitor Receives the rows.
+     * \param[in] context Passed to visitor.
+     * \return Number of rows passed to visitor.
+     */
+    size_t query(uint32_t from, uint32_t to, TimeSeriesVisitor visitor, void* context) const;
+
+    /** \brief Number of the oldest block held. */
+    uint32_t getFirstBlock() const { return firstBlock; }
+
+    /** \brief Number of the newest block held plus one; equals getFirstBlock() when empty. */
+    uint32_t getEndBlock() const { return endBlock; }
+
+    /**
+     * \brief Copy a block for decodeBlock(), including the rows added so far when it is the newest.
+     * \param[in] block Block number.
+     * \param[out] out Buffer of getBlockSize() bytes; receives the header and the bytes used.
+     * \return false when the block is not held (dropped or not written yet).
+     */
+    bool copyBlock(uint32_t block, uint8_t* out) const;
+
+    /**
+     * \brief Decode the rows with from <= time <= to of a copied block.
+     * \param[in] block Block as copied by copyBlock().
+     * \param[in] blockSize Block size of the store.
+     * \param[in] metrics Metrics of the store.
+     * \param[in] interval Interval of the store.
+     * \param[in] from First time of the range.
+     * \param[in] to Last time of the range.
+     * \param[in] visitor Receives the rows.
+     * \param[in] context Passed to visitor.
+     * \param[out] stopped Set to true when visitor stopped the query, or NULL.
+     * \return Number of rows passed to visitor.
+     */
+    static size_t decodeBlock(const uint8_t* block, size_t blockSize, uint8_t metrics, uint32_t interval,
+                              uint32_t from, uint32_t to, TimeSeriesVisitor visitor, void* context,
+                              bool* stopped);
+
+    /** \brief Largest encoded row of a store with the given metrics (bytes). */
+    static size_t maxBlockRow(uint8_t metrics) { return (size_t)(metrics + 7) / 8 + (size_t)metrics * 5; }
+
+    /** \brief Rows held. */
+    uint32_t getRows() const { return rows; }
+
+    /** \brief Time of the oldest row; 0 when empty. */
+    uint32_t getOldestTime() const;
+
+    /** \brief Time of the newest row; 0 when empty. */
+    uint32_t getNewestTime() const { return rows > 0 ? newestTime : 0; }
+
+    /** \brief Bytes of the blocks held, headers included. */
+    size_t getUsedBytes() const;
+
+    /** \brief Bytes of memory used for blocks (block count times block size). */
+    size_t getCapacityBytes() const { return (size_t)blockCount * blockSize; }
+
+    size_t getBlockSize() const { return blockSize; }
+    uint32_t getBlockCount() const { return blockCount; }
+    uint8_t getMetrics() const { return metrics; }
+    uint32_t getInterval() const { return interval; }
+
+private:
+    uint8_t* blockAt(uint32_t block) const;
+    void startBlock(uint32_t time);
+
+    uint8_t* memory;
+    size_t blockSize;
+    uint32_t blockCount;
+    uint8_t metrics;
+    uint32_t interval;
+    uint32_t firstBlock;
+    uint32_t endBlock;
+    uint32_t rows;                          // Rows in all blocks held
+    uint32_t newestTime;
+    int32_t previous[TIMESERIES_MAX_METRICS]; // Newest row, the base of the next differences
+};
+
+#endif // TIME_SERIES_STORE_STANDALONE_H
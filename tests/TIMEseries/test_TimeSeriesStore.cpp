@@ -0,0 +1,455 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch.hpp"
+#include "TimeSeriesStore_standalone.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+typedef std::vector<int32_t> Row;
+
+// Rows and times received by a query
+struct Rows {
+    std::vector<uint32_t> times;
+    std::vector<Row> values;
+    uint8_t metrics = 0;
+    size_t stopAfter = (size_t)-1;
+};
+
+static bool collect(uint32_t time, const int32_t* values, void* context) {
+    Rows* rows = (Rows*)context;
+    rows->times.push_back(time);
+    rows->values.push_back(Row(values, values + rows->metrics));
+    return rows->times.size() < rows->stopAfter;
+}
+
+static Rows queryAll(const TimeSeriesStore& store, uint32_t from, uint32_t to) {
+    Rows rows;
+    rows.metrics = store.getMetrics();
+    size_t visited = store.query(from, to, collect, &rows);
+    REQUIRE(visited == rows.times.size());
+    return rows;
+}
+
+// Same query through copied blocks, as the firmware reads the store
+static Rows queryCopied(const TimeSeriesStore& store, uint32_t from, uint32_t to) {
+    Rows rows;
+    rows.metrics = store.getMetrics();
+    std::vector<uint8_t> copy(store.getBlockSize());
+    for (uint32_t block = store.getFirstBlock(); block != store.getEndBlock(); block++) {
+        REQUIRE(store.copyBlock(block, copy.data()));
+        TimeSeriesStore::decodeBlock(copy.data(), copy.size(), store.getMetrics(), store.getInterval(),
+                                     from, to, collect, &rows, NULL);
+    }
+    return rows;
+}
+
+// One minute of a working RTK rover, roughly as the firmware samples it
+struct Rover {
+    std::mt19937 random;
+    int32_t satellites = 20;
+    int32_t hdop = 70;
+    int32_t heapFree = 152000;
+    int32_t heapMin = 148000;
+    int32_t msm[4] = {10, 7, 8, 9};
+    int32_t rssi = -62;
+    int32_t fix = 4;
+
+    explicit Rover(uint32_t seed) : random(seed) {}
+
+    int32_t noise(int32_t spread) {
+        return (int32_t)(random() % (uint32_t)(2 * spread + 1)) - spread;
+    }
+
+    Row next(uint8_t metrics) {
+        Row row;
+        if (random() % 30 == 0) {
+            fix = (fix == 4) ? 5 : 4;
+        }
+        satellites += (random() % 10 == 0) ? noise(1) : 0;
+        hdop = 70 + noise(6);
+        rssi = -62 + noise(3);
+        heapFree = 152000 + noise(800);
+        heapMin -= (random() % 60 == 0) ? 64 : 0;
+        for (int i = 0; i < 4; i++) {
+            msm[i] += (random() % 15 == 0) ? noise(1) : 0;
+        }
+        int32_t fixed = (fix == 4) ? 60 - (int32_t)(random() % 3 == 0) : 0;
+        row.push_back(fix);                         // fix_quality
+        row.push_back(0);                           // no_fix_seconds
+        row.push_back(0);                           // gps_seconds
+        row.push_back(0);                           // dgps_seconds
+        row.push_back(60 - fixed);                  // float_seconds
+        row.push_back(fixed);                       // fixed_seconds
+        row.push_back(fix == 5 ? 1 : 0);            // fix_downgrades
+        row.push_back(fix == 4 ? 1 : 0);            // fix_upgrades
+        row.push_back(satellites);
+        row.push_back(hdop);                        // x100
+        row.push_back(fix == 4 ? hdop / 5 : hdop * 5);   // accuracy mm
+        row.push_back(10 + noise(5));               // correction age x10
+        row.push_back(8412);                        // baseline m
+        row.push_back(61000 + noise(3000));         // RTCM bytes
+        row.push_back(300 + noise(4));              // RTCM messages
+        row.push_back(random() % 200 == 0 ? 1 : 0); // corrupted
+        for (int i = 0; i < 4; i++) {
+            row.push_back(msm[i]);
+        }
+        row.push_back(random() % 2);                // GGA sent
+        row.push_back(0);                           // GGA failures
+        row.push_back(60);                          // NTRIP connected seconds
+        row.push_back(rssi);
+        row.push_back(60);                          // WiFi connected seconds
+        row.push_back(heapFree);
+        row.push_back(heapFree - 40000 + noise(2000)); // largest block
+        row.push_back(heapMin);
+        row.push_back(120 + noise(20));             // core 0 load x10
+        row.push_back(80 + noise(15));              // core 1 load x10
+        row.resize(metrics);
+        return row;
+    }
+};
+
+TEST_CASE("Time series store - init", "[timeseries]") {
+    std::vector<uint8_t> memory(4096);
+    TimeSeriesStore store;
+    int32_t values[1] = {1};
+
+    SECTION("Not initialized") {
+        REQUIRE_FALSE(store.append(60, values));
+        REQUIRE(queryAll(store, 0, 0xFFFFFFFFu).times.empty());
+        REQUIRE(store.getRows() == 0);
+        REQUIRE(store.getUsedBytes() == 0);
+        REQUIRE(store.getCapacityBytes() == 0);
+    }
+
+    SECTION("Invalid parameters") {
+        REQUIRE_FALSE(store.init(NULL, memory.size(), 256, 8, 60));
+        REQUIRE_FALSE(store.init(memory.data(), memory.size(), 256, 0, 60));
+        REQUIRE_FALSE(store.init(memory.data(), memory.size(), 256, TIMESERIES_MAX_METRICS + 1, 60));
+        REQUIRE_FALSE(store.init(memory.data(), memory.size(), 256, 8, 0));
+        // Block smaller than the header and the largest row
+        REQUIRE_FALSE(store.init(memory.data(), memory.size(), TIMESERIES_BLOCK_HEADER + TimeSeriesStore::maxBlockRow(8) - 1, 8, 60));
+        REQUIRE(store.init(memory.data(), memory.size(), TIMESERIES_BLOCK_HEADER + TimeSeriesStore::maxBlockRow(8), 8, 60));
+        // At least two blocks
+        REQUIRE_FALSE(store.init(memory.data(), 511, 256, 8, 60));
+        REQUIRE_FALSE(store.init(memory.data(), memory.size(), 0x10000, 8, 60));
+        REQUIRE_FALSE(store.append(60, values));
+    }
+
+    SECTION("Whole blocks of the memory") {
+        REQUIRE(store.init(memory.data(), 1000, 256, 8, 60));
+        REQUIRE(store.getBlockCount() == 3);
+        REQUIRE(store.getCapacityBytes() == 768);
+        REQUIRE(store.getMetrics() == 8);
+        REQUIRE(store.getInterval() == 60);
+        REQUIRE(TimeSeriesStore::maxBlockRow(8) == 41);
+        REQUIRE(TimeSeriesStore::maxBlockRow(32) == 164);
+    }
+}
+
+TEST_CASE("Time series store - round trip", "[timeseries]") {
+    std::vector<uint8_t> memory(64 * 1024);
+    TimeSeriesStore store;
+    const uint8_t metrics = 9;
+    REQUIRE(store.init(memory.data(), memory.size(), 1024, metrics, 60));
+
+    SECTION("Extreme values and differences") {
+        const int32_t extremes[] = {0, 1, -1, 63, -64, 64, -65, 8191, -8192, INT32_MAX, INT32_MIN, INT32_MAX - 1, INT32_MIN + 1};
+        const size_t count = sizeof(extremes) / sizeof(extremes[0]);
+        std::vector<Row> written;
+        for (size_t r = 0; r < count * 3; r++) {
+            Row row(metrics);
+            for (uint8_t m = 0; m < metrics; m++) {
+                row[m] = extremes[(r * (m + 1) + m) % count];
+            }
+            REQUIRE(store.append((uint32_t)(60 * (r + 1)), row.data()));
+            written.push_back(row);
+        }
+        Rows rows = queryAll(store, 0, 0xFFFFFFFFu);
+        REQUIRE(rows.values == written);
+        REQUIRE(rows.times.front() == 60);
+        REQUIRE(rows.times.back() == 60 * written.size());
+        REQUIRE(store.getRows() == written.size());
+    }
+
+    SECTION("Random rows over many blocks") {
+        std::mt19937 random(7);
+        std::vector<Row> written;
+        for (uint32_t r = 0; r < 800; r++) {
+            Row row(metrics);
+            for (uint8_t m = 0; m < metrics; m++) {
+                // Mostly small changes, some unchanged, some large
+                int32_t previous = written.empty() ? 0 : written.back()[m];
+                switch (random() % 4) {
+                    case 0: row[m] = previous; break;
+                    case 1: row[m] = previous + (int32_t)(random() % 200) - 100; break;
+                    case 2: row[m] = (int32_t)random(); break;
+                    default: row[m] = previous - 1; break;
+                }
+            }
+            REQUIRE(store.append(1000 + 60 * r, row.data()));
+            written.push_back(row);
+        }
+        REQUIRE(store.getEndBlock() - store.getFirstBlock() > 10);
+        Rows rows = queryAll(store, 0, 0xFFFFFFFFu);
+        REQUIRE(rows.values == written);
+        REQUIRE(queryCopied(store, 0, 0xFFFFFFFFu).values == written);
+        REQUIRE(store.getOldestTime() == 1000);
+        REQUIRE(store.getNewestTime() == 1000 + 60 * 799);
+    }
+
+    SECTION("Unchanged rows take the mask only") {
+        Row row(metrics, 1000);
+        REQUIRE(store.append(60, row.data()));
+        size_t first = store.getUsedBytes();
+        REQUIRE(first == TIMESERIES_BLOCK_HEADER + metrics * 2);
+        for (uint32_t r = 2; r <= 100; r++) {
+            REQUIRE(store.append(60 * r, row.data()));
+        }
+        REQUIRE(store.getUsedBytes() == first + 99 * 2);
+        // One changed metric by less than 64: mask and one byte
+        row[3] += 63;
+        REQUIRE(store.append(60 * 101, row.data()));
+        REQUIRE(store.getUsedBytes() == first + 99 * 2 + 3);
+    }
+}
+
+TEST_CASE("Time series store - times", "[timeseries]") {
+    std::vector<uint8_t> memory(8 * 1024);
+    TimeSeriesStore store;
+    REQUIRE(store.init(memory.data(), memory.size(), 512, 4, 60));
+    Row row = {1, 2, 3, 4};
+
+    SECTION("Rows must be later than the newest row") {
+        REQUIRE(store.append(120, row.data()));
+        REQUIRE_FALSE(store.append(120, row.data()));
+        REQUIRE_FALSE(store.append(60, row.data()));
+        REQUIRE(store.append(121, row.data()));
+        REQUIRE(store.getRows() == 2);
+    }
+
+    SECTION("A gap starts a new block") {
+        for (uint32_t t = 60; t <= 600; t += 60) {
+            REQUIRE(store.append(t, row.data()));
+        }
+        REQUIRE(store.getEndBlock() - store.getFirstBlock() == 1);
+        // Missed two rows, then a row off the minute
+        REQUIRE(store.append(780, row.data()));
+        REQUIRE(store.append(845, row.data()));
+        REQUIRE(store.append(905, row.data()));
+        REQUIRE(store.getEndBlock() - store.getFirstBlock() == 3);
+        Rows rows = queryAll(store, 0, 0xFFFFFFFFu);
+        std::vector<uint32_t> expected = {60, 120, 180, 240, 300, 360, 420, 480, 540, 600, 780, 845, 905};
+        REQUIRE(rows.times == expected);
+    }
+
+    SECTION("Range queries") {
+        REQUIRE(store.init(memory.data(), memory.size(), 128, 4, 60));
+        for (uint32_t t = 60; t <= 60 * 200; t += 60) {
+            row[0] = (int32_t)t;
+            REQUIRE(store.append(t, row.data()));
+        }
+        REQUIRE(store.getEndBlock() - store.getFirstBlock() > 2);
+        // Inclusive bounds, between rows and outside the store
+        Rows rows = queryAll(store, 600, 1200);
+        REQUIRE(rows.times.size() == 11);
+        REQUIRE(rows.times.front() == 600);
+        REQUIRE(rows.times.back() == 1200);
+        REQUIRE(rows.values.front()[0] == 600);
+        REQUIRE(queryAll(store, 601, 659).times.empty());
+        REQUIRE(queryAll(store, 601, 660).times.size() == 1);
+        REQUIRE(queryAll(store, 0, 59).times.empty());
+        REQUIRE(queryAll(store, 60 * 201, 0xFFFFFFFFu).times.empty());
+        REQUIRE(queryAll(store, 1200, 600).times.empty());
+        REQUIRE(queryAll(store, 0, 0xFFFFFFFFu).times.size() == 200);
+        // Every range equals the rows filtered from a full query
+        for (uint32_t from = 0; from < 60 * 202; from += 97) {
+            for (uint32_t to = from; to < 60 * 202; to += 389) {
+                Rows part = queryAll(store, from, to);
+                Rows copied = queryCopied(store, from, to);
+                size_t expected = 0;
+                for (uint32_t t = 60; t <= 60 * 200; t += 60) {
+                    expected += (t >= from && t <= to);
+                }
+                REQUIRE(part.times.size() == expected);
+                REQUIRE(copied.times == part.times);
+                REQUIRE(copied.values == part.values);
+            }
+        }
+    }
+
+    SECTION("The visitor stops the query") {
+        for (uint32_t t = 60; t <= 60 * 200; t += 60) {
+            REQUIRE(store.append(t, row.data()));
+        }
+        Rows rows;
+        rows.metrics = 4;
+        rows.stopAfter = 150;
+        REQUIRE(store.query(0, 0xFFFFFFFFu, collect, &rows) == 150);
+        REQUIRE(rows.times.back() == 60 * 150);
+
+        Rows copied;
+        copied.metrics = 4;
+        copied.stopAfter = 1;
+        std::vector<uint8_t> copy(store.getBlockSize());
+        REQUIRE(store.copyBlock(store.getFirstBlock(), copy.data()));
+        bool stopped = false;
+        REQUIRE(TimeSeriesStore::decodeBlock(copy.data(), copy.size(), 4, 60, 0, 0xFFFFFFFFu, collect, &copied, &stopped) == 1);
+        REQUIRE(stopped);
+    }
+}
+
+TEST_CASE("Time series store - bounded memory", "[timeseries]") {
+    std::vector<uint8_t> memory(8 * 1024 + 16, 0xA5);
+    TimeSeriesStore store;
+    const uint8_t metrics = 30;
+    REQUIRE(store.init(memory.data(), 8 * 1024, 1024, metrics, 60));
+    Rover rover(1);
+
+    SECTION("The oldest block is dropped when full") {
+        std::vector<Row> written;
+        for (uint32_t r = 0; r < 5000; r++) {
+            written.push_back(rover.next(metrics));
+            REQUIRE(store.append(60 * (r + 1), written.back().data()));
+            REQUIRE(store.getUsedBytes() <= store.getCapacityBytes());
+            REQUIRE(store.getEndBlock() - store.getFirstBlock() <= store.getBlockCount());
+        }
+        // Nothing written after the blocks
+        for (size_t i = 8 * 1024; i < memory.size(); i++) {
+            REQUIRE(memory[i] == 0xA5);
+        }
+        REQUIRE(store.getEndBlock() - store.getFirstBlock() == 8);
+        REQUIRE(store.getFirstBlock() > 0);
+        // The newest rows are held without gaps
+        Rows rows = queryAll(store, 0, 0xFFFFFFFFu);
+        REQUIRE(rows.times.size() == store.getRows());
+        REQUIRE(rows.times.front() == store.getOldestTime());
+        REQUIRE(rows.times.back() == 60 * 5000);
+        for (size_t i = 0; i < rows.times.size(); i++) {
+            uint32_t t = rows.times[i];
+            REQUIRE(t == store.getOldestTime() + 60 * i);
+            REQUIRE(rows.values[i] == written[t / 60 - 1]);
+        }
+    }
+
+    SECTION("Dropped blocks cannot be copied") {
+        std::vector<uint8_t> copy(store.getBlockSize());
+        REQUIRE_FALSE(store.copyBlock(0, copy.data()));
+        for (uint32_t r = 0; r < 3000; r++) {
+            Row row = rover.next(metrics);
+            REQUIRE(store.append(60 * (r + 1), row.data()));
+        }
+        REQUIRE_FALSE(store.copyBlock(store.getFirstBlock() - 1, copy.data()));
+        REQUIRE(store.copyBlock(store.getFirstBlock(), copy.data()));
+        REQUIRE(store.copyBlock(store.getEndBlock() - 1, copy.data()));
+        REQUIRE_FALSE(store.copyBlock(store.getEndBlock(), copy.data()));
+    }
+
+    SECTION("Clear drops all rows, block numbers continue") {
+        for (uint32_t r = 0; r < 100; r++) {
+            Row row = rover.next(metrics);
+            REQUIRE(store.append(60 * (r + 1), row.data()));
+        }
+        uint32_t end = store.getEndBlock();
+        store.clear();
+        REQUIRE(store.getRows() == 0);
+        REQUIRE(store.getUsedBytes() == 0);
+        REQUIRE(store.getOldestTime() == 0);
+        REQUIRE(store.getNewestTime() == 0);
+        REQUIRE(queryAll(store, 0, 0xFFFFFFFFu).times.empty());
+        // Earlier times are accepted again
+        Row row = rover.next(metrics);
+        REQUIRE(store.append(60, row.data()));
+        REQUIRE(store.getFirstBlock() == end);
+        REQUIRE(queryAll(store, 0, 0xFFFFFFFFu).values.front() == row);
+    }
+}
+
+TEST_CASE("Time series store - damaged blocks", "[timeseries]") {
+    std::vector<uint8_t> memory(4096);
+    TimeSeriesStore store;
+    REQUIRE(store.init(memory.data(), memory.size(), 1024, 14, 60));
+    Rover rover(3);
+    for (uint32_t r = 0; r < 40; r++) {
+        Row row = rover.next(14);
+        REQUIRE(store.append(60 * (r + 1), row.data()));
+    }
+    std::vector<uint8_t> copy(store.getBlockSize());
+    REQUIRE(store.copyBlock(store.getFirstBlock(), copy.data()));
+    uint16_t used = (uint16_t)(copy[6] | (copy[7] << 8));
+    Rows rows;
+    rows.metrics = 14;
+
+    SECTION("Bytes used beyond the block") {
+        copy[6] = 0xFF;
+        copy[7] = 0xFF;
+        REQUIRE(TimeSeriesStore::decodeBlock(copy.data(), copy.size(), 14, 60, 0, 0xFFFFFFFFu, collect, &rows, NULL) == 0);
+    }
+
+    SECTION("More rows than bytes") {
+        copy[4] = 0xFF;
+        copy[5] = 0xFF;
+        // Decodes the rows present and stops at the end of the bytes used
+        size_t visited = TimeSeriesStore::decodeBlock(copy.data(), copy.size(), 14, 60, 0, 0xFFFFFFFFu, collect, &rows, NULL);
+        REQUIRE(visited == 40);
+    }
+
+    SECTION("Truncated varint") {
+        // A continuation bit on the last byte must not read past the bytes used
+        for (size_t i = TIMESERIES_BLOCK_HEADER + used; i < copy.size(); i++) {
+            copy[i] = 0xFF;
+        }
+        copy[TIMESERIES_BLOCK_HEADER + used - 1] |= 0x80;
+        size_t visited = TimeSeriesStore::decodeBlock(copy.data(), copy.size(), 14, 60, 0, 0xFFFFFFFFu, collect, &rows, NULL);
+        REQUIRE(visited == 39);
+    }
+}
+
+TEST_CASE("Time series benchmark - 24 hours of 30 metrics", "[.benchmark]") {
+    const uint8_t metrics = 30;
+    const uint32_t day = 24 * 60;
+    const size_t rawRow = metrics * sizeof(int32_t);
+
+    printf("\n%u rows of %u metrics (1 day at 1 minute), raw %zu bytes per row\n", day, metrics, rawRow);
+    printf("%-7s %9s %8s %9s %14s %14s %12s\n", "block", "bytes/row", "ratio", "append us", "hours in 32KB",
+           "hours in 256KB", "day query us");
+
+    static const size_t blockSizes[4] = {512, 1024, 2048, 4096};
+    for (size_t b = 0; b < 4; b++) {
+        // Large enough for the day
+        std::vector<uint8_t> memory(512 * 1024);
+        TimeSeriesStore store;
+        REQUIRE(store.init(memory.data(), memory.size(), blockSizes[b], metrics, 60));
+        Rover rover(11);
+        std::vector<Row> rows;
+        for (uint32_t r = 0; r < day; r++) {
+            rows.push_back(rover.next(metrics));
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t r = 0; r < day; r++) {
+            store.append(60 * (r + 1), rows[r].data());
+        }
+        double appendUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / day;
+        REQUIRE(store.getRows() == day);
+
+        // Whole blocks, including the unused end of each block
+        double perRow = (double)(store.getEndBlock() - store.getFirstBlock()) * blockSizes[b] / day;
+
+        const int queries = 200;
+        Rows sink;
+        sink.metrics = metrics;
+        start = std::chrono::steady_clock::now();
+        for (int q = 0; q < queries; q++) {
+            sink.times.clear();
+            sink.values.clear();
+            store.query(0, 0xFFFFFFFFu, collect, &sink);
+        }
+        double queryUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / queries;
+        REQUIRE(sink.values == rows);
+
+        printf("%-7zu %9.1f %7.1fx %9.2f %14.1f %14.1f %12.0f\n", blockSizes[b], perRow, rawRow / perRow,
+               appendUs, 32 * 1024 / perRow / 60, 256 * 1024 / perRow / 60, queryUs);
+    }
+}
@@ -0,0 +1,155 @@
+#include <cstdint>
+#include <stddef.h>
+#include <stdio.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ChromeTrace.h"
+#include "TraceDump_standalone.h"
+
+// Thread of the records without a task number (run-time trace facility off)
+#define CHROME_TRACE_CORE_TID 100000
+
+struct ChromeRecord {
+    uint64_t timeUs;
+    size_t order;           // Position in the download, keeps equal times stable
+    TraceRecord record;
+    uint8_t core;
+};
+
+static bool earlier(const ChromeRecord& a, const ChromeRecord& b) {
+    return a.timeUs != b.timeUs ? a.timeUs < b.timeUs : a.order < b.order;
+}
+
+static void appendEscaped(std::string* json, const char* text) {
+    json->push_back('"');
+    for (const char* c = text; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\') {
+            json->push_back('\\');
+            json->push_back(*c);
+        } else if ((unsigned char)*c < 0x20) {
+            char escape[8];
+            snprintf(escape, sizeof(escape), "\\u%04x", (unsigned char)*c);
+            json->append(escape);
+        } else {
+            json->push_back(*c);
+        }
+    }
+    json->push_back('"');
+}
+
+bool chromeTraceConvert(const uint8_t* data, size_t length, std::string* json, ChromeTraceInfo* info) {
+    TraceDump dump;
+    if (json == NULL || !dump.parse(data, length)) {
+        return false;
+    }
+
+    std::vector<ChromeRecord> records(dump.getRecordCount());
+    for (size_t i = 0; i < records.size(); i++) {
+        records[i].timeUs = dump.getRecord(i, &records[i].record, &records[i].core);
+        records[i].order = i;
+    }
+    std::stable_sort(records.begin(), records.end(), earlier);
+
+    // Event names
+    std::vector<std::string> eventNames(dump.getEventCount());
+    std::vector<std::string> argNames(dump.getEventCount());
+    for (size_t i = 0; i < dump.getEventCount(); i++) {
+        char name[TRACE_DUMP_NAME_SIZE];
+        char argName[TRACE_DUMP_NAME_SIZE];
+        dump.getEvent(i, name, argName);
+        eventNames[i] = name;
+        argNames[i] = argName[0] != '\0' ? argName : "arg";
+    }
+
+    // Thread names of the tasks with records
+    std::map<uint32_t, std::string> taskNames;
+    for (size_t i = 0; i < dump.getTaskCount(); i++) {
+        char name[TRACE_DUMP_NAME_SIZE];
+        uint32_t number = dump.getTask(i, name);
+        taskNames[number] = name;
+    }
+    std::map<uint32_t, std::string> threads;
+    for (const ChromeRecord& r : records) {
+        uint32_t tid = r.record.task != 0 ? r.record.task : CHROME_TRACE_CORE_TID + r.core;
+        if (threads.count(tid) != 0) {
+            continue;
+        }
+        char fallback[32];
+        if (r.record.task == 0) {
+            snprintf(fallback, sizeof(fallback), "core %u", (unsigned)r.core);
+            threads[tid] = fallback;
+        } else if (taskNames.count(tid) != 0) {
+            threads[tid] = taskNames[tid];
+        } else {
+            snprintf(fallback, sizeof(fallback), "task %u", (unsigned)tid);
+            threads[tid] = fallback;
+        }
+    }
+
+    char number[96];
+    json->clear();
+    json->reserve(128 + records.size() * 110);
+    snprintf(number, sizeof(number), "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"dump_us\":%llu,\"skipped\":%lu},",
+             (unsigned long long)dump.getNowUs(), (unsigned long)dump.getSkipped());
+    json->append(number);
+    json->append("\"traceEvents\":[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"NTRIP client\"}}");
+    for (const auto& thread : threads) {
+        snprintf(number, sizeof(number), ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%lu,\"args\":{\"name\":",
+                 (unsigned long)thread.first);
+        json->append(number);
+        appendEscaped(json, thread.second.c_str());
+        json->append("}}");
+    }
+
+    // Begins still open per thread, to pair the ends
+    std::map<uint32_t, std::vector<uint8_t> > open;
+    size_t events = 0;
+    size_t droppedEnds = 0;
+    for (const ChromeRecord& r : records) {
+        uint32_t tid = r.record.task != 0 ? r.record.task : CHROME_TRACE_CORE_TID + r.core;
+        const char* phase = "i";
+        if (r.record.phase == TRACE_PHASE_BEGIN) {
+            phase = "B";
+            open[tid].push_back(r.record.event);
+        } else if (r.record.phase == TRACE_PHASE_END) {
+            std::vector<uint8_t>& begins = open[tid];
+            if (begins.empty() || begins.back() != r.record.event) {
+                droppedEnds++;
+                continue;
+            }
+            begins.pop_back();
+            phase = "E";
+        }
+        char unknown[16];
+        const char* name = unknown;
+        const char* argName = "arg";
+        if (r.record.event < eventNames.size()) {
+            name = eventNames[r.record.event].c_str();
+            argName = argNames[r.record.event].c_str();
+        } else {
+            snprintf(unknown, sizeof(unknown), "event %u", (unsigned)r.record.event);
+        }
+        json->append(",\n{\"name\":");
+        appendEscaped(json, name);
+        snprintf(number, sizeof(number), ",\"ph\":\"%s\",%s\"ts\":%llu,\"pid\":1,\"tid\":%lu,\"args\":{",
+                 phase, r.record.phase == TRACE_PHASE_INSTANT ? "\"s\":\"t\"," : "",
+                 (unsigned long long)r.timeUs, (unsigned long)tid);
+        json->append(number);
+        appendEscaped(json, argName);
+        snprintf(number, sizeof(number), ":%lu,\"core\":%u}}", (unsigned long)r.record.arg, (unsigned)r.core);
+        json->append(number);
+        events++;
+    }
+    json->append("\n]}\n");
+
+    if (info != NULL) {
+        info->events = events;
+        info->threads = threads.size();
+        info->droppedEnds = droppedEnds;
+        info->skipped = dump.getSkipped();
+    }
+    return true;
+}
@@ -0,0 +1,46 @@
+/*!
+ * \file ChromeTrace.h
+ * \brief Host side converter of trace downloads to Chrome trace JSON.
+ *
+ * Converts a download of GET /api/trace (lib/TraceDump format) into the
+ * JSON object format of the Chrome trace event profiler, which
+ * chrome://tracing and ui.perfetto.dev open. Every FreeRTOS task is a
+ * thread named after the task; the records become instant events ("i") or
+ * begin and end events ("B", "E") with the time in microseconds since boot
+ * and the argument and core in args.
+ *
+ * Records of both cores are merged in time order. An end without its begin
+ * (the begin was overwritten in the ring) is dropped; a begin without its
+ * end stays open to the end of the trace.
+ *
+ * Plain C++11 without dependencies.
+ */
+
+#ifndef CHROME_TRACE_H
+#define CHROME_TRACE_H
+
+#include <cstdint>
+#include <stddef.h>
+#include <string>
+
+/**
+ * \brief Counts of one conversion.
+ */
+struct ChromeTraceInfo {
+    size_t events;          // Trace events written, without the thread names
+    size_t threads;         // Tasks with records
+    size_t droppedEnds;     // End records without their begin
+    uint32_t skipped;       // Records the firmware left out of the download
+};
+
+/**
+ * \brief Convert a trace download.
+ * \param[in] data Download.
+ * \param[in] length Size of the download.
+ * \param[out] json Receives the Chrome trace JSON.
+ * \param[out] info Receives the counts (optional).
+ * \return false when the download is malformed.
+ */
+bool chromeTraceConvert(const uint8_t* data, size_t length, std::string* json, ChromeTraceInfo* info);
+
+#endif // CHROME_TRACE_H
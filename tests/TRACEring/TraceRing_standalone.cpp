@@ -0,0 +1,94 @@
+// Standalone build for trace ring tests using Code::Blocks
+// This file contains a copy of the TraceRing implementation for standalone compilation
+
+#include <atomic>
+#include <cstdint>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "TraceRing_standalone.h"
+
+TraceRing::TraceRing()
+    : slots(NULL),
+      capacity(0) {
+    head.store(0, std::memory_order_relaxed);
+}
+
+TraceRing::~TraceRing() {
+    deinit();
+}
+
+bool TraceRing::init(size_t size) {
+    deinit();
+
+    // A power of two, so the slot follows from the low bits of the index
+    if (size == 0 || (size & (size - 1)) != 0 || size > 0x80000000u) {
+        return false;
+    }
+    slots = (Slot*)calloc(size, sizeof(Slot));
+    if (slots == NULL) {
+        return false;
+    }
+    for (size_t i = 0; i < size; i++) {
+        slots[i].sequence.store(0, std::memory_order_relaxed);
+    }
+    capacity = size;
+    head.store(0, std::memory_order_release);
+    return true;
+}
+
+void TraceRing::deinit() {
+    free(slots);
+    slots = NULL;
+    capacity = 0;
+    head.store(0, std::memory_order_relaxed);
+}
+
+void TraceRing::record(uint32_t timeUs, uint8_t event, uint8_t phase, uint16_t task, uint32_t arg) {
+    if (slots == NULL) {
+        return;
+    }
+    uint32_t index = head.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots[index & (capacity - 1)];
+    slot.sequence.store(0, std::memory_order_relaxed);
+    // The cleared sequence must be visible before any field changes
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.timeUs.store(timeUs, std::memory_order_relaxed);
+    slot.arg.store(arg, std::memory_order_relaxed);
+    slot.info.store(((uint32_t)task << 16) | ((uint32_t)event << 8) | phase, std::memory_order_relaxed);
+    // Release: the fields are visible before the sequence that publishes them
+    slot.sequence.store(index + 1, std::memory_order_release);
+}
+
+size_t TraceRing::snapshot(TraceRecord* records, size_t maxRecords) const {
+    if (slots == NULL || records == NULL || maxRecords == 0) {
+        return 0;
+    }
+    uint32_t end = head.load(std::memory_order_acquire);
+    size_t span = capacity < maxRecords ? capacity : maxRecords;
+    // Slots never written have sequence 0 and are skipped, also before the first lap
+    uint32_t start = end - (uint32_t)span;
+    size_t copied = 0;
+    for (uint32_t index = start; index != end; index++) {
+        const Slot& slot = slots[index & (capacity - 1)];
+        uint32_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before == 0 || before != index + 1) {
+            // Never written, still being written or already overwritten by a newer record
+            continue;
+        }
+        TraceRecord& record = records[copied];
+        record.timeUs = slot.timeUs.load(std::memory_order_relaxed);
+        record.arg = slot.arg.load(std::memory_order_relaxed);
+        uint32_t info = slot.info.load(std::memory_order_relaxed);
+        // The field loads complete before the sequence is checked again
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != before) {
+            continue;
+        }
+        record.task = (uint16_t)(info >> 16);
+        record.event = (uint8_t)(info >> 8);
+        record.phase = (uint8_t)info;
+        copied++;
+    }
+    return copied;
+}
@@ -0,0 +1,433 @@
+#define CATCH_CONFIG_MAIN
+#include "../catch2/catch.hpp"
+#include "TraceRing_standalone.h"
+#include "TraceDump_standalone.h"
+#include "ChromeTrace.h"
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Dump of rings per core as the firmware writes it
+static std::vector<uint8_t> makeDump(uint64_t nowUs, const std::vector<std::vector<TraceRecord> >& cores,
+                                     const std::vector<std::pair<uint32_t, const char*> >& tasks,
+                                     uint32_t skipped = 0) {
+    static const char* const events[3][2] = {{"uart_rx", "bytes"}, {"frame_tx", "bytes"}, {"mqtt_publish", ""}};
+    size_t records = 0;
+    for (const auto& core : cores) {
+        records += core.size();
+    }
+    std::vector<uint8_t> dump(TRACE_DUMP_HEADER_SIZE + 3 * TRACE_DUMP_EVENT_SIZE +
+                              tasks.size() * TRACE_DUMP_TASK_SIZE + records * TRACE_DUMP_RECORD_SIZE);
+    uint8_t* p = dump.data();
+    p += TraceDump::encodeHeader(p, nowUs, 3, (uint16_t)tasks.size(), (uint32_t)records, skipped);
+    for (int i = 0; i < 3; i++) {
+        p += TraceDump::encodeEvent(p, events[i][0], events[i][1]);
+    }
+    for (const auto& task : tasks) {
+        p += TraceDump::encodeTask(p, task.first, task.second);
+    }
+    for (size_t core = 0; core < cores.size(); core++) {
+        for (const TraceRecord& record : cores[core]) {
+            p += TraceDump::encodeRecord(p, record, (uint8_t)core);
+        }
+    }
+    return dump;
+}
+
+static TraceRecord makeRecord(uint32_t timeUs, uint8_t event, uint8_t phase, uint16_t task, uint32_t arg) {
+    TraceRecord record = {timeUs, arg, task, event, phase};
+    return record;
+}
+
+static size_t countOf(const std::string& text, const std::string& part) {
+    size_t count = 0;
+    for (size_t at = text.find(part); at != std::string::npos; at = text.find(part, at + 1)) {
+        count++;
+    }
+    return count;
+}
+
+TEST_CASE("TraceRing - Recording and snapshots", "[TraceRing]") {
+    TraceRing ring;
+    TraceRecord records[64];
+
+    SECTION("Capacity must be a power of two") {
+        REQUIRE_FALSE(ring.init(0));
+        REQUIRE_FALSE(ring.init(100));
+        REQUIRE(ring.getCapacity() == 0);
+        REQUIRE(ring.init(16));
+        REQUIRE(ring.getCapacity() == 16);
+        REQUIRE(ring.init(1));
+    }
+
+    SECTION("Records before init are ignored") {
+        ring.record(1, 2, TRACE_PHASE_INSTANT, 3, 4);
+        REQUIRE(ring.getWritten() == 0);
+        REQUIRE(ring.snapshot(records, 64) == 0);
+    }
+
+    SECTION("Fields read back in order") {
+        REQUIRE(ring.init(16));
+        REQUIRE(ring.snapshot(records, 64) == 0);
+        ring.record(1000, 0, TRACE_PHASE_INSTANT, 7, 128);
+        ring.record(1010, 5, TRACE_PHASE_BEGIN, 65535, 0xFFFFFFFF);
+        ring.record(1020, 255, TRACE_PHASE_END, 1, 0);
+        REQUIRE(ring.getWritten() == 3);
+        REQUIRE(ring.snapshot(records, 64) == 3);
+        REQUIRE(records[0].timeUs == 1000);
+        REQUIRE(records[0].event == 0);
+        REQUIRE(records[0].phase == TRACE_PHASE_INSTANT);
+        REQUIRE(records[0].task == 7);
+        REQUIRE(records[0].arg == 128);
+        REQUIRE(records[1].event == 5);
+        REQUIRE(records[1].phase == TRACE_PHASE_BEGIN);
+        REQUIRE(records[1].task == 65535);
+        REQUIRE(records[1].arg == 0xFFFFFFFF);
+        REQUIRE(records[2].event == 255);
+        REQUIRE(records[2].phase == TRACE_PHASE_END);
+    }
+
+    SECTION("A full ring keeps the newest records") {
+        REQUIRE(ring.init(16));
+        for (uint32_t i = 0; i < 100; i++) {
+            ring.record(i, 0, TRACE_PHASE_INSTANT, 1, i);
+        }
+        REQUIRE(ring.getWritten() == 100);
+        REQUIRE(ring.snapshot(records, 64) == 16);
+        for (uint32_t i = 0; i < 16; i++) {
+            REQUIRE(records[i].arg == 84 + i);
+        }
+        // A smaller buffer gets the newest records
+        REQUIRE(ring.snapshot(records, 4) == 4);
+        REQUIRE(records[0].arg == 96);
+        REQUIRE(records[3].arg == 99);
+    }
+
+    SECTION("Deinit and init start empty") {
+        REQUIRE(ring.init(16));
+        ring.record(1, 0, TRACE_PHASE_INSTANT, 1, 1);
+        REQUIRE(ring.init(32));
+        REQUIRE(ring.getWritten() == 0);
+        REQUIRE(ring.snapshot(records, 64) == 0);
+        ring.deinit();
+        ring.record(1, 0, TRACE_PHASE_INSTANT, 1, 1);
+        REQUIRE(ring.snapshot(records, 64) == 0);
+    }
+}
+
+TEST_CASE("TraceRing - Tasks record while the server takes snapshots", "[TraceRing]") {
+    // Four writers on one ring: every record is self-checking, so a torn
+    // record or one read twice shows
+    const int writers = 4;
+    const uint32_t perWriter = 300000;
+    TraceRing ring;
+    REQUIRE(ring.init(256));
+    std::atomic<int> running(writers);
+
+    std::vector<std::thread> threads;
+    for (int w = 0; w < writers; w++) {
+        threads.push_back(std::thread([&ring, &running, w, perWriter]() {
+            for (uint32_t i = 1; i <= perWriter; i++) {
+                ring.record(i * 7u, (uint8_t)i, (uint8_t)(i % 3), (uint16_t)(w + 1), i);
+            }
+            running--;
+        }));
+    }
+
+    std::vector<TraceRecord> records(256);
+    uint64_t snapshots = 0;
+    uint64_t copied = 0;
+    uint64_t bad = 0;
+    uint64_t outOfOrder = 0;
+    while (running.load() > 0) {
+        size_t n = ring.snapshot(records.data(), records.size());
+        uint32_t last[writers + 1] = {};
+        for (size_t i = 0; i < n; i++) {
+            const TraceRecord& r = records[i];
+            if (r.task < 1 || r.task > writers || r.timeUs != r.arg * 7u ||
+                r.event != (uint8_t)r.arg || r.phase != r.arg % 3) {
+                bad++;
+                continue;
+            }
+            // Records of one writer are in its order
+            if (r.arg <= last[r.task]) {
+                outOfOrder++;
+            }
+            last[r.task] = r.arg;
+        }
+        snapshots++;
+        copied += n;
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    INFO("snapshots: " << snapshots << ", records copied: " << copied);
+    REQUIRE(bad == 0);
+    REQUIRE(outOfOrder == 0);
+    REQUIRE(ring.getWritten() == writers * perWriter);
+    // At rest the whole ring is complete and ends with the last record of a writer
+    REQUIRE(ring.snapshot(records.data(), records.size()) == 256);
+    for (const TraceRecord& r : records) {
+        REQUIRE(r.timeUs == r.arg * 7u);
+    }
+    REQUIRE(records.back().arg == perWriter);
+}
+
+TEST_CASE("TraceDump - Encoding and parsing", "[TraceDump]") {
+    std::vector<std::vector<TraceRecord> > cores(2);
+    cores[0].push_back(makeRecord(5000, 0, TRACE_PHASE_INSTANT, 12, 64));
+    cores[1].push_back(makeRecord(5100, 1, TRACE_PHASE_BEGIN, 13, 35));
+    std::vector<std::pair<uint32_t, const char*> > tasks;
+    tasks.push_back(std::make_pair(12u, "gnss_receiver"));
+    tasks.push_back(std::make_pair(13u, "a_very_long_task_name"));
+    std::vector<uint8_t> data = makeDump(6000, cores, tasks, 3);
+    TraceDump dump;
+
+    SECTION("Round trip") {
+        REQUIRE(data.size() == 32 + 3 * 32 + 2 * 20 + 2 * 16);
+        REQUIRE(memcmp(data.data(), "NTRT", 4) == 0);
+        REQUIRE(dump.parse(data.data(), data.size()));
+        REQUIRE(dump.getNowUs() == 6000);
+        REQUIRE(dump.getSkipped() == 3);
+        REQUIRE(dump.getEventCount() == 3);
+        REQUIRE(dump.getTaskCount() == 2);
+        REQUIRE(dump.getRecordCount() == 2);
+
+        char name[TRACE_DUMP_NAME_SIZE];
+        char argName[TRACE_DUMP_NAME_SIZE];
+        dump.getEvent(1, name, argName);
+        REQUIRE(std::string(name) == "frame_tx");
+        REQUIRE(std::string(argName) == "bytes");
+        dump.getEvent(2, name, argName);
+        REQUIRE(std::string(argName) == "");
+        dump.getEvent(3, name, NULL);
+        REQUIRE(std::string(name) == "");
+
+        REQUIRE(dump.getTask(0, name) == 12);
+        REQUIRE(std::string(name) == "gnss_receiver");
+        REQUIRE(dump.getTask(1, name) == 13);
+        REQUIRE(std::string(name) == "a_very_long_tas");    // Cut to 15 characters
+        REQUIRE(dump.getTask(2, name) == 0);
+
+        TraceRecord record;
+        uint8_t core = 9;
+        REQUIRE(dump.getRecord(1, &record, &core) == 5100);
+        REQUIRE(core == 1);
+        REQUIRE(record.task == 13);
+        REQUIRE(record.event == 1);
+        REQUIRE(record.phase == TRACE_PHASE_BEGIN);
+        REQUIRE(record.arg == 35);
+        REQUIRE(dump.getRecord(2, &record, NULL) == 0);
+    }
+
+    SECTION("Malformed downloads are rejected") {
+        REQUIRE_FALSE(dump.parse(NULL, 0));
+        REQUIRE_FALSE(dump.parse(data.data(), TRACE_DUMP_HEADER_SIZE - 1));
+        REQUIRE_FALSE(dump.parse(data.data(), data.size() - 1));       // Last record cut
+        std::vector<uint8_t> bad = data;
+        bad[0] = 'X';
+        REQUIRE_FALSE(dump.parse(bad.data(), bad.size()));
+        bad = data;
+        bad[4] = 2;                                                     // Version
+        REQUIRE_FALSE(dump.parse(bad.data(), bad.size()));
+        bad = data;
+        bad[20] = 0xFF;                                                 // Record count
+        bad[21] = 0xFF;
+        bad[22] = 0xFF;
+        bad[23] = 0xFF;
+        REQUIRE_FALSE(dump.parse(bad.data(), bad.size()));
+        REQUIRE(dump.getRecordCount() == 0);
+        // Extra bytes after the records are allowed
+        bad = data;
+        bad.push_back(0);
+        REQUIRE(dump.parse(bad.data(), bad.size()));
+    }
+
+    SECTION("Record times are extended across the 32 bit wrap") {
+        std::vector<std::vector<TraceRecord> > wrapped(1);
+        wrapped[0].push_back(makeRecord(0xFFFFFF00u, 0, TRACE_PHASE_INSTANT, 1, 0));
+        wrapped[0].push_back(makeRecord(0x00000010u, 0, TRACE_PHASE_INSTANT, 1, 0));
+        uint64_t now = (3ull << 32) + 0x100;
+        std::vector<uint8_t> later = makeDump(now, wrapped, tasks);
+        REQUIRE(dump.parse(later.data(), later.size()));
+        REQUIRE(dump.getNowUs() == now);
+        TraceRecord record;
+        REQUIRE(dump.getRecord(0, &record, NULL) == (3ull << 32) - 0x100);
+        REQUIRE(dump.getRecord(1, &record, NULL) == (3ull << 32) + 0x10);
+    }
+}
+
+TEST_CASE("ChromeTrace - Conversion", "[ChromeTrace]") {
+    std::vector<std::pair<uint32_t, const char*> > tasks;
+    tasks.push_back(std::make_pair(12u, "gnss_receiver"));
+    tasks.push_back(std::make_pair(13u, "data_\"output\""));
+    std::string json;
+    ChromeTraceInfo info;
+
+    SECTION("Cores are merged in time order with task threads") {
+        std::vector<std::vector<TraceRecord> > cores(2);
+        cores[0].push_back(makeRecord(1000, 0, TRACE_PHASE_INSTANT, 12, 128));
+        cores[0].push_back(makeRecord(3000, 0, TRACE_PHASE_INSTANT, 12, 96));
+        cores[1].push_back(makeRecord(2000, 1, TRACE_PHASE_BEGIN, 13, 0));
+        cores[1].push_back(makeRecord(2400, 1, TRACE_PHASE_END, 13, 35));
+        std::vector<uint8_t> data = makeDump(5000, cores, tasks);
+        REQUIRE(chromeTraceConvert(data.data(), data.size(), &json, &info));
+        REQUIRE(info.events == 4);
+        REQUIRE(info.threads == 2);
+        REQUIRE(info.droppedEnds == 0);
+
+        REQUIRE(json.find("{\"displayTimeUnit\":\"ms\"") == 0);
+        REQUIRE(json.find("\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":12,\"args\":{\"name\":\"gnss_receiver\"}") != std::string::npos);
+        REQUIRE(json.find("{\"name\":\"data_\\\"output\\\"\"}") != std::string::npos);
+        size_t first = json.find("\"ts\":1000,");
+        size_t begin = json.find("\"ph\":\"B\",\"ts\":2000,\"pid\":1,\"tid\":13,\"args\":{\"bytes\":0,\"core\":1}");
+        size_t end = json.find("\"ph\":\"E\",\"ts\":2400,\"pid\":1,\"tid\":13,\"args\":{\"bytes\":35,\"core\":1}");
+        size_t last = json.find("\"name\":\"uart_rx\",\"ph\":\"i\",\"s\":\"t\",\"ts\":3000,\"pid\":1,\"tid\":12");
+        REQUIRE(first != std::string::npos);
+        REQUIRE(begin > first);
+        REQUIRE(end > begin);
+        REQUIRE(last > end);
+        REQUIRE(last != std::string::npos);
+        REQUIRE(json.substr(json.size() - 4) == "\n]}\n");
+    }
+
+    SECTION("Ends without their begin are dropped") {
+        std::vector<std::vector<TraceRecord> > cores(1);
+        cores[0].push_back(makeRecord(100, 1, TRACE_PHASE_END, 13, 35));       // Begin overwritten
+        cores[0].push_back(makeRecord(200, 1, TRACE_PHASE_BEGIN, 13, 0));
+        cores[0].push_back(makeRecord(250, 2, TRACE_PHASE_END, 13, 0));        // Other event
+        cores[0].push_back(makeRecord(300, 1, TRACE_PHASE_END, 13, 35));
+        cores[0].push_back(makeRecord(400, 2, TRACE_PHASE_BEGIN, 12, 10));     // Stays open
+        std::vector<uint8_t> data = makeDump(500, cores, tasks);
+        REQUIRE(chromeTraceConvert(data.data(), data.size(), &json, &info));
+        REQUIRE(info.events == 3);
+        REQUIRE(info.droppedEnds == 2);
+        REQUIRE(countOf(json, "\"ph\":\"E\"") == 1);
+        REQUIRE(countOf(json, "\"ph\":\"B\"") == 2);
+        REQUIRE(json.find("\"name\":\"mqtt_publish\",\"ph\":\"B\",\"ts\":400,\"pid\":1,\"tid\":12,\"args\":{\"arg\":10") != std::string::npos);
+    }
+
+    SECTION("Records without task numbers and unknown events") {
+        std::vector<std::vector<TraceRecord> > cores(2);
+        cores[1].push_back(makeRecord(100, 7, TRACE_PHASE_INSTANT, 0, 1));
+        std::vector<uint8_t> data = makeDump(500, cores, tasks);
+        REQUIRE(chromeTraceConvert(data.data(), data.size(), &json, &info));
+        REQUIRE(json.find("\"tid\":100001,\"args\":{\"name\":\"core 1\"}") != std::string::npos);
+        REQUIRE(json.find("{\"name\":\"event 7\",\"ph\":\"i\"") != std::string::npos);
+    }
+
+    SECTION("Malformed downloads") {
+        uint8_t junk[64] = {};
+        REQUIRE_FALSE(chromeTraceConvert(junk, sizeof(junk), &json, &info));
+        REQUIRE_FALSE(chromeTraceConvert(junk, sizeof(junk), NULL, NULL));
+    }
+}
+
+// Mutex protected ring of structs, the straightforward alternative
+struct MutexTrace {
+    std::mutex mutex;
+    std::vector<TraceRecord> records;
+    size_t head = 0;
+    explicit MutexTrace(size_t capacity) : records(capacity) {}
+    void record(uint32_t timeUs, uint8_t event, uint8_t phase, uint16_t task, uint32_t arg) {
+        std::lock_guard<std::mutex> lock(mutex);
+        TraceRecord& r = records[head++ % records.size()];
+        r.timeUs = timeUs;
+        r.arg = arg;
+        r.task = task;
+        r.event = event;
+        r.phase = phase;
+    }
+};
+
+// Formatted text line per event, like a debug log into a buffer
+struct TextTrace {
+    std::mutex mutex;
+    std::vector<char> buffer;
+    size_t used = 0;
+    explicit TextTrace(size_t size) : buffer(size) {}
+    void record(uint32_t timeUs, uint8_t event, uint8_t phase, uint16_t task, uint32_t arg) {
+        char line[64];
+        int n = snprintf(line, sizeof(line), "%lu T%u E%u P%u A%lu\n", (unsigned long)timeUs,
+                         (unsigned)task, (unsigned)event, (unsigned)phase, (unsigned long)arg);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (used + n > buffer.size()) {
+            used = 0;
+        }
+        memcpy(&buffer[used], line, n);
+        used += n;
+    }
+};
+
+template <typename Trace>
+static double benchmarkRecord(Trace& trace, int threads, uint32_t perThread) {
+    std::vector<std::thread> workers;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; t++) {
+        workers.push_back(std::thread([&trace, t, perThread]() {
+            for (uint32_t i = 0; i < perThread; i++) {
+                trace.record(i, (uint8_t)(i & 3), TRACE_PHASE_INSTANT, (uint16_t)t, i);
+            }
+        }));
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return seconds * 1e9 / ((double)threads * perThread);
+}
+
+TEST_CASE("Trace benchmark - record cost, snapshot and conversion", "[.benchmark]") {
+    const uint32_t perThread = 4000000;
+    printf("\nTrace record, %u records per thread (%u CPUs)\n", perThread, std::thread::hardware_concurrency());
+    printf("%-22s %8s %12s\n", "trace", "threads", "ns/record");
+    for (int threads = 1; threads <= 2; threads++) {
+        TextTrace text(512 * 24);
+        printf("%-22s %8d %12.1f\n", "text line + mutex", threads, benchmarkRecord(text, threads, perThread));
+        MutexTrace locked(512);
+        printf("%-22s %8d %12.1f\n", "binary + mutex", threads, benchmarkRecord(locked, threads, perThread));
+        TraceRing ring;
+        ring.init(512);
+        printf("%-22s %8d %12.1f\n", "TraceRing", threads, benchmarkRecord(ring, threads, perThread));
+    }
+
+    // Download of two full rings and its conversion
+    TraceRing rings[2];
+    std::vector<std::vector<TraceRecord> > cores(2);
+    for (int core = 0; core < 2; core++) {
+        rings[core].init(512);
+        for (uint32_t i = 0; i < 2000; i++) {
+            rings[core].record(i * 250, (uint8_t)(i % 3), (uint8_t)(i % 3 == 1 ? TRACE_PHASE_INSTANT : 1 + (i & 1)),
+                               (uint16_t)(10 + core), i);
+        }
+        cores[core].resize(512);
+    }
+    const int repeats = 2000;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; r++) {
+        for (int core = 0; core < 2; core++) {
+            rings[core].snapshot(cores[core].data(), cores[core].size());
+        }
+    }
+    double snapshotUs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e6 / repeats;
+
+    std::vector<std::pair<uint32_t, const char*> > tasks;
+    tasks.push_back(std::make_pair(10u, "gnss_receiver"));
+    tasks.push_back(std::make_pair(11u, "NTRIP_Client"));
+    std::vector<uint8_t> data = makeDump(600000, cores, tasks);
+    std::string json;
+    ChromeTraceInfo info;
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < 100; r++) {
+        chromeTraceConvert(data.data(), data.size(), &json, &info);
+    }
+    double convertMs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e3 / 100;
+    printf("\nSnapshot of 2 x 512 records: %.1f us; download %zu bytes; Chrome JSON %zu bytes, %zu events in %.2f ms\n",
+           snapshotUs, data.size(), json.size(), info.events, convertMs);
+}
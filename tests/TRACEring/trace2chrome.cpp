@@ -0,0 +1,53 @@
+// Convert a trace download of GET /api/trace to Chrome trace JSON
+//
+//   curl -H "Authorization: Bearer <session token>" http://192.168.4.1/api/trace -o trace.bin
+//   trace2chrome trace.bin trace.json
+//
+// Open trace.json in ui.perfetto.dev or chrome://tracing.
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "ChromeTrace.h"
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <trace.bin> <trace.json>\n", argv[0]);
+        return 2;
+    }
+
+    FILE* in = fopen(argv[1], "rb");
+    if (in == NULL) {
+        fprintf(stderr, "Cannot open %s\n", argv[1]);
+        return 1;
+    }
+    std::vector<uint8_t> data;
+    uint8_t buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        data.insert(data.end(), buffer, buffer + n);
+    }
+    fclose(in);
+
+    std::string json;
+    ChromeTraceInfo info;
+    if (!chromeTraceConvert(data.data(), data.size(), &json, &info)) {
+        fprintf(stderr, "%s is not a trace download\n", argv[1]);
+        return 1;
+    }
+
+    FILE* out = fopen(argv[2], "wb");
+    if (out == NULL || fwrite(json.data(), 1, json.size(), out) != json.size()) {
+        fprintf(stderr, "Cannot write %s\n", argv[2]);
+        if (out != NULL) {
+            fclose(out);
+        }
+        return 1;
+    }
+    fclose(out);
+    fprintf(stderr, "%lu events of %lu tasks, %lu ends without begin dropped, %lu records skipped by the device\n",
+            (unsigned long)info.events, (unsigned long)info.threads, (unsigned long)info.droppedEnds,
+            (unsigned long)info.skipped);
+    return 0;
+}